@@ -2364,6 +2364,55 @@ bgp_attr_check (struct peer *peer, struct attr *attr)
 
 int stream_put_prefix (struct stream *, struct prefix *);
 
+#ifdef USE_SRX
+/**
+ * Determine if the update can be sent to the peer as BGPsec update. Both
+ * peers need to have negotiated BGPsec and the update must not be aggregated.
+ *
+ * @param peer The peer the update is sent to.
+ * @param from The peer the update was received from, NULL if not received.
+ * @param attr The attributes of the update.
+ *
+ * @return true if a BGPsec path can be sent.
+ */
+bool
+bgp_attr_bgpsec_capable (struct peer *peer, struct peer *from,
+                         struct attr *attr)
+{
+  /* if and only if, the peer's recv capability set and this node's send
+   * capability set, BGPSec Update message can be sent to the peer */
+  if (   !CHECK_FLAG (peer->flags, PEER_FLAG_BGPSEC_CAPABILITY_SEND)
+      || !CHECK_FLAG (peer->cap, PEER_CAP_BGPSEC_ADV))
+    return false;
+
+  if (from && from->as && from->as != peer->as
+      && (   !CHECK_FLAG (from->flags, PEER_FLAG_BGPSEC_CAPABILITY_RECV)
+          || !CHECK_FLAG (from->cap, PEER_CAP_BGPSEC_ADV_SEND)))
+    return false;
+
+  // No Aggregation allowed in BGPSEC - 4.1
+  return !(attr->flag & ATTR_FLAG_BIT (BGP_ATTR_AGGREGATOR))
+         && !(attr->flag & ATTR_FLAG_BIT (BGP_ATTR_ATOMIC_AGGREGATE));
+}
+
+/**
+ * Determine pCount and flags of the own secure path segment for the peer.
+ *
+ * @param peer The eBGP or confederation peer the update is signed for.
+ * @param pCount Returns the pCount.
+ * @param flags Returns the flags.
+ */
+void
+bgp_attr_bgpsec_segment (struct peer *peer, u_int8_t *pCount, u_int8_t *flags)
+{
+  // @TODO: set the confed flag here
+  *flags  = peer->sort == BGP_PEER_CONFED ? 0x80 : 0;
+  *pCount = (CHECK_FLAG (peer->flags, PEER_FLAG_BGPSEC_MIGRATE))
+            ? 0
+            : peer->sort == BGP_PEER_CONFED ? 0 : 1;
+}
+#endif /* USE_SRX */
+
 /* Make attribute packet. */
 #ifdef USE_SRX
 // This method is changed that much that it makes sense to copy the original
@@ -2464,20 +2513,7 @@ bgp_packet_attribute (struct bgp *bgp, struct peer *peer,
   *
   * Added the case prefix aggregation is chosen, only generate a BGP4 AS_PATH
   */
-  if (!*useASpath
-      && (   (   !CHECK_FLAG (peer->flags, PEER_FLAG_BGPSEC_CAPABILITY_SEND)
-              || !CHECK_FLAG (peer->cap, PEER_CAP_BGPSEC_ADV)
-             )
-          || ( from && from->as && from->as != peer->as
-               && (   !CHECK_FLAG (from->flags, PEER_FLAG_BGPSEC_CAPABILITY_RECV)
-                   || !CHECK_FLAG (from->cap, PEER_CAP_BGPSEC_ADV_SEND)
-                  )
-             )
-          // No Aggregation allowed in BGPSEC - 4.1
-          || (attr->flag & ATTR_FLAG_BIT (BGP_ATTR_AGGREGATOR))
-          || (attr->flag & ATTR_FLAG_BIT (BGP_ATTR_ATOMIC_AGGREGATE))
-         )
-     )
+  if (!*useASpath && !bgp_attr_bgpsec_capable (peer, from, attr))
   {
     // We determined that for this peer no bgpsec path can be made.
     *useASpath = true;
@@ -2496,11 +2532,7 @@ bgp_packet_attribute (struct bgp *bgp, struct peer *peer,
     // First check if we do bgpsec:
     if ((peer->sort == BGP_PEER_EBGP) || (peer->sort == BGP_PEER_CONFED))
     {
-      // @TODO: set the confed flag here
-      flags  = peer->sort == BGP_PEER_CONFED ? 0x80 : 0;
-      pCount = (CHECK_FLAG (peer->flags, PEER_FLAG_BGPSEC_MIGRATE))
-               ? 0
-               : peer->sort == BGP_PEER_CONFED ? 0 : 1;
+      bgp_attr_bgpsec_segment (peer, &pCount, &flags);
       signature = signBGPSecPathAttr(bgp, peer, p, attr, pCount, flags);
 
       // Now if we were unable to generate a signature, fall back to the BGP4
@@ -176,6 +176,10 @@ extern bgp_size_t bgp_packet_attribute (struct bgp *bgp, struct peer *,
                                  struct prefix *, afi_t, safi_t,
                                  struct peer *, struct prefix_rd *, u_char *,
                                  bool* fSetAspath);
+extern bool bgp_attr_bgpsec_capable (struct peer *, struct peer *from,
+                                     struct attr *);
+extern void bgp_attr_bgpsec_segment (struct peer *, u_int8_t *pCount,
+                                     u_int8_t *flags);
 #else
 extern bgp_size_t bgp_packet_attribute (struct bgp *bgp, struct peer *,
                                  struct stream *, struct attr *,
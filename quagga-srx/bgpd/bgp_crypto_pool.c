@@ -0,0 +1,704 @@
+/**
+ * This software was developed at the National Institute of Standards and
+ * Technology by employees of the Federal Government in the course of
+ * their official duties. Pursuant to title 17 Section 105 of the United
+ * States Code this software is not subject to copyright protection and
+ * is in the public domain.
+ *
+ * NIST assumes no responsibility whatsoever for its use by other parties,
+ * and makes no guarantees, expressed or implied, about its quality,
+ * reliability, or any other characteristic.
+ *
+ * We would appreciate acknowledgment if the software is used.
+ *
+ * NIST ALLOWS FREE USE OF THIS SOFTWARE IN ITS "AS IS" CONDITION AND
+ * DISCLAIM ANY LIABILITY OF ANY KIND FOR ANY DAMAGES WHATSOEVER RESULTING
+ * FROM THE USE OF THIS SOFTWARE.
+ *
+ * This software might use libraries that are under GNU public license or
+ * other licenses. Please refer to the licenses of all libraries required
+ * by this software.
+ *
+ * Worker pool that performs the local BGPsec path validation outside of the
+ * bgpd main thread. Each job validates a private copy of the validation data
+ * of the update. Finished jobs are collected in a result list, the first
+ * result written into an empty list wakes up the main thread through an event
+ * descriptor of the thread library.
+ * The main thread then applies all collected results to the updates that are
+ * still installed with the same path attributes.
+ *
+ * @version 0.6.0.4
+ *
+ * Changelog:
+ * -----------------------------------------------------------------------------
+ * 0.6.0.4 - 2026/10/17
+ *           * File created
+ */
+#include <zebra.h>
+
+#ifdef USE_SRX
+
+#include <pthread.h>
+
+#include "log.h"
+#include "prefix.h"
+#include "thread.h"
+#include "vty.h"
+
+#include "bgpd/bgpd.h"
+#include "bgpd/bgp_attr.h"
+#include "bgpd/bgp_fsm.h"
+#include "bgpd/bgp_packet.h"
+#include "bgpd/bgp_route.h"
+#include "bgpd/bgp_validate.h"
+#include "bgpd/bgp_sign_cache.h"
+#include "bgpd/bgp_crypto_pool.h"
+
+/* One BGPsec path validation or signature generation */
+struct crypto_job
+{
+  struct crypto_job *next;
+  /* Validation: the update, locked as long as the job exists */
+  struct bgp_info *info;
+  /* The validation data of the update, used to detect a changed update */
+  SCA_BGPSecValidationData *origData;
+  /* Private copy of the validation data handed to the API. Signing uses it
+   * to generate the hash message of the received path */
+  SCA_BGPSecValidationData data;
+  /* The result of the validate call */
+  int valResult;
+
+  /* Signing: the peer the signature is made for, locked as long as the job
+   * exists */
+  struct peer *peer;
+  /* The cache receiving the signature and its flush count at submit time */
+  struct sign_cache *cache;
+  unsigned long generation;
+  /* The signed data, the path is owned by the job */
+  struct sign_cache_key key;
+  SCA_BGPSEC_SecurePathSegment spSeg;
+  SCA_BGPSecSignData signData;
+};
+
+struct crypto_pool
+{
+  struct bgp *bgp;
+  SRxCryptoAPI *capi;
+
+  pthread_t *threads;
+  int noThreads;
+
+  /* Protects the job lists and the stop flag */
+  pthread_mutex_t mutex;
+  pthread_cond_t cond;
+  bool stop;
+
+  /* Jobs waiting for a worker */
+  struct crypto_job *reqHead;
+  struct crypto_job *reqTail;
+  unsigned int queued;
+
+  /* Jobs finished but not yet applied by the main thread */
+  struct crypto_job *doneHead;
+  struct crypto_job *doneTail;
+
+  /* Wakes up the main thread */
+  struct thread_event_fd wake;
+  struct thread *t_read;
+
+  struct crypto_pool_stats stats;
+};
+
+static int crypto_pool_read (struct thread *);
+
+/**
+ * Release the hash messages the API generated for the job.
+ *
+ * @param pool The worker pool.
+ * @param job The job.
+ */
+static void _crypto_job_free (struct crypto_pool *pool, struct crypto_job *job)
+{
+  int idx;
+
+  for (idx = 0; idx < 2; idx++)
+  {
+    if (job->data.hashMessage[idx] != NULL)
+    {
+      if (!pool->capi->freeHashMessage(job->data.hashMessage[idx]))
+      {
+        freeSCA_HashMessage(job->data.hashMessage[idx]);
+      }
+      job->data.hashMessage[idx] = NULL;
+    }
+  }
+  if (job->signData.signature != NULL)
+  {
+    if (pool->capi->freeSignature(job->signData.signature) == API_FAILURE)
+    {
+      free (job->signData.signature->sigBuff);
+      free (job->signData.signature);
+    }
+    job->signData.signature = NULL;
+  }
+  free (job->key.path);
+  free (job);
+}
+
+/**
+ * Take the next job from the request queue. Signing jobs that follow a
+ * signing job are taken as well, up to a batch of SRX_SIGN_BATCH jobs, and
+ * handed to the API in one sign call. Must be called with the mutex locked.
+ *
+ * @param pool The worker pool.
+ *
+ * @return the list of jobs.
+ */
+static struct crypto_job* _crypto_pool_pop (struct crypto_pool *pool)
+{
+  struct crypto_job *head = pool->reqHead;
+  struct crypto_job *tail = head;
+  int count = 1;
+
+  if (head->peer != NULL)
+  {
+    while (count < SRX_SIGN_BATCH && tail->next != NULL
+           && tail->next->peer != NULL)
+    {
+      tail = tail->next;
+      count++;
+    }
+  }
+
+  pool->reqHead = tail->next;
+  if (pool->reqHead == NULL)
+  {
+    pool->reqTail = NULL;
+  }
+  pool->queued -= count;
+  tail->next = NULL;
+
+  if (head->peer != NULL)
+  {
+    pool->stats.batches++;
+    if (count > pool->stats.maxBatch)
+    {
+      pool->stats.maxBatch = count;
+    }
+  }
+
+  return head;
+}
+
+/**
+ * Generate the signatures of the list of signing jobs with one sign call.
+ * Each job uses its own hash message because the API writes the target AS
+ * and the own path segment into it.
+ *
+ * @param pool The worker pool.
+ * @param jobs The list of signing jobs.
+ */
+static void _crypto_pool_sign (struct crypto_pool *pool,
+                               struct crypto_job *jobs)
+{
+  SCA_BGPSecSignData *signData[SRX_SIGN_BATCH];
+  struct crypto_job *job;
+  int count = 0;
+
+  for (job = jobs; job != NULL; job = job->next)
+  {
+    job->signData.algorithmID = job->key.algoID;
+    job->signData.myHost      = &job->spSeg;
+    job->signData.peerAS      = job->key.targetAS;
+    job->signData.nlri        = &job->key.nlri;
+    job->signData.ski         = job->key.ski;
+    job->signData.status      = API_STATUS_OK;
+    job->signData.signature   = NULL;
+    job->signData.hashMessage = NULL;
+
+    if (job->key.path != NULL)
+    {
+      // Forwarded path, without hash message the API would sign it as an
+      // origination.
+      job->data.bgpsec_path_attr = job->key.path;
+      job->data.nlri             = &job->key.nlri;
+      sca_generateHashMessage (&job->data, SCA_ECDSA_ALGORITHM,
+                               &job->data.status);
+      if (job->data.hashMessage[0] == NULL)
+      {
+        continue;
+      }
+      job->signData.hashMessage = job->data.hashMessage[0];
+    }
+    signData[count++] = &job->signData;
+  }
+
+  // The result of the call is checked per job using the signature.
+  if (count > 0)
+  {
+    pool->capi->sign (count, signData);
+  }
+}
+
+/**
+ * Worker thread. Validates jobs until the pool is stopped and no job is left.
+ *
+ * @param arg The worker pool.
+ *
+ * @return NULL
+ */
+static void* _crypto_pool_worker (void *arg)
+{
+  struct crypto_pool *pool = (struct crypto_pool *)arg;
+  struct crypto_job *job;
+  bool wakeup;
+
+  pthread_mutex_lock (&pool->mutex);
+  while (true)
+  {
+    while (pool->reqHead == NULL && !pool->stop)
+    {
+      pthread_cond_wait (&pool->cond, &pool->mutex);
+    }
+    if (pool->reqHead == NULL)
+    {
+      break;
+    }
+
+    job = _crypto_pool_pop (pool);
+    pthread_mutex_unlock (&pool->mutex);
+
+    if (job->peer != NULL)
+    {
+      _crypto_pool_sign (pool, job);
+    }
+    else
+    {
+      job->valResult = pool->capi->validate (&job->data);
+    }
+
+    pthread_mutex_lock (&pool->mutex);
+    wakeup = pool->doneHead == NULL;
+    if (pool->doneTail != NULL)
+    {
+      pool->doneTail->next = job;
+    }
+    else
+    {
+      pool->doneHead = job;
+    }
+    while (job->next != NULL)
+    {
+      job = job->next;
+    }
+    pool->doneTail = job;
+
+    // Only the first result of an empty list needs to wake the main thread.
+    if (wakeup)
+    {
+      thread_event_fd_signal (&pool->wake);
+    }
+  }
+  pthread_mutex_unlock (&pool->mutex);
+
+  return NULL;
+}
+
+/**
+ * Apply the result of the job to the update. The result is dropped if the
+ * update was removed or received new path attributes in the meantime.
+ *
+ * @param pool The worker pool.
+ * @param job The finished job.
+ */
+static void _crypto_pool_apply (struct crypto_pool *pool,
+                                struct crypto_job *job)
+{
+  struct bgp_info *info = job->info;
+  SCA_BGPSecValidationData *origData = job->origData;
+  uint8_t bgpsecResult;
+  int idx;
+
+  pool->stats.completed++;
+
+  if (CHECK_FLAG (info->flags, BGP_INFO_REMOVED) || info->attr == NULL
+      || info->attr->bgpsec_validationData != origData)
+  {
+    pool->stats.discarded++;
+  }
+  else
+  {
+    bgpsecResult = job->valResult == API_VALRESULT_VALID ? SRx_RESULT_VALID
+                                                         : SRx_RESULT_INVALID;
+    if (bgpsecResult == SRx_RESULT_INVALID
+        && (job->data.status & API_STATUS_ERROR_MASK) > 0)
+    {
+      zlog_err("Update [0x%08X] validation returned invalid with an error: "
+               "status=0x%X\n", info->updateID, job->data.status);
+    }
+
+    // Keep the generated hash messages with the update, they are used again
+    // when the update is signed for a peer.
+    for (idx = 0; idx < 2; idx++)
+    {
+      if (origData->hashMessage[idx] == NULL)
+      {
+        origData->hashMessage[idx] = job->data.hashMessage[idx];
+        job->data.hashMessage[idx] = NULL;
+      }
+    }
+
+    bgp_info_set_validation_result (info, VRT_BGPSEC, 0, bgpsecResult, 0);
+  }
+
+  bgp_info_unlock (info);
+  _crypto_job_free (pool, job);
+}
+
+/**
+ * Store the signature of the job in the signature cache and let the peer
+ * continue sending its updates. The signature is dropped if the cache was
+ * replaced or flushed in the meantime.
+ *
+ * @param pool The worker pool.
+ * @param job The finished signing job.
+ */
+static void _crypto_pool_signed (struct crypto_pool *pool,
+                                 struct crypto_job *job)
+{
+  struct sign_cache *cache = pool->bgp->srx_signCache;
+  struct sign_cache_stats stats;
+  struct peer *peer = job->peer;
+
+  pool->stats.completed++;
+
+  sign_cache_statistics (cache, &stats);
+  if (cache != job->cache || stats.flushes != job->generation)
+  {
+    pool->stats.discarded++;
+  }
+  else if (job->signData.signature == NULL)
+  {
+    pool->stats.signFailed++;
+    sign_cache_fail (cache, &job->key);
+  }
+  else
+  {
+    sign_cache_add (cache, &job->key, job->signData.signature);
+  }
+
+  // The peer might have stopped building updates while the signature was
+  // pending.
+  if (peer->status == Established)
+  {
+    BGP_WRITE_ON (peer->t_write, bgp_write, peer->fd);
+  }
+
+  peer_unlock (peer);
+  _crypto_job_free (pool, job);
+}
+
+/**
+ * Apply all results collected by the workers.
+ *
+ * @param pool The worker pool.
+ */
+static void _crypto_pool_process (struct crypto_pool *pool)
+{
+  struct crypto_job *job;
+  struct crypto_job *next;
+
+  pthread_mutex_lock (&pool->mutex);
+  job = pool->doneHead;
+  pool->doneHead = NULL;
+  pool->doneTail = NULL;
+  pthread_mutex_unlock (&pool->mutex);
+
+  for (; job != NULL; job = next)
+  {
+    next = job->next;
+    if (job->peer != NULL)
+    {
+      _crypto_pool_signed (pool, job);
+    }
+    else
+    {
+      _crypto_pool_apply (pool, job);
+    }
+  }
+}
+
+/**
+ * Read event of the wake-up descriptor.
+ *
+ * @param thread The read thread.
+ *
+ * @return 0
+ */
+static int crypto_pool_read (struct thread *thread)
+{
+  struct crypto_pool *pool = THREAD_ARG (thread);
+
+  pool->t_read = NULL;
+  pool->stats.wakeups++;
+
+  // Clear the descriptor before the results are taken, a result added later
+  // on signals again.
+  thread_event_fd_clear (&pool->wake);
+
+  _crypto_pool_process (pool);
+
+  pool->t_read = thread_add_event_fd (bm->master, crypto_pool_read, pool,
+                                      &pool->wake);
+  return 0;
+}
+
+/**
+ * Create the worker pool and start the worker threads.
+ *
+ * @param bgp The bgp instance the pool validates for.
+ * @param capi The SRxCryptoAPI used for the validation.
+ * @param noWorkers The number of worker threads.
+ *
+ * @return the worker pool or NULL if it could not be created.
+ */
+struct crypto_pool* crypto_pool_new (struct bgp *bgp, SRxCryptoAPI *capi,
+                                     int noWorkers)
+{
+  struct crypto_pool *pool;
+  int idx;
+
+  if (capi == NULL || noWorkers <= 0)
+  {
+    return NULL;
+  }
+
+  pool = calloc (1, sizeof(struct crypto_pool));
+  if (pool == NULL)
+  {
+    return NULL;
+  }
+  pool->bgp  = bgp;
+  pool->capi = capi;
+
+  if (thread_event_fd_open (&pool->wake) != 0)
+  {
+    zlog_err ("[%s] Cannot create wake-up descriptor: %s", __FUNCTION__,
+              safe_strerror (errno));
+    free (pool);
+    return NULL;
+  }
+
+  pthread_mutex_init (&pool->mutex, NULL);
+  pthread_cond_init (&pool->cond, NULL);
+
+  pool->threads = calloc (noWorkers, sizeof(pthread_t));
+  for (idx = 0; pool->threads != NULL && idx < noWorkers; idx++)
+  {
+    if (pthread_create (&pool->threads[idx], NULL, _crypto_pool_worker,
+                        pool) != 0)
+    {
+      zlog_err ("[%s] Cannot start crypto worker %d", __FUNCTION__, idx);
+      break;
+    }
+    pool->noThreads++;
+  }
+  pool->stats.workers = pool->noThreads;
+
+  if (pool->noThreads == 0)
+  {
+    crypto_pool_free (&pool);
+    return NULL;
+  }
+
+  pool->t_read = thread_add_event_fd (bm->master, crypto_pool_read, pool,
+                                      &pool->wake);
+  return pool;
+}
+
+/**
+ * Stop the worker threads and release the pool. Jobs that are still queued
+ * are validated and applied before this function returns.
+ *
+ * @param pool Pointer to the worker pool, will be set to NULL.
+ */
+void crypto_pool_free (struct crypto_pool **pool)
+{
+  struct crypto_pool *self = *pool;
+  int idx;
+
+  if (self == NULL)
+  {
+    return;
+  }
+
+  pthread_mutex_lock (&self->mutex);
+  self->stop = true;
+  pthread_cond_broadcast (&self->cond);
+  pthread_mutex_unlock (&self->mutex);
+
+  for (idx = 0; idx < self->noThreads; idx++)
+  {
+    pthread_join (self->threads[idx], NULL);
+  }
+
+  THREAD_READ_OFF (self->t_read);
+  _crypto_pool_process (self);
+
+  thread_event_fd_close (&self->wake);
+  pthread_cond_destroy (&self->cond);
+  pthread_mutex_destroy (&self->mutex);
+  free (self->threads);
+  free (self);
+
+  *pool = NULL;
+}
+
+/**
+ * Append the job to the request queue and wake up a worker.
+ *
+ * @param pool The worker pool.
+ * @param job The job.
+ */
+static void _crypto_pool_submit (struct crypto_pool *pool,
+                                 struct crypto_job *job)
+{
+  pthread_mutex_lock (&pool->mutex);
+  if (pool->reqTail != NULL)
+  {
+    pool->reqTail->next = job;
+  }
+  else
+  {
+    pool->reqHead = job;
+  }
+  pool->reqTail = job;
+  pool->queued++;
+  if (pool->queued > pool->stats.maxQueued)
+  {
+    pool->stats.maxQueued = pool->queued;
+  }
+  pthread_cond_signal (&pool->cond);
+  pthread_mutex_unlock (&pool->mutex);
+
+  pool->stats.submitted++;
+}
+
+/**
+ * Hand the BGPsec path validation of the update to the worker threads. The
+ * result is applied by the main thread using
+ * bgp_info_set_validation_result().
+ *
+ * @param pool The worker pool.
+ * @param info The update to be validated.
+ *
+ * @return true if the job was queued, false if the update has to be
+ *         validated by the caller.
+ */
+bool crypto_pool_validate (struct crypto_pool *pool, struct bgp_info *info)
+{
+  struct crypto_job *job;
+
+  if (pool == NULL || info->attr == NULL
+      || info->attr->bgpsec_validationData == NULL)
+  {
+    return false;
+  }
+
+  job = calloc (1, sizeof(struct crypto_job));
+  if (job == NULL)
+  {
+    return false;
+  }
+
+  job->info     = bgp_info_lock (info);
+  job->origData = info->attr->bgpsec_validationData;
+  // The workers generate their own hash messages, the ones of the update
+  // might be in use by the main thread.
+  job->data     = *job->origData;
+  job->data.hashMessage[0] = NULL;
+  job->data.hashMessage[1] = NULL;
+  job->data.status         = API_STATUS_OK;
+
+  _crypto_pool_submit (pool, job);
+
+  return true;
+}
+
+/**
+ * Hand the generation of the signature for the given key to the worker
+ * threads. The signature is stored in the signature cache by the main thread,
+ * which then triggers the write thread of the peer. The caller is expected to
+ * have reserved the cache entry.
+ *
+ * @param pool The worker pool.
+ * @param peer The peer the signature is made for.
+ * @param cache The signature cache receiving the signature.
+ * @param key The data to be signed.
+ *
+ * @return true if the job was queued, false if the signature has to be
+ *         generated by the caller.
+ */
+bool crypto_pool_sign (struct crypto_pool *pool, struct peer *peer,
+                       struct sign_cache *cache, struct sign_cache_key *key)
+{
+  struct sign_cache_stats stats;
+  struct crypto_job *job;
+
+  if (pool == NULL || cache == NULL)
+  {
+    return false;
+  }
+
+  job = calloc (1, sizeof(struct crypto_job));
+  if (job == NULL)
+  {
+    return false;
+  }
+  job->key = *key;
+  if (key->path != NULL)
+  {
+    job->key.path = malloc (key->pathLen);
+    if (job->key.path == NULL)
+    {
+      free (job);
+      return false;
+    }
+    memcpy (job->key.path, key->path, key->pathLen);
+  }
+  sign_cache_statistics (cache, &stats);
+  job->peer         = peer_lock (peer);
+  job->cache        = cache;
+  job->generation   = stats.flushes;
+  job->spSeg.pCount = key->pCount;
+  job->spSeg.flags  = key->flags;
+  job->spSeg.asn    = htonl (pool->bgp->as);
+
+  _crypto_pool_submit (pool, job);
+  pool->stats.signJobs++;
+
+  return true;
+}
+
+/**
+ * Fill the given statistics with the counters of the worker pool.
+ *
+ * @param pool The worker pool, NULL if no pool is running.
+ * @param stats The statistics to be filled.
+ */
+void crypto_pool_statistics (struct crypto_pool *pool,
+                             struct crypto_pool_stats *stats)
+{
+  if (pool == NULL)
+  {
+    memset (stats, 0, sizeof(struct crypto_pool_stats));
+    return;
+  }
+
+  pthread_mutex_lock (&pool->mutex);
+  *stats = pool->stats;
+  pthread_mutex_unlock (&pool->mutex);
+  stats->pending = stats->submitted - stats->completed;
+}
+
+#endif /* USE_SRX */
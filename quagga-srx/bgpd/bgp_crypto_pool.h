@@ -0,0 +1,108 @@
+/**
+ * This software was developed at the National Institute of Standards and
+ * Technology by employees of the Federal Government in the course of
+ * their official duties. Pursuant to title 17 Section 105 of the United
+ * States Code this software is not subject to copyright protection and
+ * is in the public domain.
+ *
+ * NIST assumes no responsibility whatsoever for its use by other parties,
+ * and makes no guarantees, expressed or implied, about its quality,
+ * reliability, or any other characteristic.
+ *
+ * We would appreciate acknowledgment if the software is used.
+ *
+ * NIST ALLOWS FREE USE OF THIS SOFTWARE IN ITS "AS IS" CONDITION AND
+ * DISCLAIM ANY LIABILITY OF ANY KIND FOR ANY DAMAGES WHATSOEVER RESULTING
+ * FROM THE USE OF THIS SOFTWARE.
+ *
+ * This software might use libraries that are under GNU public license or
+ * other licenses. Please refer to the licenses of all libraries required
+ * by this software.
+ *
+ * Worker pool that performs the local BGPsec path validation and the signing
+ * of outbound BGPsec paths outside of the bgpd main thread. The results are
+ * handed back to the main thread through an event descriptor that is watched
+ * by the thread master.
+ *
+ * @version 0.6.0.4
+ *
+ * Changelog:
+ * -----------------------------------------------------------------------------
+ * 0.6.0.4 - 2026/10/17
+ *           * File created
+ */
+#ifndef _QUAGGA_BGP_CRYPTO_POOL_H
+#define _QUAGGA_BGP_CRYPTO_POOL_H
+
+#include "config.h"
+
+#ifdef USE_SRX
+
+#include <zebra.h>
+#include <srx/srxcryptoapi.h>
+
+/* Default number of crypto worker threads. 0 validates on the main thread */
+#define SRX_CRYPTO_WORKERS      2
+/* Maximum number of crypto worker threads */
+#define SRX_CRYPTO_WORKERS_MAX  64
+/* Maximum number of signatures generated with one sign call */
+#define SRX_SIGN_BATCH          32
+/* Default number of queued updates per peer the signatures are requested
+ * for. 0 signs within the main thread while the update is built */
+#define SRX_SIGN_PREFETCH       64
+/* Largest configurable number of prefetched signatures */
+#define SRX_SIGN_PREFETCH_MAX   4096
+
+struct bgp;
+struct bgp_info;
+struct peer;
+struct sign_cache;
+struct sign_cache_key;
+struct crypto_pool;
+
+/* Counters of the crypto worker pool */
+struct crypto_pool_stats
+{
+  /* Jobs handed to the workers */
+  unsigned long submitted;
+  /* Jobs finished by the workers */
+  unsigned long completed;
+  /* Results dropped because the update was removed or changed meanwhile or
+   * because the signature cache was flushed */
+  unsigned long discarded;
+  /* Signing jobs, included in submitted */
+  unsigned long signJobs;
+  /* Signing jobs the API could not generate a signature for */
+  unsigned long signFailed;
+  /* Sign calls of the workers */
+  unsigned long batches;
+  /* Read events of the wake-up descriptor */
+  unsigned long wakeups;
+  /* Largest number of jobs waiting for a worker */
+  unsigned int  maxQueued;
+  /* Largest number of signatures generated with one sign call */
+  unsigned int  maxBatch;
+  /* Jobs currently waiting for or processed by a worker */
+  unsigned int  pending;
+  /* Number of worker threads */
+  unsigned int  workers;
+};
+
+/* Create and destroy the worker pool */
+extern struct crypto_pool* crypto_pool_new (struct bgp *, SRxCryptoAPI *,
+                                            int noWorkers);
+extern void crypto_pool_free (struct crypto_pool **);
+
+/* Hand the BGPsec path validation of the update to the workers */
+extern bool crypto_pool_validate (struct crypto_pool *, struct bgp_info *);
+
+/* Hand the signing for the peer to the workers, the result is stored in the
+ * signature cache */
+extern bool crypto_pool_sign (struct crypto_pool *, struct peer *,
+                              struct sign_cache *, struct sign_cache_key *);
+
+extern void crypto_pool_statistics (struct crypto_pool *,
+                                    struct crypto_pool_stats *);
+
+#endif /* USE_SRX */
+#endif /* _QUAGGA_BGP_CRYPTO_POOL_H */
@@ -50,6 +50,9 @@ Software Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
 #include "bgpd/bgp_mplsvpn.h"
 #include "bgpd/bgp_advertise.h"
 #include "bgpd/bgp_vty.h"
+#ifdef USE_SRX
+#include "bgpd/bgp_validate.h"
+#endif
 
 int stream_put_prefix (struct stream *, struct prefix *);
 
@@ -191,6 +194,70 @@ int srxEcommunityRestore(struct attr *attr, struct ecommunity* ecom_orig)
 
   return ret;
 }
+
+/* Request the signature of the queued update from the crypto workers.
+   Returns the state of the signature, SIGN_CACHE_MISSING if the update is
+   not signed by the workers.  */
+static enum sign_cache_state
+bgp_update_sign_request (struct peer *peer, struct bgp_advertise *adv,
+                         u_int8_t pCount, u_int8_t flags, bool *submitted)
+{
+  struct attr *attr = adv->baa->attr;
+  struct peer *from = adv->binfo ? adv->binfo->peer : NULL;
+
+  *submitted = false;
+
+  /* Same decision as bgp_packet_attribute (), only BGPsec paths and
+     originations are signed.  */
+  if (! attr->bgpsecPathAttr && attr->aspath && attr->aspath->str_len)
+    return SIGN_CACHE_MISSING;
+  if (! bgp_attr_bgpsec_capable (peer, from, attr))
+    return SIGN_CACHE_MISSING;
+
+  return requestBGPSecSignature (peer->bgp, peer, &adv->rn->p, attr,
+                                 pCount, flags, submitted);
+}
+
+/* Hand the signing of the next updates to the peer to the crypto workers.
+   Returns true if the first update still waits for its signature, the
+   signature completion restarts the write thread of the peer.  */
+static bool
+bgp_update_sign_pending (struct peer *peer, afi_t afi, safi_t safi)
+{
+  struct bgp_advertise *fifo;
+  struct bgp_advertise *head;
+  struct bgp_advertise *adv;
+  u_int8_t pCount, flags;
+  enum sign_cache_state state;
+  bool submitted;
+  int count;
+
+  if (peer->bgp->srx_signPrefetch == 0
+      || (peer->sort != BGP_PEER_EBGP && peer->sort != BGP_PEER_CONFED))
+    return false;
+
+  fifo = (struct bgp_advertise *) &peer->sync[afi][safi]->update;
+  head = FIFO_HEAD (&peer->sync[afi][safi]->update);
+  bgp_attr_bgpsec_segment (peer, &pCount, &flags);
+  state = bgp_update_sign_request (peer, head, pCount, flags, &submitted);
+
+  /* Find the end of the prefetch window.  */
+  for (adv = head, count = 1;
+       adv->fifo.next != fifo && count < peer->bgp->srx_signPrefetch;
+       adv = adv->fifo.next, count++)
+    ;
+
+  /* The updates are requested in queue order, walking back from the end of
+     the window stops at the first one requested before.  */
+  for (; adv != head; adv = adv->fifo.prev)
+    {
+      if (bgp_update_sign_request (peer, adv, pCount, flags, &submitted)
+          != SIGN_CACHE_MISSING && ! submitted)
+        break;
+    }
+
+  return state == SIGN_CACHE_PENDING;
+}
 #endif
 
 /* Make BGP update packet.  */
@@ -738,6 +805,11 @@ bgp_write_packet (struct peer *peer)
     for (safi = SAFI_UNICAST; safi < SAFI_MAX; safi++)
       {
 	adv = FIFO_HEAD (&peer->sync[afi][safi]->update);
+#ifdef USE_SRX
+	/* Wait for the signature, no End-of-RIB while updates are pending */
+	if (adv && bgp_update_sign_pending (peer, afi, safi))
+	  continue;
+#endif
 	if (adv)
 	  {
             if (adv->binfo && adv->binfo->uptime < peer->synctime)
@@ -2778,6 +2850,11 @@ bgp_read (struct thread *thread)
     case BGP_MSG_UPDATE:
       peer->readtime = bgp_recent_clock ();
       bgp_update_receive (peer, size);
+#ifdef USE_SRX
+      /* Send the verify requests collected for this UPDATE. */
+      if (peer->bgp != NULL && peer->bgp->srxProxy != NULL)
+        flushVerifyBatch (peer->bgp->srxProxy);
+#endif /* USE_SRX */
       break;
     case BGP_MSG_NOTIFY:
       bgp_notify_receive (peer, size);
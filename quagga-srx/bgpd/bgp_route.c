@@ -251,6 +251,15 @@ int respawnReceivePacket(struct thread *t)
 	// TODO: after a certain amount time or try, clean up client connection
 	//
     }
+    else if (hasPendingPackets(rq->proxy))
+    {
+      // The receive budget is used up but more messages are buffered. The
+      // socket might not become readable again, therefore schedule an event
+      // to continue after the other pending threads got their turn.
+      rq->t_read = thr = thread_add_event (bm->master, respawnReceivePacket, 
+                                           rq, clientFD);
+      g_current_read_thread = thr;
+    }
     else
     {
       rq->t_read = thr = thread_add_read (bm->master, respawnReceivePacket, rq,
@@ -440,14 +449,13 @@ void threadControlCall(int type)
     if(type == COM_ERR_PROXY_UNKNOWN && rq->clientFD != 0)
     {
       // Never will happen because this error is never send!!!
-      FD_CLR (rq->clientFD, &bm->master->readfd);
+      thread_ignore_read (bm->master, rq->clientFD);
       zlog_debug (" FD_CLR called for avoiding select() error" );
     }
     else if(type == COM_ERR_PROXY_COULD_NOT_SEND)
     {
-      if( FD_ISSET(rq->clientFD, &bm->master->readfd) )
+      if (thread_ignore_read (bm->master, rq->clientFD))
       {
-        FD_CLR (rq->clientFD, &bm->master->readfd);
         zlog_debug (" FD_CLR called for avoiding select() error" );
       }
       return;
@@ -1017,17 +1025,147 @@ bool isSrxValChanged (SRxResult old, SRxResult new)
   return ret;
 }
 
+/* A route node waiting for its best path to be re-evaluated. */
+struct srx_requeue_entry
+{
+  struct bgp *bgp;
+  struct bgp_node *rn;
+  afi_t afi;
+  safi_t safi;
+};
+
+/* Route nodes collected during a burst of validation results. Each node is
+   contained at most once, marked by BGP_NODE_SRX_REQUEUE. */
+static struct
+{
+  struct srx_requeue_entry *entries;
+  unsigned int count;
+  unsigned int size;
+  struct thread *t_flush;
+  struct srx_requeue_stats stats;
+} srx_requeue;
+
+#define SRX_REQUEUE_INIT_SIZE 256
+
 /**
- * Add the given update back into the process queue.
+ * Timer function that hands the collected route nodes to the process queue.
+ *
+ * @param thread The timer thread.
+ *
+ * @return 0
+ */
+static int srx_bgp_requeue_timer (struct thread *thread)
+{
+  srx_requeue.t_flush = NULL;
+  srx_bgp_requeue_flush ();
+
+  return 0;
+}
+
+/**
+ * Hand all collected route nodes to the process queue, each node once.
+ */
+void srx_bgp_requeue_flush (void)
+{
+  struct srx_requeue_entry *entry;
+  struct bgp_table *table;
+  unsigned int idx;
+
+  THREAD_TIMER_OFF (srx_requeue.t_flush);
+  if (srx_requeue.count == 0)
+  {
+    return;
+  }
+
+  for (idx = 0; idx < srx_requeue.count; idx++)
+  {
+    entry = &srx_requeue.entries[idx];
+    table = bgp_node_table (entry->rn);
+    UNSET_FLAG (entry->rn->flags, BGP_NODE_SRX_REQUEUE);
+    bgp_process (entry->bgp, entry->rn, entry->afi, entry->safi);
+
+    bgp_unlock (entry->bgp);
+    bgp_unlock_node (entry->rn);
+    bgp_table_unlock (table);
+  }
+
+  srx_requeue.stats.nodes  += srx_requeue.count;
+  srx_requeue.stats.bursts++;
+  if (srx_requeue.count > srx_requeue.stats.maxBurst)
+  {
+    srx_requeue.stats.maxBurst = srx_requeue.count;
+  }
+  srx_requeue.count = 0;
+}
+
+/**
+ * Fill the given statistics with the counters of the coalesced requeue.
+ *
+ * @param stats The statistics to be filled.
+ */
+void srx_bgp_requeue_statistics (struct srx_requeue_stats *stats)
+{
+  *stats = srx_requeue.stats;
+  stats->pending = srx_requeue.count;
+}
+
+/**
+ * Add the given update back into the process queue. The route node is
+ * collected for the configured requeue window so a burst of validation
+ * results for routes of the same prefix re-runs the best path selection only
+ * once. A window of 0 hands the node to the process queue immediately.
  *
  * @param info the BGP update.
  */
 void srx_bgp_requeue_update(struct bgp_info *info)
 {
+  struct bgp *bgp = info->peer->bgp;
+  struct bgp_node *rn = info->node;
   struct bgp_table *table;
+  struct srx_requeue_entry *entry;
+
   table = (struct bgp_table *)info->node->table->info;
+  srx_requeue.stats.requests++;
 
-  bgp_process (info->peer->bgp, info->node, table->afi, table->safi);
+  if (CHECK_FLAG (rn->flags, BGP_NODE_SRX_REQUEUE))
+  {
+    srx_requeue.stats.coalesced++;
+    return;
+  }
+
+  if (bgp->srx_requeueWindow == 0)
+  {
+    srx_requeue.stats.nodes++;
+    bgp_process (bgp, rn, table->afi, table->safi);
+    return;
+  }
+
+  if (srx_requeue.count == srx_requeue.size)
+  {
+    srx_requeue.size = srx_requeue.size == 0 ? SRX_REQUEUE_INIT_SIZE
+                                             : srx_requeue.size * 2;
+    srx_requeue.entries = XREALLOC (MTYPE_BGP_PROCESS_QUEUE,
+                                    srx_requeue.entries,
+                                    srx_requeue.size
+                                      * sizeof (struct srx_requeue_entry));
+  }
+
+  /* all unlocked in srx_bgp_requeue_flush */
+  entry = &srx_requeue.entries[srx_requeue.count++];
+  bgp_table_lock (table);
+  entry->rn   = bgp_lock_node (rn);
+  entry->bgp  = bgp;
+  bgp_lock (bgp);
+  entry->afi  = table->afi;
+  entry->safi = table->safi;
+  SET_FLAG (rn->flags, BGP_NODE_SRX_REQUEUE);
+
+  if (srx_requeue.t_flush == NULL)
+  {
+    srx_requeue.t_flush = thread_add_timer_msec (bm->master,
+                                                 srx_bgp_requeue_timer, NULL,
+                                                 bgp->srx_requeueWindow);
+  }
 }
 
 /**
@@ -4392,6 +4530,12 @@ bgp_soft_reconfig_in (struct peer *peer, afi_t afi, safi_t safi)
 
           bgp_soft_reconfig_table (peer, afi, safi, table, &prd);
         }
+
+#ifdef USE_SRX
+  /* Send the verify requests collected during the soft reconfiguration. */
+  if (peer->bgp != NULL && peer->bgp->srxProxy != NULL)
+    flushVerifyBatch (peer->bgp->srxProxy);
+#endif /* USE_SRX */
 }
 
 
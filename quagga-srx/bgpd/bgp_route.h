@@ -244,8 +244,28 @@ extern void bgp_info_set_flag (struct bgp_node *, struct bgp_info *, u_int32_t);
 extern void bgp_info_unset_flag (struct bgp_node *, struct bgp_info *, u_int32_t);
 #ifdef USE_SRX
 extern int  bgp_info_set_ignore_flag(struct bgp_info *);
+/* Counters of the coalesced best path re-evaluation after validation
+   results changed. */
+struct srx_requeue_stats
+{
+  /* Requeue requests for a route node */
+  unsigned long requests;
+  /* Requests for a route node already waiting in the requeue window */
+  unsigned long coalesced;
+  /* Route nodes handed to the process queue */
+  unsigned long nodes;
+  /* Requeue windows that expired */
+  unsigned long bursts;
+  /* Largest number of route nodes handed over by one window */
+  unsigned int  maxBurst;
+  /* Route nodes currently waiting in the requeue window */
+  unsigned int  pending;
+};
+
 extern void srx_bgp_requeue_update(struct bgp_info *);
 extern void srx_bgp_requeue_all(struct bgp *);
+extern void srx_bgp_requeue_flush (void);
+extern void srx_bgp_requeue_statistics (struct srx_requeue_stats *);
 extern void bgp_info_set_validation_result (struct bgp_info *,
                                        ValidationResultType resType,
                                        uint8_t roaResult, uint8_t bgpsecResult, uint8_t);
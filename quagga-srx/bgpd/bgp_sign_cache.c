@@ -0,0 +1,551 @@
+/**
+ * This software was developed at the National Institute of Standards and
+ * Technology by employees of the Federal Government in the course of
+ * their official duties. Pursuant to title 17 Section 105 of the United
+ * States Code this software is not subject to copyright protection and
+ * is in the public domain.
+ *
+ * NIST assumes no responsibility whatsoever for its use by other parties,
+ * and makes no guarantees, expressed or implied, about its quality,
+ * reliability, or any other characteristic.
+ *
+ * We would appreciate acknowledgment if the software is used.
+ *
+ * NIST ALLOWS FREE USE OF THIS SOFTWARE IN ITS "AS IS" CONDITION AND
+ * DISCLAIM ANY LIABILITY OF ANY KIND FOR ANY DAMAGES WHATSOEVER RESULTING
+ * FROM THE USE OF THIS SOFTWARE.
+ *
+ * This software might use libraries that are under GNU public license or
+ * other licenses. Please refer to the licenses of all libraries required
+ * by this software.
+ *
+ * Cache of outbound BGPsec signatures. The entries keep a copy of the
+ * received BGPsec path attribute, a changed attribute therefore never matches
+ * an old entry. The entries are kept in least recently used order and the
+ * oldest entries are removed once the memory limit is reached. Signatures that
+ * are generated by the crypto workers are reserved as pending entries until
+ * the signature is added.
+ *
+ * @version 0.6.0.4
+ *
+ * Changelog:
+ * -----------------------------------------------------------------------------
+ * 0.6.0.4 - 2026/10/17
+ *           * File created
+ */
+#include <zebra.h>
+
+#ifdef USE_SRX
+
+#include "hash.h"
+#include "jhash.h"
+
+#include "bgpd/bgp_sign_cache.h"
+
+struct sign_cache_entry
+{
+  /* Least recently used list, the head is the most recently used entry */
+  struct sign_cache_entry *prev;
+  struct sign_cache_entry *next;
+
+  struct sign_cache_key key;
+  unsigned int hashKey;
+
+  /* NULL as long as the signature is pending or failed */
+  u_int16_t sigLen;
+  u_int8_t  *sigBuff;
+  bool      failed;
+
+  /* Memory used by this entry */
+  unsigned long size;
+};
+
+struct sign_cache
+{
+  struct hash *hash;
+  struct sign_cache_entry *head;
+  struct sign_cache_entry *tail;
+  struct sign_cache_stats stats;
+};
+
+/**
+ * Calculate the hash value of the key.
+ *
+ * @param key The key.
+ *
+ * @return the hash value.
+ */
+static unsigned int _sign_cache_hash_key (struct sign_cache_key *key)
+{
+  unsigned int hashKey;
+
+  hashKey = jhash_3words (key->targetAS,
+                          (key->pCount << 16) | (key->flags << 8)
+                            | key->algoID,
+                          key->nlri.length, 0);
+  hashKey = jhash (key->ski, SKI_LENGTH, hashKey);
+  hashKey = jhash (key->nlri.addr.ip, (key->nlri.length + 7) / 8, hashKey);
+  if (key->path != NULL)
+  {
+    hashKey = jhash (key->path, key->pathLen, hashKey);
+  }
+
+  return hashKey;
+}
+
+static unsigned int sign_cache_hash_key (void *data)
+{
+  return ((struct sign_cache_entry *)data)->hashKey;
+}
+
+static int sign_cache_hash_cmp (const void *arg1, const void *arg2)
+{
+  const struct sign_cache_key *key1 = &((struct sign_cache_entry *)arg1)->key;
+  const struct sign_cache_key *key2 = &((struct sign_cache_entry *)arg2)->key;
+
+  return key1->targetAS == key2->targetAS
+         && key1->pCount == key2->pCount
+         && key1->flags  == key2->flags
+         && key1->algoID == key2->algoID
+         && memcmp (key1->ski, key2->ski, SKI_LENGTH) == 0
+         && key1->nlri.afi    == key2->nlri.afi
+         && key1->nlri.safi   == key2->nlri.safi
+         && key1->nlri.length == key2->nlri.length
+         && memcmp (key1->nlri.addr.ip, key2->nlri.addr.ip,
+                    (key1->nlri.length + 7) / 8) == 0
+         && key1->pathLen == key2->pathLen
+         && (key1->path == NULL) == (key2->path == NULL)
+         && (key1->path == NULL
+             || memcmp (key1->path, key2->path, key1->pathLen) == 0);
+}
+
+/**
+ * Remove the entry from the least recently used list.
+ *
+ * @param cache The signature cache.
+ * @param entry The entry.
+ */
+static void _sign_cache_unlink (struct sign_cache *cache,
+                                struct sign_cache_entry *entry)
+{
+  if (entry->prev != NULL)
+  {
+    entry->prev->next = entry->next;
+  }
+  else
+  {
+    cache->head = entry->next;
+  }
+  if (entry->next != NULL)
+  {
+    entry->next->prev = entry->prev;
+  }
+  else
+  {
+    cache->tail = entry->prev;
+  }
+  entry->prev = NULL;
+  entry->next = NULL;
+}
+
+/**
+ * Add the entry as most recently used entry to the list.
+ *
+ * @param cache The signature cache.
+ * @param entry The entry.
+ */
+static void _sign_cache_push (struct sign_cache *cache,
+                              struct sign_cache_entry *entry)
+{
+  entry->prev = NULL;
+  entry->next = cache->head;
+  if (cache->head != NULL)
+  {
+    cache->head->prev = entry;
+  }
+  else
+  {
+    cache->tail = entry;
+  }
+  cache->head = entry;
+}
+
+/**
+ * Remove the entry from the cache and release it.
+ *
+ * @param cache The signature cache.
+ * @param entry The entry.
+ */
+static void _sign_cache_remove (struct sign_cache *cache,
+                                struct sign_cache_entry *entry)
+{
+  hash_release (cache->hash, entry);
+  _sign_cache_unlink (cache, entry);
+
+  cache->stats.entries--;
+  cache->stats.memory -= entry->size;
+
+  if (entry->sigBuff != NULL)
+  {
+    memset (entry->sigBuff, 0, entry->sigLen);
+    free (entry->sigBuff);
+  }
+  free (entry->key.path);
+  free (entry);
+}
+
+/**
+ * Remove the least recently used entries until the given memory is available.
+ *
+ * @param cache The signature cache.
+ * @param size The memory needed.
+ */
+static void _sign_cache_evict (struct sign_cache *cache, unsigned long size)
+{
+  while (cache->tail != NULL
+         && cache->stats.memory + size > cache->stats.maxMemory)
+  {
+    _sign_cache_remove (cache, cache->tail);
+    cache->stats.evictions++;
+  }
+}
+
+/**
+ * Find the entry of the given key.
+ *
+ * @param cache The signature cache.
+ * @param key The key of the signature.
+ *
+ * @return the entry or NULL.
+ */
+static struct sign_cache_entry* _sign_cache_find (struct sign_cache *cache,
+                                                  struct sign_cache_key *key)
+{
+  struct sign_cache_entry lookup;
+
+  lookup.key     = *key;
+  lookup.hashKey = _sign_cache_hash_key (key);
+
+  return hash_lookup (cache->hash, &lookup);
+}
+
+/**
+ * Create an entry without signature that contains a copy of the key.
+ *
+ * @param key The key of the entry.
+ *
+ * @return the entry or NULL if out of memory.
+ */
+static struct sign_cache_entry* _sign_cache_entry_new (
+                                                    struct sign_cache_key *key)
+{
+  struct sign_cache_entry *entry = calloc (1, sizeof(struct sign_cache_entry));
+
+  if (entry == NULL)
+  {
+    return NULL;
+  }
+  entry->key      = *key;
+  entry->key.path = NULL;
+  entry->hashKey  = _sign_cache_hash_key (key);
+  entry->size     = sizeof(struct sign_cache_entry) + key->pathLen;
+  if (key->path != NULL)
+  {
+    entry->key.path = malloc (key->pathLen);
+    if (entry->key.path == NULL)
+    {
+      free (entry);
+      return NULL;
+    }
+    memcpy (entry->key.path, key->path, key->pathLen);
+  }
+
+  return entry;
+}
+
+/**
+ * Add the entry as most recently used entry to the cache. Older entries are
+ * removed to stay within the memory limit.
+ *
+ * @param cache The signature cache.
+ * @param entry The entry.
+ */
+static void _sign_cache_insert (struct sign_cache *cache,
+                                struct sign_cache_entry *entry)
+{
+  _sign_cache_evict (cache, entry->size);
+  hash_get (cache->hash, entry, hash_alloc_intern);
+  _sign_cache_push (cache, entry);
+  cache->stats.entries++;
+  cache->stats.memory += entry->size;
+}
+
+/**
+ * Create the signature cache.
+ *
+ * @param maxMemory The memory limit in bytes.
+ *
+ * @return the signature cache.
+ */
+struct sign_cache* sign_cache_new (unsigned long maxMemory)
+{
+  struct sign_cache *cache = calloc (1, sizeof(struct sign_cache));
+
+  if (cache != NULL)
+  {
+    cache->hash = hash_create (sign_cache_hash_key, sign_cache_hash_cmp);
+    cache->stats.maxMemory = maxMemory;
+  }
+
+  return cache;
+}
+
+/**
+ * Release the signature cache and all entries.
+ *
+ * @param cache Pointer to the signature cache, will be set to NULL.
+ */
+void sign_cache_free (struct sign_cache **cache)
+{
+  if (*cache != NULL)
+  {
+    sign_cache_flush (*cache);
+    hash_free ((*cache)->hash);
+    free (*cache);
+    *cache = NULL;
+  }
+}
+
+/**
+ * Set the memory limit, entries exceeding it are removed.
+ *
+ * @param cache The signature cache.
+ * @param maxMemory The memory limit in bytes.
+ */
+void sign_cache_set_max_memory (struct sign_cache *cache,
+                                unsigned long maxMemory)
+{
+  cache->stats.maxMemory = maxMemory;
+  _sign_cache_evict (cache, 0);
+}
+
+/**
+ * Remove all entries. This is required once the router keys change.
+ *
+ * @param cache The signature cache.
+ */
+void sign_cache_flush (struct sign_cache *cache)
+{
+  if (cache == NULL)
+  {
+    return;
+  }
+
+  while (cache->head != NULL)
+  {
+    _sign_cache_remove (cache, cache->head);
+  }
+  cache->stats.flushes++;
+}
+
+/**
+ * Look up the signature for the given key.
+ *
+ * @param cache The signature cache.
+ * @param key The key of the signature.
+ *
+ * @return A copy of the signature that is not owned by the API or NULL if
+ *         the cache does not contain the signature.
+ */
+SCA_Signature* sign_cache_lookup (struct sign_cache *cache,
+                                  struct sign_cache_key *key)
+{
+  struct sign_cache_entry *entry;
+  SCA_Signature *signature;
+
+  entry = _sign_cache_find (cache, key);
+  if (entry == NULL || entry->sigBuff == NULL)
+  {
+    cache->stats.misses++;
+    return NULL;
+  }
+
+  signature = calloc (1, sizeof(SCA_Signature));
+  if (signature != NULL)
+  {
+    signature->sigBuff = malloc (entry->sigLen);
+  }
+  if (signature == NULL || signature->sigBuff == NULL)
+  {
+    free (signature);
+    cache->stats.misses++;
+    return NULL;
+  }
+  signature->ownedByAPI = false;
+  signature->algoID     = entry->key.algoID;
+  signature->sigLen     = entry->sigLen;
+  memcpy (signature->ski, entry->key.ski, SKI_LENGTH);
+  memcpy (signature->sigBuff, entry->sigBuff, entry->sigLen);
+
+  _sign_cache_unlink (cache, entry);
+  _sign_cache_push (cache, entry);
+  cache->stats.hits++;
+
+  return signature;
+}
+
+/**
+ * Store a copy of the signature for the given key. A pending or failed entry
+ * of the key receives the signature.
+ *
+ * @param cache The signature cache.
+ * @param key The key of the signature.
+ * @param signature The signature.
+ */
+void sign_cache_add (struct sign_cache *cache, struct sign_cache_key *key,
+                     SCA_Signature *signature)
+{
+  struct sign_cache_entry *entry;
+  u_int8_t *sigBuff;
+
+  if (sizeof(struct sign_cache_entry) + signature->sigLen + key->pathLen
+      > cache->stats.maxMemory)
+  {
+    return;
+  }
+
+  entry = _sign_cache_find (cache, key);
+  if (entry != NULL && entry->sigBuff != NULL)
+  {
+    // Another signature for the same data, keep the known one.
+    return;
+  }
+
+  sigBuff = malloc (signature->sigLen);
+  if (sigBuff == NULL)
+  {
+    return;
+  }
+  memcpy (sigBuff, signature->sigBuff, signature->sigLen);
+
+  if (entry != NULL)
+  {
+    // Fill the reserved entry, it is taken out while the memory is made
+    // available for the signature.
+    hash_release (cache->hash, entry);
+    _sign_cache_unlink (cache, entry);
+    cache->stats.entries--;
+    cache->stats.memory -= entry->size;
+  }
+  else
+  {
+    entry = _sign_cache_entry_new (key);
+    if (entry == NULL)
+    {
+      free (sigBuff);
+      return;
+    }
+  }
+  entry->sigLen  = signature->sigLen;
+  entry->sigBuff = sigBuff;
+  entry->failed  = false;
+  entry->size    = sizeof(struct sign_cache_entry) + entry->sigLen
+                   + entry->key.pathLen;
+
+  _sign_cache_insert (cache, entry);
+}
+
+/**
+ * Return the state of the signature for the given key without changing the
+ * counters or the order of the entries.
+ *
+ * @param cache The signature cache.
+ * @param key The key of the signature.
+ *
+ * @return the state of the signature.
+ */
+enum sign_cache_state sign_cache_state (struct sign_cache *cache,
+                                        struct sign_cache_key *key)
+{
+  struct sign_cache_entry *entry = _sign_cache_find (cache, key);
+
+  if (entry == NULL)
+  {
+    return SIGN_CACHE_MISSING;
+  }
+  if (entry->sigBuff != NULL)
+  {
+    return SIGN_CACHE_PRESENT;
+  }
+
+  return entry->failed ? SIGN_CACHE_FAILED : SIGN_CACHE_PENDING;
+}
+
+/**
+ * Reserve a pending entry for a signature that is generated in the
+ * background.
+ *
+ * @param cache The signature cache.
+ * @param key The key of the signature.
+ *
+ * @return true if the entry was reserved, false if the key is already known
+ *         or the entry could not be created.
+ */
+bool sign_cache_reserve (struct sign_cache *cache, struct sign_cache_key *key)
+{
+  struct sign_cache_entry *entry;
+
+  if (sizeof(struct sign_cache_entry) + key->pathLen > cache->stats.maxMemory
+      || _sign_cache_find (cache, key) != NULL)
+  {
+    return false;
+  }
+
+  entry = _sign_cache_entry_new (key);
+  if (entry == NULL)
+  {
+    return false;
+  }
+  _sign_cache_insert (cache, entry);
+  cache->stats.reserved++;
+
+  return true;
+}
+
+/**
+ * Mark the pending entry of the key as failed. The signature is then
+ * generated inline again, which reports the error.
+ *
+ * @param cache The signature cache.
+ * @param key The key of the signature.
+ */
+void sign_cache_fail (struct sign_cache *cache, struct sign_cache_key *key)
+{
+  struct sign_cache_entry *entry = _sign_cache_find (cache, key);
+
+  if (entry != NULL && entry->sigBuff == NULL)
+  {
+    entry->failed = true;
+  }
+}
+
+/**
+ * Fill the given statistics with the counters of the cache.
+ *
+ * @param cache The signature cache, NULL if no cache is used.
+ * @param stats The statistics to be filled.
+ */
+void sign_cache_statistics (struct sign_cache *cache,
+                            struct sign_cache_stats *stats)
+{
+  if (cache == NULL)
+  {
+    memset (stats, 0, sizeof(struct sign_cache_stats));
+  }
+  else
+  {
+    *stats = cache->stats;
+  }
+}
+
+#endif /* USE_SRX */
@@ -0,0 +1,119 @@
+/**
+ * This software was developed at the National Institute of Standards and
+ * Technology by employees of the Federal Government in the course of
+ * their official duties. Pursuant to title 17 Section 105 of the United
+ * States Code this software is not subject to copyright protection and
+ * is in the public domain.
+ *
+ * NIST assumes no responsibility whatsoever for its use by other parties,
+ * and makes no guarantees, expressed or implied, about its quality,
+ * reliability, or any other characteristic.
+ *
+ * We would appreciate acknowledgment if the software is used.
+ *
+ * NIST ALLOWS FREE USE OF THIS SOFTWARE IN ITS "AS IS" CONDITION AND
+ * DISCLAIM ANY LIABILITY OF ANY KIND FOR ANY DAMAGES WHATSOEVER RESULTING
+ * FROM THE USE OF THIS SOFTWARE.
+ *
+ * This software might use libraries that are under GNU public license or
+ * other licenses. Please refer to the licenses of all libraries required
+ * by this software.
+ *
+ * Cache of outbound BGPsec signatures. A signature only depends on the target
+ * AS, the prefix, the own secure path segment, the signing key and the
+ * received BGPsec path. Updates sent to several peers of the same AS are
+ * therefore signed only once.
+ *
+ * @version 0.6.0.4
+ *
+ * Changelog:
+ * -----------------------------------------------------------------------------
+ * 0.6.0.4 - 2026/10/17
+ *           * File created
+ */
+#ifndef _QUAGGA_BGP_SIGN_CACHE_H
+#define _QUAGGA_BGP_SIGN_CACHE_H
+
+#include "config.h"
+
+#ifdef USE_SRX
+
+#include <zebra.h>
+#include <srx/srxcryptoapi.h>
+
+/* Default memory limit of the signature cache in kilobytes */
+#define SRX_SIGN_CACHE_KB      4096
+/* Largest configurable memory limit in kilobytes */
+#define SRX_SIGN_CACHE_KB_MAX  1048576
+
+struct sign_cache;
+
+/* State of a signature within the cache */
+enum sign_cache_state
+{
+  SIGN_CACHE_MISSING,
+  /* Reserved, the signature is generated by a crypto worker */
+  SIGN_CACHE_PENDING,
+  /* The crypto worker could not generate the signature */
+  SIGN_CACHE_FAILED,
+  SIGN_CACHE_PRESENT
+};
+
+/* Everything a signature depends on */
+struct sign_cache_key
+{
+  /* The AS the signature is made for, network format */
+  u_int32_t targetAS;
+  u_int8_t  pCount;
+  u_int8_t  flags;
+  u_int8_t  algoID;
+  u_int8_t  ski[SKI_LENGTH];
+  SCA_Prefix nlri;
+  /* The received BGPsec path attribute, NULL for originations */
+  u_int8_t  *path;
+  u_int16_t pathLen;
+};
+
+/* Counters of the signature cache */
+struct sign_cache_stats
+{
+  unsigned long hits;
+  unsigned long misses;
+  /* Entries removed to stay within the memory limit */
+  unsigned long evictions;
+  /* Removals of all entries after a key change */
+  unsigned long flushes;
+  /* Entries reserved for signatures generated by the crypto workers */
+  unsigned long reserved;
+  unsigned long entries;
+  /* Memory used by the entries in bytes */
+  unsigned long memory;
+  /* The memory limit in bytes */
+  unsigned long maxMemory;
+};
+
+/* Create and destroy the signature cache */
+extern struct sign_cache* sign_cache_new (unsigned long maxMemory);
+extern void sign_cache_free (struct sign_cache **);
+
+extern void sign_cache_set_max_memory (struct sign_cache *,
+                                       unsigned long maxMemory);
+extern void sign_cache_flush (struct sign_cache *);
+
+/* Look up and store signatures */
+extern SCA_Signature* sign_cache_lookup (struct sign_cache *,
+                                         struct sign_cache_key *);
+extern void sign_cache_add (struct sign_cache *, struct sign_cache_key *,
+                            SCA_Signature *);
+
+/* Reserve entries for signatures generated in the background */
+extern enum sign_cache_state sign_cache_state (struct sign_cache *,
+                                               struct sign_cache_key *);
+extern bool sign_cache_reserve (struct sign_cache *, struct sign_cache_key *);
+extern void sign_cache_fail (struct sign_cache *, struct sign_cache_key *);
+
+extern void sign_cache_statistics (struct sign_cache *,
+                                   struct sign_cache_stats *);
+
+#endif /* USE_SRX */
+#endif /* _QUAGGA_BGP_SIGN_CACHE_H */
@@ -65,6 +65,7 @@ struct bgp_node
 
   u_char flags;
 #define BGP_NODE_PROCESS_SCHEDULED	(1 << 0)
+#define BGP_NODE_SRX_REQUEUE		(1 << 1)
 };
 
 /*
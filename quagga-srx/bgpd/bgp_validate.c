@@ -15,6 +15,8 @@
 #include "bgpd/bgp_debug.h"
 #include "bgpd/bgp_aspath.h"
 #include "bgpd/bgp_validate.h"
+#include "bgpd/bgp_sign_cache.h"
+#include "bgpd/bgp_crypto_pool.h"
 
 #include <srx/srxcryptoapi.h>
 SRxCryptoAPI *g_capi;
@@ -805,9 +807,63 @@ struct BgpsecPathAttr* bgpsec_parse(struct attr *attr, struct peer *peer,
   return bpa;
 }
 
+/**
+ * Fill the signature cache key with the data the signature is generated for.
+ *
+ * @param key The key to be filled.
+ * @param signData The signing data.
+ * @param pathAttr The received BGPsec path attribute, NULL for originations.
+ */
+static void _initSignCacheKey(struct sign_cache_key* key,
+                              SCA_BGPSecSignData* signData, u_int8_t* pathAttr)
+{
+  SCA_BGP_PathAttribute* pa = (SCA_BGP_PathAttribute*)pathAttr;
+
+  memset(key, 0, sizeof(struct sign_cache_key));
+  key->targetAS = signData->peerAS;
+  key->pCount   = signData->myHost->pCount;
+  key->flags    = signData->myHost->flags;
+  key->algoID   = signData->algorithmID;
+  memcpy(key->ski, signData->ski, SKI_LENGTH);
+  if (signData->nlri != NULL)
+  {
+    key->nlri = *signData->nlri;
+  }
+
+  if (pa != NULL)
+  {
+    key->path = pathAttr;
+    if ((pa->flags & SCA_BGP_UPD_A_FLAGS_EXT_LENGTH) > 0)
+    {
+      key->pathLen = sizeof(SCA_BGPSEC_ExtPathAttribute)
+                     + ntohs(((SCA_BGPSEC_ExtPathAttribute*)pa)->attrLength);
+    }
+    else
+    {
+      key->pathLen = sizeof(SCA_BGPSEC_NormPathAttribute)
+                     + ((SCA_BGPSEC_NormPathAttribute*)pa)->attrLength;
+    }
+  }
+}
+
+/**
+ * Release the validation data that was generated for an origination.
+ *
+ * @param attr The attribute containing the temporary validation data.
+ */
+static void _freeTmpValidationData(struct attr* attr)
+{
+  free (attr->bgpsec_validationData->nlri);
+  attr->bgpsec_validationData->nlri = NULL;
+  free (attr->bgpsec_validationData);
+  attr->bgpsec_validationData = NULL;
+}
+
 /**
  * This method does call the signing of the BGPSEC path attribute. This method
- * assumes that the peer is NOT an iBGP peer.
+ * assumes that the peer is NOT an iBGP peer. Signatures already generated for
+ * the same target AS, prefix, path segment, key, and received path are taken
+ * from the signature cache.
  *
  * @param bgp The bgp session.
  * @param peer The peer to sign it too
@@ -908,6 +964,23 @@ SCA_Signature* signBGPSecPathAttr(struct bgp* bgp, struct peer* peer,
   // hashMessage will not be NULL. If it is null, the signature algorithm
   // assumes it is an origination.
   scaSignData.signature   = NULL;
+
+  struct sign_cache_key cacheKey;
+  if (bgp->srx_signCache != NULL)
+  {
+    _initSignCacheKey(&cacheKey, &scaSignData,
+                      attr->bgpsec_validationData->bgpsec_path_attr);
+    scaSignData.signature = sign_cache_lookup(bgp->srx_signCache, &cacheKey);
+    if (scaSignData.signature != NULL)
+    {
+      if (tmpData)
+      {
+        _freeTmpValidationData(attr);
+      }
+      return scaSignData.signature;
+    }
+  }
+
   if ( CHECK_FLAG(bgp->srx_config, SRX_CONFIG_EVAL_PATH_DISTR))
   {
   /* hash message for Distribution version */
@@ -950,6 +1023,11 @@ SCA_Signature* signBGPSecPathAttr(struct bgp* bgp, struct peer* peer,
     return 0;
   }
 
+  if (bgp->srx_signCache != NULL && scaSignData.signature != NULL)
+  {
+    sign_cache_add(bgp->srx_signCache, &cacheKey, scaSignData.signature);
+  }
+
   if ( !CHECK_FLAG(bgp->srx_config, SRX_CONFIG_EVAL_PATH_DISTR))
   {
   if (attr->bgpsec_validationData->hashMessage[BLOCK_0] != scaSignData.hashMessage)
@@ -978,16 +1056,111 @@ SCA_Signature* signBGPSecPathAttr(struct bgp* bgp, struct peer* peer,
   if (tmpData)
   {
     // THis is an origin announcement, clean up
-    free (attr->bgpsec_validationData->nlri);
-    attr->bgpsec_validationData->nlri = NULL;
-    free (attr->bgpsec_validationData);
-    attr->bgpsec_validationData = NULL;
+    _freeTmpValidationData(attr);
     scaSignData.hashMessage = NULL;
   }
 
   return scaSignData.signature;
 }
 
+/**
+ * Request the signature of the BGPSEC path attribute from the crypto workers.
+ * The signature is stored in the signature cache where signBGPSecPathAttr
+ * finds it once the update is built. This method assumes that the peer is
+ * NOT an iBGP peer.
+ *
+ * @param bgp The bgp session.
+ * @param peer The peer to sign it too
+ * @param pfx The prefix to sign over (only for origin anouncements)
+ * @param attr The attribute containing the path information.
+ * @param pCount The pCount of this update
+ * @param flags the update flags.
+ * @param submitted Returns true if this call handed the signing to the
+ *                  crypto workers.
+ *
+ * @return the state of the signature, SIGN_CACHE_PENDING while it is generated
+ *         by a crypto worker. SIGN_CACHE_MISSING if the signature is not
+ *         generated by the crypto workers and has to be generated inline.
+ */
+enum sign_cache_state requestBGPSecSignature(struct bgp* bgp, struct peer* peer,
+                            struct prefix* pfx, struct attr* attr,
+                            u_int8_t pCount, u_int8_t flags, bool* submitted)
+{
+  SCA_BGPSEC_SecurePathSegment spSeg;
+  SCA_BGPSecSignData    scaSignData;
+  SCA_Prefix            nlri;
+  struct sign_cache_key cacheKey;
+  u_int8_t*             pathAttr = NULL;
+  enum sign_cache_state state;
+
+  *submitted = false;
+  if (bgp->srxCAPI == NULL || bgp->srx_signCache == NULL
+      || bgp->srx_cryptoWorkers == 0)
+  {
+    return SIGN_CACHE_MISSING;
+  }
+
+  memset (&nlri, 0, sizeof(SCA_Prefix));
+  if (attr->bgpsec_validationData != NULL
+      && attr->bgpsec_validationData->nlri != NULL)
+  {
+    nlri     = *attr->bgpsec_validationData->nlri;
+    pathAttr = attr->bgpsec_validationData->bgpsec_path_attr;
+  }
+  else if (attr->bgpsec_validationData == NULL
+           || attr->bgpsec_validationData->bgpsec_path_attr == NULL)
+  {
+    // Origination, use the prefix the same way signBGPSecPathAttr does.
+    nlri.afi    = htons(family2afi(pfx->family));
+    nlri.safi   = SAFI_UNICAST;
+    nlri.length = (u_int8_t)pfx->prefixlen;
+    memcpy(nlri.addr.ip, pfx->u.val, (pfx->prefixlen + 7) / 8);
+  }
+  else
+  {
+    return SIGN_CACHE_MISSING;
+  }
+
+  spSeg.pCount = pCount;
+  spSeg.flags  = flags;
+  spSeg.asn    = htonl(bgp->as);
+
+  memset (&scaSignData, 0, sizeof(SCA_BGPSecSignData));
+  scaSignData.algorithmID = bgp->srx_bgpsec_key[bgp->srx_bgpsec_active_key].algoID;
+  scaSignData.myHost      = &spSeg;
+  scaSignData.peerAS      = htonl(peer->as);
+  scaSignData.nlri        = &nlri;
+  scaSignData.ski         = bgp->srx_bgpsec_key[bgp->srx_bgpsec_active_key].ski;
+  _initSignCacheKey(&cacheKey, &scaSignData, pathAttr);
+
+  // A failed signature is generated again inline which reports the error.
+  state = sign_cache_state(bgp->srx_signCache, &cacheKey);
+  if (state != SIGN_CACHE_MISSING)
+  {
+    return state;
+  }
+
+  if (bgp->srx_cryptoPool == NULL)
+  {
+    bgp->srx_cryptoPool = crypto_pool_new(bgp, bgp->srxCAPI,
+                                          bgp->srx_cryptoWorkers);
+  }
+  if (bgp->srx_cryptoPool == NULL
+      || !sign_cache_reserve(bgp->srx_signCache, &cacheKey))
+  {
+    return SIGN_CACHE_MISSING;
+  }
+  if (!crypto_pool_sign(bgp->srx_cryptoPool, peer, bgp->srx_signCache,
+                        &cacheKey))
+  {
+    sign_cache_fail(bgp->srx_signCache, &cacheKey);
+    return SIGN_CACHE_FAILED;
+  }
+  *submitted = true;
+
+  return SIGN_CACHE_PENDING;
+}
+
 /**
  * Construct the BGPSEC Path attribute. This includes signing the as path if it
  * is not signed already.
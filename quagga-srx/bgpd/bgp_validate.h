@@ -37,6 +37,8 @@
 
 #ifdef USE_SRX
 
+#include "bgpd/bgp_sign_cache.h"
+
 #define BGPSEC_SKI_LENGTH           20
 #define BGPSEC_ALGO_ID              1
 #define BGPSEC_ALGO_ID_LENGTH       1
@@ -234,6 +236,31 @@ SCA_Signature* signBGPSecPathAttr(struct bgp* bgp, struct peer* peer,
                                   struct prefix* pfx, struct attr* attr, 
                                   u_int8_t pCount, u_int8_t flags);
 
+/**
+ * Request the signature of the BGPSEC path attribute from the crypto workers.
+ * The signature is stored in the signature cache where signBGPSecPathAttr
+ * finds it once the update is built.
+ *
+ * @param bgp The bgp session.
+ * @param peer The peer to sign it too
+ * @param pfx The prefix to sign over (only for origin anouncements)
+ * @param attr The attribute containing the path information.
+ * @param pCount The pCount of this update
+ * @param flags the update flags.
+ * @param submitted Returns true if this call handed the signing to the
+ *                  crypto workers.
+ *
+ * @return the state of the signature, SIGN_CACHE_PENDING while it is generated
+ *         by a crypto worker. SIGN_CACHE_MISSING if the signature is not
+ *         generated by the crypto workers and has to be generated inline.
+ */
+enum sign_cache_state requestBGPSecSignature(struct bgp* bgp,
+                                             struct peer* peer,
+                                             struct prefix* pfx,
+                                             struct attr* attr,
+                                             u_int8_t pCount, u_int8_t flags,
+                                             bool* submitted);
+
 /**
  * This function is a wrapper for the corresponding CAPI function. This function
  * is needed to allow the memory management performed by the CAPI itself.
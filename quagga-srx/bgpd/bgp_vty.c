@@ -53,6 +53,8 @@ Software Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
 #include "bgpd/bgp_vty.h"
 #include "bgpd/bgp_mpath.h"
 #include "bgp_validate.h"
+#include "bgpd/bgp_crypto_pool.h"
+#include "bgpd/bgp_sign_cache.h"
 
 #ifdef USE_SRX
   #define _SRX_BLANKS "                   "
@@ -1460,9 +1462,76 @@ DEFUN (srx_show_config,
            (bgp->srx_proxyID >>  8) & 0xFF,
            (bgp->srx_proxyID) & 0xFF, bgp->srx_proxyID, VTY_NEWLINE);
   vty_out (vty, "  keep-window....: %d%s", bgp->srx_keepWindow, VTY_NEWLINE);
+  vty_out (vty, "  receive-budget.: %d%s", bgp->srx_receiveBudget, 
+           VTY_NEWLINE);
+  vty_out (vty, "  requeue-window.: %d ms%s", bgp->srx_requeueWindow, 
+           VTY_NEWLINE);
+  vty_out (vty, "  crypto-workers.: %d%s", bgp->srx_cryptoWorkers, 
+           VTY_NEWLINE);
+  vty_out (vty, "  sign-cache.....: %d KB%s", bgp->srx_signCacheKB, 
+           VTY_NEWLINE);
+  vty_out (vty, "  sign-prefetch..: %d%s", bgp->srx_signPrefetch, 
+           VTY_NEWLINE);
   vty_out (vty, "  connected......: %s%s", (isConnected(bgp->srxProxy)
                                           ? "true" : "false"), VTY_NEWLINE);
 
+  SRxProxyReceiveStats rcvStats;
+  getReceiveStatistics(bgp->srxProxy, &rcvStats);
+  vty_out (vty, "SRx-Server receive statistics:%s", VTY_NEWLINE);
+  vty_out (vty, "  read events....: %llu%s", 
+           (unsigned long long)rcvStats.wakeups, VTY_NEWLINE);
+  vty_out (vty, "  socket reads...: %llu%s", 
+           (unsigned long long)rcvStats.reads, VTY_NEWLINE);
+  vty_out (vty, "  messages.......: %llu%s", 
+           (unsigned long long)rcvStats.pdus, VTY_NEWLINE);
+  vty_out (vty, "  notifications..: %llu%s", 
+           (unsigned long long)rcvStats.notifications, VTY_NEWLINE);
+  vty_out (vty, "  per read event.: %.2f (max %u messages)%s",
+           rcvStats.wakeups > 0 
+             ? (double)rcvStats.notifications / rcvStats.wakeups : 0.0,
+           rcvStats.maxPerWakeup, VTY_NEWLINE);
+  vty_out (vty, "  budget reached.: %llu%s", 
+           (unsigned long long)rcvStats.budgetExhausted, VTY_NEWLINE);
+
+  struct srx_requeue_stats rqStats;
+  srx_bgp_requeue_statistics(&rqStats);
+  vty_out (vty, "SRx best path requeue statistics:%s", VTY_NEWLINE);
+  vty_out (vty, "  requests.......: %lu%s", rqStats.requests, VTY_NEWLINE);
+  vty_out (vty, "  coalesced......: %lu%s", rqStats.coalesced, VTY_NEWLINE);
+  vty_out (vty, "  prefixes.......: %lu%s", rqStats.nodes, VTY_NEWLINE);
+  vty_out (vty, "  windows........: %lu%s", rqStats.bursts, VTY_NEWLINE);
+  vty_out (vty, "  max per window.: %u%s", rqStats.maxBurst, VTY_NEWLINE);
+  vty_out (vty, "  pending........: %u%s", rqStats.pending, VTY_NEWLINE);
+
+  struct crypto_pool_stats cpStats;
+  crypto_pool_statistics(bgp->srx_cryptoPool, &cpStats);
+  vty_out (vty, "BGPsec crypto worker statistics:%s", VTY_NEWLINE);
+  vty_out (vty, "  workers........: %u%s", cpStats.workers, VTY_NEWLINE);
+  vty_out (vty, "  validations....: %lu%s", 
+           cpStats.submitted - cpStats.signJobs, VTY_NEWLINE);
+  vty_out (vty, "  signatures.....: %lu (failed %lu)%s", cpStats.signJobs,
+           cpStats.signFailed, VTY_NEWLINE);
+  vty_out (vty, "  sign calls.....: %lu (max batch %u)%s", cpStats.batches,
+           cpStats.maxBatch, VTY_NEWLINE);
+  vty_out (vty, "  completed......: %lu%s", cpStats.completed, VTY_NEWLINE);
+  vty_out (vty, "  discarded......: %lu%s", cpStats.discarded, VTY_NEWLINE);
+  vty_out (vty, "  result events..: %lu%s", cpStats.wakeups, VTY_NEWLINE);
+  vty_out (vty, "  pending........: %u (max queued %u)%s", cpStats.pending,
+           cpStats.maxQueued, VTY_NEWLINE);
+
+  struct sign_cache_stats scStats;
+  sign_cache_statistics(bgp->srx_signCache, &scStats);
+  vty_out (vty, "BGPsec signature cache statistics:%s", VTY_NEWLINE);
+  vty_out (vty, "  hits...........: %lu%s", scStats.hits, VTY_NEWLINE);
+  vty_out (vty, "  misses.........: %lu%s", scStats.misses, VTY_NEWLINE);
+  vty_out (vty, "  entries........: %lu%s", scStats.entries, VTY_NEWLINE);
+  vty_out (vty, "  memory.........: %lu of %lu KB%s", 
+           (scStats.memory + 1023) / 1024, scStats.maxMemory / 1024, 
+           VTY_NEWLINE);
+  vty_out (vty, "  evictions......: %lu%s", scStats.evictions, VTY_NEWLINE);
+  vty_out (vty, "  flushes........: %lu%s", scStats.flushes, VTY_NEWLINE);
+  vty_out (vty, "  prefetched.....: %lu%s", scStats.reserved, VTY_NEWLINE);
+
   vty_out (vty, "BGPSEC configuration settings:%s", VTY_NEWLINE);
   vty_out (vty, "  active key.....: %u%s", bgp->srx_bgpsec_active_key,
            VTY_NEWLINE);
@@ -1848,6 +1917,8 @@ int srx_set_ski(struct vty* vty, u_int8_t skiNum, char* skiStr, u_int8_t algoID)
 
   // The array index starts by zero "0" but the key numbering by one "1"
   BGPSecKey* key = &bgp->srx_bgpsec_key[skiNum];
+  // Signatures of the previous key must not be used anymore.
+  sign_cache_flush(bgp->srx_signCache);
   if (key->keyLength > 0)
   {
     // A previous key was loaded, remove it and load the new one.
@@ -2044,6 +2115,7 @@ DEFUN (srx_bgpsec_active_ski,
   else
   {
     bgp->srx_bgpsec_active_key = activeNum;
+    sign_cache_flush(bgp->srx_signCache);
   }
 
   return retVal;
@@ -2084,6 +2156,7 @@ DEFUN (srx_bgpsec_register_pkeys,
   }
 
   // Now register the keys (again)
+  sign_cache_flush(bgp->srx_signCache);
   if (bgp->srxCAPI != NULL)
   {
     for (kIdx = 0; kIdx < SRX_MAX_PRIVKEYS; kIdx++)
@@ -2445,6 +2518,95 @@ DEFUN (srx_keepwindow,
   return CMD_SUCCESS;
 }
 
+DEFUN (srx_receive_budget,
+       srx_receive_budget_cmd,
+       SRX_VTY_CMD_RECEIVE_BUDGET,
+       SRX_VTY_HLP_RECEIVE_BUDGET)
+{
+  struct bgp *bgp;
+
+  bgp = vty->index;
+  bgp->srx_receiveBudget = strtoul (argv[0], NULL, 10);
+  if (bgp->srxProxy != NULL)
+  {
+    setReceiveBudget (bgp->srxProxy, bgp->srx_receiveBudget);
+  }
+
+  return CMD_SUCCESS;
+}
+
+DEFUN (srx_crypto_workers,
+       srx_crypto_workers_cmd,
+       SRX_VTY_CMD_CRYPTO_WORKERS,
+       SRX_VTY_HLP_CRYPTO_WORKERS)
+{
+  struct bgp *bgp;
+
+  bgp = vty->index;
+  bgp->srx_cryptoWorkers = strtoul (argv[0], NULL, 10);
+  // The pool is started again with the new size by the next validation.
+  crypto_pool_free (&bgp->srx_cryptoPool);
+
+  return CMD_SUCCESS;
+}
+
+DEFUN (srx_sign_cache,
+       srx_sign_cache_cmd,
+       SRX_VTY_CMD_SIGN_CACHE,
+       SRX_VTY_HLP_SIGN_CACHE)
+{
+  struct bgp *bgp;
+
+  bgp = vty->index;
+  bgp->srx_signCacheKB = strtoul (argv[0], NULL, 10);
+  if (bgp->srx_signCacheKB == 0)
+  {
+    sign_cache_free (&bgp->srx_signCache);
+  }
+  else if (bgp->srx_signCache == NULL)
+  {
+    bgp->srx_signCache = sign_cache_new (bgp->srx_signCacheKB * 1024UL);
+  }
+  else
+  {
+    sign_cache_set_max_memory (bgp->srx_signCache, 
+                               bgp->srx_signCacheKB * 1024UL);
+  }
+
+  return CMD_SUCCESS;
+}
+
+DEFUN (srx_sign_prefetch,
+       srx_sign_prefetch_cmd,
+       SRX_VTY_CMD_SIGN_PREFETCH,
+       SRX_VTY_HLP_SIGN_PREFETCH)
+{
+  struct bgp *bgp;
+
+  bgp = vty->index;
+  // Signatures already requested are still stored in the signature cache.
+  bgp->srx_signPrefetch = strtoul (argv[0], NULL, 10);
+
+  return CMD_SUCCESS;
+}
+
+DEFUN (srx_requeue_window,
+       srx_requeue_window_cmd,
+       SRX_VTY_CMD_REQUEUE_WINDOW,
+       SRX_VTY_HLP_REQUEUE_WINDOW)
+{
+  struct bgp *bgp;
+
+  bgp = vty->index;
+  bgp->srx_requeueWindow = strtoul (argv[0], NULL, 10);
+  if (bgp->srx_requeueWindow == 0)
+  {
+    srx_bgp_requeue_flush ();
+  }
+
+  return CMD_SUCCESS;
+}
+
 DEFUN (srx_proxyid,
        srx_proxyid_cmd,
        SRX_VTY_CMD_PROXYID,
@@ -11119,6 +11281,11 @@ bgp_vty_init (void)
   install_element (BGP_NODE, &no_srx_display_cmd);
 
   install_element (BGP_NODE, &srx_keepwindow_cmd);
+  install_element (BGP_NODE, &srx_receive_budget_cmd);
+  install_element (BGP_NODE, &srx_requeue_window_cmd);
+  install_element (BGP_NODE, &srx_crypto_workers_cmd);
+  install_element (BGP_NODE, &srx_sign_cache_cmd);
+  install_element (BGP_NODE, &srx_sign_prefetch_cmd);
   install_element (BGP_NODE, &srx_proxyid_cmd);
 
   // ROA LOCAL-PREF POICIES
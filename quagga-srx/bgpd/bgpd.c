@@ -65,6 +65,8 @@ Software Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
 #ifdef USE_SRX
 #include "bgpd/bgp_info_hash.h"
 #include "bgpd/bgp_validate.h"
+#include "bgpd/bgp_crypto_pool.h"
+#include "bgpd/bgp_sign_cache.h"
 
 // Forward Declaration
 bool handleSRxValidationResult (SRxUpdateID updateID, uint32_t localID,
@@ -705,6 +707,10 @@ int srx_connect_proxy(struct bgp *bgp)
         bgp->srx_handshakeTimeout, true);
     if (connected)
     {
+      // Only used if the SRx server supports bulk verify requests.
+      setVerifyBatch (bgp->srxProxy, SRX_VERIFY_BATCH_MAX,
+                      SRX_VERIFY_BATCH_DELAY_MS);
+      setReceiveBudget (bgp->srxProxy, bgp->srx_receiveBudget);
       g_rq->proxy = bgp->srxProxy;
       clientFD = getInternalSocketFD(bgp->srxProxy, true);
 
@@ -2665,28 +2671,46 @@ bool handleSRxValidationResult (SRxUpdateID updateID, uint32_t localID,
       //------ To be deleted later on-----------
       if ( !CHECK_FLAG(bgp->srx_config, SRX_CONFIG_EVAL_PATH_DISTR))
       {
-        if (bgp->srxCAPI != NULL && info->attr->bgpsec_validationData != NULL)
+        // Hand the path validation to the crypto workers, the BGPsec result
+        // is applied once the workers are done.
+        if (bgp->srx_cryptoPool == NULL && bgp->srx_cryptoWorkers > 0
+            && bgp->srxCAPI != NULL)
         {
-          // Now CAPI validation result and the SRx Validation result are different
-          // values. We need to adjust them.
-          int valResult = bgp->srxCAPI->validate(info->attr->bgpsec_validationData);
-          bgpsecResult = valResult == API_VALRESULT_VALID ? SRx_RESULT_VALID
-                                                          : SRx_RESULT_INVALID;
-
-          if (bgpsecResult == SRx_RESULT_INVALID)
+          bgp->srx_cryptoPool = crypto_pool_new(bgp, bgp->srxCAPI,
+                                                bgp->srx_cryptoWorkers);
+        }
+        if (crypto_pool_validate(bgp->srx_cryptoPool, info))
+        {
+          valType &= ~VRT_BGPSEC;
+        }
+        else
+        {
+          if (bgp->srxCAPI != NULL && info->attr->bgpsec_validationData != NULL)
           {
-            if ((info->attr->bgpsec_validationData->status & API_STATUS_ERROR_MASK) > 0)
+            // Now CAPI validation result and the SRx Validation result are different
+            // values. We need to adjust them.
+            int valResult = bgp->srxCAPI->validate(info->attr->bgpsec_validationData);
+            bgpsecResult = valResult == API_VALRESULT_VALID ? SRx_RESULT_VALID
+                                                            : SRx_RESULT_INVALID;
+
+            if (bgpsecResult == SRx_RESULT_INVALID)
             {
-              zlog_err("Update [0x%08X] validation returned invalid with an error: status=0x%X\n",
-                      updateID, info->attr->bgpsec_validationData->status);
+              if ((info->attr->bgpsec_validationData->status & API_STATUS_ERROR_MASK) > 0)
+              {
+                zlog_err("Update [0x%08X] validation returned invalid with an error: status=0x%X\n",
+                        updateID, info->attr->bgpsec_validationData->status);
+              }
             }
           }
+          valType |= VRT_BGPSEC;
         }
-        valType |= VRT_BGPSEC;
       }
 
-      bgp_info_set_validation_result (info, valType, roaResult, bgpsecResult, 
-                                      aspaResult);
+      if ((valType & SRX_FLAG_ROA_BGPSEC_ASPA) != 0)
+      {
+        bgp_info_set_validation_result (info, valType, roaResult, 
+                                        bgpsecResult, aspaResult);
+      }
       retVal = true;
     }
   }
@@ -2782,6 +2806,12 @@ void handleSRxSynchRequest(void* bgpRouter)
 
   _handleSRxSynchRequest_processTable(bgp, bgp->rib[AFI_IP][SAFI_MULTICAST]);
   _handleSRxSynchRequest_processTable(bgp, bgp->rib[AFI_IP][SAFI_UNICAST]);
+
+  /* Send the verify requests collected during the table walk. */
+  if (bgp->srxProxy != NULL)
+  {
+    flushVerifyBatch (bgp->srxProxy);
+  }
 }
 
 /**
@@ -2807,6 +2837,15 @@ void srx_set_default(struct bgp *bgp)
   //bgp->srx_proxyID          = bgp->router_id.s_addr;
   bgp->srx_keepWindow       = SRX_KEEP_WINDOW;
   bgp->srx_handshakeTimeout = SRX_HANDHAKE_TIMEOUT;
+  bgp->srx_receiveBudget    = SRX_DEFAULT_RECEIVE_BUDGET;
+  bgp->srx_requeueWindow    = SRX_REQUEUE_WINDOW_MS;
+  bgp->srx_cryptoWorkers    = SRX_CRYPTO_WORKERS;
+  bgp->srx_signCacheKB      = SRX_SIGN_CACHE_KB;
+  bgp->srx_signPrefetch     = SRX_SIGN_PREFETCH;
+  // Called again after failed connection attempts, release what exists.
+  crypto_pool_free(&bgp->srx_cryptoPool);
+  sign_cache_free(&bgp->srx_signCache);
+  bgp->srx_signCache        = sign_cache_new(SRX_SIGN_CACHE_KB * 1024UL);
 
   // Changed from previously having origin validation as default to only 
   // enable the SRX_CONFIG_DISPLAY_INFO enabled.
@@ -3051,6 +3090,8 @@ bgp_delete (struct bgp *bgp)
     bgp_close ();
 
 #ifdef USE_SRX
+  crypto_pool_free (&bgp->srx_cryptoPool);
+  sign_cache_free (&bgp->srx_signCache);
   if (bgp->srxProxy)
   {
     zlog_debug ("[%s] calling release SRx proxy ", __FUNCTION__);
@@ -6227,6 +6268,41 @@ static int srx_config_write_configuration (struct vty *vty, struct bgp *bgp)
   vty_out (vty, " %s %d%s", SRX_VTY_CMD_KEEPWINDOW_SHORT,
                 bgp->srx_keepWindow,  VTY_NEWLINE);
 
+  // RECEIVE BUDGET
+  if (bgp->srx_receiveBudget != SRX_DEFAULT_RECEIVE_BUDGET)
+  {
+    vty_out (vty, " %s %d%s", SRX_VTY_CMD_RECEIVE_BUDGET_SHORT,
+                  bgp->srx_receiveBudget, VTY_NEWLINE);
+  }
+
+  // REQUEUE WINDOW
+  if (bgp->srx_requeueWindow != SRX_REQUEUE_WINDOW_MS)
+  {
+    vty_out (vty, " %s %d%s", SRX_VTY_CMD_REQUEUE_WINDOW_SHORT,
+                  bgp->srx_requeueWindow, VTY_NEWLINE);
+  }
+
+  // CRYPTO WORKERS
+  if (bgp->srx_cryptoWorkers != SRX_CRYPTO_WORKERS)
+  {
+    vty_out (vty, " %s %d%s", SRX_VTY_CMD_CRYPTO_WORKERS_SHORT,
+                  bgp->srx_cryptoWorkers, VTY_NEWLINE);
+  }
+
+  // SIGN CACHE
+  if (bgp->srx_signCacheKB != SRX_SIGN_CACHE_KB)
+  {
+    vty_out (vty, " %s %d%s", SRX_VTY_CMD_SIGN_CACHE_SHORT,
+                  bgp->srx_signCacheKB, VTY_NEWLINE);
+  }
+
+  // SIGN PREFETCH
+  if (bgp->srx_signPrefetch != SRX_SIGN_PREFETCH)
+  {
+    vty_out (vty, " %s %d%s", SRX_VTY_CMD_SIGN_PREFETCH_SHORT,
+                  bgp->srx_signPrefetch, VTY_NEWLINE);
+  }
+
   // EVALUATION MODE
   if (srx_config_check(bgp,   SRX_CONFIG_EVAL_ORIGIN 
                             | SRX_CONFIG_EVAL_PATH 
@@ -121,6 +121,53 @@ Software Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
                                 " is deleted!\n" \
                                 "Time in seconds \'0\' disables this feature!\n"
 
+#define SRX_VTY_CMD_RECEIVE_BUDGET_SHORT "srx receive-budget"
+#define SRX_VTY_CMD_RECEIVE_BUDGET  SRX_VTY_CMD_RECEIVE_BUDGET_SHORT \
+                                    " <1-65535>"
+#define SRX_VTY_HLP_RECEIVE_BUDGET  SRX_VTY_HLP_STR \
+                                "Configure the maximum number of SRx server " \
+                                "messages processed per read event\n" \
+                                "Number of messages\n"
+
+#define SRX_VTY_CMD_CRYPTO_WORKERS_SHORT "srx crypto-workers"
+#define SRX_VTY_CMD_CRYPTO_WORKERS  SRX_VTY_CMD_CRYPTO_WORKERS_SHORT \
+                                    " <0-64>"
+#define SRX_VTY_HLP_CRYPTO_WORKERS  SRX_VTY_HLP_STR \
+                                "Configure the number of threads performing " \
+                                "the local BGPsec path validation\n" \
+                                "Number of threads \'0\' validates within " \
+                                "the main thread!\n"
+
+#define SRX_VTY_CMD_SIGN_CACHE_SHORT "srx sign-cache"
+#define SRX_VTY_CMD_SIGN_CACHE  SRX_VTY_CMD_SIGN_CACHE_SHORT \
+                                " <0-1048576>"
+#define SRX_VTY_HLP_SIGN_CACHE  SRX_VTY_HLP_STR \
+                                "Configure the memory used to keep generated " \
+                                "BGPsec signatures for other peers of the " \
+                                "same AS\n" \
+                                "Memory in kilobytes \'0\' disables this " \
+                                "feature!\n"
+
+#define SRX_VTY_CMD_SIGN_PREFETCH_SHORT "srx sign-prefetch"
+#define SRX_VTY_CMD_SIGN_PREFETCH  SRX_VTY_CMD_SIGN_PREFETCH_SHORT \
+                                   " <0-4096>"
+#define SRX_VTY_HLP_SIGN_PREFETCH  SRX_VTY_HLP_STR \
+                                "Configure the number of queued updates per " \
+                                "peer that are signed by the crypto workers " \
+                                "ahead of time\n" \
+                                "Number of updates \'0\' signs within the " \
+                                "main thread!\n"
+
+#define SRX_VTY_CMD_REQUEUE_WINDOW_SHORT "srx requeue-window"
+#define SRX_VTY_CMD_REQUEUE_WINDOW  SRX_VTY_CMD_REQUEUE_WINDOW_SHORT \
+                                    " <0-1000>"
+#define SRX_VTY_HLP_REQUEUE_WINDOW  SRX_VTY_HLP_STR \
+                                "Configure the time validation result changes " \
+                                "are collected before the best path selection " \
+                                "is re-run\n" \
+                                "Time in milliseconds \'0\' disables this " \
+                                "feature!\n"
+
 //The short version is not a stand alone command, it is needed for a vtty output
 #define SRX_VTY_CMD_SET_SERVER_SHORT "srx set-server"
 #define SRX_VTY_CMD_SET_SERVER  SRX_VTY_CMD_SET_SERVER_SHORT " .LINE <0-65535>"
@@ -663,11 +710,32 @@ struct bgp
 
 #define SRX_HANDHAKE_TIMEOUT  30
 #define SRX_KEEP_WINDOW      900
+/* Verify requests collected into one bulk verify request. The batch is
+   flushed at the latest once the received UPDATE message is processed. */
+#define SRX_VERIFY_BATCH_MAX      256
+#define SRX_VERIFY_BATCH_DELAY_MS  10
 
   // The timeout during the session establishment
   int  srx_handshakeTimeout;
   // Time in seconds the SRx server is requested to keep data after a delete
   int  srx_keepWindow;
+  // Max number of SRx server messages processed per read event
+  int  srx_receiveBudget;
+/* Validation result changes within this window re-run the best path
+   selection of a prefix only once. */
+#define SRX_REQUEUE_WINDOW_MS  5
+  // Time in milliseconds route nodes are collected before requeued
+  int  srx_requeueWindow;
+  // Number of threads performing the local BGPsec path validation
+  int  srx_cryptoWorkers;
+  // The worker pool, started with the first local path validation
+  struct crypto_pool* srx_cryptoPool;
+  // Memory limit of the signature cache in kilobytes
+  int  srx_signCacheKB;
+  // Signatures generated for outbound BGPsec updates
+  struct sign_cache* srx_signCache;
+  // Number of queued updates per peer signed ahead by the crypto workers
+  int  srx_signPrefetch;
   uint32_t srx_proxyID;
   
 #define NUM_LOCPREF_TYPE   3
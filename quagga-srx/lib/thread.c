@@ -29,6 +29,7 @@
 #include "hash.h"
 #include "command.h"
 #include "sigevent.h"
+#include "network.h"
 
 #if defined HAVE_SNMP && defined SNMP_AGENTX
 #include <net-snmp/net-snmp-config.h>
@@ -44,6 +45,13 @@ extern int agentx_enabled;
 #include <mach/mach_time.h>
 #endif
 
+#ifdef THREAD_EPOLL
+#include <sys/epoll.h>
+#endif
+#ifdef HAVE_EVENTFD
+#include <sys/eventfd.h>
+#endif
+
 
 /* Recent absolute time of day */
 struct timeval recent_time;
@@ -59,6 +67,22 @@ static struct hash *cpu_record = NULL;
 /* Struct timeval's tv_usec one second value.  */
 #define TIMER_SECOND_MICRO 1000000L
 
+#ifdef THREAD_EPOLL
+/* Maximum number of descriptors returned by one epoll_wait() */
+#define THREAD_EPOLL_EVENTS 256
+
+/* Registration of a descriptor with the epoll instance.  The descriptors
+   are added with EPOLLONESHOT, an event disables the descriptor until the
+   next read or write thread for it re-arms it with one epoll_ctl(). */
+struct thread_fd
+{
+  struct thread *read;
+  struct thread *write;
+  u_int32_t armed;		/* events enabled in the epoll instance */
+  u_char registered;		/* descriptor added to the epoll instance */
+};
+#endif /* THREAD_EPOLL */
+
 /* Adjust so that tv_usec is in the range [0,TIMER_SECOND_MICRO).
    And change negative values to 0. */
 static struct timeval
@@ -529,13 +553,21 @@ thread_master_debug (struct thread_master *m)
 struct thread_master *
 thread_master_create ()
 {
+  struct thread_master *m;
+
   if (cpu_record == NULL) 
     cpu_record 
       = hash_create_size (1011, (unsigned int (*) (void *))cpu_record_hash_key, 
                           (int (*) (const void *, const void *))cpu_record_hash_cmp);
     
-  return (struct thread_master *) XCALLOC (MTYPE_THREAD_MASTER,
-					   sizeof (struct thread_master));
+  m = (struct thread_master *) XCALLOC (MTYPE_THREAD_MASTER,
+					sizeof (struct thread_master));
+#ifdef THREAD_EPOLL
+  m->epoll_fd = epoll_create1 (EPOLL_CLOEXEC);
+  if (m->epoll_fd < 0)
+    zlog_err ("epoll_create1() error: %s", safe_strerror (errno));
+#endif /* THREAD_EPOLL */
+  return m;
 }
 
 /* Add a new thread to the list.  */
@@ -624,6 +656,13 @@ thread_master_free (struct thread_master *m)
   thread_list_free (m, &m->ready);
   thread_list_free (m, &m->unuse);
   thread_list_free (m, &m->background);
+
+#ifdef THREAD_EPOLL
+  if (m->epoll_fd >= 0)
+    close (m->epoll_fd);
+  if (m->fds)
+    XFREE (MTYPE_THREAD_MASTER, m->fds);
+#endif /* THREAD_EPOLL */
   
   XFREE (MTYPE_THREAD_MASTER, m);
 
@@ -711,52 +750,238 @@ thread_get (struct thread_master *m, u_char type,
   return thread;
 }
 
-/* Add new read thread. */
-struct thread *
-funcname_thread_add_read (struct thread_master *m, 
-		 int (*func) (struct thread *), void *arg, int fd, const char* funcname)
+#ifdef THREAD_EPOLL
+/* Move a read or write thread to the ready list. */
+static void
+thread_fd_ready (struct thread_master *m, struct thread *thread)
 {
-  struct thread *thread;
+  thread_list_delete (thread->type == THREAD_READ ? &m->read : &m->write,
+                      thread);
+  thread_list_add (&m->ready, thread);
+  thread->type = THREAD_READY;
+}
 
-  assert (m != NULL);
+/* Make room for fd in the descriptor table. */
+static int
+thread_fd_grow (struct thread_master *m, int fd)
+{
+  int size;
+
+  if (fd < 0)
+    return -1;
+  if (fd < m->fds_size)
+    return 0;
+
+  for (size = m->fds_size ? m->fds_size : 256; size <= fd; size *= 2)
+    ;
+  m->fds = XREALLOC (MTYPE_THREAD_MASTER, m->fds,
+                     size * sizeof (struct thread_fd));
+  memset (m->fds + m->fds_size, 0,
+          (size - m->fds_size) * sizeof (struct thread_fd));
+  m->fds_size = size;
+  return 0;
+}
+
+/* Bring the epoll registration of fd in line with its read and write
+   threads. */
+static void
+thread_fd_update (struct thread_master *m, int fd)
+{
+  struct thread_fd *tfd = &m->fds[fd];
+  struct epoll_event event;
+  u_int32_t events;
+  int ret;
+
+  events = (tfd->read ? EPOLLIN : 0) | (tfd->write ? EPOLLOUT : 0);
+  if (events == tfd->armed)
+    return;
 
-  if (FD_ISSET (fd, &m->readfd))
+  if (events == 0)
     {
-      zlog (NULL, LOG_WARNING, "There is already read fd [%d]", fd);
-      return NULL;
+      /* Cancelled while armed.  A descriptor disabled by its last event
+         instead stays registered, it is re-armed by the next thread or
+         dropped by the kernel on close. */
+      epoll_ctl (m->epoll_fd, EPOLL_CTL_DEL, fd, NULL);
+      tfd->registered = 0;
+      tfd->armed = 0;
+      return;
     }
 
-  thread = thread_get (m, THREAD_READ, func, arg, funcname);
-  FD_SET (fd, &m->readfd);
-  thread->u.fd = fd;
-  thread_list_add (&m->read, thread);
+  memset (&event, 0, sizeof (event));
+  event.events = events | EPOLLONESHOT;
+  event.data.fd = fd;
 
-  return thread;
+  /* The descriptor number can be closed and reused since it was
+     registered, or still be registered after a failed delete. */
+  if (tfd->registered)
+    {
+      ret = epoll_ctl (m->epoll_fd, EPOLL_CTL_MOD, fd, &event);
+      if (ret < 0 && errno == ENOENT)
+        ret = epoll_ctl (m->epoll_fd, EPOLL_CTL_ADD, fd, &event);
+    }
+  else
+    {
+      ret = epoll_ctl (m->epoll_fd, EPOLL_CTL_ADD, fd, &event);
+      if (ret < 0 && errno == EEXIST)
+        ret = epoll_ctl (m->epoll_fd, EPOLL_CTL_MOD, fd, &event);
+    }
+
+  if (ret < 0)
+    {
+      tfd->registered = 0;
+      tfd->armed = 0;
+
+      /* Regular files cannot be polled, select() reports them ready. */
+      if (errno == EPERM)
+        {
+          if (tfd->read)
+            thread_fd_ready (m, tfd->read);
+          if (tfd->write)
+            thread_fd_ready (m, tfd->write);
+          tfd->read = tfd->write = NULL;
+        }
+      else
+        zlog_warn ("epoll_ctl() error on fd [%d]: %s", fd,
+                   safe_strerror (errno));
+      return;
+    }
+
+  tfd->registered = 1;
+  tfd->armed = events;
 }
 
-/* Add new write thread. */
-struct thread *
-funcname_thread_add_write (struct thread_master *m,
-		 int (*func) (struct thread *), void *arg, int fd, const char* funcname)
+/* Is a read or write thread waiting for fd. */
+static int
+thread_fd_isset (struct thread_master *m, int fd, thread_type type)
+{
+  if (fd >= m->fds_size)
+    return 0;
+  return (type == THREAD_READ ? m->fds[fd].read : m->fds[fd].write) != NULL;
+}
+
+/* Start polling the descriptor of a read or write thread. */
+static void
+thread_fd_set (struct thread_master *m, struct thread *thread)
+{
+  struct thread_fd *tfd = &m->fds[thread->u.fd];
+
+  if (thread->type == THREAD_READ)
+    tfd->read = thread;
+  else
+    tfd->write = thread;
+  thread_fd_update (m, thread->u.fd);
+}
+
+/* Stop polling the descriptor of a read or write thread. */
+static void
+thread_fd_clr (struct thread_master *m, struct thread *thread)
+{
+  struct thread_fd *tfd = &m->fds[thread->u.fd];
+
+  if (thread->type == THREAD_READ)
+    {
+      assert (tfd->read == thread);
+      tfd->read = NULL;
+    }
+  else
+    {
+      assert (tfd->write == thread);
+      tfd->write = NULL;
+    }
+  thread_fd_update (m, thread->u.fd);
+}
+#else
+/* Make sure fd fits into the select() descriptor sets. */
+static int
+thread_fd_grow (struct thread_master *m, int fd)
+{
+  return (fd < 0 || fd >= FD_SETSIZE) ? -1 : 0;
+}
+
+/* Is a read or write thread waiting for fd. */
+static int
+thread_fd_isset (struct thread_master *m, int fd, thread_type type)
+{
+  return FD_ISSET (fd, type == THREAD_READ ? &m->readfd : &m->writefd);
+}
+
+/* Start polling the descriptor of a read or write thread. */
+static void
+thread_fd_set (struct thread_master *m, struct thread *thread)
+{
+  FD_SET (thread->u.fd,
+          thread->type == THREAD_READ ? &m->readfd : &m->writefd);
+}
+
+/* Stop polling the descriptor of a read or write thread. */
+static void
+thread_fd_clr (struct thread_master *m, struct thread *thread)
+{
+  fd_set *fdset = thread->type == THREAD_READ ? &m->readfd : &m->writefd;
+
+  assert (FD_ISSET (thread->u.fd, fdset));
+  FD_CLR (thread->u.fd, fdset);
+}
+#endif /* THREAD_EPOLL */
+
+/* Add new read or write thread. */
+static struct thread *
+thread_add_fd (struct thread_master *m, u_char type,
+	       int (*func) (struct thread *), void *arg, int fd,
+	       const char* funcname)
 {
   struct thread *thread;
 
   assert (m != NULL);
 
-  if (FD_ISSET (fd, &m->writefd))
+  if (thread_fd_grow (m, fd) < 0)
     {
-      zlog (NULL, LOG_WARNING, "There is already write fd [%d]", fd);
+      zlog (NULL, LOG_WARNING, "Cannot poll fd [%d]", fd);
       return NULL;
     }
 
-  thread = thread_get (m, THREAD_WRITE, func, arg, funcname);
-  FD_SET (fd, &m->writefd);
+  if (thread_fd_isset (m, fd, type))
+    {
+      zlog (NULL, LOG_WARNING, "There is already %s fd [%d]",
+            type == THREAD_READ ? "read" : "write", fd);
+      return NULL;
+    }
+
+  thread = thread_get (m, type, func, arg, funcname);
   thread->u.fd = fd;
-  thread_list_add (&m->write, thread);
+  thread_list_add (type == THREAD_READ ? &m->read : &m->write, thread);
+  thread_fd_set (m, thread);
 
   return thread;
 }
 
+/* Add new read thread. */
+struct thread *
+funcname_thread_add_read (struct thread_master *m, 
+		 int (*func) (struct thread *), void *arg, int fd, const char* funcname)
+{
+  return thread_add_fd (m, THREAD_READ, func, arg, fd, funcname);
+}
+
+/* Add new write thread. */
+struct thread *
+funcname_thread_add_write (struct thread_master *m,
+		 int (*func) (struct thread *), void *arg, int fd, const char* funcname)
+{
+  return thread_add_fd (m, THREAD_WRITE, func, arg, fd, funcname);
+}
+
+/* Add new read thread on the wake-up descriptor, the thread runs once the
+   descriptor is signalled and has to clear it. */
+struct thread *
+funcname_thread_add_event_fd (struct thread_master *m,
+                              int (*func) (struct thread *), void *arg,
+                              struct thread_event_fd *efd,
+                              const char *funcname)
+{
+  return thread_add_fd (m, THREAD_READ, func, arg, efd->fd[0], funcname);
+}
+
 static struct thread *
 funcname_thread_add_timer_timeval (struct thread_master *m,
                                    int (*func) (struct thread *), 
@@ -883,13 +1108,11 @@ thread_cancel (struct thread *thread)
   switch (thread->type)
     {
     case THREAD_READ:
-      assert (FD_ISSET (thread->u.fd, &thread->master->readfd));
-      FD_CLR (thread->u.fd, &thread->master->readfd);
+      thread_fd_clr (thread->master, thread);
       list = &thread->master->read;
       break;
     case THREAD_WRITE:
-      assert (FD_ISSET (thread->u.fd, &thread->master->writefd));
-      FD_CLR (thread->u.fd, &thread->master->writefd);
+      thread_fd_clr (thread->master, thread);
       list = &thread->master->write;
       break;
     case THREAD_TIMER:
@@ -957,6 +1180,96 @@ thread_cancel_event (struct thread_master *m, void *arg)
   return ret;
 }
 
+/* Stop polling fd for reading while its read thread stays scheduled.
+   Returns 1 if fd was polled. */
+int
+thread_ignore_read (struct thread_master *m, int fd)
+{
+#ifdef THREAD_EPOLL
+  struct thread_fd *tfd;
+
+  if (fd < 0 || fd >= m->fds_size || !m->fds[fd].read)
+    return 0;
+
+  /* Like select(), the read thread only loses its descriptor slot. */
+  tfd = &m->fds[fd];
+  tfd->read = NULL;
+  thread_fd_update (m, fd);
+  return 1;
+#else
+  if (fd < 0 || fd >= FD_SETSIZE || !FD_ISSET (fd, &m->readfd))
+    return 0;
+  FD_CLR (fd, &m->readfd);
+  return 1;
+#endif /* THREAD_EPOLL */
+}
+
+/* Open the wake-up descriptor of a thread master. */
+int
+thread_event_fd_open (struct thread_event_fd *efd)
+{
+#ifdef HAVE_EVENTFD
+  efd->fd[0] = efd->fd[1] = eventfd (0, EFD_NONBLOCK | EFD_CLOEXEC);
+  if (efd->fd[0] < 0)
+    return -1;
+#else
+  if (pipe (efd->fd) < 0)
+    return -1;
+  set_nonblocking (efd->fd[0]);
+  set_nonblocking (efd->fd[1]);
+#endif /* HAVE_EVENTFD */
+  return 0;
+}
+
+/* Close the wake-up descriptor, the thread using it has to be cancelled
+   before. */
+void
+thread_event_fd_close (struct thread_event_fd *efd)
+{
+  close (efd->fd[0]);
+  if (efd->fd[1] != efd->fd[0])
+    close (efd->fd[1]);
+  efd->fd[0] = efd->fd[1] = -1;
+}
+
+/* Wake up the thread master, safe to call from any thread. */
+void
+thread_event_fd_signal (struct thread_event_fd *efd)
+{
+#ifdef HAVE_EVENTFD
+  uint64_t one = 1;
+#else
+  char one = 0;
+#endif /* HAVE_EVENTFD */
+
+  /* A full counter or pipe wakes up the thread master anyway. */
+  if (write (efd->fd[1], &one, sizeof (one)) < 0 && errno != EAGAIN)
+    zlog_warn ("Cannot signal event fd [%d]: %s", efd->fd[1],
+               safe_strerror (errno));
+}
+
+/* Reset the wake-up descriptor.  Returns the number of signals since the
+   last call. */
+unsigned long
+thread_event_fd_clear (struct thread_event_fd *efd)
+{
+#ifdef HAVE_EVENTFD
+  uint64_t count = 0;
+
+  if (read (efd->fd[0], &count, sizeof (count)) != sizeof (count))
+    return 0;
+  return count;
+#else
+  unsigned long count = 0;
+  char buf[64];
+  ssize_t nbytes;
+
+  while ((nbytes = read (efd->fd[0], buf, sizeof (buf))) > 0)
+    count += nbytes;
+  return count;
+#endif /* HAVE_EVENTFD */
+}
+
 static struct timeval *
 thread_timer_wait (struct thread_list *tlist, struct timeval *timer_val)
 {
@@ -978,6 +1291,61 @@ thread_run (struct thread_master *m, struct thread *thread,
   return fetch;
 }
 
+#ifdef THREAD_EPOLL
+/* Move the threads of the descriptors epoll reported to the ready list,
+   the cost depends on the number of events and not on the number of
+   descriptors polled. */
+static int
+thread_process_epoll (struct thread_master *m, struct epoll_event *events,
+                      int num)
+{
+  struct thread_fd *tfd;
+  int ready = 0;
+  int i;
+
+  for (i = 0; i < num; i++)
+    {
+      if (events[i].data.fd >= m->fds_size)
+        continue;
+      tfd = &m->fds[events[i].data.fd];
+
+      /* The event disabled the descriptor. */
+      tfd->armed = 0;
+
+      /* Like select(), errors and hang ups make both directions ready. */
+      if (tfd->read && (events[i].events & (EPOLLIN|EPOLLERR|EPOLLHUP)))
+        {
+          thread_fd_ready (m, tfd->read);
+          tfd->read = NULL;
+          ready++;
+        }
+      if (tfd->write && (events[i].events & (EPOLLOUT|EPOLLERR|EPOLLHUP)))
+        {
+          thread_fd_ready (m, tfd->write);
+          tfd->write = NULL;
+          ready++;
+        }
+
+      /* Re-arm the direction that is still waiting. */
+      thread_fd_update (m, events[i].data.fd);
+    }
+  return ready;
+}
+
+/* Convert the select() timeout into the epoll_wait() one, rounded up so
+   that timers are not polled for early. */
+static int
+thread_epoll_timeout (struct timeval *timer_wait)
+{
+  if (timer_wait == NULL)
+    return -1;
+  if (timer_wait->tv_sec < 0)
+    return 0;
+  if (timer_wait->tv_sec >= INT_MAX / 1000 - 1)
+    return INT_MAX;
+  return timer_wait->tv_sec * 1000 + (timer_wait->tv_usec + 999) / 1000;
+}
+#else
 static int
 thread_process_fd (struct thread_list *list, fd_set *fdset, fd_set *mfdset)
 {
@@ -1003,6 +1371,7 @@ thread_process_fd (struct thread_list *list, fd_set *fdset, fd_set *mfdset)
     }
   return ready;
 }
+#endif /* THREAD_EPOLL */
 
 /* Add all timers that have popped to the ready list. */
 static unsigned int
@@ -1050,9 +1419,13 @@ struct thread *
 thread_fetch (struct thread_master *m, struct thread *fetch)
 {
   struct thread *thread;
+#ifdef THREAD_EPOLL
+  struct epoll_event events[THREAD_EPOLL_EVENTS];
+#else
   fd_set readfd;
   fd_set writefd;
   fd_set exceptfd;
+#endif /* THREAD_EPOLL */
   struct timeval timer_val = { .tv_sec = 0, .tv_usec = 0 };
   struct timeval timer_val_bg;
   struct timeval *timer_wait = &timer_val;
@@ -1084,10 +1457,12 @@ thread_fetch (struct thread_master *m, struct thread *fetch)
       /* Normal event are the next highest priority.  */
       thread_process (&m->event);
       
+#ifndef THREAD_EPOLL
       /* Structure copy.  */
       readfd = m->readfd;
       writefd = m->writefd;
       exceptfd = m->exceptfd;
+#endif /* THREAD_EPOLL */
       
       /* Calculate select wait timer if nothing else to do */
       if (m->ready.count == 0)
@@ -1121,14 +1496,23 @@ thread_fetch (struct thread_master *m, struct thread *fetch)
             timer_wait = &snmp_timer_wait;
         }
 #endif
+#ifdef THREAD_EPOLL
+      num = epoll_wait (m->epoll_fd, events, THREAD_EPOLL_EVENTS,
+                        thread_epoll_timeout (timer_wait));
+#else
       num = select (FD_SETSIZE, &readfd, &writefd, &exceptfd, timer_wait);
+#endif /* THREAD_EPOLL */
       
       /* Signals should get quick treatment */
       if (num < 0)
         {
           if (errno == EINTR)
             continue; /* signal received - process it */
+#ifdef THREAD_EPOLL
+          zlog_warn ("epoll_wait() error: %s", safe_strerror (errno));
+#else
           zlog_warn ("select() error: %s", safe_strerror (errno));
+#endif /* THREAD_EPOLL */
             return NULL;
         }
 
@@ -1155,10 +1539,14 @@ thread_fetch (struct thread_master *m, struct thread *fetch)
       /* Got IO, process it */
       if (num > 0)
         {
+#ifdef THREAD_EPOLL
+          thread_process_epoll (m, events, num);
+#else
           /* Normal priority read thead. */
           thread_process_fd (&m->read, &readfd, &m->readfd);
           /* Write thead. */
           thread_process_fd (&m->write, &writefd, &m->writefd);
+#endif /* THREAD_EPOLL */
         }
 
 #if 0
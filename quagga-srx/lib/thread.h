@@ -44,6 +44,12 @@ struct thread_list
   int count;
 };
 
+/* The epoll backend is not used together with the SNMP AgentX subagent,
+   it hands its descriptors over in a select() fd_set. */
+#if defined HAVE_EPOLL && !(defined HAVE_SNMP && defined SNMP_AGENTX)
+#define THREAD_EPOLL
+#endif
+
 /* Master of the theads. */
 struct thread_master
 {
@@ -54,12 +60,25 @@ struct thread_master
   struct thread_list ready;
   struct thread_list unuse;
   struct thread_list background;
+#ifdef THREAD_EPOLL
+  int epoll_fd;
+  struct thread_fd *fds;	/* read and write thread, indexed by fd */
+  int fds_size;
+#else
   fd_set readfd;
   fd_set writefd;
   fd_set exceptfd;
+#endif /* THREAD_EPOLL */
   unsigned long alloc;
 };
 
+/* Descriptor other threads of the process signal to wake up a thread
+   master, an eventfd if available and a pipe otherwise. */
+struct thread_event_fd
+{
+  int fd[2];			/* [0] read side, [1] write side */
+};
+
 typedef unsigned char thread_type;
 
 /* ISO C99 maximum function name length is 63 */
@@ -168,6 +187,7 @@ enum quagga_clkid {
 #define thread_add_timer_msec(m,f,a,v) funcname_thread_add_timer_msec(m,f,a,v,#f)
 #define thread_add_event(m,f,a,v) funcname_thread_add_event(m,f,a,v,#f)
 #define thread_execute(m,f,a,v) funcname_thread_execute(m,f,a,v,#f)
+#define thread_add_event_fd(m,f,a,v) funcname_thread_add_event_fd(m,f,a,v,#f)
 
 /* The 4th arg to thread_add_background is the # of milliseconds to delay. */
 #define thread_add_background(m,f,a,v) funcname_thread_add_background(m,f,a,v,#f)
@@ -199,13 +219,24 @@ extern struct thread *funcname_thread_add_background (struct thread_master *,
 extern struct thread *funcname_thread_execute (struct thread_master *,
                                                int (*)(struct thread *),
                                                void *, int, const char *);
+extern struct thread *funcname_thread_add_event_fd (struct thread_master *,
+                                                    int (*)(struct thread *),
+                                                    void *,
+                                                    struct thread_event_fd *,
+                                                    const char *);
 extern void thread_cancel (struct thread *);
+extern int thread_ignore_read (struct thread_master *, int);
 extern unsigned int thread_cancel_event (struct thread_master *, void *);
 extern struct thread *thread_fetch (struct thread_master *, struct thread *);
 extern void thread_call (struct thread *);
 extern unsigned long thread_timer_remain_second (struct thread *);
 extern int thread_should_yield (struct thread *);
 
+extern int thread_event_fd_open (struct thread_event_fd *);
+extern void thread_event_fd_close (struct thread_event_fd *);
+extern void thread_event_fd_signal (struct thread_event_fd *);
+extern unsigned long thread_event_fd_clear (struct thread_event_fd *);
+
 /* Internal libzebra exports */
 extern void thread_getrusage (RUSAGE_T *);
 extern struct cmd_element show_thread_cpu_cmd;
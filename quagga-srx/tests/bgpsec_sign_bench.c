@@ -0,0 +1,332 @@
+/**
+ * This software was developed at the National Institute of Standards and
+ * Technology by employees of the Federal Government in the course of
+ * their official duties. Pursuant to title 17 Section 105 of the United
+ * States Code this software is not subject to copyright protection and
+ * is in the public domain.
+ *
+ * NIST assumes no responsibility whatsoever for its use by other parties,
+ * and makes no guarantees, expressed or implied, about its quality,
+ * reliability, or any other characteristic.
+ *
+ * We would appreciate acknowledgment if the software is used.
+ *
+ * NIST ALLOWS FREE USE OF THIS SOFTWARE IN ITS "AS IS" CONDITION AND
+ * DISCLAIM ANY LIABILITY OF ANY KIND FOR ANY DAMAGES WHATSOEVER RESULTING
+ * FROM THE USE OF THIS SOFTWARE.
+ *
+ * This software might use libraries that are under GNU public license or
+ * other licenses. Please refer to the licenses of all libraries required
+ * by this software.
+ *
+ * Benchmark of the outbound BGPsec signing. Measures the time until all
+ * prefixes of a table are signed for one eBGP peer, once signed inline while
+ * the updates are built and once signed ahead by the crypto workers. The
+ * signing is done by a stand-in crypto API that spends a configurable CPU time
+ * per signature, the measured times therefore do not depend on the keys
+ * installed on this host.
+ *
+ * Usage: bgpsec_sign_bench [-w workers] [-p prefetch] [-c usec per signature]
+ *
+ * @version 0.6.0.4
+ *
+ * Changelog:
+ * -----------------------------------------------------------------------------
+ * 0.6.0.4 - 2026/10/17
+ *           * File created
+ */
+#include <zebra.h>
+
+#include "thread.h"
+#include "prefix.h"
+#include "vty.h"
+#include "zclient.h"
+
+#include "bgpd/bgpd.h"
+#include "bgpd/bgp_attr.h"
+#include "bgpd/bgp_validate.h"
+#include "bgpd/bgp_sign_cache.h"
+#include "bgpd/bgp_crypto_pool.h"
+
+/* need these to link in libbgp */
+struct thread_master *master = NULL;
+// Declared as static to prevent linker error on ROCKY 9 (since 0.6.0.4)
+static struct zclient *zclient;
+
+/* Length of an ECDSA P-256 signature */
+#define BENCH_SIG_LEN  72
+
+/* Time the stand-in API spends per signature in microseconds */
+static long signCost = 100;
+
+/**
+ * Return the current time in microseconds.
+ *
+ * @return the monotonic time in microseconds.
+ */
+static unsigned long long _now (void)
+{
+  struct timespec ts;
+
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+  return (unsigned long long)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+/**
+ * Return the CPU time used by the calling thread in microseconds.
+ *
+ * @return the thread CPU time in microseconds.
+ */
+static unsigned long long _cpuTime (void)
+{
+  struct timespec ts;
+
+  clock_gettime (CLOCK_THREAD_CPUTIME_ID, &ts);
+  return (unsigned long long)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+/**
+ * Stand-in for the sign call of the SRxCryptoAPI. Uses the configured CPU time
+ * per signature, like the ECDSA operation it replaces, and returns a signature
+ * over the prefix.
+ *
+ * @param count The number of signature blocks.
+ * @param bgpsec_data The signing data.
+ *
+ * @return API_SUCCESS
+ */
+static int _benchSign (int count, SCA_BGPSecSignData** bgpsec_data)
+{
+  SCA_Signature *signature;
+  unsigned long long end;
+  int idx;
+
+  for (idx = 0; idx < count; idx++)
+  {
+    end = _cpuTime () + signCost;
+    while (_cpuTime () < end);
+
+    signature = calloc (1, sizeof(SCA_Signature));
+    signature->sigBuff    = calloc (1, BENCH_SIG_LEN);
+    signature->sigLen     = BENCH_SIG_LEN;
+    signature->ownedByAPI = false;
+    signature->algoID     = bgpsec_data[idx]->algorithmID;
+    memcpy (signature->sigBuff, bgpsec_data[idx]->nlri,
+            sizeof(SCA_Prefix) < BENCH_SIG_LEN ? sizeof(SCA_Prefix)
+                                               : BENCH_SIG_LEN);
+    bgpsec_data[idx]->signature = signature;
+  }
+
+  return API_SUCCESS;
+}
+
+/* The memory is released by the caller */
+static bool _benchFreeSignature (SCA_Signature* signature)
+{
+  return API_FAILURE;
+}
+
+static bool _benchFreeHashMessage (SCA_HashMessage* hashMessage)
+{
+  return false;
+}
+
+/**
+ * Generate the signature of the prefix as it is done while the update is
+ * built and release it again.
+ *
+ * @param bgp The bgp instance.
+ * @param peer The peer the update is built for.
+ * @param pfx The prefix.
+ *
+ * @return true if a signature was generated.
+ */
+static bool _buildUpdate (struct bgp *bgp, struct peer *peer,
+                          struct prefix *pfx)
+{
+  struct attr attr;
+  SCA_Signature *signature;
+
+  memset (&attr, 0, sizeof(struct attr));
+  signature = signBGPSecPathAttr (bgp, peer, pfx, &attr, 1, 0);
+  if (signature == NULL)
+  {
+    return false;
+  }
+  if (bgp->srxCAPI->freeSignature (signature) == API_FAILURE)
+  {
+    free (signature->sigBuff);
+    free (signature);
+  }
+  return true;
+}
+
+/**
+ * Send all prefixes to the peer, the signatures are requested from the crypto
+ * workers ahead of the update being built the same way
+ * bgp_update_sign_pending() does. Without prefetch window every signature is
+ * generated inline.
+ *
+ * @param bgp The bgp instance.
+ * @param peer The peer the updates are built for.
+ * @param pfx The prefixes.
+ * @param noPrefixes The number of prefixes.
+ *
+ * @return the time until all updates were built in microseconds.
+ */
+static unsigned long long _converge (struct bgp *bgp, struct peer *peer,
+                                     struct prefix *pfx, int noPrefixes)
+{
+  unsigned long long start = _now ();
+  enum sign_cache_state state;
+  struct attr attr;
+  struct thread thread;
+  bool submitted;
+  int head = 0;
+  int idx;
+
+  memset (&attr, 0, sizeof(struct attr));
+  while (head < noPrefixes)
+  {
+    state = requestBGPSecSignature (bgp, peer, &pfx[head], &attr, 1, 0,
+                                    &submitted);
+    idx = head + bgp->srx_signPrefetch - 1;
+    for (idx = idx < noPrefixes ? idx : noPrefixes - 1; idx > head; idx--)
+    {
+      if (requestBGPSecSignature (bgp, peer, &pfx[idx], &attr, 1, 0,
+                                  &submitted) != SIGN_CACHE_MISSING
+          && !submitted)
+      {
+        break;
+      }
+    }
+
+    if (state == SIGN_CACHE_PENDING)
+    {
+      // Wait for the wake-up of the crypto workers.
+      if (thread_fetch (bm->master, &thread))
+      {
+        thread_call (&thread);
+      }
+      continue;
+    }
+
+    if (!_buildUpdate (bgp, peer, &pfx[head]))
+    {
+      printf ("Error: no signature for prefix %d\n", head);
+      exit (EXIT_FAILURE);
+    }
+    head++;
+  }
+
+  return _now () - start;
+}
+
+/*
+ * Compare inline signing with signing by the crypto workers for growing
+ * numbers of prefixes.
+ */
+int main (int argc, char** argv)
+{
+  static int tableSizes[] = { 1000, 10000, 50000 };
+  SRxCryptoAPI capi;
+  struct bgp bgp;
+  struct peer peer;
+  struct prefix *pfx;
+  struct sign_cache_stats scStats;
+  struct crypto_pool_stats cpStats;
+  unsigned long long inlineTime, pipelineTime;
+  unsigned long hits;
+  int workers  = SRX_CRYPTO_WORKERS;
+  int prefetch = SRX_SIGN_PREFETCH;
+  int opt, test, idx;
+
+  while ((opt = getopt (argc, argv, "w:p:c:")) != -1)
+  {
+    switch (opt)
+    {
+      case 'w': workers  = atoi (optarg); break;
+      case 'p': prefetch = atoi (optarg); break;
+      case 'c': signCost = atol (optarg); break;
+      default:
+        printf ("Usage: %s [-w workers] [-p prefetch] "
+                "[-c usec per signature]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+  }
+  if (workers <= 0 || prefetch <= 0)
+  {
+    printf ("Error: workers and prefetch must be greater than 0\n");
+    return EXIT_FAILURE;
+  }
+
+  master = thread_master_create ();
+  bgp_master_init ();
+
+  memset (&capi, 0, sizeof(SRxCryptoAPI));
+  capi.sign            = _benchSign;
+  capi.freeSignature   = _benchFreeSignature;
+  capi.freeHashMessage = _benchFreeHashMessage;
+
+  memset (&bgp, 0, sizeof(struct bgp));
+  bgp.as      = 65000;
+  bgp.srxCAPI = &capi;
+  bgp.srx_bgpsec_key[0].algoID = SCA_ECDSA_ALGORITHM;
+  bgp.srx_signCache = sign_cache_new (SRX_SIGN_CACHE_KB_MAX * 1024UL);
+
+  memset (&peer, 0, sizeof(struct peer));
+  peer.as     = 65001;
+  peer.lock   = 1;
+  peer.status = Idle;
+
+  printf ("BGPsec signing of a table for one eBGP peer, %ld us per "
+          "signature, %d workers, prefetch %d\n", signCost, workers, prefetch);
+  printf ("%10s %14s %14s %9s %11s\n", "prefixes", "inline [ms]",
+          "workers [ms]", "speedup", "sign calls");
+
+  for (test = 0; test < sizeof(tableSizes) / sizeof(int); test++)
+  {
+    pfx = calloc (tableSizes[test], sizeof(struct prefix));
+    for (idx = 0; idx < tableSizes[test]; idx++)
+    {
+      pfx[idx].family    = AF_INET;
+      pfx[idx].prefixlen = 24;
+      pfx[idx].u.prefix4.s_addr = htonl (0x0A000000 + (idx << 8));
+    }
+
+    // Inline, every update waits for its own signature.
+    sign_cache_flush (bgp.srx_signCache);
+    bgp.srx_cryptoWorkers = 0;
+    bgp.srx_signPrefetch  = 1;
+    inlineTime = _converge (&bgp, &peer, pfx, tableSizes[test]);
+
+    // Signed ahead by the crypto workers.
+    sign_cache_flush (bgp.srx_signCache);
+    sign_cache_statistics (bgp.srx_signCache, &scStats);
+    hits = scStats.hits;
+    bgp.srx_cryptoWorkers = workers;
+    bgp.srx_signPrefetch  = prefetch;
+    pipelineTime = _converge (&bgp, &peer, pfx, tableSizes[test]);
+
+    crypto_pool_statistics (bgp.srx_cryptoPool, &cpStats);
+    sign_cache_statistics (bgp.srx_signCache, &scStats);
+    crypto_pool_free (&bgp.srx_cryptoPool);
+    if (cpStats.signJobs != tableSizes[test] || cpStats.signFailed > 0
+        || scStats.hits - hits != tableSizes[test])
+    {
+      printf ("Error: %lu of %d signatures generated by the workers\n",
+              cpStats.signJobs - cpStats.signFailed, tableSizes[test]);
+      return EXIT_FAILURE;
+    }
+
+    printf ("%10d %14.1f %14.1f %8.2fx %11lu\n", tableSizes[test],
+            inlineTime / 1000.0, pipelineTime / 1000.0,
+            (double)inlineTime / pipelineTime, cpStats.batches);
+    free (pfx);
+  }
+
+  sign_cache_free (&bgp.srx_signCache);
+  thread_master_free (master);
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,266 @@
+/**
+ * This software was developed at the National Institute of Standards and
+ * Technology by employees of the Federal Government in the course of
+ * their official duties. Pursuant to title 17 Section 105 of the United
+ * States Code this software is not subject to copyright protection and
+ * is in the public domain.
+ *
+ * NIST assumes no responsibility whatsoever for its use by other parties,
+ * and makes no guarantees, expressed or implied, about its quality,
+ * reliability, or any other characteristic.
+ *
+ * We would appreciate acknowledgment if the software is used.
+ *
+ * NIST ALLOWS FREE USE OF THIS SOFTWARE IN ITS "AS IS" CONDITION AND
+ * DISCLAIM ANY LIABILITY OF ANY KIND FOR ANY DAMAGES WHATSOEVER RESULTING
+ * FROM THE USE OF THIS SOFTWARE.
+ *
+ * This software might use libraries that are under GNU public license or
+ * other licenses. Please refer to the licenses of all libraries required
+ * by this software.
+ *
+ * Benchmark of the thread master loop. A read thread waits on each of a
+ * number of sockets, like on the sessions of a route server, while one of
+ * them at a time receives data. Measures the time the loop needs to run the
+ * read thread of the socket that became readable. The backend of the loop,
+ * select() or epoll, is chosen by configure (--enable-epoll); run the program
+ * of both builds to compare them. The select() backend cannot poll
+ * descriptors beyond FD_SETSIZE.
+ *
+ * Usage: thread_fd_bench [-r rounds]
+ *
+ * @version 0.6.0.4
+ *
+ * Changelog:
+ * -----------------------------------------------------------------------------
+ * 0.6.0.4 - 2026/10/17
+ *           * File created
+ */
+#include <zebra.h>
+#include <pthread.h>
+#include <sys/resource.h>
+
+#include "thread.h"
+#include "network.h"
+#include "log.h"
+
+static struct thread_master *master = NULL;
+
+/* Read side and write side of each socket pair */
+static int (*socks)[2];
+
+/* Number of read threads run */
+static unsigned long reads = 0;
+
+/**
+ * Return the current time in microseconds.
+ *
+ * @return the monotonic time in microseconds.
+ */
+static unsigned long long _now (void)
+{
+  struct timespec ts;
+
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+  return (unsigned long long)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+/**
+ * Read thread of a socket, consumes the data and waits for the next.
+ *
+ * @param thread The read thread.
+ *
+ * @return 0
+ */
+static int _sockRead (struct thread *thread)
+{
+  char buf[16];
+
+  while (read (THREAD_FD (thread), buf, sizeof(buf)) > 0);
+  reads++;
+  thread_add_read (master, _sockRead, NULL, THREAD_FD (thread));
+  return 0;
+}
+
+/**
+ * Read thread of the wake-up descriptor.
+ *
+ * @param thread The event fd thread.
+ *
+ * @return 0
+ */
+static int _wakeRead (struct thread *thread)
+{
+  reads += thread_event_fd_clear (THREAD_ARG (thread));
+  return 0;
+}
+
+/**
+ * Worker thread that wakes up the thread master.
+ *
+ * @param arg The wake-up descriptor.
+ *
+ * @return NULL
+ */
+static void* _wakeWorker (void* arg)
+{
+  thread_event_fd_signal (arg);
+  return NULL;
+}
+
+/**
+ * Run the thread master until the given number of read threads ran.
+ *
+ * @param count The number of read threads to wait for.
+ */
+static void _runUntil (unsigned long count)
+{
+  struct thread thread;
+
+  while (reads < count && thread_fetch (master, &thread))
+  {
+    thread_call (&thread);
+  }
+}
+
+/**
+ * Poll the given number of sockets and measure the loop for one readable
+ * socket at a time.
+ *
+ * @param noFds The number of sockets polled.
+ * @param rounds The number of measured loops.
+ *
+ * @return the average time per loop in microseconds or -1 if the backend
+ *         cannot poll that many sockets.
+ */
+static double _measure (int noFds, int rounds)
+{
+  unsigned long long start, time;
+  double result = -1;
+  int idx;
+
+  socks = calloc (noFds, sizeof(int[2]));
+  for (idx = 0; idx < noFds; idx++)
+  {
+    if (socketpair (AF_UNIX, SOCK_STREAM, 0, socks[idx]) != 0)
+    {
+      printf ("Error: cannot create socket pair %d: %s\n", idx,
+              safe_strerror (errno));
+      exit (EXIT_FAILURE);
+    }
+    set_nonblocking (socks[idx][0]);
+  }
+
+  for (idx = 0; idx < noFds; idx++)
+  {
+    if (thread_add_read (master, _sockRead, NULL, socks[idx][0]) == NULL)
+    {
+      break;
+    }
+  }
+
+  if (idx == noFds)
+  {
+    reads = 0;
+    start = _now ();
+    for (idx = 0; idx < rounds; idx++)
+    {
+      if (write (socks[(idx * 7919) % noFds][1], "", 1) != 1)
+      {
+        printf ("Error: cannot write to socket: %s\n", safe_strerror (errno));
+        exit (EXIT_FAILURE);
+      }
+      _runUntil (idx + 1);
+    }
+    time   = _now () - start;
+    result = (double)time / rounds;
+  }
+
+  // The read threads re-added themselves.
+  while (master->read.head != NULL)
+  {
+    thread_cancel (master->read.head);
+  }
+  for (idx = 0; idx < noFds; idx++)
+  {
+    close (socks[idx][0]);
+    close (socks[idx][1]);
+  }
+  free (socks);
+
+  return result;
+}
+
+/*
+ * Measure the thread master loop for 100 and 2,000 polled sockets.
+ */
+int main (int argc, char** argv)
+{
+  static int noFds[] = { 100, 2000 };
+  struct thread_event_fd wake;
+  struct rlimit limit;
+  pthread_t worker;
+  int rounds = 100000;
+  int opt, test;
+  double loop;
+
+  while ((opt = getopt (argc, argv, "r:")) != -1)
+  {
+    switch (opt)
+    {
+      case 'r': rounds = atoi (optarg); break;
+      default:
+        printf ("Usage: %s [-r rounds]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+  }
+  if (rounds <= 0)
+  {
+    printf ("Error: rounds must be greater than 0\n");
+    return EXIT_FAILURE;
+  }
+
+  // Two descriptors per socket pair.
+  if (getrlimit (RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur < 4200)
+  {
+    limit.rlim_cur = limit.rlim_max < 4200 ? limit.rlim_max : 4200;
+    setrlimit (RLIMIT_NOFILE, &limit);
+  }
+
+  master = thread_master_create ();
+
+  // A worker thread wakes up the loop through the event descriptor.
+  if (thread_event_fd_open (&wake) != 0)
+  {
+    printf ("Error: cannot open event fd: %s\n", safe_strerror (errno));
+    return EXIT_FAILURE;
+  }
+  thread_add_event_fd (master, _wakeRead, &wake, &wake);
+  pthread_create (&worker, NULL, _wakeWorker, &wake);
+  _runUntil (1);
+  pthread_join (worker, NULL);
+  thread_event_fd_close (&wake);
+
+#ifdef THREAD_EPOLL
+  printf ("Thread master loop with epoll, %d rounds\n", rounds);
+#else
+  printf ("Thread master loop with select, %d rounds\n", rounds);
+#endif
+  printf ("%10s %14s\n", "sockets", "loop [us]");
+  for (test = 0; test < sizeof(noFds) / sizeof(int); test++)
+  {
+    loop = _measure (noFds[test], rounds);
+    if (loop < 0)
+    {
+      printf ("%10d %14s\n", noFds[test], "n/a");
+    }
+    else
+    {
+      printf ("%10d %14.2f\n", noFds[test], loop);
+    }
+  }
+
+  thread_master_free (master);
+
+  return EXIT_SUCCESS;
+}
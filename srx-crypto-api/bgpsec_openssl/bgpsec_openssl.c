@@ -17,10 +17,22 @@
  *
  * This plug-in provides an OpenSSL ECDSA implementation for BGPSEC.
  *
- * @version 0.3.0.0
+ * @version 0.3.0.7
  *
  * ChangeLog:
  * -----------------------------------------------------------------------------
+ *   0.3.0.7 - 2026/10/17
+ *             * Added optional parallel signature verification. The init 
+ *               value "THREADS:<n>" starts a verify pool with n threads.
+ *             * Moved the verification of one signature segment into 
+ *               _verifySegment.
+ *             * Added function validateBatch which shares the key lookups
+ *               of all data objects and verifies them using the verify pool.
+ *             * Added a cache of verified signatures. The init value 
+ *               "SIGCACHE:<n>" sets its size, the statistics are provided by
+ *               getSigCacheStatistics.
+ *             * Release the key storages using ks_release.
+ *             * Keys are used within key storage read sections.
  *   0.3.0.0 - 2017/09/13 - oborchert
  *             * Modified init in such that not finding the ski-list file during
  *               init does NOT return an ERROR, it returns a USER INFO instead. 
@@ -113,6 +125,8 @@
 /* general API header which will be public to the customer side */
 #include "../srx/srxcryptoapi.h"
 #include "key_storage.h"
+#include "verify_pool.h"
+#include "sig_cache.h"
 
 /** This define is used in init() to specify if configured keys should
  * immediately be converted into EC_KEYs*/
@@ -125,6 +139,20 @@ static bool BOSSL_initialized = false;
 static KeyStorage* BOSSL_pubKeys = NULL;
 /** contains the private key storage. The more keys the slower signing. */
 static KeyStorage* BOSSL_privKeys = NULL;
+/** Number of threads used to verify the signatures of a path. 0 = sequential */
+static int BOSSL_verifyThreads = 0;
+/** The verify pool, only used if BOSSL_verifyThreads > 0 */
+static VerifyPool* BOSSL_verifyPool = NULL;
+
+/** The maximum number of cached verified signatures. 0 = no cache */
+static u_int32_t BOSSL_sigCacheSize = SC_DEF_CAPACITY;
+/** The verified signature cache, only used if BOSSL_sigCacheSize > 0 */
+static SigCache* BOSSL_sigCache = NULL;
+
+/** The init value token to configure the verify threads */
+#define BOSSL_INIT_THREADS "THREADS:"
+/** The init value token to configure the size of the signature cache */
+#define BOSSL_INIT_SIGCACHE "SIGCACHE:"
 inline void printHex(int , unsigned char* );
 
 /**
@@ -276,6 +304,66 @@ static void _readKeyFile(char* fName, bool isPrivate, sca_status_t* status,
   }
 }
 
+/**
+ * Read the numeric value of the given init value token. The value is moved 
+ * behind the token and the following ';' if present.
+ *
+ * @param value IN/OUT: The current position within the init value, it 
+ *              starts with the token.
+ * @param strLen IN/OUT: The remaining length of the init value.
+ * @param token The token.
+ * @param maxValue The maximum allowed value.
+ * @param number OUT: The number.
+ *
+ * @return true if a valid number between 0 and maxValue was read.
+ *
+ * @since 0.3.0.7
+ */
+static bool _readInitNumber(char** value, int* strLen, const char* token,
+                            long maxValue, long* number)
+{
+  char  string[MAX_CFGFILE_NAME];
+  char* endPtr = NULL;
+  int   numLength;
+
+  *value  += strlen(token);
+  *strLen -= strlen(token);
+  numLength = strcspn(*value, ";");
+  memset (&string, '\0', MAX_CFGFILE_NAME);
+  memcpy (&string, *value, MIN(numLength, MAX_CFGFILE_NAME-1));
+  *number = strtol(string, &endPtr, 10);
+  if (   (numLength == 0) || (*endPtr != '\0') 
+      || (*number < 0)    || (*number > maxValue))
+  {
+    return false;
+  }
+  *value  += numLength;
+  *strLen -= numLength;
+  if (*strLen > 0)
+  {
+    // Jump over the ';'
+    (*value)++;
+    (*strLen)--;
+  }
+  return true;
+}
+
+/**
+ * Called by the public key storage for each key that is stored or removed.
+ * All cached signatures of this SKI are invalidated.
+ *
+ * @param ski The SKI of the key.
+ *
+ * @since 0.3.0.7
+ */
+static void _pubKeyChanged(u_int8_t* ski)
+{
+  if (BOSSL_sigCache != NULL)
+  {
+    sc_invalidate(BOSSL_sigCache, ski);
+  }
+}
+
 /**
  * The init method initialized the API. Only one failure can be imagined here,
  * a consecutive call of the init method. Next to the specified error status
@@ -289,10 +377,14 @@ static void _readKeyFile(char* fName, bool isPrivate, sca_status_t* status,
  * API_STATUS_INFO_USER2: the public key init keyfile cannot be found.
  *
  * In case value is not NULL it can contain the following string:
- * <type>:<filename>[;<type>:<filename>;]
+ * <type>:<filename>[;<type>:<filename>;][THREADS:<n>;][SIGCACHE:<n>]
  * with type == PRIV for private keys and PUB == public keys.
  * Each file must have the following content structure:
  * <ASN>-SKI: <SKI HEX VALUE>
+ * THREADS:<n> enables the parallel verification of the signatures of a path
+ * using a pool of n threads (1..64). Zero (default) verifies sequentially.
+ * SIGCACHE:<n> sets the number of successfully verified signatures that are
+ * cached (default 16384). Zero disables the cache.
  *
  * This values are parsed and used to load the keys using the srxcryptoapi
  * function sca_loadKeys.
@@ -334,15 +426,45 @@ int init(const char* value, int logLevel, sca_status_t* status)
     BOSSL_privKeys = malloc(sizeof(KeyStorage));
     ks_init(BOSSL_pubKeys,  SCA_ECDSA_ALGORITHM, false);
     ks_init(BOSSL_privKeys, SCA_ECDSA_ALGORITHM, true);
+    ks_setKeyChangedCallback(BOSSL_pubKeys, _pubKeyChanged);
     // used to determine which keys are contained in a possible file.
     bool isPrivate = false;
 
     char  string[MAX_CFGFILE_NAME];
     char* tmpValue = (char*)value;
     int   strLen = (value != NULL) ? strlen(value) : 0;
+    long  number = 0;
 
     while (strLen > 0 && ((myStatus & API_STATUS_ERROR_MASK) == 0 ))
     {
+      // Check for the number of verify threads
+      if (strncmp(tmpValue, BOSSL_INIT_THREADS, 
+                  strlen(BOSSL_INIT_THREADS)) == 0)
+      {
+        if (!_readInitNumber(&tmpValue, &strLen, BOSSL_INIT_THREADS, 
+                             VP_MAX_THREADS, &number))
+        {
+          myStatus |= API_STATUS_ERR_USER2;
+          continue;
+        }
+        BOSSL_verifyThreads = (int)number;
+        continue;
+      }
+
+      // Check for the size of the signature cache
+      if (strncmp(tmpValue, BOSSL_INIT_SIGCACHE, 
+                  strlen(BOSSL_INIT_SIGCACHE)) == 0)
+      {
+        if (!_readInitNumber(&tmpValue, &strLen, BOSSL_INIT_SIGCACHE, 
+                             SC_MAX_CAPACITY, &number))
+        {
+          myStatus |= API_STATUS_ERR_USER2;
+          continue;
+        }
+        BOSSL_sigCacheSize = (u_int32_t)number;
+        continue;
+      }
+
       // Check for either value, PUB: or PRIV:
       int typeLen = strspn(tmpValue, "PUBRIV:");
       if (typeLen != 0)
@@ -427,6 +549,41 @@ int init(const char* value, int logLevel, sca_status_t* status)
     *status = myStatus;
   }
 
+  if (   ((myStatus & API_STATUS_ERROR_MASK) == API_STATUS_OK)
+      && (BOSSL_verifyThreads > 0) && (BOSSL_verifyPool == NULL))
+  {
+    BOSSL_verifyPool = vp_create(BOSSL_verifyThreads);
+    if (BOSSL_verifyPool != NULL)
+    {
+      sca_debugLog(LOG_INFO, "Parallel signature verification enabled using "
+                             "%d threads!\n", vp_getThreads(BOSSL_verifyPool));
+    }
+    else
+    {
+      // Not fatal, continue with sequential validation.
+      sca_debugLog(LOG_WARNING, "Could not start the verify pool, signatures "
+                                "are verified sequentially!\n");
+      BOSSL_verifyThreads = 0;
+    }
+  }
+
+  if (   ((myStatus & API_STATUS_ERROR_MASK) == API_STATUS_OK)
+      && (BOSSL_sigCacheSize > 0) && (BOSSL_sigCache == NULL))
+  {
+    BOSSL_sigCache = sc_create(BOSSL_sigCacheSize);
+    if (BOSSL_sigCache != NULL)
+    {
+      sca_debugLog(LOG_INFO, "Signature cache enabled for %u signatures!\n",
+                             BOSSL_sigCacheSize);
+    }
+    else
+    {
+      // Not fatal, continue without caching.
+      sca_debugLog(LOG_WARNING, "Could not create the signature cache, "
+                                "signatures are not cached!\n");
+    }
+  }
+
   if ((myStatus & API_STATUS_ERROR_MASK) == API_STATUS_OK)
   {
     BOSSL_initialized = true;
@@ -439,6 +596,8 @@ int init(const char* value, int logLevel, sca_status_t* status)
     retVal = API_FAILURE;
     ks_release(BOSSL_privKeys);
     ks_release(BOSSL_pubKeys);
+    BOSSL_verifyThreads = 0;
+    BOSSL_sigCacheSize  = SC_DEF_CAPACITY;
     BOSSL_initialized = false;
   }
 
@@ -479,18 +638,21 @@ int release(sca_status_t* status)
 {
   if (BOSSL_initialized)
   {
-    ks_empty(BOSSL_pubKeys);
-    free(BOSSL_pubKeys->head);
-    BOSSL_pubKeys->head = NULL;
-    free(BOSSL_pubKeys);
+    // Release the cache first, no need to invalidate while emptying the keys.
+    sc_release(BOSSL_sigCache);
+    BOSSL_sigCache     = NULL;
+    BOSSL_sigCacheSize = SC_DEF_CAPACITY;
+
+    ks_release(BOSSL_pubKeys);
     BOSSL_pubKeys = NULL;
 
-    ks_empty(BOSSL_privKeys);
-    free(BOSSL_privKeys->head);
-    BOSSL_privKeys->head = NULL;
-    free(BOSSL_privKeys);
+    ks_release(BOSSL_privKeys);
     BOSSL_privKeys = NULL;
 
+    vp_release(BOSSL_verifyPool);
+    BOSSL_verifyPool    = NULL;
+    BOSSL_verifyThreads = 0;
+
     BOSSL_initialized = false;
   }
 
@@ -581,28 +743,351 @@ static unsigned char* _createSha256Digest(const unsigned char* message,
 }
 
 /**
- * Perform BGPSEC path validation. This function required the keys to be
- * pre-registered to perform the validation.
- * The caller manages the memory and MUST assure the memory is intact until
- * the function returns.
+ * Determine the signer ASN and the signature segment of the given hash
+ * message segment.
  *
- * The following error status codes can be set:
+ * @param hashMessage The hash message.
+ * @param idx The index of the segment.
+ * @param sigSeg OUT: the signature segment.
  *
- * API_STATUS_ERR_USER1: The hash input could not be generated
- * API_STATUS_ERR_INVALID_KEY: The hex key retrieved from the storage is NULL.
- * API_STATUS_NO_DATA: No data to validate passed.
- * API_STATUS_INFO_KEY_NOTFOUND: One or more of the keys could not be found.
- * API_STATUS_INFO_SIGNATURE: One or more signatures could not be validated.
+ * @return Pointer to the ASN (network format) of the signer.
  *
+ * @since 0.3.0.7
+ */
+static u_int32_t* _getSigner(SCA_HashMessage* hashMessage, int idx,
+                             SCA_BGPSEC_SignatureSegment** sigSeg)
+{
+  u_int32_t* asn = NULL;
+
+  // We want to have the signer key, This will be found in the next
+  // path segment.
+  if (idx+1 < hashMessage->segmentCount)
+  {
+    asn = (u_int32_t*)hashMessage->hashMessageValPtr[idx+1]->hashMessagePtr;
+  }
+  else
+  {
+    // Jump to the origin AS
+    asn = (u_int32_t*)(hashMessage->hashMessageValPtr[idx]->hashMessagePtr+6);
+  }
+  *sigSeg = (SCA_BGPSEC_SignatureSegment*)
+                              hashMessage->hashMessageValPtr[idx]->signaturePtr;
+
+  return asn;
+}
+
+/**
+ * Verify the signature of one segment using the given keys. This function 
+ * generates the message digest and performs the ECDSA verification. It does 
+ * not access the key storage and therefore can be called by multiple threads
+ * concurrently. If the signature cache is enabled, a signature that was 
+ * verified successfully before is not verified again.
  *
- * @param data This structure contains all necessary information to perform
- *             the path validation. The status flag will contain more
- *             information
+ * The following status flags can be added:
  *
- * @return API_VALRESULT_VALID(1) or API_VALRESULT_INVALID(0). For 0 refer to
- *          the status code. Internal errors result in invalid.
+ * API_STATUS_ERR_INVALID_KEY: The key array contains a NULL key.
+ * API_STATUS_INFO_SIGNATURE: The signature could not be validated.
+ *
+ * @param hashMessage The hash message.
+ * @param idx The index of the segment.
+ * @param ecdsa_key The keys of the signer as returned by the key storage.
+ * @param noKeys The number of keys.
+ * @param status The status flags will be added to this status.
+ *
+ * @return API_VALRESULT_VALID or API_VALRESULT_INVALID
+ *
+ * @since 0.3.0.7
  */
-int validate(SCA_BGPSecValidationData* data)
+static int _verifySegment(SCA_HashMessage* hashMessage, int idx,
+                          EC_KEY** ecdsa_key, u_int16_t noKeys,
+                          sca_status_t* status)
+{
+  int retVal = API_VALRESULT_INVALID;
+  SCA_BGPSEC_SignatureSegment* sigSeg =
+       (SCA_BGPSEC_SignatureSegment*)hashMessage->hashMessageValPtr[idx]->signaturePtr;
+  SCA_BGPSEC_SignatureSegment* signerSeg = NULL;
+  u_int8_t*  signature = NULL;
+  u_int16_t  sigLength = 0;
+  u_int32_t  signer    = 0;
+  sca_status_t statusIn = *status;
+  int ecIdx = 0;
+
+  // Temporary space for the generated message digest (hash)
+  u_int8_t hashDigest[SHA256_DIGEST_LENGTH];
+  // The hash of the signature, only used for the signature cache
+  u_int8_t sigHash[SHA256_DIGEST_LENGTH];
+
+  // Generate the hash (messageDigest that will be signed.)
+  _createSha256Digest (
+               hashMessage->hashMessageValPtr[idx]->hashMessagePtr,
+               hashMessage->hashMessageValPtr[idx]->hashMessageLength,
+               (u_int8_t*)&hashDigest);
+
+  if (sca_getCurrentLogLevel() >= LOG_DEBUG)
+  {
+    sca_debugLog(LOG_DEBUG, "\nHash(validate):");
+    printHex(hashMessage->hashMessageValPtr[idx]->hashMessageLength,
+             hashMessage->hashMessageValPtr[idx]->hashMessagePtr);
+    sca_debugLog(LOG_DEBUG, "\nDigest(validate):");
+    printHex(SHA256_DIGEST_LENGTH, (u_int8_t*)hashDigest);
+  }
+
+  signature = hashMessage->hashMessageValPtr[idx]->signaturePtr
+              + sizeof(SCA_BGPSEC_SignatureSegment);
+  // find the signature:
+  sigLength = ntohs(sigSeg->siglen);
+
+  if (BOSSL_sigCache != NULL)
+  {
+    signer = *_getSigner(hashMessage, idx, &signerSeg);
+    _createSha256Digest(signature, sigLength, (u_int8_t*)&sigHash);
+    if (sc_lookup(BOSSL_sigCache, signer, sigSeg->ski, hashDigest, sigHash))
+    {
+      sca_debugLog(LOG_DEBUG, "\033[92m""stack[%d] VERIFY SUCCESS (cached)"
+                              "\033[0m \n", idx+1);
+      return API_VALRESULT_VALID;
+    }
+  }
+
+  for (ecIdx=0; ecIdx < noKeys && retVal==API_VALRESULT_INVALID; ecIdx++)
+  {
+    if (ecdsa_key[ecIdx] != NULL)
+    { // Toggle through the keys
+      /* verify the signature */
+      if (ECDSA_verify(0, hashDigest, SHA256_DIGEST_LENGTH,
+                       signature, sigLength, ecdsa_key[ecIdx])
+         == 1)
+      {
+        retVal = API_VALRESULT_VALID;
+        sca_debugLog(LOG_DEBUG, "\033[92m""stack[%d] VERIFY SUCCESS""\033[0m \n", idx+1);
+      }
+      else
+      {
+        retVal = API_VALRESULT_INVALID;
+        sca_debugLog(LOG_DEBUG,
+            "\033[91m""stack[%d] VERIFY FAILED (SKI: %02X%02X%02X%02X)""\033[0m \n",
+            idx+1,
+            sigSeg->ski[0], sigSeg->ski[1], sigSeg->ski[2], sigSeg->ski[3]);
+        break;
+      }
+    }
+    else
+    {
+      // Most likely a registration error!
+      *status |= API_STATUS_ERR_INVLID_KEY;
+      sca_debugLog(LOG_WARNING, "The key storage returned a NULL eckey\n");
+    }
+  }
+
+  if (retVal == API_VALRESULT_INVALID)
+  {
+    *status |= API_STATUS_INFO_SIGNATURE;
+    sca_debugLog(LOG_DEBUG, "[%s:%d] verify failed and quit: ret:%d idx:%d, ecIdx:%d\n",
+        __FUNCTION__, __LINE__, retVal, idx, ecIdx );
+  }
+  else if ((BOSSL_sigCache != NULL) && (*status == statusIn))
+  {
+    // Only cache clean verifications, a cache hit does not add any status.
+    sc_insert(BOSSL_sigCache, signer, sigSeg->ski, hashDigest, sigHash);
+  }
+
+  return retVal;
+}
+
+/**
+ * Log that no key was found for the given signature segment.
+ *
+ * @param sigSeg The signature segment
+ *
+ * @since 0.3.0.7
+ */
+static void _logKeyNotFound(SCA_BGPSEC_SignatureSegment* sigSeg)
+{
+  sca_debugLog(LOG_DEBUG,
+      "\033[91m""NO KEY -> VERIFY FAILED (SKI: %02X%02X%02X%02X)""\033[0m \n",
+            sigSeg->ski[0], sigSeg->ski[1], sigSeg->ski[2], sigSeg->ski[3]);
+}
+
+/**
+ * Validate all signatures of the path one after the other. The validation 
+ * stops with the first signature that can not be validated.
+ *
+ * @param data The validation data containing the generated hash message.
+ *
+ * @return API_VALRESULT_VALID or API_VALRESULT_INVALID
+ *
+ * @since 0.3.0.7
+ */
+static int _validateSequential(SCA_BGPSecValidationData* data)
+{
+  int retVal = API_VALRESULT_VALID;
+  SCA_HashMessage* hashMessage = data->hashMessage[0];
+  u_int32_t* asn       = NULL;
+  EC_KEY**   ecdsa_key = NULL;
+  SCA_BGPSEC_SignatureSegment* sigSeg = NULL;
+  u_int16_t  noKeys = 0;
+  int idx = 0;
+  // The keys stay valid until the read section ends.
+  u_int32_t  epoch = ks_beginRead(BOSSL_pubKeys);
+
+  for (; idx < hashMessage->segmentCount; idx++)
+  {
+    asn = _getSigner(hashMessage, idx, &sigSeg);
+
+    /* The OpenSSL encoded key. */
+    ecdsa_key = (EC_KEY**)ks_getKey(BOSSL_pubKeys, sigSeg->ski, *asn,
+                          &noKeys, ks_eckey_e, &data->status);
+    if (ecdsa_key != NULL)
+    {
+      retVal = _verifySegment(hashMessage, idx, ecdsa_key, noKeys, 
+                              &data->status);
+      if (retVal == API_VALRESULT_INVALID)
+      {
+        break; // No further validation needed
+      }
+    }
+    else
+    {
+      retVal = API_VALRESULT_INVALID;
+      data->status |= API_STATUS_INFO_KEY_NOTFOUND;
+      _logKeyNotFound(sigSeg);
+      break; // No further validation needed
+    }
+  }
+  ks_endRead(BOSSL_pubKeys, epoch);
+
+  return retVal;
+}
+
+/**
+ * Context of one parallel path validation. Each array contains one element 
+ * per signature segment.
+ *
+ * @since 0.3.0.7
+ */
+typedef struct {
+  /** The hash message of the path. */
+  SCA_HashMessage* hashMessage;
+  /** The keys of each segment. */
+  EC_KEY***        keys;
+  /** The number of keys of each segment. */
+  u_int16_t*       noKeys;
+  /** The status of each segment. */
+  sca_status_t*    status;
+} BOSSL_ValidationJob;
+
+/**
+ * Verify pool task, verifies one signature segment.
+ *
+ * @param context The validation job (BOSSL_ValidationJob)
+ * @param idx The index of the segment.
+ *
+ * @return true if the signature could be validated.
+ *
+ * @since 0.3.0.7
+ */
+static bool _verifySegmentTask(void* context, int idx)
+{
+  BOSSL_ValidationJob* job = (BOSSL_ValidationJob*)context;
+
+  return _verifySegment(job->hashMessage, idx, job->keys[idx], 
+                        job->noKeys[idx], &job->status[idx]) 
+         == API_VALRESULT_VALID;
+}
+
+/**
+ * Validate all signatures of the path in parallel using the verify pool. The
+ * keys are retrieved first in the calling thread, only the digest generation
+ * and signature verification is performed by the pool. Once a signature 
+ * fails, signatures of later segments are not verified anymore.
+ *
+ * The result and status are exactly the same as in the sequential validation:
+ * the status is the one of the first segment that failed or of the last 
+ * segment if all signatures are valid.
+ *
+ * @param data The validation data containing the generated hash message.
+ *
+ * @return API_VALRESULT_VALID or API_VALRESULT_INVALID
+ *
+ * @since 0.3.0.7
+ */
+static int _validateParallel(SCA_BGPSecValidationData* data)
+{
+  SCA_HashMessage* hashMessage = data->hashMessage[0];
+  int              segCount    = hashMessage->segmentCount;
+  EC_KEY**         keys[segCount];
+  u_int16_t        noKeys[segCount];
+  sca_status_t     status[segCount];
+  SCA_BGPSEC_SignatureSegment* sigSeg = NULL;
+  BOSSL_ValidationJob job;
+  u_int32_t* asn      = NULL;
+  int        keyCount = 0;
+  int        lastIdx  = 0;
+  int        failed   = -1;
+  int        retVal   = API_VALRESULT_INVALID;
+
+  u_int32_t  epoch    = 0;
+
+  memset(noKeys, 0, sizeof(noKeys));
+  memset(status, 0, sizeof(status));
+
+  // Retrieve the keys in order, the key storage is not accessed by the pool.
+  // The keys stay valid until the read section ends.
+  epoch = ks_beginRead(BOSSL_pubKeys);
+  for (; keyCount < segCount; keyCount++)
+  {
+    asn = _getSigner(hashMessage, keyCount, &sigSeg);
+    keys[keyCount] = (EC_KEY**)ks_getKey(BOSSL_pubKeys, sigSeg->ski, *asn,
+                                         &noKeys[keyCount], ks_eckey_e, 
+                                         &status[keyCount]);
+    if (keys[keyCount] == NULL)
+    {
+      status[keyCount] |= API_STATUS_INFO_KEY_NOTFOUND;
+      _logKeyNotFound(sigSeg);
+      break;
+    }
+  }
+
+  job.hashMessage = hashMessage;
+  job.keys        = keys;
+  job.noKeys      = noKeys;
+  job.status      = status;
+  failed = vp_run(BOSSL_verifyPool, _verifySegmentTask, &job, keyCount);
+  ks_endRead(BOSSL_pubKeys, epoch);
+
+  if (failed != -1)
+  {
+    // A signature failed before a possibly missing key.
+    lastIdx = failed;
+  }
+  else if (keyCount < segCount)
+  {
+    // All signatures up to the missing key are valid.
+    lastIdx = keyCount;
+  }
+  else
+  {
+    lastIdx = segCount - 1;
+    retVal  = API_VALRESULT_VALID;
+  }
+  data->status = status[lastIdx];
+
+  return retVal;
+}
+
+/**
+ * Perform the preliminary checks of the validation data and generate the hash
+ * message if none was generated prior. The status of the data is set 
+ * accordingly.
+ *
+ * @param data The validation data.
+ *
+ * @return API_VALRESULT_VALID if the signatures can be verified, otherwise
+ *         API_VALRESULT_INVALID.
+ *
+ * @since 0.3.0.7
+ */
+static int _prepareValidation(SCA_BGPSecValidationData* data)
 {
   // @TODO: Currently we only deal with the first validation data result.
   //       It needs to be modified in such that it uses both results [0] and [1]
@@ -640,116 +1125,355 @@ int validate(SCA_BGPSecValidationData* data)
     }
   }
 
+  return retVal;
+}
+
+/**
+ * Perform BGPSEC path validation. This function required the keys to be
+ * pre-registered to perform the validation.
+ * The caller manages the memory and MUST assure the memory is intact until
+ * the function returns.
+ *
+ * The following error status codes can be set:
+ *
+ * API_STATUS_ERR_USER1: The hash input could not be generated
+ * API_STATUS_ERR_INVALID_KEY: The hex key retrieved from the storage is NULL.
+ * API_STATUS_NO_DATA: No data to validate passed.
+ * API_STATUS_INFO_KEY_NOTFOUND: One or more of the keys could not be found.
+ * API_STATUS_INFO_SIGNATURE: One or more signatures could not be validated.
+ *
+ *
+ * @param data This structure contains all necessary information to perform
+ *             the path validation. The status flag will contain more
+ *             information
+ *
+ * @return API_VALRESULT_VALID(1) or API_VALRESULT_INVALID(0). For 0 refer to
+ *          the status code. Internal errors result in invalid.
+ */
+int validate(SCA_BGPSecValidationData* data)
+{
+  int retVal = _prepareValidation(data);
+
   // Now perform validation
   if (retVal == API_VALRESULT_VALID)
   {
-    // Now we can validate each signature -> This can be multi threaded
-    // in this case the variables below need to be declared in each thread
-    // separately.
-    u_int32_t* asn       = NULL;
-    EC_KEY**   ecdsa_key = NULL;
-    u_int8_t*  signature = NULL;
-    u_int16_t  sigLength = 0;
-    SCA_BGPSEC_SignatureSegment* sigSeg = NULL;
-    int idx = 0;
+    if ((BOSSL_verifyPool != NULL) && (data->hashMessage[0]->segmentCount > 1))
+    {
+      retVal = _validateParallel(data);
+    }
+    else
+    {
+      retVal = _validateSequential(data);
+    }
+  }
 
-    u_int16_t noKeys = 0;
-    int ecIdx = 0;
+  return retVal;
+}
+
+/**
+ * Key lookup shared by all signature segments of a batch that are signed by
+ * the same ASN and SKI.
+ *
+ * @since 0.3.0.7
+ */
+typedef struct {
+  /** Indicates if this slot is in use. */
+  bool         used;
+  /** The ASN of the signer (network format). */
+  u_int32_t    asn;
+  /** The SKI of the signer. */
+  u_int8_t*    ski;
+  /** The keys as returned by the key storage, NULL if not found. */
+  EC_KEY**     keys;
+  /** The number of keys. */
+  u_int16_t    noKeys;
+  /** The status as returned by the key storage. */
+  sca_status_t status;
+} BOSSL_KeyLookup;
 
-    // Temporary space for the generated message digest (hash)
-    u_int8_t hashDigest[SHA256_DIGEST_LENGTH];
+/**
+ * One signature segment to be verified within a batch.
+ *
+ * @since 0.3.0.7
+ */
+typedef struct {
+  /** The hash message of the path. */
+  SCA_HashMessage* hashMessage;
+  /** The index of the segment within the hash message. */
+  int              segment;
+  /** The key lookup of the signer. */
+  BOSSL_KeyLookup* key;
+  /** The status of the verification. */
+  sca_status_t     status;
+  /** The result of the verification. */
+  bool             valid;
+} BOSSL_BatchTask;
 
-    for (; idx < data->hashMessage[0]->segmentCount; idx++)
+/**
+ * Book keeping of one data object within a batch.
+ *
+ * @since 0.3.0.7
+ */
+typedef struct {
+  /** The index of the first task of this data object. */
+  int              firstTask;
+  /** The number of tasks of this data object. */
+  int              noTasks;
+  /** The key lookup that did not find a key, NULL if all keys are found. */
+  BOSSL_KeyLookup* missingKey;
+} BOSSL_BatchItem;
+
+/**
+ * Return the key lookup for the given signer. The key storage is only queried 
+ * once per signer and batch.
+ *
+ * @param lookups The open addressed table of key lookups.
+ * @param mask The size of the table minus one (size is a power of 2).
+ * @param asn The ASN of the signer (network format).
+ * @param ski The SKI of the signer.
+ *
+ * @return The key lookup.
+ *
+ * @since 0.3.0.7
+ */
+static BOSSL_KeyLookup* _lookupBatchKey(BOSSL_KeyLookup* lookups, u_int32_t mask,
+                                        u_int32_t asn, u_int8_t* ski)
+{
+  u_int32_t hash = asn;
+  int idx = 0;
+  BOSSL_KeyLookup* lookup = NULL;
+
+  for (idx = 0; idx < SKI_LENGTH; idx++)
+  {
+    hash = (hash * 31) + ski[idx];
+  }
+  hash &= mask;
+
+  // The table is at least twice as large as the number of signers.
+  while (lookups[hash].used)
+  {
+    if ((lookups[hash].asn == asn)
+        && (memcmp(lookups[hash].ski, ski, SKI_LENGTH) == 0))
     {
-      // We want to have the signer key, This will be found in the next
-      // path segment.
-      if (idx+1 < data->hashMessage[0]->segmentCount)
+      return &lookups[hash];
+    }
+    hash = (hash + 1) & mask;
+  }
+
+  lookup = &lookups[hash];
+  lookup->used   = true;
+  lookup->asn    = asn;
+  lookup->ski    = ski;
+  lookup->status = API_STATUS_OK;
+  lookup->keys   = (EC_KEY**)ks_getKey(BOSSL_pubKeys, ski, asn, 
+                                       &lookup->noKeys, ks_eckey_e, 
+                                       &lookup->status);
+  return lookup;
+}
+
+/**
+ * Verify pool task, verifies one signature segment of a batch. A failing 
+ * signature does not stop the verification of the other tasks because they 
+ * might belong to other data objects.
+ *
+ * @param context The batch tasks (BOSSL_BatchTask)
+ * @param idx The index of the task.
+ *
+ * @return true
+ *
+ * @since 0.3.0.7
+ */
+static bool _verifyBatchTask(void* context, int idx)
+{
+  BOSSL_BatchTask* task = &((BOSSL_BatchTask*)context)[idx];
+
+  task->status = task->key->status;
+  task->valid  = _verifySegment(task->hashMessage, task->segment, 
+                                task->key->keys, task->key->noKeys, 
+                                &task->status) == API_VALRESULT_VALID;
+  return true;
+}
+
+/**
+ * Perform BGPSEC path validation of multiple data objects. Each data object 
+ * is validated exactly like validate does it. The key storage is queried only
+ * once per signer within the batch. If the verify pool is enabled the 
+ * signatures of all data objects are verified in parallel, otherwise the 
+ * verification of a data object stops with the first signature that can not 
+ * be validated.
+ *
+ * @param count The number of data elements in the given array
+ * @param data Array containing the data objects to be validated.
+ *
+ * @return API_VALRESULT_VALID if all data objects are valid, otherwise
+ *         API_VALRESULT_INVALID (check valResult and status of each data 
+ *         object).
+ *
+ * @since 0.3.0.7
+ */
+int validateBatch(int count, SCA_BGPSecValidationData** data)
+{
+  int retVal = API_VALRESULT_VALID;
+  BOSSL_BatchItem* items   = NULL;
+  BOSSL_BatchTask* tasks   = NULL;
+  BOSSL_KeyLookup* lookups = NULL;
+  SCA_HashMessage* hashMessage = NULL;
+  SCA_BGPSEC_SignatureSegment* sigSeg = NULL;
+  BOSSL_BatchTask* task = NULL;
+  u_int32_t* asn     = NULL;
+  u_int32_t  mask    = 1;
+  u_int32_t  epoch   = 0;
+  int        noTasks = 0;
+  int        idx     = 0;
+  int        segIdx  = 0;
+
+  if ((data == NULL) || (count <= 0))
+  {
+    return retVal;
+  }
+
+  // Do the preliminary checks and count the segments.
+  for (idx = 0; idx < count; idx++)
+  {
+    data[idx]->valResult = _prepareValidation(data[idx]);
+    if (data[idx]->valResult == API_VALRESULT_VALID)
+    {
+      noTasks += data[idx]->hashMessage[0]->segmentCount;
+    }
+  }
+
+  while (mask < (u_int32_t)(noTasks * 2))
+  {
+    mask <<= 1;
+  }
+  items   = calloc(count, sizeof(BOSSL_BatchItem));
+  tasks   = calloc(noTasks + 1, sizeof(BOSSL_BatchTask));
+  lookups = calloc(mask, sizeof(BOSSL_KeyLookup));
+  mask--;
+
+  if ((items == NULL) || (tasks == NULL) || (lookups == NULL))
+  {
+    sca_debugLog(LOG_WARNING, "Not enough memory for batch validation, "
+                              "validate one by one!\n");
+    for (idx = 0; idx < count; idx++)
+    {
+      if (data[idx]->valResult == API_VALRESULT_VALID)
       {
-        asn = (u_int32_t*)data->hashMessage[0]->hashMessageValPtr[idx+1]->hashMessagePtr;
+        data[idx]->valResult = 
+          ((BOSSL_verifyPool != NULL) 
+           && (data[idx]->hashMessage[0]->segmentCount > 1))
+          ? _validateParallel(data[idx]) : _validateSequential(data[idx]);
       }
-      else
+    }
+  }
+  else
+  {
+    // Retrieve the keys of each data object in order up to the first signer
+    // without a key. The keys stay valid until the read section ends.
+    epoch   = ks_beginRead(BOSSL_pubKeys);
+    noTasks = 0;
+    for (idx = 0; idx < count; idx++)
+    {
+      items[idx].firstTask = noTasks;
+      if (data[idx]->valResult != API_VALRESULT_VALID)
       {
-        // Jump to the origin AS
-        asn = (u_int32_t*)(data->hashMessage[0]->hashMessageValPtr[idx]->hashMessagePtr+6);
+        continue;
       }
-      sigSeg = (SCA_BGPSEC_SignatureSegment*)data->hashMessage[0]->hashMessageValPtr[idx]->signaturePtr;
-
-      /* The OpenSSL encoded key. */
-      ecdsa_key = (EC_KEY**)ks_getKey(BOSSL_pubKeys, sigSeg->ski, *asn,
-                            &noKeys, ks_eckey_e, &data->status);
-      if (ecdsa_key != NULL)
+      hashMessage = data[idx]->hashMessage[0];
+      for (segIdx = 0; segIdx < hashMessage->segmentCount; segIdx++)
       {
-        // Generate the hash (messageDigest that will be signed.)
-        _createSha256Digest (
-                 data->hashMessage[0]->hashMessageValPtr[idx]->hashMessagePtr,
-                 data->hashMessage[0]->hashMessageValPtr[idx]->hashMessageLength,
-                 (u_int8_t*)&hashDigest);
-
-        if (sca_getCurrentLogLevel() >= LOG_DEBUG)
+        task = &tasks[noTasks];
+        asn  = _getSigner(hashMessage, segIdx, &sigSeg);
+        task->key = _lookupBatchKey(lookups, mask, *asn, sigSeg->ski);
+        if (task->key->keys == NULL)
         {
-          sca_debugLog(LOG_DEBUG, "\nHash(validate):");
-          printHex(data->hashMessage[0]->hashMessageValPtr[idx]->hashMessageLength,
-              data->hashMessage[0]->hashMessageValPtr[idx]->hashMessagePtr);
-          sca_debugLog(LOG_DEBUG, "\nDigest(validate):");
-          printHex(SHA256_DIGEST_LENGTH, (u_int8_t*)hashDigest);
+          items[idx].missingKey = task->key;
+          _logKeyNotFound(sigSeg);
+          break;
         }
+        task->hashMessage = hashMessage;
+        task->segment     = segIdx;
+        noTasks++;
+      }
+      items[idx].noTasks = noTasks - items[idx].firstTask;
+    }
 
-        signature = data->hashMessage[0]->hashMessageValPtr[idx]->signaturePtr
-                    + sizeof(SCA_BGPSEC_SignatureSegment);
-        // find the signature:
-        sigLength = ntohs(sigSeg->siglen);
-
-        retVal = API_VALRESULT_INVALID;
-        for (ecIdx=0; ecIdx < noKeys && retVal==API_VALRESULT_INVALID; ecIdx++)
+    if (BOSSL_verifyPool != NULL)
+    {
+      vp_run(BOSSL_verifyPool, _verifyBatchTask, tasks, noTasks);
+    }
+    else
+    {
+      for (idx = 0; idx < count; idx++)
+      {
+        for (segIdx = 0; segIdx < items[idx].noTasks; segIdx++)
         {
-          if (ecdsa_key[ecIdx] != NULL)
-          { // Toggle through the keys
-            /* verify the signature */
-            if (ECDSA_verify(0, hashDigest, SHA256_DIGEST_LENGTH,
-                             signature, sigLength, ecdsa_key[ecIdx])
-               == 1)
-            {
-              retVal = API_VALRESULT_VALID;
-              sca_debugLog(LOG_DEBUG, "\033[92m""stack[%d] VERIFY SUCCESS""\033[0m \n", idx+1);
-            }
-            else
-            {
-              retVal = API_VALRESULT_INVALID;
-              sca_debugLog(LOG_DEBUG,
-                  "\033[91m""stack[%d] VERIFY FAILED (SKI: %02X%02X%02X%02X)""\033[0m \n",
-                  idx+1,
-                  sigSeg->ski[0], sigSeg->ski[1], sigSeg->ski[2], sigSeg->ski[3]);
-              break;
-            }
-          }
-          else
+          _verifyBatchTask(tasks, items[idx].firstTask + segIdx);
+          if (!tasks[items[idx].firstTask + segIdx].valid)
           {
-            // Most likely a registration error!
-            data->status |= API_STATUS_ERR_INVLID_KEY;
-            sca_debugLog(LOG_WARNING, "The key storage returned a NULL eckey\n");
+            break; // No further validation needed
           }
         }
+      }
+    }
+    ks_endRead(BOSSL_pubKeys, epoch);
 
-        if (retVal == API_VALRESULT_INVALID)
+    // Determine the result and status of each data object the same way the 
+    // sequential validation does.
+    for (idx = 0; idx < count; idx++)
+    {
+      if (data[idx]->valResult != API_VALRESULT_VALID)
+      {
+        continue;
+      }
+      task = NULL;
+      for (segIdx = 0; segIdx < items[idx].noTasks; segIdx++)
+      {
+        task = &tasks[items[idx].firstTask + segIdx];
+        if (!task->valid)
         {
-          data->status |= API_STATUS_INFO_SIGNATURE;
-          sca_debugLog(LOG_DEBUG, "[%s:%d] verify failed and quit: ret:%d idx:%d, ecIdx:%d\n",
-              __FUNCTION__, __LINE__, retVal, idx, ecIdx );
-          break; // No further validation needed
+          break;
         }
       }
-      else
+      if ((task != NULL) && !task->valid)
       {
-        retVal = API_VALRESULT_INVALID;
-        data->status |= API_STATUS_INFO_KEY_NOTFOUND;
-        sca_debugLog(LOG_DEBUG,
-            "\033[91m""NO KEY -> VERIFY FAILED (SKI: %02X%02X%02X%02X)""\033[0m \n",
-                  sigSeg->ski[0], sigSeg->ski[1], sigSeg->ski[2], sigSeg->ski[3]);
-        break; // No further validation needed
+        data[idx]->valResult = API_VALRESULT_INVALID;
+        data[idx]->status    = task->status;
+      }
+      else if (items[idx].missingKey != NULL)
+      {
+        data[idx]->valResult = API_VALRESULT_INVALID;
+        data[idx]->status    = items[idx].missingKey->status 
+                               | API_STATUS_INFO_KEY_NOTFOUND;
+      }
+      else if (task != NULL)
+      {
+        data[idx]->status = task->status;
       }
     }
   }
 
+  for (idx = 0; idx < count; idx++)
+  {
+    if (data[idx]->valResult != API_VALRESULT_VALID)
+    {
+      retVal = API_VALRESULT_INVALID;
+    }
+  }
+
+  if (items != NULL)
+  {
+    free(items);
+  }
+  if (tasks != NULL)
+  {
+    free(tasks);
+  }
+  if (lookups != NULL)
+  {
+    free(lookups);
+  }
+
   return retVal;
 }
 
@@ -827,8 +1551,9 @@ static int _sign(SCA_BGPSecSignData* bgpsec_data)
 
   if (myStatus == API_STATUS_OK)
   {
-    // First find the key
+    // First find the key, it stays valid until the read section ends.
     u_int16_t noKeys = 0;
+    u_int32_t epoch  = ks_beginRead(BOSSL_privKeys);
     bgpsec_data->status = API_STATUS_OK;
     EC_KEY** ec_keys = (EC_KEY**)ks_getKey(BOSSL_privKeys, bgpsec_data->ski,
         bgpsec_data->myHost->asn, &noKeys,
@@ -936,6 +1661,7 @@ static int _sign(SCA_BGPSecSignData* bgpsec_data)
         retVal = API_SUCCESS;
       }
     }
+    ks_endRead(BOSSL_privKeys, epoch);
   }
 
   if (bgpsec_data != NULL)
@@ -1177,6 +1903,29 @@ bool isAlgorithmSupported(u_int8_t algoID)
   return (algoID == SCA_ECDSA_ALGORITHM);
 }
 
+/**
+ * Retrieve the statistics of the verified signature cache.
+ *
+ * @param stats OUT: The statistics of the cache.
+ *
+ * @return true if the signature cache is enabled and the statistics are 
+ *         filled, otherwise false.
+ *
+ * @since 0.3.0.7
+ */
+bool getSigCacheStatistics(SCA_SigCacheStatistics* stats)
+{
+  bool retVal = false;
+
+  if ((BOSSL_sigCache != NULL) && (stats != NULL))
+  {
+    sc_getStatistics(BOSSL_sigCache, stats);
+    retVal = true;
+  }
+
+  return retVal;
+}
+
 
 /** 
  * This function is only for the compiler to check the correct implementation
@@ -1192,6 +1941,8 @@ bool isAlgorithmSupported(u_int8_t algoID)
 
   compAPI.sign                 = sign;
   compAPI.validate             = validate;
+  compAPI.validateBatch        = validateBatch;
+  compAPI.getSigCacheStatistics = getSigCacheStatistics;
 
   compAPI.freeHashMessage      = freeHashMessage;
   compAPI.freeSignature        = freeSignature;
@@ -27,10 +27,24 @@
  * Known Issue:
  *   At this time only PEM formated private keys can be loaded.
  * 
- * @version 0.3.0.6
+ * @version 0.3.0.7
  * 
  * Changelog:
  * -----------------------------------------------------------------------------
+ *  0.3.0.7 - 2026/10/17
+ *            * Added the keyChanged callback which is called for each key that
+ *              is stored or removed.
+ *            * Replaced the 256 ASN buckets and their linked lists with an open
+ *              addressed hash table on (ASN, SKI, algorithm ID). Elements are
+ *              replaced instead of modified and the table is published 
+ *              atomically, this allows lock free lookups. Writers are 
+ *              serialized by the storage write lock.
+ *            * Keys are converted into EVP_PKEY when stored instead of lazy
+ *              conversion within ks_getKey.
+ *            * Implemented ks_removeSource.
+ *            * Readers enter an epoch using ks_beginRead, replaced memory is
+ *              freed by the next writer once no reader of its epoch or an
+ *              older one is active.
  *  0.3.0.6 - 2024/07/22 - oborchert
  *            * The number of stored keys was reduced twice when deleting. This
  *              resulted in an incorrect warning message. 
@@ -60,30 +74,126 @@
  */
 #include <stdbool.h>
 #include <syslog.h>
-#include <uthash.h>
+#include <string.h>
 #include <sys/types.h>
 #include <openssl/ec.h>
+#include <openssl/evp.h>
 #include <openssl/x509.h>
 #include "../srx/srxcryptoapi.h"
 #include "key_storage.h"
 
-#define KS_BUCKETS 256
+/** The minimum number of slots of the hash table - MUST be a power of two */
+#define KS_MIN_SLOTS 256
+/** Marks a slot of a removed element, lookups must continue probing. */
+#define KS_TOMBSTONE ((KS_Key_Element*)1)
+
+/** Read a pointer that is published by the writer. */
+#define KS_LOAD(ptr)        __atomic_load_n((ptr), __ATOMIC_ACQUIRE)
+/** Publish a pointer to the readers. */
+#define KS_STORE(ptr, val)  __atomic_store_n((ptr), (val), __ATOMIC_RELEASE)
+/** Access the read epoch and reader counters, they need a total order. */
+#define KS_EPOCH_LOAD(ptr)       __atomic_load_n((ptr), __ATOMIC_SEQ_CST)
+#define KS_EPOCH_STORE(ptr, val) __atomic_store_n((ptr), (val), __ATOMIC_SEQ_CST)
+#define KS_EPOCH_INC(ptr)        __atomic_add_fetch((ptr), 1, __ATOMIC_SEQ_CST)
+#define KS_EPOCH_DEC(ptr)        __atomic_sub_fetch((ptr), 1, __ATOMIC_SEQ_CST)
 
 /**
- * REturn the bucket of the given ASN
+ * Return the hash value of the given key identifier (FNV-1a).
  * 
  * @param asn The AS number - format not important.
+ * @param ski The SKI of the key (SKI_LENGTH)
+ * @param algoID The algorithm ID
  * 
- * @return The bucket number of the ASN
+ * @return The hash value.
  */
-static u_int8_t _ks_getBucket(u_int32_t asn)
-{      
-  u_int8_t bucket = (asn >> 24) + ((asn >> 16) & 0xFF) + ((asn >> 8) & 0xFF)
-                    + (asn & 0xFF);
-  bucket = bucket & 255;
-  return bucket;
+static u_int32_t _ks_hash(u_int32_t asn, u_int8_t* ski, u_int8_t algoID)
+{
+  u_int32_t hash   = 2166136261u;
+  u_int8_t* asnPtr = (u_int8_t*)&asn;
+  int idx = 0;
+
+  for (; idx < sizeof(u_int32_t); idx++)
+  {
+    hash = (hash ^ asnPtr[idx]) * 16777619u;
+  }
+  for (idx = 0; idx < SKI_LENGTH; idx++)
+  {
+    hash = (hash ^ ski[idx]) * 16777619u;
+  }
+  hash = (hash ^ algoID) * 16777619u;
+
+  return hash;
 }
 
+/**
+ * Find the element of the given ASN and SKI in the table. This function does 
+ * not lock, the element slots are read using KS_LOAD.
+ * 
+ * @param table The hash table (can be NULL)
+ * @param algoID The algorithm ID of the storage
+ * @param asn The AS number in network format
+ * @param ski The SKI of the key (SKI_LENGTH)
+ * @param slot OUT parameter (can be NULL), the slot of the element if found,
+ *             otherwise the first slot the element can be stored in. Only 
+ *             valid for the writer.
+ * 
+ * @return The element or NULL if not found.
+ */
+static KS_Key_Element* _ks_find(KS_Table* table, u_int8_t algoID, 
+                                u_int32_t asn, u_int8_t* ski, u_int32_t* slot)
+{
+  KS_Key_Element* elem = NULL;
+  u_int32_t mask  = 0;
+  u_int32_t idx   = 0;
+  u_int32_t free  = 0;
+  u_int32_t probe = 0;
+
+  if (table == NULL)
+  {
+    return NULL;
+  }
+
+  mask = table->size - 1;
+  idx  = _ks_hash(asn, ski, algoID) & mask;
+  free = table->size;
+
+  for (; probe < table->size; probe++, idx = (idx + 1) & mask)
+  {
+    elem = KS_LOAD(&table->slots[idx]);
+    if (elem == NULL)
+    {
+      // End of the probe sequence
+      if (free == table->size)
+      {
+        free = idx;
+      }
+      break;
+    }
+    if (elem == KS_TOMBSTONE)
+    {
+      // The first deleted slot can be reused
+      if (free == table->size)
+      {
+        free = idx;
+      }
+      continue;
+    }
+    if (elem->asn == asn && memcmp(elem->ski, ski, SKI_LENGTH) == 0)
+    {
+      if (slot != NULL)
+      {
+        *slot = idx;
+      }
+      return elem;
+    }
+  }
+
+  if (slot != NULL)
+  {
+    *slot = free;
+  }
+  return NULL;
+}
 
 /**
  * Create a clone of the provided key.
@@ -95,13 +205,13 @@ static u_int8_t _ks_getBucket(u_int32_t asn)
 static BGPSecKey* _ks_clone(BGPSecKey* key)
 {
   BGPSecKey* clone = malloc(sizeof(BGPSecKey));
-  memset (clone, 0, sizeof(BGPSecKey));
   if (clone != NULL)
   {
+    memset (clone, 0, sizeof(BGPSecKey));
     clone->algoID    = key->algoID;
     clone->asn       = key->asn;
     memcpy(&clone->ski, &key->ski, SKI_LENGTH);
-    clone->keyLength = key->keyLength;
+    clone->keyLength = key->keyData != NULL ? key->keyLength : 0;
     if (clone->keyLength != 0)
     {
       clone->keyData   = malloc(key->keyLength);
@@ -120,6 +230,21 @@ static BGPSecKey* _ks_clone(BGPSecKey* key)
   return clone;  
 }
 
+/**
+ * Destroy the BGPSec Key
+ * 
+ * @param key The BGPSecKey to be destroyed.
+ */
+static void _ks_freeKey(BGPSecKey* key)
+{
+  if (key != NULL)
+  {
+    free(key->keyData);
+    memset (key, 0, sizeof(BGPSecKey));
+    free(key);
+  }
+}
+
 /**
  * Convert the DER key stored in the keyData into an EC_KEY.
  * The following status will be returned:
@@ -171,291 +296,346 @@ static EC_KEY* _ks_convertKey(u_int8_t* keyData, u_int16_t keyLength,
 }
 
 /**
- * Retrieve the EC_KEY associated to the given ski and asn. Here the source is
- * ignored.
- * 
- * Possible USER return values:
- * 
- * API_STATUS_INFO_KEY_NOTFOUND : Key not found
- * API_STATUS_ERR_USER1: A DER key element is NULL (BUG IN List).
- * API_STATUS_ERR_NO_DATA: No data provided to find the key.
+ * Convert the DER key into an EVP_PKEY. This is done once when the key is 
+ * stored, the verification itself does not need to parse the key anymore.
+ * See _ks_convertKey for the status values.
  * 
- * @param storage The storage where the key is stored in
- * @param ski The SKI of the key (SKI_LENGTH)
- * @param asn The as number of the key in network format
- * @paran noKeys An OUT variable contains the size of the returned array. 
- * @param kType The type of the keys requested, EC or DER
- * @param status is an OUT parameter that if given will provide more information.
- *        API_STATUS_INFO_USER1 is used to indicate that additional keys are
- *        available at a higher position
+ * @param key The key containing the DER encoded key
+ * @param isPrivate indicate if the key is private
+ * @param status Adds return information in case something goes wrong - the 
+ *               status flag will NOT be initialized within the function.
  * 
- * @return the array of EC_Keys/BGPsecKeys(DER_Keys) or NULL of not found. If 
- *         NULL check status value.
+ * @return The key or NULL. In the later case check status.
  */
-void** ks_getKey(KeyStorage* storage, u_int8_t* ski, u_int32_t asn, 
-                 u_int16_t* noKeys, KS_Key_Type kType, sca_status_t* status)
+static EVP_PKEY* _ks_createEVP(BGPSecKey* key, bool isPrivate, 
+                               sca_status_t* status)
 {
-  void** keys   = NULL;
-  sca_status_t myStatus = (storage != NULL && ski != NULL && noKeys != NULL)
-                          ? API_STATUS_OK
-                          : API_STATUS_ERR_NO_DATA;
-  
-  if (myStatus == API_STATUS_OK)
-  {
-    // find the correct elem list
-    u_int8_t bucket = _ks_getBucket(asn);    
-    KS_Key_Element* elem = storage->head[bucket];
-    
-    while (elem != NULL)
-    {
-      if (elem->asn < asn)
-      {
-        // Move forward in the list
-        elem = elem->next;
-        continue;
-      }
-      if (elem->asn > asn)
-      {
-        // Key Not found
-        myStatus = API_STATUS_INFO_KEY_NOTFOUND;
-        elem = NULL;
-        break;
-      }
-      // ASN Element found - check ski
-      if (memcmp(elem->ski, ski, SKI_LENGTH) != 0)
-      {
-        // No match, move on
-        elem = elem->next;
-        continue;
-      }
-      
-      // ASN and ski match
-      int idx = 0;
-      if (kType == ks_eckey_e) 
-      {
-        keys = (void**)elem->ec_key;
-      }
-      else
-      {
-        keys = (void**)elem->derKey;
-      }
+  EVP_PKEY* evp_key = NULL;
+  EC_KEY*   ec_key  = NULL;
 
-      if (kType == ks_eckey_e)
-      {
-        for(; idx < elem->noKeys; idx++)
-        {
-          if (elem->ec_key[idx] != NULL)
-          {
-            continue;
-          }
-          // Load the key
-          if (elem->derKey[idx] != NULL)
-          {
-            elem->ec_key[idx] = _ks_convertKey(elem->derKey[idx]->keyData,
-                                               elem->derKey[idx]->keyLength,
-                                               storage->isPrivate, &myStatus);
-            if (myStatus & API_STATUS_ERR_NO_DATA)
-            {
-              myStatus |= API_STATUS_ERR_USER1;
-            }
-            continue;
-          }
-          // DER Key not found
-          myStatus |= API_STATUS_ERR_USER1;
-        }      
-      }
-      // Found the key
-      *noKeys = elem->noKeys;
-      break;
-    }     
+  if (key->keyData == NULL)
+  {
+    *status |= API_STATUS_ERR_NO_DATA;
+    return NULL;
   }
-  
-  if (status != NULL)
+
+  ec_key = _ks_convertKey(key->keyData, key->keyLength, isPrivate, status);
+  if (ec_key != NULL)
   {
-    if (keys == NULL)
+    evp_key = EVP_PKEY_new();
+    // The EVP_PKEY takes the ownership of the ec_key
+    if (evp_key == NULL || !EVP_PKEY_assign_EC_KEY(evp_key, ec_key))
     {
-      myStatus |= API_STATUS_INFO_KEY_NOTFOUND;
+      EVP_PKEY_free(evp_key);
+      EC_KEY_free(ec_key);
+      evp_key = NULL;
+      *status |= API_STATUS_ERR_INSUF_KEYSTORAGE;
     }
-    *status = myStatus;
   }
-  return keys;
+
+  return evp_key;
 }
 
 /**
- * Destroy the BGPSec Key
+ * Return the EC_KEY of the given EVP key. The EC_KEY is owned by the EVP key.
  * 
- * @param key The BGPSecKey to be destroyed.
+ * @param evp_key The EVP key (can be NULL)
+ * 
+ * @return The EC_KEY or NULL
  */
-static void _ks_freeKey(BGPSecKey* key)
+static EC_KEY* _ks_getEC(EVP_PKEY* evp_key)
 {
-  if (key != NULL)
-  {
-    free(key->keyData);
-    memset (key, 0, sizeof(BGPSecKey));
-    free(key);
-  }
+  return evp_key != NULL ? (EC_KEY*)EVP_PKEY_get0_EC_KEY(evp_key) : NULL;
 }
 
 /** 
- * Generate a KeyStorage element. All internal memory is allocated using malloc!
+ * Generate an empty KeyStorage element. All internal memory is allocated 
+ * using malloc!
  * 
- * @param key The key to be added. Here a copy of the Key will be stored!
- * @param status The status of the generation.
- *              API_STATUS_ERR_NO_DATA if the conversion would not be performed.
+ * @param asn The ASN of the keys.
+ * @param ski The SKI of the keys.
+ * @param noKeys The number of keys the element will hold (> 0).
  * 
- * @return a new key storage element or NULL if an error occurred - see status.
+ * @return a new key storage element or NULL if not enough memory.
  */
-static KS_Key_Element* _ks_createKS_Element(BGPSecKey* key, bool convert,
-                                            bool isPrivate, sca_status_t* status)
+static KS_Key_Element* _ks_createKS_Element(u_int32_t asn, u_int8_t* ski,
+                                            u_int16_t noKeys)
 {  
   KS_Key_Element* elem = malloc(sizeof(KS_Key_Element));
-  sca_status_t myStatus = API_STATUS_OK;
   
   if (elem != NULL)
   {
     memset(elem, 0, sizeof(KS_Key_Element));    
-    // Store the minimal information.
-    elem->asn = key->asn;
-    memcpy(elem->ski, key->ski, SKI_LENGTH);
-    
-    //Currently the key array only will contain one single element.
-    elem->noKeys = 1;
-    
-    elem->derKey = malloc(sizeof(BGPSecKey*) * elem->noKeys);
-    memset(elem->derKey, 0, sizeof(BGPSecKey*) * elem->noKeys);
-    if (elem->derKey != NULL)
-    {
-      // Now copy the key into it.
-      elem->derKey[0] = _ks_clone(key);
-      if (elem->derKey[0] != NULL)
-      {
-        // create the array space for the ec_key
-        elem->ec_key = malloc(sizeof(EC_KEY*) * elem->noKeys);
-        memset(elem->ec_key, 0, sizeof(EC_KEY*) * elem->noKeys);
-        if (elem->ec_key != NULL)
-        {
-          if (convert)
-          {
-            // Check if the der Key is already loaded and if not, load it!.
-            if (elem->derKey[0]->keyData == NULL)
-            {
-              sca_loadKey(elem->derKey[0], isPrivate, &myStatus);
-            }
-            
-            if (elem->derKey[0]->keyData != NULL)
-            {              
-              // This is now expected!!
-              elem->ec_key[0] = _ks_convertKey(elem->derKey[0]->keyData, 
-                                               elem->derKey[0]->keyLength, 
-                                               isPrivate, &myStatus);
-              if (elem->ec_key[0] == NULL)
-              {
-                _ks_freeKey(elem->derKey[0]);
-                elem->derKey[0] = NULL;
-                // Now free the malloc'ed arrays
-                free(elem->derKey);
-                free(elem->ec_key);
-                elem->derKey = NULL;
-                elem->ec_key = NULL;
-                free(elem);                
-                elem = NULL;
-                myStatus |= API_STATUS_ERR_NO_DATA;             
-              }
-            }
-            else
-            {
-              myStatus |= API_STATUS_ERR_NO_DATA;             
-            }
-          }
-          else
-          {
-            elem->ec_key[0] = NULL;
-          }
-        }
-        else // Could not generate the ec_key array - free the key array and elem
-        {      
-          free(elem->derKey);
-          elem->derKey = NULL;
-          free(elem);
-          elem = NULL;
-          myStatus |= API_STATUS_ERR_INSUF_KEYSTORAGE;                
-        }
-      }
-      else // could not clone the BGPSecKey - clean elem-key and elem
-      {        
-        free(elem->derKey);
-        elem->derKey = NULL;
-        free(elem);
-        elem = NULL;
-        myStatus |= API_STATUS_ERR_INSUF_KEYSTORAGE;                
-      }
-    }
-    else // Could not generate the key array - free elem
+    elem->asn    = asn;
+    memcpy(elem->ski, ski, SKI_LENGTH);
+    elem->noKeys = noKeys;
+    elem->source  = malloc(sizeof(sca_key_source_t) * noKeys);
+    elem->derKey  = malloc(sizeof(BGPSecKey*) * noKeys);
+    elem->evp_key = malloc(sizeof(EVP_PKEY*) * noKeys);
+    elem->ec_key  = malloc(sizeof(EC_KEY*) * noKeys);
+    if (   elem->source == NULL || elem->derKey == NULL 
+        || elem->evp_key == NULL || elem->ec_key == NULL)
     {
+      free(elem->source);
+      free(elem->derKey);
+      free(elem->evp_key);
+      free(elem->ec_key);
       free(elem);
       elem = NULL;
-      myStatus |= API_STATUS_ERR_INSUF_KEYSTORAGE;
     }
   }
-  else
+  
+  return elem;
+}
+
+/**
+ * Copy the key at position srcIdx of the source element into the position
+ * dstIdx of the destination element. Only the pointers are copied.
+ * 
+ * @param dst The destination element
+ * @param dstIdx The destination index
+ * @param src The source element
+ * @param srcIdx The source index
+ */
+static void _ks_copyKey(KS_Key_Element* dst, int dstIdx, 
+                        KS_Key_Element* src, int srcIdx)
+{
+  dst->source[dstIdx]  = src->source[srcIdx];
+  dst->derKey[dstIdx]  = src->derKey[srcIdx];
+  dst->evp_key[dstIdx] = src->evp_key[srcIdx];
+  dst->ec_key[dstIdx]  = src->ec_key[srcIdx];
+}
+
+/**
+ * Free the element and its arrays. If requested the keys are freed as well.
+ * 
+ * @param elem The element to be freed
+ * @param freeKeys If true the DER and EVP keys are freed as well.
+ */
+static void _ks_freeKS_Elem(KS_Key_Element* elem, bool freeKeys)
+{  
+  int kIdx = 0;
+
+  if (freeKeys)
   {
-    myStatus |= API_STATUS_ERR_INSUF_KEYSTORAGE;
+    for (; kIdx < elem->noKeys; kIdx++)
+    {
+      _ks_freeKey(elem->derKey[kIdx]);
+      EVP_PKEY_free(elem->evp_key[kIdx]);
+    }
   }
-  
-  if (status != NULL)
+  free(elem->source);
+  free(elem->derKey);
+  free(elem->evp_key);
+  free(elem->ec_key);
+  memset(elem, 0, sizeof(KS_Key_Element));
+  free(elem);
+}
+
+/**
+ * Free the hash table.
+ * 
+ * @param table The table to be freed.
+ */
+static void _ks_freeTable(KS_Table* table)
+{
+  if (table != NULL)
   {
-    *status = myStatus;
+    free(table->slots);
+    free(table);
   }
-  
-  return elem;
 }
 
 /**
- * Remove the element from the storage
+ * Free the retired memory.
+ * 
+ * @param retired The retired memory
+ */
+static void _ks_freeRetired(KS_Retired* retired)
+{
+  if (retired->elem != NULL)
+  {
+    _ks_freeKS_Elem(retired->elem, false);
+  }
+  _ks_freeKey(retired->derKey);
+  EVP_PKEY_free(retired->evpKey);
+  _ks_freeTable(retired->table);
+  free(retired);
+}
+
+/**
+ * Add memory that was removed from the storage to the retired list. Readers 
+ * might still access it, therefore it is freed by _ks_reclaim once all 
+ * readers that could have seen it are gone. At least one of the parameters 
+ * besides storage must be provided. Requires the write lock.
  * 
  * @param storage The key storage
- * @param head The head index.
- * @param elem The element to be removed
+ * @param elem The element (only the element and its arrays) or NULL
+ * @param derKey The DER key or NULL
+ * @param evpKey The EVP key or NULL
+ * @param table The hash table or NULL
  */
-static void _ks_freeKS_Elem(KeyStorage* storage, int head,
-                            KS_Key_Element* elem)
-{  
-  storage->size -= elem->noKeys;
- 
-  // Take element out of the element list
-  if (elem->prev != NULL) 
-  {     
-    elem->prev->next = elem->next;
-    elem->prev = NULL;
+static void _ks_retire(KeyStorage* storage, KS_Key_Element* elem, 
+                       BGPSecKey* derKey, EVP_PKEY* evpKey, KS_Table* table)
+{
+  KS_Retired* retired = malloc(sizeof(KS_Retired));
+
+  if (retired != NULL)
+  {
+    retired->elem   = elem;
+    retired->derKey = derKey;
+    retired->evpKey = evpKey;
+    retired->table  = table;
+    retired->epoch  = storage->epoch;
+    retired->next   = storage->retired;
+    storage->retired = retired;
   }
   else
-  { // elem MUST be the head, otherwise it would have a previous 'prev' element
-    storage->head[head] = elem->next; // move head to the next one
+  {
+    // It is not safe to free the memory here, rather loose it.
+    sca_debugLog(LOG_WARNING, "Not enough memory to retire key storage "
+                              "memory!\n");
   }
-  
-  if (elem->next != NULL)
+}
+
+/**
+ * Advance the read epoch as far as no reader of an older epoch is active and
+ * free the retired memory nobody can access anymore. Memory retired in epoch
+ * e can be freed once the epoch is e + 2: a reader of epoch e - 1 or e 
+ * prevents that and readers entering later cannot find it. Requires the write
+ * lock.
+ * 
+ * @param storage The key storage
+ */
+static void _ks_reclaim(KeyStorage* storage)
+{
+  KS_Retired** retPtr  = &storage->retired;
+  KS_Retired*  retired = NULL;
+  u_int32_t    epoch   = storage->epoch;
+  int          step    = 0;
+
+  for (; step < 2; step++)
   {
-    elem->next->prev = elem->prev;
-    elem->next = NULL;
+    if (KS_EPOCH_LOAD(&storage->readers[(epoch - 1) & 1]) != 0)
+    {
+      break;
+    }
+    epoch++;
+    KS_EPOCH_STORE(&storage->epoch, epoch);
   }
-  
-  // Now free the allocated memory
+
+  while (*retPtr != NULL)
+  {
+    retired = *retPtr;
+    if ((u_int32_t)(epoch - retired->epoch) >= 2)
+    {
+      *retPtr = retired->next;
+      _ks_freeRetired(retired);
+    }
+    else
+    {
+      retPtr = &retired->next;
+    }
+  }
+}
+
+/**
+ * Remove the element from its slot and retire it including its keys. Requires
+ * the write lock.
+ * 
+ * @param storage The key storage
+ * @param slot The slot of the element
+ * @param elem The element to be removed
+ */
+static void _ks_removeElem(KeyStorage* storage, u_int32_t slot, 
+                           KS_Key_Element* elem)
+{
   int kIdx = 0;
+
+  KS_STORE(&storage->table->slots[slot], KS_TOMBSTONE);
+  storage->size -= elem->noKeys;
+  if (storage->keyChanged != NULL)
+  {
+    storage->keyChanged(elem->ski);
+  }
   for (; kIdx < elem->noKeys; kIdx++)
   {
-    _ks_freeKey(elem->derKey[kIdx]);
-    elem->derKey[kIdx] = NULL;
-    if (elem->ec_key[kIdx] != NULL)
+    _ks_retire(storage, NULL, elem->derKey[kIdx], elem->evp_key[kIdx], NULL);
+  }
+  _ks_retire(storage, elem, NULL, NULL, NULL);
+}
+
+/**
+ * Make sure the table has room for one more element. If the table is more 
+ * than half used (including deleted slots), a new table is generated and 
+ * published. Requires the write lock.
+ * 
+ * @param storage The key storage
+ * 
+ * @return false if not enough memory is available.
+ */
+static bool _ks_reserve(KeyStorage* storage)
+{
+  KS_Table*       oldTable = storage->table;
+  KS_Table*       newTable = NULL;
+  KS_Key_Element* elem     = NULL;
+  u_int32_t       elements = 0;
+  u_int32_t       size     = KS_MIN_SLOTS;
+  u_int32_t       idx      = 0;
+  u_int32_t       slot     = 0;
+
+  if (oldTable != NULL && (storage->usedSlots + 1) * 2 <= oldTable->size)
+  {
+    return true;
+  }
+
+  if (oldTable != NULL)
+  {
+    for (idx = 0; idx < oldTable->size; idx++)
     {
-      EC_KEY_free(elem->ec_key[kIdx]);
-      elem->ec_key[kIdx] = NULL;
+      elem = oldTable->slots[idx];
+      if (elem != NULL && elem != KS_TOMBSTONE)
+      {
+        elements++;
+      }
     }
   }
-  // Now free the key arrays
-  free(elem->derKey);
-  free(elem->ec_key);
-  memset(elem, 0, sizeof(KS_Key_Element));
-  free(elem);
+  // Keep the load below 25% after rebuilding
+  while (size < (elements + 1) * 4)
+  {
+    size <<= 1;
+  }
+
+  newTable = malloc(sizeof(KS_Table));
+  if (newTable == NULL)
+  {
+    return false;
+  }
+  newTable->size  = size;
+  newTable->slots = calloc(size, sizeof(KS_Key_Element*));
+  if (newTable->slots == NULL)
+  {
+    free(newTable);
+    return false;
+  }
+
+  if (oldTable != NULL)
+  {
+    for (idx = 0; idx < oldTable->size; idx++)
+    {
+      elem = oldTable->slots[idx];
+      if (elem != NULL && elem != KS_TOMBSTONE)
+      {
+        _ks_find(newTable, storage->algorithmID, elem->asn, elem->ski, &slot);
+        newTable->slots[slot] = elem;
+      }
+    }
+    _ks_retire(storage, NULL, NULL, NULL, oldTable);
+  }
+  storage->usedSlots = elements;
+  KS_STORE(&storage->table, newTable);
+
+  return true;
 }
 
 /**
@@ -470,11 +650,169 @@ void ks_init(KeyStorage* storage, u_int8_t algoID, bool isPrivate)
   if (storage != NULL)
   {
     storage->algorithmID = algoID;
-    storage->isPrivate = isPrivate;
-    storage->size = 0;
-    storage->head = malloc(sizeof(KS_Key_Element*) * KS_BUCKETS);
-    memset (storage->head, 0, sizeof(KS_Key_Element*) * KS_BUCKETS);
+    storage->isPrivate   = isPrivate;
+    storage->size        = 0;
+    storage->usedSlots   = 0;
+    storage->table       = NULL;
+    storage->retired     = NULL;
+    storage->epoch       = 0;
+    storage->readers[0]  = 0;
+    storage->readers[1]  = 0;
+    storage->keyChanged  = NULL;
+    pthread_mutex_init(&storage->writeLock, NULL);
+    // In case of no memory the table is generated with the first key.
+    _ks_reserve(storage);
+  }
+}
+
+/**
+ * Register the callback that is called with the SKI of each key that is 
+ * stored in or removed from the storage.
+ * 
+ * @param storage The key storage
+ * @param keyChanged The callback or NULL
+ * 
+ * @since 0.3.0.7
+ */
+void ks_setKeyChangedCallback(KeyStorage* storage, 
+                              void (*keyChanged)(u_int8_t* ski))
+{
+  if (storage != NULL)
+  {
+    storage->keyChanged = keyChanged;
+  }
+}
+
+/**
+ * Start reading the storage. Keys returned by ks_getKey stay valid until the
+ * matching ks_endRead.
+ * 
+ * @param storage The key storage
+ * 
+ * @return The epoch that must be passed to ks_endRead.
+ * 
+ * @since 0.3.0.7
+ */
+u_int32_t ks_beginRead(KeyStorage* storage)
+{
+  u_int32_t epoch = 0;
+
+  if (storage == NULL)
+  {
+    return 0;
+  }
+
+  // Register for the current epoch, retry if the epoch advanced in between
+  // because the writer might not have seen this reader.
+  while (true)
+  {
+    epoch = KS_EPOCH_LOAD(&storage->epoch);
+    KS_EPOCH_INC(&storage->readers[epoch & 1]);
+    if (KS_EPOCH_LOAD(&storage->epoch) == epoch)
+    {
+      break;
+    }
+    KS_EPOCH_DEC(&storage->readers[epoch & 1]);
+  }
+
+  return epoch;
+}
+
+/**
+ * Finish reading the storage.
+ * 
+ * @param storage The key storage
+ * @param epoch The epoch returned by ks_beginRead.
+ * 
+ * @since 0.3.0.7
+ */
+void ks_endRead(KeyStorage* storage, u_int32_t epoch)
+{
+  if (storage != NULL)
+  {
+    KS_EPOCH_DEC(&storage->readers[epoch & 1]);
+  }
+}
+
+/**
+ * Retrieve the EC_KEY associated to the given ski and asn. Here the source is
+ * ignored. This function does not lock, it MUST be called within ks_beginRead
+ * and ks_endRead.
+ * 
+ * Possible USER return values:
+ * 
+ * API_STATUS_INFO_KEY_NOTFOUND : Key not found
+ * API_STATUS_ERR_USER1: A DER key element is NULL (BUG IN List).
+ * API_STATUS_ERR_INVLID_KEY: One of the keys could not be converted.
+ * API_STATUS_ERR_NO_DATA: No data provided to find the key.
+ * 
+ * @param storage The storage where the key is stored in
+ * @param ski The SKI of the key (SKI_LENGTH)
+ * @param asn The as number of the key in network format
+ * @paran noKeys An OUT variable contains the size of the returned array. 
+ * @param kType The type of the keys requested, EC, EVP, or DER
+ * @param status is an OUT parameter that if given will provide more information.
+ *        API_STATUS_INFO_USER1 is used to indicate that additional keys are
+ *        available at a higher position
+ * 
+ * @return the array of EC_Keys/EVP_PKEYs/BGPsecKeys(DER_Keys) or NULL of not 
+ *         found. If NULL check status value. The array stays valid until the
+ *         read section ends.
+ */
+void** ks_getKey(KeyStorage* storage, u_int8_t* ski, u_int32_t asn, 
+                 u_int16_t* noKeys, KS_Key_Type kType, sca_status_t* status)
+{
+  void** keys   = NULL;
+  sca_status_t myStatus = (storage != NULL && ski != NULL && noKeys != NULL)
+                          ? API_STATUS_OK
+                          : API_STATUS_ERR_NO_DATA;
+  
+  if (myStatus == API_STATUS_OK)
+  {
+    KS_Key_Element* elem = _ks_find(KS_LOAD(&storage->table), 
+                                    storage->algorithmID, asn, ski, NULL);
+    if (elem != NULL)
+    {
+      int idx = 0;
+      switch (kType)
+      {
+        case ks_eckey_e:
+          keys = (void**)elem->ec_key;
+          break;
+        case ks_evpkey_e:
+          keys = (void**)elem->evp_key;
+          break;
+        default:
+          keys = (void**)elem->derKey;
+      }
+
+      if (kType != ks_derkey_e)
+      {
+        // Keys are converted when stored, report the ones that failed.
+        for(; idx < elem->noKeys; idx++)
+        {
+          if (elem->evp_key[idx] == NULL)
+          {
+            myStatus |= (elem->derKey[idx] != NULL) 
+                        ? API_STATUS_ERR_INVLID_KEY 
+                        : API_STATUS_ERR_USER1;
+          }
+        }
+      }
+      // Found the key
+      *noKeys = elem->noKeys;
+    }
+  }
+  
+  if (status != NULL)
+  {
+    if (keys == NULL)
+    {
+      myStatus |= API_STATUS_INFO_KEY_NOTFOUND;
+    }
+    *status = myStatus;
   }
+  return keys;
 }
 
 /**
@@ -487,10 +825,9 @@ void ks_release(KeyStorage* storage)
   if (storage != NULL)
   {
     ks_empty(storage);
-    if (storage->head != NULL)
-    {
-      free (storage->head);
-    }      
+    _ks_freeTable(storage->table);
+    storage->table = NULL;
+    pthread_mutex_destroy(&storage->writeLock);
     free(storage);
   }
 }
@@ -500,20 +837,17 @@ void ks_release(KeyStorage* storage)
  * contain algoID, ASN, and SKI all keys found with this match are deleted. In 
  * case a stored DER key is part of the key, only the stored version with a 100%
  * binary match will be deleted.
- * the key parameter will not be modified as long as it is different from the 
- * stored version. In case it is the same instance, it will be changed / 
- * deleted,
+ * the key parameter will not be modified. The memory of the deleted key is 
+ * freed once no reader can access it anymore.
  * 
  * the following USER status can be returned:
  * 
  * API_STATUS_ERR_USER1: Key algorithm ID does not match the storage Algorithm ID
- * API_STATUS_INFO_USER1: Given key was not registered!
+ * API_STATUS_INFO_KEY_NOTFOUND: Given key was not registered!
  * API_STATUS_ERR_NO_DATA: One of the provided parameter was NULL
  * 
  * @param storage The storage where the key is stored in
- * @param key The BGPSecKey to be deleted - the given key will not be touched, 
- *            the stored version will. If both are the exact same, then the 
- *            provided key is deleted as well.
+ * @param key The BGPSecKey to be deleted - the given key will not be touched.
  * @param source The source of the key.
  * @param status an OUT value that provides more information.
  * 
@@ -524,131 +858,91 @@ int ks_delKey(KeyStorage* storage, BGPSecKey* key, sca_key_source_t source,
 {
   int retVal = API_SUCCESS; 
   int myStatus = API_STATUS_OK;
-  int             bucket = 0;
-  KS_Key_Element* elem   = NULL;
+  KS_Key_Element* elem    = NULL;
+  KS_Key_Element* newElem = NULL;
+  u_int32_t       slot    = 0;
+  int             idx     = 0;
+  int             kIdx    = 0;
   
-  if (storage != NULL && key != NULL)
-  {
-    if (key->algoID == storage->algorithmID)
-    {
-      bucket = _ks_getBucket(key->asn);
-      elem = storage->head[bucket];
-    }
-    else
-    {
-      // Algorithm ID does not match.
-      myStatus = API_STATUS_ERR_USER1;
-    }
-  }
-  else
+  if (storage == NULL || key == NULL)
   {
     // Some data missing.
     myStatus = API_STATUS_ERR_NO_DATA;
   }
-    
-  if (elem != NULL)
+  else if (key->algoID != storage->algorithmID)
   {
-    bool deleted = false;
-    while (elem != NULL)
+    // Algorithm ID does not match.
+    myStatus = API_STATUS_ERR_USER1;
+  }
+  else
+  {
+    pthread_mutex_lock(&storage->writeLock);
+    elem = _ks_find(storage->table, storage->algorithmID, key->asn, key->ski, 
+                    &slot);
+    if (elem == NULL)
+    {
+      myStatus = API_STATUS_INFO_KEY_NOTFOUND;
+    }
+    else if (key->keyData == NULL)
+    {
+      // DER is NULL so delete the complete element.
+      _ks_removeElem(storage, slot, elem);
+    }
+    else
     {
-      if (elem->asn < key->asn)
+      //Find the correct key version to delete.
+      for (idx = 0; idx < elem->noKeys; idx++)
       {
-        // Move forward in the list
-        elem = elem->next;
-        continue;
+        if (   elem->derKey[idx]->keyLength == key->keyLength
+            && elem->derKey[idx]->keyData != NULL
+            && memcmp(elem->derKey[idx]->keyData, key->keyData, 
+                      key->keyLength) == 0)
+        {
+          break;
+        }
       }
-      if (elem->asn > key->asn)
+
+      if (idx == elem->noKeys)
       {
-        // Key Not found
         myStatus = API_STATUS_INFO_KEY_NOTFOUND;
-        elem = NULL;
-        break;
       }
-
-      // ASN Element found - check ski
-      if (memcmp(elem->ski, key->ski, SKI_LENGTH) != 0)
+      else if (elem->noKeys == 1)
       {
-        // No match, move on
-        elem = elem->next;
-        continue;
+        // This was the only key, remove the complete element
+        _ks_removeElem(storage, slot, elem);
       }
-      
-      // ASN and ski match
-      // Now if key has a DER key delete only the DER portion, otherwise delete 
-      // the complete element.
-      int idx = 0;
-      if (key->keyData != NULL)
+      else
       {
-        //Find the correct key version to delete.
-        for (; idx < elem->noKeys; idx++)
+        // some more duplicate keys exist, replace the element with a copy 
+        // that does not contain the deleted key.
+        newElem = _ks_createKS_Element(elem->asn, elem->ski, elem->noKeys - 1);
+        if (newElem != NULL)
         {
-          if (deleted)
+          for (kIdx = 0; kIdx < elem->noKeys; kIdx++)
           {
-            // move the current key to the previous emptied position
-            // This results in no empty place within the array and the last
-            // element entry is empty. Good for later rezising
-            elem->derKey[idx-1] = elem->derKey[idx];
-            elem->ec_key[idx-1] = elem->ec_key[idx];
-            elem->derKey[idx] = NULL;
-            elem->ec_key[idx] = NULL;
-          }
-          else
-          {  
-            if (elem->derKey[idx]->keyLength == key->keyLength)
+            if (kIdx != idx)
             {
-              if (memcmp(elem->derKey[idx]->keyData, key->keyData, 
-                         key->keyLength) == 0)
-              {
-                // Now delete this version of the ec_key
-                if (elem->ec_key[idx] != NULL)
-                {
-                  // This array is is OpenSSL malloc'ed
-                  EC_KEY_free(elem->ec_key[idx]);
-                  elem->ec_key[idx] = NULL;
-                }
-                // Now free the der_key
-                _ks_freeKey(elem->derKey[idx]);
-                elem->derKey[idx] = NULL;
-                deleted = true;
-                elem->noKeys--;
-                storage->size--;
-              }
+              _ks_copyKey(newElem, kIdx < idx ? kIdx : kIdx - 1, elem, kIdx);
             }
           }
-        }
-        if (deleted)
-        {
-          if (elem->noKeys == 0)
-          {
-            // This was the only key, remove the complete element
-            _ks_freeKS_Elem(storage, bucket, elem);
-          }
-          else
+          KS_STORE(&storage->table->slots[slot], newElem);
+          storage->size--;
+          if (storage->keyChanged != NULL)
           {
-            // some more duplicate keys exist. 
-            // Now resize
-            void** dk = realloc(elem->derKey, sizeof(BGPSecKey*) + elem->noKeys);
-            if (dk != NULL)
-            {
-              elem->derKey = (BGPSecKey**)dk;
-            }
-            void** ek = realloc(elem->ec_key, sizeof(EC_KEY*) + elem->noKeys);
-            if (ek != NULL)
-            {
-              elem->ec_key = (EC_KEY**)ek;
-            }
+            storage->keyChanged(elem->ski);
           }
+          _ks_retire(storage, NULL, elem->derKey[idx], elem->evp_key[idx], 
+                     NULL);
+          _ks_retire(storage, elem, NULL, NULL, NULL);
+        }
+        else
+        {
+          myStatus = API_STATUS_ERR_INSUF_KEYSTORAGE;
         }
       }
-      else
-      {
-        // DER is NULL so delete the complete element.
-        int newSize = storage->size - elem->noKeys;
-        _ks_freeKS_Elem(storage, bucket, elem);
-        deleted = storage->size == newSize;
-      }
-      elem = NULL;
     }
+    _ks_reclaim(storage);
+    pthread_mutex_unlock(&storage->writeLock);
   }
   
   if (status != NULL)
@@ -660,31 +954,56 @@ int ks_delKey(KeyStorage* storage, BGPSecKey* key, sca_key_source_t source,
 
 /** 
  * Free all Key Storage elements and *associated memory that was generated
- * within the storage.
+ * within the storage. This function MUST NOT be called while other threads 
+ * read the storage.
  * 
  * @param storage The storage to be emptied
  */
 void ks_empty(KeyStorage* storage)
 {
-  if (storage != NULL)
+  KS_Key_Element* elem    = NULL;
+  KS_Retired*     retired = NULL;
+  u_int32_t       idx     = 0;
+
+  if (storage == NULL)
   {
-    if (storage->head != NULL)
-    { // Should NOT be NULL
-      int idx = 0;
-      for (; idx < KS_BUCKETS; idx++)
+    return;
+  }
+
+  pthread_mutex_lock(&storage->writeLock);
+  if (storage->table != NULL)
+  { 
+    for (; idx < storage->table->size; idx++)
+    {
+      elem = storage->table->slots[idx];
+      if (elem != NULL && elem != KS_TOMBSTONE)
       {
-        while (storage->head[idx] != NULL)
+        storage->size -= elem->noKeys;
+        if (storage->keyChanged != NULL)
         {
-          _ks_freeKS_Elem(storage, idx, storage->head[idx]);
+          storage->keyChanged(elem->ski);
         }
+        _ks_freeKS_Elem(elem, true);
       }
+      storage->table->slots[idx] = NULL;
     }
   }
+  storage->usedSlots = 0;
+
+  // Now nobody can access the retired memory anymore.
+  while (storage->retired != NULL)
+  {
+    retired = storage->retired;
+    storage->retired = retired->next;
+    _ks_freeRetired(retired);
+  }
+
   if (storage->size != 0)
   {
     sca_debugLog(LOG_WARNING, "Key storage could not be emptied! [%p]\n", 
                  storage);
   }
+  pthread_mutex_unlock(&storage->writeLock);
 }
 
 /**
@@ -692,7 +1011,8 @@ void ks_empty(KeyStorage* storage)
  * BGPSECkey only contains the ASN, algorithm ID and the SKI this implementation
  * will use the srxCryptoAPI's sca_loadKey function. In case the key could
  * not be loaded the return value will be FAILED and the status flag will be 
- * set to Key not Found.
+ * set to Key not Found. The key is converted into an EVP_PKEY before it is 
+ * stored.
  * 
  * API_STATUS_ERR_USER1: Wrong algorithmID
  * API_STATUS_INFO_USER1: Duplicate Key
@@ -704,178 +1024,148 @@ void ks_empty(KeyStorage* storage)
  * @param key The BGPSecKey to be stored.
  * @param source The source where the ley came from.
  * @param status an OUT value that provides more information.
- * @param convert if true then convert the DER key into the EC_KEY
+ * @param convert if true the key MUST be convertible into an EVP_PKEY, 
+ *                otherwise it is stored but not usable.
  * 
  * @return API_SUCESS if it could be stored, otherwise API_FAILED. 
  */
 int ks_storeKey(KeyStorage* storage, BGPSecKey* key, sca_key_source_t source, 
                 sca_status_t* status, bool convert)
 {
-  sca_status_t myStatus = API_STATUS_OK;
-  int  retVal   = API_SUCCESS;
-  int  bucket   = 0;
+  sca_status_t    myStatus   = API_STATUS_OK;
+  sca_status_t    convStatus = API_STATUS_OK;
+  BGPSecKey*      derKey     = NULL;
+  EVP_PKEY*       evpKey     = NULL;
+  KS_Key_Element* elem       = NULL;
+  KS_Key_Element* newElem    = NULL;
+  u_int32_t       slot       = 0;
+  int             kIdx       = 0;
+  bool            stored     = false;
          
-  if (storage != NULL && key != NULL)
-  {
-    if (key->algoID == storage->algorithmID)
-    {
-      // The asn is in big endian format, 
-      bucket = _ks_getBucket(key->asn);    
-    }
-    else
-    {
-      // Algorithm ID does not match.
-      myStatus = API_STATUS_ERR_USER1;
-    }
-  }
-  else
+  if (storage == NULL || key == NULL)
   {
     // Some data missing.
     myStatus = API_STATUS_ERR_NO_DATA;
   }
-  
-  if (storage->head[bucket] != NULL)
+  else if (key->algoID != storage->algorithmID)
   {
-    // we have to find the position to insert the new key
-    KS_Key_Element* elem = storage->head[bucket];
-    while (elem != NULL)
+    // Algorithm ID does not match.
+    myStatus = API_STATUS_ERR_USER1;
+  }
+  else
+  {
+    derKey = _ks_clone(key);
+    if (derKey == NULL)
+    {
+      myStatus |= API_STATUS_ERR_INSUF_KEYSTORAGE;
+    }
+    else
     {
-      if (elem->asn < key->asn)
+      // Check if the der Key is already loaded and if not, load it!.
+      if (convert && derKey->keyData == NULL)
       {
-        if (elem->next != NULL)
-        {
-          elem = elem->next;
-          continue;
-        }
-        // add as last element          
-        storage->size++;
-        elem->next = _ks_createKS_Element(key, convert, storage->isPrivate, 
-                                          &myStatus);
-        elem->next->prev = elem;
-        break;
+        sca_loadKey(derKey, storage->isPrivate, &myStatus);
       }
+      // Convert outside of the write lock.
+      evpKey = _ks_createEVP(derKey, storage->isPrivate, &convStatus);
+      if (convert)
+      {
+        myStatus |= convStatus;
+      }
+    }
+  }
 
-      if (elem->asn > key->asn)
+  if ((myStatus & API_STATUS_ERROR_MASK) == 0)
+  {
+    pthread_mutex_lock(&storage->writeLock);
+    if (_ks_reserve(storage))
+    {
+      elem = _ks_find(storage->table, storage->algorithmID, key->asn, key->ski,
+                      &slot);
+      if (elem != NULL)
       {
-        // insert before the element
-        KS_Key_Element* newElem = _ks_createKS_Element(key, convert, 
-                                                 storage->isPrivate, &myStatus);
-        storage->size++;
-        newElem->next = elem;
-        newElem->prev = elem->prev;
-        elem->prev    = newElem;
-        if (newElem->prev != NULL)
-        {
-          newElem->prev->next = newElem;
-        }
-        else
+        // Go through all internal keys (most likely only one) and check if it 
+        // is already stored.
+        for (kIdx = 0; kIdx < elem->noKeys; kIdx++)
         {
-          // new head
-          storage->head[bucket] = newElem;
+          if (   elem->derKey[kIdx]->keyLength == derKey->keyLength
+              && (derKey->keyLength == 0 
+                  || memcmp(elem->derKey[kIdx]->keyData, derKey->keyData, 
+                            derKey->keyLength) == 0))
+          {
+            // duplicate key
+            myStatus |= API_STATUS_INFO_USER1;
+            break;
+          }
         }
-        break;
       }
 
-      // as numbers are a match. check ski
-      if (memcmp(elem->ski, key->ski, SKI_LENGTH) == 0)
+      if ((myStatus & API_STATUS_INFO_USER1) == 0)
       {
-        // check if the key already exist.
-        int  kIdx = 0;
-        bool inserted = false;
-
-        // Go through all internal keys (most likely only one) and check if it 
-        // is already stored.
-        for (; kIdx < elem->noKeys && !inserted; kIdx++)
+        // Either a new element or an SKI collision, in both cases a new
+        // element is published.
+        newElem = _ks_createKS_Element(key->asn, key->ski, 
+                                       elem != NULL ? elem->noKeys + 1 : 1);
+        if (newElem != NULL)
         {
-          if (elem->derKey[kIdx]->keyLength == key->keyLength)
+          kIdx = 0;
+          if (elem != NULL)
           {
-            // check if the key is already stored
-            if (memcmp(elem->derKey[kIdx]->keyData, key->keyData, key->keyLength) == 0)
+            for (; kIdx < elem->noKeys; kIdx++)
             {
-              // duplicate key
-              inserted = true; // stop the for loop
-              myStatus |= API_STATUS_INFO_USER1;
+              _ks_copyKey(newElem, kIdx, elem, kIdx);
             }
           }
-        }
+          newElem->source[kIdx]  = source;
+          newElem->derKey[kIdx]  = derKey;
+          newElem->evp_key[kIdx] = evpKey;
+          newElem->ec_key[kIdx]  = _ks_getEC(evpKey);
 
-        // If not inserted then we have an SKI collision and we need to add it
-        if (!inserted)
-        {
-          // add one more key / ec_key
-          elem->noKeys++;
-          // Re-allocate the internal arrays.
-          BGPSecKey** dk = realloc(elem->derKey, sizeof(BGPSecKey*) * elem->noKeys);
-          EC_KEY** ek = realloc(elem->ec_key, sizeof(EC_KEY*) * elem->noKeys);
-                    
-          if (dk != NULL && ek != NULL)
+          if (elem == NULL && storage->table->slots[slot] == NULL)
           {
-            storage->size++;
-            elem->derKey = dk;
-            elem->ec_key = ek;
-            elem->derKey[elem->noKeys-1] = _ks_clone(key);
-            elem->ec_key[elem->noKeys-1] = _ks_convertKey(key->keyData, 
-                                 key->keyLength, storage->isPrivate, &myStatus);
-            inserted = true;
+            storage->usedSlots++;
           }
-          else
+          KS_STORE(&storage->table->slots[slot], newElem);
+          if (elem != NULL)
           {
-            // not enough memory for the ec_key, shrink the key back
-            myStatus |= API_STATUS_ERR_INSUF_KEYSTORAGE;
-            elem->noKeys--;
-            if (dk != NULL)
-            {
-              elem->derKey = realloc(dk, sizeof(BGPSecKey*) * elem->noKeys);
-            }
-            if (ek != NULL)
-            {
-              elem->ec_key = realloc(ek, sizeof(EC_KEY*) * elem->noKeys);
-            }
+            _ks_retire(storage, elem, NULL, NULL, NULL);
           }
-        }
-        break; // The while (elem != NULL) loop.
-      }
-      else
-      {
-        // ASN matches but not SKI
-        // move to the next or add as last.
-        if (elem->next != NULL)
-        {
-          elem = elem->next;
+          storage->size++;
+          stored = true;
         }
         else
         {
-          elem->next = _ks_createKS_Element(key, convert, storage->isPrivate, 
-                                            &myStatus);
-          if (elem->next != NULL)
-          {
-            storage->size++;            
-          }
-         // else set some status and return API_FAILURE ?????
-          break; // The while (elem != NULL) loop.
+          myStatus |= API_STATUS_ERR_INSUF_KEYSTORAGE;
         }
       }
     }
-  }
-  else
-  {
-    // we have a new head
-    storage->head[bucket] = _ks_createKS_Element(key, convert, 
-                                                 storage->isPrivate, &myStatus);
-    if (storage->head[bucket] != NULL)
+    else
+    {
+      myStatus |= API_STATUS_ERR_INSUF_KEYSTORAGE;
+    }
+
+    if (   ((myStatus & API_STATUS_ERROR_MASK) == 0) 
+        && (storage->keyChanged != NULL))
     {
-      storage->size++;      
+      storage->keyChanged(key->ski);
     }
-    // else set some status and return API_FAILURE ?????
+    _ks_reclaim(storage);
+    pthread_mutex_unlock(&storage->writeLock);
   }
-  
+
+  if (!stored)
+  {
+    _ks_freeKey(derKey);
+    EVP_PKEY_free(evpKey);
+  }
+
   if (status != NULL)
   {
     *status = myStatus;
   }
   
-  return retVal = ((myStatus & API_STATUS_ERROR_MASK) != 0) ? API_FAILURE
-                                                            : API_SUCCESS;
+  return ((myStatus & API_STATUS_ERROR_MASK) != 0) ? API_FAILURE
+                                                   : API_SUCCESS;
 }
 
 /** 
@@ -890,49 +1180,75 @@ int ks_storeKey(KeyStorage* storage, BGPSecKey* key, sca_key_source_t source,
  */
 int ks_removeSource(KeyStorage* storage, sca_key_source_t source)
 {
-  printf ("KEYSTORAGE: ks_removeSource not implemented yet.");
-  int idx = 0;
-  KS_Key_Element* keyElem  = NULL;
-  
-  // Walk through all buckets
-  for (; idx < KS_BUCKETS; idx++)
+  KS_Key_Element* elem    = NULL;
+  KS_Key_Element* newElem = NULL;
+  u_int32_t       idx     = 0;
+  int             kIdx    = 0;
+  int             nIdx    = 0;
+  int             found   = 0;
+  int             removed = 0;
+
+  if (storage == NULL)
+  {
+    return 0;
+  }
+
+  pthread_mutex_lock(&storage->writeLock);
+  for (; storage->table != NULL && idx < storage->table->size; idx++)
   {
-    // set element to kead and check from here
-    keyElem  = storage->head[idx];
-    if (keyElem != NULL)
+    elem = storage->table->slots[idx];
+    if (elem == NULL || elem == KS_TOMBSTONE)
+    {
+      continue;
+    }
+
+    for (found = 0, kIdx = 0; kIdx < elem->noKeys; kIdx++)
     {
-      // This bucket contains keys, walk the list.
-      while (keyElem != NULL)
+      if (elem->source[kIdx] == source)
       {
-        if (keyElem->source == source)
+        found++;
+      }
+    }
+
+    if (found == elem->noKeys)
+    {
+      _ks_removeElem(storage, idx, elem);
+      removed += found;
+    }
+    else if (found != 0)
+    {
+      // Keep the keys of the other sources.
+      newElem = _ks_createKS_Element(elem->asn, elem->ski, 
+                                     elem->noKeys - found);
+      if (newElem == NULL)
+      {
+        sca_debugLog(LOG_WARNING, "Not enough memory to remove keys!\n");
+        continue;
+      }
+      for (nIdx = 0, kIdx = 0; kIdx < elem->noKeys; kIdx++)
+      {
+        if (elem->source[kIdx] != source)
         {
-          if (keyElem->next != NULL)
-          {
-            // Move to the next already and then remove the element
-            keyElem = keyElem->next;
-            _ks_freeKS_Elem(storage, idx, keyElem->prev);  
-          }
-          else if (keyElem->prev != NULL)
-          {
-            // No next available, goto the previous and then remove it.
-            keyElem = keyElem->prev;
-            _ks_freeKS_Elem(storage, idx, keyElem->next);  
-          }
-          else
-          {
-            // It seams only this element is available, remove it
-            _ks_freeKS_Elem(storage, idx, keyElem);  
-            keyElem = NULL;
-          }
+          _ks_copyKey(newElem, nIdx++, elem, kIdx);
         }
         else
         {
-          keyElem = keyElem->next;
+          _ks_retire(storage, NULL, elem->derKey[kIdx], elem->evp_key[kIdx], 
+                     NULL);
         }
       }
+      KS_STORE(&storage->table->slots[idx], newElem);
+      storage->size -= found;
+      removed       += found;
+      if (storage->keyChanged != NULL)
+      {
+        storage->keyChanged(elem->ski);
+      }
+      _ks_retire(storage, elem, NULL, NULL, NULL);
     }
   }
+  _ks_reclaim(storage);
+  pthread_mutex_unlock(&storage->writeLock);
   
-  
-  return 0;
+  return removed;
 }
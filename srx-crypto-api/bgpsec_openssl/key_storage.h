@@ -27,10 +27,19 @@
  * Known Issue:
  *   At this time only pem formated private keys can be loaded.
  * 
- * @version 0.3.0.0
+ * @version 0.3.0.7
  * 
  * Changelog:
  * -----------------------------------------------------------------------------
+ *  0.3.0.7 - 2026/10/17
+ *            * Replaced the 256 ASN buckets with an open addressed hash table
+ *              on (ASN, SKI, algorithm ID) that can be read without locking.
+ *            * Keys are converted into EVP_PKEY when stored, the EC_KEY is
+ *              taken from the EVP_PKEY.
+ *            * Added ks_evpkey_e to KS_Key_Type.
+ *            * Added the keyChanged callback.
+ *            * Added ks_beginRead and ks_endRead. Replaced memory is freed 
+ *              by the next writer once no reader of an older epoch is active.
  *  0.3.0.0 - 2017/08/18 - oborchert
  *            * Added source to structure _KS_Key_Element
  *            * Added source parameter to ks_... functions.
@@ -52,8 +61,10 @@
 #ifndef KEY_STORAGE_H
 #define KEY_STORAGE_H
 
+#include <pthread.h>
 #include <sys/types.h>
 #include <openssl/ec.h>
+#include <openssl/evp.h>
 #include "../srx/srxcryptoapi.h"
 
 /** Used to prevent an overflow */
@@ -66,48 +77,98 @@ typedef enum {
   /** REpresent s EC Keys. */
   ks_eckey_e  = 0,
   /** Represents DER keys. */
-  ks_derkey_e = 1       
+  ks_derkey_e = 1,
+  /** Represents the pre-parsed EVP keys. 
+   * @since 0.3.0.7 */
+  ks_evpkey_e = 2
 } KS_Key_Type;
 
+/**
+ * A key storage element. Once an element is published in the storage it is 
+ * not modified anymore, any change replaces the element with an updated copy.
+ * This allows ks_getKey to read the storage without locking.
+ */
 typedef struct _KS_Key_Element
 {
-  /** Pointer to previous element */
-  struct _KS_Key_Element* prev;
-  /** Pointer to next element */
-  struct _KS_Key_Element* next;
-  
   /** The ASN of all the keys. */
   u_int32_t   asn;
-  /** The key source. */
-  sca_key_source_t source;
   /** The array containing the ASKI of the key. */
   u_int8_t    ski[SKI_LENGTH];
+  /** The source of each key - each array element corresponds to the DER 
+   * formated key. */
+  sca_key_source_t* source;
   /** An array containing the DER formated key - Normally contains only one key 
    * but in case of an SKI conflict multiple keys might be possible. 
    * IMPORTANT: All derKeys are allocated using malloc, NOT OpenSSL_malloc.*/
   BGPSecKey** derKey;
-  /** Contains the OpenSSL Key if loaded into memory - each array element 
-   * corresponds to the DER formated key. 
-   * IMPORTANT: All ec_keys are allocated using OpenSSL based malloc, 
-   * NOT malloc. To free them use ECKEY_free()*/
+  /** Contains the parsed OpenSSL key - each array element corresponds to the 
+   * DER formated key. NULL if the key could not be converted.
+   * IMPORTANT: All evp_keys are allocated using OpenSSL based malloc, 
+   * NOT malloc. To free them use EVP_PKEY_free()*/
+  EVP_PKEY**  evp_key;
+  /** The EC_KEY of each evp_key. They are owned by the evp_key and MUST NOT be
+   * freed separately. */
   EC_KEY**    ec_key; 
-  /** Number of times this key is used up to MAX_KEY_USED. */
-  u_int16_t  timesUsed;
   /** Indicates how many different DER keys are stored. Normally 1 but > 1 in 
    * case of an SKI / ASN collision */
   u_int16_t  noKeys;
 } KS_Key_Element;
 
+/**
+ * The hash table of the key storage. The size is always a power of two.
+ */
+typedef struct 
+{
+  /** The number of slots in the table. */
+  u_int32_t size;
+  /** The slots, NULL marks an unused and KS_TOMBSTONE a deleted slot. */
+  KS_Key_Element** slots;
+} KS_Table;
+
+/**
+ * Memory that was replaced in the storage but might still be accessed by 
+ * readers. It is freed by a writer once no reader of its epoch or an older
+ * one is active, latest in ks_empty and ks_release.
+ */
+typedef struct _KS_Retired
+{
+  /** The next retired memory */
+  struct _KS_Retired* next;
+  /** The epoch in which the memory was removed from the storage. */
+  u_int32_t           epoch;
+  /** The retired element, only the element and its arrays are freed. */
+  KS_Key_Element*     elem;
+  /** The retired DER key */
+  BGPSecKey*          derKey;
+  /** The retired EVP key */
+  EVP_PKEY*           evpKey;
+  /** The retired table */
+  KS_Table*           table;
+} KS_Retired;
+
 typedef struct 
 {
   /** The algorithm ID of the keys. */
   u_int8_t algorithmID;
   /** indicates if the keys are private or not. */
   bool isPrivate;
-  /** The bucket head elements of the storage. */
-  KS_Key_Element** head;  
+  /** The hash table, it is replaced atomically when it grows. */
+  KS_Table* table;
+  /** The number of used slots in the table including deleted ones. */
+  u_int32_t usedSlots;
   /** The number of keys stored in the storage. */
   u_int32_t size;
+  /** Serializes all modifications of the storage. */
+  pthread_mutex_t writeLock;
+  /** Replaced memory that still might be read. */
+  KS_Retired* retired;
+  /** The current read epoch, only advanced by writers. */
+  u_int32_t epoch;
+  /** The number of active readers of odd and even epochs. */
+  u_int32_t readers[2];
+  /** Called with the SKI of each key that is stored or removed. 
+   * @since 0.3.0.7 */
+  void (*keyChanged)(u_int8_t* ski);
 } KeyStorage;
 
 /**
@@ -120,25 +181,67 @@ typedef struct
 void ks_init(KeyStorage* storage, u_int8_t algoID, bool isPrivate);
 
 /**
- * Retrieve the EC_KEY associated to the given ski and asn
+ * Register the callback that is called with the SKI of each key that is 
+ * stored in or removed from the storage. This allows to invalidate data that
+ * depends on the keys.
+ * 
+ * @param storage The key storage
+ * @param keyChanged The callback or NULL
+ * 
+ * @since 0.3.0.7
+ */
+void ks_setKeyChangedCallback(KeyStorage* storage, 
+                              void (*keyChanged)(u_int8_t* ski));
+
+/**
+ * Start reading the storage. Keys returned by ks_getKey stay valid until the
+ * matching ks_endRead. Read sections do not block writers, they only delay
+ * the release of replaced keys.
+ * 
+ * @param storage The key storage
+ * 
+ * @return The epoch that must be passed to ks_endRead.
+ * 
+ * @since 0.3.0.7
+ */
+u_int32_t ks_beginRead(KeyStorage* storage);
+
+/**
+ * Finish reading the storage. Keys returned by ks_getKey within this read
+ * section MUST NOT be used anymore.
+ * 
+ * @param storage The key storage
+ * @param epoch The epoch returned by ks_beginRead.
+ * 
+ * @since 0.3.0.7
+ */
+void ks_endRead(KeyStorage* storage, u_int32_t epoch);
+
+/**
+ * Retrieve the EC_KEY associated to the given ski and asn. This function does
+ * not lock and can be called concurrently to all other functions except 
+ * ks_empty and ks_release. It MUST be called within ks_beginRead and 
+ * ks_endRead.
  * 
  * Possible USER return values:
  * 
  * API_STATUS_INFO_KEY_NOTFOUND : Key not found
  * API_STATUS_ERR_USER1: A DER key element is NULL (BUG IN List).
+ * API_STATUS_ERR_INVLID_KEY: One of the keys could not be converted.
  * API_STATUS_ERR_NO_DATA: No data provided to find the key
  * 
  * @param storage The storage where the key is stored in
  * @param ski The SKI of the key (SKI_LENGTH)
  * @param asn The as number of the key in network format
  * @paran noKeys An OUT variable contains the size of the returned array. 
- * @param kType The type of the keys requested, EC or DER
+ * @param kType The type of the keys requested, EC, EVP, or DER
  * @param status is an OUT parameter that if given will provide more information.
  *        API_STATUS_INFO_USER1 is used to indicate that additional keys are
  *        available at a higher position
  * 
- * @return the array of EC_Keys/BGPsecKeys(DER_Keys) or NULL of not found. If 
- *         NULL check status value.
+ * @return the array of EC_Keys/EVP_PKEYs/BGPsecKeys(DER_Keys) or NULL of not 
+ *         found. If NULL check status value. The array stays valid until the
+ *         read section ends.
  */
 void** ks_getKey(KeyStorage* storage, u_int8_t* ski, u_int32_t asn, 
                  u_int16_t* noKeys, KS_Key_Type kType, sca_status_t* status);
@@ -152,7 +255,8 @@ void** ks_getKey(KeyStorage* storage, u_int8_t* ski, u_int32_t asn,
  * @param key The BGPSecKey to be stored.
  * @param source The source of the key.
  * @param status an OUT value that provides more information.
- * @param convert if true then convert the DER key into the EC_KEY
+ * @param convert if true the key MUST be convertible into an EVP_PKEY, 
+ *                otherwise it is stored but not usable.
  * 
  * @return API_SUCESS if it could be stored, otherwise API_FAILED. 
  */
@@ -174,7 +278,8 @@ int ks_delKey(KeyStorage* storage, BGPSecKey* key, sca_key_source_t source,
 
 /** 
  * Free all Key Storage elements and *associated memory that was generated
- * within the list.
+ * within the list. This function MUST NOT be called while other threads read
+ * the storage.
  * 
  * @param storage The storage to be emptied
  */
@@ -0,0 +1,471 @@
+/**
+ * This software was developed at the National Institute of Standards and
+ * Technology by employees of the Federal Government in the course of
+ * their official duties. Pursuant to title 17 Section 105 of the United
+ * States Code this software is not subject to copyright protection and
+ * is in the public domain.
+ *
+ * NIST assumes no responsibility whatsoever for its use by other parties,
+ * and makes no guarantees, expressed or implied, about its quality,
+ * reliability, or any other characteristic.
+ *
+ * We would appreciate acknowledgment if the software is used.
+ *
+ * NIST ALLOWS FREE USE OF THIS SOFTWARE IN ITS "AS IS" CONDITION AND
+ * DISCLAIM ANY LIABILITY OF ANY KIND FOR ANY DAMAGES WHATSOEVER RESULTING
+ * FROM THE USE OF THIS SOFTWARE.
+ *
+ *
+ * This software might use libraries that are under GNU public license or
+ * other licenses. Please refer to the licenses of all libraries required
+ * by this software.
+ *
+ * This file provides the bounded, lock-striped cache of successfully verified
+ * signature segments.
+ * 
+ * @version 0.3.0.7
+ * 
+ * Changelog:
+ * -----------------------------------------------------------------------------
+ *  0.3.0.7 - 2026/10/17
+ *            * Created Signature Cache
+ */
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include "sig_cache.h"
+
+/** One verified signature. */
+typedef struct _SC_Entry
+{
+  /** The next entry in the same hash bucket. */
+  struct _SC_Entry* hnext;
+  /** The more recently used entry. */
+  struct _SC_Entry* prev;
+  /** The less recently used entry. */
+  struct _SC_Entry* next;
+  /** The ASN of the signer (network format). */
+  u_int32_t asn;
+  /** The SKI of the signer. */
+  u_int8_t  ski[SKI_LENGTH];
+  /** The digest the signature is generated for. */
+  u_int8_t  digest[SHA256_DIGEST_LENGTH];
+  /** The hash of the signature. */
+  u_int8_t  sigHash[SHA256_DIGEST_LENGTH];
+} SC_Entry;
+
+/** One stripe of the cache. */
+typedef struct
+{
+  /** Guards all members of the stripe. */
+  pthread_mutex_t mutex;
+  /** The hash buckets. */
+  SC_Entry**      buckets;
+  /** The number of buckets minus one. */
+  u_int32_t       bucketMask;
+  /** The most recently used entry. */
+  SC_Entry*       head;
+  /** The least recently used entry. */
+  SC_Entry*       tail;
+  /** The pre-allocated entries. */
+  SC_Entry*       entries;
+  /** Unused entries. */
+  SC_Entry*       freeList;
+  /** The number of entries in use. */
+  u_int32_t       count;
+  /** The maximum number of entries. */
+  u_int32_t       capacity;
+  /** Statistics */
+  u_int64_t       hits;
+  u_int64_t       misses;
+  u_int64_t       evictions;
+  u_int64_t       invalidations;
+} SC_Stripe;
+
+struct _SigCache
+{
+  /** The stripes. */
+  SC_Stripe stripes[SC_STRIPES];
+  /** The maximum number of entries. */
+  u_int32_t capacity;
+};
+
+/**
+ * Return the stripe of the given SKI.
+ * 
+ * @param cache The cache
+ * @param ski The SKI
+ * 
+ * @return The stripe.
+ */
+static SC_Stripe* _sc_getStripe(SigCache* cache, u_int8_t* ski)
+{
+  u_int32_t hash = 0;
+  int idx = 0;
+  
+  for (; idx < SKI_LENGTH; idx++)
+  {
+    hash = (hash * 31) + ski[idx];
+  }
+  return &cache->stripes[hash % SC_STRIPES];
+}
+
+/**
+ * Return the bucket of the given entry data. The digest already is a 
+ * cryptographic hash, therefore its first bytes are used.
+ * 
+ * @param stripe The stripe
+ * @param digest The digest
+ * @param sigHash The hash of the signature.
+ * 
+ * @return The bucket index.
+ */
+static u_int32_t _sc_getBucket(SC_Stripe* stripe, u_int8_t* digest, 
+                               u_int8_t* sigHash)
+{
+  u_int32_t hash1, hash2;
+  
+  memcpy(&hash1, digest,  sizeof(u_int32_t));
+  memcpy(&hash2, sigHash, sizeof(u_int32_t));
+  return (hash1 ^ hash2) & stripe->bucketMask;
+}
+
+/**
+ * Remove the entry from the LRU list. The mutex MUST be held.
+ * 
+ * @param stripe The stripe
+ * @param entry The entry
+ */
+static void _sc_unlink(SC_Stripe* stripe, SC_Entry* entry)
+{
+  if (entry->prev != NULL)
+  {
+    entry->prev->next = entry->next;
+  }
+  else
+  {
+    stripe->head = entry->next;
+  }
+  if (entry->next != NULL)
+  {
+    entry->next->prev = entry->prev;
+  }
+  else
+  {
+    stripe->tail = entry->prev;
+  }
+  entry->prev = NULL;
+  entry->next = NULL;
+}
+
+/**
+ * Add the entry as most recently used entry. The mutex MUST be held.
+ * 
+ * @param stripe The stripe
+ * @param entry The entry
+ */
+static void _sc_pushFront(SC_Stripe* stripe, SC_Entry* entry)
+{
+  entry->prev = NULL;
+  entry->next = stripe->head;
+  if (stripe->head != NULL)
+  {
+    stripe->head->prev = entry;
+  }
+  else
+  {
+    stripe->tail = entry;
+  }
+  stripe->head = entry;
+}
+
+/**
+ * Remove the entry from the stripe and return it to the free list. The mutex
+ * MUST be held.
+ * 
+ * @param stripe The stripe
+ * @param entry The entry
+ */
+static void _sc_remove(SC_Stripe* stripe, SC_Entry* entry)
+{
+  SC_Entry** link = &stripe->buckets[_sc_getBucket(stripe, entry->digest, 
+                                                   entry->sigHash)];
+  while (*link != NULL && *link != entry)
+  {
+    link = &(*link)->hnext;
+  }
+  if (*link != NULL)
+  {
+    *link = entry->hnext;
+  }
+  _sc_unlink(stripe, entry);
+  entry->hnext = stripe->freeList;
+  stripe->freeList = entry;
+  stripe->count--;
+}
+
+/**
+ * Find the entry. The mutex MUST be held.
+ * 
+ * @param stripe The stripe
+ * @param asn The ASN of the signer
+ * @param ski The SKI of the signer
+ * @param digest The digest
+ * @param sigHash The hash of the signature
+ * 
+ * @return The entry or NULL.
+ */
+static SC_Entry* _sc_find(SC_Stripe* stripe, u_int32_t asn, u_int8_t* ski, 
+                          u_int8_t* digest, u_int8_t* sigHash)
+{
+  SC_Entry* entry = stripe->buckets[_sc_getBucket(stripe, digest, sigHash)];
+  
+  while (entry != NULL)
+  {
+    if (   (entry->asn == asn)
+        && (memcmp(entry->digest,  digest,  SHA256_DIGEST_LENGTH) == 0)
+        && (memcmp(entry->sigHash, sigHash, SHA256_DIGEST_LENGTH) == 0)
+        && (memcmp(entry->ski,     ski,     SKI_LENGTH) == 0))
+    {
+      break;
+    }
+    entry = entry->hnext;
+  }
+  
+  return entry;
+}
+
+/**
+ * Create the signature cache.
+ * 
+ * @param capacity The maximum number of entries (1..SC_MAX_CAPACITY)
+ * 
+ * @return The cache or NULL if it could not be created.
+ */
+SigCache* sc_create(u_int32_t capacity)
+{
+  SigCache* cache = NULL;
+  SC_Stripe* stripe = NULL;
+  u_int32_t perStripe = 0;
+  u_int32_t idx = 0;
+  u_int32_t eIdx = 0;
+  bool      ok = true;
+  
+  if ((capacity == 0) || (capacity > SC_MAX_CAPACITY))
+  {
+    return NULL;
+  }
+  
+  cache = calloc(1, sizeof(SigCache));
+  if (cache == NULL)
+  {
+    return NULL;
+  }
+  
+  perStripe = (capacity + SC_STRIPES - 1) / SC_STRIPES;
+  cache->capacity = perStripe * SC_STRIPES;
+  for (idx = 0; idx < SC_STRIPES; idx++)
+  {
+    stripe = &cache->stripes[idx];
+    pthread_mutex_init(&stripe->mutex, NULL);
+    stripe->capacity = perStripe;
+    // Use about twice as many buckets as entries.
+    stripe->bucketMask = 1;
+    while (stripe->bucketMask < (perStripe * 2))
+    {
+      stripe->bucketMask <<= 1;
+    }
+    stripe->buckets = calloc(stripe->bucketMask, sizeof(SC_Entry*));
+    stripe->bucketMask--;
+    stripe->entries = calloc(perStripe, sizeof(SC_Entry));
+    if ((stripe->buckets == NULL) || (stripe->entries == NULL))
+    {
+      ok = false;
+      continue;
+    }
+    for (eIdx = 0; eIdx < perStripe; eIdx++)
+    {
+      stripe->entries[eIdx].hnext = stripe->freeList;
+      stripe->freeList = &stripe->entries[eIdx];
+    }
+  }
+  
+  if (!ok)
+  {
+    sc_release(cache);
+    cache = NULL;
+  }
+  
+  return cache;
+}
+
+/**
+ * Look up if the given signature was verified successfully before. A found 
+ * entry becomes the most recently used entry of its stripe.
+ * 
+ * @param cache The cache.
+ * @param asn The ASN of the signer (network format).
+ * @param ski The SKI of the signer (SKI_LENGTH).
+ * @param digest The digest the signature is generated for 
+ *               (SHA256_DIGEST_LENGTH).
+ * @param sigHash The hash of the signature (SHA256_DIGEST_LENGTH).
+ * 
+ * @return true if the signature was verified successfully before.
+ */
+bool sc_lookup(SigCache* cache, u_int32_t asn, u_int8_t* ski, 
+               u_int8_t* digest, u_int8_t* sigHash)
+{
+  SC_Stripe* stripe = _sc_getStripe(cache, ski);
+  SC_Entry*  entry  = NULL;
+  
+  pthread_mutex_lock(&stripe->mutex);
+  entry = _sc_find(stripe, asn, ski, digest, sigHash);
+  if (entry != NULL)
+  {
+    stripe->hits++;
+    if (stripe->head != entry)
+    {
+      _sc_unlink(stripe, entry);
+      _sc_pushFront(stripe, entry);
+    }
+  }
+  else
+  {
+    stripe->misses++;
+  }
+  pthread_mutex_unlock(&stripe->mutex);
+  
+  return entry != NULL;
+}
+
+/**
+ * Store a successfully verified signature. In case the stripe is full the 
+ * least recently used entry of the stripe is evicted.
+ * 
+ * @param cache The cache.
+ * @param asn The ASN of the signer (network format).
+ * @param ski The SKI of the signer (SKI_LENGTH).
+ * @param digest The digest the signature is generated for 
+ *               (SHA256_DIGEST_LENGTH).
+ * @param sigHash The hash of the signature (SHA256_DIGEST_LENGTH).
+ */
+void sc_insert(SigCache* cache, u_int32_t asn, u_int8_t* ski, 
+               u_int8_t* digest, u_int8_t* sigHash)
+{
+  SC_Stripe* stripe = _sc_getStripe(cache, ski);
+  SC_Entry*  entry  = NULL;
+  u_int32_t  bucket = 0;
+  
+  pthread_mutex_lock(&stripe->mutex);
+  // Another thread might have verified the same signature concurrently.
+  if (_sc_find(stripe, asn, ski, digest, sigHash) == NULL)
+  {
+    if (stripe->freeList == NULL)
+    {
+      _sc_remove(stripe, stripe->tail);
+      stripe->evictions++;
+    }
+    entry = stripe->freeList;
+    stripe->freeList = entry->hnext;
+    
+    entry->asn = asn;
+    memcpy(entry->ski,     ski,     SKI_LENGTH);
+    memcpy(entry->digest,  digest,  SHA256_DIGEST_LENGTH);
+    memcpy(entry->sigHash, sigHash, SHA256_DIGEST_LENGTH);
+    bucket = _sc_getBucket(stripe, digest, sigHash);
+    entry->hnext = stripe->buckets[bucket];
+    stripe->buckets[bucket] = entry;
+    _sc_pushFront(stripe, entry);
+    stripe->count++;
+  }
+  pthread_mutex_unlock(&stripe->mutex);
+}
+
+/**
+ * Remove all entries of the given SKI. This MUST be called whenever a key 
+ * with this SKI is added or removed.
+ * 
+ * @param cache The cache.
+ * @param ski The SKI (SKI_LENGTH).
+ * 
+ * @return The number of removed entries.
+ */
+u_int32_t sc_invalidate(SigCache* cache, u_int8_t* ski)
+{
+  SC_Stripe* stripe = _sc_getStripe(cache, ski);
+  SC_Entry*  entry  = NULL;
+  SC_Entry*  next   = NULL;
+  u_int32_t  count  = 0;
+  
+  pthread_mutex_lock(&stripe->mutex);
+  entry = stripe->head;
+  while (entry != NULL)
+  {
+    next = entry->next;
+    if (memcmp(entry->ski, ski, SKI_LENGTH) == 0)
+    {
+      _sc_remove(stripe, entry);
+      count++;
+    }
+    entry = next;
+  }
+  stripe->invalidations += count;
+  pthread_mutex_unlock(&stripe->mutex);
+  
+  return count;
+}
+
+/**
+ * Fill the statistics of the cache.
+ * 
+ * @param cache The cache.
+ * @param stats OUT: The statistics.
+ */
+void sc_getStatistics(SigCache* cache, SCA_SigCacheStatistics* stats)
+{
+  SC_Stripe* stripe = NULL;
+  int idx = 0;
+  
+  memset(stats, 0, sizeof(SCA_SigCacheStatistics));
+  stats->capacity = cache->capacity;
+  for (; idx < SC_STRIPES; idx++)
+  {
+    stripe = &cache->stripes[idx];
+    pthread_mutex_lock(&stripe->mutex);
+    stats->hits          += stripe->hits;
+    stats->misses        += stripe->misses;
+    stats->evictions     += stripe->evictions;
+    stats->invalidations += stripe->invalidations;
+    stats->entries       += stripe->count;
+    pthread_mutex_unlock(&stripe->mutex);
+  }
+}
+
+/**
+ * Free the cache and all its entries.
+ * 
+ * @param cache The cache to be released.
+ */
+void sc_release(SigCache* cache)
+{
+  SC_Stripe* stripe = NULL;
+  int idx = 0;
+  
+  if (cache != NULL)
+  {
+    for (; idx < SC_STRIPES; idx++)
+    {
+      stripe = &cache->stripes[idx];
+      pthread_mutex_destroy(&stripe->mutex);
+      if (stripe->buckets != NULL)
+      {
+        free(stripe->buckets);
+      }
+      if (stripe->entries != NULL)
+      {
+        free(stripe->entries);
+      }
+    }
+    free(cache);
+  }
+}
@@ -0,0 +1,120 @@
+/**
+ * This software was developed at the National Institute of Standards and
+ * Technology by employees of the Federal Government in the course of
+ * their official duties. Pursuant to title 17 Section 105 of the United
+ * States Code this software is not subject to copyright protection and
+ * is in the public domain.
+ *
+ * NIST assumes no responsibility whatsoever for its use by other parties,
+ * and makes no guarantees, expressed or implied, about its quality,
+ * reliability, or any other characteristic.
+ *
+ * We would appreciate acknowledgment if the software is used.
+ *
+ * NIST ALLOWS FREE USE OF THIS SOFTWARE IN ITS "AS IS" CONDITION AND
+ * DISCLAIM ANY LIABILITY OF ANY KIND FOR ANY DAMAGES WHATSOEVER RESULTING
+ * FROM THE USE OF THIS SOFTWARE.
+ *
+ *
+ * This software might use libraries that are under GNU public license or
+ * other licenses. Please refer to the licenses of all libraries required
+ * by this software.
+ *
+ * This file provides a bounded cache of successfully verified signature 
+ * segments. An entry is identified by the signer (ASN, SKI), the SHA-256 
+ * digest that was signed, and the SHA-256 hash of the signature itself. The
+ * cache is split into stripes selected by the SKI, each stripe has its own 
+ * lock and LRU list. This allows to invalidate all entries of one SKI by only
+ * scanning one stripe.
+ * 
+ * @version 0.3.0.7
+ * 
+ * Changelog:
+ * -----------------------------------------------------------------------------
+ *  0.3.0.7 - 2026/10/17
+ *            * Created Signature Cache
+ */
+#ifndef SIG_CACHE_H
+#define SIG_CACHE_H
+
+#include <stdbool.h>
+#include <sys/types.h>
+#include <openssl/sha.h>
+#include "../srx/srxcryptoapi.h"
+
+/** The number of stripes (locks) of the cache. */
+#define SC_STRIPES          16
+/** The default number of entries of the cache. */
+#define SC_DEF_CAPACITY  16384
+/** The maximum number of entries of the cache. */
+#define SC_MAX_CAPACITY  0x1000000
+
+/** The signature cache. */
+typedef struct _SigCache SigCache;
+
+/**
+ * Create the signature cache.
+ * 
+ * @param capacity The maximum number of entries (1..SC_MAX_CAPACITY)
+ * 
+ * @return The cache or NULL if it could not be created.
+ */
+SigCache* sc_create(u_int32_t capacity);
+
+/**
+ * Look up if the given signature was verified successfully before. A found 
+ * entry becomes the most recently used entry of its stripe.
+ * 
+ * @param cache The cache.
+ * @param asn The ASN of the signer (network format).
+ * @param ski The SKI of the signer (SKI_LENGTH).
+ * @param digest The digest the signature is generated for 
+ *               (SHA256_DIGEST_LENGTH).
+ * @param sigHash The hash of the signature (SHA256_DIGEST_LENGTH).
+ * 
+ * @return true if the signature was verified successfully before.
+ */
+bool sc_lookup(SigCache* cache, u_int32_t asn, u_int8_t* ski, 
+               u_int8_t* digest, u_int8_t* sigHash);
+
+/**
+ * Store a successfully verified signature. In case the stripe is full the 
+ * least recently used entry of the stripe is evicted.
+ * 
+ * @param cache The cache.
+ * @param asn The ASN of the signer (network format).
+ * @param ski The SKI of the signer (SKI_LENGTH).
+ * @param digest The digest the signature is generated for 
+ *               (SHA256_DIGEST_LENGTH).
+ * @param sigHash The hash of the signature (SHA256_DIGEST_LENGTH).
+ */
+void sc_insert(SigCache* cache, u_int32_t asn, u_int8_t* ski, 
+               u_int8_t* digest, u_int8_t* sigHash);
+
+/**
+ * Remove all entries of the given SKI. This MUST be called whenever a key 
+ * with this SKI is added or removed.
+ * 
+ * @param cache The cache.
+ * @param ski The SKI (SKI_LENGTH).
+ * 
+ * @return The number of removed entries.
+ */
+u_int32_t sc_invalidate(SigCache* cache, u_int8_t* ski);
+
+/**
+ * Fill the statistics of the cache.
+ * 
+ * @param cache The cache.
+ * @param stats OUT: The statistics.
+ */
+void sc_getStatistics(SigCache* cache, SCA_SigCacheStatistics* stats);
+
+/**
+ * Free the cache and all its entries.
+ * 
+ * @param cache The cache to be released.
+ */
+void sc_release(SigCache* cache);
+
+#endif /* SIG_CACHE_H */
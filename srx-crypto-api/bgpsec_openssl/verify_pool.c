@@ -0,0 +1,329 @@
+/**
+ * This software was developed at the National Institute of Standards and
+ * Technology by employees of the Federal Government in the course of
+ * their official duties. Pursuant to title 17 Section 105 of the United
+ * States Code this software is not subject to copyright protection and
+ * is in the public domain.
+ *
+ * NIST assumes no responsibility whatsoever for its use by other parties,
+ * and makes no guarantees, expressed or implied, about its quality,
+ * reliability, or any other characteristic.
+ *
+ * We would appreciate acknowledgment if the software is used.
+ *
+ * NIST ALLOWS FREE USE OF THIS SOFTWARE IN ITS "AS IS" CONDITION AND
+ * DISCLAIM ANY LIABILITY OF ANY KIND FOR ANY DAMAGES WHATSOEVER RESULTING
+ * FROM THE USE OF THIS SOFTWARE.
+ *
+ *
+ * This software might use libraries that are under GNU public license or
+ * other licenses. Please refer to the licenses of all libraries required
+ * by this software.
+ *
+ * This file provides a small worker pool used to verify the signatures of
+ * one BGPsec path in parallel.
+ * 
+ * @version 0.3.0.7
+ * 
+ * Changelog:
+ * -----------------------------------------------------------------------------
+ *  0.3.0.7 - 2026/10/17
+ *            * Created Verify Pool
+ */
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <syslog.h>
+#include "../srx/srxcryptoapi.h"
+#include "verify_pool.h"
+
+/** One batch of tasks handed to vp_run. */
+typedef struct _VP_Batch
+{
+  /** The next batch in the queue */
+  struct _VP_Batch* next;
+  /** The task function */
+  VP_TaskFunc func;
+  /** The context handed to each task */
+  void*       context;
+  /** The number of tasks */
+  int         count;
+  /** The index of the next task to be claimed */
+  int         nextIdx;
+  /** The number of tasks not finished yet */
+  int         pending;
+  /** The lowest index of a failed task or -1 */
+  int         failedIdx;
+} VP_Batch;
+
+struct _VerifyPool
+{
+  /** Guards the batch queue and all batch counters. */
+  pthread_mutex_t mutex;
+  /** Signaled once a new batch is queued. */
+  pthread_cond_t  workCond;
+  /** Signaled once a batch is completed. */
+  pthread_cond_t  doneCond;
+  /** The head of the batch queue. Only batches with unclaimed tasks. */
+  VP_Batch*       head;
+  /** The tail of the batch queue. */
+  VP_Batch*       tail;
+  /** The worker threads. */
+  pthread_t*      threads;
+  /** The number of started worker threads. */
+  int             numThreads;
+  /** Indicates if the workers keep going. */
+  bool            running;
+};
+
+/**
+ * Remove the given batch from the queue. The mutex MUST be held.
+ * 
+ * @param pool The pool
+ * @param batch The batch to be removed.
+ */
+static void _vp_dequeue(VerifyPool* pool, VP_Batch* batch)
+{
+  VP_Batch* prev = NULL;
+  VP_Batch* curr = pool->head;
+  
+  while (curr != NULL && curr != batch)
+  {
+    prev = curr;
+    curr = curr->next;
+  }
+  if (curr != NULL)
+  {
+    if (prev == NULL)
+    {
+      pool->head = curr->next;
+    }
+    else
+    {
+      prev->next = curr->next;
+    }
+    if (pool->tail == curr)
+    {
+      pool->tail = prev;
+    }
+    curr->next = NULL;
+  }
+}
+
+/**
+ * Claim the next task of the given batch and process it. Tasks with an index
+ * above an already failed task are skipped. The mutex MUST be held and will
+ * be held again once the function returns.
+ * 
+ * @param pool The pool
+ * @param batch The batch containing at least one unclaimed task.
+ */
+static void _vp_process(VerifyPool* pool, VP_Batch* batch)
+{
+  int  idx = batch->nextIdx++;
+  bool ok  = true;
+  
+  if (batch->nextIdx == batch->count)
+  {
+    // All tasks are claimed
+    _vp_dequeue(pool, batch);
+  }
+  
+  if ((batch->failedIdx == -1) || (idx < batch->failedIdx))
+  {
+    pthread_mutex_unlock(&pool->mutex);
+    ok = batch->func(batch->context, idx);
+    pthread_mutex_lock(&pool->mutex);
+    if (!ok && ((batch->failedIdx == -1) || (idx < batch->failedIdx)))
+    {
+      batch->failedIdx = idx;
+    }
+  }
+  // else skipped - a task with a lower index failed already.
+  
+  if (--batch->pending == 0)
+  {
+    pthread_cond_broadcast(&pool->doneCond);
+  }
+}
+
+/**
+ * The worker thread loop.
+ * 
+ * @param arg The verify pool
+ * 
+ * @return NULL
+ */
+static void* _vp_worker(void* arg)
+{
+  VerifyPool* pool = (VerifyPool*)arg;
+  
+  pthread_mutex_lock(&pool->mutex);
+  while (pool->running)
+  {
+    if (pool->head == NULL)
+    {
+      pthread_cond_wait(&pool->workCond, &pool->mutex);
+      continue;
+    }
+    _vp_process(pool, pool->head);
+  }
+  pthread_mutex_unlock(&pool->mutex);
+  
+  return NULL;
+}
+
+/**
+ * Create the verify pool and start the worker threads.
+ * 
+ * @param numThreads The number of worker threads (1..VP_MAX_THREADS)
+ * 
+ * @return The pool or NULL if it could not be created.
+ */
+VerifyPool* vp_create(int numThreads)
+{
+  VerifyPool* pool = NULL;
+  
+  if ((numThreads < 1) || (numThreads > VP_MAX_THREADS))
+  {
+    sca_debugLog(LOG_ERR, "Invalid number of verify threads (%d)\n", 
+                 numThreads);
+    return NULL;
+  }
+  
+  pool = malloc(sizeof(VerifyPool));
+  if (pool != NULL)
+  {
+    memset(pool, 0, sizeof(VerifyPool));
+    pool->threads = malloc(sizeof(pthread_t) * numThreads);
+    if (pool->threads == NULL)
+    {
+      free(pool);
+      return NULL;
+    }
+    pthread_mutex_init(&pool->mutex, NULL);
+    pthread_cond_init(&pool->workCond, NULL);
+    pthread_cond_init(&pool->doneCond, NULL);
+    pool->running = true;
+    
+    for (; pool->numThreads < numThreads; pool->numThreads++)
+    {
+      if (pthread_create(&pool->threads[pool->numThreads], NULL, _vp_worker, 
+                         pool) != 0)
+      {
+        sca_debugLog(LOG_WARNING, "Could only start %d of %d verify threads\n",
+                     pool->numThreads, numThreads);
+        break;
+      }
+    }
+    if (pool->numThreads == 0)
+    {
+      vp_release(pool);
+      pool = NULL;
+    }
+  }
+  
+  return pool;
+}
+
+/**
+ * Run all tasks of one batch and wait until they are done. The calling thread
+ * takes part in processing its own batch. Multiple threads can call this
+ * function concurrently.
+ * 
+ * @param pool The pool.
+ * @param func The task function.
+ * @param context The context handed to each task.
+ * @param count The number of tasks.
+ * 
+ * @return The index of the first (lowest index) failing task or -1 if all 
+ *         tasks succeeded.
+ */
+int vp_run(VerifyPool* pool, VP_TaskFunc func, void* context, int count)
+{
+  VP_Batch batch;
+  
+  if (count <= 0)
+  {
+    return -1;
+  }
+  
+  batch.next      = NULL;
+  batch.func      = func;
+  batch.context   = context;
+  batch.count     = count;
+  batch.nextIdx   = 0;
+  batch.pending   = count;
+  batch.failedIdx = -1;
+  
+  pthread_mutex_lock(&pool->mutex);
+  if (count > 1)
+  {
+    // Hand the batch to the workers
+    if (pool->tail == NULL)
+    {
+      pool->head = &batch;
+    }
+    else
+    {
+      pool->tail->next = &batch;
+    }
+    pool->tail = &batch;
+    pthread_cond_broadcast(&pool->workCond);
+  }
+  
+  // Help processing the own batch
+  while (batch.nextIdx < batch.count)
+  {
+    _vp_process(pool, &batch);
+  }
+  // Wait for the tasks still processed by the workers
+  while (batch.pending > 0)
+  {
+    pthread_cond_wait(&pool->doneCond, &pool->mutex);
+  }
+  pthread_mutex_unlock(&pool->mutex);
+  
+  return batch.failedIdx;
+}
+
+/**
+ * Return the number of worker threads of the pool.
+ * 
+ * @param pool The pool.
+ * 
+ * @return the number of worker threads.
+ */
+int vp_getThreads(VerifyPool* pool)
+{
+  return (pool != NULL) ? pool->numThreads : 0;
+}
+
+/**
+ * Stop all worker threads and free the pool. No batch must be in process.
+ * 
+ * @param pool The pool to be released.
+ */
+void vp_release(VerifyPool* pool)
+{
+  int idx;
+  
+  if (pool != NULL)
+  {
+    pthread_mutex_lock(&pool->mutex);
+    pool->running = false;
+    pthread_cond_broadcast(&pool->workCond);
+    pthread_mutex_unlock(&pool->mutex);
+    
+    for (idx = 0; idx < pool->numThreads; idx++)
+    {
+      pthread_join(pool->threads[idx], NULL);
+    }
+    
+    pthread_cond_destroy(&pool->doneCond);
+    pthread_cond_destroy(&pool->workCond);
+    pthread_mutex_destroy(&pool->mutex);
+    free(pool->threads);
+    free(pool);
+  }
+}
@@ -0,0 +1,97 @@
+/**
+ * This software was developed at the National Institute of Standards and
+ * Technology by employees of the Federal Government in the course of
+ * their official duties. Pursuant to title 17 Section 105 of the United
+ * States Code this software is not subject to copyright protection and
+ * is in the public domain.
+ *
+ * NIST assumes no responsibility whatsoever for its use by other parties,
+ * and makes no guarantees, expressed or implied, about its quality,
+ * reliability, or any other characteristic.
+ *
+ * We would appreciate acknowledgment if the software is used.
+ *
+ * NIST ALLOWS FREE USE OF THIS SOFTWARE IN ITS "AS IS" CONDITION AND
+ * DISCLAIM ANY LIABILITY OF ANY KIND FOR ANY DAMAGES WHATSOEVER RESULTING
+ * FROM THE USE OF THIS SOFTWARE.
+ *
+ *
+ * This software might use libraries that are under GNU public license or
+ * other licenses. Please refer to the licenses of all libraries required
+ * by this software.
+ *
+ * This file provides a small worker pool used to verify the signatures of
+ * one BGPsec path in parallel. A batch consists of indexed tasks. Once a task 
+ * fails, tasks with a higher index are skipped (early cancel), all tasks with 
+ * a lower index are still performed. This allows the caller to determine the 
+ * first failing task exactly as a sequential loop would.
+ * 
+ * @version 0.3.0.7
+ * 
+ * Changelog:
+ * -----------------------------------------------------------------------------
+ *  0.3.0.7 - 2026/10/17
+ *            * Created Verify Pool
+ */
+#ifndef VERIFY_POOL_H
+#define VERIFY_POOL_H
+
+#include <stdbool.h>
+
+/** The maximum number of worker threads of the pool. */
+#define VP_MAX_THREADS 64
+
+/**
+ * A single task of a batch.
+ * 
+ * @param context The batch context given to vp_run
+ * @param idx The index of the task within the batch.
+ * 
+ * @return true if the task succeeded, false if it failed.
+ */
+typedef bool (*VP_TaskFunc)(void* context, int idx);
+
+/** The verify pool. */
+typedef struct _VerifyPool VerifyPool;
+
+/**
+ * Create the verify pool and start the worker threads.
+ * 
+ * @param numThreads The number of worker threads (1..VP_MAX_THREADS)
+ * 
+ * @return The pool or NULL if it could not be created.
+ */
+VerifyPool* vp_create(int numThreads);
+
+/**
+ * Run all tasks of one batch and wait until they are done. The calling thread
+ * takes part in processing its own batch. Multiple threads can call this
+ * function concurrently.
+ * 
+ * @param pool The pool.
+ * @param func The task function.
+ * @param context The context handed to each task.
+ * @param count The number of tasks.
+ * 
+ * @return The index of the first (lowest index) failing task or -1 if all 
+ *         tasks succeeded.
+ */
+int vp_run(VerifyPool* pool, VP_TaskFunc func, void* context, int count);
+
+/**
+ * Return the number of worker threads of the pool.
+ * 
+ * @param pool The pool.
+ * 
+ * @return the number of worker threads.
+ */
+int vp_getThreads(VerifyPool* pool);
+
+/**
+ * Stop all worker threads and free the pool. No batch must be in process.
+ * 
+ * @param pool The pool to be released.
+ */
+void vp_release(VerifyPool* pool);
+
+#endif /* VERIFY_POOL_H */
@@ -19,10 +19,15 @@
  * BGPSEC implementations. This library allows to switch the crypto 
  * implementation dynamically.
  *
- * @version 0.3.0.0
+ * @version 0.3.0.7
  * 
  * ChangeLog:
  * -----------------------------------------------------------------------------
+ *   0.3.0.7 - 2026/10/17
+ *             * Added function validateBatch and the field valResult to 
+ *               SCA_BGPSecValidationData.
+ *             * Added function getSigCacheStatistics and structure 
+ *               SCA_SigCacheStatistics.
  *   0.3.0.0 - 2018/11/29 - oborchert
  *             * Removed all "merged" comments to make future merging easier
  *           - 2017/09/13 - oborchert
@@ -481,8 +486,34 @@ typedef struct
   SCA_Prefix*  nlri;
   /** The message that will be hashed. */
   SCA_HashMessage*  hashMessage[2];
+  /** The validation result of this data object. This field is only set by 
+   * validateBatch and contains the value validate would have returned.
+   * @since 0.3.0.7 */
+  int          valResult;
 } SCA_BGPSecValidationData;
 
+/**
+ * This structure contains the statistics of the verified signature cache of 
+ * the implementation. 
+ * 
+ * @since 0.3.0.7
+ */
+typedef struct
+{
+  /** The number of signature verifications answered by the cache. */
+  u_int64_t hits;
+  /** The number of signature verifications not found in the cache. */
+  u_int64_t misses;
+  /** The number of entries removed to make space for newer entries. */
+  u_int64_t evictions;
+  /** The number of entries removed due to a key change. */
+  u_int64_t invalidations;
+  /** The number of entries currently stored. */
+  u_int32_t entries;
+  /** The maximum number of entries. */
+  u_int32_t capacity;
+} SCA_SigCacheStatistics;
+
 /**
  * This structure is used as input for the sign message. The caller MUST provide
  * all data except the signature. This must be NULL when calling sign.
@@ -777,6 +808,40 @@ typedef struct
    * @since 0.3.0.0
    */
   bool (*isAlgorithmSupported)(u_int8_t algoID);
+
+  /**
+   * Validate multiple BGPsec path attributes within one call. Each data object
+   * is validated exactly as validate would do it, the validation result of 
+   * each data object is stored in its valResult field and the status field
+   * contains the same information validate would provide.
+   * 
+   * This allows the implementation to share key lookups between the data 
+   * objects and to verify the signatures of the batch in parallel.
+   * 
+   * @param count The number of data elements in the given array
+   * @param data Array containing the data objects to be validated.
+   * 
+   * @return API_VALRESULT_VALID if all data objects are valid, otherwise
+   *         API_VALRESULT_INVALID (check valResult and status of each 
+   *         data object).
+   * 
+   * @since 0.3.0.7
+   */
+  int (*validateBatch)(int count, SCA_BGPSecValidationData** data);
+
+  /**
+   * Retrieve the statistics of the verified signature cache. Implementations
+   * that cache the result of successful signature verifications report the 
+   * hits, misses, and evictions of their cache here.
+   * 
+   * @param stats OUT: The statistics of the cache.
+   * 
+   * @return true if the implementation uses a signature cache and the 
+   *         statistics are filled, otherwise false.
+   * 
+   * @since 0.3.0.7
+   */
+  bool (*getSigCacheStatistics)(SCA_SigCacheStatistics* stats);
   
 } SRxCryptoAPI;
 
@@ -25,10 +25,14 @@
  * that do generate the key files in the required form. See the tool sub
  * directory for more information.
  *
- * @version 0.3.0.3
+ * @version 0.3.0.7
  * 
  * ChangeLog:
  * -----------------------------------------------------------------------------
+ *  0.3.0.7 - 2026/10/17
+ *            * Added mapping of validateBatch and the wrapper function
+ *              wrap_validateBatch which loops over validate.
+ *            * Added mapping of getSigCacheStatistics.
  *  0.3.0.3 - 2021/05/08 - oborchert
  *            * Renamed all instances of volt to vault
  *            * Added a deprecation of the incorrect key_volt to be backwards 
@@ -163,6 +167,8 @@
 #define SCA_CLEAN_PRIVATE_KEYS     "method_cleanPrivateKeys"
 
 #define SCA_IS_ALGO_SUPPORTED      "method_isAlgorithmSupported"
+#define SCA_VALIDATE_BATCH         "method_validateBatch"
+#define SCA_GET_SIGCACHE_STATS     "method_getSigCacheStatistics"
 
 #define SCA_DEF_INIT                   "init"
 #define SCA_DEF_RELEASE                "release"
@@ -174,9 +180,11 @@
 #define SCA_DEF_SET_DEBUGLEVEL         "setDebugLevel"
 
 #define SCA_DEF_IS_ALGO_SUPPORTED      "isAlgorithmSupported"
+#define SCA_DEF_GET_SIGCACHE_STATS     "getSigCacheStatistics"
 
 #define SCA_DEF_SIGN                   "sign"
 #define SCA_DEF_VALIDATE               "validate"
+#define SCA_DEF_VALIDATE_BATCH         "validateBatch"
 
 #define SCA_DEF_REGISTER_PRIVATE_KEY   "registerPrivateKey"
 #define SCA_DEF_UNREGISTER_PRIVATE_KEY "unregisterPrivateKey"
@@ -208,9 +216,11 @@ typedef struct {
   const char* str_method_setDebugLevel;
   
   const char* str_method_isAlgorithmSupported;
+  const char* str_method_getSigCacheStatistics;
   
   const char* str_method_sign;
   const char* str_method_validate;
+  const char* str_method_validateBatch;
 
   const char* str_method_registerPrivateKey;
   const char* str_method_unregisterPrivateKey;
@@ -268,6 +278,8 @@ static char _keyPath [MAXPATHLEN];
 static char _key_ext_priv[MAX_EXT_SIZE];
 /* The file extension for X509 certificates containing the public key. */
 static char _key_ext_pub[MAX_EXT_SIZE];
+/* The validate function used by the validateBatch wrapper. */
+static int (*_validateFkt)(SCA_BGPSecValidationData* data) = NULL;
 
 // Default function implementation.
 /**
@@ -371,6 +383,22 @@ bool wrap_freeHashMessage(SCA_HashMessage* hashMessage)
     return false;    
   }  
   
+  /**
+   * The wrapper does not cache signatures.
+   *
+   * @param stats The statistics - not touched.
+   *
+   * @return false (not supported)
+   *
+   * @since 0.3.0.7
+   */
+  bool wrap_getSigCacheStatistics(SCA_SigCacheStatistics* stats)
+  {
+    sca_debugLog (LOG_DEBUG, "Called local test wrapper "
+                             "'wrap_getSigCacheStatistics'\n");
+    return false;
+  }
+
   /**
    * Perform BGPSEC path validation. This function required the keys to be 
    * pre-registered to perform the validation. 
@@ -404,6 +432,42 @@ int wrap_validate(SCA_BGPSecValidationData* data)
   return API_VALRESULT_INVALID;
 }
 
+/**
+ * This is the internal batch validation wrapper. It is used if the library 
+ * does not provide its own batch validation and calls validate for each of the 
+ * given data objects.
+ * 
+ * @param count The number of data elements in the given array
+ * @param data Array containing the data objects to be validated.
+ * 
+ * @return API_VALRESULT_VALID if all data objects are valid, otherwise
+ *         API_VALRESULT_INVALID.
+ * 
+ * @since 0.3.0.7
+ */
+int wrap_validateBatch(int count, SCA_BGPSecValidationData** data)
+{
+  int retVal = API_VALRESULT_VALID;
+  int idx    = 0;
+  int (*validateFkt)(SCA_BGPSecValidationData* data) = 
+                        _validateFkt != NULL ? _validateFkt : wrap_validate;
+
+  sca_debugLog (LOG_DEBUG, "Called local wrapper 'validateBatch'\n");
+  if (data != NULL)
+  {
+    for (idx = 0; idx < count; idx++)
+    {
+      data[idx]->valResult = validateFkt(data[idx]);
+      if (data[idx]->valResult != API_VALRESULT_VALID)
+      {
+        retVal = API_VALRESULT_INVALID;
+      }
+    }
+  }
+
+  return retVal;
+}
+
 /**
  * This is the internal wrapper function. Currently it does return only the
  * error code and provides a debug log.
@@ -771,12 +835,16 @@ static void _loadMapping(config_setting_t *set, SCA_Mappings* mappings)
   
   __readMapping(set, SCA_IS_ALGO_SUPPORTED, 
                      &mappings->str_method_isAlgorithmSupported);
+  __readMapping(set, SCA_GET_SIGCACHE_STATS, 
+                     &mappings->str_method_getSigCacheStatistics);
   
   //////////////////////////////////////////////////////////////////////////////
   // SIGN / VALIDATE FUNCTIONS
   //////////////////////////////////////////////////////////////////////////////
   __readMapping(set, SCA_SIGN, &mappings->str_method_sign);
   __readMapping(set, SCA_VALIDATE, &mappings->str_method_validate);  
+  __readMapping(set, SCA_VALIDATE_BATCH, 
+                     &mappings->str_method_validateBatch);
   
   //////////////////////////////////////////////////////////////////////////////
   // KEY STORAGE
@@ -920,11 +988,17 @@ static int _mapAPI(SCA_Mappings* mappings, SRxCryptoAPI* api)
     __doMapFunction(api->libHandle, (void**)&api->isAlgorithmSupported,
                     mappings->str_method_isAlgorithmSupported,
                     SCA_DEF_IS_ALGO_SUPPORTED);
+    __doMapFunction(api->libHandle, (void**)&api->getSigCacheStatistics,
+                    mappings->str_method_getSigCacheStatistics,
+                    SCA_DEF_GET_SIGCACHE_STATS);
         
     __doMapFunction(api->libHandle, (void**)&api->sign,
                     mappings->str_method_sign, SCA_DEF_SIGN);
     __doMapFunction(api->libHandle, (void**)&api->validate,
                     mappings->str_method_validate, SCA_DEF_VALIDATE);
+    __doMapFunction(api->libHandle, (void**)&api->validateBatch,
+                    mappings->str_method_validateBatch, 
+                    SCA_DEF_VALIDATE_BATCH);
     
     __doMapFunction(api->libHandle, (void**)&api->registerPublicKey,
                     mappings->str_method_registerPublicKey,
@@ -1017,9 +1091,11 @@ int srxCryptoInit(SRxCryptoAPI* api, sca_status_t* status)
   api->getDebugLevel        = wrap_getDebugLevel;
   
   api->isAlgorithmSupported = wrap_isAlgorithmSupported;
+  api->getSigCacheStatistics = wrap_getSigCacheStatistics;
   
   api->sign                 = wrap_sign;
   api->validate             = wrap_validate;
+  api->validateBatch        = wrap_validateBatch;
 
   api->registerPublicKey    = wrap_registerPublicKey;
   api->unregisterPublicKey  = wrap_unregisterPublicKey;
@@ -1139,6 +1215,9 @@ int srxCryptoInit(SRxCryptoAPI* api, sca_status_t* status)
     }
   }
 
+  // The batch wrapper falls back to the validate function of this API.
+  _validateFkt = api->validate;
+
   memset (mappings, 0, sizeof(SCA_Mappings));
   free(mappings);
   mappings = NULL;
@@ -1189,6 +1268,7 @@ int srxCryptoUnbind(SRxCryptoAPI* api, sca_status_t* status)
 
     // NULL the complete API
     memset (api, 0, sizeof(SRxCryptoAPI));
+    _validateFkt = NULL;
   }
   else
   {
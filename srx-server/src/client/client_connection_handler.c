@@ -43,10 +43,17 @@
  *
  * GET RID OFF SEND QUEUE ??
  *
- * Version 0.6.1.2
+ * Version 0.6.2.2
  * 
  * Changelog:
  * -----------------------------------------------------------------------------
+ * 0.6.2.2  - 2026/10/17
+ *            * Added the verify batch which sends collected verify requests 
+ *              within one bulk verify request. Pending requests are send 
+ *              before any other PDU to keep the order of the PDUs.
+ *            * Offer the supported capabilities in the hello packet.
+ *            * Added receiveAvailablePackets which processes all buffered 
+ *              PDUs, at most the receive budget, per call.
  * 0.6.1.2  - 2021/11/18 - kyehwanl
  *            * Fixed bug in LOG print.
  * 0.3.0.10 - 2015/11/10 - oborchert
@@ -65,6 +72,8 @@
  * -----------------------------------------------------------------------------
  */
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <signal.h>
 #include <unistd.h>
 #include <fcntl.h>
@@ -92,6 +101,12 @@
 /** Max. entries in the send queue */
 #define MAX_SEND_QUEUE  100000
 
+/** Initial size of the verify batch buffer */
+#define VERIFY_BATCH_INIT_SIZE 65536
+
+/** Initial size of the receive buffer */
+#define RECEIVE_BUFFER_INIT_SIZE 65536
+
 #define HDR "([0x%08X] Client Connection Handler): "
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -132,6 +147,19 @@ ClientConnectionHandler* createClientConnectionHandler(SRxProxy* proxy)
     // and released in the connection handlers init and release method
     self->cond        = NULL;
     self->rcvMonitor  = NULL;
+    // The verify batch is disabled by default
+    self->verifyBatch      = NULL;
+    self->verifyBatchSize  = 0;
+    self->verifyBatchUsed  = 0;
+    self->verifyBatchCount = 0;
+    self->verifyBatchMax   = 0;
+    self->verifyBatchDelay = 0;
+    // The receive buffer is allocated with the first read
+    self->rcvBuffer     = NULL;
+    self->rcvBufferSize = 0;
+    self->rcvUsed       = 0;
+    self->rcvBudget     = SRX_DEFAULT_RECEIVE_BUDGET;
+    memset(&self->rcvStats, 0, sizeof(SRxProxyReceiveStats));
 
     // Set default socket parameters
     self->clSock.type = SRX_PROXY_CLIENT_SOCKET;
@@ -305,6 +333,25 @@ void releaseClientConnectionHandler(ClientConnectionHandler* self)
         free(self->cond);
         self->cond       = NULL;
       }
+
+      // Deallocate the verify batch, pending requests are lost
+      if (self->verifyBatch != NULL)
+      {
+        free(self->verifyBatch);
+        self->verifyBatch      = NULL;
+        self->verifyBatchSize  = 0;
+        self->verifyBatchUsed  = 0;
+        self->verifyBatchCount = 0;
+      }
+
+      // Deallocate the receive buffer, unprocessed data is lost
+      if (self->rcvBuffer != NULL)
+      {
+        free(self->rcvBuffer);
+        self->rcvBuffer     = NULL;
+        self->rcvBufferSize = 0;
+        self->rcvUsed       = 0;
+      }
     }
   }
 }
@@ -413,6 +460,12 @@ inline bool connHandlerUnlock(ClientConnectionHandler* self)
 bool sendPacketToServer(ClientConnectionHandler* self, void* data,
                         uint32_t length)
 {
+  // Pending verify requests must be send first to keep the order.
+  if ((self->verifyBatchCount > 0) && !flushVerifyRequests(self))
+  {
+    return false;
+  }
+
   if (isConnectedToServer(&self->clSock))
   {
     // This can contain more than one packet depending on the length and content
@@ -452,6 +505,305 @@ bool sendPacketToServer(ClientConnectionHandler* self, void* data,
   return true;
 }
 
+/**
+ * Return the milliseconds passed since the given time.
+ *
+ * @param start The start time (CLOCK_MONOTONIC).
+ *
+ * @return the milliseconds passed since start.
+ *
+ * @since 0.6.2.2
+ */
+static uint64_t _elapsedMillis(struct timespec* start)
+{
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return   ((uint64_t)(now.tv_sec - start->tv_sec) * 1000)
+         + ((now.tv_nsec - start->tv_nsec) / 1000000);
+}
+
+/**
+ * Add the given verify request to the verify batch. The batch is send once it
+ * contains verifyBatchMax requests or its first request waits longer than
+ * verifyBatchDelay milliseconds. Any other PDU send to the server will flush 
+ * the batch first.
+ *
+ * @param self Instance that should be used
+ * @param data The verify request PDU.
+ * @param length The length of the verify request PDU.
+ *
+ * @return false if the request could not be added or the batch could not be 
+ *         send.
+ *
+ * @since 0.6.2.2
+ */
+bool queueVerifyRequest(ClientConnectionHandler* self, void* data,
+                        uint32_t length)
+{
+  uint32_t required = self->verifyBatchUsed + length;
+  uint32_t newSize;
+  uint8_t* newBatch;
+
+  if (self->verifyBatchCount == 0)
+  {
+    self->verifyBatchUsed = sizeof(SRXPROXY_VERIFY_BULK_REQUEST);
+    required = self->verifyBatchUsed + length;
+    clock_gettime(CLOCK_MONOTONIC, &self->verifyBatchStart);
+  }
+
+  if (required > self->verifyBatchSize)
+  {
+    newSize = self->verifyBatchSize == 0 ? VERIFY_BATCH_INIT_SIZE
+                                         : self->verifyBatchSize;
+    while (newSize < required)
+    {
+      newSize *= 2;
+    }
+    newBatch = realloc(self->verifyBatch, newSize);
+    if (newBatch == NULL)
+    {
+      RAISE_ERROR("Not enough memory to extend the verify batch to %u bytes!",
+                  newSize);
+      // Send what we have and the request itself.
+      return flushVerifyRequests(self) 
+             && sendPacketToServer(self, data, length);
+    }
+    self->verifyBatch     = newBatch;
+    self->verifyBatchSize = newSize;
+  }
+
+  memcpy(self->verifyBatch + self->verifyBatchUsed, data, length);
+  self->verifyBatchUsed += length;
+  self->verifyBatchCount++;
+
+  if (   (self->verifyBatchCount >= self->verifyBatchMax)
+      || (_elapsedMillis(&self->verifyBatchStart) >= self->verifyBatchDelay))
+  {
+    return flushVerifyRequests(self);
+  }
+
+  return true;
+}
+
+/**
+ * Send all verify requests collected in the verify batch. A single request is 
+ * send as it is, multiple requests are send within one bulk verify request.
+ *
+ * @param self Instance that should be used
+ *
+ * @return true if the batch was empty or could be send.
+ *
+ * @since 0.6.2.2
+ */
+bool flushVerifyRequests(ClientConnectionHandler* self)
+{
+  uint32_t count = self->verifyBatchCount;
+  uint32_t used  = self->verifyBatchUsed;
+  SRXPROXY_VERIFY_BULK_REQUEST* hdr;
+
+  if (count == 0)
+  {
+    return true;
+  }
+
+  // Reset the batch first, sendPacketToServer flushes pending requests.
+  self->verifyBatchCount = 0;
+  self->verifyBatchUsed  = 0;
+
+  if (count == 1)
+  {
+    return sendPacketToServer(self, 
+                  self->verifyBatch + sizeof(SRXPROXY_VERIFY_BULK_REQUEST),
+                  used - sizeof(SRXPROXY_VERIFY_BULK_REQUEST));
+  }
+
+  hdr = (SRXPROXY_VERIFY_BULK_REQUEST*)self->verifyBatch;
+  memset(hdr, 0, sizeof(SRXPROXY_VERIFY_BULK_REQUEST));
+  hdr->type       = PDU_SRXPROXY_VERIFY_BULK_REQUEST;
+  hdr->noRequests = htonl(count);
+  hdr->length     = htonl(used);
+
+  LOG(LEVEL_DEBUG, HDR "Send bulk verify request with %u requests (%u bytes)",
+                   pthread_self(), count, used);
+
+  return sendPacketToServer(self, self->verifyBatch, used);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// METHODS USED TO RECEIVE
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Return the length of the PDU at the beginning of the given data or 0 if the
+ * data does not contain a complete PDU.
+ *
+ * @param data The received data.
+ * @param size The number of bytes received.
+ *
+ * @return the length of the complete PDU or 0.
+ *
+ * @since 0.6.2.2
+ */
+static uint32_t _completePDULength(uint8_t* data, uint32_t size)
+{
+  uint32_t pduLength;
+
+  if (size < sizeof(SRXPROXY_BasicHeader))
+  {
+    return 0;
+  }
+  pduLength = ntohl(((SRXPROXY_BasicHeader*)data)->length);
+
+  return (pduLength <= size) ? pduLength : 0;
+}
+
+/**
+ * Determine if the receive buffer contains a complete PDU.
+ *
+ * @param self Instance that should be used
+ *
+ * @return true if a complete PDU is buffered.
+ *
+ * @since 0.6.2.2
+ */
+bool hasBufferedPackets(ClientConnectionHandler* self)
+{
+  return (self->rcvBuffer != NULL)
+         && (_completePDULength(self->rcvBuffer, self->rcvUsed) != 0);
+}
+
+/**
+ * Read all data available on the socket without blocking and process all
+ * complete PDUs, at most rcvBudget PDUs. Only if no PDU was processed yet, the
+ * function waits for data. Incomplete PDUs and PDUs exceeding the budget stay 
+ * in the receive buffer.
+ *
+ * @param self Instance that should be used
+ *
+ * @return false if the connection is closed or an error occurred.
+ *
+ * @since 0.6.2.2
+ */
+bool receiveAvailablePackets(ClientConnectionHandler* self)
+{
+  int*     fdPtr     = getClientFDPtr(&self->clSock);
+  uint32_t noPDUs    = 0;
+  uint32_t offset    = 0;
+  uint32_t pduLength = 0;
+  uint32_t required  = 0;
+  uint32_t newSize   = 0;
+  uint8_t* newBuffer = NULL;
+  ssize_t  rbytes    = 0;
+  bool     retVal    = true;
+  bool     drained   = false;
+  SRXPROXY_BasicHeader* hdr = NULL;
+
+  self->rcvStats.wakeups++;
+
+  while (retVal && !drained && (noPDUs < self->rcvBudget))
+  {
+    // 1. Process the complete PDUs within the buffer
+    offset = 0;
+    while (   (noPDUs < self->rcvBudget) && (self->rcvBuffer != NULL)
+           && (offset < self->rcvUsed))
+    {
+      hdr = (SRXPROXY_BasicHeader*)(self->rcvBuffer + offset);
+      if (   (self->rcvUsed - offset >= sizeof(SRXPROXY_BasicHeader))
+          && (ntohl(hdr->length) < sizeof(SRXPROXY_BasicHeader)))
+      {
+        RAISE_ERROR("Received PDU is invalid (length %u)!", 
+                    ntohl(hdr->length));
+        self->rcvUsed = 0;
+        return false;
+      }
+      pduLength = _completePDULength(self->rcvBuffer + offset,
+                                     self->rcvUsed - offset);
+      if (pduLength == 0)
+      {
+        break;
+      }
+      LOG(LEVEL_DEBUG, HDR "Received data and call dispatcher.", 
+          pthread_self());
+      self->packetHandler(hdr, self->srxProxy);
+      noPDUs++;
+      offset += pduLength;
+      if (self->rcvBuffer == NULL)
+      {
+        // The connection handler was released while processing the PDU, e.g.
+        // due to a goodbye.
+        offset = 0;
+        drained = true;
+        break;
+      }
+    }
+    if (offset > 0)
+    {
+      self->rcvUsed -= offset;
+      memmove(self->rcvBuffer, self->rcvBuffer + offset, self->rcvUsed);
+    }
+    if (drained || (noPDUs >= self->rcvBudget))
+    {
+      break;
+    }
+
+    // 2. Make room for at least the remainder of the next PDU
+    required = self->rcvUsed + 1;
+    if (self->rcvUsed >= sizeof(SRXPROXY_BasicHeader))
+    {
+      pduLength = ntohl(((SRXPROXY_BasicHeader*)self->rcvBuffer)->length);
+      required  = pduLength > required ? pduLength : required;
+    }
+    if (required > self->rcvBufferSize)
+    {
+      newSize = self->rcvBufferSize == 0 ? RECEIVE_BUFFER_INIT_SIZE
+                                         : self->rcvBufferSize;
+      while (newSize < required)
+      {
+        newSize *= 2;
+      }
+      newBuffer = realloc(self->rcvBuffer, newSize);
+      if (newBuffer == NULL)
+      {
+        RAISE_ERROR("Not enough memory for receiving packets");
+        retVal = false;
+        break;
+      }
+      self->rcvBuffer     = newBuffer;
+      self->rcvBufferSize = newSize;
+    }
+
+    // 3. Read what is available, wait only if nothing was processed yet
+    rbytes = recvAvailable(fdPtr, self->rcvBuffer + self->rcvUsed,
+                           self->rcvBufferSize - self->rcvUsed, noPDUs == 0);
+    if (rbytes < 0)
+    {
+      LOG(LEVEL_DEBUG, HDR "Data delivery interrupted!", pthread_self());
+      retVal = false;
+    }
+    else if (rbytes == 0)
+    {
+      drained = true;
+    }
+    else
+    {
+      self->rcvStats.reads++;
+      self->rcvUsed += (uint32_t)rbytes;
+    }
+  }
+
+  if (noPDUs >= self->rcvBudget)
+  {
+    self->rcvStats.budgetExhausted++;
+  }
+  self->rcvStats.pdus += noPDUs;
+  if (noPDUs > self->rcvStats.maxPerWakeup)
+  {
+    self->rcvStats.maxPerWakeup = noPDUs;
+  }
+
+  return retVal;
+}
+
 /**
  * Handler to catch the timeout alarm for handshake.
  * 
@@ -477,6 +829,12 @@ void _catch_handshakeTimeout(int sig)
  */
 bool handshakeWithServer(ClientConnectionHandler* self, SRXPROXY_HELLO* pdu)
 {  
+  // Verify requests collected and data received during the previous session
+  // are dropped.
+  self->verifyBatchCount = 0;
+  self->verifyBatchUsed  = 0;
+  self->rcvUsed          = 0;
+
   // Send 'HELLO' to the server
   if (!sendData(&self->clSock, (void*)pdu, ntohl(pdu->length)))
   {
@@ -576,6 +934,8 @@ bool sendGoodbye(ClientConnectionHandler* self, uint16_t keepWindow)
 
   if (isConnectedToServer(&self->clSock))
   {
+    // Pending verify requests must be send prior to the goodbye.
+    flushVerifyRequests(self);
     if (sendData(&self->clSock, &pdu, length))
     {
       self->established = false;
@@ -800,6 +1160,7 @@ bool reconnectSRX(ClientConnectionHandler* self)
 
     hdr->type            = PDU_SRXPROXY_HELLO;
     hdr->version         = htons(SRX_PROTOCOL_VER);
+    hdr->capabilities    = htonl(SRX_PROXY_CAPABILITIES);
     hdr->length          = htonl(length);
     hdr->proxyIdentifier = htonl(proxy->proxyID);
     hdr->asn             = htonl(proxy->proxyAS);
@@ -20,10 +20,16 @@
  * other licenses. Please refer to the licenses of all libraries required 
  * by this software.
  *
- * Version 0.5.0.6
+ * Version 0.6.2.2
  * 
  * Changelog:
  * -----------------------------------------------------------------------------
+ * 0.6.2.2 - 2026/10/17
+ *           * Added the verify batch that collects verify requests which are
+ *             send within one bulk verify request.
+ *           * Added queueVerifyRequest and flushVerifyRequests.
+ *           * Added the receive buffer, receive budget and statistics.
+ *           * Added receiveAvailablePackets and hasBufferedPackets.
  * 0.5.0.6 - 2018/11/20 - oborchert
  *           * Removed "inline" keyword from functions - caused linker error 
  *             on Ubuntu 18
@@ -42,6 +48,7 @@
 
 #include <pthread.h>
 #include <semaphore.h>
+#include <time.h>
 #include "client/srx_api.h"
 #include "util/client_socket.h"
 #include "util/packet.h"
@@ -97,6 +104,23 @@ typedef struct {
   uint32_t         handshake_timeout; // The time in seconds allowed to wait
                                     // until a handshake timeout occurs.
 
+  // The verify batch, used only if the server supports bulk verify requests.
+  uint8_t*         verifyBatch;     // The bulk verify request header followed
+                                    // by the collected verify requests.
+  uint32_t         verifyBatchSize; // The allocated size of verifyBatch.
+  uint32_t         verifyBatchUsed; // The number of bytes used incl. header.
+  uint32_t         verifyBatchCount;// The number of collected requests.
+  uint16_t         verifyBatchMax;  // Max requests per bulk, 0 or 1 disables.
+  uint32_t         verifyBatchDelay;// Max milliseconds a request is collected.
+  struct timespec  verifyBatchStart;// The time the first request was added.
+
+  // The buffer of received but not yet processed data.
+  uint8_t*         rcvBuffer;       // The receive buffer.
+  uint32_t         rcvBufferSize;   // The allocated size of rcvBuffer.
+  uint32_t         rcvUsed;         // The number of bytes in rcvBuffer.
+  uint32_t         rcvBudget;       // Max PDUs processed per call.
+  SRxProxyReceiveStats rcvStats;    // The receive statistics.
+
   // Pointer to the srx proxy
   uint32_t         keepWindow;    // a default keep window value.
   SRxProxy*        srxProxy;      // A pointer to the SRX proxy instance.
@@ -204,6 +228,61 @@ bool connHandlerUnlock(ClientConnectionHandler* self);
 bool sendPacketToServer(ClientConnectionHandler* self, SRXPROXY_PDU* header,
                         uint32_t length);
 
+/**
+ * Add the given verify request to the verify batch. The batch is send once it
+ * contains verifyBatchMax requests or its first request waits longer than
+ * verifyBatchDelay milliseconds. Any other PDU send to the server will flush 
+ * the batch first.
+ *
+ * @param self Instance that should be used
+ * @param data The verify request PDU.
+ * @param length The length of the verify request PDU.
+ *
+ * @return false if the request could not be added or the batch could not be 
+ *         send.
+ *
+ * @since 0.6.2.2
+ */
+bool queueVerifyRequest(ClientConnectionHandler* self, void* data,
+                        uint32_t length);
+
+/**
+ * Read all data available on the socket without blocking and process all
+ * complete PDUs, at most rcvBudget PDUs. Only if no PDU was processed yet, the
+ * function waits for data. Incomplete PDUs and PDUs exceeding the budget stay 
+ * in the receive buffer.
+ *
+ * @param self Instance that should be used
+ *
+ * @return false if the connection is closed or an error occurred.
+ *
+ * @since 0.6.2.2
+ */
+bool receiveAvailablePackets(ClientConnectionHandler* self);
+
+/**
+ * Determine if the receive buffer contains a complete PDU.
+ *
+ * @param self Instance that should be used
+ *
+ * @return true if a complete PDU is buffered.
+ *
+ * @since 0.6.2.2
+ */
+bool hasBufferedPackets(ClientConnectionHandler* self);
+
+/**
+ * Send all verify requests collected in the verify batch. A single request is 
+ * send as it is, multiple requests are send within one bulk verify request.
+ *
+ * @param self Instance that should be used
+ *
+ * @return true if the batch was empty or could be send.
+ *
+ * @since 0.6.2.2
+ */
+bool flushVerifyRequests(ClientConnectionHandler* self);
+
 
 /*
  * Create the connection of application layer between srx and proxy
@@ -23,10 +23,19 @@
  * Secure Routing extension (SRx) client API - This API provides a fully
  * functional proxy client to the SRx server.
  *
- * Version: 0.6.0.0
+ * Version: 0.6.2.2
  *
  * Changelog:
  * -----------------------------------------------------------------------------
+ * 0.6.2.2  - 2026/10/17
+ *            * Offer the supported capabilities in the hello packet and store
+ *              the capabilities selected by the server.
+ *            * Collect verify requests into bulk verify requests if enabled
+ *              using setVerifyBatch and supported by the server.
+ *            * Added processing of bulk verify notifications.
+ *            * processPackets processes all buffered PDUs up to the receive 
+ *              budget. Added setReceiveBudget, hasPendingPackets and 
+ *              getReceiveStatistics.
  * 0.6.0.0  - 2021/04/06 - borchert
  *            * Added initialization of common header - reserved8
  *            * Assigned asType and asRelationShip to common header
@@ -449,6 +458,7 @@ bool connectToSRx(SRxProxy* proxy, const char* host, int port,
 
   hdr->type            = PDU_SRXPROXY_HELLO;
   hdr->version         = htons(SRX_PROTOCOL_VER);
+  hdr->capabilities    = htonl(SRX_PROXY_CAPABILITIES);
   hdr->length          = htonl(length);
   hdr->proxyIdentifier = htonl(proxy->proxyID);
   hdr->asn             = htonl(proxy->proxyAS);
@@ -654,6 +664,129 @@ void resetProxyError(SRxProxy* proxy)
   proxy->lastSubCode = COM_PROXY_NO_SUBCODE;
 }
 
+/**
+ * Configure the collection of verify requests into bulk verify requests. This
+ * is only used if the SRx server supports bulk verify requests.
+ *
+ * @param proxy The SRx-Proxy instance
+ * @param maxRequests The maximum number of requests in one bulk request. The
+ *                    values 0 and 1 disable the collection (default).
+ * @param maxDelayMillis The maximum time in milliseconds a request is 
+ *                    collected.
+ *
+ * @return true if the configuration could be set.
+ *
+ * @since 0.6.2.2
+ */
+bool setVerifyBatch(SRxProxy* proxy, uint16_t maxRequests, 
+                    uint32_t maxDelayMillis)
+{
+  ClientConnectionHandler* connHandler = (proxy != NULL) 
+                              ? (ClientConnectionHandler*)proxy->connHandler
+                              : NULL;
+  if (connHandler == NULL)
+  {
+    return false;
+  }
+
+  connHandler->verifyBatchMax   = maxRequests;
+  connHandler->verifyBatchDelay = maxDelayMillis;
+  if (maxRequests <= 1)
+  {
+    // Disabled, do not keep any pending requests.
+    return flushVerifyBatch(proxy);
+  }
+
+  return true;
+}
+
+/**
+ * Send all collected verify requests to the SRx server.
+ *
+ * @param proxy The SRx-Proxy instance
+ *
+ * @return true if no requests were collected or they could be send.
+ *
+ * @since 0.6.2.2
+ */
+bool flushVerifyBatch(SRxProxy* proxy)
+{
+  ClientConnectionHandler* connHandler = (proxy != NULL) 
+                              ? (ClientConnectionHandler*)proxy->connHandler
+                              : NULL;
+  bool retVal = true;
+
+  if ((connHandler != NULL) && (connHandler->verifyBatchCount > 0))
+  {
+    retVal = flushVerifyRequests(connHandler);
+    if (!retVal)
+    {
+      LOG(LEVEL_ERROR, "Failure during sending the collected verify "
+                       "requests!");
+      callCMgmtHandler(proxy, COM_ERR_PROXY_COULD_NOT_SEND, 
+                       getLastSendError());
+    }
+  }
+
+  return retVal;
+}
+
+/**
+ * Set the maximum number of PDUs processed by one call of processPackets. 
+ * Remaining PDUs stay buffered, see hasPendingPackets.
+ *
+ * @param proxy The SRx-Proxy instance
+ * @param budget The maximum number of PDUs, 0 selects the default 
+ *               SRX_DEFAULT_RECEIVE_BUDGET.
+ *
+ * @since 0.6.2.2
+ */
+void setReceiveBudget(SRxProxy* proxy, uint32_t budget)
+{
+  if ((proxy != NULL) && (proxy->connHandler != NULL))
+  {
+    ((ClientConnectionHandler*)proxy->connHandler)->rcvBudget =
+                             budget > 0 ? budget : SRX_DEFAULT_RECEIVE_BUDGET;
+  }
+}
+
+/**
+ * Determine if complete PDUs are buffered which were not processed yet due to
+ * the receive budget. In this case processPackets must be called again, 
+ * waiting on the socket might not return.
+ *
+ * @param proxy The SRx-Proxy instance
+ *
+ * @return true if buffered PDUs wait to be processed.
+ *
+ * @since 0.6.2.2
+ */
+bool hasPendingPackets(SRxProxy* proxy)
+{
+  return    (proxy != NULL) && (proxy->connHandler != NULL)
+         && hasBufferedPackets((ClientConnectionHandler*)proxy->connHandler);
+}
+
+/**
+ * Retrieve the statistics of the PDUs received from the SRx server.
+ *
+ * @param proxy The SRx-Proxy instance
+ * @param stats The statistics to be filled.
+ *
+ * @since 0.6.2.2
+ */
+void getReceiveStatistics(SRxProxy* proxy, SRxProxyReceiveStats* stats)
+{
+  if ((proxy != NULL) && (proxy->connHandler != NULL))
+  {
+    *stats = ((ClientConnectionHandler*)proxy->connHandler)->rcvStats;
+  }
+  else
+  {
+    memset(stats, 0, sizeof(SRxProxyReceiveStats));
+  }
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 // Local helper functions
 ////////////////////////////////////////////////////////////////////////////////
@@ -822,6 +955,9 @@ void verifyUpdate(SRxProxy* proxy, uint32_t localID,
   // The client connection handler
   ClientConnectionHandler* connHandler =
                                    (ClientConnectionHandler*)proxy->connHandler;
+  // Collect the request if enabled and supported by the server.
+  bool useBatch =    (connHandler->verifyBatchMax > 1)
+                  && ((proxy->capabilities & SRX_PROXY_CAP_BULK_VERIFY) != 0);
 
   // create data packet.
   uint16_t bgpsecLength = 0;
@@ -854,7 +990,8 @@ void verifyUpdate(SRxProxy* proxy, uint32_t localID,
   do
   {
     attempt++;
-    if(sendPacketToServer(connHandler, (SRXPROXY_PDU*)pdu, length))
+    if (useBatch ? queueVerifyRequest(connHandler, pdu, length)
+                 : sendPacketToServer(connHandler, (SRXPROXY_PDU*)pdu, length))
     {
       // Leave the loop
       if (   proxy->socketConfig.resetSendErrors
@@ -1061,6 +1198,8 @@ void processHelloResponse(SRXPROXY_HELLO_RESPONSE* hdr, SRxProxy* proxy)
 
   if (ntohs(hdr->version) == SRX_PROTOCOL_VER)
   {
+    // Servers that do not know capabilities answer with 0
+    proxy->capabilities = ntohl(hdr->capabilities) & SRX_PROXY_CAPABILITIES;
     connHandler->established = true;
   }
   else
@@ -1109,6 +1248,7 @@ static int ct = 0;
  */
 void processVerifyNotify(SRXPROXY_VERIFY_NOTIFICATION* hdr, SRxProxy* proxy)
 {
+  ((ClientConnectionHandler*)proxy->connHandler)->rcvStats.notifications++;
   if (proxy->resCallback != NULL)
   {
     bool hasReceipt = (hdr->resultType & SRX_FLAG_REQUEST_RECEIPT)
@@ -1156,6 +1296,38 @@ void processVerifyNotify(SRXPROXY_VERIFY_NOTIFICATION* hdr, SRxProxy* proxy)
   }
 }
 
+/**
+ * The SRx server send multiple verification notifications within one bulk 
+ * verification notification. Each notification is processed on its own.
+ *
+ * @param hdr The "Verify Bulk Notification" Header
+ * @param proxy The instance of the proxy.
+ *
+ * @since 0.6.2.2
+ */
+void processVerifyBulkNotify(SRXPROXY_VERIFY_BULK_NOTIFICATION* hdr, 
+                             SRxProxy* proxy)
+{
+  uint32_t noNotifications = ntohl(hdr->noNotifications);
+  uint32_t length          = ntohl(hdr->length);
+  SRXPROXY_VERIFY_NOTIFICATION* notification = 
+                                       (SRXPROXY_VERIFY_NOTIFICATION*)(hdr + 1);
+  uint32_t idx;
+
+  if (length != (  sizeof(SRXPROXY_VERIFY_BULK_NOTIFICATION)
+                 + (noNotifications * sizeof(SRXPROXY_VERIFY_NOTIFICATION))))
+  {
+    RAISE_ERROR("Bulk verify notification of %u bytes does not match the "
+                "number of notifications (%u)!", length, noNotifications);
+    return;
+  }
+
+  for (idx = 0; idx < noNotifications; idx++)
+  {
+    processVerifyNotify(&notification[idx], proxy);
+  }
+}
+
 /**
  * Process signature notification.
  * NOT IMPLEMENTED YET
@@ -1318,6 +1490,11 @@ static void dispatchPackets(SRXPROXY_BasicHeader* packet, void* proxyPtr)
       processVerifyNotify((SRXPROXY_VERIFY_NOTIFICATION*)packet, proxy);
       break;
 
+    case PDU_SRXPROXY_VERI_BULK_NOTIFICATION:
+      processVerifyBulkNotify((SRXPROXY_VERIFY_BULK_NOTIFICATION*)packet, 
+                              proxy);
+      break;
+
     case PDU_SRXPROXY_SIGN_NOTIFICATION:
       processSignNotify((SRXPROXY_SIGNATURE_NOTIFICATION*)packet, proxy);
       break;
@@ -1339,8 +1516,9 @@ static void dispatchPackets(SRXPROXY_BasicHeader* packet, void* proxyPtr)
  * This function is called to read packets received from srx-server and process
  * them accordingly. This function allows the caller to have the packet handling
  * been done within the scope of the caller process. This is a possible blocking
- * method. It will go into a loop of receiving messages until the connection is
- * closed, lost, or all data is read.
+ * method, it waits for data only if no PDU is buffered. Then it reads without
+ * blocking and processes all complete PDUs available, at most the receive 
+ * budget. PDUs left due to the budget stay buffered (see hasPendingPackets).
  *
  * @param proxy The proxy instance
  *
@@ -1356,8 +1534,7 @@ bool processPackets(SRxProxy* proxy)
                                    (ClientConnectionHandler*)proxy->connHandler;
 
 
-  bRetVal = receivePackets(getClientFDPtr(&connHandler->clSock),
-                          connHandler->packetHandler, proxy, PHT_PROXY);
+  bRetVal = receiveAvailablePackets(connHandler);
 
   if(!bRetVal)
   {
@@ -23,10 +23,15 @@
  * Secure Routing extension (SRx) client API - This API provides a fully 
  * functional proxy client to the SRx server.
  *
- * Version 0.6.0.0
+ * Version 0.6.2.2
  * 
  * Changelog:
  * -----------------------------------------------------------------------------
+ * 0.6.2.2  - 2026/10/17
+ *            * Added the negotiated capabilities to SRxProxy.
+ *            * Added setVerifyBatch and flushVerifyBatch.
+ *            * Added SRxProxyReceiveStats, setReceiveBudget, hasPendingPackets
+ *              and getReceiveStatistics.
  * 0.6.0.0  - 2021/02/26 - kyehwanl
  *            * Added ASPA validation to verify request using the 
  *              SRx-Proxy_Protocol version 2.
@@ -258,6 +263,29 @@ typedef struct {
   uint16_t succsessSend;
 } ProxySocketConfig;
 
+/** The default number of PDUs processed by one call of processPackets. */
+#define SRX_DEFAULT_RECEIVE_BUDGET 256
+
+/** Statistics of the PDUs received from the SRx server.
+ * 
+ * @since 0.6.2.2
+ */
+typedef struct {
+  // Number of calls of processPackets.
+  uint64_t wakeups;
+  // Number of socket reads that returned data.
+  uint64_t reads;
+  // Number of PDUs processed.
+  uint64_t pdus;
+  // Number of verify notifications processed, including the ones within bulk
+  // notifications.
+  uint64_t notifications;
+  // The maximum number of PDUs processed within one call of processPackets.
+  uint32_t maxPerWakeup;
+  // Number of calls of processPackets that ended due to the receive budget.
+  uint64_t budgetExhausted;
+} SRxProxyReceiveStats;
+
 /** The data structure of the proxy. DO NOT change the settings, this is done
  * within the proxy implementation.
  */
@@ -286,6 +314,10 @@ typedef struct {
     
   // Experimental
   ProxySocketConfig socketConfig;
+
+  /** The capabilities the SRx server agreed on during the handshake
+   * (SRX_PROXY_CAP_...). */
+  uint32_t          capabilities;
 #ifdef USE_GRPC 
   bool  grpcClientEnable; 
   bool  grpcConnectionInit; 
@@ -473,8 +505,9 @@ bool signUpdate(SRxProxy* proxy, SRxUpdateID updateId, bool onlyOwnSignature,
  * This function is called to read packets received from srx-server and process
  * them accordingly. This function allows the caller to have the packet handling
  * been done within the scope of the caller process. This is a possible blocking
- * method. It will go into a loop of receiving messages until the connection is
- * closed, lost, or all data is read.
+ * method, it waits for data only if no PDU is buffered. Then it reads without
+ * blocking and processes all complete PDUs available, at most the receive 
+ * budget. PDUs left due to the budget stay buffered (see hasPendingPackets).
  *
  * @param proxy The proxy instance
  *
@@ -503,6 +536,74 @@ bool processPackets(SRxProxy* proxy);
  */
 int getInternalSocketFD(SRxProxy* proxy, bool main);
 
+/**
+ * Configure the collection of verify requests into bulk verify requests. This
+ * is only used if the SRx server supports bulk verify requests. The collected
+ * requests are send once maxRequests are collected, once the first collected 
+ * request waited maxDelayMillis at the time the next request is added, or 
+ * once flushVerifyBatch is called. The API does not use a timer, the user of
+ * the API MUST call flushVerifyBatch once no more requests follow for now, 
+ * e.g. after all updates of a received BGP message are processed.
+ *
+ * @param proxy The SRx-Proxy instance
+ * @param maxRequests The maximum number of requests in one bulk request. The
+ *                    values 0 and 1 disable the collection (default).
+ * @param maxDelayMillis The maximum time in milliseconds a request is 
+ *                    collected.
+ *
+ * @return true if the configuration could be set.
+ *
+ * @since 0.6.2.2
+ */
+bool setVerifyBatch(SRxProxy* proxy, uint16_t maxRequests, 
+                    uint32_t maxDelayMillis);
+
+/**
+ * Send all collected verify requests to the SRx server.
+ *
+ * @param proxy The SRx-Proxy instance
+ *
+ * @return true if no requests were collected or they could be send.
+ *
+ * @since 0.6.2.2
+ */
+bool flushVerifyBatch(SRxProxy* proxy);
+
+/**
+ * Set the maximum number of PDUs processed by one call of processPackets. 
+ * Remaining PDUs stay buffered, see hasPendingPackets.
+ *
+ * @param proxy The SRx-Proxy instance
+ * @param budget The maximum number of PDUs, 0 selects the default 
+ *               SRX_DEFAULT_RECEIVE_BUDGET.
+ *
+ * @since 0.6.2.2
+ */
+void setReceiveBudget(SRxProxy* proxy, uint32_t budget);
+
+/**
+ * Determine if complete PDUs are buffered which were not processed yet due to
+ * the receive budget. In this case processPackets must be called again, 
+ * waiting on the socket might not return.
+ *
+ * @param proxy The SRx-Proxy instance
+ *
+ * @return true if buffered PDUs wait to be processed.
+ *
+ * @since 0.6.2.2
+ */
+bool hasPendingPackets(SRxProxy* proxy);
+
+/**
+ * Retrieve the statistics of the PDUs received from the SRx server.
+ *
+ * @param proxy The SRx-Proxy instance
+ * @param stats The statistics to be filled.
+ *
+ * @since 0.6.2.2
+ */
+void getReceiveStatistics(SRxProxy* proxy, SRxProxyReceiveStats* stats);
+
 /**
  * Reset the error attributes of this proxy. Post condition of this function
  * is proxy->lastError=ERR_PROXY_NONE and 
@@ -20,12 +20,24 @@
  * other licenses. Please refer to the licenses of all libraries required 
  * by this software.
  *
- * This file contains the ASPA trie.
+ * This file contains the ASPA database. The ASPA objects are stored in an
+ * open addressed hash table (linear probing) keyed by the 32 bit customer ASN
+ * and the AFI. The provider list of each object is kept sorted.
  *
- * Version 0.6.1.2
+ * Version 0.6.2.2
  * 
  * Changelog:
  * -----------------------------------------------------------------------------
+ * 0.6.2.2 - 2026/10/17
+ *           * Replaced the 10-ary trie which was keyed by the decimal string
+ *             of the customer ASN with an open addressed hash table.
+ *           * Sort the provider ASNs in newASPAObject and use a binary search
+ *             in ASPA_DB_lookup.
+ *           * Lookups only acquire the read lock.
+ *           * Objects stored with ASPA_ANY_AFI are used for all AFIs.
+ *           * A withdrawal without ASPA object removes the customer ASN.
+ *           * process_ASPA_EndOfData_main re-validates a single (dirty) path
+ *             once and passes the result on to all updates of the path.
  * 0.6.1.2 - 2021/11/18 - kyehwanl
  *           * Moved static declaration statement from .h into .c file 
  *         - 2021/11/12 - kyehwanl
@@ -51,30 +63,161 @@
 #include "server/rpki_queue.h"
 #include "util/log.h"
 
-static uint32_t countTrieNode =0;
-static TrieNode* newAspaTrie(void);
-static TrieNode* make_trienode(char data, char* userData, ASPA_Object* );
-static void free_trienode(TrieNode* node);
-static int search_trie(TrieNode* root, char* word);
+/** Grow the table once more than 7/10 of the slots are used. */
+#define ASPA_DB_MAX_LOAD(size) (((size) / 10) * 7)
+
 static void emptyAspaDB(ASPA_DBManager* self);
+static bool _aspa_resize(ASPA_DBManager* self, uint32_t newSize);
 
-int process_ASPA_EndOfData_main(void* uc, void* handler, uint32_t uid, uint32_t pid, time_t ct);
+int process_ASPA_EndOfData_main(void* uc, void* handler, uint32_t pid, 
+                                SRxUpdateID* uids, uint32_t noUIDs);
 extern RPKI_QUEUE* getRPKIQueue();
 extern uint8_t validateASPA (PATH_LIST* asPathList, uint8_t length, AS_TYPE asType, 
                     AS_REL_DIR direction, uint8_t afi, ASPA_DBManager* aspaDBManager);
 
+/**
+ * Generate the hash value of the given key. The customer ASN and the AFI are
+ * mixed using a 64 bit multiplicative hash (Fibonacci hashing).
+ * 
+ * @param customerAsn The customer ASN
+ * @param afi The AFI
+ * @param mask The table size - 1
+ * 
+ * @return The index of the home slot.
+ */
+static inline uint32_t _aspa_slot(uint32_t customerAsn, uint16_t afi, 
+                                  uint32_t mask)
+{
+  uint64_t key = ((uint64_t)afi << 32) | customerAsn;
+  key *= 0x9E3779B97F4A7C15ULL;
+  return (uint32_t)(key >> 32) & mask;
+}
+
+/**
+ * Find the slot of the given key. The table lock must be held by the caller.
+ * 
+ * @param self The ASPA database
+ * @param customerAsn The customer ASN
+ * @param afi The AFI
+ * 
+ * @return The slot of the key or the empty slot where the key would be 
+ *         stored.
+ */
+static ASPA_DBEntry* _aspa_findSlot(ASPA_DBManager* self, uint32_t customerAsn,
+                                    uint16_t afi)
+{
+  uint32_t mask = self->tableSize - 1;
+  uint32_t idx  = _aspa_slot(customerAsn, afi, mask);
+  ASPA_DBEntry* entry = &self->table[idx];
+  
+  while (entry->aspaObject != NULL)
+  {
+    if (entry->customerAsn == customerAsn && entry->afi == afi)
+    {
+      break;
+    }
+    idx   = (idx + 1) & mask;
+    entry = &self->table[idx];
+  }
+  
+  return entry;
+}
+
+/**
+ * Remove the object in the given slot from the table. The following slots of
+ * the same cluster are shifted backwards, this way no tombstones are needed.
+ * The object itself is NOT released. The write lock must be held.
+ * 
+ * @param self The ASPA database
+ * @param entry The slot to be emptied.
+ */
+static void _aspa_removeSlot(ASPA_DBManager* self, ASPA_DBEntry* entry)
+{
+  uint32_t mask = self->tableSize - 1;
+  uint32_t hole = (uint32_t)(entry - self->table);
+  uint32_t idx  = hole;
+  uint32_t home;
+  
+  while (true)
+  {
+    idx = (idx + 1) & mask;
+    if (self->table[idx].aspaObject == NULL)
+    {
+      break;
+    }
+    home = _aspa_slot(self->table[idx].customerAsn, self->table[idx].afi, 
+                      mask);
+    // Move the entry into the hole unless its home lies cyclically in 
+    // (hole, idx]
+    if (((idx - home) & mask) >= ((idx - hole) & mask))
+    {
+      self->table[hole] = self->table[idx];
+      hole = idx;
+    }
+  }
+  self->table[hole].aspaObject  = NULL;
+  self->table[hole].customerAsn = 0;
+  self->table[hole].afi         = 0;
+}
+
+/**
+ * Rehash all objects into a new table of the given size. The write lock must 
+ * be held.
+ * 
+ * @param self The ASPA database
+ * @param newSize The new size (power of 2)
+ * 
+ * @return false if the memory could not be allocated.
+ */
+static bool _aspa_resize(ASPA_DBManager* self, uint32_t newSize)
+{
+  ASPA_DBEntry* oldTable = self->table;
+  uint32_t      oldSize  = self->tableSize;
+  uint32_t      idx;
+  
+  ASPA_DBEntry* newTable = calloc(newSize, sizeof(ASPA_DBEntry));
+  if (newTable == NULL)
+  {
+    return false;
+  }
+  
+  self->table     = newTable;
+  self->tableSize = newSize;
+  
+  for (idx = 0; idx < oldSize; idx++)
+  {
+    if (oldTable[idx].aspaObject != NULL)
+    {
+      *_aspa_findSlot(self, oldTable[idx].customerAsn, oldTable[idx].afi) 
+                                                               = oldTable[idx];
+    }
+  }
+  free(oldTable);
+  
+  return true;
+}
+
 // API for initialization
 //
 bool initializeAspaDBManager(ASPA_DBManager* aspaDBManager, Configuration* config) 
 {
-   aspaDBManager->tableRoot = newAspaTrie();
+   aspaDBManager->table = calloc(ASPA_DB_INIT_SLOTS, sizeof(ASPA_DBEntry));
+   aspaDBManager->tableSize = ASPA_DB_INIT_SLOTS;
    aspaDBManager->countAspaObj = 0;
    aspaDBManager->config = config;
    aspaDBManager->cbProcessEndOfData = process_ASPA_EndOfData_main;
   
+   if (aspaDBManager->table == NULL)
+   {
+     RAISE_ERROR("Unable to allocate the aspa object db");
+     return false;
+   }
+
    if (!createRWLock(&aspaDBManager->tableLock))
    {
      RAISE_ERROR("Unable to setup the aspa object db r/w lock");
+     free(aspaDBManager->table);
+     aspaDBManager->table = NULL;
      return false;
    }
 
@@ -85,9 +228,20 @@ bool initializeAspaDBManager(ASPA_DBManager* aspaDBManager, Configuration* confi
 //
 static void emptyAspaDB(ASPA_DBManager* self)
 {
+  uint32_t idx;
+  
   acquireWriteLock(&self->tableLock);
-  free_trienode(self->tableRoot);
-  self->tableRoot = NULL;
+  for (idx = 0; idx < self->tableSize; idx++)
+  {
+    if (self->table[idx].aspaObject != NULL)
+    {
+      deleteASPAObject(self, self->table[idx].aspaObject);
+      self->table[idx].aspaObject = NULL;
+    }
+  }
+  free(self->table);
+  self->table = NULL;
+  self->tableSize = 0;
   self->countAspaObj = 0;
   unlockWriteLock(&self->tableLock);
 }
@@ -99,28 +253,32 @@ void releaseAspaDBManager(ASPA_DBManager* self)
 {
   if (self != NULL)
   {
-    releaseRWLock(&self->tableLock);
     emptyAspaDB(self);
+    releaseRWLock(&self->tableLock);
   }
 }
 
-
-// generate trie node
-//
-static TrieNode* newAspaTrie(void) 
+/**
+ * Compare function for sorting the provider ASNs.
+ * 
+ * @param a the first ASN
+ * @param b the second ASN
+ * 
+ * @return -1, 0, 1
+ */
+static int _aspa_cmpAsn(const void* a, const void* b)
 {
-  TrieNode *rootNode = make_trienode('\0', NULL, NULL);
-  return rootNode;
+  uint32_t asnA = *(const uint32_t*)a;
+  uint32_t asnB = *(const uint32_t*)b;
+  
+  return (asnA < asnB) ? -1 : (asnA > asnB) ? 1 : 0;
 }
 
-
 // external api for creating db object
 //
 ASPA_Object* newASPAObject(uint32_t cusAsn, uint16_t pAsCount, uint32_t* provAsns, uint16_t afi)
 {
   ASPA_Object *obj = (ASPA_Object*)calloc(1, sizeof(ASPA_Object));
-  // Index variable for loops
-  int idx = 0;
   
   obj->customerAsn = cusAsn;
   obj->providerAsCount = pAsCount;
@@ -128,10 +286,9 @@ ASPA_Object* newASPAObject(uint32_t cusAsn, uint16_t pAsCount, uint32_t* provAsn
   
   if (obj->providerAsns && provAsns)
   {
-    for(idx = 0; idx < pAsCount; idx++)
-    {
-      obj->providerAsns[idx] = provAsns[idx];
-    }
+    memcpy(obj->providerAsns, provAsns, pAsCount * sizeof(uint32_t));
+    // Keep them sorted for the lookup.
+    qsort(obj->providerAsns, pAsCount, sizeof(uint32_t), _aspa_cmpAsn);
   }
   obj->afi = afi;
 
@@ -156,51 +313,6 @@ bool deleteASPAObject(ASPA_DBManager* self, ASPA_Object *obj)
   return false;
 }
 
-
-// create trie node
-//
-static TrieNode* make_trienode(char data, char* userData, ASPA_Object* obj) 
-{
-  // Index for loops
-  int idx = 0;
-  
-  // Allocate memory for a TrieNode
-  TrieNode* node = (TrieNode*) calloc (1, sizeof(TrieNode));
-  if (!node)
-  {
-    return NULL;
-  }
-
-  for (idx = 0; idx < N; idx++)
-      node->children[idx] = NULL;
-  
-  node->is_leaf = 0;
-  node->data = data;
-  node->userData = NULL;
-  node->aspaObjects = NULL;
-  
-  return node;
-}
-
-// free node
-static void free_trienode(TrieNode* node) 
-{
-  // Free the trienode sequence
-  int idx = 0;
-  for(idx = 0; idx < N; idx++) 
-  {
-    if (node->children[idx] != NULL) 
-    {
-      free_trienode(node->children[idx]);
-    }
-    else 
-    {
-      continue;
-    }
-  }
-  free(node);
-}
-
 bool compareAspaObject(ASPA_Object *obj1, ASPA_Object *obj2)
 {
   if (!obj1 || !obj2)
@@ -215,14 +327,9 @@ bool compareAspaObject(ASPA_Object *obj1, ASPA_Object *obj2)
   if (obj1->afi != obj2->afi)
     return false;
 
-  int idx;
-  
-  for (idx = 0; idx < obj1->providerAsCount; idx++)
-  {
-    if(obj1->providerAsns[idx] != obj2->providerAsns[idx])
-      return false;
-  }
-  return true;
+  // Both lists are sorted.
+  return memcmp(obj1->providerAsns, obj2->providerAsns, 
+                obj1->providerAsCount * sizeof(uint32_t)) == 0;
 }
 
 
@@ -230,35 +337,36 @@ bool compareAspaObject(ASPA_Object *obj1, ASPA_Object *obj2)
 bool delete_TrieNode_AspaObj (ASPA_DBManager* self, char* word, ASPA_Object* obj)
 {
   bool bRet = false;
-  int idx = 0;
+  ASPA_DBEntry* entry = NULL;
+  uint32_t customerAsn = 0;
+  uint16_t afi;
 
   acquireWriteLock(&self->tableLock);
-  TrieNode* temp = self->tableRoot; 
-  TrieNode* parent = NULL;
-  int position = 0;
 
-  // finding
-  for(idx = 0; word[idx] != '\0'; idx++)
+  if (obj != NULL)
   {
-    position = word[idx] - '0';
-    if (temp->children[position] == NULL)
+    entry = _aspa_findSlot(self, obj->customerAsn, obj->afi);
+    if (entry->aspaObject && compareAspaObject(entry->aspaObject, obj))
     {
-      temp = NULL;
-      break;
+      deleteASPAObject(self, entry->aspaObject);
+      _aspa_removeSlot(self, entry);
+      bRet = true;
     }
-    parent = temp;
-    temp = temp->children[position];
   }
-
-  // info compare
-  if (temp && temp->is_leaf == 1 && temp->aspaObjects 
-      && compareAspaObject(temp->aspaObjects, obj))
+  else if (word != NULL)
   {
-    deleteASPAObject(self, temp->aspaObjects);
-    free_trienode(temp);
-    temp = NULL;
-    parent->children[position] = NULL;
-    bRet = true;
+    // Withdrawal of the customer ASN, remove the objects of all AFIs
+    customerAsn = (uint32_t)strtoul(word, NULL, 10);
+    for (afi = ASPA_ANY_AFI; afi <= AFI_IP6; afi++)
+    {
+      entry = _aspa_findSlot(self, customerAsn, afi);
+      if (entry->aspaObject != NULL)
+      {
+        deleteASPAObject(self, entry->aspaObject);
+        _aspa_removeSlot(self, entry);
+        bRet = true;
+      }
+    }
   }
 
   unlockWriteLock(&self->tableLock);
@@ -268,335 +376,281 @@ bool delete_TrieNode_AspaObj (ASPA_DBManager* self, char* word, ASPA_Object* obj
 
 //  new value insert or substitution according to draft
 //
-TrieNode* insertAspaObj (ASPA_DBManager* self, char* word, char* userData, 
-                         ASPA_Object* obj) 
+ASPA_DBEntry* insertAspaObj (ASPA_DBManager* self, char* word, char* userData, 
+                             ASPA_Object* obj) 
 {
-  TrieNode* temp = self->tableRoot; // start with root node
+  ASPA_DBEntry* entry = NULL;
+  
+  if (obj == NULL)
+  {
+    return NULL;
+  }
+  
   acquireWriteLock(&self->tableLock);
-  int i;
   
-  for (i=0; word[i] != '\0'; i++) 
+  if (self->countAspaObj >= ASPA_DB_MAX_LOAD(self->tableSize))
   {
-    int idx = (int) word[i] - '0';
-    //printf("index: %02x(%d), word[%d]: %c  \n", idx, idx, i, word[i]);
-    if (temp->children[idx] == NULL) {
-        // If the corresponding child doesn't exist, simply create that child!
-        temp->children[idx] = make_trienode(word[i], userData, obj);
-    }
-    else {
-        // Do nothing. The node already exists
+    if (!_aspa_resize(self, self->tableSize << 1))
+    {
+      RAISE_ERROR("Unable to grow the aspa object db");
     }
-    // Go down a level, to the child referenced by idx
-    temp = temp->children[idx];
   }
+  
+  entry = _aspa_findSlot(self, obj->customerAsn, obj->afi);
 
-  if (temp)
+  // substitution if exist
+  if (entry->aspaObject && entry->aspaObject != obj)
   {
-    // At the end of the word, mark this node as the leaf node
-    temp->is_leaf = 1;
-    temp->userData =  userData;
-
-    // substitution if exist
-    if (temp->aspaObjects && temp->aspaObjects != obj)
-    {
-      deleteASPAObject(self, temp->aspaObjects);
-      countTrieNode--;
-    }
-    temp->aspaObjects = obj;
-    countTrieNode++;
-    self->countAspaObj++;
+    deleteASPAObject(self, entry->aspaObject);
   }
+  else if (entry->aspaObject == obj)
+  {
+    // Already stored, do not count twice
+    self->countAspaObj--;
+  }
+  entry->customerAsn = obj->customerAsn;
+  entry->afi         = obj->afi;
+  entry->aspaObject  = obj;
+  self->countAspaObj++;
 
   unlockWriteLock(&self->tableLock);
 
-  return temp;
-}
-
-// get total count
-//
-uint32_t getCountTrieNode(void)
-{
-  return countTrieNode;
-}
-
-// search method
-//
-static int search_trie(TrieNode* root, char* word)
-{
-    // Searches for word in the Trie
-    TrieNode* temp = root;
-    int i=0;
-    for(i=0; word[i]!='\0'; i++)
-    {
-        int position = word[i] - '0';
-        if (temp->children[position] == NULL)
-            return 0;
-        temp = temp->children[position];
-    }
-    if (temp != NULL && temp->is_leaf == 1)
-        return 1;
-    return 0;
+  return entry;
 }
 
-// external api for searching trie
+// external api for searching the db
 //
-ASPA_Object* findAspaObject(ASPA_DBManager* self, char* word)
+ASPA_Object* findAspaObject(ASPA_DBManager* self, uint32_t customerAsn, 
+                            uint16_t afi)
 {
-    ASPA_Object *obj=NULL;
-  
-    acquireWriteLock(&self->tableLock);
-    TrieNode* temp = self->tableRoot; 
+  ASPA_Object *obj=NULL;
 
-    int i;
-    for(i=0; word[i]!='\0'; i++)
-    {
-        int position = word[i] - '0';
-        if (temp->children[position] == NULL)
-        {
-          obj = NULL;
-          temp = NULL;
-          break;
-        }
-        temp = temp->children[position];
-    }
+  acquireReadLock(&self->tableLock);
+  obj = _aspa_findSlot(self, customerAsn, afi)->aspaObject;
+  unlockReadLock(&self->tableLock);
 
-    if (temp != NULL && temp->is_leaf == 1)
-    {
-        obj = temp->aspaObjects;
-    }
-    unlockWriteLock(&self->tableLock);
-
-    return obj;
+  return obj;
 }
 
 //
-//  print all nodes
+//  print all objects
 //
-TrieNode* printAllLeafNode(TrieNode *node)
+void printAllAspaObjects(ASPA_DBManager* self)
 {
-  TrieNode* leaf = NULL;
-  uint8_t count=0;
+  uint32_t count=0;
+  uint32_t idx;
+  int      pIdx;
+  ASPA_Object *obj = NULL;
 
-  if (node->is_leaf == 1)
+  acquireReadLock(&self->tableLock);
+  for (idx = 0; idx < self->tableSize; idx++) 
   {
-    leaf = node;
-    return leaf;
+    obj = self->table[idx].aspaObject;
+    if (obj)
+    {
+      printf("\n++ count: %u, slot: %u, ASPA object:%p \n", 
+             ++count, idx, obj);
+      printf("++ customer ASN: %u\n", obj->customerAsn);
+      printf("++ providerAsCount : %d\n", obj->providerAsCount);
+      printf("++ Address: provider asns : %p\n", obj->providerAsns);
+      if (obj->providerAsns)
+      {
+        for(pIdx = 0; pIdx < obj->providerAsCount; pIdx++)
+          printf("++ providerAsns[%d]: %u\n", pIdx, obj->providerAsns[pIdx]);
+      }
+      printf("++ afi: %d\n", obj->afi);
+    }
   }
+  unlockReadLock(&self->tableLock);
+}
 
-  int childIdx;
-  for (childIdx = 0; childIdx < N; childIdx++) 
+/**
+ * Search the provider ASN in the sorted provider list of the object.
+ * 
+ * @param obj The ASPA object
+ * @param providerAsn The provider to look for.
+ * 
+ * @return true if the provider is listed.
+ */
+static bool _aspa_hasProvider(ASPA_Object* obj, uint32_t providerAsn)
+{
+  int low  = 0;
+  int high = obj->providerAsCount - 1;
+  int mid;
+  
+  if (obj->providerAsCount <= ASPA_LINEAR_SEARCH)
   {
-    if(node->children[childIdx])
+    for (low = 0; low <= high; low++)
     {
-      leaf = printAllLeafNode(node->children[childIdx]);
-      if (leaf)
+      if (obj->providerAsns[low] >= providerAsn)
       {
-        //printf("++ count: %d i:%d digit: %c user data: %s\n", ++count, i, leaf->data, leaf->userData);
-        printf("\n++ count: %d, user data: %s, ASPA object:%p \n", 
-            ++count, leaf->userData, leaf->aspaObjects);
-
-        ASPA_Object *obj = leaf->aspaObjects;
-        if (obj)
-        {
-          printf("++ customer ASN: %d\n", obj->customerAsn);
-          printf("++ providerAsCount : %d\n", obj->providerAsCount);
-          printf("++ Address: provider asns : %p\n", obj->providerAsns);
-          if (obj->providerAsns)
-          {
-            int pIdx;
-            for(pIdx = 0; pIdx < obj->providerAsCount; pIdx++)
-              printf("++ providerAsns[%d]: %d\n", pIdx, obj->providerAsns[pIdx]);
-          }
-          printf("++ afi: %d\n", obj->afi);
-        }
+        return obj->providerAsns[low] == providerAsn;
       }
     }
+    return false;
   }
-
-  return NULL;
-}
-
-
-
-void print_trie(TrieNode* root) {/*{{{*/
-    // Prints the nodes of the trie
-    if (!root)
-        return;
-    TrieNode* temp = root;
-    printf("%c -> ", temp->data);
-    int i=0;
-    for (i=0; i<N; i++) {
-        print_trie(temp->children[i]);
+  
+  while (low <= high)
+  {
+    mid = low + ((high - low) >> 1);
+    if (obj->providerAsns[mid] == providerAsn)
+    {
+      return true;
+    }
+    if (obj->providerAsns[mid] < providerAsn)
+    {
+      low = mid + 1;
     }
-}
-
-void print_search(TrieNode* root, char* word) {
-    printf("Searching for %s: ", word);
-    if (search_trie(root, word) == 0)
-        printf("Not Found\n");
     else
-        printf("Found!\n");
-}/*}}}*/
+    {
+      high = mid - 1;
+    }
+  }
+  
+  return false;
+}
 
 // 
 // external API for db loopkup
 //
-#define MAX_ASN_LENGTH 7
 ASPA_ValidationResult ASPA_DB_lookup(ASPA_DBManager* self, uint32_t customerAsn, 
                                      uint32_t providerAsn, uint8_t afi )
 {
+  ASPA_ValidationResult result = ASPA_RESULT_UNDEFINED;
+  ASPA_Object *obj = NULL;
+  
   LOG(LEVEL_DEBUG, FILE_LINE_INFO " ASPA DB Lookup called");
 
-  char strCusAsn[MAX_ASN_LENGTH] = {};
-  sprintf(strCusAsn, "%d", customerAsn);  
-
-  ASPA_Object *obj = findAspaObject(self, strCusAsn);
+  acquireReadLock(&self->tableLock);
+  
+  obj = _aspa_findSlot(self, customerAsn, afi)->aspaObject;
+  if (!obj && afi != ASPA_ANY_AFI)
+  {
+    // No AFI specific object, use the one that is valid for all AFIs 
+    obj = _aspa_findSlot(self, customerAsn, ASPA_ANY_AFI)->aspaObject;
+  }
 
   if (!obj) // if there is no object item
   {
     LOG(LEVEL_INFO, "[db] No customer ASN exist -- Unknown");
-    return ASPA_RESULT_UNKNOWN;
+    result = ASPA_RESULT_UNKNOWN;
   }
-  else // found object
+  else if (obj->providerAsns) // found object
   {
-    LOG(LEVEL_INFO, "[db] customer ASN: %d", obj->customerAsn);
-    LOG(LEVEL_INFO, "[db] providerAsCount : %d", obj->providerAsCount);
-    LOG(LEVEL_INFO, "[db] Address: provider asns : %p", obj->providerAsns);
-    LOG(LEVEL_INFO, "[db] afi: %d", obj->afi);
+    LOG(LEVEL_INFO, "[db] customer ASN: %u providerAsCount: %d afi: %d", 
+                    obj->customerAsn, obj->providerAsCount, obj->afi);
 
-    if (obj->providerAsns)
+    if (_aspa_hasProvider(obj, providerAsn))
+    {
+      LOG(LEVEL_INFO, "[db] Matched -- Valid");
+      result = ASPA_RESULT_VALID;
+    }
+    else
     {
-      int idx = 0;
-      
-      for (idx = 0; idx < obj->providerAsCount; idx++)
-      {
-        LOG(LEVEL_INFO, "[db] providerAsns[%d]: %d", idx, 
-                        obj->providerAsns[idx]);
-        if (obj->providerAsns[idx] == providerAsn && obj->afi == afi)
-        {
-          LOG(LEVEL_INFO, "[db] Matched -- Valid");
-          return ASPA_RESULT_VALID;
-        }
-      }
-  
       LOG(LEVEL_INFO, "[db] No Matched -- Invalid");
-      return ASPA_RESULT_INVALID;
+      result = ASPA_RESULT_INVALID;
     }
   }
-  return ASPA_RESULT_UNDEFINED;
+  
+  unlockReadLock(&self->tableLock);
 
+  return result;
 }
 
-int process_ASPA_EndOfData_main(void* uc, void* handler, uint32_t uid, 
-                                uint32_t pid, time_t ct)
+/**
+ * Re-validate the AS path with the given ID and pass the result on to all
+ * given updates. Updates whose result changed are queued in the RPKI queue.
+ * 
+ * @param uc The update cache
+ * @param handler The RPKI handler
+ * @param pid The path ID of the AS path that has to be re-validated.
+ * @param uids The updates that use the AS path.
+ * @param noUIDs The number of updates.
+ * 
+ * @return the number of updates that changed their result or -1 if the path
+ *         could not be found.
+ * 
+ * @since 0.6.2.2 (modified to work path based)
+ */
+int process_ASPA_EndOfData_main(void* uc, void* handler, uint32_t pid, 
+                                SRxUpdateID* uids, uint32_t noUIDs)
 {
   SRxResult        srxRes;
   SRxDefaultResult defaultRes;
-  time_t lastEndOfDataTime = ct;
-
-  UpdateCache*  uCache      = (UpdateCache*)uc;
-  SRxUpdateID   updateID    = (SRxUpdateID) uid;
-  uint32_t      pathId      = 0;
-  RPKIHandler*  rpkiHandler = (RPKIHandler*)handler;
-
-  LOG(LEVEL_INFO, "=== main process_main_ASPA_EndOfData UpdateCache:%p rpkiHandler:%p ctime:%u", 
-      (UpdateCache*)uCache, (RPKIHandler*)rpkiHandler, ct);
-
-
-  if (!getUpdateResult(uCache, &updateID, 0, NULL, &srxRes, &defaultRes, &pathId))
+  UpdateCache*     uCache      = (UpdateCache*)uc;
+  RPKIHandler*     rpkiHandler = (RPKIHandler*)handler;
+  AspathCache*     aspathCache = rpkiHandler->aspathCache;
+  ASPA_DBManager*  aspaDBManager = rpkiHandler->aspaDBManager;
+  RPKI_QUEUE*      rQueue      = getRPKIQueue();
+  SRxUpdateID      updateID;
+  uint32_t         pathId      = 0;
+  uint32_t         idx;
+  int              changed     = 0;
+
+  LOG(LEVEL_INFO, "=== main process_main_ASPA_EndOfData UpdateCache:%p "
+      "rpkiHandler:%p pathID:0x%08X updates:%u", uCache, rpkiHandler, pid, 
+      noUIDs);
+
+  srxRes.aspaResult = SRx_RESULT_UNDEFINED;
+  AS_PATH_LIST *aspl = getAspathListFromAspathCache (aspathCache, pid, &srxRes);
+  if (!aspl)
   {
-    LOG(LEVEL_WARNING, "Update ID: 0x%08X not found ", updateID);
-    return 0;
+    LOG(LEVEL_WARNING, "Path 0x%08X is registered for ASPA but the "
+        "AS Path List is not found!", pid);
+    return -1;
   }
-  else
-  {
-    ASPA_DBManager* aspaDBManager = rpkiHandler->aspaDBManager;
-    TrieNode *root = aspaDBManager->tableRoot;
 
-    LOG(LEVEL_INFO, "Update ID: 0x%08X  Path ID: 0x%08X", updateID, pathId);
+  uint8_t afi = aspl->afi;  
+  if (aspl->afi == 0 || aspl->afi > 2) // if more than 2 (AFI_IP6)
+    afi = AFI_IP;                      // set default
 
-    uint8_t old_aspaResult = srxRes.aspaResult; // obtained from getUpdateResult above
-    AS_PATH_LIST *aspl = getAspathListFromAspathCache (rpkiHandler->aspathCache, pathId, &srxRes);
+  // call ASPA validation
+  //
+  uint8_t valResult = validateASPA (aspl->asPathList, 
+      aspl->asPathLength, aspl->asType, aspl->asRelDir, afi, aspaDBManager);
 
-    if (aspl)
-    {
-      uint8_t afi = aspl->afi;  
-      if (aspl->afi == 0 || aspl->afi > 2) // if more than 2 (AFI_IP6)
-        afi = AFI_IP;                      // set default
+  LOG(LEVEL_INFO, FILE_LINE_INFO "\033[92m"" Validation Result: %d "
+      "(0:v, 2:Iv, 3:Ud 4:DNU 5:Uk, 6:Uf)""\033[0m", valResult);
 
+  // update the last validation time regardless of changed or not
+  aspl->lastModified = time(NULL);
 
-      LOG(LEVEL_INFO, "Comparison End of Data time(%u) : AS cache entry updated time (%u)",
-          lastEndOfDataTime, aspl->lastModified);
-      // timestamp comparison
-      //
-      if (lastEndOfDataTime > aspl->lastModified)
-      {
-        // call ASPA validation
-        //
-        uint8_t valResult = validateASPA (aspl->asPathList, 
-            aspl->asPathLength, aspl->asType, aspl->asRelDir, afi, aspaDBManager);
-
-        LOG(LEVEL_INFO, FILE_LINE_INFO "\033[92m"" Validation Result: %d "
-            "(0:v, 2:Iv, 3:Ud 4:DNU 5:Uk, 6:Uf)""\033[0m", valResult);
-
-        // update the last validation time regardless of changed or not
-        time_t cTime = time(NULL);
-        aspl->lastModified = cTime;
-
-        // modify Aspath Cache with the validation result
-        modifyAspaValidationResultToAspathCache (rpkiHandler->aspathCache, pathId, valResult, aspl);
-
-        // modify UpdateCache data and enqueue as well
-        if (valResult != aspl->aspaValResult)
-        {
-          aspl->aspaValResult = valResult;
-          srxRes.aspaResult = valResult;
-
-          // UpdateCache change
-          modifyUpdateCacheResultWithAspaVal(uCache, &updateID, &srxRes);
-
-          // if different values, queuing
-          RPKI_QUEUE*      rQueue = getRPKIQueue();
-          rq_queue(rQueue, RQ_ASPA, &updateID);
-          LOG(LEVEL_INFO, "rpki queuing for aspa validation [uID:0x%08X]", updateID);
-        }
-      }
-      //
-      // in case there is another update cache entry whose path id is same with the previous
-      // This prevents from doing ASPA validation repeatedly with the same AS path list
-      //
-      else /* if else time comparison */
-      {
-        // update cache entry with the new value 
-        if (old_aspaResult != aspl->aspaValResult)
-        {
-          LOG(LEVEL_INFO, FILE_LINE_INFO " ASPA validation result already set and "
-              " the existed validation result [%d] in UpdateCache is being updated with a new result[%d]", 
-              old_aspaResult, aspl->aspaValResult);
-          srxRes.aspaResult = aspl->aspaValResult;
-
-          // modify UpdateCache data as well
-          modifyUpdateCacheResultWithAspaVal(uCache, &updateID, &srxRes);
-
-          // if different values, queuing
-          RPKI_QUEUE*      rQueue = getRPKIQueue();
-          rq_queue(rQueue, RQ_ASPA, &updateID);
-          LOG(LEVEL_INFO, "rpki queuing for aspa validation [uID:0x%08X]", updateID);
-        }
-      }
+  // modify Aspath Cache with the validation result
+  modifyAspaValidationResultToAspathCache (aspathCache, pid, valResult, aspl);
+  if (valResult != aspl->aspaValResult)
+  {
+    aspathCache->stats.lastChangedPaths++;
+    aspathCache->stats.totalChangedPaths++;
+  }
 
-    }
-    else /* no aspath list */
+  // Now pass the result on to all updates of this path
+  for (idx = 0; idx < noUIDs; idx++)
+  {
+    updateID = uids[idx];
+    if (!getUpdateResult(uCache, &updateID, 0, NULL, &srxRes, &defaultRes, 
+                         &pathId))
     {
-      LOG(LEVEL_WARNING, "Update 0x%08X is registered for ASPA but the "
-          "AS Path List is not found!", updateID);
-    } // end of if aspl
-
-    if (aspl)
-      free (aspl);
+      LOG(LEVEL_WARNING, "Update ID: 0x%08X not found ", updateID);
+      continue;
+    }
 
-  }// end of else
+    if (srxRes.aspaResult != valResult)
+    {
+      srxRes.aspaResult = valResult;
+      // UpdateCache change
+      modifyUpdateCacheResultWithAspaVal(uCache, &updateID, &srxRes);
+
+      // if different values, queuing
+      rq_queue(rQueue, RQ_ASPA, &updateID);
+      LOG(LEVEL_INFO, "rpki queuing for aspa validation [uID:0x%08X]", 
+          updateID);
+      changed++;
+    }
+  }
+  aspathCache->stats.lastChangedUpdates  += changed;
+  aspathCache->stats.totalChangedUpdates += changed;
 
+  deleteAspathListEntry(aspl);
 
-  return 1;
+  return changed;
 }
@@ -20,12 +20,23 @@
  * other licenses. Please refer to the licenses of all libraries required 
  * by this software.
  *
- * This file contains the ASPA trie header information.
+ * This file contains the ASPA database header information. Despite the file
+ * name the ASPA objects are not stored in a trie anymore but in an open
+ * addressed hash table that is keyed directly by the 32 bit customer ASN and
+ * the AFI.
  *
- * Version 0.6.1.2
+ * Version 0.6.2.2
  * 
  * Changelog:
  * -----------------------------------------------------------------------------
+ * 0.6.2.2 - 2026/10/17
+ *           * Replaced the decimal string keyed 10-ary trie with an open 
+ *             addressed hash table keyed by (customer ASN, AFI).
+ *           * Provider ASNs are kept sorted to allow a binary search.
+ *           * Added ASPA_ANY_AFI, findAspaObject now takes the binary key.
+ *           * Removed trie specific functions (print_trie, print_search,
+ *             printAllLeafNode) and added printAllAspaObjects.
+ *           * Modified cbProcessEndOfData to process one path at a time.
  * 0.6.1.2 - 2021/11/18 - kyehwanl
  *           * Moved static declaration statement from .h into .c file 
  * 0.6.0.0  - 2021/02/26 - kyehwanl
@@ -40,49 +51,93 @@
 #include "util/mutex.h"
 #include "util/rwlock.h"
 
-// The number of children for each node
-// We will construct a N-ary tree and make it a Trie
-#define N 10
+/** The AFI value used for ASPA objects that are not bound to any AFI. Objects
+ * stored with this AFI are used for lookups of any AFI that does not have its
+ * own object for the same customer ASN. */
+#define ASPA_ANY_AFI        0
+/** The initial number of slots in the ASPA table (must be a power of 2). */
+#define ASPA_DB_INIT_SLOTS  1024
+/** Up to this number of providers a linear scan is faster than a binary 
+ * search. */
+#define ASPA_LINEAR_SEARCH  8
 
 typedef struct {
   uint32_t customerAsn; 
   uint16_t providerAsCount;
+  /** The provider ASNs in ascending order. */
   uint32_t *providerAsns;
   uint16_t afi;
 } ASPA_Object;
 
-
-typedef struct TrieNode TrieNode;
-struct TrieNode {
-    // The Trie Node Structure
-    // Each node has N children, starting from the root
-    // and a flag to check if it's a leaf node
-    char data; // Storing for printing purposes only
-    TrieNode* children[N];
-    int is_leaf;
-    void *userData;
-    ASPA_Object *aspaObjects;
-};
+/**
+ * A single slot of the ASPA table. A slot is empty if aspaObject is NULL.
+ */
+typedef struct {
+  /** The customer ASN this slot is keyed with. */
+  uint32_t     customerAsn;
+  /** The AFI this slot is keyed with. */
+  uint16_t     afi;
+  /** The stored object or NULL if the slot is empty. */
+  ASPA_Object* aspaObject;
+} ASPA_DBEntry;
 
 typedef struct {
-  TrieNode*         tableRoot;
+  /** The open addressed table, linear probing. */
+  ASPA_DBEntry*     table;
+  /** The number of slots in the table (power of 2). */
+  uint32_t          tableSize;
   uint32_t          countAspaObj;
   Configuration*    config;  // The system configuration
   RWLock            tableLock;
-  int (*cbProcessEndOfData)(void* uCache, void* rpkiHandler, 
-                            uint32_t uid, uint32_t pid, time_t ct);
+  /** Re-validates one path and passes the result on to the given updates. */
+  int (*cbProcessEndOfData)(void* uCache, void* rpkiHandler, uint32_t pid,
+                            SRxUpdateID* uids, uint32_t noUIDs);
 } ASPA_DBManager;
 
 
-TrieNode* insertAspaObj(ASPA_DBManager* self, char* word, char* userData, ASPA_Object* obj);
-void print_trie(TrieNode* root);
+/**
+ * Insert the given ASPA object into the database. An already existing object
+ * for the same customer ASN and AFI will be replaced and released.
+ * 
+ * @param self The ASPA database.
+ * @param word Not used anymore, the key is taken from the object. (Kept for
+ *             compatibility with the RTR handler)
+ * @param userData Not used anymore.
+ * @param obj The ASPA object to be stored.
+ * 
+ * @return The table entry the object is stored in or NULL. The entry is only
+ *         valid until the next modification of the database.
+ */
+ASPA_DBEntry* insertAspaObj(ASPA_DBManager* self, char* word, char* userData, 
+                            ASPA_Object* obj);
 bool initializeAspaDBManager(ASPA_DBManager* aspaDBManager, Configuration* config);
-ASPA_Object* findAspaObject(ASPA_DBManager* self, char* word);
-void print_search(TrieNode* root, char* word);
+void releaseAspaDBManager(ASPA_DBManager* self);
+/**
+ * Return the ASPA object stored for the given customer ASN and AFI.
+ * 
+ * @param self The ASPA database.
+ * @param customerAsn The customer ASN.
+ * @param afi The AFI of the object.
+ * 
+ * @return The ASPA object or NULL.
+ */
+ASPA_Object* findAspaObject(ASPA_DBManager* self, uint32_t customerAsn, 
+                            uint16_t afi);
 bool deleteASPAObject(ASPA_DBManager* self, ASPA_Object *obj);
 ASPA_Object* newASPAObject(uint32_t cusAsn, uint16_t pAsCount, uint32_t* provAsns, uint16_t afi);
 ASPA_ValidationResult ASPA_DB_lookup(ASPA_DBManager* self, uint32_t customerAsn, uint32_t providerAsn, uint8_t afi);
-TrieNode* printAllLeafNode(TrieNode *node);
+void printAllAspaObjects(ASPA_DBManager* self);
+/**
+ * Remove the ASPA object from the database. If obj is not NULL the stored
+ * object must match obj, otherwise all objects of the customer ASN given in 
+ * word are removed.
+ * 
+ * @param self The ASPA database.
+ * @param word The customer ASN as decimal string (only used if obj is NULL).
+ * @param obj The object to compare with or NULL.
+ * 
+ * @return true if at least one object was removed.
+ */
 bool delete_TrieNode_AspaObj (ASPA_DBManager* self, char* word, ASPA_Object* obj);
 
 
@@ -22,10 +22,16 @@
  *
  * This file contains the AS-Path Cache.
  *
- * Version 0.6.1.0
+ * Version 0.6.2.2
  * 
  * Changelog:
  * -----------------------------------------------------------------------------
+ * 0.6.2.2 - 2026/10/17
+ *           * Added reverse index ASN -> path ID and the dirty list to allow
+ *             incremental ASPA re-validation.
+ *           * emptyAspathCache now releases the entries.
+ *           * makePathId uses generatePathIdentifier with CRC32C over the
+ *             binary path instead of CRC32 over an allocated hex string.
  * 0.6.1.0 - 2021/08/27 - kyehwanl
  *           * Added additional error condition
  * 0.6.0.0 - 2021/03/31 - oborchert
@@ -35,8 +41,9 @@
  */
 #include <uthash.h>
 #include <stdbool.h>
+#include <string.h>
 #include "server/aspath_cache.h"
-#include "shared/crc32.h"
+#include "shared/srx_identifier.h"
 #include "util/log.h"
 
 #define HDR "([0x%08X] AspathCache): "
@@ -51,8 +58,25 @@ typedef struct {
   AS_REL_DIR        asRelDir;
   uint16_t          afi;
   time_t            lastModified;
+  bool              dirty;         // Queued for ASPA re-validation
 } PathListCacheTable;
 
+/** Initial number of path IDs per ASN index entry. */
+#define ASN_INDEX_INIT_SIZE  4
+/** Initial size of the dirty path list. */
+#define DIRTY_LIST_INIT_SIZE 256
+
+/**
+ * Entry of the reverse index. It lists all paths that contain the ASN. 
+ */
+typedef struct {
+  UT_hash_handle    hh;
+  uint32_t          asn;
+  uint32_t*         pathIds;
+  uint32_t          count;
+  uint32_t          size;
+} ASNPathIndex;
+
 
 //
 // To let main call this function to generate UT hash
@@ -69,6 +93,12 @@ bool createAspathCache(AspathCache* self, ASPA_DBManager* aspaDBManager)
   // element that will be added.
   self->aspathCacheTable = NULL;
   self->aspaDBManager = aspaDBManager;
+  self->asnIndex       = NULL;
+  self->dirtyPaths     = NULL;
+  self->noDirtyPaths   = 0;
+  self->sizeDirtyPaths = 0;
+  self->noAsnChanges   = 0;
+  memset(&self->stats, 0, sizeof(AspathRevalStats));
  
   return true;
 }
@@ -79,25 +109,176 @@ void releaseAspathCache(AspathCache* self)
 
   if (self != NULL)
   {
-    releaseRWLock(&self->tableLock);
     emptyAspathCache(self);
+    releaseRWLock(&self->tableLock);
   }
 
 }
 
 void emptyAspathCache(AspathCache* self)
 {
+  PathListCacheTable *currCacheTable, *tmpCacheTable;
+  ASNPathIndex       *currIndex, *tmpIndex;
+
   acquireWriteLock(&self->tableLock);
+  HASH_ITER(hh, (PathListCacheTable*)self->aspathCacheTable, currCacheTable, 
+            tmpCacheTable) 
+  {
+    HASH_DEL(*((PathListCacheTable**)&self->aspathCacheTable), currCacheTable);
+    if (currCacheTable->data.asPathList)
+    {
+      free(currCacheTable->data.asPathList);
+    }
+    free(currCacheTable);
+  }
+  HASH_ITER(hh, (ASNPathIndex*)self->asnIndex, currIndex, tmpIndex) 
+  {
+    HASH_DEL(*((ASNPathIndex**)&self->asnIndex), currIndex);
+    free(currIndex->pathIds);
+    free(currIndex);
+  }
   self->aspathCacheTable = NULL;
+  self->asnIndex         = NULL;
+  if (self->dirtyPaths)
+  {
+    free(self->dirtyPaths);
+  }
+  self->dirtyPaths     = NULL;
+  self->noDirtyPaths   = 0;
+  self->sizeDirtyPaths = 0;
   unlockWriteLock(&self->tableLock);
 
 }
 
+/**
+ * Add the path ID to the index entries of all ASNs of the path. Each ASN is
+ * indexed only once per path. The write lock must be held.
+ * 
+ * @param self The AS path cache
+ * @param cacheTable The path list entry
+ * 
+ * @since 0.6.2.2
+ */
+static void _indexAspathList(AspathCache *self, PathListCacheTable *cacheTable)
+{
+  ASNPathIndex* index = NULL;
+  uint32_t asn;
+  int idx, prev;
+  
+  if (cacheTable->data.asPathList == NULL)
+  {
+    return;
+  }
+  
+  for (idx = 0; idx < cacheTable->data.hops; idx++)
+  {
+    asn = cacheTable->data.asPathList[idx];
+    // Skip prepending and loops, the path is already listed
+    for (prev = 0; prev < idx; prev++)
+    {
+      if (cacheTable->data.asPathList[prev] == asn)
+      {
+        break;
+      }
+    }
+    if (prev != idx)
+    {
+      continue;
+    }
+    
+    HASH_FIND(hh, (ASNPathIndex*)self->asnIndex, &asn, sizeof(uint32_t), 
+              index);
+    if (index == NULL)
+    {
+      index = calloc(1, sizeof(ASNPathIndex));
+      if (index == NULL)
+      {
+        RAISE_SYS_ERROR("Could not allocate memory for the ASN path index!");
+        return;
+      }
+      index->asn = asn;
+      HASH_ADD(hh, *((ASNPathIndex**)&self->asnIndex), asn, sizeof(uint32_t), 
+               index);
+    }
+    if (index->count == index->size)
+    {
+      uint32_t  newSize = index->size ? index->size << 1 : ASN_INDEX_INIT_SIZE;
+      uint32_t* newList = realloc(index->pathIds, newSize * sizeof(uint32_t));
+      if (newList == NULL)
+      {
+        RAISE_SYS_ERROR("Could not extend the ASN path index!");
+        return;
+      }
+      index->pathIds = newList;
+      index->size    = newSize;
+    }
+    index->pathIds[index->count++] = cacheTable->pathId;
+  }
+}
+
+/**
+ * Remove the path ID from the index entries of all ASNs of the path. The write 
+ * lock must be held.
+ * 
+ * @param self The AS path cache
+ * @param cacheTable The path list entry
+ * 
+ * @since 0.6.2.2
+ */
+static void _unindexAspathList(AspathCache *self, 
+                               PathListCacheTable *cacheTable)
+{
+  ASNPathIndex* index = NULL;
+  uint32_t pos;
+  int idx;
+  
+  for (idx = 0; (cacheTable->data.asPathList != NULL) 
+                && (idx < cacheTable->data.hops); idx++)
+  {
+    HASH_FIND(hh, (ASNPathIndex*)self->asnIndex, 
+              &cacheTable->data.asPathList[idx], sizeof(uint32_t), index);
+    if (index == NULL)
+    {
+      // Already removed (prepended ASN)
+      continue;
+    }
+    for (pos = 0; pos < index->count; pos++)
+    {
+      if (index->pathIds[pos] == cacheTable->pathId)
+      {
+        // order does not matter
+        index->pathIds[pos] = index->pathIds[--index->count];
+        break;
+      }
+    }
+    if (index->count == 0)
+    {
+      HASH_DEL(*((ASNPathIndex**)&self->asnIndex), index);
+      free(index->pathIds);
+      free(index);
+    }
+  }
+  
+  if (cacheTable->dirty)
+  {
+    for (pos = 0; pos < self->noDirtyPaths; pos++)
+    {
+      if (self->dirtyPaths[pos] == cacheTable->pathId)
+      {
+        self->dirtyPaths[pos] = self->dirtyPaths[--self->noDirtyPaths];
+        break;
+      }
+    }
+    cacheTable->dirty = false;
+  }
+}
+
 static void add_AspathList (AspathCache *self, PathListCacheTable *cacheTable)
 {
 
   acquireWriteLock(&self->tableLock);
   HASH_ADD (hh, *((PathListCacheTable**)&self->aspathCacheTable), pathId, sizeof(uint32_t), cacheTable);
+  _indexAspathList(self, cacheTable);
   unlockWriteLock(&self->tableLock);
 
 }
@@ -115,10 +296,118 @@ static bool find_AspathList (AspathCache* self, uint32_t pathId, PathListCacheTa
 static void del_AspathList (AspathCache* self, PathListCacheTable *cacheTable)
 {
   acquireWriteLock(&self->tableLock);
+  _unindexAspathList(self, cacheTable);
   HASH_DEL (*((PathListCacheTable**)&self->aspathCacheTable), cacheTable);
   unlockWriteLock(&self->tableLock);
 }
 
+/**
+ * Mark all paths that contain the given customer ASN as dirty.
+ * 
+ * @param self The AS path cache.
+ * @param customerAsn The customer ASN of the ASPA object that changed.
+ * 
+ * @return The number of paths that were newly marked dirty.
+ * 
+ * @since 0.6.2.2
+ */
+uint32_t markAspathsDirty(AspathCache* self, uint32_t customerAsn)
+{
+  ASNPathIndex*       index   = NULL;
+  PathListCacheTable* plEntry = NULL;
+  uint32_t            marked  = 0;
+  uint32_t            pos;
+  
+  acquireWriteLock(&self->tableLock);
+  self->noAsnChanges++;
+  HASH_FIND(hh, (ASNPathIndex*)self->asnIndex, &customerAsn, sizeof(uint32_t),
+            index);
+  if (index != NULL)
+  {
+    for (pos = 0; pos < index->count; pos++)
+    {
+      HASH_FIND(hh, (PathListCacheTable*)self->aspathCacheTable, 
+                &index->pathIds[pos], sizeof(uint32_t), plEntry);
+      if (plEntry == NULL || plEntry->dirty)
+      {
+        continue;
+      }
+      if (self->noDirtyPaths == self->sizeDirtyPaths)
+      {
+        uint32_t  newSize = self->sizeDirtyPaths ? self->sizeDirtyPaths << 1
+                                                 : DIRTY_LIST_INIT_SIZE;
+        uint32_t* newList = realloc(self->dirtyPaths, 
+                                    newSize * sizeof(uint32_t));
+        if (newList == NULL)
+        {
+          RAISE_SYS_ERROR("Could not extend the dirty path list!");
+          break;
+        }
+        self->dirtyPaths     = newList;
+        self->sizeDirtyPaths = newSize;
+      }
+      plEntry->dirty = true;
+      self->dirtyPaths[self->noDirtyPaths++] = plEntry->pathId;
+      marked++;
+    }
+  }
+  unlockWriteLock(&self->tableLock);
+  
+  LOG(LEVEL_DEBUG, "ASPA change for customer AS %u marked %u path(s) dirty", 
+                   customerAsn, marked);
+  
+  return marked;
+}
+
+/**
+ * Remove all dirty paths from the cache and return them. This also starts a 
+ * new statistics period for the given serial.
+ * 
+ * @param self The AS path cache.
+ * @param serial The serial of the End-of-Data (host order).
+ * @param count OUT: The number of path IDs in the returned list.
+ * 
+ * @return The list of path IDs or NULL. The list MUST be freed by the caller.
+ * 
+ * @since 0.6.2.2
+ */
+uint32_t* takeDirtyAspaths(AspathCache* self, uint32_t serial, 
+                           uint32_t* count)
+{
+  PathListCacheTable* plEntry = NULL;
+  uint32_t*           list    = NULL;
+  uint32_t            pos;
+  
+  acquireWriteLock(&self->tableLock);
+  for (pos = 0; pos < self->noDirtyPaths; pos++)
+  {
+    HASH_FIND(hh, (PathListCacheTable*)self->aspathCacheTable, 
+              &self->dirtyPaths[pos], sizeof(uint32_t), plEntry);
+    if (plEntry != NULL)
+    {
+      plEntry->dirty = false;
+    }
+  }
+  list   = self->dirtyPaths;
+  *count = self->noDirtyPaths;
+  
+  self->stats.serials++;
+  self->stats.lastSerial         = serial;
+  self->stats.lastAsnChanges     = self->noAsnChanges;
+  self->stats.lastDirtyPaths     = self->noDirtyPaths;
+  self->stats.lastChangedPaths   = 0;
+  self->stats.lastChangedUpdates = 0;
+  self->stats.totalDirtyPaths   += self->noDirtyPaths;
+  
+  self->dirtyPaths     = NULL;
+  self->noDirtyPaths   = 0;
+  self->sizeDirtyPaths = 0;
+  self->noAsnChanges   = 0;
+  unlockWriteLock(&self->tableLock);
+  
+  return list;
+}
+
 
 AS_PATH_LIST* newAspathListEntry (uint32_t length, uint32_t* pathData, uint32_t pathId, AS_TYPE asType, 
                                   AS_REL_DIR asRelDir, uint16_t afi, bool bBigEndian)
@@ -297,6 +586,11 @@ bool deleteAspathCache(AspathCache* self, uint32_t pathId, AS_PATH_LIST* pathlis
   {
     LOG(LEVEL_INFO, FILE_LINE_INFO " Deleting PathList Cache Entry");
     del_AspathList(self, plCacheTable);
+    if (plCacheTable->data.asPathList)
+    {
+      free(plCacheTable->data.asPathList);
+    }
+    free(plCacheTable);
     bRet = true;
   }
   else
@@ -355,11 +649,19 @@ AS_PATH_LIST* getAspathListFromAspathCache (AspathCache* self, uint32_t pathId,
 }
 
 
+/**
+ * Generate the path ID of the given AS path.
+ *
+ * @param asPathLength The number of ASes in the path.
+ * @param asPathList The AS path.
+ * @param asType The type of the AS path.
+ * @param bBigEndian Indicates if the ASes of the path are in network order.
+ *
+ * @return the path ID or 0 if the path is NULL.
+ */
 uint32_t makePathId (uint8_t asPathLength, PATH_LIST* asPathList, AS_TYPE asType, bool bBigEndian)
 {
   uint32_t pathId=0;
-  char* strBuf = NULL;
-  int idx;
 
   if (!asPathList)
   {
@@ -367,30 +669,9 @@ uint32_t makePathId (uint8_t asPathLength, PATH_LIST* asPathList, AS_TYPE asType
     return 0;
   }
 
-  int strSize = asPathLength * 4 *2 + 1 + 1;  //  Path length * 4 byte, *2: hex string, 1: AS type, 1: NULL
-  strBuf = (char*)calloc(strSize, sizeof(char));
-  if (!strBuf)
-  {
-    LOG(LEVEL_ERROR, "memory allocation error");
-    return 0;
-  }
-
-  for (idx=0; idx < asPathLength; idx++)
-  {
-    if(bBigEndian)
-      sprintf(strBuf + (idx*4*2), "%08X", ntohl(asPathList[idx]));
-    else
-      sprintf(strBuf + (idx*4*2), "%08X", asPathList[idx]);
-  }
-  sprintf(strBuf+strSize-2, "%X", asType);
-
-  pathId = crc32((uint8_t*)strBuf, strSize);
-  LOG(LEVEL_INFO, "PathID: %08X strings: %s", pathId, strBuf);
-
-  if (strBuf)
-  {
-    free(strBuf);
-  }
+  pathId = generatePathIdentifier(asPathLength, asPathList, (uint8_t)asType,
+                                  bBigEndian);
+  LOG(LEVEL_DEBUG, "PathID: %08X", pathId);
 
   return pathId;
 }
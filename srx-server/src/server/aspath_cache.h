@@ -22,10 +22,14 @@
  *
  * AS-Path Cache.
  *
- * Version 0.6.0.0
+ * Version 0.6.2.2
  * 
  * Changelog:
  * -----------------------------------------------------------------------------
+ * 0.6.2.2  - 2026/10/17
+ *          - Added the reverse index ASN -> path IDs, the dirty path list and
+ *            the revalidation statistics used for incremental ASPA 
+ *            revalidation during End-of-Data.
  * 0.6.0.0  - 2021/02/26 - kyehwanl
  *          - Created source
  */
@@ -67,6 +71,29 @@ typedef struct {
 // TODO: 
 
 
+/**
+ * Statistics of the incremental ASPA revalidation. The "last" values describe
+ * the most recent End-of-Data (RTR serial), the "total" values are 
+ * accumulated over all End-of-Data.
+ */
+typedef struct {
+  /** Number of End-of-Data processed. */
+  uint32_t  serials;
+  /** The serial number of the last End-of-Data (host order). */
+  uint32_t  lastSerial;
+  /** Number of ASPA changes (customer ASNs) in the last serial. */
+  uint32_t  lastAsnChanges;
+  /** Number of paths touched (re-validated) in the last serial. */
+  uint32_t  lastDirtyPaths;
+  /** Number of paths that changed the validation result in the last serial. */
+  uint32_t  lastChangedPaths;
+  /** Number of updates that changed their result in the last serial. */
+  uint32_t  lastChangedUpdates;
+  uint64_t  totalDirtyPaths;
+  uint64_t  totalChangedPaths;
+  uint64_t  totalChangedUpdates;
+} AspathRevalStats;
+
 /**
  * A single Update Cache.
  */
@@ -76,6 +103,15 @@ typedef struct {
   void              *aspathCacheTable;
   RWLock            tableLock;
   ASPA_DBManager    *aspaDBManager;
+  /** Reverse index ASN -> path IDs of all paths that contain the ASN. */
+  void              *asnIndex;
+  /** Path IDs affected by ASPA changes since the last End-of-Data. */
+  uint32_t          *dirtyPaths;
+  uint32_t          noDirtyPaths;
+  uint32_t          sizeDirtyPaths;
+  /** ASPA changes (customer ASNs) since the last End-of-Data. */
+  uint32_t          noAsnChanges;
+  AspathRevalStats  stats;
 } AspathCache;
 
 
@@ -93,6 +129,36 @@ bool modifyAspaValidationResultToAspathCache(AspathCache *self, uint32_t pathId,
 
 bool deleteAspathListEntry (AS_PATH_LIST* aspl);
 void printAllAsPathCache(AspathCache *self);
+bool deleteAspathCache(AspathCache* self, uint32_t pathId, AS_PATH_LIST* pathlistEntry);
+
+/**
+ * Mark all paths that contain the given customer ASN as dirty. This is called
+ * for each ASPA change received from the validation cache. The paths will be
+ * re-validated during the next End-of-Data.
+ * 
+ * @param self The AS path cache.
+ * @param customerAsn The customer ASN of the ASPA object that changed.
+ * 
+ * @return The number of paths that were newly marked dirty.
+ * 
+ * @since 0.6.2.2
+ */
+uint32_t markAspathsDirty(AspathCache* self, uint32_t customerAsn);
+
+/**
+ * Remove all dirty paths from the cache and return them. This also starts a 
+ * new statistics period for the given serial.
+ * 
+ * @param self The AS path cache.
+ * @param serial The serial of the End-of-Data (host order).
+ * @param count OUT: The number of path IDs in the returned list.
+ * 
+ * @return The list of path IDs or NULL. The list MUST be freed by the caller.
+ * 
+ * @since 0.6.2.2
+ */
+uint32_t* takeDirtyAspaths(AspathCache* self, uint32_t serial, 
+                           uint32_t* count);
 
 
 
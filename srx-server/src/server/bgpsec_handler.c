@@ -21,10 +21,14 @@
  * by this software.
  *
  *
- * @version 0.6.2.1
+ * @version 0.6.2.2
  *
  * Changelog:
  * -----------------------------------------------------------------------------
+ * 0.6.2.2  - 2026/10/17
+ *            * Added validateSignatures which uses the batch validation of 
+ *              the SRx Crypto API.
+ *            * Moved the cleanup of the validation data into _freeHashMessages.
  * 0.6.2.1  - 2024/09/10 - oborchert
  *           * Changed data types from u_int... to uint... which follows C99
  * 0.5.0.0  - 2017/07/08 - oborchert
@@ -68,6 +72,32 @@ bool loadPrivateKey(BGPSecHandler* self, const char* filename)
   return true;
 }
 
+/**
+ * Free the hash messages the crypto API generated during validation.
+ *
+ * @param self The BGPsec Handler itself
+ * @param valdata The validation data
+ *
+ * @since 0.6.2.2
+ */
+static void _freeHashMessages(BGPSecHandler* self, 
+                              SCA_BGPSecValidationData* valdata)
+{
+  int idx = 0;
+
+  for (idx = 0; idx < SCA_MAX_SIGBLOCK_COUNT; idx++)
+  {
+    if (valdata->hashMessage[idx] != NULL)
+    {
+      if (!self->srxCAPI->freeHashMessage(valdata->hashMessage[idx]))
+      {
+        free(valdata->hashMessage[idx]);
+      }
+      valdata->hashMessage[idx] = NULL;
+    }
+  }
+}
+
 /**
  * Validates the given bgpsec update data.
  *
@@ -96,24 +126,52 @@ uint8_t validateSignature(BGPSecHandler* self, UC_UpdateData* update)
             : SRx_RESULT_INVALID;
 
   // Free possible generated hash data
-  if (valdata.hashMessage[0] != NULL)
+  _freeHashMessages(self, &valdata);
+
+  return retVal;
+}
+
+/**
+ * Validates the given bgpsec updates using one batch validation call of the
+ * SRx Crypto API.
+ *
+ * @param self The BGPsec Handler itself
+ * @param count The number of updates
+ * @param updates The updates to be validated
+ * @param results OUT: The result SRx_RESULT_VALID or SRx_RESULT_INVALID of 
+ *                each update.
+ *
+ * @since 0.6.2.2
+ */
+void validateSignatures(BGPSecHandler* self, int count, 
+                        UC_UpdateData** updates, uint8_t* results)
+{
+  SCA_BGPSecValidationData  valdata[count];
+  SCA_BGPSecValidationData* valPtr[count];
+  int idx = 0;
+
+  memset(valdata, 0, sizeof(valdata));
+  for (idx = 0; idx < count; idx++)
   {
-    if (!self->srxCAPI->freeHashMessage(valdata.hashMessage[0]))
-    {
-      free(valdata.hashMessage[0]);
-    }
-    valdata.hashMessage[0] = NULL;
+    valdata[idx].myAS             = updates[idx]->myAS;
+    valdata[idx].status           = API_STATUS_OK;
+    valdata[idx].bgpsec_path_attr = (uint8_t*)updates[idx]->bgpsec_path;
+    valdata[idx].nlri             = &updates[idx]->nlri;
+    valdata[idx].valResult        = API_VALRESULT_INVALID;
+    valPtr[idx] = &valdata[idx];
   }
-  if (valdata.hashMessage[1] != NULL)
+
+  /* call API's batch validation */
+  self->srxCAPI->validateBatch(count, valPtr);
+
+  for (idx = 0; idx < count; idx++)
   {
-    if (!self->srxCAPI->freeHashMessage(valdata.hashMessage[1]))
-    {
-      free(valdata.hashMessage[1]);
-    }
-    valdata.hashMessage[1] = NULL;
+    results[idx] = (valdata[idx].valResult == API_VALRESULT_VALID)
+                   ? SRx_RESULT_VALID
+                   : SRx_RESULT_INVALID;
+    // Free possible generated hash data
+    _freeHashMessages(self, &valdata[idx]);
   }
-
-  return retVal;
 }
 
 bool createSignature(BGPSecHandler* self)
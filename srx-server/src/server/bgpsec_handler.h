@@ -19,10 +19,12 @@
  * other licenses. Please refer to the licenses of all libraries required
  * by this software.
  *
- * @version 0.5.0.0
+ * @version 0.6.2.2
  *
  * Changelog:
  * -----------------------------------------------------------------------------
+ * 0.6.2.2  - 2026/10/17
+ *            * Added validateSignatures
  * 0.5.0.0  - 2017/07/07 - oborchert
  *            * Moved validation into this handler (renamed validateSignature 
  *              into validateUpdate)
@@ -91,6 +93,21 @@ bool loadPrivateKey(BGPSecHandler* self, const char* filename);
  */
 uint8_t validateSignature(BGPSecHandler* self, UC_UpdateData* update);
 
+/**
+ * Validates the given bgpsec updates using one batch validation call of the
+ * SRx Crypto API.
+ *
+ * @param self The BGPsec Handler itself
+ * @param count The number of updates
+ * @param updates The updates to be validated
+ * @param results OUT: The result SRx_RESULT_VALID or SRx_RESULT_INVALID of 
+ *                each update.
+ *
+ * @since 0.6.2.2
+ */
+void validateSignatures(BGPSecHandler* self, int count, 
+                        UC_UpdateData** updates, uint8_t* results);
+
 /**
  * Creates a signature for a given Byte-stream.
  *
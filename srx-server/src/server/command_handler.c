@@ -21,14 +21,23 @@
  * by this software.
  *
  * Methods in this file are called by the command handler. The command handler
- * runs in its own thread and gets fed using the command queue. The command
- * queue is fed by the srx-proxy communication thread.
+ * runs a pool of worker threads, each fed by its own shard of the command 
+ * queue. The command queue is fed by the srx-proxy communication thread.
  *
  *
- * @version 0.6.1.2
+ * @version 0.6.2.2
  *
  * Changelog:
  * -----------------------------------------------------------------------------
+ * 0.6.2.2 - 2026/10/17
+ *           * Start one worker thread per command queue shard. The number of
+ *             workers is configured using "command-workers".
+ *           * Client control commands are serialized using controlMutex.
+ *           * broadcastResult builds the notification on the stack and uses
+ *             the send queue unless it is disabled.
+ *           * Release the output buffer of the send queue before a proxy 
+ *             connection is closed.
+ *           * Negotiate the capabilities during the handshake.
  * 0.6.1.2 - 2021/11/10 - kyehwanl
  *           * Added a missing case of if-else clause to support the invalid case 
  *             which comes from the router.
@@ -119,9 +128,10 @@ bool initializeCommandHandler(CommandHandler* self, Configuration* cfg,
   self->queue = NULL;
 
   // 'start' has not been called
+  self->workers    = NULL;
   self->numThreads = 0;
 
-  return true; // Does not fail
+  return initMutex(&self->controlMutex);
 }
 
 /**
@@ -153,43 +163,49 @@ void releaseCommandHandler(CommandHandler* self)
     }
   }
 
+  releaseMutex(&self->controlMutex);
   LOG(LEVEL_DEBUG, HDR "Command Handler released!", pthread_self());
-  // Do nothing
 }
 
 bool startProcessingCommands(CommandHandler* self, CommandQueue* cmdQueue)
 {
   int idx;
+  int numWorkers = getNumberOfQueueShards(cmdQueue);
 
   self->queue = cmdQueue;
   LOG(LEVEL_DEBUG, HDR "Start Processing Commands...", pthread_self());
 
-  for (idx = 0; idx < NUM_COMMAND_HANDLER_THREADS; idx++)
+  self->workers = calloc(numWorkers, sizeof(CommandHandlerWorker));
+  if (self->workers == NULL)
+  {
+    RAISE_SYS_ERROR("Not enough memory for %d command handler workers",
+                    numWorkers);
+    return false;
+  }
+
+  for (idx = 0; idx < numWorkers; idx++)
   {
     LOG (LEVEL_DEBUG, HDR "Create command handler Thread No %u", pthread_self(),
                       idx);
-    if (pthread_create(&self->threads[idx], NULL, handleCommands, self) > 0)
+    self->workers[idx].cmdHandler = self;
+    self->workers[idx].shard      = idx;
+    if (pthread_create(&self->workers[idx].thread, NULL, handleCommands, 
+                       &self->workers[idx]) > 0)
     {
-      // Continue with less threads
-      if (idx > 0)
-      {
-        RAISE_ERROR("Failed to initiate a command handler thread "
-                    "- continuing with %d threads",
-                    self->numThreads);
-        break;
-
-        // No thread
-      }
-      else
-      {
-        RAISE_ERROR("Failed to initiate a command handler thread - stopping");
-        return false;
-      }
+      // Each shard requires its worker, otherwise the commands of the shard 
+      // would never be processed.
+      RAISE_ERROR("Failed to initiate command handler thread %d of %d "
+                  "- stopping", idx + 1, numWorkers);
+      stopProcessingCommands(self);
+      return false;
     }
 
     self->numThreads++;
   }
 
+  LOG(LEVEL_INFO, "Command handler started with %d worker(s)", 
+                  self->numThreads);
+
   return true;
 }
 
@@ -211,21 +227,21 @@ void stopProcessingCommands(CommandHandler* self)
     // First remove all pending commands
     removeAllCommands(self->queue);
 
-    // Send SHUTDOWN to terminate the thread
+    // Send SHUTDOWN to terminate the threads. The queue places the SHUTDOWN
+    // command into each shard.
     // TODO: Revisit this - It might cause errors during shutdown
-    for (idx = 0; idx < self->numThreads; idx++)
-    {
-      queueCommand(self->queue, COMMAND_TYPE_SHUTDOWN,
-                   NULL, NULL, 0, 0, NULL);
-    }
+    queueCommand(self->queue, COMMAND_TYPE_SHUTDOWN, NULL, NULL, 0, 0, NULL);
 
     // Wait until each thread terminated
     for (idx = 0; idx < self->numThreads; idx++)
     {
-      s = pthread_join(self->threads[idx], NULL);
+      s = pthread_join(self->workers[idx].thread, NULL);
       if (s != 0)
         handle_error_en(s, "pthread_join");
     }
+    self->numThreads = 0;
+    free(self->workers);
+    self->workers = NULL;
   }
 }
 
@@ -308,7 +324,13 @@ static bool _processHandshake(CommandHandler* cmdHandler,
 
       clientThread->proxyID  = proxyID;
       clientThread->routerID = clientID;
-      if (sendHelloResponse(item->serverSocket, item->client, proxyID))
+      // Only use capabilities both sides support.
+      clientThread->capabilities =   ntohl(hdr->capabilities) 
+                                   & SRX_PROXY_CAPABILITIES;
+      LOG (LEVEL_INFO, "Handshake: Use capabilities 0x%08X for proxy[0x%08X]",
+                       clientThread->capabilities, proxyID);
+      if (sendHelloResponse(item->serverSocket, item->client, proxyID,
+                            clientThread->capabilities))
       {
         clientThread->initialized = true;
         if (cmdHandler->sysConfig->syncAfterConnEstablished)
@@ -769,7 +791,6 @@ static bool _processUpdateValidation(CommandHandler* cmdHandler,
     // ----------------------------------------------------------------
     RPKIHandler* handler = (RPKIHandler*)cmdHandler->rpkiHandler;
     ASPA_DBManager* aspaDBManager = handler->aspaDBManager;
-    TrieNode *root = aspaDBManager->tableRoot;
 
 
     // -------------------------------------------------------------------
@@ -946,12 +967,13 @@ static void _processPeerChange(CommandHandler* cmdHandler,
  * can be added by receiving a white list entry, BGPSEC entry, as well as a
  * request or action received from the SRx proxy.
  *
- * @param arg The Command Handler
+ * @param arg The Command Handler Worker (CommandHandlerWorker*)
  *
  */
 static void* handleCommands(void* arg)
 {
-  CommandHandler* cmdHandler = (CommandHandler*)arg;
+  CommandHandlerWorker* worker = (CommandHandlerWorker*)arg;
+  CommandHandler* cmdHandler = (CommandHandler*)worker->cmdHandler;
   CommandQueueItem* item;
   bool keepGoing = true;
   uint8_t clientID = 0; // only used in process handshake and goodbye
@@ -966,7 +988,13 @@ static void* handleCommands(void* arg)
     // Block until the next command is available for this thread
     LOG(LEVEL_DEBUG, HDR "recvLock request ...%s", pthread_self(),__FUNCTION__);
 
-    item = fetchNextCommand(cmdHandler->queue);
+    item = fetchNextCommand(cmdHandler->queue, worker->shard);
+    if (item == NULL)
+    {
+      // The queue is not alive anymore.
+      LOG(LEVEL_DEBUG, HDR "Command queue terminated!", pthread_self());
+      break;
+    }
 
     switch (item->cmdType)
     {
@@ -993,17 +1021,20 @@ static void* handleCommands(void* arg)
           switch (bhdr->type)
           {
             case PDU_SRXPROXY_HELLO:
+              lockMutex(&cmdHandler->controlMutex);
               // The mapping information will be maintained during the handshake
               if (!_processHandshake(cmdHandler, item))
               {
                 RAISE_ERROR("Handshake between SRx and proxy failed. Shutdown "
                             "TCP connection!");
 
+                releaseClientSendBuffer(item->client);
                 closeClientConnection(&cmdHandler->svrConnHandler->svrSock,
                                       item->client);
 		            deleteFromSList(&cmdHandler->svrConnHandler->clients,
                                 item->client);
               }
+              unlockMutex(&cmdHandler->controlMutex);
               break;
             case PDU_SRXPROXY_VERIFY_V4_REQUEST:
             case PDU_SRXPROXY_VERIFY_V6_REQUEST:
@@ -1013,7 +1044,9 @@ static void* handleCommands(void* arg)
               _processUpdateSigning(cmdHandler, item);
               break;
             case PDU_SRXPROXY_GOODBYE:
+              lockMutex(&cmdHandler->controlMutex);
               gbhdr = (SRXPROXY_GOODBYE*)item->data;
+              releaseClientSendBuffer(item->client);
               closeClientConnection(&cmdHandler->svrConnHandler->svrSock,
                                     item->client);
               clientID = ((ClientThread*)item->client)->routerID;
@@ -1025,6 +1058,7 @@ static void* handleCommands(void* arg)
 
               deleteFromSList(&cmdHandler->svrConnHandler->clients,
                               item->client);
+              unlockMutex(&cmdHandler->controlMutex);
               LOG(LEVEL_DEBUG, HDR "GoodBye!", pthread_self());
               break;
             case PDU_SRXPROXY_DELTE_UPDATE:
@@ -1043,9 +1077,11 @@ static void* handleCommands(void* arg)
             default:
               RAISE_ERROR("Unknown/unsupported pdu type: %d",
                           item->dataID);
+              lockMutex(&cmdHandler->controlMutex);
               sendError(SRXERR_INVALID_PACKET, item->serverSocket,
                         item->client, false);
               sendGoodbye(item->serverSocket, item->client, false);
+              releaseClientSendBuffer(item->client);
               closeClientConnection(&cmdHandler->svrConnHandler->svrSock,
                                     item->client);
 
@@ -1059,6 +1095,7 @@ static void* handleCommands(void* arg)
 
               deleteFromSList(&cmdHandler->svrConnHandler->clients,
                               item->client);
+              unlockMutex(&cmdHandler->controlMutex);
           }
         }
         break;
@@ -1067,14 +1104,6 @@ static void* handleCommands(void* arg)
       // Still keep going.
     }
 
-    if (cmdHandler->queue->nextItemNode != NULL)
-    {
-      LOG(LEVEL_DEBUG, HDR "recv Unlock request ...%s", pthread_self(),
-                       __FUNCTION__);
-      //unlockMutex(&cmdHandler->queue->recvMutex);
-      //signalCond(&cmdHandler->queue->recvCond);
-    }
-
     // Now remove the item from command handler. it is processed.
     deleteCommand(cmdHandler->queue, item);
 
@@ -1099,7 +1128,8 @@ static void* handleCommands(void* arg)
  */
 bool broadcastResult(CommandHandler* self, SRxValidationResult* valResult)
 {
-  SRXPROXY_VERIFY_NOTIFICATION* pdu;
+  SRXPROXY_VERIFY_NOTIFICATION  notification;
+  SRXPROXY_VERIFY_NOTIFICATION* pdu = &notification;
   uint32_t pduLength = sizeof(SRXPROXY_VERIFY_NOTIFICATION);
   bool retVal = true;
   // Prepare the array of clients.
@@ -1123,7 +1153,7 @@ bool broadcastResult(CommandHandler* self, SRxValidationResult* valResult)
   // that have listeners / clients installed.
   if (clientCt > 0)
   {
-    pdu = malloc(pduLength);
+    // The PDU is copied into the send queue, no need to allocate it.
     memset(pdu,0,pduLength);
     pdu->type         = PDU_SRXPROXY_VERI_NOTIFICATION;
     pdu->resultType   = (valResult->valType & SRX_FLAG_ROA_BGPSEC_ASPA);
@@ -1151,13 +1181,13 @@ bool broadcastResult(CommandHandler* self, SRxValidationResult* valResult)
 #endif // USE_GRPC
         client = self->svrConnHandler->proxyMap[clients[clientCt]].socket;
 
-        retVal |= sendPacketToClient(&self->svrConnHandler->svrSock,
-                                     client , pdu, pduLength);
+        // Use the send queue to coalesce the notifications of each proxy.
+        retVal |= __sendPacketToClient(&self->svrConnHandler->svrSock,
+                                       client , pdu, pduLength,
+                                       !self->sysConfig->mode_no_sendqueue);
       }
       // If the mapping is inactive the proxy might be in reboot.
     }
-
-    free(pdu);
   }
 
   return retVal;
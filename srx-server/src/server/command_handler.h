@@ -20,10 +20,15 @@
  * other licenses. Please refer to the licenses of all libraries required 
  * by this software.
  * 
- * @version 0.6.0.0
+ * @version 0.6.2.2
  *
  * Changelog:
  * -----------------------------------------------------------------------------
+ * 0.6.2.2  - 2026/10/17
+ *            * Replaced the fixed thread array with a configurable pool of
+ *              workers, one per command queue shard.
+ *            * Added controlMutex, client control commands of different 
+ *              clients are not processed concurrently.
   * 0.6.0.0  - 2021/03/30 - oborchert
  *            * Added missing version control. Also moved modifications labeled 
  *              as version 0.5.2.0 to 0.6.0.0 (0.5.2.0 was skipped)
@@ -59,10 +64,19 @@
 #include "util/server_socket.h"
 
 /**
- * Number of parallel threads.
+ * A single command handler worker. Each worker processes the commands of one
+ * command queue shard.
+ *
+ * @since 0.6.2.2
  */
-#define NUM_COMMAND_HANDLER_THREADS 1
-// #define NUM_COMMAND_HANDLER_THREADS 2
+typedef struct {
+  /** The command handler (CommandHandler*) this worker belongs to. */
+  void*     cmdHandler;
+  /** The command queue shard this worker processes. */
+  int       shard;
+  /** The worker thread. */
+  pthread_t thread;
+} CommandHandlerWorker;
 
 /**
  * A single Command Handler.
@@ -82,8 +96,11 @@ typedef struct {
   CommandQueue*             queue;
 
   // Internal
-  pthread_t                 threads[NUM_COMMAND_HANDLER_THREADS];
+  CommandHandlerWorker*     workers;
   int                       numThreads;
+  // Serializes the client control commands (connect, disconnect) processed
+  // by the workers.
+  Mutex                     controlMutex;
 #ifdef USE_GRPC
   bool                      grpcEnable;
 #endif
@@ -116,7 +133,7 @@ void releaseCommandHandler(CommandHandler* self);
 /**
  * Handles all commands in the given queue.
  * 
- * @note Spawns a threads, i.e. is non-blocking
+ * @note Spawns one worker thread per queue shard, i.e. is non-blocking
  *
  * @param self Instance
  * @param cmdQueue An existing Command Queue
@@ -20,10 +20,22 @@
  * other licenses. Please refer to the licenses of all libraries required 
  * by this software.
  *
- * @version 0.3.0
+ * @version 0.6.2.2
  *
  * Changelog:
  * -----------------------------------------------------------------------------
+ * 0.6.2.2 - 2026/10/17
+ *           * Split the queue into one shard per command handler worker.
+ *           * Client control commands are fenced in the shards that hold
+ *             commands of the same client, later commands of the client wait
+ *             until the control command is processed.
+ *           * removeAllCommands only removes unconsumed commands, commands
+ *             in process are deleted by their worker.
+ *           * The shard queues are indexed, deleting a command does not walk
+ *             the queue anymore. Fixed the leaked queue items of deleted 
+ *             commands.
+ *           * Each shard counts the pending commands per client to find the
+ *             shards a control command has to be fenced in.
  *   0.3.0 - 2013/02/06 - oborchert
  *           * Added Version Control
  *           * Changed log level of output during shutdown
@@ -34,6 +46,8 @@
  * -----------------------------------------------------------------------------
  */
 
+#include <stdlib.h>
+#include <string.h>
 #include "server/command_queue.h"
 #include "shared/srx_defs.h"
 #include "shared/srx_packets.h"
@@ -42,75 +56,536 @@
 
 #define HDR "([0x%08X] Command Queue): "
 
+/** Maximum accepted data length - BZ197 */
+#define CMD_QUEUE_MAX_DATA_LENGTH 1000000
+
 /** 
  * Initializes and setup the command queue.
  *
  * @param self Variable that should be initialized
- * 
+ * @param numShards The number of shards (command handler workers), at least 1.
+ *
  * @return true if the queue could be initialized.
  */
-bool initializeCommandQueue(CommandQueue* self)
+bool initializeCommandQueue(CommandQueue* self, int numShards)
 {
+  int idx;
+
   if (self->alive)
   {
     RAISE_ERROR("This command queue is already alive!!");  
     return false;
   }
-  
-  // Create read and write Mutex
-  if (!initMutex(&self->cmdQueueMutex))
+
+  if (numShards < 1)
   {
+    numShards = 1;
+  }
+
+  self->shards = calloc(numShards, sizeof(CommandQueueShard));
+  if (self->shards == NULL)
+  {
+    RAISE_SYS_ERROR("Not enough memory to allocate %d command queue shards",
+                    numShards);
     return false;
   }
 
-  if(!initCond(&self->consumeCond))
+  if (!initMutex(&self->fenceMutex))
+  {
+    free(self->shards);
+    self->shards = NULL;
+    return false;
+  }
+  if (!initCond(&self->fenceCond))
   {
-    releaseMutex(&self->cmdQueueMutex);
-    pthread_cond_destroy(&self->consumeCond);
+    releaseMutex(&self->fenceMutex);
+    free(self->shards);
+    self->shards = NULL;
     return false;
   }
+  self->openFences    = NULL;
+  self->numOpenFences = 0;
+  
+  for (idx = 0; idx < numShards; idx++)
+  {
+    CommandQueueShard* shard = &self->shards[idx];
+    // Create read and write Mutex
+    if (!initMutex(&shard->shardMutex) || !initCond(&shard->consumeCond))
+    {
+      RAISE_ERROR("Could not initialize command queue shard %d", idx);
+      while (--idx >= 0)
+      {
+        releaseMutex(&self->shards[idx].shardMutex);
+        destroyCond(&self->shards[idx].consumeCond);
+      }
+      destroyCond(&self->fenceCond);
+      releaseMutex(&self->fenceMutex);
+      free(self->shards);
+      self->shards = NULL;
+      return false;
+    }
 
-  // An empty list
-  self->totalItems = 0;
-  self->unprocessedItems = 0;
-  initSList(&self->queue);
+    // An empty list
+    shard->totalItems       = 0;
+    shard->unprocessedItems = 0;
+    shard->fetchedItems     = 0;
+    shard->clientCounts     = NULL;
+    shard->numClients       = 0;
+    shard->maxClients       = 0;
+    initSList(&shard->queue);
+    indexSList(&shard->queue);
 
-  // No item is available, i.e. block fetch
-  self->nextItemNode = NULL;
+    // No item is available, i.e. block fetch
+    shard->nextItemNode = NULL;
+  }
 
+  self->numShards = numShards;
   self->alive = true;
   
   return true;
 }
 
+/**
+ * Release one reference of the given fence. The fence and the command data
+ * are freed once the last reference is released. The fence mutex MUST be held.
+ *
+ * @param fence The fence
+ *
+ * @since 0.6.2.2
+ */
+static void _releaseFence(CommandQueueFence* fence)
+{
+  if (--fence->refCount == 0)
+  {
+    if (fence->previous != NULL)
+    {
+      _releaseFence(fence->previous);
+    }
+    free(fence->data);
+    free(fence);
+  }
+}
+
+/**
+ * Remove the fence from the list of open fences. The list reference is NOT 
+ * released. The fence mutex MUST be held.
+ *
+ * @param self The command queue
+ * @param fence The fence
+ *
+ * @return true if the fence was in the list.
+ *
+ * @since 0.6.2.2
+ */
+static bool _unlinkOpenFence(CommandQueue* self, CommandQueueFence* fence)
+{
+  CommandQueueFence** link = &self->openFences;
+
+  while ((*link != NULL) && (*link != fence))
+  {
+    link = &(*link)->next;
+  }
+  if (*link == NULL)
+  {
+    return false;
+  }
+
+  *link = fence->next;
+  fence->next = NULL;
+  __atomic_store_n(&self->numOpenFences, self->numOpenFences - 1,
+                   __ATOMIC_RELAXED);
+  return true;
+}
+
+/**
+ * Mark the fence as done and release all workers waiting for it. The fence is
+ * removed from the list of open fences. The fence mutex MUST be held.
+ *
+ * @param self The command queue
+ * @param fence The fence that is processed or can not be processed anymore.
+ *
+ * @since 0.6.2.2
+ */
+static void _completeFence(CommandQueue* self, CommandQueueFence* fence)
+{
+  if (!fence->done)
+  {
+    fence->done = true;
+    broadcastCond(&self->fenceCond);
+  }
+  if (_unlinkOpenFence(self, fence))
+  {
+    _releaseFence(fence);
+  }
+}
+
+/**
+ * Return the open fence of the given client. The fence mutex MUST be held.
+ *
+ * @param self The command queue
+ * @param client The client
+ *
+ * @return The latest unprocessed fence of the client or NULL.
+ *
+ * @since 0.6.2.2
+ */
+static CommandQueueFence* _findOpenFence(CommandQueue* self,
+                                         ServerClient* client)
+{
+  CommandQueueFence* fence = self->openFences;
+
+  while ((fence != NULL) && (fence->client != client))
+  {
+    fence = fence->next;
+  }
+
+  return fence;
+}
+
 /** Used to destroy command queue. The queue is not usable after executing 
  * this command.
- * 
  * @param self The comnand queue to be released
  */
 void releaseCommandQueue(CommandQueue* self)
 {
-  if (self != NULL)
+  int idx;
+
+  if (self != NULL && self->shards != NULL)
   {
     LOG(LEVEL_DEBUG, HDR "Release Command Queue", pthread_self());    
-    lockMutex(&self->cmdQueueMutex);
+    lockMutex(&self->fenceMutex);
     LOG(LEVEL_DEBUG, HDR "Set alive = false", pthread_self());    
     self->alive = false;
+    broadcastCond(&self->fenceCond);
+    unlockMutex(&self->fenceMutex);
+
     LOG(LEVEL_DEBUG, HDR "Signal consumer (fetch thread)", pthread_self());        
-    signalCond(&self->consumeCond);    
-    
-    unlockMutex(&self->cmdQueueMutex);
+    for (idx = 0; idx < self->numShards; idx++)
+    {
+      lockMutex(&self->shards[idx].shardMutex);
+      signalCond(&self->shards[idx].consumeCond);
+      unlockMutex(&self->shards[idx].shardMutex);
+    }
     
     LOG(LEVEL_DEBUG, HDR "Now empty command queue", pthread_self());    
     removeAllCommands(self);
+
+    // Fences that were never processed.
+    lockMutex(&self->fenceMutex);
+    while (self->openFences != NULL)
+    {
+      _completeFence(self, self->openFences);
+    }
+    unlockMutex(&self->fenceMutex);
        
     LOG(LEVEL_DEBUG, HDR "Release internal list and Mutex", pthread_self());    
     // Release all items and the mutexes
-    releaseSList(&self->queue); 
-    releaseMutex(&self->cmdQueueMutex);
+    for (idx = 0; idx < self->numShards; idx++)
+    {
+      releaseSList(&self->shards[idx].queue);
+      releaseMutex(&self->shards[idx].shardMutex);
+      destroyCond(&self->shards[idx].consumeCond);
+      free(self->shards[idx].clientCounts);
+    }
+    destroyCond(&self->fenceCond);
+    releaseMutex(&self->fenceMutex);
+    free(self->shards);
+    self->shards    = NULL;
+    self->numShards = 0;
+  }
+}
+
+/**
+ * Determine if the given command is a client control command that must be
+ * kept in order with all commands of the same client.
+ *
+ * @param cmdType The command type
+ * @param data The command data (SRx proxy PDU)
+ *
+ * @return true if the command must be fenced.
+ *
+ * @since 0.6.2.2
+ */
+static bool _isFencedCommand(CommandQueueType cmdType, uint8_t* data)
+{
+  if ((cmdType != COMMAND_TYPE_SRX_PROXY) || (data == NULL))
+  {
+    return false;
+  }
+
+  switch (((SRXPROXY_BasicHeader*)data)->type)
+  {
+    case PDU_SRXPROXY_HELLO:
+    case PDU_SRXPROXY_GOODBYE:
+    case PDU_SRXPROXY_SYNC_REQUEST:
+      return true;
+    default:
+      break;
+  }
+
+  return false;
+}
+
+/**
+ * Return the command count of the given client within the shard. The shard 
+ * mutex MUST be held.
+ *
+ * @param shard The shard
+ * @param client The client
+ *
+ * @return The index of the count in clientCounts or -1 if the shard holds no
+ *         command of the client.
+ *
+ * @since 0.6.2.2
+ */
+static int _findClientCount(CommandQueueShard* shard, ServerClient* client)
+{
+  int idx;
+
+  for (idx = 0; idx < shard->numClients; idx++)
+  {
+    if (shard->clientCounts[idx].client == client)
+    {
+      return idx;
+    }
+  }
+
+  return -1;
+}
+
+/**
+ * Count one more command of the client in the shard. The shard mutex MUST be
+ * held.
+ *
+ * @param shard The shard
+ * @param client The client
+ *
+ * @return false if not enough memory is available.
+ *
+ * @since 0.6.2.2
+ */
+static bool _incClientCount(CommandQueueShard* shard, ServerClient* client)
+{
+  CommandQueueClientCount* counts;
+  int idx = _findClientCount(shard, client);
+
+  if (idx == -1)
+  {
+    if (shard->numClients == shard->maxClients)
+    {
+      counts = realloc(shard->clientCounts, (shard->maxClients + 8) 
+                                            * sizeof(CommandQueueClientCount));
+      if (counts == NULL)
+      {
+        RAISE_SYS_ERROR("Not enough memory to count the client commands");
+        return false;
+      }
+      shard->clientCounts = counts;
+      shard->maxClients  += 8;
+    }
+    idx = shard->numClients++;
+    shard->clientCounts[idx].client  = client;
+    shard->clientCounts[idx].pending = 0;
+  }
+  shard->clientCounts[idx].pending++;
+
+  return true;
+}
+
+/**
+ * Count one command of the client less in the shard. The shard mutex MUST be
+ * held.
+ *
+ * @param shard The shard
+ * @param client The client
+ *
+ * @since 0.6.2.2
+ */
+static void _decClientCount(CommandQueueShard* shard, ServerClient* client)
+{
+  int idx = _findClientCount(shard, client);
+
+  if ((idx != -1) && (--shard->clientCounts[idx].pending == 0))
+  {
+    shard->clientCounts[idx] = shard->clientCounts[--shard->numClients];
   }
 }
 
+/**
+ * Append a new item to the given shard. The shard mutex MUST be held.
+ *
+ * @param self The command queue
+ * @param shardIdx The shard to add the item to
+ * @param cmdType The type of the command.
+ * @param svrSock The server socket
+ * @param client The server client
+ * @param dataID The data ID
+ * @param dataLength The length of the data
+ * @param data The data, the item takes over the memory.
+ * @param fence The fence or NULL.
+ * @param waitFence The fence the item has to wait for or NULL. The item takes
+ *                  over the reference.
+ *
+ * @return true if the item could be added.
+ *
+ * @since 0.6.2.2
+ */
+static bool _appendCommand(CommandQueue* self, int shardIdx,
+                           CommandQueueType cmdType, ServerSocket* svrSock,
+                           ServerClient* client, uint32_t dataID,
+                           uint32_t dataLength, uint8_t* data,
+                           CommandQueueFence* fence,
+                           CommandQueueFence* waitFence)
+{
+  CommandQueueShard* shard = &self->shards[shardIdx];
+  CommandQueueItem*  newItem;
+
+  if (!_incClientCount(shard, client))
+  {
+    return false;
+  }
+  newItem = (CommandQueueItem*)appendToSList(&shard->queue,
+                                             sizeof(CommandQueueItem));
+  // Failed to add an item
+  if (newItem == NULL)
+  {
+    _decClientCount(shard, client);
+    return false;
+  }
+
+  // Set the item members
+  newItem->consumed     = false;
+  newItem->serverSocket = svrSock;
+  newItem->client       = client;
+  newItem->cmdType      = cmdType;
+  newItem->dataID       = dataID;
+  newItem->dataLength   = dataLength;
+  newItem->data         = data;
+  newItem->shard        = shardIdx;
+  newItem->fence        = fence;
+  newItem->waitFence    = waitFence;
+
+  // Set the new next node inside this mutex to make sure we -
+  // - get the new item
+  // - unlock only once
+  if (shard->nextItemNode == NULL)
+  {
+    shard->nextItemNode = getLastNodeOfSList(&shard->queue);
+  }
+
+  shard->totalItems++;
+  shard->unprocessedItems++;
+  
+  LOG(LEVEL_DEBUG, HDR "Signale new data to consume...%s", pthread_self(),
+                   __FUNCTION__);
+  signalCond(&shard->consumeCond);
+
+  return true;
+}
+
+/**
+ * Place the copies of a client control command into all shards that hold 
+ * commands of the same client, or into the shard selected by dataID if no 
+ * such shard exists.
+ *
+ * @param self The command queue
+ * @param cmdType The type of the command.
+ * @param svrSock The server socket
+ * @param client The server client
+ * @param dataID The data ID
+ * @param dataLength The length of the data
+ * @param data The data, the fence takes over the memory.
+ *
+ * @return true if the command could be added.
+ *
+ * @since 0.6.2.2
+ */
+static bool _queueFencedCommand(CommandQueue* self, CommandQueueType cmdType,
+                                ServerSocket* svrSock, ServerClient* client,
+                                uint32_t dataID, uint32_t dataLength,
+                                uint8_t* data)
+{
+  CommandQueueFence* fence = malloc(sizeof(CommandQueueFence));
+  CommandQueueShard* shard;
+  bool               retVal = true;
+  int                idx;
+
+  if (fence == NULL)
+  {
+    RAISE_SYS_ERROR("Not enough memory to fence the command");
+    free(data);
+    return false;
+  }
+  fence->client   = client;
+  fence->data     = data;
+  fence->copies   = 0;
+  fence->arrived  = 0;
+  fence->done     = false;
+  fence->next     = NULL;
+
+  // Holding the fence mutex keeps all fences in the same order within all
+  // shards and keeps workers from counting the copies before all are placed.
+  lockMutex(&self->fenceMutex);
+
+  // The previous fence of the client hands its list reference over.
+  fence->previous = _findOpenFence(self, client);
+  if (fence->previous != NULL)
+  {
+    _unlinkOpenFence(self, fence->previous);
+  }
+  fence->refCount   = 1;
+  fence->next       = self->openFences;
+  self->openFences  = fence;
+  __atomic_store_n(&self->numOpenFences, self->numOpenFences + 1,
+                   __ATOMIC_RELAXED);
+
+  for (idx = 0; idx < self->numShards; idx++)
+  {
+    shard = &self->shards[idx];
+    lockMutex(&shard->shardMutex);
+    if (_findClientCount(shard, client) != -1)
+    {
+      if (!_appendCommand(self, idx, cmdType, svrSock, client, dataID,
+                          dataLength, data, fence, NULL))
+      {
+        retVal = false;
+        unlockMutex(&shard->shardMutex);
+        break;
+      }
+      fence->copies++;
+      fence->refCount++;
+    }
+    unlockMutex(&shard->shardMutex);
+  }
+
+  if (retVal && (fence->copies == 0))
+  {
+    // No command of the client is queued, no other worker is involved.
+    idx   = dataID % self->numShards;
+    shard = &self->shards[idx];
+    lockMutex(&shard->shardMutex);
+    retVal = _appendCommand(self, idx, cmdType, svrSock, client, dataID,
+                            dataLength, data, fence, NULL);
+    unlockMutex(&shard->shardMutex);
+    if (retVal)
+    {
+      fence->copies++;
+      fence->refCount++;
+    }
+  }
+
+  if (!retVal)
+  {
+    // A missing copy would break the order - drop the command.
+    RAISE_ERROR("Could not place fenced command into shard %d!", idx);
+    _completeFence(self, fence);
+  }
+
+  unlockMutex(&self->fenceMutex);
+
+  return retVal;
+}
+
 /**
  * Add a given command into the command queue. THe type of command is stored in 
  * the parameter cmdType.
@@ -130,164 +605,267 @@ bool queueCommand(CommandQueue* self, CommandQueueType cmdType,
                   ServerSocket* svrSock, ServerClient* client, uint32_t dataID,
                   uint32_t dataLength, uint8_t* data)
 {
-  // This method is changed in such that the wait mutex is synchronized with
-  // the fetchCommand method. The waitmutex is locked and a notify is called 
-  // once a command is placed and the counter is incresed. The mutex is released
-  // afterwards.
+  CommandQueueShard* shard;
+  CommandQueueFence* waitFence = NULL;
+  uint8_t* dataCopy = NULL;
+  bool     retVal   = true;
+  int      idx;
   
   if (!self->alive)
   {
-    LOG(LEVEL_DEBUG, HDR, "Command Queue is not alive anymore, cannot queue "
-                          "command type (%u)!", pthread_self(), cmdType);
+    LOG(LEVEL_DEBUG, HDR "Command Queue is not alive anymore, cannot queue "
+                         "command type (%u)!", pthread_self(), cmdType);
     return false;
   }
   
   LOG(LEVEL_DEBUG, HDR "queueComamnd type (%u)", pthread_self(), cmdType);
-  CommandQueueItem* newItem;    
 
-  // Try to add a new item - make sure no one modifies the queue
-  lockMutex(&self->cmdQueueMutex);  
-  newItem = (CommandQueueItem*)appendToSList(&self->queue, 
-                                             sizeof(CommandQueueItem));
-  newItem->consumed = false;
-  
-  // Set the new next node inside this mutex to make sure we -
-  // - get the new item
-  // - unlock only once
-  if (self->nextItemNode == NULL)
+  // 'NULL' packet
+  if (data != NULL)
   {
-    self->nextItemNode = getLastNodeOfSList(&self->queue);
+    //TODO: BZ197 This might be revisited - Dirty BUG test
+    if (dataLength >= CMD_QUEUE_MAX_DATA_LENGTH)
+    {
+      // SEGV due to dataLength : 50529027 (0x03030303)
+      RAISE_SYS_ERROR("Given datalength too big due to transmission error "
+        "- Inform developers with reference code BZ197!");
+      return false;
+    }
+    // Try to copy the 'packet' into the command item
+    dataCopy = malloc(dataLength);
+    if (dataCopy == NULL)
+    {
+      RAISE_SYS_ERROR("Not enough memory to copy the data into the queue");
+      return false;
+    }
+    memcpy(dataCopy, data, dataLength);
   }
 
-  // Failed to add an item
-  if (newItem == NULL)
+  if (cmdType == COMMAND_TYPE_SHUTDOWN)
   {
-    unlockMutex(&self->cmdQueueMutex);
-    return false;
+    // Each worker has to receive its own shutdown.
+    for (idx = 0; idx < self->numShards; idx++)
+    {
+      lockMutex(&self->shards[idx].shardMutex);
+      retVal = _appendCommand(self, idx, cmdType, svrSock, client, dataID, 0,
+                              NULL, NULL, NULL) && retVal;
+      unlockMutex(&self->shards[idx].shardMutex);
+    }
+    free(dataCopy);
   }
-
-  // 'NULL' packet
-  if (data == NULL)
+  else if ((self->numShards > 1) && _isFencedCommand(cmdType, dataCopy))
   {
-    newItem->data = NULL;
-  } 
+    retVal = _queueFencedCommand(self, cmdType, svrSock, client, dataID,
+                                 dataLength, dataCopy);
+  }
   else
   {
-    // Try to copy the 'packet' into the command item
-    newItem->data = malloc(dataLength);
-    if (newItem->data == NULL)
+    // The commands of one client are queued by one thread, an open fence of
+    // the client can not be added concurrently.
+    if ((self->numShards > 1)
+        && (__atomic_load_n(&self->numOpenFences, __ATOMIC_RELAXED) > 0))
     {
-      RAISE_SYS_ERROR("Not enough memory to copy the data into the queue");
-      deleteFromSList(&self->queue, newItem);
-      
-      return false;
+      lockMutex(&self->fenceMutex);
+      waitFence = _findOpenFence(self, client);
+      if (waitFence != NULL)
+      {
+        waitFence->refCount++;
+      }
+      unlockMutex(&self->fenceMutex);
     }
-    //TODO: BZ197 This might be revisited - Dirty BUG test
-    if (dataLength < 1000000) // dirty bug test - increased by factor 10
+
+    // Sharding by update ID keeps all commands of one update in order.
+    idx   = dataID % self->numShards;
+    shard = &self->shards[idx];
+    lockMutex(&shard->shardMutex);
+    retVal = _appendCommand(self, idx, cmdType, svrSock, client, dataID, 
+                            dataLength, dataCopy, NULL, waitFence);
+    unlockMutex(&shard->shardMutex);
+    if (!retVal)
     {
-      memcpy(newItem->data, data, dataLength); 
-      // SEGV due to dataLength : 50529027 (0x03030303)
+      free(dataCopy);
+      if (waitFence != NULL)
+      {
+        lockMutex(&self->fenceMutex);
+        _releaseFence(waitFence);
+        unlockMutex(&self->fenceMutex);
+      }
     }
-    else
+  }
+
+  return retVal;
+}
+
+/**
+ * Remove the item from its shard and free it. The fence references of the
+ * item are released, the fence is NOT completed. The fence mutex MUST NOT be 
+ * held.
+ *
+ * @param self The command queue
+ * @param item The item
+ *
+ * @since 0.6.2.2
+ */
+static void _removeCommand(CommandQueue* self, CommandQueueItem* item)
+{
+  CommandQueueShard* shard = &self->shards[item->shard];
+
+  if ((item->fence != NULL) || (item->waitFence != NULL))
+  {
+    lockMutex(&self->fenceMutex);
+    if (item->fence != NULL)
     {
-      RAISE_SYS_ERROR("Given datalength too big due to transmission error "
-        "- Inform developers with reference code BZ197!");
-      deleteFromSList(&self->queue, newItem);
-      unlockMutex(&self->cmdQueueMutex);
-      return false;
+      // The data belongs to the fence.
+      item->data = NULL;
+      _releaseFence(item->fence);
     }
+    if (item->waitFence != NULL)
+    {
+      _releaseFence(item->waitFence);
+    }
+    unlockMutex(&self->fenceMutex);
   }
+  free(item->data);
 
-  // Set the other item members
-  newItem->serverSocket = svrSock;
-  newItem->client       = client;
-  newItem->cmdType      = cmdType;
-  newItem->dataID       = dataID;
-  newItem->dataLength   = dataLength;
-    
-  self->totalItems++;
-  self->unprocessedItems++;
-  
-  LOG(LEVEL_DEBUG, HDR "Signale new data to consume...%s", pthread_self(),
-                   __FUNCTION__);
-  signalCond(&self->consumeCond);
-  
-  LOG(LEVEL_DEBUG, HDR "UNLOCK readWriteLock...%s", pthread_self(),
-                   __FUNCTION__);
-  unlockMutex(&self->cmdQueueMutex);
-
-  return true;
+  lockMutex (&shard->shardMutex);
+  shard->totalItems--;
+  _decClientCount(shard, item->client);
+  // The item was allocated by the list, the delete only frees the node.
+  deleteFromSList(&shard->queue, item);
+  unlockMutex(&shard->shardMutex);
+  free(item);
 }
 
 /**
- * Retrieves the next command. This method DOES NOT clear the memory. 
- * After a command is processed the method 'deleteCommand' will remove it from 
- * the queue and free up all associated memory.
- * 
+ * Retrieves the next command of the given shard. This method DOES NOT clear 
+ * the memory. After a command is processed the method 'deleteCommand' will 
+ * remove it from the queue and free up all associated memory.
+ *
+ * In case the command has to wait for a control command of the same client, 
+ * this method blocks until the control command is processed. In case the 
+ * command is a copy of a fenced control command, only the worker that reaches
+ * the last copy receives the command, all others drop their copy and continue
+ * with their next command.
+ *
  * @param self The command queue
- * 
+ * @param shard The shard of the calling worker.
+ *
  * @return The command queue command.
- *  */
-CommandQueueItem* fetchNextCommand(CommandQueue* self)
+ */
+CommandQueueItem* fetchNextCommand(CommandQueue* self, int shardIdx)
 {
   // Changed the mutex management in this method. It will lock the wait mutex 
   // and wait unti la command is in the queue. once a command is read from the 
   // queue the wait mutesx will be unlocked and the command will be returned.
   // This method plays the loc/unlock mutex game with queuecommand
   
-  CommandQueueItem* item;
+  CommandQueueShard* shard;
+  CommandQueueItem*  item = NULL;
+  CommandQueueFence* fence;
+  bool               keepFetching = true;
   
   LOG(LEVEL_DEBUG, HDR "Fetch next command from command queue...", 
                    pthread_self());
 
-  if (!self->alive)
+  if (!self->alive || shardIdx < 0 || shardIdx >= self->numShards)
   {
     RAISE_ERROR ("Command queue is not alive anymore, fetching commands is not"
                  " possible!");
     return NULL;
   }
- 
-  LOG(LEVEL_DEBUG, HDR "Request access lock to cmd Queue", pthread_self());
-  lockMutex(&self->cmdQueueMutex);
+  shard = &self->shards[shardIdx];
 
-  // Wait until a new item is in the queue
-  while (self->alive && self->unprocessedItems == 0)
+  while (keepFetching)
   {
-    LOG(LEVEL_DEBUG, HDR "No command in queue, wait until command arrives.", 
-                     pthread_self());
-    // Will be woken up by queueCommand
-    waitCond(&self->consumeCond, &self->cmdQueueMutex, 0);
-    LOG(LEVEL_DEBUG, HDR "Received notification of command arrival.", 
-                     pthread_self());
-  }
+    LOG(LEVEL_DEBUG, HDR "Request access lock to cmd Queue", pthread_self());
+    lockMutex(&shard->shardMutex);
+
+    // Wait until a new item is in the queue
+    while (self->alive && shard->unprocessedItems == 0)
+    {
+      LOG(LEVEL_DEBUG, HDR "No command in queue, wait until command arrives.", 
+                       pthread_self());
+      // Will be woken up by queueCommand
+      waitCond(&shard->consumeCond, &shard->shardMutex, 0);
+      LOG(LEVEL_DEBUG, HDR "Received notification of command arrival.", 
+                       pthread_self());
+    }
   
-  if (!self->alive)
-  {
-    LOG(LEVEL_INFO, HDR "Command queue is terminated during fetching command, "
-                        "abort fetching!!!", pthread_self());
-    unlockMutex(&self->cmdQueueMutex);
-    return NULL;
-  }
+    if (!self->alive)
+    {
+      LOG(LEVEL_INFO, HDR "Command queue is terminated during fetching command,"
+                          " abort fetching!!!", pthread_self());
+      unlockMutex(&shard->shardMutex);
+      return NULL;
+    }
   
-  // Retrieve the item and set the fetcher to the next one.
-  item = (CommandQueueItem*)self->nextItemNode->data;
-  self->unprocessedItems--;				// SEE also ./util/slist.c:106    
-  if (item == NULL)
-  {
-    RAISE_ERROR("Fatal CommandQueue encountered an empty command.");
-  }
-  if (item->consumed)
-  {
-    RAISE_ERROR("Fetch an already consumed command!!");
-  }
-  // Indicate this item is consumed and can be deleted.
-  item->consumed = true;
+    // Retrieve the item and set the fetcher to the next one.
+    item = (CommandQueueItem*)shard->nextItemNode->data;
+    shard->unprocessedItems--;				// SEE also ./util/slist.c:106    
+    shard->fetchedItems++;
+    if (item == NULL)
+    {
+      RAISE_ERROR("Fatal CommandQueue encountered an empty command.");
+    }
+    else if (item->consumed)
+    {
+      RAISE_ERROR("Fetch an already consumed command!!");
+    }
+    else
+    {
+      // Indicate this item is consumed and can be deleted.
+      item->consumed = true;
+    }
   
-  //move to next item.
-  self->nextItemNode = getNextNodeOfSListNode(self->nextItemNode);
-  // TODO: Check what happens to the memory allocated to store the command!!!
-  // Unlock the write mutex
-  unlockMutex(&self->cmdQueueMutex);  
+    //move to next item.
+    shard->nextItemNode = getNextNodeOfSListNode(shard->nextItemNode);
+    // Unlock the write mutex
+    unlockMutex(&shard->shardMutex);  
+
+    keepFetching = false;
+    if ((item != NULL) && (item->waitFence != NULL))
+    {
+      // A control command of the same client was queued before.
+      lockMutex(&self->fenceMutex);
+      while (self->alive && !item->waitFence->done)
+      {
+        waitCond(&self->fenceCond, &self->fenceMutex, 0);
+      }
+      _releaseFence(item->waitFence);
+      item->waitFence = NULL;
+      unlockMutex(&self->fenceMutex);
+    }
+    else if ((item != NULL) && (item->fence != NULL))
+    {
+      fence = item->fence;
+      lockMutex(&self->fenceMutex);
+      if (!fence->done && (++fence->arrived == fence->copies))
+      {
+        // Last one to arrive, all previous commands of the client are 
+        // processed. A previous control command is processed by the worker
+        // that reached its last copy.
+        while (self->alive && (fence->previous != NULL) 
+               && !fence->previous->done)
+        {
+          waitCond(&self->fenceCond, &self->fenceMutex, 0);
+        }
+        if (fence->previous != NULL)
+        {
+          _releaseFence(fence->previous);
+          fence->previous = NULL;
+        }
+        unlockMutex(&self->fenceMutex);
+      }
+      else
+      {
+        unlockMutex(&self->fenceMutex);
+        // The command is processed by another worker, drop this copy.
+        _removeCommand(self, item);
+        item = NULL;
+        keepFetching = self->alive;
+      }
+    }
+  }
 
   return item;
 }
@@ -295,84 +873,157 @@ CommandQueueItem* fetchNextCommand(CommandQueue* self)
 /**
  * Remove the queue element that is already consumed from the list and frees 
  * up all allocated memory associated with this element.
- * 
+ *
  * @param self The command queue
  * @param item The item. It also will be freed!
  */
 void deleteCommand(CommandQueue* self, CommandQueueItem* item)
 {
   LOG(LEVEL_DEBUG, HDR "Delete the given command queue item.", pthread_self());
-  lockMutex (&self->cmdQueueMutex);
-  // Free The packet data within the item
-  if(item != NULL) 
+  if (item == NULL)
+  {
+    return;
+  }
+
+  if (item->fence != NULL)
   {
-    free(item->data);
+    // Processed - release all waiting commands of the client.
+    lockMutex(&self->fenceMutex);
+    _completeFence(self, item->fence);
+    unlockMutex(&self->fenceMutex);
   }
-  self->totalItems--;
-  // The delete from list also frees the item.
-  deleteFromSList(&self->queue, item);
-  unlockMutex(&self->cmdQueueMutex);
+  _removeCommand(self, item);
 }
 
 /**
- * Clears the complete queue.
- * 
+ * Clears the complete queue. Only unprocessed commands are removed, commands 
+ * currently in process are removed by their worker using deleteCommand.
+ *
  * @param self The command queue.
  */
 void removeAllCommands(CommandQueue* self)
 {
   LOG(LEVEL_DEBUG, HDR "Remove all commands from the command queue.",
                    pthread_self());
-  SListNode* currNode;
-
-  // No adding or single removing allowed
-  lockMutex(&self->cmdQueueMutex);
+  CommandQueueShard* shard;
+  CommandQueueItem*  item;
+  int idx;
 
-  // Release all packets stored in the items
-  FOREACH_SLIST(&self->queue, currNode)
+  // Keep fences from being added or released while removing.
+  lockMutex(&self->fenceMutex);
+  for (idx = 0; idx < self->numShards; idx++)
   {
-    void* p = ((CommandQueueItem*)getDataOfSListNode(currNode))->data;
-    if (p)
+    shard = &self->shards[idx];
+    // No adding or single removing allowed
+    lockMutex(&shard->shardMutex);
+
+    while (shard->nextItemNode != NULL)
     {
-      free(p);
+      item = (CommandQueueItem*)getDataOfSListNode(shard->nextItemNode);
+      shard->nextItemNode = getNextNodeOfSListNode(shard->nextItemNode);
+      if (item->fence != NULL)
+      {
+        // The fence can not be completed anymore, release waiting workers
+        _completeFence(self, item->fence);
+        _releaseFence(item->fence);
+      }
+      else if (item->data != NULL)
+      {
+        free(item->data);
+      }
+      if (item->waitFence != NULL)
+      {
+        _releaseFence(item->waitFence);
+      }
+      _decClientCount(shard, item->client);
+      deleteFromSList(&shard->queue, item);
+      free(item);
     }
-  }
-  // Now delete the items.
-  emptySList(&self->queue);
-
-  if (self->nextItemNode != NULL)
-  {
-    RAISE_SYS_ERROR("Queue[0x%08X] Removing of all commands without success!", 
-                    self);
-  };
   
-  self->totalItems       = self->queue.size;
-  self->unprocessedItems = self->nextItemNode == NULL ? 0 : self->totalItems;
+    shard->totalItems       = shard->queue.size;
+    shard->unprocessedItems = 0;
   
-  // Grant write access again
-  unlockMutex(&self->cmdQueueMutex); 
+    // Grant write access again
+    unlockMutex(&shard->shardMutex);
+  }
+  unlockMutex(&self->fenceMutex);
 }
 
 /**
  * Return the maximum number of commands in the queue
- * 
+ *
  * @param self The command queue
- * 
+ *
  * @return the maximum number of items in the queue.
  */
-inline int getTotalQueueSize(CommandQueue* self)
+int getTotalQueueSize(CommandQueue* self)
 {
-  return self->totalItems;
+  int total = 0;
+  int idx;
+
+  for (idx = 0; idx < self->numShards; idx++)
+  {
+    total += self->shards[idx].totalItems;
+  }
+  return total;
 }
 
 /**
  * Return the number of unprocessed commands in the queue
- * 
+ *
  * @param self The command queue
- * 
+ *
  * @return the number of unprocessed items in the queue.
  */
-inline int getUnprocessedQueueSize(CommandQueue* self)
+int getUnprocessedQueueSize(CommandQueue* self)
+{
+  int unprocessed = 0;
+  int idx;
+
+  for (idx = 0; idx < self->numShards; idx++)
+  {
+    unprocessed += self->shards[idx].unprocessedItems;
+  }
+  return unprocessed;
+}
+
+/**
+ * Return the number of shards of the queue.
+ *
+ * @param self The command queue
+ *
+ * @return the number of shards.
+ *
+ * @since 0.6.2.2
+ */
+int getNumberOfQueueShards(CommandQueue* self)
+{
+  return self->numShards;
+}
+
+/**
+ * Retrieve the statistics of the given shard. The values are for display only
+ * and are read without synchronization.
+ *
+ * @param self The command queue
+ * @param shard The shard index
+ * @param total Returns the number of items in the shard
+ * @param unprocessed Returns the number of unprocessed items in the shard
+ * @param fetched Returns the number of items fetched from the shard so far
+ *
+ * @return false if the shard does not exist.
+ *
+ * @since 0.6.2.2
+ */
+bool getQueueShardStatistics(CommandQueue* self, int shard, int* total,
+                             int* unprocessed, uint32_t* fetched)
 {
-  return self->unprocessedItems;
+  if ((shard < 0) || (shard >= self->numShards))
+  {
+    return false;
+  }
+  *total       = self->shards[shard].totalItems;
+  *unprocessed = self->shards[shard].unprocessedItems;
+  *fetched     = self->shards[shard].fetchedItems;
+  return true;
 }
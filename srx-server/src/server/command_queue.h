@@ -20,10 +20,16 @@
  * other licenses. Please refer to the licenses of all libraries required 
  * by this software.
  *
- * @version 0.5.0.6
+ * @version 0.6.2.2
  *
  * Changelog:
  * -----------------------------------------------------------------------------
+ *   0.6.2.2 - 2026/10/17
+ *             * Split the queue into shards, one per command handler worker.
+ *               Commands are sharded by update ID, client control commands
+ *               (HELLO, GOODBYE, SYNC) are fenced in the shards that hold
+ *               commands of the same client.
+ *             * Added getNumberOfQueueShards and getQueueShardStatistics.
  *   0.5.0.6 - 2018/11/20 - oborchert
  *             * Removed "inline" keyword from functions - caused linker error 
  *               on Ubuntu 18
@@ -51,6 +57,30 @@ typedef enum {
   COMMAND_TYPE_SRX_PROXY = 0,
   COMMAND_TYPE_SHUTDOWN  = 1
 } CommandQueueType;
+/**
+ * Shared state of a client control command (HELLO, GOODBYE, SYNC). A copy of
+ * the command is placed into each shard that holds commands of the same
+ * client. The worker that reaches its copy last processes the command, all
+ * other copies are dropped without waiting. Commands of the client that are
+ * queued after the control command wait until it is processed. This keeps the
+ * control command in order with all commands of the same client, regardless
+ * of which shard they were placed in, without stalling other clients.
+ *
+ * @since 0.6.2.2
+ */
+typedef struct _CommandQueueFence {
+  ServerClient*    client;       // The client that sent the command
+  uint8_t*         data;         // The command, shared by all copies
+  int              copies;       // Number of copies placed into the shards
+  int              arrived;      // Number of workers that reached their copy
+  int              refCount;     // Copies, waiting commands and the open list
+  bool             done;         // The command is processed or was dropped
+  // The open fence of the same client queued before this one or NULL.
+  struct _CommandQueueFence* previous;
+  // The next fence in the list of open fences.
+  struct _CommandQueueFence* next;
+} CommandQueueFence;
+
 /** 
  * A Command Queue Item.
  */
@@ -63,23 +93,59 @@ typedef struct {
   bool             consumed;     // Indicated if this element is already fetched
   uint32_t         dataLength;   // Length in Bytes of \c packet
   uint8_t*         data;         // The actual packet (= data)
+  int              shard;        // The shard this item is stored in.
+  CommandQueueFence* fence;      // Only set for client control commands
+  CommandQueueFence* waitFence;  // Control command of the same client that
+                                 // must be processed first or NULL
 } CommandQueueItem;
 
 /**
- * A single Command Queue.
+ * The number of commands of one client within a shard.
+ *
+ * @since 0.6.2.2
+ */
+typedef struct {
+  ServerClient* client;         // The client
+  int           pending;        // Unprocessed and in process commands
+} CommandQueueClientCount;
+
+/**
+ * One shard of the command queue. Each shard is consumed by exactly one
+ * command handler worker.
+ *
+ * @since 0.6.2.2
  */
 typedef struct {
   SList       queue;          // The list that actually represents the queue.
   SListNode*  nextItemNode;   // The next node containing a CommandQueueItem to be 
                               // fetched.
-  Mutex       cmdQueueMutex; // Used to safely access the queue in read and
+  Mutex       shardMutex;     // Used to safely access the shard in read and
                               // write
   Cond        consumeCond;    // The condition for consuming elements from the 
-                              // command queue
+                              // shard
 
-  int         totalItems;     // Total number of Items in the queue, unprocessed 
+  int         totalItems;     // Total number of Items in the shard, unprocessed 
                               // and processed.
   int         unprocessedItems; // THe number of unprocessed Items.
+  uint32_t    fetchedItems;   // Number of items handed to the worker so far.
+  // The clients with commands in the shard, used to place fenced commands.
+  CommandQueueClientCount* clientCounts;
+  int         numClients;     // The number of clients in clientCounts
+  int         maxClients;     // The capacity of clientCounts
+} CommandQueueShard;
+
+/**
+ * A single Command Queue.
+ */
+typedef struct {
+  CommandQueueShard* shards;  // The shards, one per command handler worker.
+  int         numShards;      // The number of shards.
+  Mutex       fenceMutex;     // Keeps the fences in the same order in all 
+                              // shards and guards the fence state.
+  Cond        fenceCond;      // Signaled each time a fence is done.
+  CommandQueueFence* openFences; // The latest unprocessed fence of each 
+                              // client.
+  int         numOpenFences;  // Number of fences in openFences.
   bool        alive;          // used to stop fetching commands
 } CommandQueue;
 
@@ -87,10 +153,11 @@ typedef struct {
  * Initializes and setup the command queue.
  *
  * @param self Variable that should be initialized.
+ * @param numShards The number of shards (command handler workers), at least 1.
  * 
  * @return true if the queue could be initialized.
  */
-bool initializeCommandQueue(CommandQueue* self);
+bool initializeCommandQueue(CommandQueue* self, int numShards);
 
 /**
  * Frees the whole queue.
@@ -112,6 +179,11 @@ void releaseCommandQueue(CommandQueue* self);
  * @param dataLength The length of the data attached to this command queue.
  * @param data The data package attached.
  *
+ * @note Commands are placed into the shard selected by dataID. Client control
+ *       commands are fenced in all shards that hold commands of the same
+ *       client and a SHUTDOWN command is placed into every shard. Commands of
+ *       one client must be queued by one thread at a time.
+ *
  * @return true if the command could be added to the queue.
  */
 bool queueCommand(CommandQueue* self, CommandQueueType cmdType,
@@ -125,9 +197,11 @@ bool queueCommand(CommandQueue* self, CommandQueueType cmdType,
  * @note Blocks until a command is available!
  *
  * @param self Queue instance
- * @return The next item
+ * @param shard The shard of the calling worker.
+ *
+ * @return The next item or NULL if the queue is not alive anymore.
  */
-CommandQueueItem* fetchNextCommand(CommandQueue* self);
+CommandQueueItem* fetchNextCommand(CommandQueue* self, int shard);
 
 /**
  * Removes a command from the queue.
@@ -161,5 +235,33 @@ int getTotalQueueSize(CommandQueue* self);
  * @return the number of unprocessed items in the queue.
  */
 int getUnprocessedQueueSize(CommandQueue* self);
+
+/**
+ * Return the number of shards of the queue.
+ *
+ * @param self The command queue
+ *
+ * @return the number of shards.
+ *
+ * @since 0.6.2.2
+ */
+int getNumberOfQueueShards(CommandQueue* self);
+
+/**
+ * Retrieve the statistics of the given shard. The values are for display only
+ * and are read without synchronization.
+ *
+ * @param self The command queue
+ * @param shard The shard index
+ * @param total Returns the number of items in the shard
+ * @param unprocessed Returns the number of unprocessed items in the shard
+ * @param fetched Returns the number of items fetched from the shard so far
+ *
+ * @return false if the shard does not exist.
+ *
+ * @since 0.6.2.2
+ */
+bool getQueueShardStatistics(CommandQueue* self, int shard, int* total,
+                             int* unprocessed, uint32_t* fetched);
 #endif // !__COMMAND_QUEUE_H__
 
@@ -20,10 +20,14 @@
  * other licenses. Please refer to the licenses of all libraries required
  * by this software.
  *
- * @version 0.6.2.1
+ * @version 0.6.2.2
  *
  * Changelog:
  * -----------------------------------------------------------------------------
+ * 0.6.2.2 - 2026/10/17
+ *           * Added "command-workers" to configuration file and command line.
+ *           * Added "server-reactors" to configuration file and command line.
+ *           * Added "async-log" to configuration file and command line.
  * 0.6.2.1 - 2024/08/24 - oborchert
  *           * Fixed segmentation fault in _duplicateString
  * 0.6.0.0 - 2021/02/16 - oborchert
@@ -119,6 +123,10 @@
 #define CFG_PARAM_MODE_NO_SEND_QUEUE 10
 #define CFG_PARAM_MODE_NO_RCV_QUEUE  11
 
+#define CFG_PARAM_COMMAND_WORKERS 12
+#define CFG_PARAM_SERVER_REACTORS 13
+#define CFG_PARAM_ASYNC_LOG 14
+
 #define HDR "([0x%08X] Configuration): "
 
 #ifndef SYSCONFDIR
@@ -152,9 +160,12 @@ static const struct option _LONG_OPTIONS[] = {
   { "log",          required_argument, NULL, 'l'},
 
   { "syslog",       no_argument, NULL, CFG_PARAM_SYSLOG},
+  { "async-log",    required_argument, NULL, CFG_PARAM_ASYNC_LOG},
 
   { "proxy-clients", required_argument, NULL, 'C'},
   { "keep-window", required_argument, NULL, 'k'},
+  { "command-workers", required_argument, NULL, CFG_PARAM_COMMAND_WORKERS},
+  { "server-reactors", required_argument, NULL, CFG_PARAM_SERVER_REACTORS},
 
   { "port",             required_argument, NULL, 'p'},
   { "console.port",     required_argument, NULL, 'c'},
@@ -188,11 +199,18 @@ static const char* _USAGE_TEXT =
   "                               (6)=INFO, (7)=DEBUG\n"
   "  -l, --log <file>             Write all messages to a file\n"
   "      --syslog                 Send all messages to syslog\n"
+  "      --async-log <0|1>        Write the messages from a background\n"
+  "                               thread (def.: 1)\n"
   "  -C  --proxy-clients          Minimum expected number of proxy clients\n"
   "  -s  --sync                   Send synchronization request each time a\n"
   "                               proxy connection is established!\n"
   "  -k  --keep-window <sec>      The default keepWindow in seconds. Zero\n"
   "                               deactivates this feature\n"
+  "      --command-workers <no>   Number of command handler workers. Zero\n"
+  "                               starts one worker per online CPU\n"
+  "      --server-reactors <no>   Number of threads serving all proxy\n"
+  "                               connections. Zero starts one thread per\n"
+  "                               proxy connection (def.: 1)\n"
   "  -p, --port <no>              Use a different listening port (def.: 17900)\n"
   "  -c, --console.port <no>      Use a different console port (def.: 17901)\n"
   "  -P, --console.password <pwd> Password for remote shutdown\n"
@@ -235,6 +253,7 @@ void initConfiguration(Configuration* self)
   self->syncAfterConnEstablished = false;
   self->msgDest = MSG_DEST_STDERR;
   self->msgDestFilename = NULL;
+  self->asyncLog = true;
 
   self->server_port      = SRX_DEF_PORT;
   self->console_port     = SRX_DEF_CONSOLE_PORT;
@@ -257,6 +276,8 @@ void initConfiguration(Configuration* self)
   self->grpc_port = DEFAULT_GRPC_PORT;
 #endif
   self->defaultKeepWindow = SRX_DEFAULT_KEEP_WINDOW; // from srx_defs.h
+  self->commandWorkers    = SRX_DEF_COMMAND_WORKERS;
+  self->serverReactors    = SRX_DEF_SERVER_REACTORS;
   memset(&self->mapping_routerID, 0, MAX_PROXY_MAPPINGS);
 }
 
@@ -397,6 +418,9 @@ int parseProgramArgs(Configuration* self, int argc, const char** argv,
         case CFG_PARAM_CREDITS:
         case CFG_PARAM_MODE_NO_SEND_QUEUE:
         case CFG_PARAM_MODE_NO_RCV_QUEUE:
+        case CFG_PARAM_COMMAND_WORKERS:
+        case CFG_PARAM_SERVER_REACTORS:
+        case CFG_PARAM_ASYNC_LOG:
           optc = -1;
           break;
         default:
@@ -438,6 +462,12 @@ int parseProgramArgs(Configuration* self, int argc, const char** argv,
         self->defaultKeepWindow = (uint16_t)strtol(optarg, NULL,
                                                    SRX_DEFAULT_KEEP_WINDOW);
         break;
+      case CFG_PARAM_COMMAND_WORKERS :
+        self->commandWorkers = (int)strtol(optarg, NULL, 10);
+        break;
+      case CFG_PARAM_SERVER_REACTORS :
+        self->serverReactors = (int)strtol(optarg, NULL, 10);
+        break;
       case 'l':
         self->msgDest = MSG_DEST_FILENAME;
         if (optarg == NULL)
@@ -469,6 +499,9 @@ int parseProgramArgs(Configuration* self, int argc, const char** argv,
       case CFG_PARAM_SYSLOG:
         self->msgDest = MSG_DEST_SYSLOG;
         break;
+      case CFG_PARAM_ASYNC_LOG:
+        self->asyncLog = strtol(optarg, NULL, 10) != 0;
+        break;
       case 'p':
         if (optarg == NULL)
         {
@@ -649,11 +682,20 @@ bool readConfigFile(Configuration* self, const char* filename)
 
   if ( config_lookup_int(&cfg, "keep-window", &intVal) == CONFIG_TRUE )
   { self->defaultKeepWindow = (int)intVal; }
+
+  if ( config_lookup_int(&cfg, "command-workers", &intVal) == CONFIG_TRUE )
+  { self->commandWorkers = (int)intVal; }
+
+  if ( config_lookup_int(&cfg, "server-reactors", &intVal) == CONFIG_TRUE )
+  { self->serverReactors = (int)intVal; }
   
   // Global - message destination
   if ( config_lookup_bool(&cfg, "syslog", (int*)&boolVal) == CONFIG_TRUE )
   { useSyslog = (bool)boolVal; }
 
+  if ( config_lookup_bool(&cfg, "async-log", (int*)&boolVal) == CONFIG_TRUE )
+  { self->asyncLog = (bool)boolVal; }
+
   if (config_lookup_int(&cfg, "loglevel", &intVal) == CONFIG_TRUE)
   {
     if ((intVal >= LEVEL_ERROR) && ((intVal <= LEVEL_COMM)))
@@ -870,6 +912,16 @@ bool isCompleteConfiguration(Configuration* self)
                 "The keep-window time can not be negative!");
   ERROR_IF_TRUE(self->defaultKeepWindow > 0xFFFF,
                 "The keep-window time more than 65535 seconds!");
+  ERROR_IF_TRUE(self->commandWorkers < 0,
+                "The number of command workers can not be negative!");
+  ERROR_IF_TRUE(self->commandWorkers > SRX_MAX_COMMAND_WORKERS,
+                "More than %d command workers are not supported!", 
+                SRX_MAX_COMMAND_WORKERS);
+  ERROR_IF_TRUE(self->serverReactors < 0,
+                "The number of server reactors can not be negative!");
+  ERROR_IF_TRUE(self->serverReactors > SRX_MAX_SERVER_REACTORS,
+                "More than %d server reactors are not supported!", 
+                SRX_MAX_SERVER_REACTORS);
 
   return true;
 }
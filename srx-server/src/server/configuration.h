@@ -20,10 +20,14 @@
  * other licenses. Please refer to the licenses of all libraries required
  * by this software.
  *
- * @version 0.6.2.1
+ * @version 0.6.2.2
  *
  * Changelog:
  * -----------------------------------------------------------------------------
+ * 0.6.2.2  - 2026/10/17
+ *            * Added commandWorkers.
+ *            * Added serverReactors.
+ *            * Added asyncLog.
  * 0.6.2.1  - 2024/08/24 - oborchert
  *            * Added defines to replace in code hardcoded strings.
  * 0.6.0.0  - 2021/06/26 - kyehwanl
@@ -60,6 +64,14 @@
 #define SRX_DEF_CONSOLE_PASSWORD "x"
 #define SRX_DEF_PORT             17900
 #define SRX_DEF_CONSOLE_PORT     17901
+/** Default number of command handler workers. Zero = one per online CPU */
+#define SRX_DEF_COMMAND_WORKERS  1
+/** Maximum number of command handler workers */
+#define SRX_MAX_COMMAND_WORKERS  64
+/** Default number of proxy connection reactors. Zero = thread per proxy */
+#define SRX_DEF_SERVER_REACTORS  1
+/** Maximum number of proxy connection reactors */
+#define SRX_MAX_SERVER_REACTORS  16
 
 #define MAX_PROXY_MAPPINGS 256
 
@@ -99,6 +111,8 @@ typedef struct {
 
   /** Set only if \c msgDest is MSG_DEST_FILENAME */
   char*                 msgDestFilename;
+  /** Write the messages from the log writer thread. */
+  bool                  asyncLog;
 
   // SRx Server
   /** Port the SRx server should run on (default: 17900) */
@@ -133,6 +147,13 @@ typedef struct {
   /** If set true, disable the receiver queue. */
   bool                  mode_no_receivequeue;
 
+  /** Number of command handler workers. Zero = one per online CPU. */
+  int                   commandWorkers;
+
+  /** Number of epoll reactor threads serving the proxy connections. Zero = 
+   * one thread per proxy connection. */
+  int                   serverReactors;
+
   /** The configured default keep window. Zero = deactivate.*/
   int                   defaultKeepWindow;
   /** the configuration array for the proxy mapping */
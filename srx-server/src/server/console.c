@@ -20,10 +20,26 @@
  * other licenses. Please refer to the licenses of all libraries required
  * by this software.
  *
- * @version 0.6.0.0
+ * @version 0.6.2.2
  *
  * Changelog:
  * -----------------------------------------------------------------------------
+ * 0.6.2.2 - 2026/10/17
+ *           * command-queue displays the queue depth of each command handler
+ *             worker.
+ *           * show-aspa displays the statistics of the incremental ASPA
+ *             re-validation.
+ *           * Added command "sig-cache" which displays the statistics of the
+ *             verified signature cache of the SRx Crypto API.
+ *           * Added command "update-gc" which displays the statistics of the
+ *             update cache garbage collector.
+ *           * num-updates and dump-ucache do not count removed updates.
+ *           * num-updates displays the updates pending for the prefix tree.
+ *           * Added command "mem-pools" which displays the usage of all memory
+ *             pools.
+ *           * Added command "send-queue" which displays the statistics of the
+ *             send queue and the number of send system calls.
+ *           * show-srx displays the number of server reactors.
  * 0.6.0.0 - 2021/02.26 - kyehwanl
  *           * Added CST_VERSION, CST_ASPATH, and CST_ASPA to ConsoleShowType.
  *           * Added commands "show-aspa" and "show-aspath".
@@ -82,6 +98,7 @@
 #include "server/command_queue.h"
 #include "server/configuration.h"
 #include "server/console.h"
+#include "server/main.h"
 #include "server/prefix_cache.h"
 #include "server/srx_server.h"
 #include "server/srx_packet_sender.h"
@@ -96,6 +113,7 @@
 #include "rpki_router_client.h"
 
 #include "util/log.h"
+#include "util/mem_pool.h"
 #include "util/server_socket.h"
 #include "util/prefix.h"
 #include "util/slist.h"
@@ -109,6 +127,7 @@
 #define CP2_NOPROMPT "\r"
 #define CP2_PROMPT   "\r[SRx]> "
 #define CON_STDOUT   '-'
+#define CON_MAX_MEM_POOLS 32
 
 #define INITIAL_BUFFER_SIZE 1
 
@@ -147,6 +166,10 @@ static void doNumPrefixes(SRXConsole* self, char* cmd, char* param);
 static void doNumProxies(SRXConsole* self, char* cmd, char* param);
 
 static void doCommandQueue(SRXConsole* self, char* cmd, char* param);
+static void doSigCache(SRXConsole* self, char* cmd, char* param);
+static void doUpdateGC(SRXConsole* self, char* cmd, char* param);
+static void doMemPools(SRXConsole* self, char* cmd, char* param);
+static void doSendQueue(SRXConsole* self, char* cmd, char* param);
 static void doDumpPCache(SRXConsole* self, char* cmd, char* param);
 static void doDumpUCache(SRXConsole* self, char* cmd, char* param);
 
@@ -218,6 +241,16 @@ char* CON_HELP_RESP= "\r\nAvailable commands are:\r\n"
                                              "attached\r\n"
                  " command-queue         Displays the content of the "
                                              "command queue.\r\n"
+                 " sig-cache             Displays the statistics of the "
+                                             "verified\r\n"
+                 "                       signature cache.\r\n"
+                 " update-gc             Displays the statistics of the "
+                                             "update\r\n"
+                 "                       cache garbage collector.\r\n"
+                 " mem-pools             Displays the usage of the memory "
+                                             "pools.\r\n"
+                 " send-queue            Displays the statistics of the "
+                                             "send queue.\r\n"
 #ifdef SRX_ALL
                  " dump-pcache <file>    Dump the prefix cache into a file with"
                  "\r\n                       the given name.\r\n"
@@ -267,6 +300,10 @@ char* CON_NOPREFIX_CMD = "num-prefixes";
 char* CON_NOPROXY_CMD  = "num-proxies";
 
 char* CON_COMMAND_QUEUE   = "command-queue";
+char* CON_SIG_CACHE_CMD   = "sig-cache";
+char* CON_UPDATE_GC_CMD   = "update-gc";
+char* CON_MEM_POOLS_CMD   = "mem-pools";
+char* CON_SEND_QUEUE_CMD  = "send-queue";
 char* CON_DUMP_PCACHE_CMD = "dump-pcache";
 char* CON_DUMP_UCACHE_CMD = "dump-ucache";
 
@@ -821,6 +858,30 @@ static bool doProcessCommand(SRXConsole* self)
   {
     doCommandQueue(self, cmd, param);
   }
+  // statistics of the verified signature cache
+  else if (    (cmdLen == strlen(CON_SIG_CACHE_CMD))
+            && (strncmp(CON_SIG_CACHE_CMD, cmd, cmdLen)==0))
+  {
+    doSigCache(self, cmd, param);
+  }
+  // statistics of the update cache garbage collector
+  else if (    (cmdLen == strlen(CON_UPDATE_GC_CMD))
+            && (strncmp(CON_UPDATE_GC_CMD, cmd, cmdLen)==0))
+  {
+    doUpdateGC(self, cmd, param);
+  }
+  // usage of the memory pools
+  else if (    (cmdLen == strlen(CON_MEM_POOLS_CMD))
+            && (strncmp(CON_MEM_POOLS_CMD, cmd, cmdLen)==0))
+  {
+    doMemPools(self, cmd, param);
+  }
+  // statistics of the send queue
+  else if (    (cmdLen == strlen(CON_SEND_QUEUE_CMD))
+            && (strncmp(CON_SEND_QUEUE_CMD, cmd, cmdLen)==0))
+  {
+    doSendQueue(self, cmd, param);
+  }
   // dump the prefix cache
   else if (    (cmdLen == strlen(CON_DUMP_PCACHE_CMD))
             && (strncmp(CON_DUMP_PCACHE_CMD, cmd, cmdLen)==0))
@@ -909,14 +970,29 @@ static void doShowAsPath(SRXConsole* self, char* cmd, char* param)
 static void doShowASPA(SRXConsole* self, char* cmd, char* param)
 {
   LOG(LEVEL_DEBUG, CP1 CP2 "%s %s", self->clientSockFd, cmd, param);
-  char out[256];
-  memset(out, '\0', 256);
-  sprintf (out, "ASPA Object DB printing ...\r\n");
+  char out[1024];
+  memset(out, '\0', 1024);
 
   RPKIHandler* handler = self->rpkiHandler;
-  ASPA_DBManager* aspaDBManager = handler->aspaDBManager;
-  TrieNode *root = aspaDBManager->tableRoot;
-  printAllLeafNode(root);
+  AspathRevalStats* stats = &handler->aspathCache->stats;
+  snprintf (out, 1024, "ASPA Object DB printing ...\r\n"
+            "ASPA objects              : %u\r\n"
+            "ASPA re-validations       : %u\r\n"
+            " last serial              : %u\r\n"
+            " - ASPA changes           : %u\r\n"
+            " - paths touched          : %u\r\n"
+            " - paths changed          : %u\r\n"
+            " - updates changed        : %u\r\n"
+            " total paths touched      : %llu\r\n"
+            " total paths changed      : %llu\r\n"
+            " total updates changed    : %llu\r\n",
+            handler->aspaDBManager->countAspaObj, stats->serials,
+            stats->lastSerial, stats->lastAsnChanges, stats->lastDirtyPaths,
+            stats->lastChangedPaths, stats->lastChangedUpdates,
+            (unsigned long long)stats->totalDirtyPaths, 
+            (unsigned long long)stats->totalChangedPaths,
+            (unsigned long long)stats->totalChangedUpdates);
+  printAllAspaObjects(handler->aspaDBManager);
 
   sendToConsoleClient(self, out, true);
 }
@@ -1707,6 +1783,8 @@ static void doShowSRX(SRXConsole* self, char* cmd, char* param)
   strPtr += sprintf(strPtr, "mode.no-receivequeue.....: %s\r\n",
                  cfg->mode_no_receivequeue ? "true  (receive queue turned off)"
                                            : "false (receive queue turned on)");
+  strPtr += sprintf(strPtr, "server-reactors..........: %d\r\n",
+                            cfg->serverReactors);
   strPtr += sprintf(strPtr, "\r\n");
   sendToConsoleClient(self, str, true);
 }
@@ -1823,11 +1901,12 @@ static void doNumUpdates(SRXConsole* self, char* cmd, char* param)
   // produce a \0 terminated string
   memset(str,'\0',256);
 
-  elements = self->commandHandler->updCache->allItems.size;
+  elements = getNumberOfUpdates(self->commandHandler->updCache);
   sprintf(str, "Update Cache: %u updates stored.\r\n", elements);
   sendToConsoleClient(self, str, false);
   elements = self->commandHandler->rpkiHandler->prefixCache->updates.size;
-  sprintf(str, "Prefix Cache: %u update shadows stored.\r\n", elements);
+  sprintf(str, "Prefix Cache: %u update shadows stored, %u pending.\r\n", 
+          elements, self->commandHandler->rpkiHandler->prefixCache->noPending);
   sendToConsoleClient(self, str, true);
 }
 
@@ -1882,19 +1961,229 @@ static void doNumProxies(SRXConsole* self, char* cmd, char* param)
 static void doCommandQueue(SRXConsole* self, char* cmd, char* param)
 {
   LOG(LEVEL_DEBUG, CP1 CP2 "%s %s", self->clientSockFd, cmd, param);
-  char str[256];
-  int total = getTotalQueueSize(self->commandHandler->queue);
-  int unprocessed = getUnprocessedQueueSize(self->commandHandler->queue);
+  CommandQueue* queue = self->commandHandler->queue;
+  int total = getTotalQueueSize(queue);
+  int unprocessed = getUnprocessedQueueSize(queue);
+  int shards = getNumberOfQueueShards(queue);
+  int shardTotal, shardUnprocessed, idx;
+  uint32_t shardFetched;
+  // One line per worker
+  int   size = 512 + (shards * 64);
+  char* str  = malloc(size);
+  char* pos  = str;
+
+  if (str == NULL)
+  {
+    sendToConsoleClient(self, "Not enough memory!\r\n", true);
+    return;
+  }
   // produce a \0 terminated string
-  memset(str,'\0',256);
+  memset(str,'\0',size);
 
   // Get the number of elements from the command queue. Here is is for display
   // only, synchronizing is not necessary
-  sprintf(str, "Command handler:\r\n"
-               "====================================\r\n"
-               "Total commands........: %06u\r\n"
-               "Unprocessed commands..: %06u\r\n"
-               "====================================\r\n", total, unprocessed);
+  pos += sprintf(pos, "Command handler:\r\n"
+                      "====================================\r\n"
+                      "Total commands........: %06u\r\n"
+                      "Unprocessed commands..: %06u\r\n"
+                      "Workers...............: %u\r\n"
+                      "------------------------------------\r\n"
+                      " Worker  Total  Unprocessed  Fetched\r\n",
+                      total, unprocessed, shards);
+  for (idx = 0; idx < shards; idx++)
+  {
+    if (getQueueShardStatistics(queue, idx, &shardTotal, &shardUnprocessed,
+                                &shardFetched))
+    {
+      pos += sprintf(pos, "  %5u %6u       %6u %8u\r\n",
+                     idx, shardTotal, shardUnprocessed, shardFetched);
+    }
+  }
+  sprintf(pos, "====================================\r\n");
+  sendToConsoleClient(self, str, true);
+  free(str);
+}
+
+/**
+ * Display the statistics of the verified signature cache of the SRx Crypto 
+ * API.
+ *
+ * @param self The console itself
+ * @param cmd The sig-cache command
+ * @param param parameters - not used
+ *
+ * @since 0.6.2.2
+ */
+static void doSigCache(SRXConsole* self, char* cmd, char* param)
+{
+  LOG(LEVEL_DEBUG, CP1 CP2 "%s %s", self->clientSockFd, cmd, param);
+  SRxCryptoAPI* capi = getSrxCAPI();
+  SCA_SigCacheStatistics stats;
+  char str[512];
+  uint64_t lookups = 0;
+
+  memset(&stats, 0, sizeof(SCA_SigCacheStatistics));
+  if (   (capi == NULL) || (capi->getSigCacheStatistics == NULL)
+      || !capi->getSigCacheStatistics(&stats))
+  {
+    sendToConsoleClient(self, "The SRx Crypto API does not use a signature "
+                              "cache!\r\n", true);
+    return;
+  }
+
+  lookups = stats.hits + stats.misses;
+  snprintf(str, sizeof(str), 
+           "Verified signature cache:\r\n"
+           "====================================\r\n"
+           "Entries...............: %u / %u\r\n"
+           "Hits..................: %llu\r\n"
+           "Misses................: %llu\r\n"
+           "Hit rate..............: %.1f%%\r\n"
+           "Evictions.............: %llu\r\n"
+           "Invalidations.........: %llu\r\n"
+           "====================================\r\n",
+           stats.entries, stats.capacity, 
+           (unsigned long long)stats.hits, (unsigned long long)stats.misses,
+           lookups > 0 ? (stats.hits * 100.0) / lookups : 0.0,
+           (unsigned long long)stats.evictions,
+           (unsigned long long)stats.invalidations);
+  sendToConsoleClient(self, str, true);
+}
+
+/**
+ * Display the statistics of the update cache garbage collector.
+ *
+ * @param self The console itself
+ * @param cmd The update-gc command
+ * @param param parameters - not used
+ *
+ * @since 0.6.2.2
+ */
+static void doUpdateGC(SRXConsole* self, char* cmd, char* param)
+{
+  LOG(LEVEL_DEBUG, CP1 CP2 "%s %s", self->clientSockFd, cmd, param);
+  UC_GCStatistics stats;
+  char str[512];
+
+  getUpdateCacheGCStats(self->commandHandler->updCache, &stats);
+  snprintf(str, sizeof(str), 
+           "Update cache garbage collector:\r\n"
+           "====================================\r\n"
+           "Runs..................: %llu\r\n"
+           "Reclaimed updates.....: %llu\r\n"
+           "Reclaimed bytes.......: %llu\r\n"
+           "Scheduled updates.....: %u\r\n"
+           "Free cache entries....: %u\r\n"
+           "====================================\r\n",
+           (unsigned long long)stats.runs, 
+           (unsigned long long)stats.reclaimedEntries,
+           (unsigned long long)stats.reclaimedBytes,
+           stats.scheduled, stats.freeEntries);
+  sendToConsoleClient(self, str, true);
+}
+
+/**
+ * Display the usage statistics of all memory pools.
+ *
+ * @param self The console itself
+ * @param cmd The mem-pools command
+ * @param param parameters - not used
+ *
+ * @since 0.6.2.2
+ */
+static void doMemPools(SRXConsole* self, char* cmd, char* param)
+{
+  LOG(LEVEL_DEBUG, CP1 CP2 "%s %s", self->clientSockFd, cmd, param);
+  MemPoolStatistics stats[CON_MAX_MEM_POOLS];
+  int   noPools = getAllMemPoolStatistics(stats, CON_MAX_MEM_POOLS);
+  int   idx;
+  int   size = 512 + (CON_MAX_MEM_POOLS * 160);
+  char* str  = malloc(size);
+  char* pos  = str;
+
+  if (str == NULL)
+  {
+    sendToConsoleClient(self, "Not enough memory!\r\n", true);
+    return;
+  }
+  if (noPools > CON_MAX_MEM_POOLS)
+  {
+    noPools = CON_MAX_MEM_POOLS;
+  }
+
+  pos += sprintf(pos, "Memory pools:\r\n"
+                      "============================================"
+                      "============================================\r\n"
+                      " Pool                    Size  Slabs  KBytes"
+                      "    In Use    Cached      Allocs       Frees\r\n");
+  for (idx = 0; idx < noPools; idx++)
+  {
+    pos += sprintf(pos, " %-22s %5u %6u %7llu %9u %9u %11llu %11llu\r\n",
+                   stats[idx].name, stats[idx].objectSize, stats[idx].slabs,
+                   (unsigned long long)(stats[idx].slabBytes / 1024),
+                   stats[idx].inUse, stats[idx].cached,
+                   (unsigned long long)stats[idx].allocs,
+                   (unsigned long long)stats[idx].frees);
+  }
+  sprintf(pos, "============================================"
+               "============================================\r\n");
+  sendToConsoleClient(self, str, true);
+  free(str);
+}
+
+/**
+ * Display the statistics of the send queue and the send system calls of the
+ * server socket.
+ *
+ * @param self The console itself
+ * @param cmd The send-queue command
+ * @param param parameters - not used
+ *
+ * @since 0.6.2.2
+ */
+static void doSendQueue(SRXConsole* self, char* cmd, char* param)
+{
+  LOG(LEVEL_DEBUG, CP1 CP2 "%s %s", self->clientSockFd, cmd, param);
+  SendQueueStatistics stats;
+  uint64_t calls = 0;
+  uint64_t bytes = 0;
+  char     str[1024];
+
+  getSendQueueStatistics(&stats);
+  getServerSocketSendStatistics(&self->commandHandler->svrConnHandler->svrSock,
+                                &calls, &bytes);
+
+  snprintf(str, sizeof(str), "Send queue:\r\n"
+           "====================================\r\n"
+           " Queued PDUs ........: %llu\r\n"
+           " Queued bytes .......: %llu\r\n"
+           " Size flushes .......: %llu\r\n"
+           " Timer flushes ......: %llu\r\n"
+           " Direct sends .......: %llu\r\n"
+           " Full ring waits ....: %llu\r\n"
+           " Overflow PDUs ......: %llu\r\n"
+           " Dropped PDUs .......: %llu\r\n"
+           " Queue depth ........: %u\r\n"
+           " High-water mark ....: %u\r\n"
+           " Output buffers .....: %u\r\n"
+           "------------------------------------\r\n"
+           " Send system calls ..: %llu\r\n"
+           " Bytes send .........: %llu\r\n"
+           " Bytes per call .....: %llu\r\n"
+           "====================================\r\n",
+           (unsigned long long)stats.pdus,
+           (unsigned long long)stats.bytes,
+           (unsigned long long)stats.sizeFlushes,
+           (unsigned long long)stats.timerFlushes,
+           (unsigned long long)stats.directSends,
+           (unsigned long long)stats.fullWaits,
+           (unsigned long long)stats.overflows,
+           (unsigned long long)stats.drops,
+           stats.depth, stats.highWater,
+           stats.buffers,
+           (unsigned long long)calls,
+           (unsigned long long)bytes,
+           (unsigned long long)(calls > 0 ? bytes / calls : 0));
   sendToConsoleClient(self, str, true);
 }
 
@@ -1952,7 +2241,7 @@ static void doDumpUCache(SRXConsole* self, char* cmd, char* param)
   char* fileName = (ch == CON_STDOUT) ? "standard out" : param;
   // Get the number of elements from the command queue. Here is is for display
   // only, synchronizing is not necessary
-  elements = self->commandHandler->updCache->allItems.size;
+  elements = getNumberOfUpdates(self->commandHandler->updCache);
   sprintf(str, "Update Cache has %u items. Start export into %s!\r\n",
           elements, fileName);
   sendToConsoleClient(self, str, true);
@@ -25,7 +25,7 @@
  * In this version the SRX server only can connect to once RPKI VALIDATION CACHE
  * MULTI CACHE will be part of a later release.
  *
- * @version 0.6.2.1
+ * @version 0.6.2.2
  *
  * EXIT Values:
  *
@@ -39,6 +39,12 @@
  *
  * Changelog:
  * -----------------------------------------------------------------------------
+ * 0.6.2.2  - 2026/10/17
+ *            * The command queue is created with one shard per configured
+ *              command handler worker.
+ *            * Start the update cache garbage collector after all caches are
+ *              created and stop it before any cache is released.
+ *            * Start the log writer thread if "async-log" is configured.
  * 0.6.2.1  - 2024/09/03 - oborchert
  *            * Fixed issues if started with no configuration file.
  * 0.6.0.0  - 2021/03/30 - oborchert
@@ -88,6 +94,7 @@
  */
 #include <stdio.h>
 #include <signal.h>
+#include <unistd.h>
 #include "server/bgpsec_handler.h"
 #include "server/command_handler.h"
 #include "server/command_queue.h"
@@ -151,7 +158,6 @@ static SKI_CACHE*    skiCache  = NULL;
 static RPKI_QUEUE*   rpkiQueue = NULL;
 
 static AspathCache  aspathCache;
-static TrieNode     aspaTrie;
 static ASPA_DBManager aspaDBManager;
 
 /** The cache that manages keys for bgpsec. 
@@ -333,6 +339,10 @@ static bool setupCaches()
   }
   initializeAspaDBManager(&aspaDBManager, &config);    // ASPA: ASPA object DB
   createAspathCache(&aspathCache, &aspaDBManager); // ASPA: AS path DB 
+  if (!startUpdateCacheGC(&updCache, &prefixCache, &aspathCache))
+  {
+    LOG(LEVEL_WARNING, "Updates will not be removed from the update cache!");
+  }
 
   LOG(LEVEL_INFO, "- SRx Caches and RPKI Queue created");
   return true;
@@ -426,7 +436,16 @@ static bool setupQueues()
 
   if (cont)
   {
-    if (!initializeCommandQueue(&cmdQueue))
+    // Zero command workers = one worker per online CPU
+    int cmdWorkers = config.commandWorkers;
+    if (cmdWorkers == 0)
+    {
+      long numCPU = sysconf(_SC_NPROCESSORS_ONLN);
+      cmdWorkers = (numCPU > 0) ? (int)numCPU : 1;
+      cmdWorkers = cmdWorkers > SRX_MAX_COMMAND_WORKERS 
+                   ? SRX_MAX_COMMAND_WORKERS : cmdWorkers;
+    }
+    if (!initializeCommandQueue(&cmdQueue, cmdWorkers))
     {
       stopSendQueue();
       releaseSendQueue();
@@ -435,7 +454,8 @@ static bool setupQueues()
     }
     else
     {
-      LOG(LEVEL_INFO, "- Command Queue created!");
+      LOG(LEVEL_INFO, "- Command Queue created with %d shard(s)!", 
+                      cmdWorkers);
     }
   }
 
@@ -524,6 +544,11 @@ static void doCleanupHandlers(int handler)
  */
 static void doCleanupCaches(int cache)
 {
+  // The garbage collector uses the prefix cache and the AS path cache.
+  if ((cache & SETUP_UPDATE_CACHE) > 0)
+  {
+    stopUpdateCacheGC(&updCache);
+  }
   if ((cache & SETUP_KEY_CACHE) > 0)
   {
     releaseKeyCache(&keyCache);
@@ -714,6 +739,12 @@ int main(int argc, const char* argv[])
           LOG(LEVEL_ERROR, "Could not set log file.");
       }
 
+      // Write the messages from the log writer thread.
+      if (config.asyncLog && !startLogWriter())
+      {
+        LOG(LEVEL_WARNING, "Could not start the log writer thread.");
+      }
+
       LOG(LEVEL_DEBUG, "([0x%08X]) > Start Main SRx server thread.", 
                        pthread_self());
 
@@ -821,6 +852,7 @@ int main(int argc, const char* argv[])
 
       LOG(LEVEL_DEBUG, "([0x%08X]) < Stop Main SRx server thread.", 
                        pthread_self());
+      stopLogWriter();
       if (fp)
       {
         fclose(fp);
@@ -29,10 +29,22 @@
  *  - getOriginStatus: Triggered by the SRx - Router - proxy for each
  *                     validation request.
  *
- * @version 0.6.0.0
+ * @version 0.6.2.2
  *
  * Changelog:
  * -----------------------------------------------------------------------------
+ * 0.6.2.2  - 2026/10/17
+ *            * The update list and the update lists of each prefix are indexed,
+ *              removing an update does not walk the lists anymore. Pending
+ *              updates are kept in a hash table per shard.
+ *            * requestUpdateValidation validates with the published ROA index
+ *              and does not wait for the prefix tree anymore. Added 
+ *              publishPrefixCacheIndex and the tree mutex.
+ *            * Added addROAwlBulk for the initial synchronization.
+ *            * Implemented removeUpdate, used by the update cache garbage
+ *              collector.
+ *            * PC_Prefix, PC_AS, PC_ROA, and PC_Update are allocated from memory
+ *              pools.
  * 0.6.0.0  - 2021/03/30 - oborchert
  *            * Added missing version control. Also moved modifications labeled 
  *              as version 0.5.2.0 to 0.6.0.0 (0.5.2.0 was skipped)
@@ -66,6 +78,7 @@
 
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
 
 #include <uthash.h>
 #include <arpa/telnet.h>
@@ -175,6 +188,8 @@
  */
 bool initializePrefixCache(PrefixCache* self, UpdateCache* updateCache)
 {
+  int idx;
+
   // Create the patricia prefix tree
   self->prefixTree = New_Patricia(PATRICIA_MAXBITS); // 128 = IPv6
   if (self->prefixTree == NULL)
@@ -220,9 +235,54 @@ bool initializePrefixCache(PrefixCache* self, UpdateCache* updateCache)
     }
   }
 
+  // Memory pools
+  self->prefixPool = createMemPool("prefix-cache-prefix", sizeof(PC_Prefix), 0);
+  self->asPool     = createMemPool("prefix-cache-as", sizeof(PC_AS), 0);
+  self->roaPool    = createMemPool("prefix-cache-roa", sizeof(PC_ROA), 0);
+  self->updatePool = createMemPool("prefix-cache-update", sizeof(PC_Update), 
+                                   0);
+  self->pendingPool = createMemPool("prefix-cache-pending", 
+                                    sizeof(PC_PendingUpdate), 0);
+  if (   (self->prefixPool == NULL) || (self->asPool == NULL)
+      || (self->roaPool == NULL) || (self->updatePool == NULL)
+      || (self->pendingPool == NULL))
+  {
+    RAISE_ERROR("Failed to initialize the prefix cache memory pools");
+    releaseMemPool(self->prefixPool);
+    releaseMemPool(self->asPool);
+    releaseMemPool(self->roaPool);
+    releaseMemPool(self->updatePool);
+    releaseMemPool(self->pendingPool);
+    releaseRWLock(&self->otherLock);
+    releaseRWLock(&self->validLock);
+    releaseRWLock(&self->asLock);
+    releaseRWLock(&self->treeLock);
+    Destroy_Patricia(self->prefixTree, NULL);
+    return false;
+  }
+
+  // ROA index and pending updates
+  if (!initMutex(&self->treeMutex) || !initROAIndexDomain(&self->roaIndex))
+  {
+    RAISE_ERROR("Failed to initialize the prefix cache ROA index");
+    return false;
+  }
+  for (idx = 0; idx < PC_UPDATE_SHARDS; idx++)
+  {
+    if (!initMutex(&self->pending[idx].mutex))
+    {
+      RAISE_ERROR("Failed to initialize the pending updates mutex");
+      return false;
+    }
+    self->pending[idx].updates = NULL;
+  }
+  self->roaChanged = false;
+  self->noPending  = 0;
+
   // Misc.
   self->updateCache = updateCache;
   initSList(&self->updates);
+  indexSList(&self->updates);
   return true;
 }
 
@@ -231,9 +291,10 @@ bool initializePrefixCache(PrefixCache* self, UpdateCache* updateCache)
  * maintenance values are maintained here. This method should not be
  * called for other than a clean emptying of the cache.
  *
+ * @param self the prefix cache
  * @param prefix the particular pc prefix to be released.
  */
-static void releasePrefix(PC_Prefix* prefix)
+static void releasePrefix(PrefixCache* self, PC_Prefix* prefix)
 {
   SListNode* asListNode;
   SListNode* roaListNode;
@@ -254,17 +315,17 @@ static void releasePrefix(PC_Prefix* prefix)
         roa = (PC_ROA*)roaListNode->data;
         if (roa != NULL)
         {
-          free(roa);
+          freeToMemPool(self->roaPool, roa);
           roa = NULL;
         }
       }
       releaseSList(&asNumber->roas);
-      free(asNumber);
+      freeToMemPool(self->asPool, asNumber);
       asNumber = NULL;
     }
   }
   releaseSList(&prefix->asn);
-  free(prefix);
+  freeToMemPool(self->prefixPool, prefix);
 }
 
 /**
@@ -278,6 +339,7 @@ void releasePrefixCache(PrefixCache* self)
     SListNode*        listNode;
     PC_Prefix*        prefix;
     PC_Update*        pc_update;
+    int               idx;
 
     // Free all prefixes and node-data
     WRITE_LOCK(&self->asLock);
@@ -287,7 +349,7 @@ void releasePrefixCache(PrefixCache* self)
     PATRICIA_WALK(self->prefixTree->head, treeNode)
     {
       prefix = PATRICIA_DATA_GET(treeNode, PC_Prefix);
-      releasePrefix(prefix);
+      releasePrefix(self, prefix);
     } PATRICIA_WALK_END;
     RAISE_ERROR("Check if the treeNode has to be released independent or if it gets released with the Destroy_Patricia!");
     Destroy_Patricia(self->prefixTree, NULL);
@@ -306,10 +368,25 @@ void releasePrefixCache(PrefixCache* self)
     FOREACH_SLIST(&self->updates, listNode)
     {
       pc_update = (PC_Update*)getDataOfSListNode(listNode);
-      free(pc_update);
+      freeToMemPool(self->updatePool, pc_update);
     }
     releaseSList(&self->updates);
     releaseMutex(&self->updatesMutex);
+
+    // Free the pending updates and the ROA index
+    for (idx = 0; idx < PC_UPDATE_SHARDS; idx++)
+    {
+      HASH_CLEAR(hh, self->pending[idx].updates);
+      releaseMutex(&self->pending[idx].mutex);
+    }
+    releaseROAIndexDomain(&self->roaIndex);
+    releaseMutex(&self->treeMutex);
+
+    releaseMemPool(self->prefixPool);
+    releaseMemPool(self->asPool);
+    releaseMemPool(self->roaPool);
+    releaseMemPool(self->updatePool);
+    releaseMemPool(self->pendingPool);
   }
 }
 
@@ -344,7 +421,7 @@ void emptyCache(PrefixCache* self)
       prefix = (PC_Prefix*)treeNode->data;
       if (prefix != NULL)
       {
-        releasePrefix(prefix);
+        releasePrefix(self, prefix);
       }
       treeNode->data = NULL;
     } PATRICIA_WALK_END;
@@ -357,7 +434,7 @@ void emptyCache(PrefixCache* self)
       pc_update = (PC_Update*)listNode->data;
       if (pc_update != NULL)
       {
-        free(pc_update);
+        freeToMemPool(self->updatePool, pc_update);
       }
     }
     emptySList(&self->updates);
@@ -418,7 +495,8 @@ static void printXML(PrefixCache* self, char* methodName);
  *
  * @return The prefix cache AS or NULL in case a fatal internal error occurred.
  */
-static PC_AS* getASFromPrefix(PC_Prefix* pcPrefix, uint32_t as)
+static PC_AS* getASFromPrefix(PrefixCache* self, PC_Prefix* pcPrefix, 
+                              uint32_t as)
 {
   PC_AS* pcAS = NULL;
   int idx;
@@ -440,8 +518,8 @@ static PC_AS* getASFromPrefix(PC_Prefix* pcPrefix, uint32_t as)
   // If the AS is not found, create one.
   if (pcAS == NULL)
   {
-    pcAS = malloc(sizeof(PC_AS));
-    if (appendDataToSList(&pcPrefix->asn, pcAS))
+    pcAS = allocFromMemPool(self->asPool);
+    if ((pcAS != NULL) && appendDataToSList(&pcPrefix->asn, pcAS))
     {
       pcAS->asn          = as;
       pcAS->update_count = 0;
@@ -451,7 +529,7 @@ static PC_AS* getASFromPrefix(PC_Prefix* pcPrefix, uint32_t as)
     {
       RAISE_SYS_ERROR( HDR "Could not add AS%u to the prefix tree!",
                        pthread_self(), as);
-      free(pcAS);
+      freeToMemPool(self->asPool, pcAS);
       pcAS = NULL;
     }
   }
@@ -516,13 +594,14 @@ static bool _performUpdateValidationNewPrefix(PrefixCache* self,
 static bool _performUpdateValidationKnownPrefix(PrefixCache* self,
                                                 PC_Update* update, uint32_t as,
                                                 bool isNew);
+static bool _registerUpdate(PrefixCache* self, SRxUpdateID* updateID,
+                            IPPrefix* prefix, uint32_t as);
 
 /**
- * Request the validation for an update received. During the process of
- * validating of adding the update it will be added to the cache, the validation
- * is done by using the data within the prefix cache. Each update MUST be added
- * only once! Once added, changes of the validation state are signaled to the
- * update cache and with this to the registered clients.
+ * Request the validation for an update received. The update is validated with
+ * the published ROA index and stored in its shard of pending updates, neither
+ * waits for the prefix tree. The pending updates are added to the prefix tree
+ * by _drainPendingUpdates. Each update MUST be added only once!
  *
  * @param self The prefix cache
  * @param updateID the id of the update itself
@@ -533,6 +612,104 @@ static bool _performUpdateValidationKnownPrefix(PrefixCache* self,
  */
 bool requestUpdateValidation(PrefixCache* self, SRxUpdateID* updateID,
                                 IPPrefix* prefix, uint32_t as)
+{
+  PC_PendingUpdate*      pending = allocFromMemPool(self->pendingPool);
+  PC_UpdateShard*        shard   = &self->pending[*updateID % PC_UPDATE_SHARDS];
+  SRxValidationResultVal result;
+  ROAIndex*              index;
+  int                    slot;
+
+  if (pending == NULL)
+  {
+    RAISE_SYS_ERROR( HDR "Could not allocate update [0x%08X] in prefix cache!",
+                     pthread_self(), *updateID);
+    return false;
+  }
+  pending->updateID = *updateID;
+  pending->as       = as;
+  memcpy(&pending->prefix, prefix, sizeof(IPPrefix));
+
+  // The update is stored before the reader leaves the index. A publisher 
+  // drains the pending updates only after all readers of the previous index 
+  // left, the update is therefore validated again with the prefix tree if the
+  // index changed meanwhile.
+  index  = enterROAIndex(&self->roaIndex, &slot);
+  result = validateWithROAIndex(index, prefix, as);
+  notifyUpdateCacheForROAChange(self->updateCache, updateID, result,
+                                PC_DONT_SUPPRESS);
+
+  lockMutex(&shard->mutex);
+  HASH_ADD(hh, shard->updates, updateID, sizeof(SRxUpdateID), pending);
+  __atomic_add_fetch(&self->noPending, 1, __ATOMIC_SEQ_CST);
+  unlockMutex(&shard->mutex);
+  leaveROAIndex(&self->roaIndex, slot);
+
+  return true;
+}
+
+/**
+ * Add the pending updates to the prefix tree. The updates are validated again
+ * with the prefix tree, a changed result is signaled to the update cache.
+ * The caller MUST hold the tree mutex.
+ *
+ * @param self The prefix cache
+ *
+ * @since 0.6.2.2
+ */
+static void _drainPendingUpdates(PrefixCache* self)
+{
+  PC_PendingUpdate* pending;
+  PC_PendingUpdate* tmp;
+  PC_PendingUpdate* updates;
+  uint32_t          drained = 0;
+  int               idx;
+
+  if (__atomic_load_n(&self->noPending, __ATOMIC_SEQ_CST) == 0)
+  {
+    return;
+  }
+
+  for (idx = 0; idx < PC_UPDATE_SHARDS; idx++)
+  {
+    lockMutex(&self->pending[idx].mutex);
+    updates = self->pending[idx].updates;
+    self->pending[idx].updates = NULL;
+    unlockMutex(&self->pending[idx].mutex);
+
+    // The hash table iterates in the order the updates were added.
+    HASH_ITER(hh, updates, pending, tmp)
+    {
+      HASH_DELETE(hh, updates, pending);
+      if (!_registerUpdate(self, &pending->updateID, &pending->prefix, 
+                           pending->as))
+      {
+        RAISE_SYS_ERROR( HDR "Update [0x%08X] could not be added to the "
+                             "prefix tree!", pthread_self(), 
+                             pending->updateID);
+      }
+      freeToMemPool(self->pendingPool, pending);
+      drained++;
+    }
+  }
+
+  __atomic_sub_fetch(&self->noPending, drained, __ATOMIC_SEQ_CST);
+}
+
+/**
+ * Add the given update to the prefix tree and validate it with the data 
+ * within the prefix tree. Once added, changes of the validation state are 
+ * signaled to the update cache and with this to the registered clients.
+ * The caller MUST hold the tree mutex.
+ *
+ * @param self The prefix cache
+ * @param updateID the id of the update itself
+ * @param prefix The prefix of the update
+ * @param as The AS number of the update
+ *
+ * @return false indicates an error, most likely memory related! (fatal)
+ */
+static bool _registerUpdate(PrefixCache* self, SRxUpdateID* updateID,
+                            IPPrefix* prefix, uint32_t as)
 {
   // the node within the prefix tree. the data of it is the PC_prefix
   // information.
@@ -542,12 +719,21 @@ bool requestUpdateValidation(PrefixCache* self, SRxUpdateID* updateID,
   // This is the prefix the algorithm runs on.
   PC_Prefix*       pcPrefix = NULL;
   // The update itself
-  PC_Update*       pcUpdate = malloc(sizeof(PC_Update));
+  PC_Update*       pcUpdate = allocFromMemPool(self->updatePool);
   // The AS instance
   PC_AS*           pcAS = NULL;
   // The update id. I know it is so=illy but the structure might change.
   SRxUpdateID      updID = *updateID;
 
+  if ((pcUpdate == NULL) || (lookupPrefix == NULL))
+  {
+    RAISE_SYS_ERROR( HDR "Could not allocate update [0x%08X] in prefix cache!",
+                     pthread_self(), updID);
+    freeToMemPool(self->updatePool, pcUpdate);
+    free(lookupPrefix);
+    return false;
+  }
+
   WRITE_LOCK(&self->treeLock);
 
   pcUpdate->roa_match = 0;
@@ -557,7 +743,7 @@ bool requestUpdateValidation(PrefixCache* self, SRxUpdateID* updateID,
   {
     RAISE_SYS_ERROR( HDR "Could not add update [0x%08X] to prefix cache!",
                      pthread_self(), updID);
-    free(pcUpdate);
+    freeToMemPool(self->updatePool, pcUpdate);
     free(lookupPrefix);
     UNLOCK_WRITE_LOCK(&self->treeLock);
     return false;
@@ -573,7 +759,7 @@ bool requestUpdateValidation(PrefixCache* self, SRxUpdateID* updateID,
   {
     RAISE_ERROR("Failed to append a prefix to the prefix tree");
     deleteFromSList(&self->updates, pcUpdate);
-    free(pcUpdate);
+    freeToMemPool(self->updatePool, pcUpdate);
     free(lookupPrefix);
     UNLOCK_WRITE_LOCK(&self->treeLock);
     return false;
@@ -588,9 +774,15 @@ bool requestUpdateValidation(PrefixCache* self, SRxUpdateID* updateID,
   bool retVal = true;
 
   // Already existed - need to free given prefix
-  if (lookupPrefix->ref_count > 0) // If the prefix would have been existed
-  {                     // already this instance would not have been referenced.
+  // delROAwl might have left the node of the prefix without data.
+  if ((lookupPrefix->ref_count > 0) || (treeNode->data == NULL))
+  { // If the prefix would have been existed already this instance would not 
+    // have been referenced.
     // (Does P exist ? NO)
+    if (lookupPrefix->ref_count == 0)
+    {
+      free(lookupPrefix);
+    }
     retVal = _performUpdateValidationNewPrefix(self, pcUpdate, as);
     UNLOCK_READ_LOCK(&self->treeLock);
 
@@ -623,12 +815,12 @@ bool requestUpdateValidation(PrefixCache* self, SRxUpdateID* updateID,
                          pthread_self(), updateID);
         // remove update only, other updates for this prefix do exist!
         deleteFromSList(&self->updates, pcUpdate);
-        free(pcUpdate);
+        freeToMemPool(self->updatePool, pcUpdate);
         UNLOCK_READ_LOCK(&self->treeLock);
         return false;
       }
 
-      pcAS = getASFromPrefix(pcPrefix, as);
+      pcAS = getASFromPrefix(self, pcPrefix, as);
       if (pcAS == NULL)
       {
         // Error already generated!
@@ -637,7 +829,7 @@ bool requestUpdateValidation(PrefixCache* self, SRxUpdateID* updateID,
                          pthread_self(), updateID);
         deleteFromSList(&pcPrefix->other, pcUpdate);
         deleteFromSList(&self->updates, pcUpdate);
-        free(pcUpdate);
+        freeToMemPool(self->updatePool, pcUpdate);
         UNLOCK_READ_LOCK(&self->treeLock);
         return false;
       }
@@ -678,13 +870,16 @@ static bool _performUpdateValidationNewPrefix(PrefixCache* self,
                     pthread_self(), pcUpdate->updateID);
     return false;
   }
-  PC_Prefix* pcPrefix = malloc(sizeof(PC_Prefix));
+  PC_Prefix* pcPrefix = allocFromMemPool(self->prefixPool);
   pcPrefix->treeNode = pcUpdate->treeNode;
   pcUpdate->treeNode->data = pcPrefix;
 
   initSList(&pcPrefix->asn);
   initSList(&pcPrefix->other);
   initSList(&pcPrefix->valid);
+  indexSList(&pcPrefix->asn);
+  indexSList(&pcPrefix->other);
+  indexSList(&pcPrefix->valid);
   pcPrefix->roa_coverage = 0;
 
   PC_Prefix* parent_pcPrefix = getParent(pcUpdate->treeNode);
@@ -825,7 +1020,7 @@ static bool _performUpdateValidationKnownPrefix(PrefixCache* self,
 {
   PC_Prefix* pcPrefix = (PC_Prefix*)pcUpdate->treeNode->data;
   PC_Prefix* pcPrefix_Po = pcPrefix;
-  PC_AS*     pcAS = getASFromPrefix(pcPrefix, as);
+  PC_AS*     pcAS = getASFromPrefix(self, pcPrefix, as);
   pcAS->update_count++;
 
   // P might be covered by a ROA (we don't know if NEW prefix).
@@ -856,9 +1051,40 @@ static bool _performUpdateValidationKnownPrefix(PrefixCache* self,
 ////////////////////////////////////////////////////////////////////////////////
 
 /**
- * This method will remove the given update from the prefix cache.
+ * Search the update in the given list of updates.
  *
- * NOT IMPLEMENTED PRIOR VERSION 0.5.1
+ * @param list The list of PC_Update elements (P::valid or P::other)
+ * @param updateID The id of the update.
+ *
+ * @return The update or NULL if not found.
+ *
+ * @since 0.6.2.2
+ */
+static PC_Update* _removeUpdate_find(SList* list, SRxUpdateID updateID)
+{
+  SListNode* listNode;
+  PC_Update* pcUpdate;
+
+  FOREACH_SLIST(list, listNode)
+  {
+    pcUpdate = (PC_Update*)listNode->data;
+    if ((pcUpdate != NULL) && (pcUpdate->updateID == updateID))
+    {
+      return pcUpdate;
+    }
+  }
+
+  return NULL;
+}
+
+static bool _removeUpdate(PrefixCache* self, SRxUpdateID* updateID, 
+                          IPPrefix* prefix, uint32_t as);
+
+/**
+ * This method will remove the given update from the prefix cache. The ROA and
+ * AS counters of the update's prefix are reduced accordingly. The prefix 
+ * itself remains in the prefix tree, requestUpdateValidation expects existing
+ * tree nodes to carry their PC_Prefix.
  *
  * @param self The prefix cache.
  * @param updateID The id of the update that has to be removed.
@@ -870,8 +1096,139 @@ static bool _performUpdateValidationKnownPrefix(PrefixCache* self,
 bool removeUpdate(PrefixCache* self, SRxUpdateID* updateID, IPPrefix* prefix,
                   uint32_t as)
 {
-  //TODO: Implement for 0.5.x
-  RAISE_ERROR("IMPLEMENTATION EXPECTED FOR VERSION 0.5.1");
+  PC_UpdateShard*   shard   = &self->pending[*updateID % PC_UPDATE_SHARDS];
+  PC_PendingUpdate* pending = NULL;
+  bool              retVal;
+
+  lockMutex(&self->treeMutex);
+
+  // The update might not be added to the prefix tree yet.
+  lockMutex(&shard->mutex);
+  HASH_FIND(hh, shard->updates, updateID, sizeof(SRxUpdateID), pending);
+  if (pending != NULL)
+  {
+    HASH_DELETE(hh, shard->updates, pending);
+    freeToMemPool(self->pendingPool, pending);
+    __atomic_sub_fetch(&self->noPending, 1, __ATOMIC_SEQ_CST);
+  }
+  unlockMutex(&shard->mutex);
+
+  retVal = (pending != NULL) || _removeUpdate(self, updateID, prefix, as);
+  unlockMutex(&self->treeMutex);
+
+  return retVal;
+}
+
+/**
+ * Remove the given update from the prefix tree, see removeUpdate. The caller
+ * MUST hold the tree mutex.
+ *
+ * @param self The prefix cache.
+ * @param updateID The id of the update that has to be removed.
+ * @param prefix The prefix of the update.
+ * @param as The AS number of the update.
+ *
+ * @return true if the update could be removed.
+ */
+static bool _removeUpdate(PrefixCache* self, SRxUpdateID* updateID, 
+                          IPPrefix* prefix, uint32_t as)
+{
+  prefix_t*        lookupPrefix = ipPrefixToPrefix_t(prefix);
+  patricia_node_t* treeNode     = NULL;
+  PC_Prefix*       pcPrefix_Po  = NULL;
+  PC_Prefix*       pcPrefix     = NULL;
+  PC_Update*       pcUpdate     = NULL;
+  PC_AS*           pcAS         = NULL;
+  PC_ROA*          pcROA        = NULL;
+  SList*           list         = NULL;
+  SListNode*       asListNode;
+  SListNode*       roaListNode;
+
+  if (lookupPrefix == NULL)
+  {
+    RAISE_SYS_ERROR("Not enough memory to remove update [0x%08X]!", 
+                    *updateID);
+    return false;
+  }
+
+  WRITE_LOCK(&self->treeLock);
+  treeNode = patricia_search_exact(self->prefixTree, lookupPrefix);
+  free(lookupPrefix);
+
+  if ((treeNode == NULL) || (treeNode->data == NULL))
+  {
+    // The update was never validated (stored only).
+    UNLOCK_WRITE_LOCK(&self->treeLock);
+    return false;
+  }
+
+  pcPrefix_Po = (PC_Prefix*)treeNode->data;
+  list        = &pcPrefix_Po->valid;
+  pcUpdate    = _removeUpdate_find(list, *updateID);
+  if (pcUpdate == NULL)
+  {
+    list     = &pcPrefix_Po->other;
+    pcUpdate = _removeUpdate_find(list, *updateID);
+  }
+  if (pcUpdate == NULL)
+  {
+    UNLOCK_WRITE_LOCK(&self->treeLock);
+    return false;
+  }
+
+  // Release the ROAs that were counted during the validation of the update.
+  pcPrefix = pcPrefix_Po;
+  while ((pcUpdate->roa_match > 0) && (pcPrefix != NULL) 
+         && (pcPrefix->roa_coverage > 0))
+  {
+    FOREACH_SLIST(&pcPrefix->asn, asListNode)
+    {
+      pcAS = (PC_AS*)asListNode->data;
+      if (pcAS->asn != as)
+      {
+        continue;
+      }
+      FOREACH_SLIST(&pcAS->roas, roaListNode)
+      {
+        pcROA = (PC_ROA*)roaListNode->data;
+        if (   (pcPrefix_Po->treeNode->prefix->bitlen <= pcROA->max_len)
+            && (pcROA->update_count > 0))
+        {
+          pcROA->update_count--;
+        }
+      }
+    }
+    pcPrefix = getParent(pcPrefix->treeNode);
+  }
+
+  deleteFromSList(list, pcUpdate);
+  LOCK_MUTEX(&self->updatesMutex);
+  deleteFromSList(&self->updates, pcUpdate);
+  UNLOCK_MUTEX(&self->updatesMutex);
+  freeToMemPool(self->updatePool, pcUpdate);
+
+  // Now release the AS of the update if not needed anymore.
+  FOREACH_SLIST(&pcPrefix_Po->asn, asListNode)
+  {
+    pcAS = (PC_AS*)asListNode->data;
+    if (pcAS->asn == as)
+    {
+      if (pcAS->update_count > 0)
+      {
+        pcAS->update_count--;
+      }
+      if ((pcAS->update_count == 0) && (pcAS->roas.size == 0))
+      {
+        LOG(LEVEL_DEBUG, HDR "Remove AS from prefix!", pthread_self());
+        deleteFromSList(&pcPrefix_Po->asn, pcAS);
+        freeToMemPool(self->asPool, pcAS);
+      }
+      break;
+    }
+  }
+
+  UNLOCK_WRITE_LOCK(&self->treeLock);
+
   return true;
 }
 
@@ -905,33 +1262,21 @@ static void _addROAwl_moveMatchedUpdatesToValid(UpdateCache* updateCache,
                                                bool suppressNotification);
 
 /**
- * Add the given ROA white-list entry provided by the specified validation cache
- * with the given session id.
- * ROA white-list entries for ASNs specified in rfc5398 are ignored!
+ * Return the prefix of the prefix tree for the given ROA white-list prefix.
+ * The prefix is created if it does not exist yet. A new prefix inherits the
+ * state of other and the coverage of its parent prefixes.
+ *
+ * @note The caller must hold the tree write lock.
  *
  * @param self The prefix cache
- * @param originAS The origin AS of the ROA whitelist entry.
- * @param prefix The prefix of the ROA whitelist entry to be added
- * @param maxLen The max length of the ROA whitelist entry
- * @param session_id The session id of the validation cache session
- * @param valCacheID The validation cache ID
- * @param suppressNotification Allow to suppress calling the update modification 
- *                callback
+ * @param prefix The prefix of the ROA whitelist entry
  *
- * @return true if the ROA whitelist entry could be added - false most likely
- *         indicates a memory problem or rfc5398
+ * @return The prefix or NULL in case of an internal error.
+ *
+ * @since 0.6.2.2
  */
-bool addROAwl(PrefixCache* self, uint32_t originAS, IPPrefix* prefix,
-              uint8_t maxLen, uint32_t session_id, uint32_t valCacheID,
-              bool suppressNotification)
+static PC_Prefix* _addROAwl_getPrefix(PrefixCache* self, IPPrefix* prefix)
 {
-  if (belongsToRfc5398(originAS))
-  {
-    LOG(LEVEL_WARNING, "Ignore white-list entry for reserved ASV %u from "
-            "validation cache %u!", originAS, valCacheID);
-    return false;
-  }
-
   // the node within the prefix tree. the data of it is the PC_prefix
   // information.
   patricia_node_t* treeNode = NULL;
@@ -939,17 +1284,6 @@ bool addROAwl(PrefixCache* self, uint32_t originAS, IPPrefix* prefix,
   prefix_t*        lookupPrefix = ipPrefixToPrefix_t(prefix);
   // This is the prefix the algorithm runs on.
   PC_Prefix*       pcPrefix = NULL;
-  // The AS instance
-  PC_AS*           pcAS = NULL;
-  // The ROA instance
-  PC_ROA*          pcROA = NULL;
-  // The as list node
-  SListNode*      asListNode;
-  // The roa list node
-  SListNode*      roaListNode;
-
-
-  WRITE_LOCK(&self->treeLock);
 
   // Create or get the existing prefix node
   // Return the prefix tree element for the prefix in question. This lookup will
@@ -961,8 +1295,7 @@ bool addROAwl(PrefixCache* self, uint32_t originAS, IPPrefix* prefix,
   {
     RAISE_ERROR("Failed to append a prefix to the prefix tree");
     free(lookupPrefix);
-    UNLOCK_WRITE_LOCK(&self->treeLock);
-    return false;
+    return NULL;
   }
 
   // Already existed - need to free given prefix
@@ -974,12 +1307,15 @@ bool addROAwl(PrefixCache* self, uint32_t originAS, IPPrefix* prefix,
   if (treeNode->data == NULL)
   {
     // (Does P exist ? NO) - Created here
-    pcPrefix = malloc(sizeof(PC_Prefix));
+    pcPrefix = allocFromMemPool(self->prefixPool);
     pcPrefix->treeNode = treeNode;
     treeNode->data = pcPrefix;
     initSList(&pcPrefix->asn);
     initSList(&pcPrefix->other);
     initSList(&pcPrefix->valid);
+    indexSList(&pcPrefix->asn);
+    indexSList(&pcPrefix->other);
+    indexSList(&pcPrefix->valid);
     pcPrefix->roa_coverage = 0;
 
     // Exist less Specific P'
@@ -1003,37 +1339,59 @@ bool addROAwl(PrefixCache* self, uint32_t originAS, IPPrefix* prefix,
   }
   else
   {
-    // free(lookupPrefix); // prefix already existed. This instance is not used.
     pcPrefix = (PC_Prefix*)treeNode->data;
   }
 
-  if(pcPrefix!=NULL)
+  return pcPrefix;
+}
+
+/**
+ * Attach the ROA white-list entry to the given prefix and verify the updates
+ * of the prefix and its children.
+ *
+ * @note The caller must hold the tree write lock.
+ *
+ * @param self The prefix cache
+ * @param pcPrefix The prefix of the ROA whitelist entry
+ * @param originAS The origin AS of the ROA whitelist entry.
+ * @param maxLen The max length of the ROA whitelist entry
+ * @param valCacheID The validation cache ID
+ * @param suppressNotification Allow to suppress calling the update modification
+ *                callback
+ *
+ * @since 0.6.2.2
+ */
+static void _addROAwl_attach(PrefixCache* self, PC_Prefix* pcPrefix,
+                             uint32_t originAS, uint8_t maxLen,
+                             uint32_t valCacheID, bool suppressNotification)
+{
+  // The AS instance
+  PC_AS*           pcAS = NULL;
+  // The ROA instance
+  PC_ROA*          pcROA = NULL;
+  // The as list node
+  SListNode*      asListNode;
+  // The roa list node
+  SListNode*      roaListNode;
+
+  // IF P CONTAINS AS
+  FOREACH_SLIST(&pcPrefix->asn, asListNode)
   {
-      // IF P CONTAINS AS
-      FOREACH_SLIST(&pcPrefix->asn, asListNode)
-      {
-	  pcAS = (PC_AS*)asListNode->data;
-	  if (pcAS->asn == originAS)
-	  {
-	      break;
-	  }
-	  else
-	  {
-	      pcAS = NULL;
-	  }
-      }
-  } else{
-      RAISE_ERROR(" exist! --> patricia tree fetch error");
-      RAISE_ERROR(" STOP this point -- press any key");
-      getchar();
-      return false;
+    pcAS = (PC_AS*)asListNode->data;
+    if (pcAS->asn == originAS)
+    {
+      break;
+    }
+    else
+    {
+      pcAS = NULL;
+    }
   }
 
-
   if (pcAS == NULL)
   {
     // (P contains AS ? => No
-    pcAS = malloc(sizeof(PC_AS));
+    pcAS = allocFromMemPool(self->asPool);
     pcAS->asn = originAS;
     pcAS->update_count = 0;
     initSList(&pcAS->roas);
@@ -1061,7 +1419,7 @@ bool addROAwl(PrefixCache* self, uint32_t originAS, IPPrefix* prefix,
   }
   if (pcROA == NULL)
   {
-    pcROA = malloc(sizeof(PC_ROA));
+    pcROA = allocFromMemPool(self->roaPool);
     pcROA->valCacheID = valCacheID;
     pcROA->as = originAS;
     pcROA->max_len = maxLen;
@@ -1075,13 +1433,215 @@ bool addROAwl(PrefixCache* self, uint32_t originAS, IPPrefix* prefix,
     pcROA->roa_count++;
   }
   _addROAwl_verifyUpdates(self, pcPrefix, pcROA, suppressNotification);
+}
+
+/**
+ * Prepare the prefix tree for a ROA change. The first change after the index
+ * was published adds the pending updates to the prefix tree first, they were
+ * validated with the ROAs the prefix tree still holds. The caller MUST hold 
+ * the tree mutex.
+ *
+ * @param self The prefix cache
+ *
+ * @since 0.6.2.2
+ */
+static void _beginROAChange(PrefixCache* self)
+{
+  if (!self->roaChanged)
+  {
+    _drainPendingUpdates(self);
+    self->roaChanged = true;
+  }
+}
+
+/**
+ * Add the given ROA white-list entry provided by the specified validation cache
+ * with the given session id.
+ * ROA white-list entries for ASNs specified in rfc5398 are ignored!
+ *
+ * @param self The prefix cache
+ * @param originAS The origin AS of the ROA whitelist entry.
+ * @param prefix The prefix of the ROA whitelist entry to be added
+ * @param maxLen The max length of the ROA whitelist entry
+ * @param session_id The session id of the validation cache session
+ * @param valCacheID The validation cache ID
+ * @param suppressNotification Allow to suppress calling the update modification 
+ *                callback
+ *
+ * @return true if the ROA whitelist entry could be added - false most likely
+ *         indicates a memory problem or rfc5398
+ */
+bool addROAwl(PrefixCache* self, uint32_t originAS, IPPrefix* prefix,
+              uint8_t maxLen, uint32_t session_id, uint32_t valCacheID,
+              bool suppressNotification)
+{
+  if (belongsToRfc5398(originAS))
+  {
+    LOG(LEVEL_WARNING, "Ignore white-list entry for reserved ASV %u from "
+            "validation cache %u!", originAS, valCacheID);
+    return false;
+  }
+
+  // This is the prefix the algorithm runs on.
+  PC_Prefix* pcPrefix = NULL;
+
+  lockMutex(&self->treeMutex);
+  WRITE_LOCK(&self->treeLock);
+  _beginROAChange(self);
+
+  pcPrefix = _addROAwl_getPrefix(self, prefix);
+  if (pcPrefix == NULL)
+  {
+    UNLOCK_WRITE_LOCK(&self->treeLock);
+    unlockMutex(&self->treeMutex);
+    return false;
+  }
+  _addROAwl_attach(self, pcPrefix, originAS, maxLen, valCacheID, 
+                   suppressNotification);
   UNLOCK_WRITE_LOCK(&self->treeLock);
+  unlockMutex(&self->treeMutex);
 
   //printXML(self, "addROAwl");
 
   return true;
 }
 
+/**
+ * Order of the prefixes for the bulk load. The prefixes are sorted by address
+ * and prefix length, this places each prefix in front of all its more specific
+ * prefixes.
+ *
+ * @param prefix1 The first prefix
+ * @param prefix2 The second prefix
+ *
+ * @return < 0, 0, > 0 like memcmp
+ *
+ * @since 0.6.2.2
+ */
+static int _addROAwlBulk_comparePrefix(IPPrefix* prefix1, IPPrefix* prefix2)
+{
+  int retVal = (int)prefix1->ip.version - (int)prefix2->ip.version;
+
+  if (retVal == 0)
+  {
+    retVal = (prefix1->ip.version == 4)
+             ? memcmp(prefix1->ip.addr.v4.u8, prefix2->ip.addr.v4.u8, 
+                      sizeof(IPv4Address))
+             : memcmp(prefix1->ip.addr.v6.u8, prefix2->ip.addr.v6.u8, 
+                      sizeof(IPv6Address));
+  }
+  if (retVal == 0)
+  {
+    retVal = (int)prefix1->length - (int)prefix2->length;
+  }
+
+  return retVal;
+}
+
+/**
+ * Order of the ROA white-list entries for the bulk load, by prefix, origin AS,
+ * and max length.
+ *
+ * @param entry1 The first PC_ROAwlEntry
+ * @param entry2 The second PC_ROAwlEntry
+ *
+ * @return < 0, 0, > 0 like memcmp
+ *
+ * @since 0.6.2.2
+ */
+static int _addROAwlBulk_compare(const void* entry1, const void* entry2)
+{
+  PC_ROAwlEntry* roa1 = (PC_ROAwlEntry*)entry1;
+  PC_ROAwlEntry* roa2 = (PC_ROAwlEntry*)entry2;
+  int retVal = _addROAwlBulk_comparePrefix(&roa1->prefix, &roa2->prefix);
+
+  if (retVal == 0)
+  {
+    retVal = (roa1->originAS < roa2->originAS) ? -1 
+                                               : (roa1->originAS > roa2->originAS);
+  }
+  if (retVal == 0)
+  {
+    retVal = (int)roa1->maxLen - (int)roa2->maxLen;
+  }
+
+  return retVal;
+}
+
+/**
+ * Add the given ROA white-list entries provided by the specified validation
+ * cache at once. This is used for the initial synchronization with a cache.
+ * The entries are sorted and the tree is build in this order, each new prefix
+ * takes its coverage from the already complete parent prefixes and only the
+ * updates that were stored before are verified again. The tree write lock is
+ * acquired only once.
+ * ROA white-list entries for ASNs specified in rfc5398 are ignored!
+ *
+ * @param self The prefix cache
+ * @param entries The ROA white-list entries, the array will be sorted.
+ * @param count The number of entries.
+ * @param session_id The session id of the validation cache session
+ * @param valCacheID The validation cache ID
+ * @param suppressNotification Allow to suppress calling the update modification
+ *                callback
+ *
+ * @return The number of ROA white-list entries added.
+ *
+ * @since 0.6.2.2
+ */
+uint32_t addROAwlBulk(PrefixCache* self, PC_ROAwlEntry* entries, 
+                      uint32_t count, uint32_t session_id, uint32_t valCacheID,
+                      bool suppressNotification)
+{
+  PC_Prefix*     pcPrefix = NULL;
+  PC_ROAwlEntry* prev     = NULL;
+  uint32_t       added    = 0;
+  uint32_t       ignored  = 0;
+  uint32_t       idx;
+
+  qsort(entries, count, sizeof(PC_ROAwlEntry), _addROAwlBulk_compare);
+
+  lockMutex(&self->treeMutex);
+  WRITE_LOCK(&self->treeLock);
+  _beginROAChange(self);
+
+  for (idx = 0; idx < count; idx++)
+  {
+    if (belongsToRfc5398(entries[idx].originAS))
+    {
+      ignored++;
+      continue;
+    }
+
+    // Entries of the same prefix follow each other.
+    if ((prev == NULL) || (pcPrefix == NULL)
+        || (_addROAwlBulk_comparePrefix(&prev->prefix, 
+                                        &entries[idx].prefix) != 0))
+    {
+      pcPrefix = _addROAwl_getPrefix(self, &entries[idx].prefix);
+    }
+    prev = &entries[idx];
+
+    if (pcPrefix != NULL)
+    {
+      _addROAwl_attach(self, pcPrefix, entries[idx].originAS, 
+                       entries[idx].maxLen, valCacheID, suppressNotification);
+      added++;
+    }
+  }
+
+  UNLOCK_WRITE_LOCK(&self->treeLock);
+  unlockMutex(&self->treeMutex);
+
+  if (ignored > 0)
+  {
+    LOG(LEVEL_WARNING, "Ignored %u white-list entries for reserved ASNs from "
+            "validation cache %u!", ignored, valCacheID);
+  }
+
+  return added;
+}
+
 /**
  * this method moved up the prefix tree to check if a parent prefix holds a roa
  * that might cover this prefix. the walk up the tree can stop once a parent
@@ -1266,65 +1826,26 @@ static void _addROAwl_moveMatchedUpdatesToValid(UpdateCache* updateCache,
                                                 SList* otherList, PC_ROA* pcROA,
                                                 bool suppressNotification)
 {
-  SListNode* nodeToMove = NULL;
   SListNode* currNode = otherList->root;
-  SListNode* prevNode = NULL;
+  SListNode* nextNode;
   PC_Update* pcUpdate;
 
   // For each matched Update Do:
   while (currNode != NULL)
   {
+    // Advance in list to not loose the next pointer
+    nextNode = currNode->next;
     pcUpdate = (PC_Update*)currNode->data;
     if (pcUpdate->as == pcROA->as)
     {
-      nodeToMove = currNode;
       pcUpdate->roa_match++;
       pcROA->update_count++;
       notifyUpdateCacheForROAChange(updateCache, &pcUpdate->updateID,
                                     SRx_RESULT_VALID, suppressNotification);
+      // Move the node from other into the valid list
+      moveSListNode(validList, otherList, currNode, currNode->prev);
     }
-    else
-    {
-      prevNode = currNode;
-    }
-
-    // Advance in list to not loose the next pointer
-    currNode = currNode->next;
-
-    if (nodeToMove != NULL)
-    {
-      // Remove Node from Other
-      otherList->size--;
-      if (prevNode == NULL)
-      {
-        // Node was the List Head
-        otherList->root = nodeToMove->next;
-      }
-      else
-      {
-        prevNode->next = nodeToMove->next;
-      }
-
-      if (nodeToMove->next == NULL)
-      {
-        // Node was last node
-        otherList->last = prevNode;
-      }
-
-      // Now add it into valid list
-      validList->size++;
-      nodeToMove->next = NULL;
-      if (validList->root == NULL)
-      {
-        validList->root  = nodeToMove;
-      }
-      else
-      {
-        validList->last->next = nodeToMove;
-      }
-      validList->last = nodeToMove;
-      nodeToMove = NULL;
-    }
+    currNode = nextNode;
   }
 }
 
@@ -1339,6 +1860,10 @@ static void _delROAwl_validateUpdates(PrefixCache* self, PC_Prefix* pcPrefix,
 static void _delROAwl_moveToOther(UpdateCache* updateCache, PC_Prefix* pcPrefix,
                                   PC_ROA* pcROA, bool suppressNotification);
 
+static bool _delROAwl(PrefixCache* self, uint32_t originAS, IPPrefix* prefix,
+                     uint8_t maxLen, uint32_t valCacheID, 
+                     bool suppressNotification);
+
 /**
  * Delete the given ROA white-list entry provided by the specified validation
  * cache with the given session id.
@@ -1358,6 +1883,35 @@ static void _delROAwl_moveToOther(UpdateCache* updateCache, PC_Prefix* pcPrefix,
 bool delROAwl(PrefixCache* self, uint32_t originAS, IPPrefix* prefix,
               uint8_t maxLen, uint32_t session_id, uint32_t valCacheID,
               bool suppressNotification)
+{
+  bool retVal;
+
+  lockMutex(&self->treeMutex);
+  _beginROAChange(self);
+  retVal = _delROAwl(self, originAS, prefix, maxLen, valCacheID, 
+                     suppressNotification);
+  unlockMutex(&self->treeMutex);
+
+  return retVal;
+}
+
+/**
+ * Delete the given ROA white-list entry from the prefix tree, see delROAwl. 
+ * The caller MUST hold the tree mutex.
+ *
+ * @param self The prefix cache
+ * @param originAS The origin AS of the ROA white-list entry.
+ * @param prefix The prefix of the ROA white-list entry to be added
+ * @param maxLen The max length of the ROA white-list entry
+ * @param valCacheID The validation cache ID
+ * @param suppressNotification Allows to suppress calling the update 
+ *                        modification callback function. 
+ *
+ * @return true if the ROA white-list entry could be removed.
+ */
+static bool _delROAwl(PrefixCache* self, uint32_t originAS, IPPrefix* prefix,
+                     uint8_t maxLen, uint32_t valCacheID, 
+                     bool suppressNotification)
 {
   // the node within the prefix tree. the data of it is the PC_prefix
   // information.
@@ -1512,7 +2066,7 @@ bool delROAwl(PrefixCache* self, uint32_t originAS, IPPrefix* prefix,
   {
     LOG(LEVEL_DEBUG, HDR "Remove ROA entry!", pthread_self());
     deleteFromSList(&pcAS->roas, pcROA);
-    free(pcROA);
+    freeToMemPool(self->roaPool, pcROA);
 
     if (pcAS->roas.size == 0)
     {
@@ -1520,11 +2074,11 @@ bool delROAwl(PrefixCache* self, uint32_t originAS, IPPrefix* prefix,
       {
         LOG(LEVEL_DEBUG, HDR "Remove AS from prefix!", pthread_self());
         deleteFromSList(&pcPrefix->asn, pcAS);
-        free(pcAS);
+        freeToMemPool(self->asPool, pcAS);
 
         if (pcPrefix->asn.size == 0)
         {
-          free(pcPrefix);
+          freeToMemPool(self->prefixPool, pcPrefix);
           treeNode->data = NULL;
         }
       }
@@ -1621,14 +2175,14 @@ static void _delROAwl_validateUpdates(PrefixCache* self, PC_Prefix* pcPrefix,
 static void _delROAwl_moveToOther(UpdateCache* updateCache, PC_Prefix* pcPrefix,
                                   PC_ROA* pcROA, bool suppressNotification)
 {
-  SListNode* nodeToMove = NULL;
   SListNode* currNode = pcPrefix->valid.root;
-  SListNode* prevNode = NULL;
+  SListNode* nextNode;
   PC_Update* pcUpdate;
 
   // For each matched Update Do:
   while ((currNode != NULL) && (pcROA->update_count > 0))
   {
+    nextNode = currNode->next;
     pcUpdate = (PC_Update*)currNode->data;
     if (pcUpdate->as == pcROA->as)
     {
@@ -1648,54 +2202,114 @@ static void _delROAwl_moveToOther(UpdateCache* updateCache, PC_Prefix* pcPrefix,
 
       if (pcUpdate->roa_match == 0)
       {
-        nodeToMove = currNode;
         notifyUpdateCacheForROAChange(updateCache, &pcUpdate->updateID,
                                       pcPrefix->state_of_other, 
                                       suppressNotification);
+        // Move the node from valid into the other list
+        moveSListNode(&pcPrefix->other, &pcPrefix->valid, currNode, 
+                      currNode->prev);
       }
     }
-    else
+
+    currNode = nextNode;
+  }
+}
+
+/**
+ * Publish the ROAs of the prefix tree as ROA index for the validation of new
+ * updates. The updates validated with the previous index are added to the
+ * prefix tree afterwards, their result is updated if it changed.
+ *
+ * @param self The prefix cache
+ *
+ * @since 0.6.2.2
+ */
+void publishPrefixCacheIndex(PrefixCache* self)
+{
+  patricia_node_t* treeNode;
+  PC_Prefix*       pcPrefix;
+  PC_AS*           pcAS;
+  PC_ROA*          pcROA;
+  SListNode*       asListNode;
+  SListNode*       roaListNode;
+  IPPrefix         prefix;
+  ROAIndex*        index;
+  bool             built = true;
+  struct timespec  start, end;
+
+  lockMutex(&self->treeMutex);
+
+  if (self->roaChanged)
+  {
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    index = createROAIndex();
+    if (index == NULL)
     {
-      prevNode = currNode;
+      RAISE_SYS_ERROR("Not enough memory to build the ROA index!");
+      unlockMutex(&self->treeMutex);
+      return;
     }
 
-    currNode = currNode->next;
-
-    if (nodeToMove != NULL)
+    PATRICIA_WALK(self->prefixTree->head, treeNode)
     {
-      // Remove Node from Valid
-      pcPrefix->valid.size--;
-      if (prevNode == NULL)
-      {
-        // Node was the List Head
-        pcPrefix->valid.root = nodeToMove->next;
-      }
-      else
+      // Prefixes without ROAs might have no data left.
+      pcPrefix = (PC_Prefix*)treeNode->data;
+      if (pcPrefix != NULL)
       {
-        prevNode->next = nodeToMove->next;
-      }
+        memset(&prefix, 0, sizeof(IPPrefix));
+        prefix.length = treeNode->prefix->bitlen;
+        if (treeNode->prefix->family == AF_INET)
+        {
+          prefix.ip.version     = 4;
+          prefix.ip.addr.v4.u32 = treeNode->prefix->add.sin.s_addr;
+        }
+        else
+        {
+          prefix.ip.version = 6;
+          memcpy(&prefix.ip.addr.v6.in_addr, &treeNode->prefix->add.sin6,
+                 sizeof(IPv6Address));
+        }
 
-      if (nodeToMove->next == NULL)
-      {
-        // Node was last node
-        pcPrefix->valid.last = prevNode;
+        FOREACH_SLIST(&pcPrefix->asn, asListNode)
+        {
+          pcAS = (PC_AS*)asListNode->data;
+          FOREACH_SLIST(&pcAS->roas, roaListNode)
+          {
+            pcROA = (PC_ROA*)roaListNode->data;
+            if (pcROA->roa_count > 0)
+            {
+              built = addToROAIndex(index, &prefix, pcROA->max_len, pcAS->asn)
+                      && built;
+            }
+          }
+        }
       }
+    } PATRICIA_WALK_END;
 
-      // Now add it into other list
-      pcPrefix->other.size++;
-      nodeToMove->next = NULL;
-      if (pcPrefix->other.root == NULL)
-      {
-        pcPrefix->other.root  = nodeToMove;
-      }
-      else
-      {
-        pcPrefix->other.last->next = nodeToMove;
-      }
-      pcPrefix->other.last  = nodeToMove;
-      nodeToMove = NULL;
+    if (!built)
+    {
+      RAISE_SYS_ERROR("Not enough memory to build the ROA index!");
+      releaseROAIndex(index);
+      unlockMutex(&self->treeMutex);
+      return;
     }
+
+    finishROAIndex(index);
+    publishROAIndex(&self->roaIndex, index);
+    self->roaChanged = false;
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    LOG(LEVEL_INFO, "Published ROA index with %u IPv4 and %u IPv6 ROAs in "
+                    "%.3f s", sizeOfROAIndex(index, 4), 
+                    sizeOfROAIndex(index, 6),
+                    (end.tv_sec - start.tv_sec) 
+                    + (end.tv_nsec - start.tv_nsec) / 1e9);
   }
+
+  // Updates validated with the previous index.
+  _drainPendingUpdates(self);
+
+  unlockMutex(&self->treeMutex);
 }
 
 /**
@@ -1935,6 +2549,10 @@ void outputPrefixCacheAsXML(PrefixCache* self, FILE* stream)
   SListNode*  updateListNode;
   PC_Update*  pcUpdate;
 
+  // Show all updates in the prefix tree.
+  lockMutex(&self->treeMutex);
+  _drainPendingUpdates(self);
+
   initXMLOut(&out, stream);
   openTag(&out, "prefix-cache");
 
@@ -1981,6 +2599,7 @@ void outputPrefixCacheAsXML(PrefixCache* self, FILE* stream)
 
   closeTag(&out);
   releaseXMLOut(&out);
+  unlockMutex(&self->treeMutex);
 }
 
 /*-----------------------
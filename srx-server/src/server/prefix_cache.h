@@ -22,10 +22,18 @@
  *
  * Prefix Cache.
  *
- * @version 0.6.0.0
+ * @version 0.6.2.2
  *
  * Changelog:
  * -----------------------------------------------------------------------------
+ * 0.6.2.2  - 2026/10/17
+ *            * Pending updates are kept in a hash table per shard.
+ *            * New updates are validated with the published ROA index and
+ *              kept in sharded pending lists until they are added to the 
+ *              prefix tree. Added treeMutex and publishPrefixCacheIndex.
+ *            * Added PC_ROAwlEntry and addROAwlBulk.
+ *            * removeUpdate is implemented.
+ *            * Added memory pools for PC_Prefix, PC_AS, PC_ROA, and PC_Update.
  * 0.6.0.0  - 2021/02/26 - kyehwanl
  *            * Added ASPA_DBManager and AspaCache to RPKIHandler. 
  * 0.5.0.0  - 2017/07/06 - oborchert
@@ -56,12 +64,15 @@
 #define __PREFIX_CACHE_H__
 
 #include <stdio.h>
+#include <uthash.h>
 
 #define HAVE_IPV6
 #include <patricia.h>
  
+#include "server/roa_index.h"
 #include "server/update_cache.h"
 #include "shared/srx_defs.h"
+#include "util/mem_pool.h"
 #include "util/mutex.h"
 #include "util/prefix.h"
 #include "util/rwlock.h"
@@ -72,6 +83,21 @@
 /** Do not call the update change callback */
 #define PC_DO_SUPPRESS   true
 
+/** Number of shards of the pending updates */
+#define PC_UPDATE_SHARDS 16
+
+/**
+ * Updates that are validated with the ROA index but not yet added to the 
+ * prefix tree. The shard of an update is selected by its update id.
+ * 
+ * @since 0.6.2.2
+ */
+typedef struct {
+  Mutex mutex;
+  /** The hash table of PC_PendingUpdate by update id */
+  struct _PC_PendingUpdate* updates;
+} PC_UpdateShard;
+
 /**
  * A single Prefix Cache.
  */
@@ -87,8 +113,44 @@ typedef struct {
   RWLock            otherLock;
   RWLock            validLock;
   RWLock            asLock;
+
+  // Memory pools of the cache elements
+  MemPool*          prefixPool;
+  MemPool*          asPool;
+  MemPool*          roaPool;
+  MemPool*          updatePool;
+
+  /** Serializes the ROA changes and the update bookkeeping in the prefix 
+   * tree. (since 0.6.2.2) */
+  Mutex             treeMutex;
+  /** The ROAs of the prefix tree as of the last publication, used to
+   * validate new updates. */
+  ROAIndexDomain    roaIndex;
+  /** Indicates the ROAs changed since the last publication. */
+  bool              roaChanged;
+  /** Updates validated with the ROA index and not yet in the prefix tree. */
+  PC_UpdateShard    pending[PC_UPDATE_SHARDS];
+  /** The number of pending updates. */
+  uint32_t          noPending;
+  MemPool*          pendingPool;
 } PrefixCache;
 
+/**
+ * An update that is validated but not yet added to the prefix tree.
+ * 
+ * @since 0.6.2.2
+ */
+typedef struct _PC_PendingUpdate {
+  /** The id of the update in the update cache. */
+  SRxUpdateID    updateID;
+  /** The origin AS */
+  uint32_t       as;
+  /** The prefix of the update. */
+  IPPrefix       prefix;
+  /** The hash table of the shard */
+  UT_hash_handle hh;
+} PC_PendingUpdate;
+
 /**
  * Update with reference counter.
  */
@@ -160,6 +222,20 @@ typedef struct {
   uint32_t update_count;
 } PC_ROA;
 
+/**
+ * A ROA white-list entry staged for the bulk load.
+ * 
+ * @since 0.6.2.2
+ */
+typedef struct {
+  /** The prefix of the ROA white-list entry. */
+  IPPrefix prefix;
+  /** The origin AS of the ROA white-list entry. */
+  uint32_t originAS;
+  /** The max length of the ROA white-list entry. */
+  uint8_t  maxLen;
+} PC_ROAwlEntry;
+
 /**
  * Initializes an empty cache and creates a link to an existing Update Cache.
  *
@@ -178,6 +254,9 @@ void releasePrefixCache(PrefixCache* self);
 /**
  * Request the validation for an update received. The result will be stored in 
  * the update cache's update by calling its notification method.
+ * The update is validated with the ROA index published at the last 
+ * End-of-Data, this does not wait for ROA changes in progress. The update is
+ * added to the prefix tree before the next ROA change.
  * 
  * @param self The prefix cache
  * @param updateID the id of the update itself
@@ -192,8 +271,6 @@ bool requestUpdateValidation(PrefixCache* self, SRxUpdateID* updateID,
 /**
  * This method will remove the given update from the prefix cache.
  * 
- * NOT IMPLEMENTED PRIOR VERSION 0.3
- * 
  * @param self The prefix cache.
  * @param updateID The id of the update that has to be removed.
  * @param prefix The prefix of the update.
@@ -225,6 +302,29 @@ bool addROAwl(PrefixCache* self, uint32_t originAS, IPPrefix* prefix,
               uint8_t maxLen, uint32_t session_id, uint32_t valCacheID,
               bool suppressNotification);
 
+/**
+ * Add the given ROA white-list entries provided by the specified validation
+ * cache at once. This is used for the initial synchronization with a cache.
+ * The entries are sorted so each prefix is added before its more specific
+ * prefixes, the tree write lock is acquired only once.
+ * ROA white-list entries for ASNs specified in rfc5398 are ignored!
+ *
+ * @param self The prefix cache
+ * @param entries The ROA white-list entries, the array will be sorted.
+ * @param count The number of entries.
+ * @param session_id The session_id of the validation cache session 
+ * @param valCacheID The validation cache ID
+ * @param suppressNotification Allow to suppress calling the update modification 
+ *                callback
+ *
+ * @return The number of ROA white-list entries added.
+ *
+ * @since 0.6.2.2
+ */
+uint32_t addROAwlBulk(PrefixCache* self, PC_ROAwlEntry* entries, 
+                      uint32_t count, uint32_t session_id, uint32_t valCacheID,
+                      bool suppressNotification);
+
 /**
  * Add the given ROA white-list entry provided by the specified validation cache
  * with the given session id.
@@ -246,6 +346,17 @@ bool delROAwl(PrefixCache* self, uint32_t originAS, IPPrefix* prefix,
               uint8_t maxLen, uint32_t session_id, uint32_t valCacheID,
               bool suppressNotification);
 
+/**
+ * Publish the ROAs of the prefix tree as ROA index for the validation of new
+ * updates. The updates validated with the previous index are added to the
+ * prefix tree afterwards, their result is updated if it changed.
+ * 
+ * @param self The prefix cache
+ * 
+ * @since 0.6.2.2
+ */
+void publishPrefixCacheIndex(PrefixCache* self);
+
 /**
  * Remove all ROA whitelist entries from the given validation cache with the 
  * given session id value. Used for giving up a cache, executing a cache reset
@@ -0,0 +1,445 @@
+/**
+ * This software was developed at the National Institute of Standards and
+ * Technology by employees of the Federal Government in the course of
+ * their official duties. Pursuant to title 17 Section 105 of the United
+ * States Code this software is not subject to copyright protection and
+ * is in the public domain.
+ *
+ * NIST assumes no responsibility whatsoever for its use by other parties,
+ * and makes no guarantees, expressed or implied, about its quality,
+ * reliability, or any other characteristic.
+ *
+ * We would appreciate acknowledgment if the software is used.
+ *
+ * NIST ALLOWS FREE USE OF THIS SOFTWARE IN ITS "AS IS" CONDITION AND
+ * DISCLAIM ANY LIABILITY OF ANY KIND FOR ANY DAMAGES WHATSOEVER RESULTING
+ * FROM THE USE OF THIS SOFTWARE.
+ *
+ * This software might use libraries that are under GNU public license or
+ * other licenses. Please refer to the licenses of all libraries required
+ * by this software.
+ *
+ * Immutable ROA index used for the origin validation of new updates.
+ *
+ * @version 0.6.2.2
+ *
+ * Changelog:
+ * -----------------------------------------------------------------------------
+ * 0.6.2.2  - 2026/10/17
+ *            * Code created.
+ */
+#include <sched.h>
+#include <stdlib.h>
+#include <string.h>
+#include <arpa/inet.h>
+#include "server/roa_index.h"
+#include "util/log.h"
+
+/** Number of ROAs the arrays of an index grow by. */
+#define ROA_INDEX_BLOCK 65536
+/** Maximum prefix length of all address families. */
+#define ROA_INDEX_MAX_LEN MAX_PREFIX_LEN_v6
+
+/**
+ * A ROA of the index. The address is stored in host byte order, IPv4
+ * addresses in the upper 32 bits.
+ */
+typedef struct {
+  uint64_t addr[2];
+  uint32_t asn;
+  uint8_t  length;
+  uint8_t  maxLen;
+} ROAIndexEntry;
+
+/**
+ * The ROAs of one address family sorted by prefix length and address. The
+ * ROAs of each prefix length form one block.
+ */
+typedef struct {
+  ROAIndexEntry* roas;
+  uint32_t       count;
+  uint32_t       size;
+  /** The first ROA of each prefix length, start[len+1] ends the block. */
+  uint32_t       start[ROA_INDEX_MAX_LEN + 2];
+  /** The prefix lengths that have ROAs, ascending. */
+  uint8_t        lengths[ROA_INDEX_MAX_LEN + 1];
+  uint8_t        noLengths;
+} ROAIndexFamily;
+
+/**
+ * The ROA index, one family for IPv4 and one for IPv6.
+ */
+struct _ROAIndex {
+  ROAIndexFamily family[2];
+  bool           finished;
+};
+
+/**
+ * Store the address of the given prefix masked to the given length.
+ *
+ * @param prefix The prefix.
+ * @param length The number of bits to keep.
+ * @param addr OUT - The masked address.
+ */
+static void _getAddress(IPPrefix* prefix, uint8_t length, uint64_t* addr)
+{
+  int idx;
+
+  if (prefix->ip.version == 4)
+  {
+    addr[0] = (uint64_t)ntohl(prefix->ip.addr.v4.u32) << 32;
+    addr[1] = 0;
+  }
+  else
+  {
+    addr[0] = 0;
+    addr[1] = 0;
+    for (idx = 0; idx < 8; idx++)
+    {
+      addr[0] = (addr[0] << 8) | prefix->ip.addr.v6.u8[idx];
+      addr[1] = (addr[1] << 8) | prefix->ip.addr.v6.u8[idx + 8];
+    }
+  }
+
+  if (length <= 64)
+  {
+    addr[0] = (length == 0) ? 0 : addr[0] & (~0ULL << (64 - length));
+    addr[1] = 0;
+  }
+  else if (length < 128)
+  {
+    addr[1] &= ~0ULL << (128 - length);
+  }
+}
+
+/**
+ * Order of the ROAs in the index, by prefix length, address, and origin AS.
+ *
+ * @param entry1 The first ROAIndexEntry
+ * @param entry2 The second ROAIndexEntry
+ *
+ * @return < 0, 0, > 0 like memcmp
+ */
+static int _compareEntries(const void* entry1, const void* entry2)
+{
+  const ROAIndexEntry* roa1 = (const ROAIndexEntry*)entry1;
+  const ROAIndexEntry* roa2 = (const ROAIndexEntry*)entry2;
+
+  if (roa1->length != roa2->length)
+  {
+    return (int)roa1->length - (int)roa2->length;
+  }
+  if (roa1->addr[0] != roa2->addr[0])
+  {
+    return (roa1->addr[0] < roa2->addr[0]) ? -1 : 1;
+  }
+  if (roa1->addr[1] != roa2->addr[1])
+  {
+    return (roa1->addr[1] < roa2->addr[1]) ? -1 : 1;
+  }
+  if (roa1->asn != roa2->asn)
+  {
+    return (roa1->asn < roa2->asn) ? -1 : 1;
+  }
+  return (int)roa1->maxLen - (int)roa2->maxLen;
+}
+
+/**
+ * Create a new and empty ROA index. ROAs are added using addToROAIndex, the
+ * index can be used once finishROAIndex is called.
+ *
+ * @return The index or NULL if not enough memory is available.
+ */
+ROAIndex* createROAIndex()
+{
+  return calloc(1, sizeof(ROAIndex));
+}
+
+/**
+ * Release the ROA index. The index MUST NOT be published.
+ *
+ * @param self The ROA index (can be NULL).
+ */
+void releaseROAIndex(ROAIndex* self)
+{
+  if (self != NULL)
+  {
+    free(self->family[0].roas);
+    free(self->family[1].roas);
+    free(self);
+  }
+}
+
+/**
+ * Add the given ROA to the index.
+ *
+ * @param self The ROA index, not finished yet.
+ * @param prefix The prefix of the ROA.
+ * @param maxLen The max length of the ROA.
+ * @param asn The origin AS of the ROA.
+ *
+ * @return false if not enough memory is available.
+ */
+bool addToROAIndex(ROAIndex* self, IPPrefix* prefix, uint8_t maxLen,
+                   uint32_t asn)
+{
+  ROAIndexFamily* family = &self->family[prefix->ip.version == 4 ? 0 : 1];
+  ROAIndexEntry*  entry  = NULL;
+
+  if (self->finished)
+  {
+    RAISE_ERROR("ROA index is already finished!");
+    return false;
+  }
+
+  if (family->count == family->size)
+  {
+    entry = realloc(family->roas, (family->size + ROA_INDEX_BLOCK)
+                                  * sizeof(ROAIndexEntry));
+    if (entry == NULL)
+    {
+      RAISE_SYS_ERROR("Not enough memory to add more than %u ROAs to the ROA "
+                      "index!", family->count);
+      return false;
+    }
+    family->roas  = entry;
+    family->size += ROA_INDEX_BLOCK;
+  }
+
+  entry = &family->roas[family->count++];
+  _getAddress(prefix, prefix->length, entry->addr);
+  entry->asn    = asn;
+  entry->length = prefix->length;
+  entry->maxLen = maxLen;
+
+  return true;
+}
+
+/**
+ * Sort the ROAs of the index. No more ROAs can be added afterwards.
+ *
+ * @param self The ROA index.
+ */
+void finishROAIndex(ROAIndex* self)
+{
+  ROAIndexFamily* family;
+  uint32_t        idx;
+  int             fIdx, len;
+
+  for (fIdx = 0; fIdx < 2; fIdx++)
+  {
+    family = &self->family[fIdx];
+    qsort(family->roas, family->count, sizeof(ROAIndexEntry),
+          _compareEntries);
+
+    idx = 0;
+    family->noLengths = 0;
+    for (len = 0; len <= ROA_INDEX_MAX_LEN; len++)
+    {
+      family->start[len] = idx;
+      while ((idx < family->count) && (family->roas[idx].length == len))
+      {
+        idx++;
+      }
+      if (family->start[len] != idx)
+      {
+        family->lengths[family->noLengths++] = (uint8_t)len;
+      }
+    }
+    family->start[ROA_INDEX_MAX_LEN + 1] = idx;
+  }
+
+  self->finished = true;
+}
+
+/**
+ * Return the number of ROAs in the index.
+ *
+ * @param self The ROA index (can be NULL).
+ * @param version The IP version (4 or 6) or 0 for both.
+ *
+ * @return The number of ROAs.
+ */
+uint32_t sizeOfROAIndex(ROAIndex* self, uint8_t version)
+{
+  if (self == NULL)
+  {
+    return 0;
+  }
+  switch (version)
+  {
+    case 4:  return self->family[0].count;
+    case 6:  return self->family[1].count;
+    default: return self->family[0].count + self->family[1].count;
+  }
+}
+
+/**
+ * Validate the origin of the given prefix (RFC 6811). Each prefix length that
+ * has ROAs and does not exceed the length of the prefix is searched for the
+ * covering prefix.
+ *
+ * @param self The finished ROA index (can be NULL).
+ * @param prefix The prefix of the update.
+ * @param asn The origin AS of the update.
+ *
+ * @return SRx_RESULT_VALID, SRx_RESULT_INVALID, or SRx_RESULT_NOTFOUND.
+ */
+SRxValidationResultVal validateWithROAIndex(ROAIndex* self, IPPrefix* prefix,
+                                            uint32_t asn)
+{
+  SRxValidationResultVal result = SRx_RESULT_NOTFOUND;
+  ROAIndexFamily* family;
+  ROAIndexEntry*  roa;
+  uint64_t        addr[2];
+  uint32_t        low, high, mid;
+  int             lIdx;
+  uint8_t         len;
+
+  if ((self == NULL) || !self->finished)
+  {
+    return SRx_RESULT_NOTFOUND;
+  }
+
+  family = &self->family[prefix->ip.version == 4 ? 0 : 1];
+  for (lIdx = 0; lIdx < family->noLengths; lIdx++)
+  {
+    len = family->lengths[lIdx];
+    if (len > prefix->length)
+    {
+      break;
+    }
+
+    // Find the first ROA of the covering prefix in the block of this length.
+    _getAddress(prefix, len, addr);
+    low  = family->start[len];
+    high = family->start[len + 1];
+    while (low < high)
+    {
+      mid = low + (high - low) / 2;
+      roa = &family->roas[mid];
+      if (   (roa->addr[0] < addr[0])
+          || ((roa->addr[0] == addr[0]) && (roa->addr[1] < addr[1])))
+      {
+        low = mid + 1;
+      }
+      else
+      {
+        high = mid;
+      }
+    }
+
+    for (roa = &family->roas[low]; low < family->start[len + 1]; low++, roa++)
+    {
+      if ((roa->addr[0] != addr[0]) || (roa->addr[1] != addr[1]))
+      {
+        break;
+      }
+      if ((roa->asn == asn) && (prefix->length <= roa->maxLen))
+      {
+        return SRx_RESULT_VALID;
+      }
+      result = SRx_RESULT_INVALID;
+    }
+  }
+
+  return result;
+}
+
+/**
+ * Initialize the index domain without an index.
+ *
+ * @param self The index domain.
+ *
+ * @return false if the domain could not be initialized.
+ */
+bool initROAIndexDomain(ROAIndexDomain* self)
+{
+  memset(self, 0, sizeof(ROAIndexDomain));
+  return initMutex(&self->publishMutex);
+}
+
+/**
+ * Release the index domain including the published index. The domain MUST NOT
+ * have readers anymore.
+ *
+ * @param self The index domain.
+ */
+void releaseROAIndexDomain(ROAIndexDomain* self)
+{
+  releaseROAIndex(self->current);
+  self->current = NULL;
+  releaseMutex(&self->publishMutex);
+}
+
+/**
+ * Enter the domain as reader and return the published index. The index stays
+ * valid until leaveROAIndex is called. This function does not block.
+ *
+ * @param self The index domain.
+ * @param slot OUT - The reader slot that must be passed to leaveROAIndex.
+ *
+ * @return The published index, can be NULL.
+ */
+ROAIndex* enterROAIndex(ROAIndexDomain* self, int* slot)
+{
+  uint32_t epoch = __atomic_load_n(&self->epoch, __ATOMIC_SEQ_CST);
+
+  for (;;)
+  {
+    *slot = epoch & 1;
+    __atomic_fetch_add(&self->readers[*slot], 1, __ATOMIC_SEQ_CST);
+    // A publisher that switched the slot in between does not wait for this
+    // slot anymore - use the new slot.
+    uint32_t check = __atomic_load_n(&self->epoch, __ATOMIC_SEQ_CST);
+    if (check == epoch)
+    {
+      break;
+    }
+    __atomic_fetch_sub(&self->readers[*slot], 1, __ATOMIC_SEQ_CST);
+    epoch = check;
+  }
+
+  return __atomic_load_n(&self->current, __ATOMIC_SEQ_CST);
+}
+
+/**
+ * Leave the domain as reader. The index returned by enterROAIndex MUST NOT
+ * be used anymore.
+ *
+ * @param self The index domain.
+ * @param slot The reader slot returned by enterROAIndex.
+ */
+void leaveROAIndex(ROAIndexDomain* self, int slot)
+{
+  __atomic_fetch_sub(&self->readers[slot], 1, __ATOMIC_RELEASE);
+}
+
+/**
+ * Publish the given finished index. The previous index is released once all
+ * its readers left the domain.
+ *
+ * @param self The index domain.
+ * @param index The finished index.
+ */
+void publishROAIndex(ROAIndexDomain* self, ROAIndex* index)
+{
+  ROAIndex* previous;
+  uint32_t  epoch;
+
+  lockMutex(&self->publishMutex);
+
+  previous = __atomic_exchange_n(&self->current, index, __ATOMIC_SEQ_CST);
+  // New readers use the other slot, the readers of the previous index are
+  // all counted in the current slot.
+  epoch = __atomic_fetch_add(&self->epoch, 1, __ATOMIC_SEQ_CST);
+  while (__atomic_load_n(&self->readers[epoch & 1], __ATOMIC_ACQUIRE) != 0)
+  {
+    sched_yield();
+  }
+  self->publishes++;
+
+  unlockMutex(&self->publishMutex);
+
+  releaseROAIndex(previous);
+}
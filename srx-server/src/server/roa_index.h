@@ -0,0 +1,171 @@
+/**
+ * This software was developed at the National Institute of Standards and
+ * Technology by employees of the Federal Government in the course of
+ * their official duties. Pursuant to title 17 Section 105 of the United
+ * States Code this software is not subject to copyright protection and
+ * is in the public domain.
+ *
+ * NIST assumes no responsibility whatsoever for its use by other parties,
+ * and makes no guarantees, expressed or implied, about its quality,
+ * reliability, or any other characteristic.
+ *
+ * We would appreciate acknowledgment if the software is used.
+ *
+ * NIST ALLOWS FREE USE OF THIS SOFTWARE IN ITS "AS IS" CONDITION AND
+ * DISCLAIM ANY LIABILITY OF ANY KIND FOR ANY DAMAGES WHATSOEVER RESULTING
+ * FROM THE USE OF THIS SOFTWARE.
+ *
+ * This software might use libraries that are under GNU public license or
+ * other licenses. Please refer to the licenses of all libraries required
+ * by this software.
+ *
+ * Immutable ROA index used for the origin validation of new updates. The index
+ * holds the ROAs of each address family in one array sorted by prefix. Once
+ * build the index is not modified anymore, a changed ROA set is published as
+ * a new index.
+ *
+ * Readers access the published index without locks. The index domain counts
+ * the readers in two slots. A publisher swaps the index pointer, switches the
+ * slot for new readers and waits until the readers of the previous slot left
+ * before the previous index is released.
+ *
+ * @version 0.6.2.2
+ *
+ * Changelog:
+ * -----------------------------------------------------------------------------
+ * 0.6.2.2  - 2026/10/17
+ *            * Code created.
+ */
+
+#ifndef __ROA_INDEX_H__
+#define __ROA_INDEX_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "shared/srx_defs.h"
+#include "util/mutex.h"
+#include "util/prefix.h"
+
+/** An immutable ROA index, see createROAIndex. */
+typedef struct _ROAIndex ROAIndex;
+
+/**
+ * The domain an index is published in.
+ */
+typedef struct {
+  /** The published index (can be NULL) */
+  ROAIndex* current;
+  /** The parity selects the reader slot of new readers. */
+  uint32_t  epoch;
+  /** The number of readers in each slot. */
+  uint32_t  readers[2];
+  /** Serializes the publishers. */
+  Mutex     publishMutex;
+  /** The number of published indexes. */
+  uint32_t  publishes;
+} ROAIndexDomain;
+
+/**
+ * Create a new and empty ROA index. ROAs are added using addToROAIndex, the
+ * index can be used once finishROAIndex is called.
+ *
+ * @return The index or NULL if not enough memory is available.
+ */
+ROAIndex* createROAIndex();
+
+/**
+ * Release the ROA index. The index MUST NOT be published.
+ *
+ * @param self The ROA index (can be NULL).
+ */
+void releaseROAIndex(ROAIndex* self);
+
+/**
+ * Add the given ROA to the index.
+ *
+ * @param self The ROA index, not finished yet.
+ * @param prefix The prefix of the ROA.
+ * @param maxLen The max length of the ROA.
+ * @param asn The origin AS of the ROA.
+ *
+ * @return false if not enough memory is available.
+ */
+bool addToROAIndex(ROAIndex* self, IPPrefix* prefix, uint8_t maxLen,
+                   uint32_t asn);
+
+/**
+ * Sort the ROAs of the index. No more ROAs can be added afterwards.
+ *
+ * @param self The ROA index.
+ */
+void finishROAIndex(ROAIndex* self);
+
+/**
+ * Return the number of ROAs in the index.
+ *
+ * @param self The ROA index (can be NULL).
+ * @param version The IP version (4 or 6) or 0 for both.
+ *
+ * @return The number of ROAs.
+ */
+uint32_t sizeOfROAIndex(ROAIndex* self, uint8_t version);
+
+/**
+ * Validate the origin of the given prefix (RFC 6811).
+ *
+ * @param self The finished ROA index (can be NULL).
+ * @param prefix The prefix of the update.
+ * @param asn The origin AS of the update.
+ *
+ * @return SRx_RESULT_VALID, SRx_RESULT_INVALID, or SRx_RESULT_NOTFOUND.
+ */
+SRxValidationResultVal validateWithROAIndex(ROAIndex* self, IPPrefix* prefix,
+                                            uint32_t asn);
+
+/**
+ * Initialize the index domain without an index.
+ *
+ * @param self The index domain.
+ *
+ * @return false if the domain could not be initialized.
+ */
+bool initROAIndexDomain(ROAIndexDomain* self);
+
+/**
+ * Release the index domain including the published index. The domain MUST NOT
+ * have readers anymore.
+ *
+ * @param self The index domain.
+ */
+void releaseROAIndexDomain(ROAIndexDomain* self);
+
+/**
+ * Enter the domain as reader and return the published index. The index stays
+ * valid until leaveROAIndex is called. This function does not block.
+ *
+ * @param self The index domain.
+ * @param slot OUT - The reader slot that must be passed to leaveROAIndex.
+ *
+ * @return The published index, can be NULL.
+ */
+ROAIndex* enterROAIndex(ROAIndexDomain* self, int* slot);
+
+/**
+ * Leave the domain as reader. The index returned by enterROAIndex MUST NOT
+ * be used anymore.
+ *
+ * @param self The index domain.
+ * @param slot The reader slot returned by enterROAIndex.
+ */
+void leaveROAIndex(ROAIndexDomain* self, int slot);
+
+/**
+ * Publish the given finished index. The previous index is released once all
+ * its readers left the domain.
+ *
+ * @param self The index domain.
+ * @param index The finished index.
+ */
+void publishROAIndex(ROAIndexDomain* self, ROAIndex* index);
+
+#endif // !__ROA_INDEX_H__
@@ -22,10 +22,20 @@
  *
  * This handler processes ROA validation
  *
- * @version 0.6.2.1
+ * @version 0.6.2.2
  *
  * Changelog:
  * -----------------------------------------------------------------------------
+ * 0.6.2.2  - 2026/10/17
+ *            * Added handlePrefixBatch to receive the prefixes in batches.
+ *            * End-of-Data publishes the ROA index of the prefix cache.
+ *            * ROA white-list entries of a full synchronization are staged and
+ *              added to the prefix cache at once at End-of-Data. The time of 
+ *              the synchronization is logged.
+ *            * ASPA changes mark the affected AS paths dirty, End-of-Data only
+ *              re-validates those paths.
+ *            * End-of-Data drains the RPKI queue in batches and validates the
+ *              BGPsec paths of key changes using one batch validation.
  * 0.6.2.1  - 2024/09/10 - oborchert
  *            * Changed data types from u_int... to uint... which follows C99
  *            * Added protocol version check to handleEndOfData regarding
@@ -102,6 +112,12 @@
 #define DEFAULT_FLAGS   0x0
 /** Keep the connection upon an error */
 #define KEEP_CONNECTION true
+/** Number of RPKI queue elements processed at once during End-of-Data 
+ * @since 0.6.2.2 */
+#define EOD_BATCH_SIZE  64
+/** Number of ROA white-list entries the staging array grows by during a full
+ * synchronization. @since 0.6.2.2 */
+#define ROA_STAGE_BLOCK 65536
 
 #define HDR "([0x%08X] RPKI Handler): "
 
@@ -117,6 +133,9 @@
 static void handlePrefix (uint32_t valCacheID, uint16_t session_id,
                           bool isAnn, IPPrefix* prefix, uint16_t maxLen,
                           uint32_t oas, void* rpkiHandler);
+static void handlePrefixBatch (uint32_t valCacheID, uint16_t session_id,
+                               RPKIPrefixRecord* records, uint32_t count,
+                               void* rpkiHandler);
 static void handleReset (uint32_t valCacheID, void* rpkiHandler);
 static bool handleError (uint16_t errNo, const char* msg, void* rpkiHandler);
 static int  handleConnection (void* rpkiHandler);
@@ -125,6 +144,12 @@ static void handleRouterKey (uint32_t valCacheID, uint16_t session_id,
                              const char* keyInfo, void* rpkiHandler);
 static void handleEndOfData (uint32_t valCacheID, uint16_t session_id,
                              void* rpkiHandler);
+static void handleCacheResponse (uint32_t valCacheID, uint16_t session_id,
+                                 bool fullSync, void* rpkiHandler);
+static bool stageROAwl(RPKIHandler* handler, uint32_t oas, IPPrefix* prefix,
+                       uint16_t maxLen);
+static uint32_t loadStagedROAwl(RPKIHandler* handler, uint32_t valCacheID,
+                                uint16_t session_id);
 static void handleAspaPdu (uint32_t valCacheID, uint16_t session_id, 
                            bool isAnn, uint32_t customerAsn, 
                            uint16_t providerAsCount, uint32_t* providerAsns, 
@@ -154,12 +179,14 @@ bool createRPKIHandler (RPKIHandler* handler, PrefixCache* prefixCache,
 
   // Create the RPKI/Router protocol client instance
   handler->rrclParams.prefixCallback     = handlePrefix;
+  handler->rrclParams.prefixBatchCallback = handlePrefixBatch;
   handler->rrclParams.resetCallback      = handleReset;
   handler->rrclParams.errorCallback      = handleError;
   handler->rrclParams.routerKeyCallback  = handleRouterKey;
   handler->rrclParams.connectionCallback = handleConnection;
   handler->rrclParams.aspaCallback       = handleAspaPdu;
   handler->rrclParams.endOfDataCallback  = handleEndOfData;
+  handler->rrclParams.cacheResponseCallback = handleCacheResponse;
 
   handler->rrclParams.serverHost         = serverHost;
   handler->rrclParams.serverPort         = serverPort;
@@ -169,6 +196,11 @@ bool createRPKIHandler (RPKIHandler* handler, PrefixCache* prefixCache,
   handler->rrclParams.retryInterval      = 0;
   handler->rrclParams.expireInterval     = 0;
 
+  handler->bulkLoad    = false;
+  handler->staged      = NULL;
+  handler->stagedCount = 0;
+  handler->stagedSize  = 0;
+
   if (!createRPKIRouterClient(&handler->rrclInstance, &handler->rrclParams,
                                handler))
   {
@@ -188,6 +220,13 @@ void releaseRPKIHandler(RPKIHandler* handler)
   if (handler != NULL)
   {
     releaseRPKIRouterClient(&handler->rrclInstance);
+    if (handler->staged != NULL)
+    {
+      free(handler->staged);
+      handler->staged = NULL;
+    }
+    handler->stagedCount = 0;
+    handler->stagedSize  = 0;
   }
 }
 
@@ -226,6 +265,15 @@ static void handlePrefix (uint32_t valCacheID, uint16_t session_id,
         ipPrefixToStr(prefix, prefixBuf, MAX_PREFIX_STR_LEN_V6), maxLen,
         valCacheID, session_id);
 
+    // During a full synchronization the entry is staged for the bulk load.
+    if (isAnn && handler->bulkLoad && stageROAwl(handler, oas, prefix, maxLen))
+    {
+      return;
+    }
+
+    // Stay in order with the already staged entries.
+    loadStagedROAwl(handler, valCacheID, session_id);
+
     // This method takes care of the received white list prefix/origin entry.
     if (isAnn)
     {
@@ -244,6 +292,144 @@ static void handlePrefix (uint32_t valCacheID, uint16_t session_id,
   }
 }
 
+/**
+ * This method handles the prefix announcements and withdrawals received in a
+ * row by the RPKI cache. Each entry is processed in the received order, see
+ * handlePrefix.
+ *
+ * @param valCacheID The id of the validation cache.
+ * @param session_id the id of the session id value. (NETWORK ORDER)
+ * @param records The prefix announcements and withdrawals.
+ * @param count The number of records.
+ * @param rpkiHandler the RPKI handler of the prefix that points to the prefix
+ *                    cache.
+ *
+ * @since 0.6.2.2
+ */
+static void handlePrefixBatch (uint32_t valCacheID, uint16_t session_id,
+                               RPKIPrefixRecord* records, uint32_t count,
+                               void* rpkiHandler)
+{
+  uint32_t idx;
+
+  for (idx = 0; idx < count; idx++)
+  {
+    handlePrefix(valCacheID, session_id, records[idx].isAnn, 
+                 &records[idx].prefix, records[idx].maxLen, records[idx].oas,
+                 rpkiHandler);
+  }
+}
+
+/**
+ * Stage the ROA white-list entry for the bulk load at End-of-Data.
+ *
+ * @param handler The RPKI handler.
+ * @param oas The origin AS
+ * @param prefix The prefix itself
+ * @param maxLen The maximum length for this prefix
+ *
+ * @return false if no memory is available for the entry.
+ *
+ * @since 0.6.2.2
+ */
+static bool stageROAwl(RPKIHandler* handler, uint32_t oas, IPPrefix* prefix,
+                       uint16_t maxLen)
+{
+  if (handler->stagedCount == handler->stagedSize)
+  {
+    PC_ROAwlEntry* staged = realloc(handler->staged, 
+                                    (handler->stagedSize + ROA_STAGE_BLOCK)
+                                    * sizeof(PC_ROAwlEntry));
+    if (staged == NULL)
+    {
+      LOG(LEVEL_WARNING, HDR "Not enough memory to stage more than %u ROA "
+                         "white-list entries!", pthread_self(), 
+                         handler->stagedCount);
+      return false;
+    }
+    handler->staged      = staged;
+    handler->stagedSize += ROA_STAGE_BLOCK;
+  }
+
+  PC_ROAwlEntry* entry = &handler->staged[handler->stagedCount++];
+  entry->prefix   = *prefix;
+  entry->originAS = oas;
+  entry->maxLen   = (uint8_t)maxLen;
+
+  return true;
+}
+
+/**
+ * Add all staged ROA white-list entries to the prefix cache and release the
+ * staging array.
+ *
+ * @param handler The RPKI handler.
+ * @param valCacheID The id of the validation cache.
+ * @param session_id the id of the session id value. (NETWORK ORDER)
+ *
+ * @return The number of ROA white-list entries added.
+ *
+ * @since 0.6.2.2
+ */
+static uint32_t loadStagedROAwl(RPKIHandler* handler, uint32_t valCacheID,
+                                uint16_t session_id)
+{
+  uint32_t added = 0;
+
+  if (handler->staged != NULL)
+  {
+    added = addROAwlBulk(handler->prefixCache, handler->staged, 
+                         handler->stagedCount, session_id, valCacheID, 
+                         PC_DO_SUPPRESS);
+    free(handler->staged);
+    handler->staged = NULL;
+  }
+  handler->stagedCount = 0;
+  handler->stagedSize  = 0;
+
+  return added;
+}
+
+/**
+ * Handle the cache response of the validation cache. The response to a reset
+ * query starts the full synchronization, its ROA white-list entries are staged
+ * and added to the prefix cache at once at End-of-Data.
+ *
+ * @param valCacheID The id of the validation cache.
+ * @param session_id the id of the session id value. (NETWORK ORDER)
+ * @param fullSync true if the cache sends its complete data.
+ * @param rpkiHandler the RPKI handler of the prefix that points to the prefix
+ *                    cache.
+ *
+ * @since 0.6.2.2
+ */
+static void handleCacheResponse (uint32_t valCacheID, uint16_t session_id,
+                                 bool fullSync, void* rpkiHandler)
+{
+  if (rpkiHandler != NULL)
+  {
+    RPKIHandler* handler = (RPKIHandler*)rpkiHandler;
+
+    // Entries of an interrupted synchronization are incomplete.
+    if (handler->stagedCount > 0)
+    {
+      LOG(LEVEL_WARNING, HDR "Drop %u ROA white-list entries of an incomplete "
+                         "synchronization!", pthread_self(), 
+                         handler->stagedCount);
+      handler->stagedCount = 0;
+    }
+    handler->bulkLoad = fullSync;
+    if (fullSync)
+    {
+      clock_gettime(CLOCK_MONOTONIC, &handler->syncStart);
+    }
+  }
+  else
+  {
+    LOG(LEVEL_ERROR, "Called handleCacheResponse with missing rpkiHandler!");
+  }
+}
+
 /**
  * Handle the reset for the prefix cache.
  *
@@ -279,7 +465,7 @@ static void handleEndOfData (uint32_t valCacheID, uint16_t session_id,
     RPKIHandler* handler = (RPKIHandler*)rpkiHandler;
 
     RPKI_QUEUE*      rQueue = getRPKIQueue();
-    RPKI_QUEUE_ELEM  queueElem;
+    RPKI_QUEUE_ELEM  queueElem[EOD_BATCH_SIZE];
     SRxResult        srxRes;
     SRxDefaultResult defaultRes;
     
@@ -287,6 +473,35 @@ static void handleEndOfData (uint32_t valCacheID, uint16_t session_id,
 
     UpdateCache*     uCache = handler->prefixCache->updateCache;
     SRxUpdateID*     uID = NULL;
+
+    BGPSecHandler*   bgpsecHandler = NULL;
+    UC_UpdateData*   bgpsecData[EOD_BATCH_SIZE];
+    uint8_t          bgpsecRes[EOD_BATCH_SIZE];
+    int              bgpsecIdx[EOD_BATCH_SIZE];
+    int              noBGPsec = 0;
+    int              noElem   = 0;
+    int              idx      = 0;
+
+    bool             fullSync = handler->bulkLoad;
+    uint32_t         noROAs   = 0;
+    struct timespec  now;
+    double           syncTime = 0;
+    double           loadTime = 0;
+
+    if (fullSync)
+    {
+      // Build the prefix tree of the full synchronization in one pass, the 
+      // affected updates are re-validated with the RPKI Queue below.
+      handler->bulkLoad = false;
+      noROAs = loadStagedROAwl(handler, valCacheID, session_id);
+      clock_gettime(CLOCK_MONOTONIC, &now);
+      loadTime = (now.tv_sec - handler->syncStart.tv_sec)
+                 + (now.tv_nsec - handler->syncStart.tv_nsec) / 1e9;
+    }
+
+    // New updates are validated with the ROAs of this End-of-Data from now
+    // on, the updates validated meanwhile are added to the prefix tree.
+    publishPrefixCacheIndex(handler->prefixCache);
       
     LOG(LEVEL_INFO, "Received an end of data, process RPKI Queue:\n");
 
@@ -295,88 +510,143 @@ static void handleEndOfData (uint32_t valCacheID, uint16_t session_id,
     // @TODO: Use the refresh, retry, and expire intervals as specified.
     // This also might be done by the PDU packet handler. Regardless, the 
     // timing data is stored in handler->rrclParams
-      process_ASPA_EndOfData(uCache, handler->aspaDBManager->cbProcessEndOfData, 
-                             rpkiHandler);
+      // Only re-validate the AS paths affected by the ASPA changes.
+      uint32_t  noPaths = 0;
+      uint32_t* pathIds = takeDirtyAspaths(handler->aspathCache, 
+                                     ntohl(handler->rrclInstance.serial), 
+                                     &noPaths);
+      uint32_t  noUpdates = process_ASPA_EndOfData(uCache, 
+                                     handler->aspaDBManager->cbProcessEndOfData, 
+                                     rpkiHandler, pathIds, noPaths);
+      AspathRevalStats* stats = &handler->aspathCache->stats;
+      LOG(LEVEL_INFO, "ASPA re-validation for serial %u: %u ASPA change(s), "
+                      "%u path(s) touched, %u path(s) changed, %u update(s) "
+                      "changed", stats->lastSerial, stats->lastAsnChanges, 
+                      noPaths, stats->lastChangedPaths, noUpdates);
+      if (pathIds != NULL)
+      {
+        free(pathIds);
+      }
     }
 
-    while (rq_dequeue(rQueue, &queueElem))
+    do
     {
-      uID = &queueElem.updateID;
-      valRes.updateID = queueElem.updateID;
-      valRes.valType  = VRT_NONE;
-      valRes.valResult.roaResult    = SRx_RESULT_DONOTUSE;
-      valRes.valResult.bgpsecResult = SRx_RESULT_DONOTUSE;
-      valRes.valResult.aspaResult   = SRx_RESULT_DONOTUSE;
-      
-      if ((queueElem.reason & RQ_ROA) == RQ_ROA)
+      // Dequeue the next batch and collect all updates that require BGPsec
+      // path validation. These are validated using one batch validation.
+      noElem   = 0;
+      noBGPsec = 0;
+      while ((noElem < EOD_BATCH_SIZE) 
+             && rq_dequeue(rQueue, &queueElem[noElem]))
       {
-        if (getUpdateResult(uCache, uID, 0, NULL, &srxRes, &defaultRes, NULL))
+        bgpsecIdx[noElem] = -1;
+        if ((queueElem[noElem].reason & RQ_KEY) == RQ_KEY)
         {
-          valRes.valType |= VRT_ROA;
-          valRes.valResult.roaResult = srxRes.roaResult;
+          uID = &queueElem[noElem].updateID;
+          UC_UpdateData* updateData = getUpdateData(uCache, uID);
+          if ((updateData != NULL) && (updateData->bgpsec_path != NULL))
+          {
+            bgpsecIdx[noElem]      = noBGPsec;
+            bgpsecData[noBGPsec++] = updateData;
+          }
+          else
+          {
+            LOG(LEVEL_ERROR, "Update 0x%08X is registered for BGPsec but the "
+                            "BGPsec_PATH attribute is not stored!", *uID);
+          }
+        }
+        noElem++;
+      }
+
+      if (noBGPsec > 0)
+      {
+        bgpsecHandler = getBGPsecHandler();
+        if (bgpsecHandler != NULL)
+        {
+          validateSignatures(bgpsecHandler, noBGPsec, bgpsecData, 
+                             bgpsecRes);
         }
         else
         {
-          LOG(LEVEL_WARNING, "Update 0x%08X not found during de-queuing of RPKI "
-                            "QUEUE!", queueElem.updateID);
+          RAISE_ERROR("BGPSecHAndler could not be retrieved!!");
         }
       }
-      // Now check for BGPSEC path Validation
-      if ((queueElem.reason & RQ_KEY) == RQ_KEY)
+
+      for (idx = 0; idx < noElem; idx++)
       {
-        UC_UpdateData* updateData = getUpdateData(uCache, uID);
-        SCA_BGP_PathAttribute* bgpsec_path = updateData->bgpsec_path;
-        if (bgpsec_path != NULL)
+        uID = &queueElem[idx].updateID;
+        valRes.updateID = queueElem[idx].updateID;
+        valRes.valType  = VRT_NONE;
+        valRes.valResult.roaResult    = SRx_RESULT_DONOTUSE;
+        valRes.valResult.bgpsecResult = SRx_RESULT_DONOTUSE;
+        valRes.valResult.aspaResult   = SRx_RESULT_DONOTUSE;
+
+        if ((queueElem[idx].reason & RQ_ROA) == RQ_ROA)
         {
-          BGPSecHandler* bgpsecHandler = getBGPsecHandler();
-          if (bgpsecHandler != NULL)
+          if (getUpdateResult(uCache, uID, 0, NULL, &srxRes, &defaultRes, 
+                              NULL))
           {
-            valRes.valType |= VRT_BGPSEC;
-            valRes.valResult.bgpsecResult = validateSignature(bgpsecHandler, 
-                                                              updateData);
+            valRes.valType |= VRT_ROA;
+            valRes.valResult.roaResult = srxRes.roaResult;
           }
           else
           {
-            RAISE_ERROR("BGPSecHAndler could not be retrieved!!");
+            LOG(LEVEL_WARNING, "Update 0x%08X not found during de-queuing of "
+                               "RPKI QUEUE!", queueElem[idx].updateID);
           }
         }
-        else
+        // Now check for BGPSEC path Validation
+        if ((bgpsecIdx[idx] != -1) && (bgpsecHandler != NULL))
         {
-          LOG(LEVEL_ERROR, "Update 0x%08X is registered for BGPsec but the "
-                          "BGPsec_PATH attribute is not stored!", *uID);
+          valRes.valType |= VRT_BGPSEC;
+          valRes.valResult.bgpsecResult = bgpsecRes[bgpsecIdx[idx]];
         }
-      }
-      
-      // Here check for ASPA Validation which was registered 
-      if ((queueElem.reason & RQ_ASPA) == RQ_ASPA)
-      {
-        LOG(LEVEL_INFO, FILE_LINE_INFO " called for ASPA dequeue [uID: %08X] ", *uID);
-        uint32_t pathId= 0;
-        if (getUpdateResult(uCache, uID, 0, NULL, &srxRes, &defaultRes, &pathId))
+
+        // Here check for ASPA Validation which was registered 
+        if ((queueElem[idx].reason & RQ_ASPA) == RQ_ASPA)
+        {
+          LOG(LEVEL_INFO, FILE_LINE_INFO " called for ASPA dequeue "
+                          "[uID: %08X] ", *uID);
+          uint32_t pathId= 0;
+          if (getUpdateResult(uCache, uID, 0, NULL, &srxRes, &defaultRes, 
+                              &pathId))
+          {
+            valRes.valType |= VRT_ASPA;
+            valRes.valResult.aspaResult = srxRes.aspaResult;
+          }
+          else
+          {
+            LOG(LEVEL_WARNING, "Update 0x%08X not found during de-queuing of "
+                               "RPKI QUEUE!", queueElem[idx].updateID);
+          }
+        }
+
+        if (uCache->resChangedCallback != NULL)
         {
-          valRes.valType |= VRT_ASPA;
-          valRes.valResult.aspaResult = srxRes.aspaResult;
+          // Notify of the change of validation result. 
+          // (call handleUpdateResultChange)
+          uCache->resChangedCallback(&valRes);     
         }
         else
         {
-          LOG(LEVEL_WARNING, "Update 0x%08X not found during de-queuing of RPKI "
-              "QUEUE!", queueElem.updateID);
+          RAISE_ERROR("No resChangedCallback function registered!\n"
+                      "Cannot propagate the changes of the validation result!\n"
+                      "Abort operation!");
+          rq_empty(rQueue);
+          noElem = 0;
+          break;
         }
       }
-      
-      if (uCache->resChangedCallback != NULL)
-      {
-        // Notify of the change of validation result. (call handleUpdateResultChange)
-        uCache->resChangedCallback(&valRes);     
-      }
-      else
-      {
-        RAISE_ERROR("No resChangedCallback function registered!\n"
-                    "Cannot propagate the changes of the validation result!\n"
-                    "Abort operation!");
-        rq_empty(rQueue);
-        break;
-      }
+    } while (noElem == EOD_BATCH_SIZE);
+
+    if (fullSync)
+    {
+      clock_gettime(CLOCK_MONOTONIC, &now);
+      syncTime = (now.tv_sec - handler->syncStart.tv_sec)
+                 + (now.tv_nsec - handler->syncStart.tv_nsec) / 1e9;
+      LOG(LEVEL_INFO, "Synchronized %u ROA white-list entries with validation "
+                      "cache 0x%08X in %.3f s (%.0f ROAs/s), prefix cache "
+                      "ready after %.3f s", noROAs, valCacheID, syncTime,
+                      syncTime > 0 ? noROAs / syncTime : 0.0, loadTime);
     }
   }
   else
@@ -589,7 +859,7 @@ static void handleAspaPdu (uint32_t valCacheID, uint16_t session_id,
                                     "ASPA object(s) into DB");
     ASPA_DBManager* aspaDBManager = handler->aspaDBManager;
     
-    TrieNode *node = NULL;
+    ASPA_DBEntry *node = NULL;
     ASPA_Object *aspaObj = NULL;
 
     char strWord[12];
@@ -616,6 +886,8 @@ static void handleAspaPdu (uint32_t valCacheID, uint16_t session_id,
                                 NO_AFI);
         // Here check if an existing record gets updated or not.
         node = insertAspaObj(aspaDBManager, strWord, strWord, aspaObj);
+        // Only paths that contain the customer can be affected.
+        markAspathsDirty(handler->aspathCache, customerAsn);
       }
     }
     else 
@@ -635,6 +907,7 @@ static void handleAspaPdu (uint32_t valCacheID, uint16_t session_id,
         if (resWithdraw)
         {
           LOG(LEVEL_INFO, "[Withdraw] Withdraw executed successfully");
+          markAspathsDirty(handler->aspathCache, customerAsn);
         }
         else
         {
@@ -20,10 +20,13 @@
  * other licenses. Please refer to the licenses of all libraries required
  * by this software.
  *
- * @version 0.6.2.1
+ * @version 0.6.2.2
  *
  * Changelog:
  * -----------------------------------------------------------------------------
+ * 0.6.2.2  - 2026/10/17
+ *            * Added the staging of ROA white-list entries for the bulk load
+ *              during a full synchronization.
  * 0.6.2.1  - 2024/09/08 - oborchert
  *            * To reduce confusion and errors in the code, all "void* user" 
  *              declarations are chaned into "RPKIHandler* rpkihandler". That is 
@@ -65,6 +68,18 @@ typedef struct {
   RPKIRouterClient        rrclInstance;
   ASPA_DBManager*         aspaDBManager;
   AspathCache*            aspathCache;
+
+  /** Indicates that a full synchronization stages the ROA white-list entries 
+   * for the bulk load at End-of-Data. (since 0.6.2.2) */
+  bool                    bulkLoad;
+  /** The staged ROA white-list entries. */
+  PC_ROAwlEntry*          staged;
+  /** The number of staged ROA white-list entries. */
+  uint32_t                stagedCount;
+  /** The capacity of the staged array. */
+  uint32_t                stagedSize;
+  /** The start of the synchronization. */
+  struct timespec         syncStart;
 } RPKIHandler;
 
 /**
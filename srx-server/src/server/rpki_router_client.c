@@ -22,10 +22,17 @@
  *
  * Provides the code for the SRX-RPKI router client connection.
  *
- * @version 0.6.2.1
+ * @version 0.6.2.2
  *
  * Changelog:
  * -----------------------------------------------------------------------------
+ * 0.6.2.2 - 2026/10/17
+ *           * Call the optional cacheResponseCallback on a cache response.
+ *           * Replaced _getPacket with _getPDU. PDUs are received in large
+ *             chunks into the receive buffer and processed in place.
+ *           * Pass prefixes in batches to the optional prefixBatchCallback.
+ *           * Convert the ASPA providers in place, fixes a memory leak in
+ *             handlePDUASPA.
  * 0.6.2.1 - 2024/09/20 - oborchert
  *           * Added PDU check into handlePDUASPA and send error to cache in 
  *             case of an error.
@@ -145,6 +152,54 @@
 /** The file descriptor for the rpki_router_client. */
 int g_rpki_single_thread_client_fd;
 
+/**
+ * Pass the collected prefixes to the prefix batch callback.
+ *
+ * @param client The router client instance.
+ *
+ * @since 0.6.2.2
+ */
+static void _flushPrefixBatch(RPKIRouterClient* client)
+{
+  if (client->prefixBatchCount > 0)
+  {
+    client->params->prefixBatchCallback(client->routerClientID, 
+                                        client->sessionID, client->prefixBatch,
+                                        client->prefixBatchCount,
+                                        client->rpkiHandler);
+    client->prefixBatchCount = 0;
+  }
+}
+
+/**
+ * Add the prefix to the batch of the prefix batch callback. A full batch is 
+ * passed to the callback.
+ *
+ * @param client The router client instance.
+ * @param isAnn Indicates if this in an announcement or not.
+ * @param prefix The prefix.
+ * @param maxLen The maximum length.
+ * @param oas The origin AS in host format.
+ *
+ * @since 0.6.2.2
+ */
+static void _addToPrefixBatch(RPKIRouterClient* client, bool isAnn,
+                              IPPrefix* prefix, uint16_t maxLen, uint32_t oas)
+{
+  RPKIPrefixRecord* record;
+
+  if (client->prefixBatchCount == RRC_PREFIX_BATCH_SIZE)
+  {
+    _flushPrefixBatch(client);
+  }
+
+  record = &client->prefixBatch[client->prefixBatchCount++];
+  record->prefix = *prefix;
+  record->oas    = oas;
+  record->maxLen = maxLen;
+  record->isAnn  = isAnn;
+}
+
 /**
  * Handle received IPv4 Prefixes.
  *
@@ -172,8 +227,16 @@ static bool handleIPv4Prefix(RPKIRouterClient* client,
   sessionID = client->sessionID;
 
   /* Pass the information to the callback */
-  client->params->prefixCallback(clientID, sessionID, isAnn, &prefix,
-                                 hdr->maxLen, ntohl(hdr->as), client->rpkiHandler);
+  if (client->params->prefixBatchCallback != NULL)
+  {
+    _addToPrefixBatch(client, isAnn, &prefix, hdr->maxLen, ntohl(hdr->as));
+  }
+  else
+  {
+    client->params->prefixCallback(clientID, sessionID, isAnn, &prefix,
+                                   hdr->maxLen, ntohl(hdr->as), 
+                                   client->rpkiHandler);
+  }
   return true;
 }
 
@@ -203,9 +266,16 @@ static bool handleIPv6Prefix(RPKIRouterClient* client,
   sessionID = client->sessionID;
 
   /* Pass the information to the callback */
-  client->params->prefixCallback(clientID, sessionID,
-                                 isAnn, &prefix, hdr->maxLen, ntohl(hdr->as),
-                                 client->rpkiHandler);
+  if (client->params->prefixBatchCallback != NULL)
+  {
+    _addToPrefixBatch(client, isAnn, &prefix, hdr->maxLen, ntohl(hdr->as));
+  }
+  else
+  {
+    client->params->prefixCallback(clientID, sessionID,
+                                   isAnn, &prefix, hdr->maxLen, ntohl(hdr->as),
+                                   client->rpkiHandler);
+  }
   return true;
 }
 
@@ -303,26 +373,24 @@ static bool handlePDUASPA(RPKIRouterClient* client,
 
   uint32_t customerAS;
   uint16_t providerCount;
-  uint8_t* providerASBuffer;
-  uint8_t* srcPtr;
-  uint32_t* srcData;
   uint32_t* providerAS;
   int idx = 0;
 
   isAnn            = (hdr->flags & PREFIX_FLAG_ANNOUNCEMENT);
   customerAS       = ntohl(hdr->customer_asn);
   providerCount    = ntohs(hdr->provider_as_count);
-  providerASBuffer = malloc(providerCount * 4);
-  srcPtr           = (uint8_t*)hdr + sizeof(RPKIASPAHeader);
+  // The PDU is 4 byte aligned in the receive buffer, see _getPDU.
+  providerAS       = (uint32_t*)((uint8_t*)hdr + sizeof(RPKIASPAHeader));
 
-  providerAS = (uint32_t*)providerASBuffer;
-  srcData    = (uint32_t*)srcPtr;
-  for (; idx < providerCount; idx++, providerAS++, srcData++)
+  if (ntohl(hdr->length) != sizeof(RPKIASPAHeader) + (providerCount * 4))
   {
-    *providerAS = ntohl(*srcData);
+    // The providers MUST fill the PDU.
+    retVal = false;
+    sendErrorReport(client, RPKI_EC_CORRUPT_DATA, (uint8_t*)hdr, 
+                    ntohl(hdr->length), RPKI_ESTR_CORRUPT_DATA, 
+                    strlen(RPKI_ESTR_CORRUPT_DATA));
   }
-
-  if (!isAnn && providerCount != 0)
+  else if (!isAnn && providerCount != 0)
   {
     // Withdrawals MUST NOT have providers attached!
     retVal = false;
@@ -346,8 +414,13 @@ static bool handlePDUASPA(RPKIRouterClient* client,
     LOG(LEVEL_DEBUG, "[ASPA] %s (valCacheID=0x%08X sessionID=0x%04X): cs=%u, "
                      "pct=%i\n", isAnn ? "Ann" : "Withdr",
                      valCacheID, sessionID, customerAS, providerCount);
+    // Convert the providers in place, the PDU is not used afterwards.
+    for (; idx < providerCount; idx++)
+    {
+      providerAS[idx] = ntohl(providerAS[idx]);
+    }
     client->params->aspaCallback(valCacheID, sessionID, isAnn, customerAS,
-                                providerCount, (uint32_t*)providerASBuffer,
+                                providerCount, providerAS,
                                 client->rpkiHandler);
   }
 
@@ -462,112 +535,210 @@ static bool checkSessionID(RPKIRouterClient* client, uint32_t sessionID)
 }
 
 /**
- * Read the next packet from the socket into the provided buffer. In case the 
- * buffer is not of sufficient size, the buffer will be extended.
+ * Allocate the receive buffer and the prefix batch of the client.
+ *
+ * @param client The client session
+ *
+ * @return false if not enough memory is available.
+ *
+ * @since 0.6.2.2
+ */
+static bool _initReceiveBuffer(RPKIRouterClient* client)
+{
+  client->recvBuffer       = malloc(RRC_RECV_BUFFER_SIZE);
+  client->recvSize         = RRC_RECV_BUFFER_SIZE;
+  client->recvStart        = 0;
+  client->recvEnd          = 0;
+  client->prefixBatch      = malloc(RRC_PREFIX_BATCH_SIZE 
+                                    * sizeof(RPKIPrefixRecord));
+  client->prefixBatchCount = 0;
+  client->recvCalls        = 0;
+  client->recvPDUs         = 0;
+
+  return (client->recvBuffer != NULL) && (client->prefixBatch != NULL);
+}
+
+/**
+ * Release the receive buffer and the prefix batch of the client.
+ *
+ * @note PThread cleanup syntax
+ *
+ * @param clientPtr a pointer to the RPKIRouterClient*
+ *
+ * @since 0.6.2.2
+ */
+static void _releaseReceiveBuffer(void* clientPtr)
+{
+  RPKIRouterClient* client = (RPKIRouterClient*)clientPtr;
+
+  free(client->recvBuffer);
+  free(client->prefixBatch);
+  client->recvBuffer       = NULL;
+  client->recvSize         = 0;
+  client->recvStart        = 0;
+  client->recvEnd          = 0;
+  client->prefixBatch      = NULL;
+  client->prefixBatchCount = 0;
+}
+
+/**
+ * Return the minimum length of a PDU of the given type. The fixed part of a
+ * PDU is processed without further length checks.
+ *
+ * @param type The PDU type.
+ *
+ * @return The minimum length in bytes.
+ *
+ * @since 0.6.2.2
+ */
+static uint32_t _getMinPDULength(uint8_t type)
+{
+  switch (type)
+  {
+    case PDU_TYPE_SERIAL_NOTIFY :
+      return sizeof(RPKISerialNotifyHeader);
+    case PDU_TYPE_IP_V4_PREFIX :
+      return sizeof(RPKIIPv4PrefixHeader);
+    case PDU_TYPE_IP_V6_PREFIX :
+      return sizeof(RPKIIPv6PrefixHeader);
+    case PDU_TYPE_END_OF_DATA :
+      return sizeof(RPKIEndOfDataHeader);
+    case PDU_TYPE_ROUTER_KEY :
+      return sizeof(RPKIRouterKeyHeader);
+    case PDU_TYPE_ERROR_REPORT :
+      // Including the length of the error text
+      return sizeof(RPKIErrorReportHeader) + 4;
+    case PDU_TYPE_ASPA :
+      return sizeof(RPKIASPAHeader);
+    default :
+      return sizeof(RPKICommonHeader);
+  }
+}
+
+/**
+ * Return the next PDU of the receive buffer. If the buffer does not contain
+ * the complete PDU, the data received so far is moved to the front of the 
+ * buffer and as much data as available is received from the socket. This way
+ * all PDUs of a chunk are processed without further system calls. Before the 
+ * client waits for data, the collected prefixes are passed to the prefix 
+ * batch callback.
  * 
- * In case of an internal error receiving the PDU the returned length can be 
- * less then the length field of the PDU indicates. In this case the errCode
- * contains an error.
+ * The PDU is processed in place and is valid until the next call. It starts 
+ * on a 4 byte boundary. The buffer only grows for a PDU that is larger than
+ * RRC_RECV_BUFFER_SIZE and shrinks back once the PDU is processed.
  * 
  * The following errors can be reported:
  * 
  *     RRC_RCV_PDU_NO_ERROR:       No error
- *     RRC_RCV_PDU_SOCKET_ERROR:   Somehow not all data could be loaded.
+ *     RRC_RCV_PDU_SOCKET_ERROR:   The connection is lost.
+ *     RRC_RCV_PDU_MEMORY_ERROR:   The buffer could not be extended.
+ *     RPKI_EC_CORRUPT_DATA:       The length of the PDU is invalid.
  * 
  * @param client The client session
  * @param errCode Returns the error code.
- * @param buffer The buffer to be filled.
- * @param buffSize The max size of the buffer.
  * 
- * @return 0 or the number of bytes received (can be less then the PDU length).
+ * @return The PDU or NULL in case of an error.
+ *
+ * @since 0.6.2.2
  */
-static uint32_t _getPacket(RPKIRouterClient* client, int* errCode, 
-                            uint8_t** buffer, uint32_t* buffSize)
+static RPKICommonHeader* _getPDU(RPKIRouterClient* client, int* errCode)
 {
-  uint32_t pduLen       = 0;
-  uint32_t bytesMissing = 0;
-  uint8_t* bufferPtr    = *buffer + sizeof(RPKICommonHeader);
-  RPKICommonHeader* hdr = (RPKICommonHeader*)*buffer;
+  RPKICommonHeader* hdr       = NULL;
+  uint32_t          available = 0;
+  uint32_t          pduLen    = 0;
+  uint32_t          aligned   = 0;
+  uint32_t          size      = 0;
+  uint8_t*          newBuffer = NULL;
+  ssize_t           received  = 0;
   
-  // Initialize the values.
-  memset (*buffer, 0, *buffSize);
   *errCode = RRC_RCV_PDU_NO_ERROR;
-  
-  // Read the common data for the Common header. This method fails in case the
-  // connection is lost.
-  if (!recvNum(getClientFDPtr(&client->clSock), *buffer,
-                              sizeof(RPKICommonHeader)))
-  {
-    LOG(LEVEL_DEBUG, HDR "Connection lost!", pthread_self());
-    *errCode  = RRC_RCV_PDU_SOCKET_ERROR;
-  }
-  else
-  {
-    // retrieve the actual size of the message. In case more needs to be loaded
-    // it will be done.
-    pduLen = ntohl(hdr->length);
-    if (pduLen < sizeof(RPKICommonHeader))
-    {
-      LOG(LEVEL_DEBUG, HDR "Corrupted RPKI-RTR PDU: Size!", pthread_self());
-      *errCode  = RPKI_EC_CORRUPT_DATA;
-    }    
-  }
-  
-  if (*errCode == RRC_RCV_PDU_NO_ERROR)
-  {      
-    // Determine how much data is still missing
-    bytesMissing = pduLen - sizeof(RPKICommonHeader);
 
-    // Read the rest of the PDU
-    if (bytesMissing > 0)
+  while (*errCode == RRC_RCV_PDU_NO_ERROR)
+  {
+    available = client->recvEnd - client->recvStart;
+    pduLen    = 0;
+    if (available >= sizeof(RPKICommonHeader))
     {
-      // Check if the current buffer is big enough
-      if (pduLen > *buffSize)
+      hdr    = (RPKICommonHeader*)(client->recvBuffer + client->recvStart);
+      pduLen = ntohl(hdr->length);
+      if (   (pduLen < _getMinPDULength(hdr->type)) 
+          || (pduLen > RRC_MAX_PDU_LENGTH))
+      {
+        LOG(LEVEL_DEBUG, HDR "Corrupted RPKI-RTR PDU: Size!", pthread_self());
+        *errCode = RPKI_EC_CORRUPT_DATA;
+        continue;
+      }
+      if (available >= pduLen)
       {
-        // The current buffer is to small -> try to increase it.
-        uint8_t* newBuffer = realloc(*buffer, pduLen);
-        if (newBuffer)
+        // Move the PDU back onto a 4 byte boundary. The bytes in front of
+        // the PDU are already processed.
+        aligned = client->recvStart & ~(uint32_t)3;
+        if (aligned != client->recvStart)
         {
-          *buffer   = newBuffer; // reset to the bigger space
-          *buffSize = pduLen;
-          bufferPtr = (*buffer + sizeof(RPKICommonHeader));
-        }
-        else
-        {
-          // can only happen in case it is an error packet that contains an
-          // erroneous PDU or extreme large error text.
-          LOG(LEVEL_ERROR, "Invalid PDU length : type=%d, length=%u, "
-                           "data-size=%u", hdr->type, pduLen, bytesMissing);
-
-          // Try to skip over the data
-          if (!skipBytes(&client->clSock, bytesMissing))
-          {
-            LOG(LEVEL_ERROR, "While reading a corrupted PDU, could not skip "
-                             "over the remainig data");
-          }
-          *errCode = RPKI_EC_CORRUPT_DATA;
+          memmove(client->recvBuffer + aligned, hdr, pduLen);
+          hdr = (RPKICommonHeader*)(client->recvBuffer + aligned);
         }
+        client->recvStart += pduLen;
+        client->recvPDUs++;
+        return hdr;
       }
+    }
+
+    // Move the incomplete PDU to the front of the buffer
+    if (client->recvStart != 0)
+    {
+      memmove(client->recvBuffer, client->recvBuffer + client->recvStart, 
+              available);
+      client->recvStart = 0;
+      client->recvEnd   = available;
+    }
 
-      // Now load the remaining data
-      if (*errCode == RRC_RCV_PDU_NO_ERROR)
+    // Resize the buffer if the PDU does not fit or the large PDU is processed.
+    size = (pduLen > RRC_RECV_BUFFER_SIZE) ? pduLen : RRC_RECV_BUFFER_SIZE;
+    if ((size > client->recvSize) 
+        || ((size < client->recvSize) && (available <= size)))
+    {
+      newBuffer = realloc(client->recvBuffer, size);
+      if (newBuffer != NULL)
       {
-        if (!recvNum(getClientFDPtr(&client->clSock), bufferPtr, bytesMissing))
-        {
-          *errCode = RRC_RCV_PDU_SOCKET_ERROR; 
-          pduLen -= bytesMissing;
-        }
+        client->recvBuffer = newBuffer;
+        client->recvSize   = size;
+      }
+      else if (size > client->recvSize)
+      {
+        LOG(LEVEL_ERROR, "Invalid PDU length : type=%d, length=%u", 
+                         hdr->type, pduLen);
+        *errCode = RRC_RCV_PDU_MEMORY_ERROR;
+        continue;
       }
     }
+
+    // Pass the collected prefixes before waiting for more data.
+    _flushPrefixBatch(client);
+
+    received = recvAvailable(getClientFDPtr(&client->clSock), 
+                             client->recvBuffer + client->recvEnd, 
+                             client->recvSize - client->recvEnd, true);
+    client->recvCalls++;
+    if (received < 0)
+    {
+      LOG(LEVEL_DEBUG, HDR "Connection lost!", pthread_self());
+      *errCode = RRC_RCV_PDU_SOCKET_ERROR;
+    }
+    else
+    {
+      client->recvEnd += received;
+    }
   }
   
-  return pduLen;
+  return NULL;
 }
 
 /**
  * This method implements the receiver loop between the RPKI client and
  * RPKI server. It reads and processes each PDU completely. It does NOT 
- * close the socket on return.
+ * close the socket on return. PDUs that are already received but not 
+ * processed remain in the receive buffer for the next call.
  * 
  * The following error codes can be returned:
  *   RPKI_EC_...: All RPKI error codes 0..255
@@ -591,28 +762,14 @@ static bool receivePDUs(RPKIRouterClient* client, bool returnAterEndOfData,
 {
   RPKICommonHeader* hdr        = NULL;  // A pointer to the Common header.
   uint32_t          pduLen     = 0;
-  // Use the "maximum" header. It can grow in case an error pdu is received
-  // with a large error message or an ASPA PDU with a large number of 
-  // providerASs. In this case the memory will be extended to the space needed. 
-  // In case the space can not be extended as needed, the PDU will be loaded as 
-  // much as possible and the remainder will be skipped.
-  uint32_t         bytesAllocated = sizeof(RPKIRouterKeyHeader);
-  uint8_t*         byteBuffer = malloc(bytesAllocated);
+  // The PDUs are processed in place in the receive buffer of the client.
+  uint8_t*          byteBuffer = NULL;
   // Keep going is used to keep the received thread up and running. It will be
   // set false once the connection is shut down.
   bool             keepGoing   = !client->stop;
   
-  if (byteBuffer != NULL)
-  {
-    // Reset the error code to NO ERROR
-    *errCode = RRC_RCV_PDU_NO_ERROR;
-  }
-  else
-  {
-    RAISE_ERROR("Could not allocate enough memory to read from socket!");
-    *errCode  = RRC_RCV_PDU_MEMORY_ERROR;
-    keepGoing = false;
-  }
+  // Reset the error code to NO ERROR
+  *errCode = RRC_RCV_PDU_NO_ERROR;
 
   // KeepGoing until a cache session id changed / in case of connection loss,
   // a break stops this while loop.
@@ -621,13 +778,22 @@ static bool receivePDUs(RPKIRouterClient* client, bool returnAterEndOfData,
     // If singlePoll is selected, stop after this poll.
     keepGoing = !singlePoll;
     
-    pduLen = _getPacket(client, errCode, &byteBuffer, &bytesAllocated);
-    if (!pduLen)
+    hdr = _getPDU(client, errCode);
+    if (hdr == NULL)
     {
+      pduLen    = 0;
       keepGoing = false;
       continue;
     }
-    hdr = (RPKICommonHeader*)byteBuffer;
+    byteBuffer = (uint8_t*)hdr;
+    pduLen     = ntohl(hdr->length);
+
+    // Keep the order of the batched prefixes and all other PDUs.
+    if ((hdr->type != PDU_TYPE_IP_V4_PREFIX) 
+        && (hdr->type != PDU_TYPE_IP_V6_PREFIX))
+    {
+      _flushPrefixBatch(client);
+    }
     
     LOG(LEVEL_DEBUG, HDR "Received RPKI-RTR PDU[%u] length=%u\n",
                      pthread_self(), hdr->type, ntohl(hdr->length));
@@ -725,6 +891,13 @@ static bool receivePDUs(RPKIRouterClient* client, bool returnAterEndOfData,
             *errCode = RPKI_EC_CORRUPT_DATA;
           }
         }
+        if (keepGoing && (client->params->cacheResponseCallback != NULL))
+        {
+          client->params->cacheResponseCallback(client->routerClientID, 
+                                     sessionID, 
+                                     client->lastSent == PDU_TYPE_RESET_QUERY,
+                                     client->rpkiHandler);
+        }
         break;
       case PDU_TYPE_IP_V4_PREFIX :
         handleIPv4Prefix(client, (RPKIIPv4PrefixHeader*)byteBuffer);
@@ -802,6 +975,9 @@ static bool receivePDUs(RPKIRouterClient* client, bool returnAterEndOfData,
     // Set the last received PDU
     client->lastRecv = hdr->type;
   }
+
+  // Pass the remaining prefixes before returning.
+  _flushPrefixBatch(client);
   
   // Now do error handling but only if not in handshake mode.
   if ((!client->startup) && (*errCode != RRC_RCV_PDU_NO_ERROR))
@@ -891,10 +1067,6 @@ static bool receivePDUs(RPKIRouterClient* client, bool returnAterEndOfData,
                     errStr, strlen(errStr));
   }
   
-  // Release the buffer again.
-  free(byteBuffer);
-  byteBuffer = NULL;
-  
   return *errCode == RRC_RCV_PDU_NO_ERROR;
 }
 
@@ -920,8 +1092,8 @@ static void* manageConnection (void* clientPtr)
   RPKIRouterClient* client = (RPKIRouterClient*)clientPtr;
   int               sec;
   int               errCode;
-  // Counter for errors 
-  int errCount = 0;
+  // Counter for errors, volatile as it changes inside pthread_cleanup_push
+  volatile int errCount = 0;
 
   struct sigaction act;
   sigset_t errmask;
@@ -936,6 +1108,14 @@ static void* manageConnection (void* clientPtr)
 
   LOG (LEVEL_DEBUG, "([0x%08X]) > RPKI Router Client Thread started!",
                     pthread_self());
+
+  // The receive buffer is released when the thread ends or is canceled.
+  pthread_cleanup_push(_releaseReceiveBuffer, client);
+  if (!_initReceiveBuffer(client))
+  {
+    RAISE_ERROR("Could not allocate enough memory to read from socket!");
+    client->stop = true;
+  }
     
   while (!client->stop)
   {
@@ -1018,6 +1198,10 @@ static void* manageConnection (void* clientPtr)
     // Now try to reconnect if not stopped.
     client->clSock.reconnect = !client->stop;
     reconnectToServer(&client->clSock, sec, MAX_RECONNECTION_ATTEMPTS);
+    // Data of the previous connection is not processed anymore.
+    client->recvStart        = 0;
+    client->recvEnd          = 0;
+    client->prefixBatchCount = 0;
 
     // See if the session_id changed!
     if (client->sessionIDChanged)
@@ -1059,6 +1243,7 @@ static void* manageConnection (void* clientPtr)
   LOG (LEVEL_DEBUG, "([0x%08X]) < RPKI Router Client Thread stopped!",
                     pthread_self());
 
+  pthread_cleanup_pop(1);
   pthread_exit(0);
 }
 
@@ -1095,7 +1280,9 @@ bool createRPKIRouterClient (RPKIRouterClient* self,
   int ret;
 
   // Check if the mandatory callback is set...
-  if ((params->prefixCallback == NULL) || (params->resetCallback == NULL))
+  if (   ((params->prefixCallback == NULL) 
+          && (params->prefixBatchCallback == NULL)) 
+      || (params->resetCallback == NULL))
   {
     RAISE_ERROR("Not all mandatory callback methods are set");
     return false;
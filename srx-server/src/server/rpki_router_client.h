@@ -25,10 +25,15 @@
  *
  * Uses log.h for error reporting
  *
- * @version 0.6.2.1
+ * @version 0.6.2.2
  *
  * Changelog:
  * -----------------------------------------------------------------------------
+ * 0.6.2.2 - 2026/10/17
+ *           * Added optional cacheResponseCallback to RPKIRouterClientParams.
+ *           * Added optional prefixBatchCallback to RPKIRouterClientParams and
+ *             the type RPKIPrefixRecord.
+ *           * Added the receive buffer to RPKIRouterClient.
  * 0.6.2.1 - 2024/09/10 - oborchert
  *           * Changed data types from u_int... to uint... which follows C99
  *           * Added timing parameters for protocol version 2 to 
@@ -115,6 +120,28 @@
 #define RPKI_MAX_HEADER_LENGTH 102400
 /** The maximum number of reconnect attempts within one connection request. */
 #define MAX_RECONNECTION_ATTEMPTS 10
+/** The size of the receive buffer. It only grows for a larger PDU. */
+#define RRC_RECV_BUFFER_SIZE      65536
+/** The maximum accepted PDU length (ASPA PDU with 65535 providers). */
+#define RRC_MAX_PDU_LENGTH        (12 + 0xFFFF * 4)
+/** The maximum number of prefixes passed to the prefix batch callback. */
+#define RRC_PREFIX_BATCH_SIZE     512
+
+/**
+ * A prefix announcement / withdrawal received from the RPKI validation cache.
+ * 
+ * @since 0.6.2.2
+ */
+typedef struct {
+  /** The prefix itself. Contains the information of v4/v6 */
+  IPPrefix prefix;
+  /** The origin AS for this entry in host format. */
+  uint32_t oas;
+  /** The maximum length this white-list / ROA entry covers. */
+  uint16_t maxLen;
+  /** Indicates if this in an announcement or not. */
+  bool     isAnn;
+} RPKIPrefixRecord;
 
 /**
  * Client parameter settings.
@@ -142,6 +169,27 @@ typedef struct {
                          bool isAnn, IPPrefix* prefix, uint16_t maxLen,
                          uint32_t oas, void* rpkiHandler);
 
+  /**
+   * This function is called with the prefix announcements / withdrawals 
+   * received in a row from the RPKI validation cache. The prefixes are passed
+   * before any other PDU is processed and before the client waits for more 
+   * data. If set, prefixCallback is not called.
+   *
+   * @note Optional - can be NULL
+   *
+   * @param valCacheID  This Id represents the cache.
+   * @param sessionID   The cache sessionID entry for this data.
+   * @param records     The prefixes in the order they were received. The 
+   *                    array is only valid during the call.
+   * @param count       The number of prefixes.
+   * @param rpkiHandler An instance of the RPKIHandler.
+   *
+   * @since 0.6.2.2
+   */
+  void (*prefixBatchCallback)(uint32_t valCacheID, uint16_t sessionID,
+                              RPKIPrefixRecord* records, uint32_t count,
+                              void* rpkiHandler);
+
   /**
    * This function is called for each prefix announcement / withdrawal received
    * from the RPKI validation cache.
@@ -200,6 +248,23 @@ typedef struct {
   void (*endOfDataCallback)(uint32_t valCacheID, uint16_t sessionID,
                             void* rpkiHandler);
 
+  /**
+   * This function is called each time a cache response is received. It 
+   * indicates if the following data is the complete data set of the cache 
+   * (response to a reset query) or the changes since the last serial.
+   *
+   * @note Optional - can be NULL
+   *
+   * @param valCacheID  This Id represents the cache.
+   * @param sessionID   The cache sessionID.
+   * @param fullSync    true if the cache response answers a reset query.
+   * @param rpkiHandler The RPKIHandler.
+   *
+   * @since 0.6.2.2
+   */
+  void (*cacheResponseCallback)(uint32_t valCacheID, uint16_t sessionID,
+                                bool fullSync, void* rpkiHandler);
+
   /**
    * The cache/server sent a reset response. Usually, the client should reset
    * his own cache.
@@ -409,6 +474,32 @@ typedef struct {
   bool                    stopAfterEndOfData;
   /** RTR-to-Cache protocol version info */
   int8_t                  version;
+
+  // The following attributes are used by the receiver thread only.
+  /** The receive buffer, PDUs are processed in place.
+   * @since 0.6.2.2 */
+  uint8_t*                recvBuffer;
+  /** The size of the receive buffer.
+   * @since 0.6.2.2 */
+  uint32_t                recvSize;
+  /** The start of the next PDU in the receive buffer.
+   * @since 0.6.2.2 */
+  uint32_t                recvStart;
+  /** The end of the received data in the receive buffer.
+   * @since 0.6.2.2 */
+  uint32_t                recvEnd;
+  /** The prefixes not yet passed to the prefix batch callback.
+   * @since 0.6.2.2 */
+  RPKIPrefixRecord*       prefixBatch;
+  /** The number of prefixes in prefixBatch.
+   * @since 0.6.2.2 */
+  uint32_t                prefixBatchCount;
+  /** The number of receive calls on the socket.
+   * @since 0.6.2.2 */
+  uint64_t                recvCalls;
+  /** The number of PDUs received.
+   * @since 0.6.2.2 */
+  uint64_t                recvPDUs;
 } RPKIRouterClient;
 
 /**
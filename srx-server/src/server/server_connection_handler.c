@@ -20,10 +20,16 @@
  * other licenses. Please refer to the licenses of all libraries required
  * by this software.
  *
- * @version 0.6.1.2
+ * @version 0.6.2.2
  *
  * Changelog:
  * -----------------------------------------------------------------------------
+ * 0.6.2.2  - 2026/10/17
+ *            * Add the output buffer of the send queue once a proxy connects
+ *              and release it once the proxy disconnects.
+ *            * Use the epoll based MODE_EVENT of the server socket if server
+ *              reactors are configured.
+ *            * Added processing of bulk verify requests.
  * 0.6.1.2  - 2021/11/15 - kyehwanl
  *            * Exchange the conditions to determine between sibling and lateral 
  *              peer.
@@ -65,6 +71,8 @@
 
 #include <stdio.h>
 #include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
 
 #include "util/log.h"
 #include "server/server_connection_handler.h"
@@ -530,23 +538,51 @@ void releaseServerConnectionHandler(ServerConnectionHandler* self)
   memset(self->proxyMap, 0, (sizeof(ProxyClientMapping)*256));
 }
 
+/**
+ * Collects the notifications and validation commands of the requests contained
+ * in one bulk verify request. The commands are queued after the notifications
+ * are send, this way the receipt of an update always arrives at the proxy 
+ * before the result of its validation.
+ *
+ * @since 0.6.2.2
+ */
+typedef struct {
+  /** The bulk notification PDU, followed by the notifications. */
+  SRXPROXY_VERIFY_BULK_NOTIFICATION* pdu;
+  /** The notifications following the bulk notification header. */
+  SRXPROXY_VERIFY_NOTIFICATION*      notifications;
+  /** The number of collected notifications. */
+  uint32_t                           noNotifications;
+  /** The requests to be added to the command queue. */
+  SRXRPOXY_BasicHeader_VerifyRequest** requests;
+  /** The update IDs of the requests to be added to the command queue. */
+  SRxUpdateID*                       updateIDs;
+  /** The number of collected requests. */
+  uint32_t                           noRequests;
+} BulkVerifyCollector;
+
 /**
  * This method processes the validation result request. This method is called by
  * the packet handler and if necessary the request will be added to the command
  * queue. This method does NOT send error packets to the proxy!
  *
+ * If a bulk collector is provided, the notification and the command are not
+ * send respectively queued but added to the collector.
+ *
  * @param self The server connection handler.
  * @param svrSock The server socket used to send a possible validation request
  *                receipt
  * @param client The client instance where the packet was received on
- * @param updateCache The instance of the update cache
  * @param hdr The validation request header
+ * @param bulk The collector of a bulk request, NULL for a single request.
  *
  * @return false if an internal (fatal) error occurred, otherwise true.
  */
-bool processValidationRequest(ServerConnectionHandler* self,
-                              ServerSocket* svrSock, ClientThread* client,
-                              SRXRPOXY_BasicHeader_VerifyRequest* hdr)
+static bool _processValidationRequest(ServerConnectionHandler* self,
+                                      ServerSocket* svrSock, 
+                                      ClientThread* client,
+                                      SRXRPOXY_BasicHeader_VerifyRequest* hdr,
+                                      BulkVerifyCollector* bulk)
 {
   LOG(LEVEL_DEBUG, HDR "Enter processValidationRequest", pthread_self());
 
@@ -839,10 +875,17 @@ bool processValidationRequest(ServerConnectionHandler* self,
     }
 
     // Now send the results we know so far;
-    if (!sendVerifyNotification(svrSock, client, updateID, sendFlags,
-                                requestToken, srxRes.roaResult,
-                                srxRes.bgpsecResult, srxRes.aspaResult,
-                                !self->sysConfig->mode_no_sendqueue))
+    if (bulk != NULL)
+    {
+      initVerifyNotification(&bulk->notifications[bulk->noNotifications++],
+                             updateID, sendFlags, requestToken, 
+                             srxRes.roaResult, srxRes.bgpsecResult, 
+                             srxRes.aspaResult);
+    }
+    else if (!sendVerifyNotification(svrSock, client, updateID, sendFlags,
+                                     requestToken, srxRes.roaResult,
+                                     srxRes.bgpsecResult, srxRes.aspaResult,
+                                     !self->sysConfig->mode_no_sendqueue))
     {
       RAISE_ERROR("Could not send the initial verify notification for update"
         "[0x%08X] to client [0x%02X]!", updateID, client->routerID);
@@ -861,8 +904,14 @@ bool processValidationRequest(ServerConnectionHandler* self,
     hdr->flags = sendFlags & SRX_FLAG_ROA_BGPSEC_ASPA;
 
     // create the validation command!
-    if (!queueCommand(self->cmdQueue, COMMAND_TYPE_SRX_PROXY, svrSock, client,
-                      updateID, ntohl(hdr->length), (uint8_t*)hdr))
+    if (bulk != NULL)
+    {
+      bulk->requests[bulk->noRequests]  = hdr;
+      bulk->updateIDs[bulk->noRequests] = updateID;
+      bulk->noRequests++;
+    }
+    else if (!queueCommand(self->cmdQueue, COMMAND_TYPE_SRX_PROXY, svrSock, 
+                           client, updateID, ntohl(hdr->length), (uint8_t*)hdr))
     {
       RAISE_ERROR("Could not add validation request to command queue!");
       retVal = false;
@@ -873,6 +922,192 @@ bool processValidationRequest(ServerConnectionHandler* self,
   return retVal;
 }
 
+/**
+ * This method processes the validation result request. This method is called by
+ * the packet handler and if necessary the request will be added to the command
+ * queue. This method does NOT send error packets to the proxy!
+ *
+ * @param self The server connection handler.
+ * @param svrSock The server socket used to send a possible validation request
+ *                receipt
+ * @param client The client instance where the packet was received on
+ * @param hdr The validation request header
+ *
+ * @return false if an internal (fatal) error occurred, otherwise true.
+ */
+bool processValidationRequest(ServerConnectionHandler* self,
+                              ServerSocket* svrSock, ClientThread* client,
+                              SRXRPOXY_BasicHeader_VerifyRequest* hdr)
+{
+  return _processValidationRequest(self, svrSock, client, hdr, NULL);
+}
+
+/**
+ * Verify that the given bulk verify request is well formed. Each contained
+ * request must be a complete IPv4 or IPv6 verify request and all requests 
+ * together must fill the bulk request exactly.
+ *
+ * @param bulkHdr The bulk verify request.
+ * @param length The number of bytes received.
+ *
+ * @return true if the bulk request is well formed.
+ *
+ * @since 0.6.2.2
+ */
+static bool _checkBulkVerifyRequest(SRXPROXY_VERIFY_BULK_REQUEST* bulkHdr,
+                                    PacketLength length)
+{
+  uint8_t* data      = (uint8_t*)bulkHdr + sizeof(SRXPROXY_VERIFY_BULK_REQUEST);
+  uint32_t remaining = 0;
+  uint32_t noRequests;
+  uint32_t elemLen;
+  uint32_t minLen;
+  uint32_t idx;
+  SRXRPOXY_BasicHeader_VerifyRequest* hdr;
+
+  if (   (length < sizeof(SRXPROXY_VERIFY_BULK_REQUEST))
+      || (ntohl(bulkHdr->length) != length))
+  {
+    return false;
+  }
+
+  remaining  = length - sizeof(SRXPROXY_VERIFY_BULK_REQUEST);
+  noRequests = ntohl(bulkHdr->noRequests);
+  for (idx = 0; idx < noRequests; idx++)
+  {
+    if (remaining < sizeof(SRXRPOXY_BasicHeader_VerifyRequest))
+    {
+      return false;
+    }
+    hdr = (SRXRPOXY_BasicHeader_VerifyRequest*)data;
+    switch (hdr->type)
+    {
+      case PDU_SRXPROXY_VERIFY_V4_REQUEST:
+        minLen = sizeof(SRXPROXY_VERIFY_V4_REQUEST);
+        break;
+      case PDU_SRXPROXY_VERIFY_V6_REQUEST:
+        minLen = sizeof(SRXPROXY_VERIFY_V6_REQUEST);
+        break;
+      default:
+        return false;
+    }
+    elemLen = ntohl(hdr->length);
+    if ((elemLen < minLen) || (elemLen > remaining))
+    {
+      return false;
+    }
+    data      += elemLen;
+    remaining -= elemLen;
+  }
+
+  return remaining == 0;
+}
+
+/**
+ * This method processes a bulk verify request. Each contained request is
+ * processed as a single request. If the proxy negotiated the bulk capability,
+ * all receipts are send in one bulk notification, otherwise each receipt is 
+ * send on its own. The validation commands are queued afterwards. This method
+ * does NOT send error packets to the proxy!
+ *
+ * @param self The server connection handler.
+ * @param svrSock The server socket used to send the receipts
+ * @param client The client instance where the packet was received on
+ * @param bulkHdr The bulk verify request. It must be checked already.
+ *
+ * @return false if an internal (fatal) error occurred, otherwise true.
+ *
+ * @since 0.6.2.2
+ */
+static bool _processBulkValidationRequest(ServerConnectionHandler* self,
+                                          ServerSocket* svrSock, 
+                                          ClientThread* client,
+                                      SRXPROXY_VERIFY_BULK_REQUEST* bulkHdr)
+{
+  bool     retVal     = true;
+  bool     useQueue   = !self->sysConfig->mode_no_sendqueue;
+  uint32_t noRequests = ntohl(bulkHdr->noRequests);
+  uint8_t* data       = (uint8_t*)bulkHdr + sizeof(SRXPROXY_VERIFY_BULK_REQUEST);
+  uint32_t idx;
+  BulkVerifyCollector bulk;
+  SRXRPOXY_BasicHeader_VerifyRequest* hdr;
+
+  if (noRequests == 0)
+  {
+    return true;
+  }
+
+  memset(&bulk, 0, sizeof(BulkVerifyCollector));
+  bulk.pdu = malloc(  sizeof(SRXPROXY_VERIFY_BULK_NOTIFICATION)
+                    + (noRequests * sizeof(SRXPROXY_VERIFY_NOTIFICATION)));
+  bulk.requests  = malloc(noRequests 
+                          * sizeof(SRXRPOXY_BasicHeader_VerifyRequest*));
+  bulk.updateIDs = malloc(noRequests * sizeof(SRxUpdateID));
+  if ((bulk.pdu == NULL) || (bulk.requests == NULL) || (bulk.updateIDs == NULL))
+  {
+    RAISE_SYS_ERROR("Not enough memory to process a bulk request of %u "
+                    "requests!", noRequests);
+    retVal = false;
+  }
+  else
+  {
+    bulk.notifications = (SRXPROXY_VERIFY_NOTIFICATION*)(bulk.pdu + 1);
+
+    for (idx = 0; (idx < noRequests) && retVal; idx++)
+    {
+      hdr = (SRXRPOXY_BasicHeader_VerifyRequest*)data;
+      data += ntohl(hdr->length);
+      retVal = _processValidationRequest(self, svrSock, client, hdr, &bulk);
+    }
+
+    // First send the receipts...
+    if ((client->capabilities & SRX_PROXY_CAP_BULK_VERIFY) != 0)
+    {
+      if (bulk.noNotifications > 0)
+      {
+        retVal = sendVerifyBulkNotification(svrSock, client, bulk.pdu, 
+                                            bulk.noNotifications, useQueue)
+                 && retVal;
+      }
+    }
+    else
+    {
+      for (idx = 0; idx < bulk.noNotifications; idx++)
+      {
+        if (!__sendPacketToClient(svrSock, client, &bulk.notifications[idx],
+                                  sizeof(SRXPROXY_VERIFY_NOTIFICATION),
+                                  useQueue))
+        {
+          RAISE_ERROR("Could not send the initial verify notification for "
+                      "update [0x%08X] to client [0x%02X]!", 
+                      ntohl(bulk.notifications[idx].updateID), 
+                      client->routerID);
+          retVal = false;
+        }
+      }
+    }
+
+    // ...then queue the validation.
+    for (idx = 0; idx < bulk.noRequests; idx++)
+    {
+      hdr = bulk.requests[idx];
+      if (!queueCommand(self->cmdQueue, COMMAND_TYPE_SRX_PROXY, svrSock, 
+                        client, bulk.updateIDs[idx], ntohl(hdr->length), 
+                        (uint8_t*)hdr))
+      {
+        RAISE_ERROR("Could not add validation request to command queue!");
+        retVal = false;
+      }
+    }
+  }
+
+  free(bulk.pdu);
+  free(bulk.requests);
+  free(bulk.updateIDs);
+
+  return retVal;
+}
+
 /**
  * This method processes the validation result request. This method is called by
  * the packet handler and if necessary the request will be added to the command
@@ -1023,6 +1258,40 @@ void _handlePacket(ServerSocket* svrSock, ServerClient* client,
         }
 //#endif
         break;
+      case PDU_SRXPROXY_VERIFY_BULK_REQUEST:
+        if (!clientThread->initialized)
+        {
+          // A handshake was not performed, otherwise the clientThread would be
+          // initialized!!!
+          RAISE_SYS_ERROR("Connection not initialized yet - "
+                          "Handshake missing!!!");
+          sendError(SRXERR_INTERNAL_ERROR, svrSock, client, false);
+          sendGoodbye(svrSock, client, false);
+        }
+        else if (!_checkBulkVerifyRequest(
+                                    (SRXPROXY_VERIFY_BULK_REQUEST*)packet, 
+                                    length))
+        {
+          LOG(LEVEL_WARNING, HDR "Received malformed bulk verify request from "
+                             "proxy [0x%08X]", pthread_self(), 
+                             clientThread->proxyID);
+          sendError(SRXERR_INVALID_PACKET, svrSock, client, false);
+          sendGoodbye(svrSock, client, false);
+        }
+        else
+        {
+          LOG(LEVEL_DEBUG, HDR "Received bulk verify request with %u requests "
+                           "from proxy[0x%08X]", pthread_self(),
+                ntohl(((SRXPROXY_VERIFY_BULK_REQUEST*)packet)->noRequests),
+                clientThread->proxyID);
+          if (!_processBulkValidationRequest(self, svrSock, clientThread,
+                                        (SRXPROXY_VERIFY_BULK_REQUEST*)packet))
+          {
+            sendError(SRXERR_INTERNAL_ERROR, svrSock, client, false);
+            sendGoodbye(svrSock, client, false);
+          }
+        }
+        break;
       case PDU_SRXPROXY_SIGN_REQUEST:
         if (!clientThread->initialized)
         {
@@ -1199,6 +1468,11 @@ static bool handleStatusChange(ServerSocket* svrSock, ServerClient* client,
       RAISE_SYS_ERROR("Not enough memory to handle the new connection!");
       retVal = false;
     }
+    else if (!addClientSendBuffer(client))
+    {
+      deleteFromSList(&self->clients, client);
+      retVal = false;
+    }
   }
   else
   {
@@ -1214,6 +1488,8 @@ static bool handleStatusChange(ServerSocket* svrSock, ServerClient* client,
     deactivateConnectionMapping(self, clientThread->routerID, crashed,
                                 self->sysConfig->defaultKeepWindow);
 
+    // Drop the notifications still queued for this client.
+    releaseClientSendBuffer(client);
     deleteFromSList(&svrSock->cthreads, client);
   }
   LOG(LEVEL_DEBUG, HDR "Exit handleStatusChange (%s)", pthread_self(),
@@ -1235,8 +1511,18 @@ void startProcessingRequests(ServerConnectionHandler* self,
 {
   LOG(LEVEL_DEBUG, HDR "Enter startProcessingRequests", pthread_self());
   self->cmdQueue = cmdQueue;
-  runServerLoop(&self->svrSock, MODE_SINGLE_CLIENT, handlePacket,
-                handleStatusChange, self);
+  if (self->sysConfig->serverReactors > 0)
+  {
+    // Serve all proxy connections with a few epoll threads
+    setServerSocketReactors(&self->svrSock, self->sysConfig->serverReactors);
+    runServerLoop(&self->svrSock, MODE_EVENT, handlePacket,
+                  handleStatusChange, self);
+  }
+  else
+  {
+    runServerLoop(&self->svrSock, MODE_SINGLE_CLIENT, handlePacket,
+                  handleStatusChange, self);
+  }
   LOG(LEVEL_DEBUG, HDR "Exit startProcessingRequests", pthread_self());
 }
 
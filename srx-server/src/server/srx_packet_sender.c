@@ -22,11 +22,24 @@
  *
  * This file contains the functions to send srx-proxy packets.
  * 
- * @version 0.3.0.10
+ * @version 0.6.2.2
  *
  * Changelog:
  * 
  * -----------------------------------------------------------------------------
+ * 0.6.2.2  - 2026/10/17
+ *            * Replaced the packet list of the send queue with one output ring
+ *              buffer per client. The queue thread writes all PDUs of a 
+ *              client with one sendmsg call once SEND_FLUSH_BYTES are queued 
+ *              or the oldest PDU waited SEND_FLUSH_USEC.
+ *            * Producers queue the PDUs in a lock-free ring of slots, the 
+ *              queue thread takes them in batches and owns the output buffers.
+ *            * Added addClientSendBuffer, releaseClientSendBuffer and 
+ *              getSendQueueStatistics. PDUs of a client without an output 
+ *              buffer are dropped.
+ *            * Verify notifications are build on the stack.
+ *            * Added the negotiated capabilities to sendHelloResponse.
+ *            * Added initVerifyNotification and sendVerifyBulkNotification.
  * 0.3.0.10 - 2015/11/10 - oborchert
  *            * Fixed assignment bug in stopSendQueue
  *            * Added return value (NULL) to sendQueueThreadLoop
@@ -41,40 +54,96 @@
  */
 #include <stdint.h>
 #include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sys/uio.h>
 #include "server/srx_packet_sender.h"
 #include "shared/srx_packets.h"
 #include "util/log.h"
 #include "util/mutex.h"
 #include "util/server_socket.h"
 
+/** The size of the PDU data of a slot of the send ring. */
+#define SEND_SLOT_SIZE     128
+
+/**
+ * One slot of the send ring. A producer claims the slot by advancing the tail
+ * of the ring, copies the PDU into it and publishes it by setting the sequence.
+ * PDUs larger than SEND_SLOT_SIZE are copied into a heap buffer instead.
+ *
+ * @since 0.6.2.2
+ */
 typedef struct {
-  // The pdu to be send
-  uint8_t*      pdu;    
-  // The size of the pdu
-  size_t        size;
+  // Equals the position of the slot while free, position + 1 once published
+  uint64_t          sequence;
+  // The server socket to send from
+  ServerSocket*     srcSock;
+  // The client to send to, NULL if the PDU could not be queued
+  ServerClient*     client;
+  // The size of the PDU
+  uint32_t          size;
+  // The heap copy of a PDU larger than SEND_SLOT_SIZE, otherwise NULL
+  uint8_t*          overflow;
+  // The PDU
+  uint8_t           data[SEND_SLOT_SIZE];
+} SendSlot;
+
+/**
+ * The output buffer of one client. The queue thread collects the PDUs of the
+ * client and flushes them with as few system calls as possible. Only the queue
+ * thread uses the output buffers while it runs.
+ */
+typedef struct _SendBuffer {
   // The server socket to send from
   ServerSocket* srcSock;
   // The client to send to
   ServerClient* client;
-  // The next packet in the queue
-  void*         next; 
-} SendPacket;
+  // The buffer of SEND_BUFFER_SIZE bytes
+  uint8_t*      data;
+  // The number of bytes in the buffer
+  uint32_t      used;
+  // The number of PDUs in the buffer
+  uint32_t      pdus;
+  // The time (CLOCK_MONOTONIC) the oldest unsent PDU was queued
+  struct timespec queued;
+  // The next buffer
+  struct _SendBuffer* next;
+} SendBuffer;
 
 typedef struct {
-  // the head element of the queue
-  SendPacket* head;
-  // the tail element of the queue
-  SendPacket* tail;
-  // the size of the queue
-  int        size;
+  // The ring of SEND_RING_SLOTS slots, producers do not lock the mutex
+  SendSlot*   ring;
+  // The next position producers claim
+  uint64_t    tail;
+  // The next position the queue thread takes
+  uint64_t    head;
+  // The number of producers waiting for a free slot
+  uint32_t    waiting;
+  // Indicates that the queue thread waits for the condition
+  bool        sleeping;
+  // The output buffers of all clients
+  SendBuffer* buffers;
+  // The output buffers of new clients, protected by the mutex. The queue 
+  // thread takes a buffer over with the first PDU of its client.
+  SendBuffer* added;
+  // The client whose output buffer has to be removed once the queue thread
+  // took all slots before releasePos
+  ServerClient* release;
+  uint64_t      releasePos;
   // the queue handler itself
   pthread_t handler;
   // indicates if the queue is running.
   bool        running;
+  // The queue handler runs or its output buffers are not yet removed
+  bool        active;
   // Mutex and Condition for thread handling
   Mutex       mutex;
   Cond        condition;
-  
+  // Condition used to wait for a free slot or a removed output buffer
+  Cond        idleCondition;
+  // The statistics of the queue
+  SendQueueStatistics stats;
 } SendPacketQueue;
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -84,11 +153,187 @@ typedef struct {
 // wait until notify or 1 s timeout - this is just to allow a wakeup
 #define SEND_QUEUE_WAIT_MS 1000
 
+/** The size of the output buffer of each client. */
+#define SEND_BUFFER_SIZE   (256 * 1024)
+/** Flush the output buffer of a client once it contains this many bytes. */
+#define SEND_FLUSH_BYTES   (32 * 1024)
+/** Flush the output buffer of a client latest after this many microseconds. */
+#define SEND_FLUSH_USEC    1000
+/** The number of slots of the send ring, MUST be a power of 2. */
+#define SEND_RING_SLOTS    4096
+/** The maximum number of slots the queue thread takes at once. */
+#define SEND_QUEUE_BATCH   256
+
 // The send queue 
 static SendPacketQueue* SEND_QUEUE = NULL;
 
-// Forward declaration
-SendPacket* fetchSendPacket();
+/**
+ * Return the number of microseconds between the two given times.
+ *
+ * @param from The earlier time
+ * @param to The later time
+ *
+ * @return the time difference in microseconds.
+ *
+ * @since 0.6.2.2
+ */
+static int64_t _elapsedUSec(struct timespec* from, struct timespec* to)
+{
+  return   ((int64_t)(to->tv_sec - from->tv_sec) * 1000000)
+         + ((to->tv_nsec - from->tv_nsec) / 1000);
+}
+
+/**
+ * Remove the output buffer of the given client from the list.
+ *
+ * @param list The list of output buffers.
+ * @param client The client
+ *
+ * @return The removed output buffer or NULL.
+ *
+ * @since 0.6.2.2
+ */
+static SendBuffer* _unlinkSendBuffer(SendBuffer** list, ServerClient* client)
+{
+  SendBuffer* buffer;
+
+  while (*list != NULL && (*list)->client != client)
+  {
+    list = &(*list)->next;
+  }
+  buffer = *list;
+  if (buffer != NULL)
+  {
+    *list = buffer->next;
+    buffer->next = NULL;
+  }
+
+  return buffer;
+}
+
+/**
+ * Return the output buffer of the given client. 
+ *
+ * @param queue The send queue.
+ * @param client The client
+ *
+ * @return The output buffer or NULL.
+ *
+ * @since 0.6.2.2
+ */
+static SendBuffer* _getSendBuffer(SendPacketQueue* queue, ServerClient* client)
+{
+  SendBuffer* buffer = queue->buffers;
+
+  while (buffer != NULL && buffer->client != client)
+  {
+    buffer = buffer->next;
+  }
+
+  return buffer;
+}
+
+/**
+ * Take the output buffer of a new client over, see addClientSendBuffer. The 
+ * queue mutex MUST NOT be locked.
+ *
+ * @param queue The send queue.
+ * @param client The client
+ *
+ * @return The output buffer or NULL if the client has none.
+ *
+ * @since 0.6.2.2
+ */
+static SendBuffer* _adoptSendBuffer(SendPacketQueue* queue, 
+                                    ServerClient* client)
+{
+  SendBuffer* buffer;
+
+  lockMutex(&queue->mutex);
+  buffer = _unlinkSendBuffer(&queue->added, client);
+  unlockMutex(&queue->mutex);
+  if (buffer != NULL)
+  {
+    buffer->next   = queue->buffers;
+    queue->buffers = buffer;
+  }
+
+  return buffer;
+}
+
+/**
+ * Remove the output buffer from the queue and free its memory. PDUs not yet
+ * send are dropped.
+ *
+ * @param queue The send queue.
+ * @param buffer The output buffer to be removed.
+ *
+ * @since 0.6.2.2
+ */
+static void _removeSendBuffer(SendPacketQueue* queue, SendBuffer* buffer)
+{
+  SendBuffer** ptr = &queue->buffers;
+
+  while (*ptr != NULL && *ptr != buffer)
+  {
+    ptr = &(*ptr)->next;
+  }
+  if (*ptr != NULL)
+  {
+    *ptr = buffer->next;
+  }
+  __sync_fetch_and_sub(&queue->stats.buffers, 1);
+  if (buffer->pdus > 0)
+  {
+    LOG(LEVEL_INFO, "Drop %u bytes of queued packets of a closed "
+                    "connection.", buffer->used);
+    __sync_fetch_and_add(&queue->stats.drops, buffer->pdus);
+  }
+  free(buffer->data);
+  free(buffer);
+}
+
+/**
+ * Return the slot at the given position if a producer published it.
+ *
+ * @param queue The send queue.
+ * @param pos The position in the ring.
+ *
+ * @return The published slot or NULL.
+ *
+ * @since 0.6.2.2
+ */
+static SendSlot* _getPublishedSlot(SendPacketQueue* queue, uint64_t pos)
+{
+  SendSlot* slot = &queue->ring[pos & (SEND_RING_SLOTS - 1)];
+
+  // The content of the slot is read after the sequence.
+  if (__atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE) != pos + 1)
+  {
+    return NULL;
+  }
+  return slot;
+}
+
+/**
+ * Hand the slot at the given position back to the producers.
+ *
+ * @param queue The send queue.
+ * @param slot The slot taken by the queue thread.
+ * @param pos The position of the slot.
+ *
+ * @since 0.6.2.2
+ */
+static void _freeSlot(SendPacketQueue* queue, SendSlot* slot, uint64_t pos)
+{
+  if (slot->overflow != NULL)
+  {
+    free(slot->overflow);
+    slot->overflow = NULL;
+  }
+  // The slot is used again one round later.
+  __atomic_store_n(&slot->sequence, pos + SEND_RING_SLOTS, __ATOMIC_RELEASE);
+}
 
 /**
  * Create the sender queue including the thread that manages the queue.
@@ -100,24 +345,49 @@ SendPacket* fetchSendPacket();
 bool createSendQueue()
 {
   SendPacketQueue* queue = malloc(sizeof(SendPacketQueue));
+  uint32_t idx;
+
   if (queue != NULL)
   {
-    queue->head    = NULL;
-    queue->tail    = NULL;
-    queue->size    = 0;
+    memset(queue, 0, sizeof(SendPacketQueue));
+    queue->buffers = NULL;
     queue->running = false;
+    queue->ring    = malloc(sizeof(SendSlot) * SEND_RING_SLOTS);
+    if (queue->ring == NULL)
+    {
+      free(queue);
+      return false;
+    }
+    for (idx = 0; idx < SEND_RING_SLOTS; idx++)
+    {
+      queue->ring[idx].sequence = idx;
+      queue->ring[idx].overflow = NULL;
+    }
     
     if (initMutex(&queue->mutex))
     {
-      if (!initCond(&queue->condition))
+      if (initCond(&queue->condition))
+      {
+        if (!initCond(&queue->idleCondition))
+        {
+          destroyCond(&queue->condition);
+          releaseMutex(&queue->mutex);
+          free(queue->ring);
+          free(queue);
+          queue = NULL;
+        }
+      }
+      else
       {
         releaseMutex(&queue->mutex);
+        free(queue->ring);
         free(queue);
         queue = NULL;
       }
     }
     else
     {
+      free(queue->ring);
       free(queue);
       queue = NULL;
     }    
@@ -144,12 +414,14 @@ void releaseSendQueue()
       // Stops and cleans the queue
       stopSendQueue(SEND_QUEUE);
     }
-    if (SEND_QUEUE->head != NULL)
+    if (SEND_QUEUE->buffers != NULL || SEND_QUEUE->added != NULL)
     {
       RAISE_SYS_ERROR("Queue should be already empty!");
     }
     releaseMutex(&SEND_QUEUE->mutex);
     destroyCond(&SEND_QUEUE->condition);
+    destroyCond(&SEND_QUEUE->idleCondition);
+    free (SEND_QUEUE->ring);
     free (SEND_QUEUE);
     SEND_QUEUE = NULL;
     
@@ -157,8 +429,188 @@ void releaseSendQueue()
   }  
 }
 
+/**
+ * Write the content of the output buffer to the client.
+ *
+ * @param queue The send queue.
+ * @param buffer The output buffer to be flushed.
+ * @param now The current time.
+ *
+ * @since 0.6.2.2
+ */
+static void _flushSendBuffer(SendPacketQueue* queue, SendBuffer* buffer, 
+                             struct timespec* now)
+{
+  struct iovec iov;
+
+  iov.iov_base = buffer->data;
+  iov.iov_len  = buffer->used;
+  if (buffer->used >= SEND_FLUSH_BYTES)
+  {
+    __sync_fetch_and_add(&queue->stats.sizeFlushes, 1);
+  }
+  else
+  {
+    __sync_fetch_and_add(&queue->stats.timerFlushes, 1);
+  }
+
+  if (!sendVectorToClient(buffer->srcSock, buffer->client, &iov, 1))
+  {
+    RAISE_ERROR("Could not send %u bytes of queued packets!", buffer->used);
+    __sync_fetch_and_add(&queue->stats.drops, buffer->pdus);
+  }
+
+  buffer->used = 0;
+  buffer->pdus = 0;
+  buffer->queued = *now;
+}
+
+/**
+ * Move the PDU of the slot into the output buffer of its client. PDUs that do 
+ * not fit into an output buffer are send directly once the buffer is flushed.
+ *
+ * @param queue The send queue.
+ * @param slot The published slot.
+ * @param now The current time.
+ *
+ * @since 0.6.2.2
+ */
+static void _bufferSlot(SendPacketQueue* queue, SendSlot* slot, 
+                        struct timespec* now)
+{
+  uint8_t*    pdu = slot->overflow != NULL ? slot->overflow : slot->data;
+  SendBuffer* buffer;
+
+  if (slot->client == NULL)
+  {
+    // The producer could not copy the PDU.
+    __sync_fetch_and_add(&queue->stats.drops, 1);
+    return;
+  }
+
+  buffer = _getSendBuffer(queue, slot->client);
+  if (buffer == NULL)
+  {
+    buffer = _adoptSendBuffer(queue, slot->client);
+  }
+  if (buffer == NULL)
+  {
+    // The client is released or was never added, its connection is gone.
+    __sync_fetch_and_add(&queue->stats.drops, 1);
+    return;
+  }
+  buffer->srcSock = slot->srcSock;
+
+  if (buffer->used + slot->size > SEND_BUFFER_SIZE && buffer->used > 0)
+  {
+    _flushSendBuffer(queue, buffer, now);
+  }
+  if (slot->size > SEND_BUFFER_SIZE)
+  {
+    __sync_fetch_and_add(&queue->stats.directSends, 1);
+    if (!sendPacketToClient(slot->srcSock, slot->client, pdu, slot->size))
+    {
+      __sync_fetch_and_add(&queue->stats.drops, 1);
+    }
+    return;
+  }
+
+  if (buffer->used == 0)
+  {
+    buffer->queued = *now;
+  }
+  memcpy(buffer->data + buffer->used, pdu, slot->size);
+  buffer->used += slot->size;
+  buffer->pdus++;
+}
+
+/**
+ * Take up to SEND_QUEUE_BATCH published slots out of the ring and move their
+ * PDUs into the output buffers. Producers waiting for a free slot are woken
+ * up afterwards.
+ *
+ * @param queue The send queue.
+ * @param now The current time.
+ *
+ * @return The number of slots taken.
+ *
+ * @since 0.6.2.2
+ */
+static uint32_t _dequeueBatch(SendPacketQueue* queue, struct timespec* now)
+{
+  SendSlot* slot;
+  uint64_t  pos   = queue->head;
+  uint64_t  bytes = 0;
+  uint32_t  count = 0;
+  uint32_t  depth;
+
+  depth = (uint32_t)(__atomic_load_n(&queue->tail, __ATOMIC_RELAXED) - pos);
+  if (depth > queue->stats.highWater)
+  {
+    __atomic_store_n(&queue->stats.highWater, depth, __ATOMIC_RELAXED);
+  }
+
+  while (count < SEND_QUEUE_BATCH && (slot = _getPublishedSlot(queue, pos)))
+  {
+    _bufferSlot(queue, slot, now);
+    bytes += slot->size;
+    _freeSlot(queue, slot, pos);
+    pos++;
+    count++;
+  }
+  __atomic_store_n(&queue->head, pos, __ATOMIC_RELAXED);
+
+  if (count > 0)
+  {
+    __sync_fetch_and_add(&queue->stats.pdus, count);
+    __sync_fetch_and_add(&queue->stats.bytes, bytes);
+    // Producers register under the mutex before they check for a free slot.
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&queue->waiting, __ATOMIC_RELAXED) > 0)
+    {
+      lockMutex(&queue->mutex);
+      broadcastCond(&queue->idleCondition);
+      unlockMutex(&queue->mutex);
+    }
+  }
+
+  return count;
+}
+
+/**
+ * Remove the output buffer of the client whose release is requested, once all
+ * slots queued before the request are taken. The queue mutex MUST be locked.
+ *
+ * @param queue The send queue.
+ *
+ * @since 0.6.2.2
+ */
+static void _processRelease(SendPacketQueue* queue)
+{
+  SendBuffer* buffer;
+
+  if (queue->release != NULL && (int64_t)(queue->head - queue->releasePos) >= 0)
+  {
+    buffer = _getSendBuffer(queue, queue->release);
+    if (buffer == NULL)
+    {
+      // The client never send a PDU.
+      buffer = _unlinkSendBuffer(&queue->added, queue->release);
+    }
+    if (buffer != NULL)
+    {
+      _removeSendBuffer(queue, buffer);
+    }
+    queue->release = NULL;
+    broadcastCond(&queue->idleCondition);
+  }
+}
+
 /** 
  * The thread loop of the queue. To stop the queue call stopSendQueue()
+ * The thread takes the PDUs out of the ring in batches and flushes the output
+ * buffer of a client once it contains at least SEND_FLUSH_BYTES bytes or its 
+ * oldest PDU is queued for SEND_FLUSH_USEC.
  * 
  * @param notused - Not Used
  * 
@@ -175,22 +627,52 @@ void* sendQueueThreadLoop(void* notused)
   }
   else
   {
-    SendPacket* packet = NULL;
+    SendBuffer*     buffer = NULL;
+    struct timespec now;
+    int64_t         wait, elapsed;
+    uint32_t        taken;
+
     LOG(LEVEL_DEBUG, "Enter sendqueue loop.");
-    while (queue->running)
+    while (__atomic_load_n(&queue->running, __ATOMIC_RELAXED))
     {
-      packet = fetchSendPacket(queue);
-      if (packet != NULL)
+      clock_gettime(CLOCK_MONOTONIC, &now);
+      taken = _dequeueBatch(queue, &now);
+
+      wait = (int64_t)SEND_QUEUE_WAIT_MS * 1000;
+      for (buffer = queue->buffers; buffer != NULL; buffer = buffer->next)
       {
-        if (!sendPacketToClient(packet->srcSock, packet->client, packet->pdu, 
-                                packet->size))
+        if (buffer->used == 0)
         {
-          SRXPROXY_BasicHeader* bhdr = (SRXPROXY_BasicHeader*)packet->pdu;
-          RAISE_ERROR("Could not send packet of type [%u]!", bhdr->type);
+          continue;
         }
-        free(packet->pdu);
-        free(packet);
+        elapsed = _elapsedUSec(&buffer->queued, &now);
+        if (buffer->used >= SEND_FLUSH_BYTES || elapsed >= SEND_FLUSH_USEC)
+        {
+          _flushSendBuffer(queue, buffer, &now);
+        }
+        else if (SEND_FLUSH_USEC - elapsed < wait)
+        {
+          wait = SEND_FLUSH_USEC - elapsed;
+        }
+      }
+
+      lockMutex(&queue->mutex);
+      _processRelease(queue);
+      if (taken == 0 && queue->running)
+      {
+        // Producers wake up the thread if they see it sleeping after they 
+        // published their slot.
+        __atomic_store_n(&queue->sleeping, true, __ATOMIC_RELAXED);
+        __atomic_thread_fence(__ATOMIC_SEQ_CST);
+        if (_getPublishedSlot(queue, queue->head) == NULL)
+        {
+          // Wait for new data or the next flush timer.
+          waitCond(&queue->condition, &queue->mutex, 
+                   (uint32_t)((wait + 999) / 1000));
+        }
+        __atomic_store_n(&queue->sleeping, false, __ATOMIC_RELAXED);
       }
+      unlockMutex(&queue->mutex);
     }
     LOG(LEVEL_DEBUG, "Exit send queue loop!");
   }
@@ -220,13 +702,14 @@ bool startSendQueue()
     lockMutex(&queue->mutex);
     if (!queue->running)
     {
-      queue->running = true;    
+      __atomic_store_n(&queue->running, true, __ATOMIC_RELAXED);
       if (pthread_create(&queue->handler, NULL, sendQueueThreadLoop, NULL) 
                          != 0)
       {
-        queue->running = false;
+        __atomic_store_n(&queue->running, false, __ATOMIC_RELAXED);
         RAISE_SYS_ERROR("Could not start the send queue handler!");
       }
+      queue->active = queue->running;
     }
 
     retVal = queue->running;
@@ -243,6 +726,7 @@ bool startSendQueue()
 void stopSendQueue()
 {
   SendPacketQueue* queue = SEND_QUEUE;
+  SendSlot*        slot;
   
   if (queue == NULL)
   {
@@ -253,83 +737,85 @@ void stopSendQueue()
     lockMutex(&queue->mutex);
     if (queue->running)
     {
-      queue->running = false;
+      __atomic_store_n(&queue->running, false, __ATOMIC_RELAXED);
       // Stop the queue by waking it up
       LOG(LEVEL_INFO, "StopSendQueue: send notification...");
       signalCond(&queue->condition);
     }
     unlockMutex(&queue->mutex);
-    // Give the queue thread a chance to process the notify or run into a
-    // wait timeout.   
-    LOG(LEVEL_INFO, "StopSendQueue: sleep for %u ms", SEND_QUEUE_WAIT_MS * 2);
-    usleep(SEND_QUEUE_WAIT_MS * 2);
     
-    lockMutex(&queue->mutex);
     // Free the remainder of the queue.
     LOG(LEVEL_INFO, "StopSendQueue: wait for queue thread to join...");
     pthread_join(queue->handler, NULL);
     LOG(LEVEL_INFO, "SendQueueThrealLoop STOPPED. Empty remainder of queue!");
-    SendPacket* packet = NULL;
-    while (queue->head != NULL)
+
+    lockMutex(&queue->mutex);
+    while ((slot = _getPublishedSlot(queue, queue->head)) != NULL)
     {
-      packet = queue->head;
-      queue->head = (SendPacket*)packet->next;
-      // Free the allocated memory
-      free(packet->pdu);
-      free(packet);
-      queue->size--;
+      __sync_fetch_and_add(&queue->stats.drops, 1);
+      _freeSlot(queue, slot, queue->head);
+      queue->head++;
     }
-    queue->tail = NULL;
+    while (queue->buffers != NULL)
+    {
+      _removeSendBuffer(queue, queue->buffers);
+    }
+    while (queue->added != NULL)
+    {
+      _removeSendBuffer(queue, _unlinkSendBuffer(&queue->added, 
+                                                 queue->added->client));
+    }
+    // Release all producers waiting for space and pending releases.
+    queue->release = NULL;
+    queue->active  = false;
+    broadcastCond(&queue->idleCondition);
     unlockMutex(&queue->mutex);
   }
 }
 
 /**
- * Retrieve the next packet from the queue as long as the queue is running. 
- * in case the queue is not running this method returns NULL.
- * 
- * @return  the next packet of NULL if the queue is empty.
- * 
- * @since 0.3.0
+ * Wait until the given slot is free. Producers wait here while the ring is 
+ * full, this is the backpressure of the queue.
+ *
+ * @param queue The send queue.
+ * @param slot The slot the producer wants to claim.
+ * @param pos The position the producer wants to claim.
+ *
+ * @since 0.6.2.2
  */
-SendPacket* fetchSendPacket() 
+static void _waitForSlot(SendPacketQueue* queue, SendSlot* slot, uint64_t pos)
 {
-  SendPacketQueue* queue = SEND_QUEUE;
-  SendPacket* packet = NULL;
-  
-  if (queue != NULL)
-  {
-    lockMutex(&queue->mutex);
-    while (queue->size == 0 && queue->running)
-    {
-      // wait until notify is called or after a timeout.      
-      waitCond(&queue->condition, &queue->mutex, SEND_QUEUE_WAIT_MS);
-      if(!queue->running)
-      {
-        LOG(LEVEL_INFO, "Sending queue received shutdown!");
-      }
-    }
+  __sync_fetch_and_add(&queue->stats.fullWaits, 1);
 
-    // If queue is still running and a packet is available take it
-    if (queue->running && queue->head != NULL)
+  lockMutex(&queue->mutex);
+  // Register before the slot is checked, see _dequeueBatch.
+  __atomic_add_fetch(&queue->waiting, 1, __ATOMIC_SEQ_CST);
+  while (queue->running
+         && (int64_t)(__atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE) 
+                      - pos) < 0)
+  {
+    if (__atomic_load_n(&queue->sleeping, __ATOMIC_RELAXED))
     {
-      packet = queue->head;
-      queue->size--;
-      queue->head = (SendPacket*)packet->next;
-      packet->next = NULL;   
+      signalCond(&queue->condition);
     }
-    unlockMutex(&queue->mutex);
+    waitCond(&queue->idleCondition, &queue->mutex, SEND_QUEUE_WAIT_MS);
   }
-  return packet;
+  __atomic_sub_fetch(&queue->waiting, 1, __ATOMIC_SEQ_CST);
+  unlockMutex(&queue->mutex);
 }
 
 /**
- * Queue a copy of the the packet and return the size of the queue. The copy of 
- * the packet will be free'd by the queue handler thread itself.
+ * Copy the packet into a slot of the send ring. The packet will be send by the
+ * queue handler thread together with other packets of the client. Producers
+ * do not lock the queue, only if the ring is full this call blocks until the 
+ * queue handler freed a slot. Packets larger than a slot are copied into a 
+ * heap buffer, packets larger than the output buffer are send directly by the
+ * queue handler once all previously queued packets of the client are send.
  * 
  * @param pdu The PDU to be added to the queue.
  * @param srvSoc The server socket to be used for sending
  * @param client The client to send to
+ * @param size The size of the PDU
  * 
  * @return true if the packet was queued, otherwise false.
  * 
@@ -339,52 +825,200 @@ bool addToSendQueue(uint8_t* pdu, ServerSocket* srvSoc, ServerClient* client,
                     size_t size)
 {
   SendPacketQueue* queue = SEND_QUEUE;
+  SendSlot*        slot  = NULL;
+  uint64_t         pos;
+  int64_t          diff;
+  bool             retVal = true;
   
-  SendPacket* packet = malloc(sizeof(SendPacket));
-  bool retVal = false;
-  
-  lockMutex(&queue->mutex);
-  if (packet != NULL)
+  if (!__atomic_load_n(&queue->running, __ATOMIC_RELAXED))
   {
-    memset(packet, 0, sizeof(SendPacket));
-    packet->pdu = malloc(size);
-    if (packet->pdu == NULL)
-    {
-      free(packet);
-    }
-    else
+    return false;
+  }
+
+  // Claim the slot at the tail of the ring.
+  pos = __atomic_load_n(&queue->tail, __ATOMIC_RELAXED);
+  while (true)
+  {
+    slot = &queue->ring[pos & (SEND_RING_SLOTS - 1)];
+    diff = (int64_t)(__atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE) - pos);
+    if (diff == 0)
     {
-      retVal = true;
-      packet->srcSock  = srvSoc;
-      packet->client   = client;
-      packet->next     = NULL;
-      packet->size     = size;
-      memcpy(packet->pdu, pdu, size);  
-      if (queue->size == 0)
+      if (__atomic_compare_exchange_n(&queue->tail, &pos, pos + 1, false,
+                                      __ATOMIC_RELAXED, __ATOMIC_RELAXED))
       {
-        queue->head = packet;
-        queue->tail = packet;
+        break;
       }
-      else
+    }
+    else if (diff < 0)
+    {
+      // The queue handler did not take the slot of the previous round yet.
+      _waitForSlot(queue, slot, pos);
+      if (!__atomic_load_n(&queue->running, __ATOMIC_RELAXED))
       {
-        queue->tail->next = packet;
-        queue->tail = packet;
+        return false;
       }
-      queue->size++;
-      // Signal a new packet is in the queue
-      signalCond(&queue->condition);
+    }
+    else
+    {
+      // Another producer claimed the slot.
+      pos = __atomic_load_n(&queue->tail, __ATOMIC_RELAXED);
     }
   }
-  unlockMutex(&queue->mutex);
-  
-  if (!retVal)
+
+  slot->srcSock  = srvSoc;
+  slot->client   = client;
+  slot->size     = (uint32_t)size;
+  slot->overflow = NULL;
+  if (size <= SEND_SLOT_SIZE)
   {
-    RAISE_SYS_ERROR("Not enough memory to queue packets in send queue!");
+    memcpy(slot->data, pdu, size);
+  }
+  else
+  {
+    __sync_fetch_and_add(&queue->stats.overflows, 1);
+    slot->overflow = malloc(size);
+    if (slot->overflow != NULL)
+    {
+      memcpy(slot->overflow, pdu, size);
+    }
+    else
+    {
+      // The slot is claimed and has to be published anyway.
+      RAISE_SYS_ERROR("Not enough memory to queue packets in send queue!");
+      slot->client = NULL;
+      retVal = false;
+    }
+  }
+
+  // Publish the slot, the content becomes visible together with the sequence.
+  __atomic_store_n(&slot->sequence, pos + 1, __ATOMIC_RELEASE);
+  __atomic_thread_fence(__ATOMIC_SEQ_CST);
+  if (__atomic_load_n(&queue->sleeping, __ATOMIC_RELAXED))
+  {
+    lockMutex(&queue->mutex);
+    signalCond(&queue->condition);
+    unlockMutex(&queue->mutex);
   }
   
   return retVal;
 }
 
+/**
+ * Add the output buffer of the given client. PDUs of a client without an 
+ * output buffer are dropped, therefore this MUST be called before the first
+ * PDU is send to the client.
+ *
+ * @param client The new client.
+ *
+ * @return false if not enough memory is available.
+ *
+ * @since 0.6.2.2
+ */
+bool addClientSendBuffer(ServerClient* client)
+{
+  SendPacketQueue* queue = SEND_QUEUE;
+  SendBuffer*      buffer;
+
+  if (queue == NULL)
+  {
+    // PDUs are send directly.
+    return true;
+  }
+
+  buffer = malloc(sizeof(SendBuffer));
+  if (buffer != NULL)
+  {
+    memset(buffer, 0, sizeof(SendBuffer));
+    buffer->data = malloc(SEND_BUFFER_SIZE);
+    if (buffer->data == NULL)
+    {
+      free(buffer);
+      buffer = NULL;
+    }
+  }
+  if (buffer == NULL)
+  {
+    RAISE_SYS_ERROR("Not enough memory for the output buffer of the client!");
+    return false;
+  }
+  buffer->client = client;
+
+  lockMutex(&queue->mutex);
+  buffer->next  = queue->added;
+  queue->added  = buffer;
+  unlockMutex(&queue->mutex);
+  __sync_fetch_and_add(&queue->stats.buffers, 1);
+
+  return true;
+}
+
+/**
+ * Remove the output buffer of the given client. Packets not yet send will be
+ * dropped. This function blocks until the buffer is not used anymore and MUST 
+ * be called before the client is released.
+ *
+ * @param client The client whose output buffer has to be removed.
+ *
+ * @since 0.6.2.2
+ */
+void releaseClientSendBuffer(ServerClient* client)
+{
+  SendPacketQueue* queue = SEND_QUEUE;
+
+  if (queue != NULL)
+  {
+    lockMutex(&queue->mutex);
+    // The queue handler owns the output buffers, it removes the buffer once it
+    // took all PDUs queued so far. Stopping the queue removes all buffers.
+    while (queue->active && queue->release != NULL)
+    {
+      waitCond(&queue->idleCondition, &queue->mutex, SEND_QUEUE_WAIT_MS);
+    }
+    if (queue->active)
+    {
+      queue->release    = client;
+      queue->releasePos = __atomic_load_n(&queue->tail, __ATOMIC_RELAXED);
+      signalCond(&queue->condition);
+      while (queue->active && queue->release == client)
+      {
+        waitCond(&queue->idleCondition, &queue->mutex, SEND_QUEUE_WAIT_MS);
+      }
+    }
+    unlockMutex(&queue->mutex);
+  }
+}
+
+/**
+ * Fill the statistics of the send queue. If the send queue is not used all
+ * values are zero.
+ *
+ * @param stats The statistics to be filled.
+ *
+ * @since 0.6.2.2
+ */
+void getSendQueueStatistics(SendQueueStatistics* stats)
+{
+  SendPacketQueue* queue = SEND_QUEUE;
+
+  memset(stats, 0, sizeof(SendQueueStatistics));
+  if (queue != NULL)
+  {
+    stats->pdus         = __sync_fetch_and_add(&queue->stats.pdus, 0);
+    stats->bytes        = __sync_fetch_and_add(&queue->stats.bytes, 0);
+    stats->sizeFlushes  = __sync_fetch_and_add(&queue->stats.sizeFlushes, 0);
+    stats->timerFlushes = __sync_fetch_and_add(&queue->stats.timerFlushes, 0);
+    stats->directSends  = __sync_fetch_and_add(&queue->stats.directSends, 0);
+    stats->fullWaits    = __sync_fetch_and_add(&queue->stats.fullWaits, 0);
+    stats->overflows    = __sync_fetch_and_add(&queue->stats.overflows, 0);
+    stats->drops        = __sync_fetch_and_add(&queue->stats.drops, 0);
+    stats->buffers      = __sync_fetch_and_add(&queue->stats.buffers, 0);
+    stats->highWater    = __atomic_load_n(&queue->stats.highWater, 
+                                          __ATOMIC_RELAXED);
+    stats->depth = (uint32_t)(__atomic_load_n(&queue->tail, __ATOMIC_RELAXED)
+                              - __atomic_load_n(&queue->head, __ATOMIC_RELAXED));
+  }
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 // Packet Sending methods
 ////////////////////////////////////////////////////////////////////////////////
@@ -415,6 +1049,7 @@ bool __sendPacketToClient(ServerSocket* srvSoc, ServerClient* client,
     {
       LOG(LEVEL_WARNING, "The sender queue is not initialized, send PDU directly "
                          "without queue!");
+      retVal = sendPacketToClient(srvSoc, client, pdu, size);
     }
     else
     {
@@ -432,11 +1067,12 @@ bool __sendPacketToClient(ServerSocket* srvSoc, ServerClient* client,
  * @param proxyID The id of the proxy
  * @param srvSoc The server socket
  * @param client The client who received the original message
+ * @param capabilities The capabilities negotiated with this proxy.
  *
  * @return true if the packet could be send, otherwise false.
  */
 bool sendHelloResponse(ServerSocket* srvSoc, ServerClient* client,
-                       uint32_t proxyID)
+                       uint32_t proxyID, uint32_t capabilities)
 {
   bool retVal = true;
   uint32_t length = sizeof(SRXPROXY_HELLO_RESPONSE);
@@ -445,6 +1081,7 @@ bool sendHelloResponse(ServerSocket* srvSoc, ServerClient* client,
 
   pdu->type    = PDU_SRXPROXY_HELLO_RESPONSE;
   pdu->version = htons(SRX_PROTOCOL_VER);
+  pdu->capabilities = htonl(capabilities);
   pdu->length  = htonl(length);
   pdu->proxyIdentifier = htonl(proxyID);
   
@@ -489,29 +1126,26 @@ bool sendGoodbye(ServerSocket* srvSoc, ServerClient* client, bool useQueue)
 }
 
 /**
- * Send a verification notification. Does use the sending queue.
+ * Fill the given verification notification PDU.
  *
- * @param srvSoc The server socket
- * @param client The client of the communication.
+ * @param pdu The PDU to be filled.
  * @param updateID The id of the update.
  * @param resultType The type of results.
  * @param requestToken The token id of a request. Must be disabled 
  *                     (DONOTUSE_REQUEST_TOKEN) if the receipt flag is not set!
  * @param roaResult The ROA validation result.
  * @param bgpsecResult The BGPSEC validation result.
- * @param useQueue use the sending queue or not.
+ * @param aspaResult The ASPA validation result.
  *
- * @return true if the packet could be send, otherwise false.
+ * @since 0.6.2.2
  */
-bool sendVerifyNotification(ServerSocket* srvSoc, ServerClient* client,
+void initVerifyNotification(SRXPROXY_VERIFY_NOTIFICATION* pdu,
                             SRxUpdateID updateID, uint8_t resultType,
                             uint32_t requestToken,
                             uint8_t roaResult, uint8_t bgpsecResult, 
-                            uint8_t aspaResult, bool useQueue)
+                            uint8_t aspaResult)
 {
-  bool retVal = true;
   uint32_t length = sizeof(SRXPROXY_VERIFY_NOTIFICATION);
-  SRXPROXY_VERIFY_NOTIFICATION* pdu = malloc(length);
   memset(pdu, 0, length);
 
   pdu->type          = PDU_SRXPROXY_VERI_NOTIFICATION;
@@ -519,7 +1153,7 @@ bool sendVerifyNotification(ServerSocket* srvSoc, ServerClient* client,
   pdu->requestToken  = htonl(requestToken);
   pdu->roaResult     = roaResult;
   pdu->bgpsecResult  = bgpsecResult;
-  pdu->aspaResult   = aspaResult;
+  pdu->aspaResult    = aspaResult;
   pdu->length        = htonl(length);
   pdu->updateID      = htonl(updateID);
   
@@ -528,8 +1162,75 @@ bool sendVerifyNotification(ServerSocket* srvSoc, ServerClient* client,
     LOG(LEVEL_NOTICE, "Send a notification of update 0x%0aX with request "
         "token 0x%08X but no receipt flag set!", updateID, requestToken);
   }
+}
 
-  pdu->length = htonl(length);
+/**
+ * Send a bulk verification notification. The given PDU must be followed by 
+ * the noNotifications verification notifications, the header will be filled 
+ * by this function.
+ *
+ * @param srvSoc The server socket
+ * @param client The client of the communication.
+ * @param pdu The bulk notification followed by the notifications.
+ * @param noNotifications The number of notifications.
+ * @param useQueue use the sending queue or not.
+ *
+ * @return true if the packet could be send, otherwise false.
+ *
+ * @since 0.6.2.2
+ */
+bool sendVerifyBulkNotification(ServerSocket* srvSoc, ServerClient* client,
+                                SRXPROXY_VERIFY_BULK_NOTIFICATION* pdu,
+                                uint32_t noNotifications, bool useQueue)
+{
+  bool retVal = true;
+  uint32_t length =   sizeof(SRXPROXY_VERIFY_BULK_NOTIFICATION)
+                    + (noNotifications * sizeof(SRXPROXY_VERIFY_NOTIFICATION));
+
+  memset(pdu, 0, sizeof(SRXPROXY_VERIFY_BULK_NOTIFICATION));
+  pdu->type            = PDU_SRXPROXY_VERI_BULK_NOTIFICATION;
+  pdu->noNotifications = htonl(noNotifications);
+  pdu->length          = htonl(length);
+
+  if (!__sendPacketToClient(srvSoc, client, pdu, length, useQueue))
+  {
+    RAISE_ERROR("Could not send the bulk verify notification with %u "
+                "notifications!", noNotifications);
+    retVal = false;
+  }
+
+  return retVal;
+}
+
+/**
+ * Send a verification notification. Does use the sending queue.
+ *
+ * @param srvSoc The server socket
+ * @param client The client of the communication.
+ * @param updateID The id of the update.
+ * @param resultType The type of results.
+ * @param requestToken The token id of a request. Must be disabled 
+ *                     (DONOTUSE_REQUEST_TOKEN) if the receipt flag is not set!
+ * @param roaResult The ROA validation result.
+ * @param bgpsecResult The BGPSEC validation result.
+ * @param useQueue use the sending queue or not.
+ *
+ * @return true if the packet could be send, otherwise false.
+ */
+bool sendVerifyNotification(ServerSocket* srvSoc, ServerClient* client,
+                            SRxUpdateID updateID, uint8_t resultType,
+                            uint32_t requestToken,
+                            uint8_t roaResult, uint8_t bgpsecResult, 
+                            uint8_t aspaResult, bool useQueue)
+{
+  bool retVal = true;
+  uint32_t length = sizeof(SRXPROXY_VERIFY_NOTIFICATION);
+  // The PDU is copied into the send queue, no need to allocate it.
+  SRXPROXY_VERIFY_NOTIFICATION  notification;
+  SRXPROXY_VERIFY_NOTIFICATION* pdu = &notification;
+
+  initVerifyNotification(pdu, updateID, resultType, requestToken, roaResult,
+                         bgpsecResult, aspaResult);
   
   if (!__sendPacketToClient(srvSoc, client, pdu, length, useQueue))
   {
@@ -543,7 +1244,6 @@ bool sendVerifyNotification(ServerSocket* srvSoc, ServerClient* client,
     LOG(LEVEL_DEBUG, "Notification send for update [0x%08X]", updateID);    
   }
 
-  free(pdu);
   return retVal;
 }
 
@@ -22,11 +22,18 @@
  *
  * This file contains the functions to send srx-proxy packets.
  * 
- * @version 0.3.0
+ * @version 0.6.2.2
  *
  * Changelog:
  * 
  * -----------------------------------------------------------------------------
+ *   0.6.2.2 - 2026/10/17
+ *   * Added SendQueueStatistics, getSendQueueStatistics, addClientSendBuffer
+ *     and releaseClientSendBuffer.
+ *   * Added queue depth, high-water mark, overflow and drop counters.
+ *   * Made __sendPacketToClient public.
+ *   * Added parameter capabilities to sendHelloResponse.
+ *   * Added initVerifyNotification and sendVerifyBulkNotification.
  *   0.3.0 - 2013/01/02 - oborchert
  *   * Added changelog.
  *   * Added sending queue to prevent buffer overflows in the receiver socket 
@@ -40,6 +47,37 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include "util/server_socket.h"
+#include "shared/srx_packets.h"
+
+/**
+ * The statistics of the send queue.
+ *
+ * @since 0.6.2.2
+ */
+typedef struct {
+  /** The number of PDUs handed to the send queue. */
+  uint64_t pdus;
+  /** The number of bytes handed to the send queue. */
+  uint64_t bytes;
+  /** Flushes because the output buffer reached the flush size. */
+  uint64_t sizeFlushes;
+  /** Flushes because the flush timer of the output buffer expired. */
+  uint64_t timerFlushes;
+  /** PDUs larger than the output buffer that were send directly. */
+  uint64_t directSends;
+  /** The number of times a producer had to wait for a free slot. */
+  uint64_t fullWaits;
+  /** PDUs larger than a slot that were copied into a heap buffer. */
+  uint64_t overflows;
+  /** PDUs dropped because of a closed connection or a failed send. */
+  uint64_t drops;
+  /** The number of output buffers currently allocated. */
+  uint32_t buffers;
+  /** The number of slots currently queued. */
+  uint32_t depth;
+  /** The highest number of queued slots the queue thread found. */
+  uint32_t highWater;
+} SendQueueStatistics;
 
 /**
  * Create the sender queue including the thread that manages the queue.
@@ -75,17 +113,70 @@ void stopSendQueue();
  */
 void releaseSendQueue();
 
+/**
+ * Add the output buffer of the given client. PDUs of a client without an 
+ * output buffer are dropped, therefore this MUST be called before the first
+ * PDU is send to the client.
+ *
+ * @param client The new client.
+ *
+ * @return false if not enough memory is available.
+ *
+ * @since 0.6.2.2
+ */
+bool addClientSendBuffer(ServerClient* client);
+
+/**
+ * Remove the output buffer of the given client. Packets not yet send will be
+ * dropped. This function blocks until the buffer is not used anymore and MUST 
+ * be called before the client is released.
+ *
+ * @param client The client whose output buffer has to be removed.
+ *
+ * @since 0.6.2.2
+ */
+void releaseClientSendBuffer(ServerClient* client);
+
+/**
+ * Fill the statistics of the send queue. If the send queue is not used all
+ * values are zero.
+ *
+ * @param stats The statistics to be filled.
+ *
+ * @since 0.6.2.2
+ */
+void getSendQueueStatistics(SendQueueStatistics* stats);
+
+/**
+ * Send the given PDU to the client, either directly or using the send queue.
+ * The PDU is copied into the send queue and can be released by the caller
+ * once this function returns.
+ *
+ * @param srvSoc The server socket
+ * @param client The server client
+ * @param pdu The data to be send
+ * @param size The length of the data to be send.
+ * @param useQueue Use the queue if possible.
+ *
+ * @return true if the PDU could be send or queued, otherwise false.
+ *
+ * @since 0.6.2.2
+ */
+bool __sendPacketToClient(ServerSocket* srvSoc, ServerClient* client,
+                          void* pdu, size_t size, bool useQueue);
+
 /**
  * Send a hello response to the client. This method does not use the send queue
  *
  * @param proxyID The id of the proxy
  * @param srcSock The server socket
  * @param client The client who received the original message
+ * @param capabilities The capabilities negotiated with this proxy.
  *
  * @return true if the packet could be send, otherwise false.
  */
 bool sendHelloResponse(ServerSocket* srcSock, ServerClient* client,
-                       uint32_t proxyID);
+                       uint32_t proxyID, uint32_t capabilities);
 
 /**
  * Send a goodbye packet to the proxy. The proxy does not use the keepWindow,
@@ -120,6 +211,45 @@ bool sendVerifyNotification(ServerSocket* svrSock, ServerClient* client,
                             uint8_t roaResult, uint8_t bgpsecResult, 
                             uint8_t aspaResult, bool useQueue);
 
+/**
+ * Fill the given verification notification PDU.
+ *
+ * @param pdu The PDU to be filled.
+ * @param updateID The id of the update.
+ * @param resultType The type of results.
+ * @param requestToken The token id of a request. Must be disabled 
+ *                     (DONOTUSE_REQUEST_TOKEN) if the receipt flag is not set!
+ * @param roaResult The ROA validation result.
+ * @param bgpsecResult The BGPSEC validation result.
+ * @param aspaResult The ASPA validation result.
+ *
+ * @since 0.6.2.2
+ */
+void initVerifyNotification(SRXPROXY_VERIFY_NOTIFICATION* pdu,
+                            SRxUpdateID updateID, uint8_t resultType,
+                            uint32_t requestToken,
+                            uint8_t roaResult, uint8_t bgpsecResult, 
+                            uint8_t aspaResult);
+
+/**
+ * Send a bulk verification notification. The given PDU must be followed by 
+ * the noNotifications verification notifications, the header will be filled 
+ * by this function.
+ *
+ * @param svrSock The server socket
+ * @param client The client of the communication.
+ * @param pdu The bulk notification followed by the notifications.
+ * @param noNotifications The number of notifications.
+ * @param useQueue use the sending queue or not.
+ *
+ * @return true if the packet could be send, otherwise false.
+ *
+ * @since 0.6.2.2
+ */
+bool sendVerifyBulkNotification(ServerSocket* svrSock, ServerClient* client,
+                                SRXPROXY_VERIFY_BULK_NOTIFICATION* pdu,
+                                uint32_t noNotifications, bool useQueue);
+
 /**
  * Send a signature notification.
  *
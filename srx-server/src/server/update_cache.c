@@ -20,15 +20,30 @@
  * other licenses. Please refer to the licenses of all libraries required
  * by this software.
  *
- * The update cache holds the updates in two separate structures, one is the
- * update cache, a hash table with the update id as key and the update as
- * value. The other is a list, that allows to scan through all updates. Both
- * MUST be maintained the same.
+ * The update cache holds the updates in a hash table with the update id as key
+ * and the update as value. The cache entries are allocated from a memory pool
+ * and returned into the pool by the garbage collector.
  *
- * @version 0.6.2.1
+ * @version 0.6.2.2
  *
  * Changelog:
  * -----------------------------------------------------------------------------
+ * 0.6.2.2 - 2026/10/17
+ *           * Added the path index (AS path ID -> update IDs).
+ *           * Added the garbage collector thread. Updates without clients are
+ *             scheduled in a min-heap ordered by the end of their keep window
+ *             and removed from the update cache, the prefix cache, the SKI
+ *             cache, and the AS path cache once the keep window expired.
+ *           * Cache entries and the client lists are allocated from memory
+ *             pools and returned into the pools by the garbage collector.
+ *             Removed allItems, all iterations use the hash table.
+ *           * The SKI cache registration is removed by the garbage collector
+ *             and not anymore in deleteUpdateFromCache.
+ *           * Fixed unregisterClientID which used the keep time as GC time.
+ *           * releaseUpdateCache empties the cache before releasing the locks.
+ *           * An update stays in the table while the garbage collector removes
+ *             it from the prefix and SKI cache. Storing the update ID again 
+ *             or registering a client with it waits until it is deleted.
  * 0.6.2.1 - 2024/09/10 - oborchert
  *           * Changed data types from u_int... to uint... which follows C99
  * 0.5.0.0  - 2017/07/11 - kyehwanl
@@ -85,6 +100,7 @@
 #include "server/server_connection_handler.h"
 #include "server/prefix_cache.h"
 #include "server/ski_cache.h"
+#include "server/aspath_cache.h"
 #include "shared/srx_defs.h"
 #include "shared/srx_packets.h"
 #include "util/log.h"
@@ -93,16 +109,20 @@
 #include "util/mutex.h"
 #include "main.h"
 
-/* Number of preallocated result slots */
-//#define NUM_PREALLOC  20
-#define NUM_PREALLOC  1
+/** Number of cache entries per memory pool slab. */
+#define UC_ENTRIES_PER_SLAB 1024
 
 #define HDR "([0x%08X] UpdateCache): "
 
+/** Initial number of slots in the garbage collector heap. */
+#define GC_HEAP_INIT_SIZE 1024
+/** Maximum number of updates removed per garbage collector run. */
+#define GC_BATCH_SIZE     1024
+
 /**
  * A single update result.
  */
-typedef struct {
+typedef struct _CacheEntry {
   uint8_t* clients;           // clients with value 0 are unused.
   uint8_t  noPossibleClients; // maximum number of clients in list without
                               // extending
@@ -123,8 +143,28 @@ typedef struct {
 
   UC_UpdateData    pathData;      // This element replaces the blob.
   uint32_t         aspathCacheID; // aspath cache key ID
+
+  bool             inUse;         // false if the entry is in the memory pool.
+  bool             deleting;      // The garbage collector removes the update.
+  bool             pooledClients; // clients is allocated from the client pool.
+  time_t           gcTime;        // Real time when the update can be deleted.
+  uint32_t         gcIndex;       // Position + 1 in the GC heap, 0 = none.
 } CacheEntry;
 
+/** Initial number of update IDs per path index entry. */
+#define PATH_INDEX_INIT_SIZE 2
+
+/**
+ * Entry of the path index. Lists all updates that use the AS path.
+ */
+typedef struct {
+  UT_hash_handle   hh;
+  uint32_t         pathId;
+  SRxUpdateID*     updateIDs;
+  uint32_t         count;
+  uint32_t         size;
+} PathIndexEntry;
+
 // Forward declarations
 bool _addClientReference(UpdateCache* self, CacheEntry* cEntry,
                          uint8_t clientID, ProxyClientMapping* clientMapping);
@@ -152,6 +192,31 @@ static void _cleanCachPathData(CacheEntry* cEntry)
   memset(data, 0, sizeof(UC_UpdateData));
 }
 
+/**
+ * Release the memory attached to the cache entry and return the cache entry
+ * into the memory pool.
+ *
+ * @param self The update cache
+ * @param cEntry The cache entry.
+ *
+ * @since 0.6.2.2
+ */
+static void _releaseCacheEntry(UpdateCache* self, CacheEntry* cEntry)
+{
+  _cleanCachPathData(cEntry);
+  if (cEntry->pooledClients)
+  {
+    freeToMemPool(self->clientPool, cEntry->clients);
+  }
+  else
+  {
+    free(cEntry->clients);
+  }
+  cEntry->clients = NULL;
+  cEntry->inUse   = false;
+  freeToMemPool(self->entryPool, cEntry);
+}
+
 /**
  * This function selects the data from bgpsecData that is used for ID generation
  * - see srx_identifier::generateIdentifier and stores it in the cache entry.
@@ -251,6 +316,31 @@ static bool tableFind(UpdateCache* self, SRxUpdateID updateID, CacheEntry** out)
   return (*out != NULL);
 }
 
+/**
+ * Find the update in the table. An update that is being deleted by the 
+ * garbage collector is still registered with the prefix and SKI cache under
+ * its ID, this method waits until the garbage collector deleted it. The caller
+ * MUST hold the itemMutex.
+ *
+ * @param self The update cache.
+ * @param updateID The update ID to search for.
+ * @param out the cache entry containing the update in case it was found.
+ *
+ * @return true if the update was found, otherwise false.
+ *
+ * @since 0.6.2.2
+ */
+static bool tableFindStored(UpdateCache* self, SRxUpdateID updateID, 
+                            CacheEntry** out)
+{
+  while (tableFind(self, updateID, out) && (*out)->deleting)
+  {
+    waitCond(&self->deleteCond, &self->itemMutex, 0);
+  }
+
+  return (*out != NULL);
+}
+
 /**
  * Add the update encapsulated in the cache entry element into the cache. The
  * key is the updateID and the value is the cache entry containing the update
@@ -281,6 +371,365 @@ static void tableDel(UpdateCache* self, CacheEntry* cEntry)
   unlockWriteLock(&self->tableLock);
 }
 
+/**
+ * Register the update with its AS path in the path index.
+ * 
+ * @param self The update cache.
+ * @param cEntry The update
+ * 
+ * @since 0.6.2.2
+ */
+static void pathIndexAdd(UpdateCache* self, CacheEntry* cEntry)
+{
+  PathIndexEntry* pEntry = NULL;
+  
+  if (cEntry->aspathCacheID == 0)
+  {
+    return;
+  }
+  
+  acquireWriteLock(&self->tableLock);
+  HASH_FIND(hh, (PathIndexEntry*)self->pathIndex, &cEntry->aspathCacheID, 
+            sizeof(uint32_t), pEntry);
+  if (pEntry == NULL)
+  {
+    pEntry = calloc(1, sizeof(PathIndexEntry));
+    if (pEntry != NULL)
+    {
+      pEntry->pathId = cEntry->aspathCacheID;
+      HASH_ADD(hh, *((PathIndexEntry**)&self->pathIndex), pathId, 
+               sizeof(uint32_t), pEntry);
+    }
+  }
+  if (pEntry != NULL && pEntry->count == pEntry->size)
+  {
+    uint32_t     newSize = pEntry->size ? pEntry->size << 1 
+                                        : PATH_INDEX_INIT_SIZE;
+    SRxUpdateID* newList = realloc(pEntry->updateIDs, 
+                                   newSize * sizeof(SRxUpdateID));
+    if (newList != NULL)
+    {
+      pEntry->updateIDs = newList;
+      pEntry->size      = newSize;
+    }
+  }
+  if (pEntry != NULL && pEntry->count < pEntry->size)
+  {
+    pEntry->updateIDs[pEntry->count++] = cEntry->updateID;
+  }
+  else
+  {
+    RAISE_SYS_ERROR("Could not register update [0x%08X] in the path index!",
+                    cEntry->updateID);
+  }
+  unlockWriteLock(&self->tableLock);
+}
+
+/**
+ * Remove the update from the path index.
+ * 
+ * @param self The update cache.
+ * @param cEntry The update
+ * 
+ * @return true if the update was the last one that used the AS path.
+ * 
+ * @since 0.6.2.2
+ */
+static bool pathIndexDel(UpdateCache* self, CacheEntry* cEntry)
+{
+  PathIndexEntry* pEntry = NULL;
+  bool lastRef = false;
+  uint32_t idx;
+  
+  if (cEntry->aspathCacheID == 0)
+  {
+    return false;
+  }
+  
+  acquireWriteLock(&self->tableLock);
+  HASH_FIND(hh, (PathIndexEntry*)self->pathIndex, &cEntry->aspathCacheID, 
+            sizeof(uint32_t), pEntry);
+  if (pEntry != NULL)
+  {
+    for (idx = 0; idx < pEntry->count; idx++)
+    {
+      if (pEntry->updateIDs[idx] == cEntry->updateID)
+      {
+        pEntry->updateIDs[idx] = pEntry->updateIDs[--pEntry->count];
+        break;
+      }
+    }
+    if (pEntry->count == 0)
+    {
+      HASH_DEL(*((PathIndexEntry**)&self->pathIndex), pEntry);
+      free(pEntry->updateIDs);
+      free(pEntry);
+      lastRef = true;
+    }
+  }
+  unlockWriteLock(&self->tableLock);
+  
+  return lastRef;
+}
+
+/**
+ * Determine if any update uses the given AS path.
+ * 
+ * @param self The update cache.
+ * @param pathId The AS path ID
+ * 
+ * @return true if at least one update uses the AS path.
+ * 
+ * @since 0.6.2.2
+ */
+static bool pathIndexHas(UpdateCache* self, uint32_t pathId)
+{
+  PathIndexEntry* pEntry = NULL;
+  
+  acquireReadLock(&self->tableLock);
+  HASH_FIND(hh, (PathIndexEntry*)self->pathIndex, &pathId, sizeof(uint32_t), 
+            pEntry);
+  unlockReadLock(&self->tableLock);
+  
+  return pEntry != NULL;
+}
+
+/**
+ * Remove all entries of the path index.
+ * 
+ * @param self The update cache.
+ * 
+ * @since 0.6.2.2
+ */
+static void pathIndexEmpty(UpdateCache* self)
+{
+  PathIndexEntry* pEntry = NULL;
+  PathIndexEntry* tmp    = NULL;
+  
+  HASH_ITER(hh, (PathIndexEntry*)self->pathIndex, pEntry, tmp)
+  {
+    HASH_DEL(*((PathIndexEntry**)&self->pathIndex), pEntry);
+    free(pEntry->updateIDs);
+    free(pEntry);
+  }
+}
+
+/**
+ * Return a copy of the IDs of all updates that use the given AS path.
+ * 
+ * @param self The update cache.
+ * @param pathId The AS path ID
+ * @param count OUT: The number of update IDs returned.
+ * 
+ * @return The list of update IDs or NULL. The list MUST be freed by the 
+ *         caller.
+ * 
+ * @since 0.6.2.2
+ */
+SRxUpdateID* getUpdateIDsOfAspath(UpdateCache* self, uint32_t pathId, 
+                                  uint32_t* count)
+{
+  PathIndexEntry* pEntry = NULL;
+  SRxUpdateID*    list   = NULL;
+  
+  *count = 0;
+  acquireReadLock(&self->tableLock);
+  HASH_FIND(hh, (PathIndexEntry*)self->pathIndex, &pathId, sizeof(uint32_t), 
+            pEntry);
+  if (pEntry != NULL && pEntry->count > 0)
+  {
+    list = malloc(pEntry->count * sizeof(SRxUpdateID));
+    if (list != NULL)
+    {
+      memcpy(list, pEntry->updateIDs, pEntry->count * sizeof(SRxUpdateID));
+      *count = pEntry->count;
+    }
+  }
+  unlockReadLock(&self->tableLock);
+  
+  return list;
+}
+
+
+/*---------------------------
+ * Garbage collector functions
+ *
+ * @note The GC heap is guarded by the gcMutex. The gcMutex is always the 
+ *       innermost lock.
+ */
+/**
+ * Swap the two heap slots and update the heap index of both entries.
+ *
+ * @param heap The GC heap
+ * @param a The first slot
+ * @param b The second slot
+ *
+ * @since 0.6.2.2
+ */
+static void _gcHeapSwap(CacheEntry** heap, uint32_t a, uint32_t b)
+{
+  CacheEntry* tmp = heap[a];
+  heap[a] = heap[b];
+  heap[b] = tmp;
+  heap[a]->gcIndex = a + 1;
+  heap[b]->gcIndex = b + 1;
+}
+
+/**
+ * Restore the heap order starting at the given slot.
+ *
+ * @param self The update cache
+ * @param pos The slot whose entry changed its GC time.
+ *
+ * @since 0.6.2.2
+ */
+static void _gcHeapFix(UpdateCache* self, uint32_t pos)
+{
+  CacheEntry** heap = (CacheEntry**)self->gcHeap;
+  uint32_t     parent, child;
+
+  // Move up
+  while (pos > 0)
+  {
+    parent = (pos - 1) >> 1;
+    if (heap[parent]->gcTime <= heap[pos]->gcTime)
+    {
+      break;
+    }
+    _gcHeapSwap(heap, parent, pos);
+    pos = parent;
+  }
+
+  // Move down
+  while ((child = (pos << 1) + 1) < self->gcHeapSize)
+  {
+    if (   ((child + 1) < self->gcHeapSize)
+        && (heap[child + 1]->gcTime < heap[child]->gcTime))
+    {
+      child++;
+    }
+    if (heap[pos]->gcTime <= heap[child]->gcTime)
+    {
+      break;
+    }
+    _gcHeapSwap(heap, pos, child);
+    pos = child;
+  }
+}
+
+/**
+ * Remove the entry at the given heap slot. The caller MUST hold the gcMutex.
+ *
+ * @param self The update cache
+ * @param pos The slot to be removed.
+ *
+ * @return The removed cache entry.
+ *
+ * @since 0.6.2.2
+ */
+static CacheEntry* _gcHeapRemove(UpdateCache* self, uint32_t pos)
+{
+  CacheEntry** heap   = (CacheEntry**)self->gcHeap;
+  CacheEntry*  cEntry = heap[pos];
+  uint32_t     last   = --self->gcHeapSize;
+
+  if (pos != last)
+  {
+    heap[pos] = heap[last];
+    heap[pos]->gcIndex = pos + 1;
+    _gcHeapFix(self, pos);
+  }
+  heap[last]      = NULL;
+  cEntry->gcIndex = 0;
+
+  return cEntry;
+}
+
+/**
+ * Schedule the update for garbage collection once the keep time expired. An
+ * already scheduled update will be re-scheduled. The caller MUST hold the
+ * itemMutex.
+ *
+ * @param self The update cache
+ * @param cEntry The update
+ * @param keepTime The time in seconds the update will be kept.
+ *
+ * @since 0.6.2.2
+ */
+static void _gcSchedule(UpdateCache* self, CacheEntry* cEntry, 
+                        uint32_t keepTime)
+{
+  CacheEntry** heap = NULL;
+  uint32_t     newSize;
+
+  lockMutex(&self->gcMutex);
+  cEntry->gcTime = time(NULL) + keepTime;
+  if (cEntry->gcIndex == 0)
+  {
+    if (self->gcHeapSize == self->gcHeapCapacity)
+    {
+      newSize = self->gcHeapCapacity ? self->gcHeapCapacity << 1
+                                     : GC_HEAP_INIT_SIZE;
+      heap = realloc(self->gcHeap, newSize * sizeof(CacheEntry*));
+      if (heap == NULL)
+      {
+        unlockMutex(&self->gcMutex);
+        RAISE_SYS_ERROR("Could not schedule update [0x%08X] for garbage "
+                        "collection!", cEntry->updateID);
+        return;
+      }
+      self->gcHeap         = (void**)heap;
+      self->gcHeapCapacity = newSize;
+    }
+    self->gcHeap[self->gcHeapSize] = cEntry;
+    cEntry->gcIndex = ++self->gcHeapSize;
+  }
+  _gcHeapFix(self, cEntry->gcIndex - 1);
+
+  // Wake up the garbage collector if the next deadline changed.
+  if (cEntry->gcIndex == 1)
+  {
+    signalCond(&self->gcCond);
+  }
+  unlockMutex(&self->gcMutex);
+}
+
+/**
+ * Remove the update from the garbage collection schedule. The caller MUST hold
+ * the itemMutex.
+ *
+ * @param self The update cache
+ * @param cEntry The update
+ *
+ * @since 0.6.2.2
+ */
+static void _gcUnschedule(UpdateCache* self, CacheEntry* cEntry)
+{
+  lockMutex(&self->gcMutex);
+  if (cEntry->gcIndex != 0)
+  {
+    _gcHeapRemove(self, cEntry->gcIndex - 1);
+  }
+  unlockMutex(&self->gcMutex);
+}
+
+/**
+ * Return the number of bytes the update occupies in the update cache.
+ *
+ * @param cEntry The update
+ *
+ * @return The number of bytes.
+ *
+ * @since 0.6.2.2
+ */
+static uint32_t _gcEntrySize(CacheEntry* cEntry)
+{
+  return sizeof(CacheEntry) + cEntry->noPossibleClients
+         + (cEntry->pathData.asn_path != NULL ? cEntry->pathData.hops * 4 : 0)
+         + (cEntry->pathData.bgpsec_path != NULL ? cEntry->pathData.length
+                                                 : 0);
+}
+
 /*--------
  * Exports
  */
@@ -310,36 +759,91 @@ bool createUpdateCache(UpdateCache* self, UpdateResultChanged chCallback,
     releaseMutex(&self->itemMutex);
     return false;
   }
+  if (!initCond(&self->deleteCond))
+  {
+    RAISE_ERROR("Unable to setup the delete condition");
+    releaseRWLock(&self->tableLock);
+    releaseMutex(&self->itemMutex);
+    return false;
+  }
+  if (!initMutex(&self->gcMutex) || !initCond(&self->gcCond))
+  {
+    RAISE_ERROR("Unable to setup the garbage collector Mutex");
+    destroyCond(&self->deleteCond);
+    releaseRWLock(&self->tableLock);
+    releaseMutex(&self->itemMutex);
+    return false;
+  }
 
   self->resChangedCallback = chCallback;
   // By default keep the hashtable null, it will be initialized with the first
   // element that will be added.
   self->table = NULL;
-  self->itemsUsed = NUM_PREALLOC;
+  self->pathIndex = NULL;
   self->minNumberOfClients = minNumberOfClients;
   self->lockedClients = malloc(MAX_PROXY_CLIENT_ELEMENTS);
   memset(self->lockedClients, false, MAX_PROXY_CLIENT_ELEMENTS);
 
   self->sysConfig = sysConfig;
 
-  initSList(&self->allItems);
+  self->gcRunning      = false;
+  self->gcHeap         = NULL;
+  self->gcHeapSize     = 0;
+  self->gcHeapCapacity = 0;
+  self->prefixCache    = NULL;
+  self->aspathCache    = NULL;
+  memset(&self->gcStats, 0, sizeof(UC_GCStatistics));
+
+  self->entryPool  = createMemPool("update-cache-entry", sizeof(CacheEntry),
+                                   UC_ENTRIES_PER_SLAB);
+  self->clientPool = createMemPool("update-cache-clients", minNumberOfClients,
+                                   UC_ENTRIES_PER_SLAB);
+  if ((self->entryPool == NULL) || (self->clientPool == NULL))
+  {
+    RAISE_ERROR("Unable to setup the update cache memory pools");
+    releaseMemPool(self->entryPool);
+    releaseMemPool(self->clientPool);
+    free(self->lockedClients);
+    destroyCond(&self->gcCond);
+    releaseMutex(&self->gcMutex);
+    destroyCond(&self->deleteCond);
+    releaseRWLock(&self->tableLock);
+    releaseMutex(&self->itemMutex);
+    return false;
+  }
 
   return true;
 }
 
-//TODO: Documentation
+/**
+ * Release the update cache. This stops the garbage collector, empties the 
+ * cache, and releases all memory allocated by the cache. The memory of the 
+ * cache itself is NOT released.
+ *
+ * @param self The update cache
+ */
 void releaseUpdateCache(UpdateCache* self)
 {
-  RAISE_ERROR("Release Update Cache also should empty the cache first!");
   if (self != NULL)
   {
-    releaseRWLock(&self->tableLock);
-    releaseMutex(&self->itemMutex);
+    stopUpdateCacheGC(self);
 
     // Empty cache first
     emptyUpdateCache(self);
+
+    releaseRWLock(&self->tableLock);
+    destroyCond(&self->deleteCond);
+    releaseMutex(&self->itemMutex);
+    destroyCond(&self->gcCond);
+    releaseMutex(&self->gcMutex);
+
+    free(self->gcHeap);
+    self->gcHeap = NULL;
     free(self->lockedClients);
-    releaseSList(&self->allItems);
+    releaseMemPool(self->entryPool);
+    releaseMemPool(self->clientPool);
+    self->entryPool  = NULL;
+    self->clientPool = NULL;
   }
 }
 
@@ -377,8 +881,19 @@ bool getUpdateResult(UpdateCache* self, SRxUpdateID* updateID,
   // but store it as value only. See documentation for SRxUpdateID for more info
   SRxUpdateID updID = *updateID;
 
-  // Look for the update
-  if (tableFind(self, updID, &cEntry))
+  // Look for the update. A client can only be registered with an update that
+  // is not deleted by the garbage collector.
+  if (clientID > 0)
+  {
+    lockMutex(&self->itemMutex);
+    tableFindStored(self, updID, &cEntry);
+  }
+  else
+  {
+    tableFind(self, updID, &cEntry);
+  }
+
+  if (cEntry != NULL)
   {
     // Prefix Origin values
     srxRes->roaResult               = cEntry->srxResult.roaResult;
@@ -424,12 +939,17 @@ bool getUpdateResult(UpdateCache* self, SRxUpdateID* updateID,
     defaultRes->result.aspaResult = SRx_RESULT_DONOTUSE;
   }
 
+  if (clientID > 0)
+  {
+    unlockMutex(&self->itemMutex);
+  }
+
   return retVal;
 }
 
 /**
  * Assign the given client to the cache entry. This method extends the memory
- * if needed.
+ * if needed. The caller MUST hold the itemMutex.
  *
  * @param cEntry The cache entry containing the update
  * @param clientID The client assigned to the update.
@@ -454,8 +974,6 @@ bool _addClientReference(UpdateCache* self, CacheEntry* cEntry,
     if (cEntry->clients[idx]==0)
     {
       cEntry->clients[idx] = clientID;
-      //TODO: depending on the final GC implementation if the GC uses a delete
-      //      list, remove this cEntry from there in case gcFlag > 0
       // Increase the update count of this client
       clientMapping->updateCount++;
       added = true;
@@ -471,6 +989,7 @@ bool _addClientReference(UpdateCache* self, CacheEntry* cEntry,
   if (added)
   {
     cEntry->gcFlag       = 0; // Reset the GC flag
+    _gcUnschedule(self, cEntry);
   }
   else
   { // run out of memory, increase the array list
@@ -480,7 +999,22 @@ bool _addClientReference(UpdateCache* self, CacheEntry* cEntry,
     // be 1000 extensions or even configured?
 
     int newSize = cEntry->noPossibleClients + self->minNumberOfClients;
-    cEntry->clients = realloc(cEntry->clients, newSize);
+    if (cEntry->pooledClients)
+    {
+      // Move the client list out of the pool.
+      uint8_t* clients = malloc(newSize);
+      if (clients != NULL)
+      {
+        memcpy(clients, cEntry->clients, cEntry->noPossibleClients);
+      }
+      freeToMemPool(self->clientPool, cEntry->clients);
+      cEntry->clients       = clients;
+      cEntry->pooledClients = false;
+    }
+    else
+    {
+      cEntry->clients = realloc(cEntry->clients, newSize);
+    }
 
     if (cEntry->clients)
     {
@@ -491,6 +1025,9 @@ bool _addClientReference(UpdateCache* self, CacheEntry* cEntry,
       // Now add the new client
       cEntry->clients[cEntry->noPossibleClients] = clientID;
       cEntry->noPossibleClients = (uint8_t)newSize;
+      clientMapping->updateCount++;
+      cEntry->gcFlag = 0;
+      _gcUnschedule(self, cEntry);
       added = true;
     }
     else
@@ -557,9 +1094,11 @@ int storeUpdate(UpdateCache* self, uint8_t clientID, void* clientMapping,
   LOG(LEVEL_DEBUG, HDR "Store update [ID:0x%08X] in update cache.",
                    pthread_self(), updID);
 
+  lockMutex(&self->itemMutex);
   // Existing entry then only update the result values.
-  if (tableFind(self, updID, &cEntry))
+  if (tableFindStored(self, updID, &cEntry))
   {
+    unlockMutex(&self->itemMutex);
     LOG(LEVEL_WARNING, "Attempt to store an update that already exists in "
                        "update cache!");
     retVal = 0;
@@ -572,27 +1111,14 @@ int storeUpdate(UpdateCache* self, uint8_t clientID, void* clientMapping,
 
     // Store a brand new update in the list
     // New entry
-    lockMutex(&self->itemMutex);
-
-    if (self->itemsUsed == NUM_PREALLOC)
+    cEntry = (CacheEntry*)allocFromMemPool(self->entryPool);
+    if (cEntry == NULL)
     {
-      // In case the pre-allocated empty space is used up, create more.
-      self->availItems = appendToSList(&self->allItems,
-                                       sizeof(CacheEntry) * NUM_PREALLOC);
-      if (self->availItems == NULL)
-      {
-        return -1;
-      }
-      self->itemsUsed = 0;
+      unlockMutex(&self->itemMutex);
+      return -1;
     }
-
-    // now get the new accessible space.
-    cEntry = (CacheEntry*)(self->availItems
-                           + (self->itemsUsed * sizeof(CacheEntry)));
-    // mark the entry as used for now.
-    self->itemsUsed++;
-
-  //    unlockMutex(&self->itemMutex);
+    memset(cEntry, 0, sizeof(CacheEntry));
+    cEntry->inUse = true;
 
     cEntry->updateID      = updID;
     cEntry->asn           = asn;
@@ -657,7 +1183,9 @@ int storeUpdate(UpdateCache* self, uint8_t clientID, void* clientMapping,
 
     // Add the client ID to the update
     int memsize = sizeof(uint8_t) * self->minNumberOfClients;
-    cEntry->clients = malloc(memsize);
+    cEntry->pooledClients = memsize <= getMemPoolObjectSize(self->clientPool);
+    cEntry->clients = cEntry->pooledClients
+                      ? allocFromMemPool(self->clientPool) : malloc(memsize);
     memset(cEntry->clients, 0, memsize);
     cEntry->noPossibleClients = self->minNumberOfClients;
 
@@ -679,10 +1207,12 @@ int storeUpdate(UpdateCache* self, uint8_t clientID, void* clientMapping,
       // Mark for GC
       uint16_t keepWindow = (uint16_t)self->sysConfig->defaultKeepWindow;
       cEntry->gcFlag = getGCTime(keepWindow);
+      _gcSchedule(self, cEntry, keepWindow);
     }
 
     // Finally add the entry to cache.
     tableAdd(self, cEntry);
+    pathIndexAdd(self, cEntry);
 
     unlockMutex(&self->itemMutex);
   }
@@ -835,58 +1365,290 @@ bool modifyUpdateCacheResultWithAspaVal(UpdateCache* self, SRxUpdateID* updateID
 }
 
 /**
- * Try to finally delete the update.
+ * Try to finally delete the update. The update is removed from the update 
+ * cache, the prefix cache, the SKI cache, and if it was the last update that 
+ * used its AS path also from the AS path cache. The cache entry itself is 
+ * moved into the free list of the update cache.
+ *
+ * The update stays in the update cache, marked as deleting, until it is 
+ * removed from the prefix cache and SKI cache. This keeps the same update ID
+ * from being stored again while the registrations of the old update are 
+ * removed.
  *
  * @param self The Update cache
  * @param cEntry The cache entry (update)
  * @param pCache The prefix cache.
  * @param force  Force the deletion of the update. This ignores if the update is
  *               still referenced by clients.
+ * @param bytes  OUT: The number of bytes reclaimed (can be NULL).
  *
  * @return true if the update was deleted, otherwise false/
  *
  * @since 0.3.0
  */
 bool gcTestAndDeleteUpdate(UpdateCache* self, CacheEntry* cEntry,
-                           void* pCache, bool force)
+                           void* pCache, bool force, uint32_t* bytes)
 {
-  //TODO: Test one last time if the update can be deleted. If so then delete it.
-  // This method MUST be called by the garbage collector.
-  LOG(LEVEL_INFO,"IMPLEMENTATION CAN BE EXPECTED WITH VERSION 0.4");
-  bool delete = !force;
+  bool        delete  = false;
+  bool        lastRef = false;
+  SRxUpdateID updateID;
+  int         idx;
 
-  if (!force)
+  lockMutex(&self->itemMutex);
+  delete = cEntry->inUse && !cEntry->deleting;
+  if (delete && !force)
   {
-    // 1. CHECK IF GC TIME IS READY
+    // 1. CHECK IF THE UPDATE WAS NOT RE-SCHEDULED IN THE MEANTIME
+    delete = (cEntry->gcIndex == 0) && (cEntry->gcTime <= time(NULL));
 
     // 2. CHECK ONE MORE TIME IF NO REFERENCE EXISTS
+    for (idx = 0; delete && idx < cEntry->noPossibleClients; idx++)
+    {
+      delete = cEntry->clients[idx] == 0;
+    }
   }
 
   if (delete)
   {
-    if (!removeUpdate((PrefixCache*)pCache, &cEntry->updateID, &cEntry->prefix,
-                      cEntry->asn))
+    _gcUnschedule(self, cEntry);
+    // Clients can not be registered with the update anymore and the update 
+    // ID can not be stored again until the update is deleted.
+    cEntry->deleting = true;
+    if (bytes != NULL)
     {
-      // The reason might be that the update was not validated. (stored only)
-      LOG(LEVEL_WARNING, "Could not delete the update 0x08X from the prefix "
-                         "cache!");
+      *bytes = _gcEntrySize(cEntry);
     }
+  }
+  unlockMutex(&self->itemMutex);
 
+  if (delete)
+  {
+    // The prefix cache might call back into the update cache, therefore the 
+    // itemMutex MUST NOT be held.
+    updateID = cEntry->updateID;
+    if (pCache != NULL)
+    {
+      if (!removeUpdate((PrefixCache*)pCache, &updateID, &cEntry->prefix,
+                        cEntry->asn))
+      {
+        // The reason might be that the update was not validated. (stored only)
+        LOG(LEVEL_DEBUG, "Could not delete the update 0x%08X from the prefix "
+                         "cache!", updateID);
+      }
+    }
+
+    if (cEntry->pathData.bgpsec_path != NULL)
+    {
+      // Unregister the update from the SKI CACHE.
+      if (!ski_unregisterUpdate(getSKICache(), &updateID,
+                                cEntry->pathData.bgpsec_path))
+      {
+        LOG(LEVEL_WARNING, "Could not unregister update [0x%08X] from the ski "
+                           "cache!", updateID);
+      }
+    }
+
+    lockMutex(&self->itemMutex);
+    // A client might have released its reference meanwhile.
+    _gcUnschedule(self, cEntry);
     // now remove it from the update cache
     // Does not release the memory but only removes the hash table entry
     tableDel(self, cEntry);
-    // Now remove it from the allItems list of the cache
-    deleteFromSList(&self->allItems, cEntry);
+    lastRef = pathIndexDel(self, cEntry);
+    if (lastRef && (self->aspathCache != NULL))
+    {
+      deleteAspathCache((AspathCache*)self->aspathCache, cEntry->aspathCacheID,
+                        NULL);
+    }
+    broadcastCond(&self->deleteCond);
+    unlockMutex(&self->itemMutex);
 
-    // Free the memory of the bgpsec blob;
-    _cleanCachPathData(cEntry);
-    // Free the cache entry.
-    free(cEntry);
+    // Return the cache entry into the memory pool.
+    _releaseCacheEntry(self, cEntry);
   }
 
   return delete;
 }
 
+/**
+ * The garbage collector thread. It waits until the keep window of the first
+ * scheduled update expired and removes all expired updates.
+ *
+ * @param thisCache The update cache.
+ *
+ * @return NULL
+ *
+ * @since 0.6.2.2
+ */
+static void* _gcThread(void* thisCache)
+{
+  UpdateCache* self = (UpdateCache*)thisCache;
+  CacheEntry*  expired[GC_BATCH_SIZE];
+  CacheEntry*  top;
+  uint32_t     noExpired, idx, bytes;
+  uint64_t     reclaimed, reclaimedBytes;
+  time_t       now;
+
+  LOG(LEVEL_DEBUG, HDR "Update cache garbage collector started.",
+                   pthread_self());
+  lockMutex(&self->gcMutex);
+  while (self->gcRunning)
+  {
+    now       = time(NULL);
+    noExpired = 0;
+    while ((self->gcHeapSize > 0) && (noExpired < GC_BATCH_SIZE))
+    {
+      top = (CacheEntry*)self->gcHeap[0];
+      if (top->gcTime > now)
+      {
+        break;
+      }
+      expired[noExpired++] = _gcHeapRemove(self, 0);
+    }
+
+    if (noExpired > 0)
+    {
+      unlockMutex(&self->gcMutex);
+      reclaimed      = 0;
+      reclaimedBytes = 0;
+      for (idx = 0; idx < noExpired; idx++)
+      {
+        bytes = 0;
+        if (gcTestAndDeleteUpdate(self, expired[idx], self->prefixCache, false,
+                                  &bytes))
+        {
+          reclaimed++;
+          reclaimedBytes += bytes;
+        }
+      }
+      lockMutex(&self->gcMutex);
+      self->gcStats.runs++;
+      self->gcStats.reclaimedEntries += reclaimed;
+      self->gcStats.reclaimedBytes   += reclaimedBytes;
+      LOG(LEVEL_DEBUG, HDR "Garbage collector removed %llu of %u expired "
+                       "updates.", pthread_self(), (unsigned long long)reclaimed,
+                       noExpired);
+    }
+    else if (self->gcHeapSize > 0)
+    {
+      top = (CacheEntry*)self->gcHeap[0];
+      waitCond(&self->gcCond, &self->gcMutex, 
+               (uint32_t)(top->gcTime - now) * 1000);
+    }
+    else
+    {
+      waitCond(&self->gcCond, &self->gcMutex, 0);
+    }
+  }
+  unlockMutex(&self->gcMutex);
+  LOG(LEVEL_DEBUG, HDR "Update cache garbage collector stopped.",
+                   pthread_self());
+
+  return NULL;
+}
+
+/**
+ * Start the garbage collector thread. It removes updates without client 
+ * references once their keep window expired from the update cache, the prefix
+ * cache, the SKI cache, and the AS path cache.
+ *
+ * @param self The update cache
+ * @param prefixCache The prefix cache (PrefixCache*) the updates are 
+ *                    validated in.
+ * @param aspathCache The AS path cache (AspathCache*), can be NULL.
+ *
+ * @return true if the garbage collector is running.
+ *
+ * @since 0.6.2.2
+ */
+bool startUpdateCacheGC(UpdateCache* self, void* prefixCache, 
+                        void* aspathCache)
+{
+  bool retVal = true;
+
+  lockMutex(&self->gcMutex);
+  if (!self->gcRunning)
+  {
+    self->prefixCache = prefixCache;
+    self->aspathCache = aspathCache;
+    self->gcRunning   = true;
+    if (pthread_create(&self->gcThread, NULL, _gcThread, self) != 0)
+    {
+      RAISE_SYS_ERROR("Could not start the update cache garbage collector!");
+      self->gcRunning = false;
+      retVal          = false;
+    }
+  }
+  unlockMutex(&self->gcMutex);
+
+  return retVal;
+}
+
+/**
+ * Stop the garbage collector thread. This MUST be called before the prefix 
+ * cache or the AS path cache are released.
+ *
+ * @param self The update cache
+ *
+ * @since 0.6.2.2
+ */
+void stopUpdateCacheGC(UpdateCache* self)
+{
+  bool running;
+
+  lockMutex(&self->gcMutex);
+  running = self->gcRunning;
+  self->gcRunning = false;
+  signalCond(&self->gcCond);
+  unlockMutex(&self->gcMutex);
+
+  if (running)
+  {
+    pthread_join(self->gcThread, NULL);
+  }
+}
+
+/**
+ * Fill the given statistics with the counters of the garbage collector.
+ *
+ * @param self The update cache
+ * @param stats The statistics to be filled.
+ *
+ * @since 0.6.2.2
+ */
+void getUpdateCacheGCStats(UpdateCache* self, UC_GCStatistics* stats)
+{
+  MemPoolStatistics poolStats;
+
+  lockMutex(&self->gcMutex);
+  memcpy(stats, &self->gcStats, sizeof(UC_GCStatistics));
+  stats->scheduled = self->gcHeapSize;
+  unlockMutex(&self->gcMutex);
+
+  getMemPoolStatistics(self->entryPool, &poolStats);
+  stats->freeEntries = poolStats.capacity - poolStats.inUse;
+}
+
+/**
+ * Return the number of updates stored in the update cache.
+ *
+ * @param self The update cache
+ *
+ * @return the number of updates.
+ *
+ * @since 0.6.2.2
+ */
+uint32_t getNumberOfUpdates(UpdateCache* self)
+{
+  uint32_t noUpdates;
+
+  acquireReadLock(&self->tableLock);
+  noUpdates = HASH_COUNT((CacheEntry*)self->table);
+  unlockReadLock(&self->tableLock);
+
+  return noUpdates;
+}
+
 /**
  * Set the flag when the update can be garbage collected.
  *
@@ -974,16 +1736,18 @@ int _deleteUpdateFromCache_clientMgmt(CacheEntry* entry, uint8_t clientID)
  *                 If this id is zero all mappings and the update itself will be
  *                 removed!
  * @param cEntry   The update itself.
- * @param timeOfDeletion A proposed real-time in seconds until the update should
- *                 be kept before final deletion. The cache might remove the
- *                 update at any other time though.
+ * @param keepTime A proposed time in seconds the update should still be kept
+ *                 before final deletion. The cache might remove the update at
+ *                 any other time though.
  *
  * @return true If the update / association could be removed, false if the
  *              update was not either found in the cache or no association to
  *              the client was found.
+ *
+ * @note The caller MUST hold the itemMutex.
  */
 int _deleteUpdateFromCache(UpdateCache* self, uint8_t clientID,
-                           CacheEntry*  cEntry, uint16_t timeOfDeletion)
+                           CacheEntry*  cEntry, uint16_t keepTime)
 {
   bool retVal = false;
 
@@ -997,7 +1761,8 @@ int _deleteUpdateFromCache(UpdateCache* self, uint8_t clientID,
       retVal = false;
       break;
     case 0 : // no reference left
-      setGCFlag(cEntry, timeOfDeletion);
+      setGCFlag(cEntry, getGCTime(keepTime));
+      _gcSchedule(self, cEntry, keepTime);
     case 1 : // still some left, don't delete
     default:
       retVal = true;
@@ -1007,13 +1772,10 @@ int _deleteUpdateFromCache(UpdateCache* self, uint8_t clientID,
 }
 
 /**
- * Removes the update data from the list and releases all memory associated to
- * it. Also, if this update contains bgpsec blob, it will remove this
- * update from the SKI Cache.
- *
- * @note This method ONLY deletes the update from the update cache. It is
- *       important to assure that other references such as the prefix_cache
- *       might be affected by this.
+ * Removes the client association from the update. If no further client 
+ * references exist, the update is scheduled for the garbage collector which 
+ * removes it from the update cache, the prefix cache, the SKI cache, and the
+ * AS path cache once the keep time expired.
  *
  * @param self The instance of the update cache
  * @param clientID The ID of the srx-server client. This is NOT the proxyID,
@@ -1042,23 +1804,13 @@ bool deleteUpdateFromCache(UpdateCache* self, uint8_t clientID,
   {
     keepTime = self->sysConfig->defaultKeepWindow;
   }
-  uint16_t timeToBeDeleted = getGCTime(keepTime);
 
   // Get the update cache entry from the update cache.
   if (tableFind(self, updID, &cEntry))
   {
-    retVal = _deleteUpdateFromCache(self, clientID, cEntry, timeToBeDeleted);
-    if (retVal && (cEntry->pathData.bgpsec_path != NULL))
-    {
-      // Unregister the update from the SKI CACHE.
-      SKI_CACHE* sCache = getSKICache();
-      UC_UpdateData* data = &cEntry->pathData;
-      if (!ski_unregisterUpdate(sCache, updateID, data->bgpsec_path))
-      {
-        LOG(LEVEL_WARNING, "Could not unregister update [0x%08X] from the ski "
-                           "cache!", updID);
-      }
-    }
+    lockMutex(&self->itemMutex);
+    retVal = _deleteUpdateFromCache(self, clientID, cEntry, keepTime);
+    unlockMutex(&self->itemMutex);
   }
   else
   {
@@ -1198,18 +1950,29 @@ UC_UpdateData* getUpdateData(UpdateCache* self, SRxUpdateID* updateID)
 void emptyUpdateCache(UpdateCache* self)
 {
   ////////////////////////////////////////////////////////////////////////////// TOUCHED(X); OK ( ); NOT YET ( ); Tested ( )
-  acquireWriteLock(&self->tableLock);
+  CacheEntry* cEntry = NULL;
+  CacheEntry* tmp    = NULL;
+
   lockMutex(&self->itemMutex);
-  emptySList(&self->allItems);
+  acquireWriteLock(&self->tableLock);
   SKI_CACHE* sCache = getSKICache();
   // clean all updates from the update cache.
   ski_clean(sCache, SKI_CLEAN_UPDATES);
-  unlockMutex(&self->itemMutex);
 
-  self->table     = NULL;
-  self->itemsUsed = NUM_PREALLOC;
+  HASH_ITER(hh, (CacheEntry*)self->table, cEntry, tmp)
+  {
+    HASH_DEL(*((CacheEntry**)&self->table), cEntry);
+    _releaseCacheEntry(self, cEntry);
+  }
+  self->table = NULL;
+  pathIndexEmpty(self);
+
+  lockMutex(&self->gcMutex);
+  self->gcHeapSize = 0;
+  unlockMutex(&self->gcMutex);
 
   unlockWriteLock(&self->tableLock);
+  unlockMutex(&self->itemMutex);
 }
 
 
@@ -1292,32 +2055,34 @@ int unregisterClientID(UpdateCache* self, uint8_t clientID, void* clientMapping,
                        uint32_t keepTime)
 {
   int idsRemoved = -1;
-  SListNode*  lNode;
   CacheEntry* cEntry;
+  CacheEntry* tmp;
   ProxyClientMapping* mapping = (ProxyClientMapping*)clientMapping;
 
-  acquireWriteLock(&self->tableLock);
+  if (keepTime < self->sysConfig->defaultKeepWindow)
+  {
+    keepTime = self->sysConfig->defaultKeepWindow;
+  }
+
   lockMutex(&self->itemMutex);
   if (!self->lockedClients[clientID])
   {
     idsRemoved = 0;
     self->lockedClients[clientID]=true;
-    FOREACH_SLIST(&self->allItems, lNode)
+    acquireReadLock(&self->tableLock);
+    HASH_ITER(hh, (CacheEntry*)self->table, cEntry, tmp)
     {
-      cEntry = (CacheEntry*)lNode->data;
-      if (cEntry != NULL)
+      if (_deleteUpdateFromCache(self, clientID, cEntry, keepTime))
       {
-        if (_deleteUpdateFromCache(self, clientID, cEntry, keepTime))
-        {
-          idsRemoved++;
-          mapping->updateCount--;
-        }
+        idsRemoved++;
+        mapping->updateCount--;
       }
       if (mapping->updateCount == 0)
       {
         break;
       }
     }
+    unlockReadLock(&self->tableLock);
     self->lockedClients[clientID]=false;
   }
   else
@@ -1327,7 +2092,6 @@ int unregisterClientID(UpdateCache* self, uint8_t clientID, void* clientMapping,
 
   }
   unlockMutex(&self->itemMutex);
-  unlockWriteLock(&self->tableLock);
 
   return idsRemoved;
 }
@@ -1489,8 +2253,8 @@ void outputUpdateCacheAsXML(UpdateCache* self, FILE* stream, int maxBlob)
 {
 #define CLIENT_LIST_STRING_LEN 1024
   XMLOut      out;
-  SListNode*  updateListNode;
   CacheEntry* update;
+  CacheEntry* tmp;
   uint8_t     clIdx;
   uint8_t     noClients;
   char        clientString[CLIENT_LIST_STRING_LEN];
@@ -1503,12 +2267,12 @@ void outputUpdateCacheAsXML(UpdateCache* self, FILE* stream, int maxBlob)
   addU32Attrib(&out, "current-gc-time", getGCTime(0));
 
   // Updates
-  if (sizeOfSList(&self->allItems))
+  acquireReadLock(&self->tableLock);
+  if (HASH_COUNT((CacheEntry*)self->table) > 0)
   {
     openTag(&out, "updates");
-    FOREACH_SLIST(&self->allItems, updateListNode)
+    HASH_ITER(hh, (CacheEntry*)self->table, update, tmp)
     {
-      update = (CacheEntry*)getDataOfSListNode(updateListNode);
       openTag(&out, "update");
         addH32Attrib(&out, "update-id", update->updateID);
         // noClients contains the number of clients used during the last run.
@@ -1575,6 +2339,7 @@ void outputUpdateCacheAsXML(UpdateCache* self, FILE* stream, int maxBlob)
     }
     closeTag(&out);
   }
+  unlockReadLock(&self->tableLock);
 
   closeTag(&out);
   releaseXMLOut(&out);
@@ -1582,22 +2347,50 @@ void outputUpdateCacheAsXML(UpdateCache* self, FILE* stream, int maxBlob)
 
 
 
-void process_ASPA_EndOfData(UpdateCache* self, 
-                            int (*cb)(void* uCache, void* hldr, uint32_t uid, uint32_t pid, time_t ct), 
-                            void* rpkiHandler)
+/**
+ * Re-validate the given AS paths and pass the results on to all updates that
+ * use them. The callback is called once per path with the updates of the path.
+ * 
+ * @param self The update cache
+ * @param cb The callback that re-validates the path. It returns the number of
+ *           updates whose result changed or -1 in case of an error.
+ * @param rpkiHandler The RPKI handler
+ * @param pathIds The list of (dirty) path IDs.
+ * @param noPaths The number of path IDs in the list.
+ * 
+ * @return the number of updates whose result changed.
+ * 
+ * @since 0.6.2.2 (modified signature)
+ */
+uint32_t process_ASPA_EndOfData(UpdateCache* self, 
+                          int (*cb)(void* uCache, void* hldr, uint32_t pid, 
+                                    SRxUpdateID* uids, uint32_t noUIDs), 
+                          void* rpkiHandler, uint32_t* pathIds, 
+                          uint32_t noPaths)
 {
-  time_t lastEndOfDataTime = time(NULL);
-  int count=0;
-  CacheEntry* cEntry, *tmp;
+  uint32_t     changed   = 0;
+  uint32_t     idx       = 0;
+  uint32_t     noUpdates = 0;
+  SRxUpdateID* updateIDs = NULL;
+  int          result    = 0;
     
-  LOG(LEVEL_DEBUG, "Last end of Data Time: %u", lastEndOfDataTime);
-  HASH_ITER(hh, (CacheEntry*)self->table, cEntry, tmp) 
+  for (idx = 0; idx < noPaths; idx++)
   {
-    LOG(LEVEL_DEBUG, "[%d] updateID: 0x%08X  pathID: 0x%08X", 
-        count++, cEntry->updateID, cEntry->aspathCacheID);
+    updateIDs = getUpdateIDsOfAspath(self, pathIds[idx], &noUpdates);
+    LOG(LEVEL_DEBUG, "[%u] pathID: 0x%08X used by %u update(s)", 
+        idx, pathIds[idx], noUpdates);
 
-    cb((void*)self, (void*)rpkiHandler, cEntry->updateID, cEntry->aspathCacheID, 
-        lastEndOfDataTime); // call process_ASPA_EndOfData_main
+    result = cb((void*)self, rpkiHandler, pathIds[idx], updateIDs, noUpdates);
+    if (result > 0)
+    {
+      changed += (uint32_t)result;
+    }
+    
+    if (updateIDs != NULL)
+    {
+      free(updateIDs);
+    }
   }
 
+  return changed;
 }
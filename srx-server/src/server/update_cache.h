@@ -20,15 +20,24 @@
  * other licenses. Please refer to the licenses of all libraries required 
  * by this software.
  *
- * The update cache holds the updates in two separate structures, one is the 
- * update cache, a hash table with the update id as key and the update as 
- * value. The other is a list, that allows to scan through all updates. Both 
- * MUST be maintained the same.
+ * The update cache holds the updates in a hash table with the update id as 
+ * key and the update as value. The cache entries are allocated from a memory
+ * pool.
  * 
- * @version 0.6.2.1
+ * @version 0.6.2.2
  * 
  * Changelog:
  * -----------------------------------------------------------------------------
+ * 0.6.2.2  - 2026/10/17
+ *            * Added the path index (AS path ID -> update IDs) and changed
+ *              process_ASPA_EndOfData to only process the given paths.
+ *            * Added the garbage collector that removes updates once their 
+ *              keep window expired, see startUpdateCacheGC. Removed cache 
+ *              entries are kept in a free list for reuse.
+ *            * Added UC_GCStatistics and getUpdateCacheGCStats.
+ *            * Cache entries and client lists are allocated from memory 
+ *              pools. Removed allItems, the updates are only stored in the 
+ *              hash table.
  * 0.6.2.1  - 2024/09/10 - oborchert
  *            * Changed data types from u_int... to uint... which follows C99
  * 0.5.0.0  - 2017/07/06 - oborchert
@@ -68,6 +77,7 @@
 #include "server/configuration.h"
 #include "shared/srx_defs.h"
 #include "shared/srx_packets.h"
+#include "util/mem_pool.h"
 #include "util/mutex.h"
 #include "util/rwlock.h"
 #include "util/slist.h"
@@ -80,6 +90,22 @@
  */
 typedef void (*UpdateResultChanged)(SRxValidationResult* result);
 
+/**
+ * Statistics of the update cache garbage collector.
+ */
+typedef struct {
+  /** Number of garbage collector runs that found expired updates. */
+  uint64_t runs;
+  /** Number of updates removed by the garbage collector. */
+  uint64_t reclaimedEntries;
+  /** Number of bytes freed or returned into the free list. */
+  uint64_t reclaimedBytes;
+  /** Number of updates waiting for their keep window to expire. */
+  uint32_t scheduled;
+  /** Number of free cache entries in the memory pool. */
+  uint32_t freeEntries;
+} UC_GCStatistics;
+
 /**
  * A single Update Cache.
  */
@@ -87,12 +113,23 @@ typedef struct {
   Configuration*      sysConfig;  // The system configuration
   UpdateResultChanged resChangedCallback;
   Mutex               itemMutex;
-  // TODO Check if allItems can be removed!
-  SList               allItems;   // All updates in an SList.
-  void*               availItems; // pointer to the next available cEntry
-  int                 itemsUsed;  // number of cEntries used
+  Cond                deleteCond; // Signaled when the GC deleted an update
+  MemPool*            entryPool;  // Memory pool of the cEntries.
+  MemPool*            clientPool; // Memory pool of the cEntry client lists.
+  // Garbage collector, gcMutex guards the heap and the statistics
+  Mutex               gcMutex;
+  Cond                gcCond;
+  pthread_t           gcThread;
+  bool                gcRunning;
+  void**              gcHeap;     // cEntries ordered by their GC time
+  uint32_t            gcHeapSize;
+  uint32_t            gcHeapCapacity;
+  void*               prefixCache;// The prefix cache used by the GC
+  void*               aspathCache;// The AS path cache used by the GC
+  UC_GCStatistics     gcStats;
   RWLock              tableLock;
   void*               table;      // The hash table for quick lookup
+  void*               pathIndex;  // AS path ID -> update IDs (uses tableLock)
   // The is also the maximum number of clients currently installed. It is
   // called minNumberOfclients because it is the minimum expected and therefore
   // the initial number of array elements needed per update. This number might
@@ -304,6 +341,54 @@ int storeUpdate(UpdateCache* self, uint8_t clientID, void* clientMapping,
 bool deleteUpdateFromCache(UpdateCache* self, uint8_t clientID, 
                            SRxUpdateID* updateID, uint16_t keepTime);
 
+/**
+ * Start the garbage collector thread. It removes updates without client 
+ * references once their keep window expired from the update cache, the prefix
+ * cache, the SKI cache, and the AS path cache.
+ *
+ * @param self The update cache
+ * @param prefixCache The prefix cache (PrefixCache*) the updates are 
+ *                    validated in.
+ * @param aspathCache The AS path cache (AspathCache*), can be NULL.
+ *
+ * @return true if the garbage collector is running.
+ *
+ * @since 0.6.2.2
+ */
+bool startUpdateCacheGC(UpdateCache* self, void* prefixCache, 
+                        void* aspathCache);
+
+/**
+ * Stop the garbage collector thread. This MUST be called before the prefix 
+ * cache or the AS path cache are released.
+ *
+ * @param self The update cache
+ *
+ * @since 0.6.2.2
+ */
+void stopUpdateCacheGC(UpdateCache* self);
+
+/**
+ * Fill the given statistics with the counters of the garbage collector.
+ *
+ * @param self The update cache
+ * @param stats The statistics to be filled.
+ *
+ * @since 0.6.2.2
+ */
+void getUpdateCacheGCStats(UpdateCache* self, UC_GCStatistics* stats);
+
+/**
+ * Return the number of updates stored in the update cache.
+ *
+ * @param self The update cache
+ *
+ * @return the number of updates.
+ *
+ * @since 0.6.2.2
+ */
+uint32_t getNumberOfUpdates(UpdateCache* self);
+
 /**
  * Empties a cache and releases all memory attached to each of the elements.
  * For each update that contains BGPsec data it calls the unregister update
@@ -441,9 +526,41 @@ void outputUpdateCacheAsXML(UpdateCache* self, FILE* stream, int maxBlob);
 bool modifyUpdateCacheResultWithAspaVal(UpdateCache* self, SRxUpdateID* updateID,
                         SRxResult* srxResult_aspa);
 
-void process_ASPA_EndOfData(UpdateCache* self, 
-                            int (*cb)(void* uCache, void* hldr, uint32_t uid, uint32_t pid, time_t), 
-                            void* rpkiHandler);
+/**
+ * Return a copy of the IDs of all updates that use the given AS path.
+ * 
+ * @param self The update cache.
+ * @param pathId The AS path ID
+ * @param count OUT: The number of update IDs returned.
+ * 
+ * @return The list of update IDs or NULL. The list MUST be freed by the 
+ *         caller.
+ * 
+ * @since 0.6.2.2
+ */
+SRxUpdateID* getUpdateIDsOfAspath(UpdateCache* self, uint32_t pathId, 
+                                  uint32_t* count);
+
+/**
+ * Re-validate the given AS paths and pass the results on to all updates that
+ * use them. The callback is called once per path with the updates of the path.
+ * 
+ * @param self The update cache
+ * @param cb The callback that re-validates the path. It returns the number of
+ *           updates whose result changed or -1 in case of an error.
+ * @param rpkiHandler The RPKI handler
+ * @param pathIds The list of (dirty) path IDs.
+ * @param noPaths The number of path IDs in the list.
+ * 
+ * @return the number of updates whose result changed.
+ * 
+ * @since 0.6.2.2 (modified signature)
+ */
+uint32_t process_ASPA_EndOfData(UpdateCache* self, 
+                          int (*cb)(void* uCache, void* hldr, uint32_t pid, 
+                                    SRxUpdateID* uids, uint32_t noUIDs), 
+                          void* rpkiHandler, uint32_t* pathIds, 
+                          uint32_t noPaths);
 #endif // !__UPDATE_CACHE_H__
 
 
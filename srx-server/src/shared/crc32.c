@@ -20,9 +20,26 @@
  * other licenses. Please refer to the licenses of all libraries required 
  * by this software.
  *
+ * @version 0.6.2.2
+ *
+ * Changelog:
+ * -----------------------------------------------------------------------------
+ * 0.6.2.2  - 2026/10/17
+ *            * Added CRC32C (Castagnoli) using the SSE4.2 crc32 instruction if
+ *              the CPU provides it and a slice-by-8 table otherwise.
  */
+#include <pthread.h>
+#include <string.h>
 #include "shared/crc32.h"
 
+#if defined(__x86_64__) && defined(__GNUC__)
+#include <nmmintrin.h>
+#define CRC32C_HW_X86 1
+#endif
+
+/** The reflected CRC32C (Castagnoli) polynomial 0x1EDC6F41 */
+#define CRC32C_POLY 0x82F63B78
+
 // CRC-32 polynominal:
 // X^32+X^26+X^23+X^22+X^16+X^12+X^11+X^10+X^8+X^7+X^5+X^4+X^2+X+1
 
@@ -110,3 +127,161 @@ uint32_t crc32(uint8_t *pData, uint32_t uSize)
   }
   return ~pCrc32;
 }
+
+/** The slice-by-8 tables for CRC32C, generated once in _crc32cInit. */
+static uint32_t crc32ctab[8][256];
+/** Guards the generation of the tables and the selection of the function. */
+static pthread_once_t crc32cOnce = PTHREAD_ONCE_INIT;
+
+/**
+ * Calculate the CRC32C of the given data block using table lookups, eight
+ * bytes at a time.
+ *
+ * @param crc The inverted CRC value to start with.
+ * @param pData The data block.
+ * @param uSize The size of the data block in bytes.
+ *
+ * @return The inverted CRC value.
+ *
+ * @since 0.6.2.2
+ */
+static uint32_t _crc32cSW(uint32_t crc, const uint8_t* pData, uint32_t uSize)
+{
+  uint64_t word;
+
+  while (uSize >= 8)
+  {
+    memcpy(&word, pData, 8);
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    word = __builtin_bswap64(word);
+#endif
+    word ^= crc;
+    crc = crc32ctab[7][ word        & 0xFF] ^ crc32ctab[6][(word >>  8) & 0xFF]
+        ^ crc32ctab[5][(word >> 16) & 0xFF] ^ crc32ctab[4][(word >> 24) & 0xFF]
+        ^ crc32ctab[3][(word >> 32) & 0xFF] ^ crc32ctab[2][(word >> 40) & 0xFF]
+        ^ crc32ctab[1][(word >> 48) & 0xFF] ^ crc32ctab[0][ word >> 56];
+    pData += 8;
+    uSize -= 8;
+  }
+  while (uSize-- > 0)
+  {
+    crc = (crc >> 8) ^ crc32ctab[0][(crc ^ *pData++) & 0xFF];
+  }
+
+  return crc;
+}
+
+#ifdef CRC32C_HW_X86
+/**
+ * Calculate the CRC32C of the given data block using the SSE4.2 crc32
+ * instruction. MUST only be called if the CPU supports SSE4.2.
+ *
+ * @param crc The inverted CRC value to start with.
+ * @param pData The data block.
+ * @param uSize The size of the data block in bytes.
+ *
+ * @return The inverted CRC value.
+ *
+ * @since 0.6.2.2
+ */
+__attribute__((target("sse4.2")))
+static uint32_t _crc32cHW(uint32_t crc, const uint8_t* pData, uint32_t uSize)
+{
+  uint64_t crc64 = crc;
+  uint64_t word;
+
+  while (uSize >= 8)
+  {
+    memcpy(&word, pData, 8);
+    crc64 = _mm_crc32_u64(crc64, word);
+    pData += 8;
+    uSize -= 8;
+  }
+  crc = (uint32_t)crc64;
+  while (uSize-- > 0)
+  {
+    crc = _mm_crc32_u8(crc, *pData++);
+  }
+
+  return crc;
+}
+#endif
+
+/** The CRC32C implementation selected in _crc32cInit. */
+static uint32_t (*_crc32cFunc)(uint32_t, const uint8_t*, uint32_t) = _crc32cSW;
+
+/**
+ * Generate the lookup tables and select the hardware implementation if the
+ * CPU supports it.
+ *
+ * @since 0.6.2.2
+ */
+static void _crc32cInit()
+{
+  uint32_t crc;
+  int idx, bit, slice;
+
+  for (idx = 0; idx < 256; idx++)
+  {
+    crc = idx;
+    for (bit = 0; bit < 8; bit++)
+    {
+      crc = (crc & 1) ? (crc >> 1) ^ CRC32C_POLY : crc >> 1;
+    }
+    crc32ctab[0][idx] = crc;
+  }
+  for (idx = 0; idx < 256; idx++)
+  {
+    crc = crc32ctab[0][idx];
+    for (slice = 1; slice < 8; slice++)
+    {
+      crc = (crc >> 8) ^ crc32ctab[0][crc & 0xFF];
+      crc32ctab[slice][idx] = crc;
+    }
+  }
+
+#ifdef CRC32C_HW_X86
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("sse4.2"))
+  {
+    _crc32cFunc = _crc32cHW;
+  }
+#endif
+}
+
+/**
+ * Generates a CRC32C (Castagnoli) number for the given data block. The value
+ * of a previous call can be passed as crc to continue the calculation over
+ * multiple data blocks: crc32c(crc32c(0, a, x), b, y) is the CRC32C of the
+ * concatenation of a and b.
+ *
+ * @param crc The CRC32C of the preceding data or 0 to start.
+ * @param pData The data block.
+ * @param uSize The size of the data block in bytes.
+ *
+ * @return The CRC32C value.
+ *
+ * @since 0.6.2.2
+ */
+uint32_t crc32c(uint32_t crc, const uint8_t* pData, uint32_t uSize)
+{
+  pthread_once(&crc32cOnce, _crc32cInit);
+  return ~_crc32cFunc(~crc, pData, uSize);
+}
+
+/**
+ * Return true if crc32c uses the SSE4.2 crc32 instruction.
+ *
+ * @return true if the hardware implementation is used.
+ *
+ * @since 0.6.2.2
+ */
+bool crc32cHardware()
+{
+  pthread_once(&crc32cOnce, _crc32cInit);
+#ifdef CRC32C_HW_X86
+  return _crc32cFunc == _crc32cHW;
+#else
+  return false;
+#endif
+}
@@ -20,16 +20,19 @@
  * other licenses. Please refer to the licenses of all libraries required 
  * by this software.
  *
- * @version 0.3.0.10
+ * @version 0.6.2.2
  *
  * Changelog:
  * -----------------------------------------------------------------------------
+ * 0.6.2.2  - 2026/10/17
+ *            * Added crc32c and crc32cHardware.
  * 0.3.0.10 - 2015/11/09 - oborchert
  *            * Added Changelog
  *            * Fixed speller in documentation header
  * 0.1.0    - 2011/05/01 -oborchert
  *            * Code created. 
  */
+#include <stdbool.h>
 #include <stdint.h>
 
 #ifndef CRC32_H
@@ -41,6 +44,30 @@ extern "C" {
 
 uint32_t crc32(uint8_t *pData, uint32_t uSize);
 
+/**
+ * Generates a CRC32C (Castagnoli) number for the given data block. The value
+ * of a previous call can be passed as crc to continue the calculation over
+ * multiple data blocks.
+ *
+ * @param crc The CRC32C of the preceding data or 0 to start.
+ * @param pData The data block.
+ * @param uSize The size of the data block in bytes.
+ *
+ * @return The CRC32C value.
+ *
+ * @since 0.6.2.2
+ */
+uint32_t crc32c(uint32_t crc, const uint8_t* pData, uint32_t uSize);
+
+/**
+ * Return true if crc32c uses the SSE4.2 crc32 instruction.
+ *
+ * @return true if the hardware implementation is used.
+ *
+ * @since 0.6.2.2
+ */
+bool crc32cHardware();
+
 #ifdef	__cplusplus
 }
 #endif
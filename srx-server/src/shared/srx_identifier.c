@@ -20,10 +20,14 @@
  * other licenses. Please refer to the licenses of all libraries required 
  * by this software.
  *
- * @version 0.5.0.0
+ * @version 0.6.2.2
  *
  * Changelog:
  * -----------------------------------------------------------------------------
+ * 0.6.2.2  - 2026/10/17
+ *            * The update ID is generated with CRC32C over the binary data
+ *              instead of CRC32 over a hex string.
+ *            * Added generatePathIdentifier (moved from aspath_cache).
  * 0.5.0.0  - 2017/06/21 - oborchert
  *            * Add method compareSrxUpdateID
  *            * Fixed speller in documentation
@@ -37,7 +41,7 @@
  * 0.1.0    - 2011/05/03 -oborchert
  *            * Code created. 
  */
-#include <stdio.h>
+#include <arpa/inet.h>
 #include <stdint.h>
 #include <string.h>
 #include "shared/crc32.h"
@@ -46,9 +50,10 @@
 #include "srx_defs.h"
 
 /**
- * This particular method generates an ID out of the given data using a simple
- * CRC32 algorithm. All data is used as is, no transformation from host to
- * network and vice versa is performed.
+ * This particular method generates an ID out of the given data using the 
+ * CRC32C algorithm over the binary data. The origin AS is used in network
+ * order, the prefix address as stored in the IPPrefix which is network order
+ * as well.
  *
  * @param originAS The origin AS of the data
  * @param prefix The prefix to be announced (IPPrefix)
@@ -80,46 +85,59 @@ uint32_t generateIdentifier(uint32_t originAS, IPPrefix* prefix,
     blob = (uint8_t*)data->asPath;
   }
 
-  uint32_t crc  = 0;
+  // OriginAS + IPPrefix + Prefix Length
+  uint8_t  head[4 + sizeof(prefix->ip.addr.v6.u8) + 1];
   uint32_t prefixSize = prefix->ip.version == 4 ? 4
                                                 : sizeof(prefix->ip.addr.v6.u8);
-  uint32_t length = (  4           /* OriginAS */
-                     + prefixSize  /* IPPrefix */
-                     + 1           /* Prefix Length */
-                     + blobLength  /* The length of the data blob */
-                    ) * 2;         /* To generate a hex string. */
+  uint32_t asn = htonl(originAS);
 
-  char dataText[length];
-  memset(dataText, '\0', length);
-  char* dataPtr = dataText;
-  int i;
-
-  sprintf(dataPtr, "%08X", originAS);
-  dataPtr += 8;
+  memcpy(head, &asn, 4);
   if (prefix->ip.version == 4)
   {
-    sprintf(dataPtr, "%08X%02X", prefix->ip.addr.v4.u32, prefix->length);
-    dataPtr += 10;
+    memcpy(head + 4, &prefix->ip.addr.v4.u32, prefixSize);
   }
   else
   {
-    for (i = 0; i < prefixSize; i++)
+    memcpy(head + 4, prefix->ip.addr.v6.u8, prefixSize);
+  }
+  head[4 + prefixSize] = prefix->length;
+
+  return crc32c(crc32c(0, head, 4 + prefixSize + 1), blob, blobLength);
+}
+
+/**
+ * Generate the ID of the given AS path using the CRC32C algorithm over all
+ * ASes in network order followed by the AS type.
+ *
+ * @param asPathLength The number of ASes in the path.
+ * @param asPath The AS path.
+ * @param asType The type of the AS path.
+ * @param bBigEndian Indicates if the ASes of the path are in network order.
+ *
+ * @return the path ID.
+ *
+ * @since 0.6.2.2
+ */
+uint32_t generatePathIdentifier(uint8_t asPathLength, uint32_t* asPath,
+                                uint8_t asType, bool bBigEndian)
+{
+  uint32_t buf[asPathLength + 1];
+  int      idx;
+
+  if (bBigEndian)
+  {
+    memcpy(buf, asPath, asPathLength * 4);
+  }
+  else
+  {
+    for (idx = 0; idx < asPathLength; idx++)
     {
-      sprintf(dataPtr, "%02X", prefix->ip.addr.v6.u8[i]);
-      dataPtr += 2;
+      buf[idx] = htonl(asPath[idx]);
     }
-    sprintf(dataPtr, "%02X", prefix->length);
-    dataPtr += 2;
   }
+  ((uint8_t*)buf)[asPathLength * 4] = asType;
 
-  for (i = 0; i < blobLength; i++)
-  {
-    sprintf(dataPtr, "%02X", *(char*)blob);
-    dataPtr += 2;
-    blob++;
-  }  
-  crc = crc32((uint8_t*)dataText, length);
-  return crc;
+  return crc32c(0, (uint8_t*)buf, asPathLength * 4 + 1);
 }
 
 /**
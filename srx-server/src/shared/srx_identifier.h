@@ -20,10 +20,13 @@
  * other licenses. Please refer to the licenses of all libraries required 
  * by this software.
  *
- * @version 0.5.0.0
+ * @version 0.6.2.2
  *
  * Changelog:
  * -----------------------------------------------------------------------------
+ * 0.6.2.2  - 2026/10/17
+ *            * generateIdentifier uses CRC32C over the binary data.
+ *            * Added generatePathIdentifier.
  * 0.5.0.0  - 2017/06/21 - oborchert
  *            * Add method compareSrxUpdateID
  *            * Added enumeration type e_SRx_uID_Compare
@@ -37,6 +40,7 @@
  *            * Code created. 
  */
 
+#include <stdbool.h>
 #include <stdint.h>
 #include "util/prefix.h"
 #include "shared/srx_defs.h"
@@ -55,9 +59,8 @@ typedef enum {
 } e_SRx_uID_Compare;
 
 /**
- * This particular method generates an ID out of the given data using a simple
- * CRC32 algorithm. All data is used as is, no transformation from host to
- * network and vice versa is performed.
+ * This particular method generates an ID out of the given data using the 
+ * CRC32C algorithm over the binary data.
  *
  * @param originAS The origin AS of the data
  * @param prefix The prefix to be announced (IPPrefix)
@@ -69,6 +72,21 @@ typedef enum {
 uint32_t generateIdentifier(uint32_t originAS, IPPrefix* prefix, 
                             BGPSecData* data);
 
+/**
+ * Generate the ID of the given AS path using the CRC32C algorithm.
+ *
+ * @param asPathLength The number of ASes in the path.
+ * @param asPath The AS path.
+ * @param asType The type of the AS path.
+ * @param bBigEndian Indicates if the ASes of the path are in network order.
+ *
+ * @return the path ID.
+ *
+ * @since 0.6.2.2
+ */
+uint32_t generatePathIdentifier(uint8_t asPathLength, uint32_t* asPath,
+                                uint8_t asType, bool bBigEndian);
+
 /**
  * Compare two given srx update identifiers with each other. 
  * The result is less than 0 for u1 less than u2, equals 0 if u1 equals u2 and
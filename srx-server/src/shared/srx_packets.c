@@ -21,10 +21,12 @@
  * by this software.
  *
  *
- * @version 0.4.0.0
+ * @version 0.6.2.2
  *
  * Changelog:
  * -----------------------------------------------------------------------------
+ * 0.6.2.2  - 2026/10/17
+ *            * Added the bulk verify PDUs to packetTypeToStr.
  * 0.4.0.0  - 2016/06/19 - oborchert
  *            * moved up to version 0.4.0.0 to be synched with header file.
  * 0.3.0.10 - 2015/11/10 - oborchert
@@ -72,6 +74,14 @@ const char* packetTypeToStr(SRxProxyPDUType type)
   {
     return PACKET_TYPES[type];
   }
+  else if (type == PDU_SRXPROXY_VERIFY_BULK_REQUEST)
+  {
+    return "Verify_Bulk";
+  }
+  else if (type == PDU_SRXPROXY_VERI_BULK_NOTIFICATION)
+  {
+    return "Verification_Bulk_Notification";
+  }
   else
   {
     return NULL;
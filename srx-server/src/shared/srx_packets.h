@@ -28,10 +28,16 @@
  * other licenses. Please refer to the licenses of all libraries required
  * by this software.
  *
- * @version 0.6.0.0
+ * @version 0.6.2.2
  *
  * Changelog:
  * -----------------------------------------------------------------------------
+ * 0.6.2.2  - 2026/10/17
+ *            * Use the zero field of SRXPROXY_HELLO and 
+ *              SRXPROXY_HELLO_RESPONSE to negotiate optional capabilities.
+ *            * Added PDU_SRXPROXY_VERIFY_BULK_REQUEST and 
+ *              PDU_SRXPROXY_VERI_BULK_NOTIFICATION which carry multiple 
+ *              verify requests respectively notifications in one PDU.
  * 0.6.0.0  - 2021/04/06 - oborchert
  *            * Moved asType and asRelType to SRXRPOXY_BasicHeader_VerifyRequest
  *              from struct SRXPROXY_VERIFY_V4_REQUEST and struct 
@@ -83,6 +89,12 @@
 /** Block Type Bits */
 #define SRX_PROXY_BLOCK_TYPE_LATEST_SIGNATURE  1
 
+/** Capabilities negotiated during the handshake */
+/** The bulk verify request and notification PDUs are supported */
+#define SRX_PROXY_CAP_BULK_VERIFY              1
+/** All capabilities supported by this implementation */
+#define SRX_PROXY_CAPABILITIES                 SRX_PROXY_CAP_BULK_VERIFY
+
 /** Peer Change Type */
 #define SRX_PROXY_PEER_CHANGE_TYPE_REMOVE 0
 #define SRX_PROXY_PEER_CHANGE_TYPE_ADD    1
@@ -118,7 +130,10 @@ typedef enum {
   PDU_SRXPROXY_PEER_CHANGE       =  9,
   PDU_SRXPROXY_SYNC_REQUEST      = 10,
   PDU_SRXPROXY_ERROR             = 11,
-  PDU_SRXPROXY_UNKNOWN           = 12    // NOT IN SPEC
+  PDU_SRXPROXY_UNKNOWN           = 12,   // NOT IN SPEC
+  // Only used if SRX_PROXY_CAP_BULK_VERIFY is negotiated
+  PDU_SRXPROXY_VERIFY_BULK_REQUEST    = 13,
+  PDU_SRXPROXY_VERI_BULK_NOTIFICATION = 14
 } SRxProxyPDUType;
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -151,7 +166,8 @@ typedef struct {
   uint8_t    type;              // 0
   uint16_t   version;
   uint8_t    reserved8;
-  uint32_t   zero32;
+  // The capabilities supported by the proxy (SRX_PROXY_CAP_...)
+  uint32_t   capabilities;
   uint32_t   length;            // Variable 24(+) Bytes
   uint32_t   proxyIdentifier;
   uint32_t   asn;
@@ -166,7 +182,8 @@ typedef struct {
   uint8_t   type;              // 1
   uint16_t  version;
   uint8_t   reserved8;
-  uint32_t  zero32;
+  // The capabilities supported by both, the proxy and the server
+  uint32_t  capabilities;
   uint32_t  length;            
   uint32_t  proxyIdentifier;    // 16 Bytes
 } __attribute__((packed)) SRXPROXY_HELLO_RESPONSE;
@@ -262,6 +279,19 @@ typedef struct {
   BGPSECValReqData bgpsecValReqData;
 } __attribute__((packed)) SRXPROXY_VERIFY_V6_REQUEST;
 
+/**
+ * This struct specifies the bulk verify request packet. The header is followed
+ * by noRequests complete SRXPROXY_VERIFY_V4_REQUEST or 
+ * SRXPROXY_VERIFY_V6_REQUEST PDUs, each with its own type and length.
+ */
+typedef struct {
+  uint8_t     type;            // 13
+  uint16_t    reserved16;
+  uint8_t     reserved8;
+  uint32_t    noRequests;
+  uint32_t    length;          // 12(+) Bytes
+} __attribute__((packed)) SRXPROXY_VERIFY_BULK_REQUEST;
+
 /**
  * This struct specifies the sign request packet
  */
@@ -292,6 +322,18 @@ typedef struct {
   SRxUpdateID updateID;
 } __attribute__((packed)) SRXPROXY_VERIFY_NOTIFICATION;
 
+/**
+ * This struct specifies the bulk verification notification packet. The header
+ * is followed by noNotifications SRXPROXY_VERIFY_NOTIFICATION PDUs.
+ */
+typedef struct {
+  uint8_t     type;            // 14
+  uint16_t    reserved16;
+  uint8_t     reserved8;
+  uint32_t    noNotifications;
+  uint32_t    length;          // 12(+) Bytes
+} __attribute__((packed)) SRXPROXY_VERIFY_BULK_NOTIFICATION;
+
 /**
  * This struct specifies the signature notification packet
  */
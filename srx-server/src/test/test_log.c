@@ -0,0 +1,284 @@
+/**
+ * This software was developed at the National Institute of Standards and
+ * Technology by employees of the Federal Government in the course of
+ * their official duties. Pursuant to title 17 Section 105 of the United
+ * States Code this software is not subject to copyright protection and
+ * is in the public domain.
+ *
+ * NIST assumes no responsibility whatsoever for its use by other parties,
+ * and makes no guarantees, expressed or implied, about its quality,
+ * reliability, or any other characteristic.
+ *
+ * We would appreciate acknowledgment if the software is used.
+ *
+ * NIST ALLOWS FREE USE OF THIS SOFTWARE IN ITS "AS IS" CONDITION AND
+ * DISCLAIM ANY LIABILITY OF ANY KIND FOR ANY DAMAGES WHATSOEVER RESULTING
+ * FROM THE USE OF THIS SOFTWARE.
+ *
+ * This software might use libraries that are under GNU public license or
+ * other licenses. Please refer to the licenses of all libraries required
+ * by this software.
+ *
+ *
+ * This files is used for testing and benchmarking the logging. Several
+ * threads log the messages of a path validation into a file. The test checks
+ * that all messages are written in order when using the log writer thread, 
+ * that long messages are written completely, and measures the validations per second for the log levels NOTICE and INFO with
+ * and without the writer thread.
+ *
+ * @version 0.6.2.2
+ *
+ * Changelog:
+ * -----------------------------------------------------------------------------
+ * 0.6.2.2  - 2026/10/17
+ *            * File created
+ */
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "util/log.h"
+
+/** Number of logging threads. */
+#define NO_THREADS       4
+/** Number of validations per thread and run. */
+#define NO_VALIDATIONS   50000
+/** Number of hops of each validated path. */
+#define NO_HOPS          5
+/** Length of the long message, longer than the messages within the rings. */
+#define LONG_MSG_LEN     2000
+
+/** The style of the log calls. */
+typedef enum {
+  /** Use the LOG macro. */
+  STYLE_GATED,
+  /** Call writeLog directly, the arguments are always evaluated. */
+  STYLE_UNGATED
+} LogStyle;
+
+/** The style used by the threads. */
+static LogStyle _style;
+/** Sum of the validations, keeps the compiler from removing them. */
+static uint32_t _result;
+
+/**
+ * Return the current time in nanoseconds.
+ *
+ * @return the monotonic time in nanoseconds.
+ */
+static uint64_t _now()
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+/**
+ * Perform validations of a path and log the messages of each hop the same way
+ * validateASPA does.
+ *
+ * @param arg The thread number.
+ *
+ * @return NULL
+ */
+static void* _validate(void* arg)
+{
+  uintptr_t thread = (uintptr_t)arg;
+  uint32_t  path[NO_HOPS];
+  uint32_t  result = 0;
+  int       idx, hop;
+
+  for (idx = 0; idx < NO_VALIDATIONS; idx++)
+  {
+    for (hop = 0; hop < NO_HOPS; hop++)
+    {
+      path[hop] = 65000 + ((idx + hop) % 100);
+    }
+    for (hop = 0; hop < NO_HOPS - 1; hop++)
+    {
+      result += path[hop] ^ path[hop + 1];
+      if (_style == STYLE_GATED)
+      {
+        LOG(LEVEL_INFO, "[T%u:%i] hop %i customer AS %u provider AS %u",
+            (unsigned)thread, idx, hop, path[hop], path[hop + 1]);
+      }
+      else
+      {
+        writeLog(LEVEL_INFO, "[%s] [T%u:%i] hop %i customer AS %u provider "
+                 "AS %u", logTimeStamp(), (unsigned)thread, idx, hop,
+                 path[hop], path[hop + 1]);
+      }
+    }
+  }
+  __atomic_fetch_add(&_result, result, __ATOMIC_RELAXED);
+
+  return NULL;
+}
+
+/**
+ * Run the validation threads with the given settings.
+ *
+ * @param level The log level.
+ * @param async Use the log writer thread.
+ * @param style The style of the log calls.
+ * @param stream The stream the log is written to.
+ *
+ * @return The validations per second.
+ */
+static double _run(LogLevel level, bool async, LogStyle style, FILE* stream)
+{
+  pthread_t threads[NO_THREADS];
+  uint64_t  start;
+  uintptr_t idx;
+
+  rewind(stream);
+  setLogMethodToFile(stream);
+  setLogLevel(level);
+  _style = style;
+  if (async && !startLogWriter())
+  {
+    printf ("Error: Could not start the log writer!\n");
+    exit (EXIT_FAILURE);
+  }
+
+  start = _now();
+  for (idx = 0; idx < NO_THREADS; idx++)
+  {
+    pthread_create(&threads[idx], NULL, _validate, (void*)idx);
+  }
+  for (idx = 0; idx < NO_THREADS; idx++)
+  {
+    pthread_join(threads[idx], NULL);
+  }
+  if (async)
+  {
+    stopLogWriter();
+  }
+  fflush(stream);
+
+  return (double)NO_THREADS * NO_VALIDATIONS * 1000000000 / (_now() - start);
+}
+
+/**
+ * Check that the file contains all messages and that the messages of each
+ * thread are in order. Exits the program on failure.
+ *
+ * @param stream The stream the log was written to.
+ */
+static void _checkLog(FILE* stream)
+{
+  char line[256];
+  int  next[NO_THREADS];
+  int  lines = 0;
+  int  expected;
+  unsigned int thread;
+  int  idx, hop;
+
+  memset(next, 0, sizeof(next));
+  rewind(stream);
+  while (fgets(line, sizeof(line), stream) != NULL)
+  {
+    if (   (sscanf(line, "%*[^]]] [T%u:%i] hop %i", &thread, &idx, &hop) != 3)
+        || (thread >= NO_THREADS)
+        || (idx * (NO_HOPS - 1) + hop != next[thread]))
+    {
+      printf ("Error: Unexpected message '%s'!\n", line);
+      exit (EXIT_FAILURE);
+    }
+    next[thread]++;
+    lines++;
+  }
+
+  expected = NO_THREADS * NO_VALIDATIONS * (NO_HOPS - 1);
+  if (lines != expected)
+  {
+    printf ("Error: %i messages written, expected %i!\n", lines, expected);
+    exit (EXIT_FAILURE);
+  }
+}
+
+/**
+ * Write a message longer than the messages stored within the rings of the
+ * log writer and check that it is written completely. Exits the program on 
+ * failure.
+ *
+ * @param stream The stream the log is written to.
+ */
+static void _checkLongMessage(FILE* stream)
+{
+  char text[LONG_MSG_LEN + 1];
+  char line[LONG_MSG_LEN + 64];
+  int  idx;
+
+  for (idx = 0; idx < LONG_MSG_LEN; idx++)
+  {
+    text[idx] = 'a' + (idx % 26);
+  }
+  text[LONG_MSG_LEN] = '\0';
+
+  rewind(stream);
+  setLogMethodToFile(stream);
+  setLogLevel(LEVEL_INFO);
+  if (!startLogWriter())
+  {
+    printf ("Error: Could not start the log writer!\n");
+    exit (EXIT_FAILURE);
+  }
+  writeLog(LEVEL_INFO, "%s", text);
+  stopLogWriter();
+  fflush(stream);
+
+  rewind(stream);
+  if (   (fgets(line, sizeof(line), stream) == NULL)
+      || (strlen(line) != strlen("   INFO ") + LONG_MSG_LEN + 1)
+      || (strncmp(line + strlen("   INFO "), text, LONG_MSG_LEN) != 0))
+  {
+    printf ("Error: The long message was not written completely!\n");
+    exit (EXIT_FAILURE);
+  }
+}
+
+/*
+ * Check the log writer thread and measure the validation throughput.
+ */
+int main(int argc, char** argv)
+{
+  FILE*  stream = tmpfile();
+  double rate;
+
+  if (stream == NULL)
+  {
+    printf ("Error: Could not create the log file!\n");
+    return (EXIT_FAILURE);
+  }
+
+  printf ("Test #1: Write the messages of %i threads by the log writer\n",
+          NO_THREADS);
+  _run(LEVEL_INFO, true, STYLE_GATED, stream);
+  _checkLog(stream);
+  printf ("         passed.\n");
+
+  printf ("Test #2: Write a message of %i characters by the log writer\n",
+          LONG_MSG_LEN);
+  _checkLongMessage(stream);
+  printf ("         passed.\n");
+
+  printf ("Test #3: Validations per second of %i threads\n", NO_THREADS);
+  printf ("         %-8s %-8s %-9s %14s\n", "level", "writer", "call",
+          "validations/s");
+  rate = _run(LEVEL_NOTICE, false, STYLE_UNGATED, stream);
+  printf ("         %-8s %-8s %-9s %14.0f\n", "NOTICE", "no", "writeLog",
+          rate);
+  rate = _run(LEVEL_NOTICE, false, STYLE_GATED, stream);
+  printf ("         %-8s %-8s %-9s %14.0f\n", "NOTICE", "no", "LOG", rate);
+  rate = _run(LEVEL_INFO, false, STYLE_GATED, stream);
+  printf ("         %-8s %-8s %-9s %14.0f\n", "INFO", "no", "LOG", rate);
+  rate = _run(LEVEL_INFO, true, STYLE_GATED, stream);
+  printf ("         %-8s %-8s %-9s %14.0f\n", "INFO", "yes", "LOG", rate);
+
+  fclose(stream);
+
+  return (EXIT_SUCCESS);
+}
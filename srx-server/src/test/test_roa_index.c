@@ -0,0 +1,410 @@
+/**
+ * This software was developed at the National Institute of Standards and
+ * Technology by employees of the Federal Government in the course of
+ * their official duties. Pursuant to title 17 Section 105 of the United
+ * States Code this software is not subject to copyright protection and
+ * is in the public domain.
+ *
+ * NIST assumes no responsibility whatsoever for its use by other parties,
+ * and makes no guarantees, expressed or implied, about its quality,
+ * reliability, or any other characteristic.
+ *
+ * We would appreciate acknowledgment if the software is used.
+ *
+ * NIST ALLOWS FREE USE OF THIS SOFTWARE IN ITS "AS IS" CONDITION AND
+ * DISCLAIM ANY LIABILITY OF ANY KIND FOR ANY DAMAGES WHATSOEVER RESULTING
+ * FROM THE USE OF THIS SOFTWARE.
+ *
+ * This software might use libraries that are under GNU public license or
+ * other licenses. Please refer to the licenses of all libraries required
+ * by this software.
+ *
+ *
+ * This files is used for testing and benchmarking the ROA index. The origin
+ * validation is checked against a linear search over all ROAs. The validation
+ * throughput of the readers is measured once with a stable index and once
+ * while a full resynchronization publishes new indexes of 500,000 ROAs.
+ *
+ * @version 0.6.2.2
+ *
+ * Changelog:
+ * -----------------------------------------------------------------------------
+ * 0.6.2.2  - 2026/10/17
+ *            * File created
+ */
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <arpa/inet.h>
+#include "server/roa_index.h"
+
+/** Number of ROAs compared against the linear search. */
+#define NO_CHECK_ROAS    5000
+/** Number of validations compared against the linear search. */
+#define NO_CHECK_UPDATES 20000
+/** Number of ROAs of the resynchronization. */
+#define NO_SYNC_ROAS     500000
+/** Number of reader threads. */
+#define NO_READERS       4
+/** Duration of each throughput measurement in milliseconds. */
+#define BENCH_TIME_MS    2000
+
+/** A test ROA. */
+typedef struct {
+  IPPrefix prefix;
+  uint8_t  maxLen;
+  uint32_t asn;
+} TEST_ROA;
+
+/** The index domain used by the readers and the writer. */
+static ROAIndexDomain domain;
+/** The ROAs of the resynchronization. */
+static TEST_ROA* syncROAs = NULL;
+/** Stops the reader and writer threads. */
+static volatile bool stop = false;
+
+/**
+ * Return the current time in nanoseconds.
+ *
+ * @return the monotonic time in nanoseconds.
+ */
+static uint64_t _now()
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+/**
+ * Fill the prefix with a random address of the given version and length.
+ *
+ * @param prefix The prefix to be filled.
+ * @param version The IP version.
+ * @param length The prefix length.
+ * @param seed The random seed (thread safe random numbers).
+ */
+static void _randomPrefix(IPPrefix* prefix, uint8_t version, uint8_t length,
+                          unsigned int* seed)
+{
+  int idx;
+
+  memset(prefix, 0, sizeof(IPPrefix));
+  prefix->ip.version = version;
+  prefix->length     = length;
+  if (version == 4)
+  {
+    // Keep the ROAs in 10.0.0.0/8 to get covering ROAs.
+    prefix->ip.addr.v4.u32 = htonl(0x0A000000
+                                   | (rand_r(seed) & 0x00FFFFFF));
+  }
+  else
+  {
+    prefix->ip.addr.v6.u8[0] = 0x20;
+    prefix->ip.addr.v6.u8[1] = 0x01;
+    for (idx = 2; idx < 16; idx++)
+    {
+      prefix->ip.addr.v6.u8[idx] = (uint8_t)rand_r(seed);
+    }
+    // Few different values in the first bytes to get covering ROAs.
+    prefix->ip.addr.v6.u8[2] &= 0x03;
+  }
+}
+
+/**
+ * Check if the first prefix covers the second one.
+ *
+ * @param roa The prefix of the ROA.
+ * @param prefix The prefix of the update.
+ *
+ * @return true if the ROA prefix covers the update prefix.
+ */
+static bool _covers(IPPrefix* roa, IPPrefix* prefix)
+{
+  uint8_t* roaAddr = roa->ip.version == 4 ? roa->ip.addr.v4.u8
+                                          : roa->ip.addr.v6.u8;
+  uint8_t* addr    = prefix->ip.version == 4 ? prefix->ip.addr.v4.u8
+                                             : prefix->ip.addr.v6.u8;
+  int bits;
+
+  if ((roa->ip.version != prefix->ip.version) || (roa->length > prefix->length))
+  {
+    return false;
+  }
+  for (bits = 0; bits < roa->length; bits++)
+  {
+    if (((roaAddr[bits / 8] ^ addr[bits / 8]) & (0x80 >> (bits % 8))) != 0)
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * Validate the prefix origin using a linear search over all ROAs (RFC 6811).
+ *
+ * @param roas The ROAs.
+ * @param noROAs The number of ROAs.
+ * @param prefix The prefix of the update.
+ * @param asn The origin AS of the update.
+ *
+ * @return The validation result.
+ */
+static SRxValidationResultVal _validateLinear(TEST_ROA* roas, int noROAs,
+                                              IPPrefix* prefix, uint32_t asn)
+{
+  SRxValidationResultVal result = SRx_RESULT_NOTFOUND;
+  int idx;
+
+  for (idx = 0; idx < noROAs; idx++)
+  {
+    if (_covers(&roas[idx].prefix, prefix))
+    {
+      if ((roas[idx].asn == asn) && (prefix->length <= roas[idx].maxLen))
+      {
+        return SRx_RESULT_VALID;
+      }
+      result = SRx_RESULT_INVALID;
+    }
+  }
+  return result;
+}
+
+/**
+ * Create the given number of random ROAs of both IP versions.
+ *
+ * @param noROAs The number of ROAs.
+ * @param seed The random seed.
+ *
+ * @return The ROAs.
+ */
+static TEST_ROA* _createROAs(int noROAs, unsigned int* seed)
+{
+  TEST_ROA* roas = malloc(noROAs * sizeof(TEST_ROA));
+  uint8_t   length;
+  int       idx;
+
+  for (idx = 0; idx < noROAs; idx++)
+  {
+    if (idx % 4 != 3)
+    {
+      length = 12 + rand_r(seed) % 13;
+      _randomPrefix(&roas[idx].prefix, 4, length, seed);
+      roas[idx].maxLen = length + rand_r(seed) % (33 - length);
+    }
+    else
+    {
+      length = 24 + rand_r(seed) % 25;
+      _randomPrefix(&roas[idx].prefix, 6, length, seed);
+      roas[idx].maxLen = length + rand_r(seed) % (49 - length);
+    }
+    roas[idx].asn = 65000 + rand_r(seed) % 100;
+  }
+
+  return roas;
+}
+
+/**
+ * Build a finished index of the given ROAs.
+ *
+ * @param roas The ROAs.
+ * @param noROAs The number of ROAs.
+ *
+ * @return The finished index.
+ */
+static ROAIndex* _buildIndex(TEST_ROA* roas, int noROAs)
+{
+  ROAIndex* index = createROAIndex();
+  int idx;
+
+  for (idx = 0; idx < noROAs; idx++)
+  {
+    if (!addToROAIndex(index, &roas[idx].prefix, roas[idx].maxLen,
+                       roas[idx].asn))
+    {
+      printf ("Error: Could not add ROA %i to the index!\n", idx);
+      exit (EXIT_FAILURE);
+    }
+  }
+  finishROAIndex(index);
+
+  return index;
+}
+
+/**
+ * Compare the validation of the index with the linear search.
+ */
+static void _test1()
+{
+  unsigned int seed   = 1;
+  TEST_ROA*    roas   = _createROAs(NO_CHECK_ROAS, &seed);
+  ROAIndex*    index  = _buildIndex(roas, NO_CHECK_ROAS);
+  int          result[3] = { 0, 0, 0 };
+  SRxValidationResultVal expected;
+  IPPrefix     prefix;
+  uint32_t     asn;
+  int          idx;
+
+  printf ("Test #1: Validate %i updates against %i ROAs\n", NO_CHECK_UPDATES,
+          NO_CHECK_ROAS);
+  for (idx = 0; idx < NO_CHECK_UPDATES; idx++)
+  {
+    if (idx % 2 == 0)
+    {
+      _randomPrefix(&prefix, 4, 8 + rand_r(&seed) % 25, &seed);
+    }
+    else
+    {
+      _randomPrefix(&prefix, 6, 16 + rand_r(&seed) % 49, &seed);
+    }
+    asn = 65000 + rand_r(&seed) % 100;
+
+    expected = _validateLinear(roas, NO_CHECK_ROAS, &prefix, asn);
+    if (validateWithROAIndex(index, &prefix, asn) != expected)
+    {
+      printf ("Error: Update %i; Expected result %u\n", idx, expected);
+      exit (EXIT_FAILURE);
+    }
+    result[expected]++;
+  }
+  printf ("         passed (%i valid, %i not found, %i invalid).\n",
+          result[SRx_RESULT_VALID], result[SRx_RESULT_NOTFOUND],
+          result[SRx_RESULT_INVALID]);
+
+  releaseROAIndex(index);
+  free(roas);
+}
+
+/**
+ * Reader thread, validates random updates with the published index until
+ * stopped.
+ *
+ * @param arg OUT - The number of validations (uint64_t).
+ *
+ * @return NULL
+ */
+static void* _reader(void* arg)
+{
+  unsigned int seed = (unsigned int)(uintptr_t)arg;
+  uint64_t     count = 0;
+  IPPrefix     prefix;
+  ROAIndex*    index;
+  int          slot;
+
+  _randomPrefix(&prefix, 4, 24, &seed);
+  while (!stop)
+  {
+    prefix.ip.addr.v4.u32 = htonl(0x0A000000 | (rand_r(&seed) & 0x00FFFF00));
+    index = enterROAIndex(&domain, &slot);
+    validateWithROAIndex(index, &prefix, 65000 + count % 100);
+    leaveROAIndex(&domain, slot);
+    count++;
+  }
+  *(uint64_t*)arg = count;
+
+  return NULL;
+}
+
+/**
+ * Writer thread, builds and publishes the index of the resynchronization
+ * until stopped.
+ *
+ * @param arg unused.
+ *
+ * @return NULL
+ */
+static void* _writer(void* arg)
+{
+  while (!stop)
+  {
+    publishROAIndex(&domain, _buildIndex(syncROAs, NO_SYNC_ROAS));
+  }
+
+  return NULL;
+}
+
+/**
+ * Measure the number of validations per second of all readers.
+ *
+ * @param resync Indicates if a writer resynchronizes meanwhile.
+ *
+ * @return The validations per second.
+ */
+static double _benchReaders(bool resync)
+{
+  pthread_t readers[NO_READERS];
+  pthread_t writer;
+  uint64_t  counts[NO_READERS];
+  uint64_t  total = 0;
+  uint64_t  start;
+  struct timespec wait = { BENCH_TIME_MS / 1000,
+                           (BENCH_TIME_MS % 1000) * 1000000 };
+  int idx;
+
+  stop = false;
+  start = _now();
+  for (idx = 0; idx < NO_READERS; idx++)
+  {
+    counts[idx] = idx + 1;
+    pthread_create(&readers[idx], NULL, _reader, &counts[idx]);
+  }
+  if (resync)
+  {
+    pthread_create(&writer, NULL, _writer, NULL);
+  }
+  nanosleep(&wait, NULL);
+  stop = true;
+  for (idx = 0; idx < NO_READERS; idx++)
+  {
+    pthread_join(readers[idx], NULL);
+    total += counts[idx];
+  }
+  start = _now() - start;
+  if (resync)
+  {
+    pthread_join(writer, NULL);
+  }
+
+  return total * 1e9 / start;
+}
+
+/**
+ * Measure the validation throughput with and without resynchronization.
+ */
+static void _test2()
+{
+  unsigned int seed = 2;
+  uint64_t     start;
+  uint32_t     publishes;
+  double       stable, resync;
+
+  syncROAs = _createROAs(NO_SYNC_ROAS, &seed);
+  start = _now();
+  initROAIndexDomain(&domain);
+  publishROAIndex(&domain, _buildIndex(syncROAs, NO_SYNC_ROAS));
+  printf ("Test #2: %i readers, index of %i ROAs built in %.1f ms\n",
+          NO_READERS, NO_SYNC_ROAS, (_now() - start) / 1e6);
+
+  stable = _benchReaders(false);
+  publishes = domain.publishes;
+  resync = _benchReaders(true);
+  printf ("         stable index   : %12.0f validations/s\n", stable);
+  printf ("         resynchronizing: %12.0f validations/s (%u indexes "
+          "published)\n", resync, domain.publishes - publishes);
+
+  releaseROAIndexDomain(&domain);
+  free(syncROAs);
+}
+
+/*
+ * Test and benchmark the ROA index.
+ */
+int main(int argc, char** argv)
+{
+  _test1();
+  _test2();
+
+  return (EXIT_SUCCESS);
+}
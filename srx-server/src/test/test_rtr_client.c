@@ -0,0 +1,577 @@
+/**
+ * This software was developed at the National Institute of Standards and
+ * Technology by employees of the Federal Government in the course of
+ * their official duties. Pursuant to title 17 Section 105 of the United
+ * States Code this software is not subject to copyright protection and
+ * is in the public domain.
+ *
+ * NIST assumes no responsibility whatsoever for its use by other parties,
+ * and makes no guarantees, expressed or implied, about its quality,
+ * reliability, or any other characteristic.
+ *
+ * We would appreciate acknowledgment if the software is used.
+ *
+ * NIST ALLOWS FREE USE OF THIS SOFTWARE IN ITS "AS IS" CONDITION AND
+ * DISCLAIM ANY LIABILITY OF ANY KIND FOR ANY DAMAGES WHATSOEVER RESULTING
+ * FROM THE USE OF THIS SOFTWARE.
+ *
+ * This software might use libraries that are under GNU public license or
+ * other licenses. Please refer to the licenses of all libraries required
+ * by this software.
+ *
+ *
+ * This files is used for testing and benchmarking the receiving of the RPKI
+ * router client. A recorded full synchronization of 500,000 ROAs and 50,000
+ * ASPA objects is replayed from a local socket. The test checks the data
+ * passed to the callbacks and measures the PDUs per second and the number of
+ * receive calls. For comparison the stream is also read the way the client
+ * did before, using one receive call for the header and one for the rest of
+ * each PDU.
+ *
+ * @version 0.6.2.2
+ *
+ * Changelog:
+ * -----------------------------------------------------------------------------
+ * 0.6.2.2  - 2026/10/17
+ *            * File created
+ */
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include "server/rpki_router_client.h"
+#include "shared/rpki_router.h"
+#include "util/log.h"
+#include "util/socket.h"
+
+/** Number of IPv4 ROAs in the stream. */
+#define NO_ROAS_V4       400000
+/** Number of IPv6 ROAs in the stream. */
+#define NO_ROAS_V6       100000
+/** Number of ASPA objects in the stream. */
+#define NO_ASPAS         50000
+/** Number of providers of the large ASPA object (larger than the buffer). */
+#define NO_LARGE_ASPA    30000
+/** Number of router keys, they move the following PDUs off alignment. */
+#define NO_KEYS          3
+/** The protocol version of the stream. */
+#define STREAM_VERSION   2
+/** The session ID of the stream. */
+#define STREAM_SESSION   0x1234
+
+/** The recorded stream. */
+typedef struct {
+  uint8_t* data;
+  size_t   size;
+  size_t   noPDUs;
+  /** The listening socket of the cache. */
+  int      listenFD;
+  /** The port of the cache. */
+  int      port;
+} TEST_STREAM;
+
+/** The statistics of a run. */
+typedef struct {
+  uint32_t prefixes;
+  uint32_t aspas;
+  uint32_t keys;
+  uint32_t batches;
+  uint32_t endOfData;
+  uint32_t errors;
+} TEST_RESULT;
+
+/** The result of the current run, written by the client thread. */
+static TEST_RESULT _result;
+
+/**
+ * Return the current time in nanoseconds.
+ *
+ * @return the monotonic time in nanoseconds.
+ */
+static uint64_t _now()
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+/**
+ * Reserve the given number of bytes at the end of the stream.
+ *
+ * @param stream The stream.
+ * @param length The length of the PDU.
+ * @param type The type of the PDU.
+ *
+ * @return The start of the PDU, the memory is zeroed.
+ */
+static uint8_t* _addPDU(TEST_STREAM* stream, uint32_t length, uint8_t type)
+{
+  RPKICommonHeader* hdr = (RPKICommonHeader*)(stream->data + stream->size);
+
+  memset(hdr, 0, length);
+  hdr->version = STREAM_VERSION;
+  hdr->type    = type;
+  hdr->length  = htonl(length);
+  stream->size += length;
+  stream->noPDUs++;
+
+  return (uint8_t*)hdr;
+}
+
+/**
+ * Add an ASPA PDU to the stream. The providers follow the customer AS.
+ *
+ * @param stream The stream.
+ * @param customer The customer AS.
+ * @param noProviders The number of providers.
+ */
+static void _addASPA(TEST_STREAM* stream, uint32_t customer,
+                     uint16_t noProviders)
+{
+  RPKIASPAHeader* hdr;
+  uint8_t*        providers;
+  uint32_t        provider;
+  int             idx;
+
+  hdr = (RPKIASPAHeader*)_addPDU(stream, sizeof(RPKIASPAHeader)
+                                 + noProviders * 4, PDU_TYPE_ASPA);
+  hdr->flags             = PREFIX_FLAG_ANNOUNCEMENT;
+  hdr->provider_as_count = htons(noProviders);
+  hdr->customer_asn      = htonl(customer);
+  // The stream is not aligned after a router key.
+  providers = (uint8_t*)hdr + sizeof(RPKIASPAHeader);
+  for (idx = 0; idx < noProviders; idx++)
+  {
+    provider = htonl(customer + idx + 1);
+    memcpy(providers + idx * 4, &provider, 4);
+  }
+}
+
+/**
+ * Record the stream of a full synchronization.
+ *
+ * @param stream The stream to be filled.
+ */
+static void _recordStream(TEST_STREAM* stream)
+{
+  RPKICacheResponseHeader* response;
+  RPKIIPv4PrefixHeader*    v4;
+  RPKIIPv6PrefixHeader*    v6;
+  RPKIRouterKeyHeader*     key;
+  RPKIEndOfDataHeader_2*   eod;
+  uint32_t                 idx;
+  int                      keys = 0;
+
+  stream->data   = malloc((size_t)NO_ROAS_V4 * sizeof(RPKIIPv4PrefixHeader)
+                          + (size_t)NO_ROAS_V6 * sizeof(RPKIIPv6PrefixHeader)
+                          + (size_t)NO_ASPAS * (sizeof(RPKIASPAHeader) + 16)
+                          + NO_LARGE_ASPA * 4 + 4096);
+  stream->size   = 0;
+  stream->noPDUs = 0;
+
+  response = (RPKICacheResponseHeader*)_addPDU(stream,
+                  sizeof(RPKICacheResponseHeader), PDU_TYPE_CACHE_RESPONSE);
+  response->sessionID = htons(STREAM_SESSION);
+
+  for (idx = 0; idx < NO_ROAS_V4 + NO_ROAS_V6; idx++)
+  {
+    if ((keys < NO_KEYS) && (idx == 1000 + keys * 200000))
+    {
+      key = (RPKIRouterKeyHeader*)_addPDU(stream, sizeof(RPKIRouterKeyHeader),
+                                          PDU_TYPE_ROUTER_KEY);
+      key->flags = PREFIX_FLAG_ANNOUNCEMENT;
+      key->as    = htonl(65000 + keys);
+      keys++;
+    }
+    if (idx < NO_ROAS_V4)
+    {
+      v4 = (RPKIIPv4PrefixHeader*)_addPDU(stream, sizeof(RPKIIPv4PrefixHeader),
+                                          PDU_TYPE_IP_V4_PREFIX);
+      v4->flags       = PREFIX_FLAG_ANNOUNCEMENT;
+      v4->prefixLen   = 24;
+      v4->maxLen      = 24;
+      v4->addr.in_addr.s_addr = htonl(0x0A000000 + (idx << 8));
+      v4->as          = htonl(idx);
+    }
+    else
+    {
+      v6 = (RPKIIPv6PrefixHeader*)_addPDU(stream, sizeof(RPKIIPv6PrefixHeader),
+                                          PDU_TYPE_IP_V6_PREFIX);
+      v6->flags       = PREFIX_FLAG_ANNOUNCEMENT;
+      v6->prefixLen   = 48;
+      v6->maxLen      = 64;
+      v6->addr.in_addr.s6_addr32[0] = htonl(0x20010DB8);
+      v6->addr.in_addr.s6_addr32[1] = htonl(idx);
+      v6->as          = htonl(idx);
+    }
+  }
+
+  for (idx = 0; idx < NO_ASPAS; idx++)
+  {
+    _addASPA(stream, idx, 1 + idx % 4);
+    if (idx == NO_ASPAS / 2)
+    {
+      _addASPA(stream, NO_ASPAS, NO_LARGE_ASPA);
+    }
+  }
+
+  eod = (RPKIEndOfDataHeader_2*)_addPDU(stream, sizeof(RPKIEndOfDataHeader_2),
+                                        PDU_TYPE_END_OF_DATA);
+  eod->v1.sessionID       = htons(STREAM_SESSION);
+  eod->v1.serial          = htonl(1);
+  eod->refresh_interval   = htonl(3600);
+  eod->retry_interval     = htonl(600);
+  eod->expire_interval    = htonl(7200);
+}
+
+/**
+ * Replay the stream to one connection. Waits for the reset query, sends the
+ * stream and waits until the client closes the connection.
+ *
+ * @param arg The stream.
+ *
+ * @return NULL
+ */
+static void* _replay(void* arg)
+{
+  TEST_STREAM* stream = (TEST_STREAM*)arg;
+  uint8_t      query[sizeof(RPKIResetQueryHeader)];
+  int          fd = accept(stream->listenFD, NULL, NULL);
+
+  if (   (fd == -1) || !recvNum(&fd, query, sizeof(query))
+      || !sendNum(&fd, stream->data, stream->size))
+  {
+    printf ("Error: Could not replay the stream!\n");
+    exit (EXIT_FAILURE);
+  }
+  // Wait until the client is done.
+  while (recv(fd, query, sizeof(query), 0) > 0);
+  close(fd);
+
+  return NULL;
+}
+
+/**
+ * Open the listening socket of the cache on a free local port.
+ *
+ * @param stream The stream.
+ */
+static void _listen(TEST_STREAM* stream)
+{
+  struct sockaddr_in addr;
+  socklen_t          len = sizeof(addr);
+
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family      = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  stream->listenFD     = socket(AF_INET, SOCK_STREAM, 0);
+  if (   (stream->listenFD == -1)
+      || (bind(stream->listenFD, (struct sockaddr*)&addr, sizeof(addr)) != 0)
+      || (listen(stream->listenFD, 1) != 0)
+      || (getsockname(stream->listenFD, (struct sockaddr*)&addr, &len) != 0))
+  {
+    printf ("Error: Could not open the cache socket!\n");
+    exit (EXIT_FAILURE);
+  }
+  stream->port = ntohs(addr.sin_port);
+}
+
+/**
+ * Check a prefix, the prefixes are expected in the order of the stream.
+ */
+static void _checkPrefix(bool isAnn, IPPrefix* prefix, uint16_t maxLen,
+                         uint32_t oas)
+{
+  uint32_t idx = _result.prefixes++;
+  bool     ok  = isAnn && (oas == idx);
+
+  if (idx < NO_ROAS_V4)
+  {
+    ok = ok && (prefix->ip.version == 4) && (maxLen == 24)
+         && (ntohl(prefix->ip.addr.v4.in_addr.s_addr)
+             == 0x0A000000 + (idx << 8));
+  }
+  else
+  {
+    ok = ok && (prefix->ip.version == 6) && (maxLen == 64)
+         && (ntohl(prefix->ip.addr.v6.in_addr.s6_addr32[1]) == idx);
+  }
+  if (!ok)
+  {
+    _result.errors++;
+  }
+}
+
+/**
+ * The prefix callback of the client.
+ */
+static void _handlePrefix(uint32_t valCacheID, uint16_t sessionID,
+                          bool isAnn, IPPrefix* prefix, uint16_t maxLen,
+                          uint32_t oas, void* rpkiHandler)
+{
+  _checkPrefix(isAnn, prefix, maxLen, oas);
+}
+
+/**
+ * The prefix batch callback of the client.
+ */
+static void _handlePrefixBatch(uint32_t valCacheID, uint16_t sessionID,
+                               RPKIPrefixRecord* records, uint32_t count,
+                               void* rpkiHandler)
+{
+  uint32_t idx;
+
+  _result.batches++;
+  if ((count == 0) || (count > RRC_PREFIX_BATCH_SIZE))
+  {
+    _result.errors++;
+  }
+  for (idx = 0; idx < count; idx++)
+  {
+    _checkPrefix(records[idx].isAnn, &records[idx].prefix,
+                 records[idx].maxLen, records[idx].oas);
+  }
+}
+
+/**
+ * The router key callback of the client.
+ */
+static void _handleRouterKey(uint32_t valCacheID, uint16_t sessionID,
+                             bool isAnn, uint32_t asn, const char* ski,
+                             const char* keyInfo, void* rpkiHandler)
+{
+  if (asn != 65000 + _result.keys++)
+  {
+    _result.errors++;
+  }
+}
+
+/**
+ * The ASPA callback of the client. The providers are checked.
+ */
+static void _handleASPA(uint32_t valCacheID, uint16_t sessionID, bool isAnn,
+                        uint32_t customerAS, uint16_t providerCt,
+                        uint32_t* providerASList, void* rpkiHandler)
+{
+  uint16_t expected = (customerAS == NO_ASPAS) ? NO_LARGE_ASPA
+                                               : 1 + customerAS % 4;
+  int      idx;
+
+  _result.aspas++;
+  if ((((uintptr_t)providerASList) % 4 != 0) || (providerCt != expected))
+  {
+    _result.errors++;
+    return;
+  }
+  for (idx = 0; idx < providerCt; idx++)
+  {
+    if (providerASList[idx] != customerAS + idx + 1)
+    {
+      _result.errors++;
+      return;
+    }
+  }
+}
+
+/**
+ * The end of data callback of the client.
+ */
+static void _handleEndOfData(uint32_t valCacheID, uint16_t sessionID,
+                             void* rpkiHandler)
+{
+  _result.endOfData++;
+}
+
+/**
+ * The reset callback of the client.
+ */
+static void _handleReset(uint32_t valCacheID, void* rpkiHandler)
+{
+}
+
+/**
+ * Receive the stream using the RPKI router client.
+ *
+ * @param stream The stream.
+ * @param batch Use the prefix batch callback.
+ * @param recvCalls OUT - The number of receive calls.
+ *
+ * @return The PDUs per second.
+ */
+static double _runClient(TEST_STREAM* stream, bool batch, uint64_t* recvCalls)
+{
+  RPKIRouterClientParams params;
+  RPKIRouterClient       client;
+  pthread_t              cache;
+  uint64_t               start;
+  double                 rate;
+
+  memset(&params, 0, sizeof(params));
+  memset(&client, 0, sizeof(client));
+  memset(&_result, 0, sizeof(_result));
+  params.prefixCallback      = _handlePrefix;
+  params.prefixBatchCallback = batch ? _handlePrefixBatch : NULL;
+  params.routerKeyCallback   = _handleRouterKey;
+  params.aspaCallback        = _handleASPA;
+  params.endOfDataCallback   = _handleEndOfData;
+  params.resetCallback       = _handleReset;
+  params.serverHost          = "127.0.0.1";
+  params.serverPort          = stream->port;
+  params.version             = STREAM_VERSION;
+  client.stopAfterEndOfData  = true;
+
+  pthread_create(&cache, NULL, _replay, stream);
+  start = _now();
+  if (!createRPKIRouterClient(&client, &params, NULL))
+  {
+    printf ("Error: Could not create the client!\n");
+    exit (EXIT_FAILURE);
+  }
+  pthread_join(client.thread, NULL);
+  rate = (double)stream->noPDUs * 1000000000 / (_now() - start);
+  closeClientSocket(&client.clSock);
+  releaseMutex(&client.writeMutex);
+  pthread_join(cache, NULL);
+
+  if (   (_result.errors != 0) || (_result.endOfData != 1)
+      || (_result.prefixes != NO_ROAS_V4 + NO_ROAS_V6)
+      || (_result.aspas != NO_ASPAS + 1) || (_result.keys != NO_KEYS)
+      || (client.recvPDUs != stream->noPDUs)
+      || (batch != (_result.batches != 0)))
+  {
+    printf ("Error: %u errors, %u prefixes, %u ASPA objects, %u keys, "
+            "%u end of data, %llu PDUs!\n", _result.errors, _result.prefixes,
+            _result.aspas, _result.keys, _result.endOfData,
+            (unsigned long long)client.recvPDUs);
+    exit (EXIT_FAILURE);
+  }
+  *recvCalls = client.recvCalls;
+
+  return rate;
+}
+
+/**
+ * Receive the stream the way the client did before: One receive call for the
+ * common header and one for the rest of the PDU.
+ *
+ * @param stream The stream.
+ * @param recvCalls OUT - The number of receive calls.
+ *
+ * @return The PDUs per second.
+ */
+static double _runPerPDU(TEST_STREAM* stream, uint64_t* recvCalls)
+{
+  struct sockaddr_in   addr;
+  RPKIResetQueryHeader query;
+  RPKICommonHeader*    hdr;
+  pthread_t            cache;
+  uint32_t             size   = sizeof(RPKIRouterKeyHeader);
+  uint8_t*             buffer = malloc(size);
+  uint32_t             pduLen;
+  uint64_t             start, noPDUs = 0;
+  double               rate;
+  int                  fd;
+
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family      = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  addr.sin_port        = htons(stream->port);
+  memset(&query, 0, sizeof(query));
+  query.version = STREAM_VERSION;
+  query.type    = PDU_TYPE_RESET_QUERY;
+  query.length  = htonl(sizeof(query));
+  *recvCalls    = 0;
+
+  pthread_create(&cache, NULL, _replay, stream);
+  start = _now();
+  fd    = socket(AF_INET, SOCK_STREAM, 0);
+  if (   (connect(fd, (struct sockaddr*)&addr, sizeof(addr)) != 0)
+      || !sendNum(&fd, &query, sizeof(query)))
+  {
+    printf ("Error: Could not connect to the cache!\n");
+    exit (EXIT_FAILURE);
+  }
+
+  hdr = (RPKICommonHeader*)buffer;
+  do
+  {
+    memset(buffer, 0, size);
+    (*recvCalls)++;
+    if (!recvNum(&fd, buffer, sizeof(RPKICommonHeader)))
+    {
+      break;
+    }
+    pduLen = ntohl(hdr->length);
+    if (pduLen > size)
+    {
+      buffer = realloc(buffer, pduLen);
+      size   = pduLen;
+      hdr    = (RPKICommonHeader*)buffer;
+    }
+    (*recvCalls)++;
+    if (!recvNum(&fd, buffer + sizeof(RPKICommonHeader),
+                 pduLen - sizeof(RPKICommonHeader)))
+    {
+      break;
+    }
+    noPDUs++;
+  } while (hdr->type != PDU_TYPE_END_OF_DATA);
+  rate = (double)noPDUs * 1000000000 / (_now() - start);
+
+  close(fd);
+  pthread_join(cache, NULL);
+  free(buffer);
+
+  if (noPDUs != stream->noPDUs)
+  {
+    printf ("Error: %llu PDUs received, expected %zu!\n",
+            (unsigned long long)noPDUs, stream->noPDUs);
+    exit (EXIT_FAILURE);
+  }
+
+  return rate;
+}
+
+/*
+ * Replay the stream to the client and measure the receiving.
+ */
+int main(int argc, char** argv)
+{
+  TEST_STREAM stream;
+  uint64_t    recvCalls;
+  double      rate;
+
+  setLogMethodToFile(stderr);
+  setLogLevel(LEVEL_WARNING);
+  _recordStream(&stream);
+  _listen(&stream);
+
+  printf ("Test #1: Receive %zu PDUs (%zu bytes) with the RPKI router "
+          "client\n", stream.noPDUs, stream.size);
+  _runClient(&stream, true, &recvCalls);
+  _runClient(&stream, false, &recvCalls);
+  printf ("         passed.\n");
+
+  printf ("Test #2: Receive the stream\n");
+  printf ("         %-28s %12s %12s\n", "reader", "recv calls", "PDUs/s");
+  rate = _runPerPDU(&stream, &recvCalls);
+  printf ("         %-28s %12llu %12.0f\n", "header and body per PDU",
+          (unsigned long long)recvCalls, rate);
+  rate = _runClient(&stream, false, &recvCalls);
+  printf ("         %-28s %12llu %12.0f\n", "client, prefix callback",
+          (unsigned long long)recvCalls, rate);
+  rate = _runClient(&stream, true, &recvCalls);
+  printf ("         %-28s %12llu %12.0f\n", "client, prefix batch callback",
+          (unsigned long long)recvCalls, rate);
+
+  close(stream.listenFD);
+  free(stream.data);
+
+  return (EXIT_SUCCESS);
+}
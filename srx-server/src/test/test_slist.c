@@ -0,0 +1,315 @@
+/**
+ * This software was developed at the National Institute of Standards and
+ * Technology by employees of the Federal Government in the course of
+ * their official duties. Pursuant to title 17 Section 105 of the United
+ * States Code this software is not subject to copyright protection and
+ * is in the public domain.
+ *
+ * NIST assumes no responsibility whatsoever for its use by other parties,
+ * and makes no guarantees, expressed or implied, about its quality,
+ * reliability, or any other characteristic.
+ *
+ * We would appreciate acknowledgment if the software is used.
+ *
+ * NIST ALLOWS FREE USE OF THIS SOFTWARE IN ITS "AS IS" CONDITION AND
+ * DISCLAIM ANY LIABILITY OF ANY KIND FOR ANY DAMAGES WHATSOEVER RESULTING
+ * FROM THE USE OF THIS SOFTWARE.
+ *
+ * This software might use libraries that are under GNU public license or
+ * other licenses. Please refer to the licenses of all libraries required
+ * by this software.
+ *
+ *
+ * This files is used for testing and benchmarking the indexed list. Random
+ * list operations on two indexed lists are checked against the expected
+ * membership. The cost of removing an update from a list of 100,000 and
+ * 1,000,000 cached updates is measured with and without the index.
+ *
+ * @version 0.6.2.2
+ *
+ * Changelog:
+ * -----------------------------------------------------------------------------
+ * 0.6.2.2  - 2026/10/17
+ *            * File created
+ */
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "util/slist.h"
+
+/** Number of elements used for the random operations. */
+#define NO_CHECK_ELEMENTS 2000
+/** Number of random operations. */
+#define NO_CHECK_OPS      200000
+/** Number of deletes measured without the index. */
+#define NO_LINEAR_DELETES 200
+
+/** A test element, the list holds pointers to it. */
+typedef struct {
+  int id;
+  /** The list the element is stored in: 0 = none, 1 or 2 */
+  int list;
+} TEST_ELEMENT;
+
+/**
+ * Return the current time in nanoseconds.
+ *
+ * @return the monotonic time in nanoseconds.
+ */
+static uint64_t _now()
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+/**
+ * Check the links of the list, the size, and that each element found in the
+ * list is expected in it. Exits the program on failure.
+ *
+ * @param list The list to check.
+ * @param listID The expected list of the elements.
+ * @param op The number of the operation for the error message.
+ */
+static void _checkList(SList* list, int listID, int op)
+{
+  SListNode* node;
+  SListNode* prev = NULL;
+  int        size = 0;
+
+  FOREACH_SLIST(list, node)
+  {
+    if ((node->prev != prev) || (((TEST_ELEMENT*)node->data)->list != listID))
+    {
+      printf ("Error: Operation %i; List %i is corrupt at node %i!\n", op,
+              listID, size);
+      exit (EXIT_FAILURE);
+    }
+    prev = node;
+    size++;
+  }
+  if ((size != list->size) || (list->last != prev))
+  {
+    printf ("Error: Operation %i; List %i has %i nodes, expected %i!\n", op,
+            listID, size, list->size);
+    exit (EXIT_FAILURE);
+  }
+}
+
+/**
+ * Run random appends, inserts, deletes, shifts and moves on two indexed lists
+ * and compare the list content with the expected list of each element.
+ */
+static void _test1()
+{
+  TEST_ELEMENT  elements[NO_CHECK_ELEMENTS];
+  SList         lists[2];
+  SListNode*    node;
+  TEST_ELEMENT* element;
+  unsigned int  seed = 1;
+  int           idx, op, action;
+
+  printf ("Test #1: %i random operations on two indexed lists\n",
+          NO_CHECK_OPS);
+  for (idx = 0; idx < NO_CHECK_ELEMENTS; idx++)
+  {
+    elements[idx].id   = idx;
+    elements[idx].list = 0;
+  }
+  initSList(&lists[0]);
+  initSList(&lists[1]);
+  indexSList(&lists[0]);
+  indexSList(&lists[1]);
+
+  for (op = 0; op < NO_CHECK_OPS; op++)
+  {
+    element = &elements[rand_r(&seed) % NO_CHECK_ELEMENTS];
+    action  = rand_r(&seed) % 10;
+
+    if (element->list == 0)
+    {
+      // Add it to one of the lists
+      idx = rand_r(&seed) % 2;
+      if (action < 7)
+      {
+        appendDataToSList(&lists[idx], element);
+      }
+      else
+      {
+        insertDataIntoSList(&lists[idx], rand_r(&seed) % (lists[idx].size + 1),
+                            element);
+      }
+      element->list = idx + 1;
+    }
+    else if (action < 6)
+    {
+      if (!deleteFromSList(&lists[element->list - 1], element))
+      {
+        printf ("Error: Operation %i; Element %i not found!\n", op,
+                element->id);
+        exit (EXIT_FAILURE);
+      }
+      element->list = 0;
+    }
+    else if (action < 9)
+    {
+      // Move it into the other list
+      idx = element->list - 1;
+      FOREACH_SLIST(&lists[idx], node)
+      {
+        if (node->data == element)
+        {
+          break;
+        }
+      }
+      moveSListNode(&lists[1 - idx], &lists[idx], node, node->prev);
+      element->list = 2 - idx;
+    }
+    else if (lists[element->list - 1].size > 0)
+    {
+      idx = element->list - 1;
+      ((TEST_ELEMENT*)shiftFromSList(&lists[idx]))->list = 0;
+    }
+
+    for (idx = 0; idx < NO_CHECK_ELEMENTS; idx++)
+    {
+      if (op % 1000 != 0)
+      {
+        idx += rand_r(&seed) % 50;
+        if (idx >= NO_CHECK_ELEMENTS)
+        {
+          break;
+        }
+      }
+      if (existsInSList(&lists[0], &elements[idx])
+            != (elements[idx].list == 1)
+          || existsInSList(&lists[1], &elements[idx])
+            != (elements[idx].list == 2))
+      {
+        printf ("Error: Operation %i; Element %i expected in list %i!\n", op,
+                idx, elements[idx].list);
+        exit (EXIT_FAILURE);
+      }
+    }
+    _checkList(&lists[0], 1, op);
+    _checkList(&lists[1], 2, op);
+  }
+
+  // Move the second list into the first one.
+  moveSList(&lists[0], &lists[1]);
+  FOREACH_SLIST(&lists[0], node)
+  {
+    ((TEST_ELEMENT*)node->data)->list = 1;
+  }
+  for (idx = 0; idx < NO_CHECK_ELEMENTS; idx++)
+  {
+    if (existsInSList(&lists[0], &elements[idx]) != (elements[idx].list != 0))
+    {
+      printf ("Error: Element %i lost while moving the list!\n", idx);
+      exit (EXIT_FAILURE);
+    }
+  }
+  _checkList(&lists[0], 1, op);
+  _checkList(&lists[1], 2, op);
+
+  printf ("         passed (%i and %i elements left).\n", lists[0].size,
+          lists[1].size);
+  releaseSList(&lists[0]);
+  releaseSList(&lists[1]);
+}
+
+/**
+ * Fill the list with the given number of updates and measure the deletion
+ * of updates in random order.
+ *
+ * @param noUpdates The number of cached updates.
+ * @param indexed Use an indexed list.
+ * @param noDeletes The number of deletes to measure.
+ *
+ * @return The average time per delete in nanoseconds.
+ */
+static double _measure(int noUpdates, bool indexed, int noDeletes)
+{
+  int*         updates = malloc(noUpdates * sizeof(int));
+  int*         order   = malloc(noUpdates * sizeof(int));
+  unsigned int seed    = 1;
+  SList        list;
+  uint64_t     start;
+  double       time;
+  int          idx, swap, tmp;
+
+  initSList(&list);
+  if (indexed)
+  {
+    indexSList(&list);
+  }
+  for (idx = 0; idx < noUpdates; idx++)
+  {
+    order[idx] = idx;
+    appendDataToSList(&list, &updates[idx]);
+  }
+  for (idx = 0; idx < noDeletes; idx++)
+  {
+    swap = idx + rand_r(&seed) % (noUpdates - idx);
+    tmp         = order[idx];
+    order[idx]  = order[swap];
+    order[swap] = tmp;
+  }
+
+  start = _now();
+  for (idx = 0; idx < noDeletes; idx++)
+  {
+    if (!deleteFromSList(&list, &updates[order[idx]]))
+    {
+      printf ("Error: Update %i not found!\n", order[idx]);
+      exit (EXIT_FAILURE);
+    }
+  }
+  time = (double)(_now() - start) / noDeletes;
+
+  if (list.size != noUpdates - noDeletes)
+  {
+    printf ("Error: %i updates left, expected %i\n", list.size,
+            noUpdates - noDeletes);
+    exit (EXIT_FAILURE);
+  }
+  releaseSList(&list);
+  free(order);
+  free(updates);
+
+  return time;
+}
+
+/**
+ * Measure the cost of deleting updates from the list of 100,000 and 1,000,000
+ * cached updates.
+ */
+static void _test2()
+{
+  static int noUpdates[] = { 100000, 1000000 };
+  double linear, indexed;
+  int    test;
+
+  printf ("Test #2: Delete updates from the update list\n");
+  printf ("         %10s %16s %16s\n", "updates", "walk [ns]", "index [ns]");
+  for (test = 0; test < sizeof(noUpdates) / sizeof(int); test++)
+  {
+    linear  = _measure(noUpdates[test], false, NO_LINEAR_DELETES);
+    indexed = _measure(noUpdates[test], true, noUpdates[test] / 2);
+    printf ("         %10i %16.0f %16.0f\n", noUpdates[test], linear,
+            indexed);
+  }
+}
+
+/*
+ * Check the indexed list and measure the delete cost.
+ */
+int main(int argc, char** argv)
+{
+  _test1();
+  _test2();
+
+  return (EXIT_SUCCESS);
+}
@@ -0,0 +1,297 @@
+/**
+ * This software was developed at the National Institute of Standards and
+ * Technology by employees of the Federal Government in the course of
+ * their official duties. Pursuant to title 17 Section 105 of the United
+ * States Code this software is not subject to copyright protection and
+ * is in the public domain.
+ *
+ * NIST assumes no responsibility whatsoever for its use by other parties,
+ * and makes no guarantees, expressed or implied, about its quality,
+ * reliability, or any other characteristic.
+ *
+ * We would appreciate acknowledgment if the software is used.
+ *
+ * NIST ALLOWS FREE USE OF THIS SOFTWARE IN ITS "AS IS" CONDITION AND
+ * DISCLAIM ANY LIABILITY OF ANY KIND FOR ANY DAMAGES WHATSOEVER RESULTING
+ * FROM THE USE OF THIS SOFTWARE.
+ *
+ * This software might use libraries that are under GNU public license or
+ * other licenses. Please refer to the licenses of all libraries required
+ * by this software.
+ *
+ *
+ * This files is used for testing and benchmarking the CRC32C based update and
+ * path ID generation against the former CRC32 over a hex string using BGPsec
+ * paths of 2 and 10 hops.
+ *
+ * @version 0.6.2.2
+ *
+ * Changelog:
+ * -----------------------------------------------------------------------------
+ * 0.6.2.2  - 2026/10/17
+ *            * File created
+ */
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <arpa/inet.h>
+#include "shared/crc32.h"
+#include "shared/srx_identifier.h"
+
+/** Number of ID generations per measurement. */
+#define NO_ITERATIONS 200000
+/** Size of the secure path segment (pCount, flags, AS) */
+#define SECURE_PATH_SEGMENT_LEN 6
+/** Size of a signature segment (SKI, length, ECDSA P-256 signature) */
+#define SIGNATURE_SEGMENT_LEN (20 + 2 + 72)
+
+/** The data of one test update. */
+typedef struct {
+  uint32_t   originAS;
+  IPPrefix   prefix;
+  uint32_t*  asPath;
+  uint8_t*   attr;
+  BGPSecData bgpData;
+} TEST_UPDATE;
+
+/**
+ * Check the value against expected, if not match then exit.
+ *
+ * @param val the value to be checked
+ * @param expected the value to be checked against (expected value)
+ * @param error the error string in case of exit
+ */
+static void assert_uint(uint32_t val, uint32_t expected, char* error)
+{
+  if (val != expected)
+  {
+    printf ("Error: %s; Expected 0x%08X but received 0x%08X\n",
+            error, expected, val);
+    exit (EXIT_FAILURE);
+  }
+}
+
+/**
+ * Return the current time in nanoseconds.
+ *
+ * @return the monotonic time in nanoseconds.
+ */
+static uint64_t _now()
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+/**
+ * Create an IPv4 update with a BGPsec path attribute of the given number of
+ * hops. The content of the attribute is random, only the size matters.
+ *
+ * @param update The update to be filled.
+ * @param hops The number of hops.
+ */
+static void _createUpdate(TEST_UPDATE* update, int hops)
+{
+  int      idx;
+  uint16_t attrLen = 4 + 2 + (hops * SECURE_PATH_SEGMENT_LEN)
+                       + 3 + (hops * SIGNATURE_SEGMENT_LEN);
+
+  memset(update, 0, sizeof(TEST_UPDATE));
+  update->originAS = 65000 + hops;
+  update->prefix.ip.version  = 4;
+  update->prefix.ip.addr.v4.u32 = htonl(0x0A000000 + hops);
+  update->prefix.length = 24;
+
+  update->asPath = malloc(hops * 4);
+  for (idx = 0; idx < hops; idx++)
+  {
+    update->asPath[idx] = htonl(65000 + hops - idx);
+  }
+  update->attr = malloc(attrLen);
+  for (idx = 0; idx < attrLen; idx++)
+  {
+    update->attr[idx] = (uint8_t)rand();
+  }
+
+  update->bgpData.numberHops       = hops;
+  update->bgpData.asPath           = update->asPath;
+  update->bgpData.attr_length      = attrLen;
+  update->bgpData.bgpsec_path_attr = update->attr;
+}
+
+/**
+ * Release the memory allocated for the update.
+ *
+ * @param update The update to be released.
+ */
+static void _freeUpdate(TEST_UPDATE* update)
+{
+  free(update->asPath);
+  free(update->attr);
+}
+
+/**
+ * Generate the update ID the way it was done before 0.6.2.2, CRC32 over a hex
+ * string of the data. Used as reference for the benchmark.
+ *
+ * @param update The update to be used.
+ *
+ * @return the ID.
+ */
+static uint32_t _hexUpdateID(TEST_UPDATE* update)
+{
+  uint32_t length = (4 + 4 + 1 + update->bgpData.attr_length) * 2;
+  char     text[length + 1];
+  char*    textPtr = text;
+  int      idx;
+
+  textPtr += sprintf(textPtr, "%08X%08X%02X", update->originAS,
+                     update->prefix.ip.addr.v4.u32, update->prefix.length);
+  for (idx = 0; idx < update->bgpData.attr_length; idx++)
+  {
+    textPtr += sprintf(textPtr, "%02X", update->bgpData.bgpsec_path_attr[idx]);
+  }
+
+  return crc32((uint8_t*)text, length);
+}
+
+/**
+ * Measure the update ID generation.
+ *
+ * @param update The update to be used.
+ * @param useHex Use the hex string reference instead of generateIdentifier.
+ *
+ * @return the time per ID in nanoseconds.
+ */
+static double _benchUpdateID(TEST_UPDATE* update, bool useHex)
+{
+  volatile uint32_t id = 0;
+  uint64_t start = _now();
+  int idx;
+
+  for (idx = 0; idx < NO_ITERATIONS; idx++)
+  {
+    id = useHex ? _hexUpdateID(update)
+                : generateIdentifier(update->originAS, &update->prefix,
+                                     &update->bgpData);
+  }
+  (void)id;
+
+  return (double)(_now() - start) / NO_ITERATIONS;
+}
+
+/**
+ * Measure the path ID generation.
+ *
+ * @param update The update to be used.
+ *
+ * @return the time per ID in nanoseconds.
+ */
+static double _benchPathID(TEST_UPDATE* update)
+{
+  volatile uint32_t id = 0;
+  uint64_t start = _now();
+  int idx;
+
+  for (idx = 0; idx < NO_ITERATIONS; idx++)
+  {
+    id = generatePathIdentifier(update->bgpData.numberHops, update->asPath,
+                                2, true);
+  }
+  (void)id;
+
+  return (double)(_now() - start) / NO_ITERATIONS;
+}
+
+/**
+ * Check the CRC32C values against the known test vector and check that the
+ * IDs do not depend on the byte order of the AS path.
+ */
+static void _test1()
+{
+  printf ("Test #1: Check CRC32C (%s)\n", crc32cHardware() ? "SSE4.2"
+                                                            : "table");
+  uint8_t* check = (uint8_t*)"123456789";
+  assert_uint(crc32c(0, check, 9), 0xE3069283, "CRC32C check value");
+  assert_uint(crc32c(crc32c(0, check, 4), check + 4, 5), 0xE3069283,
+              "CRC32C in two blocks");
+
+  uint32_t netPath[3]  = { htonl(65001), htonl(65002), htonl(65003) };
+  uint32_t hostPath[3] = { 65001, 65002, 65003 };
+  assert_uint(generatePathIdentifier(3, hostPath, 2, false),
+              generatePathIdentifier(3, netPath, 2, true),
+              "Path ID of host and network order");
+  printf ("         passed.\n");
+}
+
+/**
+ * Check the update ID of a BGPsec path attribute containing bytes >= 0x80
+ * against the CRC32C of the binary data.
+ */
+static void _test2()
+{
+  printf ("Test #2: Check update ID of bytes >= 0x80\n");
+  TEST_UPDATE update;
+  uint8_t     data[4 + 4 + 1 + 256];
+  uint32_t    asn;
+  int         idx;
+
+  _createUpdate(&update, 1);
+  asn = htonl(update.originAS);
+  memcpy(data, &asn, 4);
+  memcpy(data + 4, &update.prefix.ip.addr.v4.u32, 4);
+  data[8] = update.prefix.length;
+  for (idx = 0; idx < 256; idx++)
+  {
+    data[9 + idx] = (uint8_t)(0xFF - idx);
+  }
+  update.bgpData.attr_length      = 256;
+  update.bgpData.bgpsec_path_attr = data + 9;
+
+  assert_uint(generateIdentifier(update.originAS, &update.prefix,
+                                 &update.bgpData),
+              crc32c(0, data, sizeof(data)), "CRC32C update ID");
+
+  _freeUpdate(&update);
+  printf ("         passed.\n");
+}
+
+/**
+ * Benchmark the ID generation for the given number of hops.
+ *
+ * @param test The number of the test.
+ * @param hops The number of hops of the BGPsec path.
+ */
+static void _benchmark(int test, int hops)
+{
+  TEST_UPDATE update;
+  double      hexTime, binTime;
+
+  _createUpdate(&update, hops);
+  printf ("Test #%i: %i hop BGPsec path (%u bytes), %i iterations\n",
+          test, hops, update.bgpData.attr_length, NO_ITERATIONS);
+
+  hexTime = _benchUpdateID(&update, true);
+  binTime = _benchUpdateID(&update, false);
+  printf ("         update ID: hex CRC32 %8.1f ns, CRC32C %8.1f ns, "
+          "speedup %6.1fx\n", hexTime, binTime, hexTime / binTime);
+  printf ("         path ID  : CRC32C %8.1f ns\n", _benchPathID(&update));
+
+  _freeUpdate(&update);
+}
+
+/*
+ * Test and benchmark the update identifier generation.
+ */
+int main(int argc, char** argv)
+{
+  srand(1);
+  _test1();
+  _test2();
+  _benchmark(3, 2);
+  _benchmark(4, 10);
+
+  return (EXIT_SUCCESS);
+}
@@ -19,10 +19,18 @@
  * to set the log method at the beginning of the application - otherwise
  * eventual message will be discarded.
  *
- * @version 0.5.0.0
+ * @version 0.6.2.2
  *
  * Changelog:
  * -----------------------------------------------------------------------------
+ * 0.6.2.2 - 2026/10/17
+ *           * Added the log writer thread and the per thread message rings.
+ *             The writer is only woken up if it waits for messages, it
+ *             writes all available messages before it flushes the stream.
+ *             Longer messages are spilled into heap memory.
+ *           * The timestamp buffer is kept per thread and only formatted
+ *             when the second changed.
+ *           * The active level is available to the macros as g_logLevel.
  * 0.5.0.0 - 2017/07/03 - oborchert
  *           * Added missing debug level text
  *           * Fixed issue in _writeToFile where levels are passed that are 
@@ -38,6 +46,10 @@
  *           * Code Created
  * -----------------------------------------------------------------------------
  */
+#include <pthread.h>
+#include <sched.h>
+#include <stdint.h>
+#include <stdlib.h>
 #include <time.h>
 #include <syslog.h>
 #include "util/log.h"
@@ -49,6 +61,11 @@
 #define TIMESTAMP_MAX_LEN 18
 #define TIMESTAMP_FORMAT  "%D %I:%M.%S"
 
+/** Number of messages in the ring of each thread (power of 2) */
+#define LOG_RING_SIZE      256
+/** Length of a message stored within the ring, longer ones are spilled */
+#define LOG_MSG_MAX_LEN    512
+
 static const char* LOG_LEVEL_TEXT[] = {
      "EMERGENCY",
      "CRITICAL",
@@ -61,14 +78,74 @@ static const char* LOG_LEVEL_TEXT[] = {
      "   COMM"  // 8:LEVEL_COMM
 };
 
+/*------
+ * Types
+ */
+
+/** A message in the ring of a thread. */
+typedef struct {
+  /** Orders the messages of all threads */
+  uint64_t seq;
+  LogLevel level;
+  /** A message that does not fit into msg or NULL, freed by the writer */
+  char*    spill;
+  char     msg[LOG_MSG_MAX_LEN];
+} LogRingMessage;
+
+/**
+ * The messages of one thread. The owning thread writes at head, the writer
+ * thread reads at tail. Rings are claimed by threads and released once the
+ * thread ends, they are never freed.
+ */
+typedef struct _LogRing {
+  LogRingMessage   messages[LOG_RING_SIZE];
+  /** Next message written by the owner */
+  uint32_t         head;
+  /** Next message read by the writer thread */
+  uint32_t         tail;
+  /** The owner writes into the ring */
+  bool             busy;
+  /** The ring is claimed by a thread */
+  bool             inUse;
+  /** The next ring of all rings */
+  struct _LogRing* next;
+} LogRing;
+
 /*-----------------
  * Global variables
  */
 
-static LogLevel _activeLevel = LEVEL_DEBUG;
-static char _tsBuf[TIMESTAMP_MAX_LEN];
+LogLevel g_logLevel = LEVEL_DEBUG;
+static __thread char   _tsBuf[TIMESTAMP_MAX_LEN];
+static __thread time_t _tsTime = 0;
 static LogMessagePosted _callback = NULL;
 
+/*------------------------
+ * Log writer variables
+ */
+
+/** All rings, new rings are added at the front */
+static LogRing*        _rings = NULL;
+/** The ring of the calling thread */
+static __thread LogRing* _threadRing = NULL;
+/** Releases the ring once the thread ends */
+static pthread_key_t   _ringKey;
+static pthread_once_t  _ringKeyOnce = PTHREAD_ONCE_INIT;
+/** Sequence number of the next message */
+static uint64_t        _logSeq = 0;
+/** Messages are passed through the rings */
+static bool            _writerRunning = false;
+static pthread_t       _writerThread;
+/** Wakes up the writer thread if it waits for messages */
+static pthread_mutex_t _writerMutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t  _writerCond = PTHREAD_COND_INITIALIZER;
+/** The writer thread waits for messages */
+static bool            _writerWaiting = false;
+/** The writer thread itself writes directly */
+static __thread bool   _isWriter = false;
+/** stopLogWriter is registered to run at exit */
+static bool            _stopAtExit = false;
+
 /*--------------------
  * "_write*" variables
  */
@@ -156,7 +233,7 @@ void setLogMethodToCallback (LogMessagePosted cb)
  */
 void setLogLevel (LogLevel level)
 {
-  _activeLevel = level;
+  g_logLevel = level;
 }
 
 /**
@@ -168,9 +245,12 @@ void setLogLevel (LogLevel level)
  */
 LogLevel getLogLevel()
 {
-  return _activeLevel;
+  return g_logLevel;
 }
 
+// Forward declaration
+static bool _writeToRing (LogLevel level, const char* fmt, va_list args);
+
 /*
  * Write a log entry if the given log level is activated.
  *
@@ -180,12 +260,16 @@ LogLevel getLogLevel()
  */
 void writeLog (LogLevel level, const char* fmt, ...)
 {
-  if ((_callback != NULL) && (level <= _activeLevel))
+  if ((_callback != NULL) && (level <= g_logLevel))
   {
     va_list al;
 
     va_start(al, fmt);
-    _callback(level, fmt, al);
+    if (!__atomic_load_n(&_writerRunning, __ATOMIC_ACQUIRE) || _isWriter
+        || !_writeToRing(level, fmt, al))
+    {
+      _callback(level, fmt, al);
+    }
     va_end(al);
   }
 }
@@ -199,7 +283,363 @@ const char* logTimeStamp ()
 {
   time_t now = time(NULL);
   struct tm ret_tm;
-  strftime(_tsBuf, TIMESTAMP_MAX_LEN, TIMESTAMP_FORMAT, localtime_r(&now, &ret_tm)); //--> error in quagga, due to localtime  *change into localtime_r() --KH--
+
+  // Only format the timestamp once a second
+  if (now != _tsTime)
+  {
+    strftime(_tsBuf, TIMESTAMP_MAX_LEN, TIMESTAMP_FORMAT, localtime_r(&now, &ret_tm)); //--> error in quagga, due to localtime  *change into localtime_r() --KH--
+    _tsTime = now;
+  }
   return (const char*) _tsBuf;
 }
 
+/**
+ * Pass a message of a ring to the log method.
+ *
+ * @param level The level of the message
+ * @param fmt Format string
+ * @param ... Format elements.
+ */
+static void _postMessage (LogLevel level, const char* fmt, ...)
+{
+  LogMessagePosted callback = _callback;
+  va_list al;
+
+  if (callback != NULL)
+  {
+    va_start(al, fmt);
+    callback(level, fmt, al);
+    va_end(al);
+  }
+}
+
+/**
+ * Determine if any ring contains a message.
+ *
+ * @return true if a message is available.
+ */
+static bool _hasMessages ()
+{
+  LogRing* ring;
+
+  for (ring = __atomic_load_n(&_rings, __ATOMIC_ACQUIRE); ring != NULL; 
+       ring = ring->next)
+  {
+    if (__atomic_load_n(&ring->head, __ATOMIC_ACQUIRE) != ring->tail)
+    {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+/**
+ * Wake up the writer thread if it waits for messages. Only the first thread
+ * that finds the writer waiting locks the mutex.
+ */
+static void _wakeWriter ()
+{
+  // Pairs with the fence of the writer, see _logWriter.
+  __atomic_thread_fence(__ATOMIC_SEQ_CST);
+  if (__atomic_load_n(&_writerWaiting, __ATOMIC_RELAXED)
+      && __atomic_exchange_n(&_writerWaiting, false, __ATOMIC_ACQ_REL))
+  {
+    pthread_mutex_lock(&_writerMutex);
+    pthread_cond_signal(&_writerCond);
+    pthread_mutex_unlock(&_writerMutex);
+  }
+}
+
+/**
+ * Write all messages of the rings in the order of their sequence numbers.
+ * Messages to a stream are flushed once all available messages are written.
+ *
+ * @return The number of messages written.
+ */
+static uint32_t _drainRings ()
+{
+  LogRing*        ring;
+  LogRing*        next;
+  LogRingMessage* msg;
+  FILE*           stream  = (_callback == _writeToFile) ? _stream : NULL;
+  const char*     text;
+  uint32_t        written = 0;
+
+  while (true)
+  {
+    // Find the oldest message of all rings
+    next = NULL;
+    for (ring = __atomic_load_n(&_rings, __ATOMIC_ACQUIRE); ring != NULL; 
+         ring = ring->next)
+    {
+      if ((__atomic_load_n(&ring->head, __ATOMIC_ACQUIRE) != ring->tail)
+          && ((next == NULL) 
+              || (ring->messages[ring->tail % LOG_RING_SIZE].seq 
+                  < next->messages[next->tail % LOG_RING_SIZE].seq)))
+      {
+        next = ring;
+      }
+    }
+    if (next == NULL)
+    {
+      break;
+    }
+
+    msg  = &next->messages[next->tail % LOG_RING_SIZE];
+    text = (msg->spill != NULL) ? msg->spill : msg->msg;
+    if (stream != NULL)
+    {
+      // Same format as _writeToFile
+      fprintf(stream, "%s %s\n", LOG_LEVEL_TEXT[msg->level], text);
+    }
+    else
+    {
+      _postMessage(msg->level, "%s", text);
+    }
+    free(msg->spill);
+    msg->spill = NULL;
+    __atomic_store_n(&next->tail, next->tail + 1, __ATOMIC_RELEASE);
+    written++;
+  }
+
+  if ((stream != NULL) && (written > 0))
+  {
+    fflush(stream);
+  }
+
+  return written;
+}
+
+/**
+ * The log writer thread.
+ *
+ * @param arg Not used
+ *
+ * @return NULL
+ */
+static void* _logWriter (void* arg)
+{
+  _isWriter = true;
+
+  while (__atomic_load_n(&_writerRunning, __ATOMIC_ACQUIRE))
+  {
+    if (_drainRings() == 0)
+    {
+      pthread_mutex_lock(&_writerMutex);
+      // Announce the wait before the rings are checked again, a thread that
+      // adds a message afterwards finds the writer waiting, see _wakeWriter.
+      __atomic_store_n(&_writerWaiting, true, __ATOMIC_RELAXED);
+      __atomic_thread_fence(__ATOMIC_SEQ_CST);
+      if (__atomic_load_n(&_writerRunning, __ATOMIC_ACQUIRE) 
+          && !_hasMessages())
+      {
+        pthread_cond_wait(&_writerCond, &_writerMutex);
+      }
+      __atomic_store_n(&_writerWaiting, false, __ATOMIC_RELAXED);
+      pthread_mutex_unlock(&_writerMutex);
+    }
+  }
+
+  return NULL;
+}
+
+/**
+ * Release the ring of a thread once the thread ends. The writer thread still
+ * writes the remaining messages.
+ *
+ * @param ring The ring of the thread
+ */
+static void _releaseRing (void* ring)
+{
+  __atomic_store_n(&((LogRing*)ring)->inUse, false, __ATOMIC_RELEASE);
+}
+
+/**
+ * Create the key used to release the rings.
+ */
+static void _createRingKey ()
+{
+  pthread_key_create(&_ringKey, _releaseRing);
+}
+
+/**
+ * Return the ring of the calling thread. A released ring is claimed, a new
+ * ring is created if none is available.
+ *
+ * @return The ring or NULL if no memory is available
+ */
+static LogRing* _getThreadRing ()
+{
+  LogRing* ring = _threadRing;
+  bool     unused;
+
+  if (ring != NULL)
+  {
+    return ring;
+  }
+
+  pthread_once(&_ringKeyOnce, _createRingKey);
+  for (ring = __atomic_load_n(&_rings, __ATOMIC_ACQUIRE); ring != NULL; 
+       ring = ring->next)
+  {
+    unused = false;
+    if (__atomic_compare_exchange_n(&ring->inUse, &unused, true, false, 
+                                    __ATOMIC_ACQ_REL, __ATOMIC_RELAXED))
+    {
+      break;
+    }
+  }
+
+  if (ring == NULL)
+  {
+    ring = calloc(1, sizeof(LogRing));
+    if (ring == NULL)
+    {
+      return NULL;
+    }
+    ring->inUse = true;
+    ring->next  = __atomic_load_n(&_rings, __ATOMIC_RELAXED);
+    while (!__atomic_compare_exchange_n(&_rings, &ring->next, ring, false,
+                                        __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+  }
+
+  pthread_setspecific(_ringKey, ring);
+  _threadRing = ring;
+  return ring;
+}
+
+/**
+ * Format the message into the ring of the calling thread. Waits while the 
+ * ring is full. A message that does not fit into the ring is spilled into 
+ * heap memory.
+ *
+ * @param level The level of the message
+ * @param fmt Format string
+ * @param args Arguments
+ *
+ * @return false if the message has to be written directly
+ */
+static bool _writeToRing (LogLevel level, const char* fmt, va_list args)
+{
+  LogRing*        ring = _getThreadRing();
+  LogRingMessage* msg;
+  va_list         copy;
+  int             len;
+
+  if (ring == NULL)
+  {
+    return false;
+  }
+
+  // The writer waits for busy rings before it stops.
+  __atomic_store_n(&ring->busy, true, __ATOMIC_SEQ_CST);
+  if (!__atomic_load_n(&_writerRunning, __ATOMIC_SEQ_CST))
+  {
+    __atomic_store_n(&ring->busy, false, __ATOMIC_RELEASE);
+    return false;
+  }
+
+  if ((ring->head - __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE)) 
+      == LOG_RING_SIZE)
+  {
+    while ((ring->head - __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE)) 
+           == LOG_RING_SIZE)
+    {
+      if (!__atomic_load_n(&_writerRunning, __ATOMIC_SEQ_CST))
+      {
+        // The writer stopped, the message has to be written directly.
+        __atomic_store_n(&ring->busy, false, __ATOMIC_RELEASE);
+        return false;
+      }
+      sched_yield();
+    }
+  }
+
+  msg = &ring->messages[ring->head % LOG_RING_SIZE];
+  msg->level = level;
+  va_copy(copy, args);
+  len = vsnprintf(msg->msg, LOG_MSG_MAX_LEN, fmt, copy);
+  va_end(copy);
+  if (len >= LOG_MSG_MAX_LEN)
+  {
+    // Keep the truncated message if no memory is available.
+    msg->spill = malloc(len + 1);
+    if (msg->spill != NULL)
+    {
+      va_copy(copy, args);
+      vsnprintf(msg->spill, len + 1, fmt, copy);
+      va_end(copy);
+    }
+  }
+  msg->seq = __atomic_fetch_add(&_logSeq, 1, __ATOMIC_RELAXED);
+
+  __atomic_store_n(&ring->head, ring->head + 1, __ATOMIC_RELEASE);
+  __atomic_store_n(&ring->busy, false, __ATOMIC_RELEASE);
+  _wakeWriter();
+
+  return true;
+}
+
+/**
+ * Starts the log writer thread.
+ *
+ * @return true if the writer thread is running
+ *
+ * @since 0.6.2.2
+ */
+bool startLogWriter ()
+{
+  if (__atomic_load_n(&_writerRunning, __ATOMIC_ACQUIRE))
+  {
+    return true;
+  }
+
+  __atomic_store_n(&_writerRunning, true, __ATOMIC_SEQ_CST);
+  if (pthread_create(&_writerThread, NULL, _logWriter, NULL) != 0)
+  {
+    __atomic_store_n(&_writerRunning, false, __ATOMIC_SEQ_CST);
+    return false;
+  }
+
+  // Write the pending messages if the program exits without stopping.
+  if (!_stopAtExit)
+  {
+    _stopAtExit = atexit(stopLogWriter) == 0;
+  }
+
+  return true;
+}
+
+/**
+ * Stops the log writer thread once all messages are written.
+ *
+ * @since 0.6.2.2
+ */
+void stopLogWriter ()
+{
+  LogRing* ring;
+
+  if (!__atomic_load_n(&_writerRunning, __ATOMIC_ACQUIRE))
+  {
+    return;
+  }
+
+  __atomic_store_n(&_writerRunning, false, __ATOMIC_SEQ_CST);
+  pthread_mutex_lock(&_writerMutex);
+  pthread_cond_signal(&_writerCond);
+  pthread_mutex_unlock(&_writerMutex);
+  pthread_join(_writerThread, NULL);
+
+  // Wait for threads that write into their ring right now.
+  for (ring = __atomic_load_n(&_rings, __ATOMIC_ACQUIRE); ring != NULL; 
+       ring = ring->next)
+  {
+    while (__atomic_load_n(&ring->busy, __ATOMIC_SEQ_CST))
+    {
+      sched_yield();
+    }
+  }
+  _drainRings();
+}
+
@@ -18,11 +18,21 @@
  * This file contains functions and macros for logging output. It is recommended 
  * to set the log method at the beginning of the application - otherwise 
  * eventual message will be discarded.
+ *
+ * The macros check the log level before their arguments are evaluated. Once
+ * the log writer is started (see startLogWriter) the messages are formatted
+ * into a ring of the calling thread and passed to the log method by the 
+ * writer thread.
  *  
- * @version 0.5.0.0
+ * @version 0.6.2.2
  *
  * Changelog:
  * -----------------------------------------------------------------------------
+ * 0.6.2.2  - 2026/10/17
+ *            * The macros check the log level before evaluating their 
+ *              arguments.
+ *            * Added startLogWriter and stopLogWriter.
+ *            * The timestamp is kept per thread and formatted once a second.
  * 0.5.0.0  - 2017/07/03 - oborchert
  *            * Added some documentation
  * 0.3.0.10 - 2015/11/09 - oborchert
@@ -44,6 +54,7 @@
 #include <stdio.h>
 #include <string.h>
 #include <stdarg.h>
+#include <stdbool.h>
 #include <errno.h>
 
 /** 
@@ -73,6 +84,11 @@ typedef enum {
   LEVEL_COMM    = 8
 } LogLevel;
 
+/** 
+ * The active log level, read by the macros. Use setLogLevel and getLogLevel.
+ */
+extern LogLevel g_logLevel;
+
 /** 
  * Function that is called when a log message has been received.
  *
@@ -154,7 +170,8 @@ extern LogLevel getLogLevel();
 extern void writeLog(LogLevel level, const char* fmt, ...);
 
 /**
- * Returns the current date and time as a string.
+ * Returns the current date and time as a string. The string is kept per 
+ * thread and formatted once a second.
  *
  * @note Primarily for internal use
  *
@@ -162,13 +179,41 @@ extern void writeLog(LogLevel level, const char* fmt, ...);
  */
 extern const char* logTimeStamp();
 
+/**
+ * Starts the log writer thread. Messages are formatted into a ring of the
+ * calling thread and passed to the log method by the writer thread. A thread
+ * waits if its ring is full. Messages longer than 511 characters are copied 
+ * into heap memory. The log method MUST be set before.
+ *
+ * @return \c true if the writer thread is running
+ *
+ * @since 0.6.2.2
+ */
+extern bool startLogWriter();
+
+/**
+ * Stops the log writer thread once all messages are written. Messages are
+ * passed to the log method directly afterwards.
+ *
+ * @since 0.6.2.2
+ */
+extern void stopLogWriter();
+
 /*-------
  * Macros
  */
 
-/** See writeLog. */
+/** Evaluates to true if messages of the given level are written. */
+#define IS_LOG_LEVEL(LEVEL) ((LEVEL) <= g_logLevel)
+
+/** See writeLog. The arguments are only evaluated if the level is active. */
 #define LOG(LEVEL, FMT, ...) \
-  writeLog(LEVEL, "[%s] " FMT, logTimeStamp(), ## __VA_ARGS__)
+  do { \
+    if (IS_LOG_LEVEL(LEVEL)) \
+    { \
+      writeLog(LEVEL, "[%s] " FMT, logTimeStamp(), ## __VA_ARGS__); \
+    } \
+  } while (0)
 
 #define STRINGIFY_ARG(ARG) #ARG
 #define STRINGIFY_IND(ARG) STRINGIFY_ARG(ARG)
@@ -180,8 +225,13 @@ extern const char* logTimeStamp();
 
 /** Raises an error - simply a writeLog(LEVEL_ERROR, ...) shortcut */
 #define RAISE_ERROR(FMT, ...) \
-  writeLog(LEVEL_ERROR, ERROR_LEAD FMT, logTimeStamp(), \
-           __func__,  ## __VA_ARGS__)
+  do { \
+    if (IS_LOG_LEVEL(LEVEL_ERROR)) \
+    { \
+      writeLog(LEVEL_ERROR, ERROR_LEAD FMT, logTimeStamp(), \
+               __func__,  ## __VA_ARGS__); \
+    } \
+  } while (0)
 
 /**
  * Raises a system error. It uses errnum to determine the exact, detailed 
@@ -193,8 +243,13 @@ extern const char* logTimeStamp();
  * @see raiseError
  */
 #define RAISE_SYS_ERROR(FMT, ...) \
-  writeLog(LEVEL_ERROR, ERROR_LEAD FMT " - %s", logTimeStamp(), \
-           __func__, ## __VA_ARGS__, strerror(errno))
+  do { \
+    if (IS_LOG_LEVEL(LEVEL_ERROR)) \
+    { \
+      writeLog(LEVEL_ERROR, ERROR_LEAD FMT " - %s", logTimeStamp(), \
+               __func__, ## __VA_ARGS__, strerror(errno)); \
+    } \
+  } while (0)
 
 #endif // !__LOG_H__
 
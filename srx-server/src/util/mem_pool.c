@@ -0,0 +1,514 @@
+/**
+ * This software was developed at the National Institute of Standards and
+ * Technology by employees of the Federal Government in the course of
+ * their official duties. Pursuant to title 17 Section 105 of the United
+ * States Code this software is not subject to copyright protection and
+ * is in the public domain.
+ *
+ * NIST assumes no responsibility whatsoever for its use by other parties,
+ * and makes no guarantees, expressed or implied, about its quality,
+ * reliability, or any other characteristic.
+ *
+ * We would appreciate acknowledgment if the software is used.
+ *
+ * NIST ALLOWS FREE USE OF THIS SOFTWARE IN ITS "AS IS" CONDITION AND
+ * DISCLAIM ANY LIABILITY OF ANY KIND FOR ANY DAMAGES WHATSOEVER RESULTING
+ * FROM THE USE OF THIS SOFTWARE.
+ *
+ * This software might use libraries that are under GNU public license or
+ * other licenses. Please refer to the licenses of all libraries required
+ * by this software.
+ *
+ * Memory pool for objects of one fixed size.
+ *
+ * @version 0.6.2.2
+ *
+ * Changelog:
+ * -----------------------------------------------------------------------------
+ * 0.6.2.2  - 2026/10/17
+ *            * Code created.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "util/mem_pool.h"
+#include "util/log.h"
+
+/** Number of objects moved between a thread cache and the pool at once. */
+#define MEM_POOL_CACHE_BATCH 32
+/** Maximum number of free objects kept in a thread cache. */
+#define MEM_POOL_CACHE_MAX   (MEM_POOL_CACHE_BATCH * 2)
+/** The alignment of all objects. */
+#define MEM_POOL_ALIGN       sizeof(void*)
+
+/**
+ * A free object. The link to the next free object is stored in the object
+ * itself.
+ */
+typedef struct _MemPoolObject {
+  struct _MemPoolObject* next;
+} MemPoolObject;
+
+/**
+ * The header of a slab. The objects follow the header.
+ */
+typedef union _MemPoolSlab {
+  union _MemPoolSlab* next;
+  /** Keeps the first object aligned */
+  long double         align;
+} MemPoolSlab;
+
+/**
+ * The free objects of one thread.
+ */
+typedef struct _MemPoolCache {
+  struct _MemPoolCache* next;
+  struct _MemPoolCache* prev;
+  MemPool*              pool;
+  MemPoolObject*        free;
+  uint32_t              count;
+  uint64_t              allocs;
+  uint64_t              frees;
+} MemPoolCache;
+
+/**
+ * The memory pool.
+ */
+struct _MemPool {
+  char             name[MEM_POOL_NAME_LEN];
+  size_t           objectSize;
+  uint32_t         objectsPerSlab;
+  /** Guards the free list, the slabs, the caches, and the counters. */
+  pthread_mutex_t  mutex;
+  pthread_key_t    cacheKey;
+  MemPoolObject*   free;
+  uint32_t         noFree;
+  MemPoolSlab*     slabs;
+  uint32_t         noSlabs;
+  MemPoolCache*    caches;
+  /** allocations and releases not counted in a current thread cache */
+  uint64_t         allocs;
+  uint64_t         frees;
+  /** The next registered pool. */
+  struct _MemPool* next;
+};
+
+/** All registered memory pools. */
+static MemPool*        _memPools     = NULL;
+static pthread_mutex_t _memPoolsLock = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * Allocate a new slab and add its objects to the free list of the pool. The
+ * caller MUST hold the mutex of the pool.
+ *
+ * @param self The memory pool
+ *
+ * @return true if the slab could be allocated.
+ */
+static bool _addSlab(MemPool* self)
+{
+  MemPoolSlab*   slab = malloc(sizeof(MemPoolSlab)
+                               + (self->objectsPerSlab * self->objectSize));
+  MemPoolObject* obj  = NULL;
+  uint8_t*       data = NULL;
+  uint32_t       idx;
+
+  if (slab == NULL)
+  {
+    RAISE_SYS_ERROR("Could not allocate a new slab for memory pool '%s'",
+                    self->name);
+    return false;
+  }
+  slab->next  = self->slabs;
+  self->slabs = slab;
+  self->noSlabs++;
+
+  data = (uint8_t*)(slab + 1);
+  for (idx = self->objectsPerSlab; idx > 0; idx--)
+  {
+    obj       = (MemPoolObject*)(data + ((idx - 1) * self->objectSize));
+    obj->next = self->free;
+    self->free = obj;
+  }
+  self->noFree += self->objectsPerSlab;
+
+  return true;
+}
+
+/**
+ * Move up to the given number of objects from the free list of the pool into
+ * the thread cache. The caller MUST hold the mutex of the pool.
+ *
+ * @param self The memory pool
+ * @param cache The thread cache
+ * @param count The number of objects to be moved.
+ */
+static void _fillCache(MemPool* self, MemPoolCache* cache, uint32_t count)
+{
+  MemPoolObject* obj;
+
+  while ((count > 0) && ((self->free != NULL) || _addSlab(self)))
+  {
+    obj         = self->free;
+    self->free  = obj->next;
+    self->noFree--;
+    obj->next   = cache->free;
+    cache->free = obj;
+    cache->count++;
+    count--;
+  }
+}
+
+/**
+ * Move up to the given number of objects from the thread cache into the free
+ * list of the pool. The caller MUST hold the mutex of the pool.
+ *
+ * @param self The memory pool
+ * @param cache The thread cache
+ * @param count The number of objects to be moved.
+ */
+static void _flushCache(MemPool* self, MemPoolCache* cache, uint32_t count)
+{
+  MemPoolObject* obj;
+
+  while ((count > 0) && (cache->free != NULL))
+  {
+    obj         = cache->free;
+    cache->free = obj->next;
+    cache->count--;
+    obj->next   = self->free;
+    self->free  = obj;
+    self->noFree++;
+    count--;
+  }
+}
+
+/**
+ * Called when a thread ends. Returns all objects of the thread cache into the
+ * pool.
+ *
+ * @param data The thread cache
+ */
+static void _releaseCache(void* data)
+{
+  MemPoolCache* cache = (MemPoolCache*)data;
+  MemPool*      self  = cache->pool;
+
+  pthread_mutex_lock(&self->mutex);
+  _flushCache(self, cache, cache->count);
+  self->allocs += cache->allocs;
+  self->frees  += cache->frees;
+  if (cache->prev != NULL)
+  {
+    cache->prev->next = cache->next;
+  }
+  else
+  {
+    self->caches = cache->next;
+  }
+  if (cache->next != NULL)
+  {
+    cache->next->prev = cache->prev;
+  }
+  pthread_mutex_unlock(&self->mutex);
+
+  free(cache);
+}
+
+/**
+ * Return the cache of the calling thread. The cache is created if needed.
+ *
+ * @param self The memory pool
+ *
+ * @return The thread cache or NULL if it could not be created.
+ */
+static MemPoolCache* _getCache(MemPool* self)
+{
+  MemPoolCache* cache = (MemPoolCache*)pthread_getspecific(self->cacheKey);
+
+  if (cache == NULL)
+  {
+    cache = calloc(1, sizeof(MemPoolCache));
+    if (cache != NULL)
+    {
+      cache->pool = self;
+      if (pthread_setspecific(self->cacheKey, cache) != 0)
+      {
+        free(cache);
+        return NULL;
+      }
+      pthread_mutex_lock(&self->mutex);
+      cache->next = self->caches;
+      if (self->caches != NULL)
+      {
+        self->caches->prev = cache;
+      }
+      self->caches = cache;
+      pthread_mutex_unlock(&self->mutex);
+    }
+  }
+
+  return cache;
+}
+
+/**
+ * Create a new memory pool and register it with the given name.
+ *
+ * @param name The name of the pool used for statistics.
+ * @param objectSize The size of each object in bytes.
+ * @param objectsPerSlab The number of objects allocated at once. If 0 the
+ *                       value MEM_POOL_DEF_SLAB_OBJECTS will be used.
+ *
+ * @return The memory pool or NULL if the pool could not be created.
+ */
+MemPool* createMemPool(const char* name, size_t objectSize,
+                       uint32_t objectsPerSlab)
+{
+  MemPool* self = calloc(1, sizeof(MemPool));
+
+  if (self == NULL)
+  {
+    RAISE_SYS_ERROR("Could not allocate memory pool '%s'", name);
+    return NULL;
+  }
+
+  if (objectSize < sizeof(MemPoolObject))
+  {
+    objectSize = sizeof(MemPoolObject);
+  }
+  self->objectSize     = (objectSize + MEM_POOL_ALIGN - 1)
+                         & ~(MEM_POOL_ALIGN - 1);
+  self->objectsPerSlab = objectsPerSlab > 0 ? objectsPerSlab
+                                            : MEM_POOL_DEF_SLAB_OBJECTS;
+  snprintf(self->name, MEM_POOL_NAME_LEN, "%s", name);
+
+  if (pthread_mutex_init(&self->mutex, NULL) != 0)
+  {
+    RAISE_SYS_ERROR("Could not initialize the mutex of memory pool '%s'", name);
+    free(self);
+    return NULL;
+  }
+  if (pthread_key_create(&self->cacheKey, _releaseCache) != 0)
+  {
+    RAISE_SYS_ERROR("Could not create the thread cache of memory pool '%s'",
+                    name);
+    pthread_mutex_destroy(&self->mutex);
+    free(self);
+    return NULL;
+  }
+
+  pthread_mutex_lock(&_memPoolsLock);
+  self->next = _memPools;
+  _memPools  = self;
+  pthread_mutex_unlock(&_memPoolsLock);
+
+  return self;
+}
+
+/**
+ * Release the memory pool including all slabs. All objects of this pool are
+ * invalid afterwards. The pool MUST NOT be used by any other thread anymore.
+ *
+ * @param self The memory pool (can be NULL)
+ */
+void releaseMemPool(MemPool* self)
+{
+  MemPool**     pool;
+  MemPoolCache* cache;
+  MemPoolSlab*  slab;
+
+  if (self == NULL)
+  {
+    return;
+  }
+
+  pthread_mutex_lock(&_memPoolsLock);
+  for (pool = &_memPools; *pool != NULL; pool = &(*pool)->next)
+  {
+    if (*pool == self)
+    {
+      *pool = self->next;
+      break;
+    }
+  }
+  pthread_mutex_unlock(&_memPoolsLock);
+
+  // No cache destructor will be called after the key is deleted.
+  pthread_key_delete(self->cacheKey);
+  pthread_mutex_lock(&self->mutex);
+  while (self->caches != NULL)
+  {
+    cache        = self->caches;
+    self->caches = cache->next;
+    free(cache);
+  }
+  while (self->slabs != NULL)
+  {
+    slab        = self->slabs;
+    self->slabs = slab->next;
+    free(slab);
+  }
+  pthread_mutex_unlock(&self->mutex);
+  pthread_mutex_destroy(&self->mutex);
+  free(self);
+}
+
+/**
+ * Return an object of the memory pool. The memory is NOT initialized.
+ *
+ * @param self The memory pool
+ *
+ * @return The object or NULL if no memory is available.
+ */
+void* allocFromMemPool(MemPool* self)
+{
+  MemPoolCache*  cache = _getCache(self);
+  MemPoolObject* obj   = NULL;
+
+  if (cache != NULL)
+  {
+    if (cache->free == NULL)
+    {
+      pthread_mutex_lock(&self->mutex);
+      _fillCache(self, cache, MEM_POOL_CACHE_BATCH);
+      pthread_mutex_unlock(&self->mutex);
+    }
+    obj = cache->free;
+    if (obj != NULL)
+    {
+      cache->free = obj->next;
+      cache->count--;
+      cache->allocs++;
+    }
+  }
+  else
+  {
+    pthread_mutex_lock(&self->mutex);
+    if ((self->free != NULL) || _addSlab(self))
+    {
+      obj        = self->free;
+      self->free = obj->next;
+      self->noFree--;
+      self->allocs++;
+    }
+    pthread_mutex_unlock(&self->mutex);
+  }
+
+  return obj;
+}
+
+/**
+ * Return the object into the memory pool. The object MUST have been allocated
+ * from the same memory pool.
+ *
+ * @param self The memory pool
+ * @param object The object to be returned (can be NULL).
+ */
+void freeToMemPool(MemPool* self, void* object)
+{
+  MemPoolCache*  cache = NULL;
+  MemPoolObject* obj   = (MemPoolObject*)object;
+
+  if (obj == NULL)
+  {
+    return;
+  }
+
+  cache = _getCache(self);
+  if (cache != NULL)
+  {
+    obj->next   = cache->free;
+    cache->free = obj;
+    cache->count++;
+    cache->frees++;
+    if (cache->count >= MEM_POOL_CACHE_MAX)
+    {
+      pthread_mutex_lock(&self->mutex);
+      _flushCache(self, cache, MEM_POOL_CACHE_BATCH);
+      pthread_mutex_unlock(&self->mutex);
+    }
+  }
+  else
+  {
+    pthread_mutex_lock(&self->mutex);
+    obj->next  = self->free;
+    self->free = obj;
+    self->noFree++;
+    self->frees++;
+    pthread_mutex_unlock(&self->mutex);
+  }
+}
+
+/**
+ * Return the size of the objects provided by the memory pool. This might be
+ * larger than the requested size due to alignment.
+ *
+ * @param self The memory pool
+ *
+ * @return The size of each object in bytes.
+ */
+size_t getMemPoolObjectSize(MemPool* self)
+{
+  return self->objectSize;
+}
+
+/**
+ * Fill the statistics of the given memory pool. The values are for display
+ * purpose and not synchronized with the per thread caches.
+ *
+ * @param self The memory pool
+ * @param stats The statistics to be filled.
+ */
+void getMemPoolStatistics(MemPool* self, MemPoolStatistics* stats)
+{
+  MemPoolCache* cache;
+
+  memset(stats, 0, sizeof(MemPoolStatistics));
+  snprintf(stats->name, MEM_POOL_NAME_LEN, "%s", self->name);
+
+  pthread_mutex_lock(&self->mutex);
+  stats->objectSize = (uint32_t)self->objectSize;
+  stats->slabs      = self->noSlabs;
+  stats->slabBytes  = (uint64_t)self->noSlabs
+                      * (sizeof(MemPoolSlab)
+                         + (self->objectsPerSlab * self->objectSize));
+  stats->capacity   = self->noSlabs * self->objectsPerSlab;
+  stats->allocs     = self->allocs;
+  stats->frees      = self->frees;
+  for (cache = self->caches; cache != NULL; cache = cache->next)
+  {
+    stats->cached += cache->count;
+    stats->allocs += cache->allocs;
+    stats->frees  += cache->frees;
+  }
+  stats->inUse = stats->capacity - self->noFree - stats->cached;
+  pthread_mutex_unlock(&self->mutex);
+}
+
+/**
+ * Fill the statistics of all registered memory pools.
+ *
+ * @param stats Array of statistics to be filled.
+ * @param maxPools The number of elements in the array.
+ *
+ * @return The number of registered memory pools. This might be larger than
+ *         maxPools, in this case only the first maxPools elements are filled.
+ */
+int getAllMemPoolStatistics(MemPoolStatistics* stats, int maxPools)
+{
+  MemPool* pool;
+  int      noPools = 0;
+
+  pthread_mutex_lock(&_memPoolsLock);
+  for (pool = _memPools; pool != NULL; pool = pool->next)
+  {
+    if (noPools < maxPools)
+    {
+      getMemPoolStatistics(pool, &stats[noPools]);
+    }
+    noPools++;
+  }
+  pthread_mutex_unlock(&_memPoolsLock);
+
+  return noPools;
+}
@@ -0,0 +1,148 @@
+/**
+ * This software was developed at the National Institute of Standards and
+ * Technology by employees of the Federal Government in the course of
+ * their official duties. Pursuant to title 17 Section 105 of the United
+ * States Code this software is not subject to copyright protection and
+ * is in the public domain.
+ *
+ * NIST assumes no responsibility whatsoever for its use by other parties,
+ * and makes no guarantees, expressed or implied, about its quality,
+ * reliability, or any other characteristic.
+ *
+ * We would appreciate acknowledgment if the software is used.
+ *
+ * NIST ALLOWS FREE USE OF THIS SOFTWARE IN ITS "AS IS" CONDITION AND
+ * DISCLAIM ANY LIABILITY OF ANY KIND FOR ANY DAMAGES WHATSOEVER RESULTING
+ * FROM THE USE OF THIS SOFTWARE.
+ *
+ * This software might use libraries that are under GNU public license or
+ * other licenses. Please refer to the licenses of all libraries required
+ * by this software.
+ *
+ * Memory pool for objects of one fixed size. The objects are carved out of
+ * larger slabs and released objects are kept in a free list for re-use. Each
+ * thread keeps a small cache of free objects that is refilled from and
+ * flushed into the shared free list in batches. Slabs are only returned to the
+ * system when the pool is released.
+ *
+ * All pools are registered by name which allows to display their usage.
+ *
+ * @version 0.6.2.2
+ *
+ * Changelog:
+ * -----------------------------------------------------------------------------
+ * 0.6.2.2  - 2026/10/17
+ *            * Code created.
+ */
+
+#ifndef __MEM_POOL_H__
+#define __MEM_POOL_H__
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+
+/** Maximum length of the name of a memory pool including the '\0'. */
+#define MEM_POOL_NAME_LEN 32
+
+/** Default number of objects per slab. */
+#define MEM_POOL_DEF_SLAB_OBJECTS 256
+
+/**
+ * The usage statistics of a memory pool.
+ */
+typedef struct {
+  /** The name of the pool. */
+  char     name[MEM_POOL_NAME_LEN];
+  /** The size of each object in bytes (including alignment). */
+  uint32_t objectSize;
+  /** The number of slabs allocated. */
+  uint32_t slabs;
+  /** The number of bytes allocated for slabs. */
+  uint64_t slabBytes;
+  /** The number of objects in all slabs. */
+  uint32_t capacity;
+  /** The number of objects currently handed out. */
+  uint32_t inUse;
+  /** The number of free objects kept in the thread caches. */
+  uint32_t cached;
+  /** The number of allocations. */
+  uint64_t allocs;
+  /** The number of releases. */
+  uint64_t frees;
+} MemPoolStatistics;
+
+/** A memory pool, see createMemPool. */
+typedef struct _MemPool MemPool;
+
+/**
+ * Create a new memory pool and register it with the given name.
+ *
+ * @param name The name of the pool used for statistics.
+ * @param objectSize The size of each object in bytes.
+ * @param objectsPerSlab The number of objects allocated at once. If 0 the
+ *                       value MEM_POOL_DEF_SLAB_OBJECTS will be used.
+ *
+ * @return The memory pool or NULL if the pool could not be created.
+ */
+extern MemPool* createMemPool(const char* name, size_t objectSize,
+                              uint32_t objectsPerSlab);
+
+/**
+ * Release the memory pool including all slabs. All objects of this pool are
+ * invalid afterwards. The pool MUST NOT be used by any other thread anymore.
+ *
+ * @param self The memory pool (can be NULL)
+ */
+extern void releaseMemPool(MemPool* self);
+
+/**
+ * Return an object of the memory pool. The memory is NOT initialized.
+ *
+ * @param self The memory pool
+ *
+ * @return The object or NULL if no memory is available.
+ */
+extern void* allocFromMemPool(MemPool* self);
+
+/**
+ * Return the object into the memory pool. The object MUST have been allocated
+ * from the same memory pool.
+ *
+ * @param self The memory pool
+ * @param object The object to be returned (can be NULL).
+ */
+extern void freeToMemPool(MemPool* self, void* object);
+
+/**
+ * Return the size of the objects provided by the memory pool. This might be
+ * larger than the requested size due to alignment.
+ *
+ * @param self The memory pool
+ *
+ * @return The size of each object in bytes.
+ */
+extern size_t getMemPoolObjectSize(MemPool* self);
+
+/**
+ * Fill the statistics of the given memory pool. The values are for display
+ * purpose and not synchronized with the per thread caches.
+ *
+ * @param self The memory pool
+ * @param stats The statistics to be filled.
+ */
+extern void getMemPoolStatistics(MemPool* self, MemPoolStatistics* stats);
+
+/**
+ * Fill the statistics of all registered memory pools.
+ *
+ * @param stats Array of statistics to be filled.
+ * @param maxPools The number of elements in the array.
+ *
+ * @return The number of registered memory pools. This might be larger than
+ *         maxPools, in this case only the first maxPools elements are filled.
+ */
+extern int getAllMemPoolStatistics(MemPoolStatistics* stats, int maxPools);
+
+#endif // !__MEM_POOL_H__
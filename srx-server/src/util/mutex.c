@@ -28,6 +28,12 @@
  *
  * Changelog:
  * -----------------------------------------------------------------------------
+ * 0.6.2.2  - 2026/10/17
+ *            * Added broadcastCond()
+ *            * waitCond() calculates the deadline from the current time in 
+ *              nanoseconds. Before, fractions of a second were counted from
+ *              the last full second and converted into micro- instead of
+ *              nanoseconds.
  * 0.3.0.10 - 2016/01/21 - kyehwanl
  *            * change log level of waitCond() from LOGLEVEL to LEVEL_COMM,
  *              in order to avoid the infinate printing while waiting command
@@ -92,6 +98,13 @@ inline int signalCond(Cond *cond)
   return (pthread_cond_signal(cond));
 }
 
+inline int broadcastCond(Cond *cond)
+{
+  LOG(LOGLEVEL, "([0x%08X] Condition broadcast): --> to [0x%08X] ",
+      pthread_self(), cond);
+  return (pthread_cond_broadcast(cond));
+}
+
 /** Wait for time milliseconds. time - 0 = until notify called! */
 inline int waitCond(Cond *cond, Mutex *self, uint32_t millis)
 {
@@ -101,11 +114,17 @@ inline int waitCond(Cond *cond, Mutex *self, uint32_t millis)
     memset(&to, 0, sizeof(to));
 
     // Fix BZ133
-    long int stime = millis < 1000 ? 0 : millis / 1000;
-    long int ntime = (millis < 1000 ? millis : millis % 1000) * 1000;
-
-    to.tv_sec  = stime + time(0);
-    to.tv_nsec = ntime;
+    long int stime = millis / 1000;
+    long int ntime = (millis % 1000) * 1000000;
+
+    clock_gettime(CLOCK_REALTIME, &to);
+    to.tv_sec  += stime;
+    to.tv_nsec += ntime;
+    if (to.tv_nsec >= 1000000000)
+    {
+      to.tv_sec++;
+      to.tv_nsec -= 1000000000;
+    }
     LOG(LEVEL_COMM, "([0x%08X] Condition wait): --> [0x%08X] at Mutex[0x%08x] "
                     "for %i milliseconds = (%i seconds! and %i nanoseconds)",
                     pthread_self(), cond, self, millis, stime, ntime);
@@ -149,11 +168,17 @@ inline int sem_wait_wrapper(sem_t *sem_var, uint32_t millis)
     memset(&to, 0, sizeof(to));
 
     // Fix BZ133
-    long int stime = millis < 1000 ? 0 : millis / 1000;
-    long int ntime = (millis < 1000 ? millis : millis % 1000) * 1000;
-
-    to.tv_sec  = stime + time(0);
-    to.tv_nsec = ntime;
+    long int stime = millis / 1000;
+    long int ntime = (millis % 1000) * 1000000;
+
+    clock_gettime(CLOCK_REALTIME, &to);
+    to.tv_sec  += stime;
+    to.tv_nsec += ntime;
+    if (to.tv_nsec >= 1000000000)
+    {
+      to.tv_sec++;
+      to.tv_nsec -= 1000000000;
+    }
     LOG(LOGLEVEL, "([0x%08X] Condition wait): --> [0x%08X] at Semaphor[0x%08x] "
                   "for %i milliseconds = (%i seconds! and %i nanoseconds)",
                   pthread_self(), sem_var, millis, stime, ntime);
@@ -24,10 +24,12 @@
  * @note Currently based on PThread
  * log.h is used for error reporting.
  * 
- * @version 0.5.0.6
+ * @version 0.6.2.2
  *
  * Changelog:
  * -----------------------------------------------------------------------------
+ * 0.6.2.2 - 2026/10/17
+ *           * Added broadcastCond(...)
  * 0.5.0.6 - 2018/11/20 - oborchert
  *           * Removed "inline" keyword from functions - caused linker error 
  *             on Ubuntu 18
@@ -96,6 +98,8 @@ extern void waitMutex(Mutex* self);
 
 extern int initCond(Cond *cond);
 extern int signalCond(Cond *cond);
+/** Wake up all threads waiting on the condition. */
+extern int broadcastCond(Cond *cond);
 /** Wait for a time milli seconds. time - 0 = until notify called! */
 extern int waitCond(Cond *cond, Mutex *self, uint32_t millis);
 
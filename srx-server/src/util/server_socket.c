@@ -22,10 +22,18 @@
  *
  * Provides functionality to handle the SRx server socket.
  *
-  * @version 0.6.1.3
+  * @version 0.6.2.2
  *
  * Changelog:
  * -----------------------------------------------------------------------------
+ *  0.6.2.2 - 2026/10/17
+ *            * Packets are send using sendmsg which allows to send multiple
+ *              packets with one system call. Added send statistics.
+ *            * Added MODE_EVENT which serves all client connections with a few
+ *              epoll reactor threads using non blocking sockets. Each read
+ *              can deliver multiple PDUs. Data a client socket does not 
+ *              accept is buffered and written by the reactor once the socket
+ *              is writable, a client that does not receive is closed.
  *  0.6.1.3 - 2024/06/12 - oborchert
  *            * Fixed linker error in 'ROCKY 9' regarding the variable declaration
  *              int g_single_thread_client_fd which needs to be declared in the .c
@@ -64,6 +72,9 @@
 #include <netinet/in.h>
 #include <arpa/inet.h>
 #include <pthread.h>
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
 #include "util/log.h"
 #include "util/mutex.h"
 #include "util/packet.h"
@@ -97,6 +108,95 @@ static inline void sendData(int* fd, void* data, PacketLength len)
   }
 }
 
+/**
+ * Sends all data of the given vector using sendmsg. Partial writes are 
+ * continued, therefore the vector is modified. The number of system calls 
+ * and bytes are added to the statistics of the server socket. Similar to 
+ * sendNum the file descriptor is set to -1 in case of an error.
+ *
+ * @param self The server socket
+ * @param fd Socket file-descriptor
+ * @param iov The data vector
+ * @param iovcnt The number of elements in the data vector.
+ *
+ * @return true if all data could be send, otherwise false.
+ *
+ * @since 0.6.2.2
+ */
+static bool _sendVector(ServerSocket* self, int* fd, struct iovec* iov, 
+                        int iovcnt)
+{
+  struct msghdr msg;
+  ssize_t       sbytes = 0;
+
+  if (*fd == -1)
+  {
+    LOG(LEVEL_WARNING, FILE_LINE_INFO " File descriptor is invalid!");
+    return false;
+  }
+
+  memset(&msg, 0, sizeof(struct msghdr));
+  msg.msg_iov    = iov;
+  msg.msg_iovlen = iovcnt;
+
+  while (true)
+  {
+    // Skip all data already send
+    while ((msg.msg_iovlen > 0) && ((size_t)sbytes >= msg.msg_iov->iov_len))
+    {
+      sbytes -= msg.msg_iov->iov_len;
+      msg.msg_iov++;
+      msg.msg_iovlen--;
+    }
+    if (msg.msg_iovlen == 0)
+    {
+      break;
+    }
+    msg.msg_iov->iov_base  = (uint8_t*)msg.msg_iov->iov_base + sbytes;
+    msg.msg_iov->iov_len  -= sbytes;
+
+    sbytes = sendmsg(*fd, &msg, MSG_NOSIGNAL);
+    __sync_fetch_and_add(&self->sendCalls, 1);
+    if (sbytes <= 0)
+    {
+      if ((sbytes < 0) && (errno == EINTR))
+      {
+        sbytes = 0;
+        continue;
+      }
+      *fd = -1;
+      return false;
+    }
+    __sync_fetch_and_add(&self->sendBytes, (uint64_t)sbytes);
+  }
+
+  return true;
+}
+
+static bool event_sendVector(ClientThread* cthread, struct iovec* iov, 
+                             int iovcnt);
+
+/**
+ * Send the data vector to the client, requires the write mutex. Blocking 
+ * sockets send all data, MODE_EVENT buffers what the socket does not accept.
+ *
+ * @param clt The client
+ * @param iov The data vector
+ * @param iovcnt The number of elements in the data vector.
+ *
+ * @return true if the data is send or buffered, otherwise false.
+ *
+ * @since 0.6.2.2
+ */
+static bool _sendClientVector(ClientThread* clt, struct iovec* iov, int iovcnt)
+{
+  if (clt->svrSock->mode == MODE_EVENT)
+  {
+    return event_sendVector(clt, iov, iovcnt);
+  }
+  return _sendVector(clt->svrSock, &clt->clientFD, iov, iovcnt);
+}
+
 /**
  * NULL-safe frees memory.
  *
@@ -185,8 +285,12 @@ static bool single_sendResult(ServerClient* client, void* data, size_t size)
   // Only when still active
   if (clt->active)
   {
+    struct iovec iov = { data, size };
     lockMutex(&clt->writeMutex);
-    sendData(&clt->clientFD, data, (PacketLength)size);
+    if (!_sendClientVector(clt, &iov, 1))
+    {
+      RAISE_ERROR("Data could not be send!");
+    }
     unlockMutex(&clt->writeMutex);
 #ifdef USE_GRPC
       retVal = true;
@@ -546,6 +650,670 @@ static void* custom_handleClient(void* data)
   pthread_exit(0);
 }
 
+/*-----------
+ * MODE_EVENT
+ */
+
+/** The initial size of the receive buffer of a client connection. */
+#define EVENT_RCV_BUFFER_SIZE  (64 * 1024)
+/** PDUs larger than this are considered corrupt and close the connection. */
+#define EVENT_MAX_PDU_SIZE     (16 * 1024 * 1024)
+/** The maximum number of events processed with one epoll_wait call. */
+#define EVENT_MAX_EVENTS       64
+/** Maximum number of reads per event to not starve other connections. */
+#define EVENT_MAX_READS        8
+/** The initial size of the send buffer of a client connection. */
+#define EVENT_SND_BUFFER_SIZE  (64 * 1024)
+/** A client with more unsent data does not receive and is closed. */
+#define EVENT_MAX_SND_BUFFER   (16 * 1024 * 1024)
+/** The events of a client connection without respectively with unsent data. */
+#define EVENT_CLIENT_EVENTS    (EPOLLIN | EPOLLRDHUP)
+#define EVENT_CLIENT_EVENTS_OUT (EVENT_CLIENT_EVENTS | EPOLLOUT)
+
+/**
+ * An epoll reactor thread that serves a share of the client connections.
+ *
+ * @note MODE_EVENT
+ */
+typedef struct
+{
+  /** The server socket. */
+  ServerSocket* svrSock;
+  /** The thread of this reactor. */
+  pthread_t thread;
+  /** The epoll instance. */
+  int epollFD;
+  /** Event file descriptor used to wake up the reactor when stopping. */
+  int wakeFD;
+} EventReactor;
+
+/**
+ * Set the file descriptor into non blocking mode.
+ *
+ * @param fd The file descriptor.
+ *
+ * @return true if the mode could be set.
+ *
+ * @since 0.6.2.2
+ */
+static bool _setNonBlocking(int fd)
+{
+  int flags = fcntl(fd, F_GETFL, 0);
+  return (flags != -1) && (fcntl(fd, F_SETFL, flags | O_NONBLOCK) != -1);
+}
+
+/**
+ * Process all complete PDUs within the receive buffer of the client and move
+ * the remaining bytes to the beginning of the buffer. The buffer is enlarged
+ * in case the next PDU does not fit.
+ *
+ * @note MODE_EVENT
+ *
+ * @param cthread The client connection.
+ *
+ * @return false if the stream is corrupt or no memory is available.
+ *
+ * @since 0.6.2.2
+ */
+static bool event_processBuffer(ClientThread* cthread)
+{
+  ServerSocket* svrSock = cthread->svrSock;
+  uint32_t      offset  = 0;
+  uint32_t      pduLength;
+  uint8_t*      newBuffer;
+
+  while ((cthread->rcvUsed - offset) >= sizeof(SRXPROXY_BasicHeader))
+  {
+    pduLength = ntohl(((SRXPROXY_BasicHeader*)(cthread->rcvBuffer + offset))
+                      ->length);
+    if (   (pduLength < sizeof(SRXPROXY_BasicHeader)) 
+        || (pduLength > EVENT_MAX_PDU_SIZE))
+    {
+      RAISE_ERROR("Received PDU with invalid length %u!", pduLength);
+      return false;
+    }
+    if ((cthread->rcvUsed - offset) < pduLength)
+    {
+      break;
+    }
+    if (!cthread->active)
+    {
+      // The connection was closed by the server, drop the remaining PDUs
+      return false;
+    }
+    // ServerPacketReceived - the packet must be copied if it is kept.
+    svrSock->modeCallback(svrSock, cthread, cthread->rcvBuffer + offset,
+                          pduLength, svrSock->user);
+    offset += pduLength;
+  }
+
+  if (offset > 0)
+  {
+    cthread->rcvUsed -= offset;
+    memmove(cthread->rcvBuffer, cthread->rcvBuffer + offset, cthread->rcvUsed);
+  }
+
+  // Make sure the next PDU fits into the buffer
+  if (cthread->rcvUsed >= sizeof(SRXPROXY_BasicHeader))
+  {
+    pduLength = ntohl(((SRXPROXY_BasicHeader*)cthread->rcvBuffer)->length);
+    if (pduLength > cthread->rcvBufferSize)
+    {
+      newBuffer = realloc(cthread->rcvBuffer, pduLength);
+      if (newBuffer == NULL)
+      {
+        RAISE_SYS_ERROR("Not enough memory for the packet data");
+        return false;
+      }
+      cthread->rcvBuffer     = newBuffer;
+      cthread->rcvBufferSize = pduLength;
+    }
+  }
+
+  return true;
+}
+
+/**
+ * Read as much data as available and process all complete PDUs.
+ *
+ * @note MODE_EVENT
+ *
+ * @param cthread The client connection.
+ *
+ * @return false if the connection is closed or broken.
+ *
+ * @since 0.6.2.2
+ */
+static bool event_readClient(ClientThread* cthread)
+{
+  ssize_t  rbytes;
+  uint32_t space;
+  int      reads;
+
+  for (reads = 0; reads < EVENT_MAX_READS; reads++)
+  {
+    space  = cthread->rcvBufferSize - cthread->rcvUsed;
+    rbytes = recv(cthread->clientFD, cthread->rcvBuffer + cthread->rcvUsed,
+                  space, 0);
+    if (rbytes == 0)
+    {
+      LOG(LEVEL_DEBUG, HDR "Connection to client closed", pthread_self());
+      return false;
+    }
+    if (rbytes < 0)
+    {
+      if (errno == EINTR)
+      {
+        continue;
+      }
+      if ((errno == EAGAIN) || (errno == EWOULDBLOCK))
+      {
+        break;
+      }
+      LOG(LEVEL_DEBUG, HDR "Connection to client closed (errno %d)", 
+                       pthread_self(), errno);
+      return false;
+    }
+
+    cthread->rcvUsed += (uint32_t)rbytes;
+    if (!event_processBuffer(cthread))
+    {
+      return false;
+    }
+    if ((uint32_t)rbytes < space)
+    {
+      // The socket is drained
+      break;
+    }
+  }
+
+  return true;
+}
+
+/**
+ * Register the events of the client with its reactor. EPOLLOUT is only armed
+ * while unsent data is buffered.
+ *
+ * @note MODE_EVENT
+ *
+ * @param cthread The client connection.
+ * @param events The epoll events.
+ *
+ * @return true if the events are registered.
+ *
+ * @since 0.6.2.2
+ */
+static bool event_setClientEvents(ClientThread* cthread, uint32_t events)
+{
+  struct epoll_event event;
+
+  memset(&event, 0, sizeof(struct epoll_event));
+  event.events   = events;
+  event.data.ptr = cthread;
+  return epoll_ctl(cthread->epollFD, EPOLL_CTL_MOD, cthread->clientFD, &event)
+         != -1;
+}
+
+/**
+ * Send the data vector to the client without waiting. The data the socket
+ * does not accept is appended to the send buffer and written by the reactor
+ * once the socket is writable. A client which does not receive its data is 
+ * shut down and closed by the reactor. Requires the write mutex.
+ *
+ * @note MODE_EVENT
+ *
+ * @param cthread The client connection.
+ * @param iov The data vector, it will be modified.
+ * @param iovcnt The number of elements in the data vector.
+ *
+ * @return true if the data is send or buffered, otherwise false.
+ *
+ * @since 0.6.2.2
+ */
+static bool event_sendVector(ClientThread* cthread, struct iovec* iov, 
+                             int iovcnt)
+{
+  ServerSocket* svrSock = cthread->svrSock;
+  struct msghdr msg;
+  ssize_t       sbytes = 0;
+  size_t        pending;
+  uint32_t      newSize;
+  uint8_t*      newBuffer;
+  int           idx;
+
+  if (cthread->clientFD == -1)
+  {
+    return false;
+  }
+
+  memset(&msg, 0, sizeof(struct msghdr));
+  msg.msg_iov    = iov;
+  msg.msg_iovlen = iovcnt;
+
+  // Data is only written directly if nothing is queued before it.
+  while (cthread->sndUsed == 0)
+  {
+    // Skip all data already send
+    while ((msg.msg_iovlen > 0) && ((size_t)sbytes >= msg.msg_iov->iov_len))
+    {
+      sbytes -= msg.msg_iov->iov_len;
+      msg.msg_iov++;
+      msg.msg_iovlen--;
+    }
+    if (msg.msg_iovlen == 0)
+    {
+      return true;
+    }
+    msg.msg_iov->iov_base  = (uint8_t*)msg.msg_iov->iov_base + sbytes;
+    msg.msg_iov->iov_len  -= sbytes;
+
+    sbytes = sendmsg(cthread->clientFD, &msg, MSG_NOSIGNAL);
+    __sync_fetch_and_add(&svrSock->sendCalls, 1);
+    if (sbytes < 0)
+    {
+      if (errno == EINTR)
+      {
+        sbytes = 0;
+        continue;
+      }
+      if ((errno == EAGAIN) || (errno == EWOULDBLOCK))
+      {
+        sbytes = 0;
+        break;
+      }
+      // The reactor closes the connection.
+      shutdown(cthread->clientFD, SHUT_RDWR);
+      return false;
+    }
+    __sync_fetch_and_add(&svrSock->sendBytes, (uint64_t)sbytes);
+  }
+
+  pending = 0;
+  for (idx = 0; idx < (int)msg.msg_iovlen; idx++)
+  {
+    pending += msg.msg_iov[idx].iov_len;
+  }
+  if (pending == 0)
+  {
+    return true;
+  }
+  if ((cthread->sndUsed + pending) > EVENT_MAX_SND_BUFFER)
+  {
+    RAISE_ERROR("Client [ID :%u] does not receive its data, close it!", 
+                cthread->proxyID);
+    shutdown(cthread->clientFD, SHUT_RDWR);
+    return false;
+  }
+
+  if ((cthread->sndUsed + pending) > cthread->sndBufferSize)
+  {
+    newSize = (cthread->sndBufferSize == 0) ? EVENT_SND_BUFFER_SIZE
+                                            : cthread->sndBufferSize;
+    while (newSize < (cthread->sndUsed + pending))
+    {
+      newSize *= 2;
+    }
+    newBuffer = realloc(cthread->sndBuffer, newSize);
+    if (newBuffer == NULL)
+    {
+      RAISE_SYS_ERROR("Not enough memory for the send buffer");
+      shutdown(cthread->clientFD, SHUT_RDWR);
+      return false;
+    }
+    cthread->sndBuffer     = newBuffer;
+    cthread->sndBufferSize = newSize;
+  }
+
+  if (cthread->sndUsed == 0)
+  {
+    // First unsent data, let the reactor know when the socket is writable.
+    if (!event_setClientEvents(cthread, EVENT_CLIENT_EVENTS_OUT))
+    {
+      RAISE_SYS_ERROR("Could not wait for the client to be writable");
+      shutdown(cthread->clientFD, SHUT_RDWR);
+      return false;
+    }
+  }
+
+  for (idx = 0; idx < (int)msg.msg_iovlen; idx++)
+  {
+    memcpy(cthread->sndBuffer + cthread->sndUsed, msg.msg_iov[idx].iov_base,
+           msg.msg_iov[idx].iov_len);
+    cthread->sndUsed += (uint32_t)msg.msg_iov[idx].iov_len;
+  }
+
+  return true;
+}
+
+/**
+ * Write the buffered data of the client as long as the socket accepts it.
+ * EPOLLOUT is disarmed once the send buffer is empty.
+ *
+ * @note MODE_EVENT
+ *
+ * @param cthread The client connection.
+ *
+ * @return false if the connection is broken.
+ *
+ * @since 0.6.2.2
+ */
+static bool event_writeClient(ClientThread* cthread)
+{
+  ServerSocket* svrSock = cthread->svrSock;
+  uint32_t      offset  = 0;
+  ssize_t       sbytes;
+  bool          retVal  = true;
+
+  lockMutex(&cthread->writeMutex);
+  while (offset < cthread->sndUsed)
+  {
+    sbytes = send(cthread->clientFD, cthread->sndBuffer + offset,
+                  cthread->sndUsed - offset, MSG_NOSIGNAL);
+    __sync_fetch_and_add(&svrSock->sendCalls, 1);
+    if (sbytes < 0)
+    {
+      if (errno == EINTR)
+      {
+        continue;
+      }
+      retVal = (errno == EAGAIN) || (errno == EWOULDBLOCK);
+      break;
+    }
+    __sync_fetch_and_add(&svrSock->sendBytes, (uint64_t)sbytes);
+    offset += (uint32_t)sbytes;
+  }
+
+  if (retVal)
+  {
+    cthread->sndUsed -= offset;
+    if (cthread->sndUsed == 0)
+    {
+      retVal = event_setClientEvents(cthread, EVENT_CLIENT_EVENTS);
+    }
+    else if (offset > 0)
+    {
+      memmove(cthread->sndBuffer, cthread->sndBuffer + offset, 
+              cthread->sndUsed);
+    }
+  }
+  unlockMutex(&cthread->writeMutex);
+
+  return retVal;
+}
+
+/**
+ * Remove the client from the reactor and release it. If the client was closed
+ * by the peer, the status callback is called which takes over the client 
+ * thread instance, otherwise it is removed from the list of client threads.
+ *
+ * @note MODE_EVENT
+ *
+ * @param reactor The reactor that serves the client.
+ * @param cthread The client connection.
+ *
+ * @since 0.6.2.2
+ */
+static void event_closeClient(EventReactor* reactor, ClientThread* cthread)
+{
+  ServerSocket* svrSock = cthread->svrSock;
+  bool          byPeer;
+  int           fd;
+
+  epoll_ctl(reactor->epollFD, EPOLL_CTL_DEL, cthread->clientFD, NULL);
+
+  lockMutex(&cthread->writeMutex);
+  byPeer = cthread->active;
+  fd     = cthread->clientFD;
+  cthread->active   = false;
+  cthread->clientFD = -1;
+  close(fd);
+  free(cthread->sndBuffer);
+  cthread->sndBuffer     = NULL;
+  cthread->sndBufferSize = 0;
+  cthread->sndUsed       = 0;
+  unlockMutex(&cthread->writeMutex);
+
+  free(cthread->rcvBuffer);
+  cthread->rcvBuffer     = NULL;
+  cthread->rcvBufferSize = 0;
+  cthread->rcvUsed       = 0;
+
+  if (svrSock->verbose)
+  {
+    LOG(LEVEL_INFO, "Client disconnected: [ID :%u]", cthread->proxyID);
+  }
+
+  if (byPeer && (svrSock->statusCallback != NULL))
+  {
+    // Let the user know about the client loss
+    svrSock->statusCallback(svrSock, cthread, fd, false, svrSock->user);
+  }
+  else
+  {
+    deleteFromSList(&svrSock->cthreads, cthread);
+  }
+}
+
+/**
+ * The loop of a reactor thread. Waits for data of all its client connections
+ * and processes all PDUs received.
+ *
+ * @note MODE_EVENT
+ * @note PThread syntax
+ *
+ * @param data EventReactor instance
+ *
+ * @return Always NULL
+ *
+ * @since 0.6.2.2
+ */
+static void* event_reactorLoop(void* data)
+{
+  EventReactor*      reactor = (EventReactor*)data;
+  struct epoll_event events[EVENT_MAX_EVENTS];
+  ClientThread*      cthread;
+  int                noEvents, idx;
+
+  LOG(LEVEL_DEBUG, "([0x%08X]) > Proxy Client Reactor Thread started "
+                   "(ServerSocket::event_reactorLoop)", pthread_self());
+
+  while (reactor->svrSock->stopping == 0)
+  {
+    noEvents = epoll_wait(reactor->epollFD, events, EVENT_MAX_EVENTS, -1);
+    if (noEvents < 0)
+    {
+      if (errno == EINTR)
+      {
+        continue;
+      }
+      RAISE_SYS_ERROR("Reactor failed to wait for client data");
+      break;
+    }
+
+    for (idx = 0; idx < noEvents; idx++)
+    {
+      cthread = (ClientThread*)events[idx].data.ptr;
+      if (cthread == NULL)
+      {
+        // The wake up event of the reactor itself
+        continue;
+      }
+      if (   ((events[idx].events & EPOLLOUT) != 0)
+          && !event_writeClient(cthread))
+      {
+        event_closeClient(reactor, cthread);
+        continue;
+      }
+      // Errors and hang ups are reported by recv after the remaining data
+      if (   ((events[idx].events & ~EPOLLOUT) != 0)
+          && !event_readClient(cthread))
+      {
+        event_closeClient(reactor, cthread);
+      }
+    }
+  }
+
+  LOG(LEVEL_DEBUG, "([0x%08X]) < Proxy Client Reactor Thread stopped "
+                   "(ServerSocket::event_reactorLoop)", pthread_self());
+
+  return NULL;
+}
+
+/**
+ * Create and start the reactor threads of the server socket.
+ *
+ * @note MODE_EVENT
+ *
+ * @param self The server socket.
+ *
+ * @return true if all reactors are started.
+ *
+ * @since 0.6.2.2
+ */
+static bool event_startReactors(ServerSocket* self)
+{
+  EventReactor*      reactors;
+  struct epoll_event event;
+  int                idx;
+
+  reactors = calloc(self->noReactors, sizeof(EventReactor));
+  if (reactors == NULL)
+  {
+    RAISE_SYS_ERROR("Not enough memory for the reactor threads");
+    return false;
+  }
+
+  for (idx = 0; idx < self->noReactors; idx++)
+  {
+    reactors[idx].svrSock = self;
+    reactors[idx].epollFD = epoll_create1(EPOLL_CLOEXEC);
+    reactors[idx].wakeFD  = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    memset(&event, 0, sizeof(struct epoll_event));
+    event.events   = EPOLLIN;
+    event.data.ptr = NULL;
+    if (   (reactors[idx].epollFD == -1) || (reactors[idx].wakeFD == -1)
+        || (epoll_ctl(reactors[idx].epollFD, EPOLL_CTL_ADD, 
+                      reactors[idx].wakeFD, &event) == -1)
+        || (pthread_create(&reactors[idx].thread, NULL, event_reactorLoop,
+                           &reactors[idx]) != 0))
+    {
+      RAISE_SYS_ERROR("Could not start the reactor thread %i", idx);
+      break;
+    }
+  }
+
+  if (idx < self->noReactors)
+  {
+    // Release the partial started reactors
+    self->stopping++;
+    while (idx >= 0)
+    {
+      if (reactors[idx].thread != 0)
+      {
+        eventfd_write(reactors[idx].wakeFD, 1);
+        pthread_join(reactors[idx].thread, NULL);
+      }
+      if (reactors[idx].epollFD != -1) { close(reactors[idx].epollFD); }
+      if (reactors[idx].wakeFD != -1)  { close(reactors[idx].wakeFD); }
+      idx--;
+    }
+    self->stopping--;
+    free(reactors);
+    return false;
+  }
+
+  self->reactors    = reactors;
+  self->nextReactor = 0;
+  return true;
+}
+
+/**
+ * Hand the accepted client connection to the next reactor.
+ *
+ * @note MODE_EVENT
+ *
+ * @param self The server socket.
+ * @param cthread The client connection.
+ *
+ * @return true if the client is served by a reactor.
+ *
+ * @since 0.6.2.2
+ */
+static bool event_addClient(ServerSocket* self, ClientThread* cthread)
+{
+  EventReactor*      reactor = &((EventReactor*)self->reactors)
+                                        [self->nextReactor++ % self->noReactors];
+  struct epoll_event event;
+
+  cthread->rcvBuffer     = malloc(EVENT_RCV_BUFFER_SIZE);
+  cthread->rcvBufferSize = EVENT_RCV_BUFFER_SIZE;
+  cthread->rcvUsed       = 0;
+  cthread->sndBuffer     = NULL;
+  cthread->sndBufferSize = 0;
+  cthread->sndUsed       = 0;
+  cthread->epollFD       = reactor->epollFD;
+  cthread->thread        = reactor->thread;
+
+  if (cthread->rcvBuffer == NULL)
+  {
+    RAISE_SYS_ERROR("Not enough memory for the receive buffer");
+    return false;
+  }
+  if (!_setNonBlocking(cthread->clientFD) || !initWriteMutex(cthread))
+  {
+    free(cthread->rcvBuffer);
+    cthread->rcvBuffer = NULL;
+    return false;
+  }
+
+  memset(&event, 0, sizeof(struct epoll_event));
+  event.events   = EVENT_CLIENT_EVENTS;
+  event.data.ptr = cthread;
+  if (epoll_ctl(reactor->epollFD, EPOLL_CTL_ADD, cthread->clientFD, &event) 
+      == -1)
+  {
+    RAISE_SYS_ERROR("Could not add the client to the reactor");
+    releaseMutex(&cthread->writeMutex);
+    free(cthread->rcvBuffer);
+    cthread->rcvBuffer = NULL;
+    return false;
+  }
+
+  return true;
+}
+
+/**
+ * Stop all reactor threads and release them. The client connections are not
+ * closed.
+ *
+ * @note MODE_EVENT
+ *
+ * @param self The server socket.
+ *
+ * @since 0.6.2.2
+ */
+static void event_stopReactors(ServerSocket* self)
+{
+  EventReactor* reactors = (EventReactor*)self->reactors;
+  int idx;
+
+  if (reactors != NULL)
+  {
+    for (idx = 0; idx < self->noReactors; idx++)
+    {
+      eventfd_write(reactors[idx].wakeFD, 1);
+    }
+    for (idx = 0; idx < self->noReactors; idx++)
+    {
+      pthread_join(reactors[idx].thread, NULL);
+      close(reactors[idx].epollFD);
+      close(reactors[idx].wakeFD);
+    }
+    free(reactors);
+    self->reactors = NULL;
+  }
+}
+
 /*--------
  * Exports
  */
@@ -679,10 +1447,29 @@ bool createServerSocket(ServerSocket* self, int port, bool verbose)
   // Misc. variables
   self->stopping = 0;
   self->verbose = verbose;
+  self->sendCalls = 0;
+  self->sendBytes = 0;
+  self->noReactors  = 1;
+  self->reactors    = NULL;
+  self->nextReactor = 0;
 
   return true;
 }
 
+/**
+ * Set the number of epoll reactor threads used in MODE_EVENT. Must be called
+ * prior to runServerLoop.
+ *
+ * @param self The server-socket
+ * @param noReactors The number of reactor threads (minimum 1).
+ *
+ * @since 0.6.2.2
+ */
+void setServerSocketReactors(ServerSocket* self, int noReactors)
+{
+  self->noReactors = noReactors < 1 ? 1 : noReactors;
+}
+
 /**
  * This is the server loop for the SRx - Proxy server connection.
  * 
@@ -722,6 +1509,14 @@ void runServerLoop(ServerSocket* self, ClientMode clMode,
   // No active threads
   initSList(&self->cthreads);
 
+  if ((clMode == MODE_EVENT) && !event_startReactors(self))
+  {
+    LOG(LEVEL_WARNING, "Could not start the reactor threads, use one thread "
+                       "per client connection!");
+    clMode = MODE_SINGLE_CLIENT;
+    self->mode = clMode;
+  }
+
   // Prepare socket to accept connections
   listen(self->serverFD, MAX_PENDING_CONNECTIONS);
   
@@ -774,8 +1569,9 @@ void runServerLoop(ServerSocket* self, ClientMode clMode,
 ////////////////////////////////////////////////////////////////////////////////
         //TODO: the mode might not be needed anymore
         accepted = self->statusCallback(self,
-                                        (clMode == MODE_SINGLE_CLIENT) ? cthread
-                                                                       : NULL,
+                                        (   (clMode == MODE_SINGLE_CLIENT)
+                                         || (clMode == MODE_EVENT)) ? cthread
+                                                                    : NULL,
                                         cliendFD, true, self->user);
       }
 
@@ -789,6 +1585,7 @@ void runServerLoop(ServerSocket* self, ClientMode clMode,
         cthread->proxyID  = 0; // will be changed for srx-proxy during handshake
         cthread->routerID = 0; // Indicates that it is currently not usable, 
                                // must be set during handshake
+        cthread->capabilities = 0;
         cthread->clientFD = cliendFD;
         cthread->svrSock  = self;
         cthread->caddr	  = caddr;
@@ -796,13 +1593,23 @@ void runServerLoop(ServerSocket* self, ClientMode clMode,
         cthread->type_grpc_client = false;
 #endif
 
-        ret = pthread_create(&(cthread->thread), &attr,
-                             CL_THREAD_ROUTINES[clMode],
-                             (void*)cthread);
-        if (ret != 0)
+        cthread->rcvBuffer = NULL;
+
+        if (clMode == MODE_EVENT)
         {
-          accepted = false;
-          RAISE_ERROR("Failed to create a client thread");
+          // Let a reactor serve the connection.
+          accepted = event_addClient(self, cthread);
+        }
+        else
+        {
+          ret = pthread_create(&(cthread->thread), &attr,
+                               CL_THREAD_ROUTINES[clMode],
+                               (void*)cthread);
+          if (ret != 0)
+          {
+            accepted = false;
+            RAISE_ERROR("Failed to create a client thread");
+          }
         }
       }
 
@@ -826,7 +1633,30 @@ static void _killClientThread(void* clt)
 {
   ClientThread* clientThread = (ClientThread*)clt;
 
-  if (clientThread->active)
+  if (clientThread->svrSock->mode == MODE_EVENT
+#ifdef USE_GRPC
+      && !clientThread->type_grpc_client
+#endif
+     )
+  {
+    // The reactors are stopped, the connection can be closed directly.
+    if (clientThread->clientFD != -1)
+    {
+      close(clientThread->clientFD);
+      clientThread->clientFD = -1;
+    }
+    if (clientThread->active)
+    {
+      releaseMutex(&clientThread->writeMutex);
+      clientThread->active = false;
+    }
+    free(clientThread->rcvBuffer);
+    clientThread->rcvBuffer = NULL;
+    free(clientThread->sndBuffer);
+    clientThread->sndBuffer = NULL;
+    clientThread->sndUsed   = 0;
+  }
+  else if (clientThread->active)
   {
     // Close the client connection
 #ifdef USE_GRPC
@@ -860,6 +1690,12 @@ void stopServerLoop(ServerSocket* self)
     // Stop accepting connections 
     close(self->serverFD);
 
+    if (self->mode == MODE_EVENT)
+    {
+      // No client is processed anymore once the reactors are stopped.
+      event_stopReactors(self);
+    }
+
     // Kill all threads
     foreachInSList(&self->cthreads, _killClientThread);
     releaseSList(&self->cthreads);
@@ -877,7 +1713,7 @@ bool sendPacketToClient(ServerSocket* self, ServerClient* client,
     return false;
   }
 
-  if (self->mode == MODE_SINGLE_CLIENT)
+  if ((self->mode == MODE_SINGLE_CLIENT) || (self->mode == MODE_EVENT))
   {
     return single_sendResult(client, data, size);
   }
@@ -889,6 +1725,79 @@ bool sendPacketToClient(ServerSocket* self, ServerClient* client,
   return false;
 }
 
+/**
+ * Sends the data of the given vector to a client using as few system calls as
+ * possible. The vector is modified during sending.
+ *
+ * @note Only supported for MODE_SINGLE_CLIENT and MODE_EVENT.
+ *
+ * @param self Server-socket instance
+ * @param client Client
+ * @param iov The data vector, might contain multiple packets.
+ * @param iovcnt The number of elements in the data vector.
+ * 
+ * @return \c true = sent, \c false = an error occurred (e.g. inactive client)
+ * 
+ * @since 0.6.2.2
+ */
+bool sendVectorToClient(ServerSocket* self, ServerClient* client,
+                        struct iovec* iov, int iovcnt)
+{
+  ClientThread* clt = (ClientThread*)client;
+  bool retVal = false;
+
+  if (self == NULL)
+  {
+    RAISE_ERROR("Server Socket instance is NULL");
+    return false;
+  }
+  if ((self->mode != MODE_SINGLE_CLIENT) && (self->mode != MODE_EVENT))
+  {
+    RAISE_ERROR("Cannot send packet vectors in this mode");
+    return false;
+  }
+#ifdef USE_GRPC
+  if (clt->type_grpc_client)
+  {
+    return false;
+  }
+#endif // USE_GRPC
+
+  if (clt->active)
+  {
+    lockMutex(&clt->writeMutex);
+    retVal = _sendClientVector(clt, iov, iovcnt);
+    unlockMutex(&clt->writeMutex);
+    if (!retVal)
+    {
+      RAISE_ERROR("Data could not be send!");
+    }
+  }
+  else
+  {
+    RAISE_ERROR("Trying to send a packet over an inactive connection");
+  }
+
+  return retVal;
+}
+
+/**
+ * Retrieve the number of send system calls and the number of bytes send to
+ * all clients of the server socket.
+ *
+ * @param self Server-socket instance
+ * @param calls Returns the number of send system calls.
+ * @param bytes Returns the number of bytes send.
+ * 
+ * @since 0.6.2.2
+ */
+void getServerSocketSendStatistics(ServerSocket* self, uint64_t* calls, 
+                                   uint64_t* bytes)
+{
+  *calls = __sync_fetch_and_add(&self->sendCalls, 0);
+  *bytes = __sync_fetch_and_add(&self->sendBytes, 0);
+}
+
 /**
  * Closes the connection associated with the given client.
  * 
@@ -904,6 +1813,25 @@ int closeClientConnection(ServerSocket* self, ServerClient* client)
   LOG(LEVEL_DEBUG, HDR "Close and remove client: Thread [0x%08X]; [ID :%u]; "
                        "[FD: 0x%08X]", pthread_self() , clientThread->thread,
                        clientThread->proxyID, clientThread->clientFD);
+
+  if (self->mode == MODE_EVENT
+#ifdef USE_GRPC
+      && !clientThread->type_grpc_client
+#endif
+     )
+  {
+    // The reactor owns the connection. Shutting it down lets the reactor 
+    // release it once it processed the remaining data.
+    lockMutex(&clientThread->writeMutex);
+    if (clientThread->active)
+    {
+      clientThread->active = false;
+      shutdown(clientThread->clientFD, SHUT_RDWR);
+    }
+    unlockMutex(&clientThread->writeMutex);
+    LOG(LEVEL_INFO, "Client connection [ID:%u] closed!", clientThread->proxyID);
+    return true;
+  }
 #ifdef USE_GRPC
   if (clientThread->svrSock->statusCallback != NULL)
   {
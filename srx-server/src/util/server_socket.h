@@ -23,10 +23,18 @@
  * Function to create a server-socket and to start/stop a server runloop.
  * Provides functionality to handle the SRx server socket.
  *
- * @version 0.6.1.3
+ * @version 0.6.2.2
  *
  * Changelog:
  * -----------------------------------------------------------------------------
+ *  0.6.2.2 - 2026/10/17
+ *            * Added sendVectorToClient and the send statistics.
+ *            * Added MODE_EVENT and setServerSocketReactors.
+ *            * Added the receive buffer to the ClientThread structure.
+ *            * Increased MAX_PENDING_CONNECTIONS from 5 to 128.
+ *            * Added the negotiated capabilities to ClientThread.
+ *            * Added the send buffer and the epoll instance of the reactor to
+ *              the ClientThread structure.
  *  0.6.1.3 - 2024/06/12 - oborchert
  *            * Fixed linker error in 'ROCKY 9' regarding the variable declaration
  *              int g_single_thread_client_fd which needs to be declared in the .c
@@ -75,18 +83,26 @@
  *   <td>ClientConnectionAccepted</td>
  *   <td>no</td>
  * </tr>
+ * <tr>
+ *   <td>MODE_EVENT</td>
+ *   <td>1 client, 1 connection, served by epoll reactor threads</td>
+ *   <td>ServerPacketReceived</td>
+ *   <td>yes</td>
+ * </tr>
  * </table>
  *
  */
 #ifndef __SERVER_SOCKET_H__
 #define __SERVER_SOCKET_H__
 
+#include <stdint.h>
+#include <sys/uio.h>
 #include "util/mutex.h"
 #include "util/packet.h"
 #include "util/slist.h"
 
 /** Maximum number of clients waiting to be accepted for connection. */
-#define MAX_PENDING_CONNECTIONS 5
+#define MAX_PENDING_CONNECTIONS 128
 
 ////////////////////////////////////////////////////////////////////////////////
 // ERROR STRINGS - Moved from code to here with version 0.5.0.0
@@ -136,6 +152,8 @@ typedef enum
   MODE_SINGLE_CLIENT = 0, // 1 client  : 1 connection, ServerPacketReceived
   MODE_MULTIPLE_CLIENTS, // N clients : 1 connection, ServerPacketReceived
   MODE_CUSTOM_CALLBACK, // Custom, ClientConnectionAccepted
+  MODE_EVENT,           // 1 client  : 1 connection, ServerPacketReceived, 
+                        // all clients are served by a few epoll threads
 
   NUM_CLIENT_MODES ///< Number of different modes (needs to be the last item)
 } ClientMode;
@@ -228,6 +246,13 @@ struct _ServerSocket
   int stopping;
   SList cthreads;
   bool verbose;
+  // Statistics: number of send system calls and bytes send to clients
+  uint64_t sendCalls;
+  uint64_t sendBytes;
+  // MODE_EVENT: the number of reactor threads and the reactors themselves
+  int      noReactors;
+  void*    reactors;
+  uint32_t nextReactor;
 } ;
 
 /**
@@ -260,6 +285,9 @@ typedef struct
    * attached routers / proxies, max 255 therefore a one byte id is more than
    * sufficient. This ID will be mapped to the updates. */
   uint8_t  routerID;
+
+  /** The capabilities negotiated during the handshake (SRX_PROXY_CAP_...). */
+  uint32_t capabilities;
   
   Mutex writeMutex;
 
@@ -267,6 +295,21 @@ typedef struct
   ServerSocket* svrSock;
   /* The socket address. */
   struct sockaddr caddr;  
+  /* MODE_EVENT: The buffer of received but not yet processed data. */
+  uint8_t* rcvBuffer;
+  /* MODE_EVENT: The size of the receive buffer. */
+  uint32_t rcvBufferSize;
+  /* MODE_EVENT: The number of bytes in the receive buffer. */
+  uint32_t rcvUsed;
+  /* MODE_EVENT: The data the socket did not accept yet, protected by the 
+   * writeMutex. */
+  uint8_t* sndBuffer;
+  /* MODE_EVENT: The size of the send buffer. */
+  uint32_t sndBufferSize;
+  /* MODE_EVENT: The number of bytes in the send buffer. */
+  uint32_t sndUsed;
+  /* MODE_EVENT: The epoll instance of the reactor serving this client. */
+  int      epollFD;
 #ifdef USE_GRPC 
   bool type_grpc_client; /* between general client and  grpc client */
 #endif
@@ -282,6 +325,17 @@ typedef struct
  */
 bool createServerSocket(ServerSocket* self, int port, bool verbose);
 
+/**
+ * Set the number of epoll reactor threads used in MODE_EVENT. Must be called
+ * prior to runServerLoop.
+ *
+ * @param self The server-socket
+ * @param noReactors The number of reactor threads (minimum 1).
+ *
+ * @since 0.6.2.2
+ */
+void setServerSocketReactors(ServerSocket* self, int noReactors);
+
 /**
  * Starts the runloop which processes all client connections, and depending 
  * on the mode even the receipt of the packets.
@@ -325,6 +379,39 @@ void stopServerLoop(ServerSocket* self);
 bool sendPacketToClient(ServerSocket* self, ServerClient* client,
                         void* data, size_t size);
 
+/**
+ * Sends the data of the given vector to a client using as few system calls as
+ * possible. The vector is modified during sending. In MODE_EVENT the data the
+ * socket does not accept is buffered and send by the reactor, this call never
+ * waits for the client.
+ *
+ * @note Only supported for MODE_SINGLE_CLIENT and MODE_EVENT.
+ *
+ * @param self Server-socket instance
+ * @param client Client
+ * @param iov The data vector, might contain multiple packets.
+ * @param iovcnt The number of elements in the data vector.
+ * 
+ * @return \c true = sent, \c false = an error occurred (e.g. inactive client)
+ * 
+ * @since 0.6.2.2
+ */
+bool sendVectorToClient(ServerSocket* self, ServerClient* client,
+                        struct iovec* iov, int iovcnt);
+
+/**
+ * Retrieve the number of send system calls and the number of bytes send to
+ * all clients of the server socket.
+ *
+ * @param self Server-socket instance
+ * @param calls Returns the number of send system calls.
+ * @param bytes Returns the number of bytes send.
+ * 
+ * @since 0.6.2.2
+ */
+void getServerSocketSendStatistics(ServerSocket* self, uint64_t* calls, 
+                                   uint64_t* bytes);
+
 /**
  * Closes the connection associated with the given client.
  * 
@@ -21,23 +21,279 @@
  * by this software.
  *
  *
- * @version 0.3.0.10
+ * @version 0.6.2.2
  *
  * Changelog:
  * -----------------------------------------------------------------------------
+ * 0.6.2.2  - 2026/10/17
+ *            * Nodes link their predecessor, deleting a node does not walk
+ *              the list anymore.
+ *            * Added the optional index of the data pointers.
+ *            * Fixed moveSList and moveSListNode leaving a stale last node in
+ *              the source list.
  * 0.3.0.10 - 2015/11/09 - oborchert
  *            * Added Changelog
  *            * Fixed speller in documentation header
  * 0.1.0    - 2009/12/23 -pgleichm
  *            * Code created. 
  */
+#include <stdint.h>
+#include <string.h>
 #include "util/slist.h"
 #include "util/log.h"
 
+/**
+ * Return the first index slot of the given data pointer.
+ *
+ * @param data The data pointer
+ * @param mask The number of index slots - 1
+ *
+ * @return The slot
+ */
+static inline int _slotOfData(void* data, int mask)
+{
+  uint64_t key = (uint64_t)(uintptr_t)data;
+
+  // Mix the pointer bits, the lower bits of aligned pointers are zero.
+  key ^= key >> 33;
+  key *= 0xff51afd7ed558ccdULL;
+  key ^= key >> 33;
+
+  return (int)(key & (uint64_t)mask);
+}
+
+/**
+ * Build the index of the list anew, the number of slots is adjusted to the
+ * size of the list. The list is searched without index if not enough memory
+ * is available.
+ *
+ * @param self List instance
+ */
+static void _rebuildSListIndex(SList* self)
+{
+  SListNode* node;
+  int        slots = 64;
+  int        slot;
+
+  // Keep the load below one half.
+  while (slots <= self->size * 2)
+  {
+    slots <<= 1;
+  }
+
+  free(self->index);
+  self->index     = calloc(slots, sizeof(SListNode*));
+  self->indexSize = 0;
+  if (self->index == NULL)
+  {
+    RAISE_ERROR("Not enough memory for the list index");
+    return;
+  }
+  self->indexSize = slots;
+
+  for (node = self->root; node != NULL; node = node->next)
+  {
+    slot = _slotOfData(node->data, slots - 1);
+    while (self->index[slot] != NULL)
+    {
+      slot = (slot + 1) & (slots - 1);
+    }
+    self->index[slot] = node;
+  }
+}
+
+/**
+ * Add the nodes from first to last to the index. The nodes MUST already be
+ * linked and counted in the size of the list.
+ *
+ * @param self List instance
+ * @param first The first node to add
+ * @param last The last node to add
+ */
+static void _addToSListIndex(SList* self, SListNode* first, SListNode* last)
+{
+  SListNode* node;
+  int        mask;
+  int        slot;
+
+  if (!self->indexed)
+  {
+    return;
+  }
+
+  // Not build yet or too crowded, the rebuild covers the new nodes as well.
+  if (self->size * 2 > self->indexSize)
+  {
+    if ((self->indexSize > 0) || (self->size >= SLIST_INDEX_MIN_SIZE))
+    {
+      _rebuildSListIndex(self);
+    }
+    return;
+  }
+
+  mask = self->indexSize - 1;
+  for (node = first; node != NULL; node = node->next)
+  {
+    slot = _slotOfData(node->data, mask);
+    while (self->index[slot] != NULL)
+    {
+      slot = (slot + 1) & mask;
+    }
+    self->index[slot] = node;
+    if (node == last)
+    {
+      break;
+    }
+  }
+}
+
+/**
+ * Remove a node from the index. The node MUST already be unlinked and not be
+ * counted in the size of the list anymore.
+ *
+ * @param self List instance
+ * @param node The node to remove
+ */
+static void _removeFromSListIndex(SList* self, SListNode* node)
+{
+  int mask = self->indexSize - 1;
+  int slot, next, home;
+
+  if (self->indexSize == 0)
+  {
+    return;
+  }
+
+  // Release an almost empty index, a list that shrunk much gets a smaller one.
+  if (self->size < SLIST_INDEX_MIN_SIZE)
+  {
+    free(self->index);
+    self->index     = NULL;
+    self->indexSize = 0;
+    return;
+  }
+  if ((self->size * 16 < self->indexSize) && (self->indexSize > 64))
+  {
+    _rebuildSListIndex(self);
+    return;
+  }
+
+  slot = _slotOfData(node->data, mask);
+  while (self->index[slot] != node)
+  {
+    if (self->index[slot] == NULL)
+    {
+      RAISE_ERROR("List node not found in the index");
+      return;
+    }
+    slot = (slot + 1) & mask;
+  }
+
+  // Move following nodes of the probe sequence into the free slot.
+  next = slot;
+  while (true)
+  {
+    next = (next + 1) & mask;
+    if (self->index[next] == NULL)
+    {
+      break;
+    }
+    home = _slotOfData(self->index[next]->data, mask);
+    if (((next > slot) && ((home <= slot) || (home > next)))
+        || ((next < slot) && (home <= slot) && (home > next)))
+    {
+      self->index[slot] = self->index[next];
+      slot = next;
+    }
+  }
+  self->index[slot] = NULL;
+}
+
+/**
+ * Return the first node holding the given data.
+ *
+ * @param self List instance
+ * @param data The data to search for
+ *
+ * @return The node or NULL if not found
+ */
+static SListNode* _findSListNode(SList* self, void* data)
+{
+  SListNode* node;
+  int        mask;
+  int        slot;
+
+  if (self->indexSize > 0)
+  {
+    mask = self->indexSize - 1;
+    for (slot = _slotOfData(data, mask); self->index[slot] != NULL;
+         slot = (slot + 1) & mask)
+    {
+      if (self->index[slot]->data == data)
+      {
+        return self->index[slot];
+      }
+    }
+    return NULL;
+  }
+
+  for (node = self->root; node != NULL; node = node->next)
+  {
+    if (node->data == data)
+    {
+      return node;
+    }
+  }
+  return NULL;
+}
+
+/**
+ * Unlink a node from the list. The node itself is not released.
+ *
+ * @param self List instance
+ * @param node The node
+ */
+static void _unlinkSListNode(SList* self, SListNode* node)
+{
+  if (node->prev == NULL)
+  {
+    self->root = node->next;
+  }
+  else
+  {
+    node->prev->next = node->next;
+  }
+
+  if (node->next == NULL)
+  {
+    self->last = node->prev;
+  }
+  else
+  {
+    node->next->prev = node->prev;
+  }
+  self->size--;
+
+  _removeFromSListIndex(self, node);
+}
+
 void initSList(SList* self)
 {
-  self->root = NULL;
-  self->size = 0;
+  self->root      = NULL;
+  self->last      = NULL;
+  self->size      = 0;
+  self->indexed   = false;
+  self->index     = NULL;
+  self->indexSize = 0;
+}
+
+void indexSList(SList* self)
+{
+  self->indexed = true;
+  if ((self->indexSize == 0) && (self->size >= SLIST_INDEX_MIN_SIZE))
+  {
+    _rebuildSListIndex(self);
+  }
 }
 
 /**
@@ -62,6 +318,10 @@ void releaseSList(SList* self)
       free(currNode);
     }
   }
+
+  free(self->index);
+  self->index     = NULL;
+  self->indexSize = 0;
 }
 
 inline int sizeOfSList(SList* self)
@@ -79,7 +339,18 @@ inline bool appendDataToSList(SList* self, void* data)
   return insertDataIntoSList(self, self->size, data);
 }
 
-void* insertIntoSList(SList* self, int index, size_t dataSize)
+/**
+ * Inserts a new node before the given index, see insertIntoSList.
+ *
+ * @param self List instance
+ * @param index Index (>= 0)
+ * @param dataSize Number of Bytes that should be allocated
+ * @param data Data managed outside of the list (dataSize = 0)
+ *
+ * @return The new node or NULL
+ */
+static SListNode* _insertIntoSList(SList* self, int index, size_t dataSize, 
+                                   void* data)
 {
   // Out of boundaries (size + 1)
   if (index > self->size)
@@ -112,7 +383,7 @@ void* insertIntoSList(SList* self, int index, size_t dataSize)
   } 
   else
   {
-    newNode->data      = NULL;
+    newNode->data      = data;
     newNode->allocSize = 0;
   }
   
@@ -124,8 +395,13 @@ void* insertIntoSList(SList* self, int index, size_t dataSize)
     {
       self->last = newNode;  
     }
+    else
+    {
+      self->root->prev = newNode;
+    }
 
     newNode->next = self->root;
+    newNode->prev = NULL;
     self->root = newNode;
 
   // Append it as last-node
@@ -133,6 +409,7 @@ void* insertIntoSList(SList* self, int index, size_t dataSize)
   else if (index == self->size) //  SUSPICIOUS PART --KH--  SEE also ./server/command_queue.c:162
   {
     self->last->next = newNode;  //<MUST use this (KH)> newNode->next = self->last->next; 
+    newNode->prev = self->last;
     self->last = newNode;
     newNode->next = NULL;
   // Go over the list
@@ -147,75 +424,61 @@ void* insertIntoSList(SList* self, int index, size_t dataSize)
     }
 
     newNode->next = prevNode->next;
+    newNode->prev = prevNode;
+    prevNode->next->prev = newNode;
     prevNode->next = newNode;
   }
 
   // One more
   self->size++;
+  _addToSListIndex(self, newNode, newNode);
 
-  return (newNode->allocSize > 0) ? newNode->data : newNode;
+  return newNode;
 }
 
-bool insertDataIntoSList(SList* self, int index, void* data)
+void* insertIntoSList(SList* self, int index, size_t dataSize)
 {
-  SListNode* newNode = insertIntoSList(self, index, 0);
-  if (newNode != NULL)
+  SListNode* newNode = _insertIntoSList(self, index, dataSize, NULL);
+
+  if (newNode == NULL)
   {
-    newNode->data = data;
-    return true;
+    return NULL;
   }
-  return false;
+  return (newNode->allocSize > 0) ? newNode->data : newNode;
 }
 
-bool deleteFromSList(SList* self, void* data) // SUSPICIOUS --KH--
+bool insertDataIntoSList(SList* self, int index, void* data)
 {
-  if (self->size > 0)
-  {
-    SListNode* currNode = self->root, *prevNode = NULL;
+  return _insertIntoSList(self, index, 0, data) != NULL;
+}
 
-    while (currNode != NULL)
-    {
-      // Found the corresponding node
-      if (currNode->data == data)
-      {
-        // Entry in the middle/end
-        if (prevNode != NULL)
-        {
-          prevNode->next = currNode->next;
-
-          // We deleted the last node
-          if (currNode->next == NULL)
-          {
-            self->last = prevNode;
-          }
-        // New root
-        } 
-        else
-        {
-          self->root = currNode->next;
-        }
-        free(currNode);
-        self->size--;
-        return true;
-      }
+bool deleteFromSList(SList* self, void* data)
+{
+  SListNode* node = (self->size > 0) ? _findSListNode(self, data) : NULL;
 
-      prevNode = currNode;
-      currNode = currNode->next;
-    }
+  if (node == NULL)
+  {
+    return false;
   }
-  return false;
+  _unlinkSListNode(self, node);
+  free(node);
+  return true;
 }
 
 /**
  * Removes all nodes from the list and frees up the memory used. This method is
- * equivalent to releaseList followed by initList.
+ * equivalent to releaseList followed by initList, an indexed list stays 
+ * indexed.
  *
  * @param self List instance
  */
 void emptySList(SList* self)
 {
+  bool indexed = self->indexed;
+
   releaseSList(self);
   initSList(self);
+  self->indexed = indexed;
 }
 
 void* shiftFromSList(SList* self)
@@ -231,30 +494,17 @@ void* shiftFromSList(SList* self)
 
   // Relink
   firstNode = self->root;
-  self->root = firstNode->next;
+  _unlinkSListNode(self, firstNode);
 
   // Release the node - but not the data
   data = firstNode->data;
   free(firstNode);
-  self->size--;
   return data;
 }
 
 bool existsInSList(SList* self, void* data)
 {
-  if (self->size > 0)
-  {
-    SListNode* node;
-  
-    FOREACH_SLIST(self, node)
-    {
-      if (node->data == data)
-      {
-        return true;
-      }
-    }
-  }
-  return false;
+  return (self->size > 0) && (_findSListNode(self, data) != NULL);
 }
 
 void* getFromSList(SList* self, int index)
@@ -382,8 +632,10 @@ SListNode* copySList(SList* to, SList* from)
     if (!copyNodeData(to->root, from->root))
     {
       free(to->root);
+      to->root = NULL;
       return NULL;
     }
+    to->root->prev = NULL;
     to->size++;
  
     // Copy all after the root
@@ -408,6 +660,8 @@ SListNode* copySList(SList* to, SList* from)
     {
       RAISE_SYS_ERROR("Not enough memory to copy a node");
       to->last = prevToNode; // Terminate the list at least
+      prevToNode->next = NULL;
+      _addToSListIndex(to, (end == NULL) ? to->root : end->next, to->last);
       return NULL;
     }
 
@@ -420,6 +674,7 @@ SListNode* copySList(SList* to, SList* from)
     }
 
     prevToNode->next = newNode;
+    newNode->prev    = prevToNode;
     to->size++;
     prevToNode = newNode;
   }
@@ -428,21 +683,19 @@ SListNode* copySList(SList* to, SList* from)
   to->last = prevToNode;
   prevToNode->next = NULL;
 
+  _addToSListIndex(to, (end == NULL) ? to->root : end->next, to->last);
+
   return (end == NULL) ? to->root : end->next;
 }
 
 SListNode* copySListNode(SList* to, SListNode* node)
 {
-  SListNode* new = appendToSList(to, node->allocSize);
+  SListNode* new = _insertIntoSList(to, to->size, node->allocSize, node->data);
   if (new == NULL)
   {
     return NULL;
   }
-  if (node->allocSize == 0)
-  {
-    new->data = node->data;
-  } 
-  else
+  if (node->allocSize > 0)
   {
     memcpy(new->data, node->data, node->allocSize);
   }
@@ -470,15 +723,22 @@ SListNode* moveSList(SList* to, SList* from)
   } 
   else
   {
-    to->last->next = from->root;
-    to->last       = from->last;
-    to->size      += from->size;
+    to->last->next   = from->root;
+    from->root->prev = to->last;
+    to->last         = from->last;
+    to->size        += from->size;
   }
 
   astart = from->root;
 
   from->root = NULL;
+  from->last = NULL;
   from->size = 0;
+  free(from->index);
+  from->index     = NULL;
+  from->indexSize = 0;
+
+  _addToSListIndex(to, astart, to->last);
 
   return astart;
 }
@@ -486,25 +746,21 @@ SListNode* moveSList(SList* to, SList* from)
 void moveSListNode(SList* to, SList* from, SListNode* node, 
                    SListNode* prevNode)
 {
+  _unlinkSListNode(from, node);
+
+  node->next = NULL;
   if (to->size == 0)
   {
-    to->root = node;  
+    node->prev = NULL;
+    to->root   = node;  
   } 
   else
   {
+    node->prev     = to->last;
     to->last->next = node;
   }
   to->last = node;
   to->size++;
 
-  if (prevNode == NULL)
-  {
-    from->root = node->next;
-  } 
-  else
-  {
-    prevNode->next = node->next;
-  }
-  node->next = NULL;
-  from->size--;
+  _addToSListIndex(to, node, node);
 }
@@ -40,12 +40,24 @@
  * @endcode
  *
  * Uses log.h to report error messages
+ *
+ * A list that holds each data pointer only once can keep an index of the
+ * data pointers (see indexSList). Indexed lists find the node of a data
+ * pointer without walking the list, this makes deleteFromSList and
+ * existsInSList O(1) for large lists such as the update list of the prefix
+ * cache.
  * 
  * 
- * @version 0.3.0.10
+ * @version 0.6.2.2
  *
  * Changelog:
  * -----------------------------------------------------------------------------
+ * 0.6.2.2  - 2026/10/17
+ *            * Added the previous node to SListNode, nodes are removed
+ *              without searching their predecessor.
+ *            * Added indexSList.
+ *            * moveSList and moveSListNode maintain the last node of the
+ *              source list.
  * 0.3.0.10 - 2015/11/09 - oborchert
  *            * Removed types.h
  *            * Added Changelog
@@ -60,6 +72,9 @@
 #include <stdlib.h>
 #include <stdbool.h>
 
+/** Indexed lists with less nodes are searched without the index. */
+#define SLIST_INDEX_MIN_SIZE 16
+
 /**
  * A single node.
  */
@@ -68,6 +83,7 @@ typedef struct _SListNode
   void*               data;       ///< Allocated memory block, or \c NULL
   size_t              allocSize;  ///< Size of \c data - 0 = managed outside
   struct _SListNode*  next;       ///< Pointer to the next node
+  struct _SListNode*  prev;       ///< Pointer to the previous node
 } SListNode;
 
 /**
@@ -75,9 +91,12 @@ typedef struct _SListNode
  */
 typedef struct
 {
-  SListNode* root; ///< The first node
-  SListNode* last; ///< The last node - makes appending easier
-  int        size; ///< Number of nodes
+  SListNode*  root;      ///< The first node
+  SListNode*  last;      ///< The last node - makes appending easier
+  int         size;      ///< Number of nodes
+  bool        indexed;   ///< Keep an index of the data pointers
+  SListNode** index;     ///< Open addressing hash table of the nodes
+  int         indexSize; ///< Number of slots of the index - 0 = not built
 } SList;
 
 /*----------------
@@ -91,6 +110,19 @@ typedef struct
  */
 extern void initSList(SList* self);
 
+/**
+ * Keeps an index of the data pointers of the list. The index is built once
+ * the list holds SLIST_INDEX_MIN_SIZE nodes and released with the list.
+ *
+ * @note Each data pointer MUST be stored only once. Data pointers MUST NOT be
+ *       changed using setDataOfSListNode.
+ *
+ * @param self List instance
+ *
+ * @since 0.6.2.2
+ */
+extern void indexSList(SList* self);
+
 /**
  * Releases the allocated memory blocks for each entry and its and nodes.
  *
@@ -159,7 +191,8 @@ extern bool deleteFromSList(SList* self, void* data);
 
 /**
  * Removes all nodes from the list and frees up the memory used. This method is
- * equivalent to releaseList followed by initList.
+ * equivalent to releaseList followed by initList, an indexed list stays 
+ * indexed.
  *
  * @param self List instance
  */
@@ -262,6 +295,8 @@ extern void* getDataOfSListNode(SListNode* node);
  * Sets the data of a node.
  * If the previous data was allocated within the list it is free'd.
  *
+ * @note Not for nodes of an indexed list
+ *
  * @param node A Node
  * @param data Data
  */
@@ -341,7 +376,8 @@ SListNode* moveSList(SList* to, SList* from);
  * @param to Destination list
  * @param from Source list
  * @param node Node that should be moved
- * @param prevNode Node before \c node or \c NULL (= first node)
+ * @param prevNode Node before \c node or \c NULL (= first node) - not used 
+ *                 anymore, the node links its predecessor
  */
 void moveSListNode(SList* to, SList* from, SListNode* node, 
                    SListNode* prevNode);
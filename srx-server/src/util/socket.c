@@ -20,10 +20,12 @@
  * other licenses. Please refer to the licenses of all libraries required
  * by this software.
  *
- * @version 0.5.0.0
+ * @version 0.6.2.2
  *
  * Changelog:
  * -----------------------------------------------------------------------------
+ * 0.6.2.2 - 2026/10/17
+ *           * Added recvAvailable.
  * 0.5.0.0 - 2017/07/07 - oborchert
  *           * Modified some LOGGING levels
  * 0.3.0.0 - 2013/02/27 - oborchert
@@ -139,6 +141,64 @@ bool recvNum(int* fd, void* buffer, size_t num)
   return true;
 }
 
+/**
+ * This method receives the bytes currently available, at most size bytes, and
+ * writes them into the given buffer.
+ *
+ * @param fd The file descriptor of the socket.
+ * @param buffer The buffer to write into.
+ * @param size The size of the buffer.
+ * @param wait Wait until data is available.
+ *
+ * @return The number of bytes read, 0 if no data is available, -1 if the 
+ *         connection is closed or an error occurred.
+ *
+ * @since 0.6.2.2
+ */
+ssize_t recvAvailable(int* fd, void* buffer, size_t size, bool wait)
+{
+  ssize_t rbytes;
+  int     flags = MSG_NOSIGNAL | (wait ? 0 : MSG_DONTWAIT);
+  _setLastError(0, SOCK_OP_RCV);
+
+  if (*fd == -1)
+  {
+    _setLastError(EBADF, SOCK_OP_RCV);
+    return -1;
+  }
+
+  do
+  {
+    rbytes = recv(*fd, buffer, size, flags);
+  } while ((rbytes == -1) && (errno == EINTR));
+
+  if (rbytes == -1)
+  {
+    int ioError = errno;
+    _setLastError(ioError, SOCK_OP_RCV);
+    if ((ioError == EAGAIN) || (ioError == EWOULDBLOCK))
+    {
+      // Nothing available right now.
+      _setLastError(0, SOCK_OP_RCV);
+      return 0;
+    }
+    if ((ioError != EBADF) && (ioError != ECONNRESET))
+    {
+      RAISE_SYS_ERROR("Socket error 0x%X (%u) while receiving data!",
+                      ioError, ioError);
+    }
+    *fd = -1;
+  }
+  else if (rbytes == 0)
+  {
+    LOG(LEVEL_INFO, "Connection reset by peer.");
+    *fd = -1;
+    rbytes = -1;
+  }
+
+  return rbytes;
+}
+
 /**
  * Send the data stored in the buffer. this method closes the socket in case of
  * an error.
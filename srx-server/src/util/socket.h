@@ -20,10 +20,12 @@
  * other licenses. Please refer to the licenses of all libraries required 
  * by this software.
  *
- * @version 0.3.0.10
+ * @version 0.6.2.2
  *
  * Changelog:
  * -----------------------------------------------------------------------------
+ * 0.6.2.2  - 2026/10/17
+ *            * Added recvAvailable.
  * 0.3.0.10 - 2015/11/09 - oborchert
  *            * Removed types.h
  * 0.3.0    - 2013/01/09 - oborchert
@@ -65,6 +67,23 @@
  */
 bool recvNum(int* fd, void* buffer, size_t num);
 
+/**
+ * Reads up to \c size Bytes from a socket. Other than recvNum this function
+ * returns with the bytes currently available. In case the connection is closed
+ * or an error occurred, \c fd is set to \c -1.
+ *
+ * @param fd File-descriptor pointer
+ * @param buffer (out) Destination for the read data
+ * @param size Size of buffer
+ * @param wait Wait until data is available, otherwise return 0 if no data is
+ *             available.
+ * @return The number of bytes read, 0 if no data is available, -1 if the 
+ *         connection is closed or an error occurred.
+ *
+ * @since 0.6.2.2
+ */
+ssize_t recvAvailable(int* fd, void* buffer, size_t size, bool wait);
+
 /** 
  * Writes \c num Bytes to a socket.
  * In case of an error, \c fd is closed and set to \c -1.